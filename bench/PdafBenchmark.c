@@ -0,0 +1,920 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/*
+    Benchmark of PDAF Library with synthetic calibration data.
+
+    Build with the sources of PDAF Library, for example
+
+        gcc -O2 -I../src PdafBenchmark.c ../src/PdafLibrary.c ../src/PdafMathFunc.c ../src/PdafThreadPool.c ../src/PdafStatistics.c ../src/PdafCalibImage.c ../src/PdafOtpDecoder.c ../src/PdafHotSwap.c ../src/PdafPhaseDetect.c ../src/PdafRoi.c ../src/PdafTracker.c ../src/PdafRecord.c ../src/PdafTrace.c -lpthread -ldl -o PdafBenchmark
+
+    Usage : PdafBenchmark [-n CallNum] [-o JsonFile] [-k AreaEngine ConstantTimeEngine]
+
+    Time per call is reported for each knot grid, pitch of knots, number of points of threshold line,
+    mode of input (normal, confidence judgement disabled, phase difference error) and AreaIndex 0 - 8
+    of PDAF window center, with the worst area and the spread between areas. Results are printed
+    as a table and written as JSON. Build with -DD_PD_LIB_CONSTANT_TIME=1 to measure the kernel
+    of constant time instead of the kernel selected by area. Bytes per knot of slope and offset packed
+    by context, and bytes of its threshold lines, are printed for each knot grid.
+
+    With -k, PDAF Library built as shared libraries with each kernel, for example
+
+        gcc -O2 -shared -fPIC -I../src ../src/PdafLibrary.c ../src/PdafMathFunc.c ../src/PdafThreadPool.c ../src/PdafStatistics.c ../src/PdafCalibImage.c ../src/PdafOtpDecoder.c ../src/PdafHotSwap.c ../src/PdafPhaseDetect.c ../src/PdafRoi.c ../src/PdafTracker.c ../src/PdafRecord.c ../src/PdafTrace.c -lpthread -o libPdafArea.so
+        gcc -O2 -shared -fPIC -DD_PD_LIB_CONSTANT_TIME=1 -I../src ../src/PdafLibrary.c ../src/PdafMathFunc.c ../src/PdafThreadPool.c ../src/PdafStatistics.c ../src/PdafCalibImage.c ../src/PdafOtpDecoder.c ../src/PdafHotSwap.c ../src/PdafPhaseDetect.c ../src/PdafRoi.c ../src/PdafTracker.c ../src/PdafRecord.c ../src/PdafTrace.c -lpthread -o libPdafConstantTime.so
+
+    are loaded, and latency of PdLibGetDefocus() of both kernels is printed side by side : mean of the
+    worst area, 99th percentile and maximum of time per call, with time per window of batch.
+*/
+
+/****************************************************************/
+/*                          include                             */
+/****************************************************************/
+
+#if !defined _WIN32 && !defined _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 199309L                     /* For clock_gettime() */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#include <dlfcn.h>
+#endif
+
+#include "PdafMathFunc.h"
+#include "PdafLibrary.h"
+#include "../tests/PdafTestCommon.h"
+
+/****************************************************************/
+/*                          define                              */
+/****************************************************************/
+
+#define D_BENCH_X_SIZE_OF_IMAGE     (4000)          /* Size of image of synthetic calibration data */
+#define D_BENCH_Y_SIZE_OF_IMAGE     (3000)
+#define D_BENCH_WINDOW_SIZE         (64)            /* Size of PDAF window */
+#define D_BENCH_WINDOW_NUM          (16)            /* Number of windows of each area */
+#define D_BENCH_AREA_NUM            (9)             /* AreaIndex 0 - 8 */
+#define D_BENCH_GAIN_NUM            (16)            /* Number of analog gains used in turn */
+#define D_BENCH_MAX_POINT_NUM       (32)            /* Maximum number of points of threshold line */
+#define D_BENCH_DEFAULT_CALL_NUM    (20000)         /* Default number of calls of each measurement */
+#define D_BENCH_KERNEL_NUM          (2)             /* Kernels compared by -k : area 0 - 8 and constant time */
+#define D_BENCH_TAIL_PERMILLE       (990)           /* Per mille of calls within tail latency */
+
+/* Mode of input */
+#define D_BENCH_MODE_NORMAL         (0)             /* Confidence judgement with threshold lines */
+#define D_BENCH_MODE_NCW            (1)             /* Confidence judgement disabled (ENCWDDON) */
+#define D_BENCH_MODE_PD_ERROR       (2)             /* Phase difference is error value (EPDVALERR) */
+
+/****************************************************************/
+/*                          structure                           */
+/****************************************************************/
+
+/* Synthetic calibration data */
+typedef struct
+{
+    PdLibCalibData_t        CalibData;
+    signed long             *p_SlopeData;
+    signed long             *p_OffsetData;
+    unsigned short          *p_XAddressKnot;
+    unsigned short          *p_YAddressKnot;
+    DefocusOKNGThrLine_t    *p_ThrLine;
+    unsigned long           *p_ThrLineData;
+} BenchCalib_t;
+
+/* Condition of measurement */
+typedef struct
+{
+    unsigned short          XKnotNum;
+    unsigned short          YKnotNum;
+    unsigned char           Irregular;              /* 0 : uniform pitch of knots, 1 : irregular pitch */
+    unsigned long           PointNum;               /* Number of points of threshold line */
+    unsigned char           Mode;                   /* D_BENCH_MODE_XXX */
+} BenchCondition_t;
+
+/* PDAF Library loaded from a shared library, which is built with a kernel */
+typedef struct
+{
+    void            *p_Handle;
+    signed long     (*p_GetDefocus) ( PdLibInputData_t *, PdLibOutputData_t * );
+    signed long     (*p_CreateContext) ( PdLibCalibData_t *, PdLibContext_t ** );
+    signed long     (*p_ValidateContext) ( PdLibContext_t * );
+    void            (*p_DestroyContext) ( PdLibContext_t * );
+    signed long     (*p_RegisterWindows) ( PdLibContext_t *, unsigned long, PdLibWindow_t * );
+    signed long     (*p_GetDefocusBatchWithContext) ( PdLibContext_t *, unsigned long, unsigned long, PdLibWindow_t *, PdLibPhaseDiffData_t *, PdLibOutputData_t *, signed long * );
+} BenchEngine_t;
+
+/* Latency of a kernel */
+typedef struct
+{
+    double                  NsWorst;                /* Mean time per call of the worst area */
+    double                  NsTail;                 /* Time within which D_BENCH_TAIL_PERMILLE of calls end */
+    double                  NsMax;                  /* Maximum time of a call */
+    double                  NsBatch;                /* Mean time per window of PdLibGetDefocusBatchWithContext() */
+} BenchLatency_t;
+
+/****************************************************************/
+/*                 local function declaration                   */
+/****************************************************************/
+
+static double bench_get_time_ns ( void );
+static signed char bench_create_calib ( BenchCondition_t *pf_Condition, BenchCalib_t *pf_Calib );
+static void bench_destroy_calib ( BenchCalib_t *pf_Calib );
+static void bench_set_window ( BenchCalib_t *pf_Calib, unsigned char f_AreaIndex, PdLibWindow_t *pf_Window );
+static void bench_set_input ( BenchCalib_t *pf_Calib, PdLibWindow_t *pf_Window, PdLibPhaseDiffData_t *pf_PhaseDiffData, unsigned long f_ImagerAnalogGain, PdLibInputData_t *pf_InputData );
+static void bench_print_json ( FILE *pf_File, const char *pf_Api, BenchCondition_t *pf_Condition, signed long f_AreaIndex, double f_NsPerCall, unsigned char f_First );
+static signed char bench_load_engine ( const char *pf_Path, BenchEngine_t *pf_Engine );
+static void bench_unload_engine ( BenchEngine_t *pf_Engine );
+static signed char bench_compare_kernels ( const char **ppf_EnginePath, unsigned long f_CallNum, FILE *pf_File );
+static signed char bench_measure_kernel ( BenchEngine_t *pf_Engine, BenchCalib_t *pf_Calib, PdLibWindow_t *pf_Window, PdLibPhaseDiffData_t *pf_PhaseDiffData, unsigned long *pf_Gain, unsigned long f_CallNum, double *pf_Latency, BenchLatency_t *pf_Result );
+static int bench_compare_ns ( const void *pf_A, const void *pf_B );
+
+/****************************************************************/
+/*                           main                               */
+/****************************************************************/
+
+int main ( int argc, char *argv[] )
+{
+    static const unsigned short s_KnotNum[][2] = { { 2, 2 }, { 8, 6 }, { 16, 12 }, { 32, 24 } };
+    static const unsigned long  s_PointNum[]   = { 2, 8, D_BENCH_MAX_POINT_NUM };
+    static const char           *s_ModeName[]  = { "normal", "ncw", "pderror" };
+
+    unsigned long   CallNum;
+    const char      *p_JsonPath;
+    const char      *p_EnginePath[D_BENCH_KERNEL_NUM];
+    FILE            *p_Json;
+    unsigned char   First;
+    unsigned long   g;
+    unsigned long   p;
+    unsigned char   Irregular;
+    unsigned char   Mode;
+    int             i;
+    volatile signed long Sink;
+
+    CallNum    = D_BENCH_DEFAULT_CALL_NUM;
+    p_JsonPath = "PdafBenchmark.json";
+
+    p_EnginePath[0] = NULL;
+    p_EnginePath[1] = NULL;
+
+    for ( i = 1; i < argc; i++ ) {
+        if ( strcmp ( argv[i], "-n" ) == 0 && i + 1 < argc ) {
+            CallNum = strtoul ( argv[++i], NULL, 10 );
+        } else if ( strcmp ( argv[i], "-o" ) == 0 && i + 1 < argc ) {
+            p_JsonPath = argv[++i];
+        } else if ( strcmp ( argv[i], "-k" ) == 0 && i + 2 < argc ) {
+            p_EnginePath[0] = argv[++i];
+            p_EnginePath[1] = argv[++i];
+        } else {
+            fprintf ( stderr, "Usage : %s [-n CallNum] [-o JsonFile] [-k AreaEngine ConstantTimeEngine]\n", argv[0] );
+            return 1;
+        }
+    }
+
+    if ( CallNum == 0 ) {
+        CallNum = 1;
+    }
+
+    p_Json = fopen ( p_JsonPath, "w" );
+
+    if ( p_Json == NULL ) {
+        fprintf ( stderr, "Cannot open %s\n", p_JsonPath );
+        return 1;
+    }
+
+    {
+        PdLibVersion_t Version;
+
+        PdLibGetVersion ( &Version );
+        fprintf ( p_Json, "{\n  \"version\": \"%lu.%02lu\",\n  \"kernel\": \"%s\",\n  \"call_num\": %lu,\n  \"results\": [\n",
+                  Version.MajorVersion, Version.MinorVersion, D_PD_LIB_CONSTANT_TIME ? "constant_time" : "area", CallNum );
+    }
+
+    printf ( "Kernel : %s\n", D_PD_LIB_CONSTANT_TIME ? "constant time" : "area 0 - 8" );
+    printf ( "%-16s %-6s %-9s %-3s %-8s %8s %8s %8s %8s %8s %8s %8s %8s %8s %8s %8s %10s %10s\n",
+             "ns/call", "grid", "pitch", "pt", "mode",
+             "area0", "area1", "area2", "area3", "area4", "area5", "area6", "area7", "area8",
+             "worst", "spread", "batch/win", "regwin/win" );
+
+    First = 1;
+    Sink  = 0;
+
+    for ( g = 0; g < sizeof(s_KnotNum) / sizeof(s_KnotNum[0]); g++ ) {
+    for ( Irregular = 0; Irregular <= 1; Irregular++ ) {
+    for ( Mode = D_BENCH_MODE_NORMAL; Mode <= D_BENCH_MODE_PD_ERROR; Mode++ ) {
+    for ( p = 0; p < sizeof(s_PointNum) / sizeof(s_PointNum[0]); p++ ) {
+        BenchCondition_t        Condition;
+        BenchCalib_t            Calib;
+        PdLibWindow_t           Window[D_BENCH_AREA_NUM * D_BENCH_WINDOW_NUM];
+        PdLibPhaseDiffData_t    PhaseDiffData[D_BENCH_AREA_NUM * D_BENCH_WINDOW_NUM];
+        PdLibOutputData_t       OutputData[D_BENCH_AREA_NUM * D_BENCH_WINDOW_NUM];
+        signed long             Result[D_BENCH_AREA_NUM * D_BENCH_WINDOW_NUM];
+        unsigned long           Gain[D_BENCH_GAIN_NUM];
+        double                  NsPerCall[D_BENCH_AREA_NUM];
+        double                  NsWorst;
+        double                  NsBest;
+        double                  NsBatch;
+        double                  NsRegWindow;
+        unsigned char           a;
+        unsigned long           j;
+        unsigned long           n;
+
+        if ( Mode != D_BENCH_MODE_NORMAL && s_PointNum[p] != 8 ) {
+            continue ;                                      /* Threshold line is not used except normal mode */
+        }
+
+        Condition.XKnotNum  = s_KnotNum[g][0];
+        Condition.YKnotNum  = s_KnotNum[g][1];
+        Condition.Irregular = Irregular;
+        Condition.PointNum  = s_PointNum[p];
+        Condition.Mode      = Mode;
+
+        if ( bench_create_calib ( &Condition, &Calib ) != 0 ) {
+            fprintf ( stderr, "Cannot allocate calibration data\n" );
+            fclose ( p_Json );
+            return 1;
+        }
+
+        for ( a = 0; a < D_BENCH_AREA_NUM; a++ ) {
+            for ( j = 0; j < D_BENCH_WINDOW_NUM; j++ ) {
+                n = a * D_BENCH_WINDOW_NUM + j;
+
+                bench_set_window ( &Calib, a, &(Window[n]) );
+
+                PhaseDiffData[n].PhaseDifference = ( Mode == D_BENCH_MODE_PD_ERROR ) ?
+                                                   ( D_PD_ERROR_VALUE * 16 ) : (signed long)( test_rand () % 4096 ) - 2048;
+                PhaseDiffData[n].ConfidenceLevel = test_rand () % 2048;
+            }
+        }
+
+        for ( j = 0; j < D_BENCH_GAIN_NUM; j++ ) {          /* Analog gain changes in every call */
+            Gain[j] = test_rand () % ( Condition.PointNum * 256 );
+        }
+
+        /* PdLibGetDefocus() for each area */
+        for ( a = 0; a < D_BENCH_AREA_NUM; a++ ) {
+            PdLibInputData_t InputData[D_BENCH_WINDOW_NUM];
+            double Start;
+
+            for ( j = 0; j < D_BENCH_WINDOW_NUM; j++ ) {
+                n = a * D_BENCH_WINDOW_NUM + j;
+                bench_set_input ( &Calib, &(Window[n]), &(PhaseDiffData[n]), Gain[j], &(InputData[j]) );
+            }
+
+            Start = bench_get_time_ns ();
+
+            for ( j = 0; j < CallNum; j++ ) {
+                PdLibOutputData_t Out;
+
+                Sink += PdLibGetDefocus ( &(InputData[j % D_BENCH_WINDOW_NUM]), &Out );
+                Sink += Out.Defocus;
+            }
+
+            NsPerCall[a] = ( bench_get_time_ns () - Start ) / (double)CallNum;
+
+            bench_print_json ( p_Json, "PdLibGetDefocus", &Condition, a, NsPerCall[a], First );
+            First = 0;
+        }
+
+        NsWorst = NsPerCall[0];                             /* Worst case and spread between areas */
+        NsBest  = NsPerCall[0];
+        for ( a = 1; a < D_BENCH_AREA_NUM; a++ ) {
+            NsWorst = ( NsWorst < NsPerCall[a] ) ? NsPerCall[a] : NsWorst;
+            NsBest  = ( NsPerCall[a] < NsBest  ) ? NsPerCall[a] : NsBest;
+        }
+
+        /* PdLibGetDefocusBatchWithContext() and PdLibGetDefocusRegisteredWindows() for windows of all areas */
+        {
+            PdLibContext_t *p_Context;
+            unsigned long Repeat;
+            double Start;
+
+            n = D_BENCH_AREA_NUM * D_BENCH_WINDOW_NUM;
+            Repeat = CallNum / n + 1;
+
+            if ( PdLibCreateContext ( &(Calib.CalibData), &p_Context ) != D_PD_LIB_E_OK ) {
+                fprintf ( stderr, "Cannot create context\n" );
+                fclose ( p_Json );
+                return 1;
+            }
+
+            (void)PdLibValidateContext ( p_Context );
+            (void)PdLibRegisterWindows ( p_Context, n, Window );
+
+            Start = bench_get_time_ns ();
+            for ( j = 0; j < Repeat; j++ ) {
+                Sink += PdLibGetDefocusBatchWithContext ( p_Context, Gain[j % D_BENCH_GAIN_NUM], n,
+                                                          Window, PhaseDiffData, OutputData, Result );
+                Sink += OutputData[j % n].Defocus;
+            }
+            NsBatch = ( bench_get_time_ns () - Start ) / (double)( Repeat * n );
+
+            Start = bench_get_time_ns ();
+            for ( j = 0; j < Repeat; j++ ) {
+                Sink += PdLibGetDefocusRegisteredWindows ( p_Context, Gain[j % D_BENCH_GAIN_NUM],
+                                                           PhaseDiffData, OutputData, Result );
+                Sink += OutputData[j % n].Defocus;
+            }
+            NsRegWindow = ( bench_get_time_ns () - Start ) / (double)( Repeat * n );
+
+            PdLibDestroyContext ( p_Context );
+
+            bench_print_json ( p_Json, "PdLibGetDefocusBatchWithContext", &Condition, -1, NsBatch, First );
+            bench_print_json ( p_Json, "PdLibGetDefocusRegisteredWindows", &Condition, -1, NsRegWindow, First );
+        }
+
+        printf ( "%-16s %2ux%-3u %-9s %-3lu %-8s %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %10.1f %10.1f\n",
+                 "PdLibGetDefocus", Condition.XKnotNum, Condition.YKnotNum, Irregular ? "irregular" : "uniform",
+                 Condition.PointNum, s_ModeName[Mode],
+                 NsPerCall[0], NsPerCall[1], NsPerCall[2], NsPerCall[3], NsPerCall[4],
+                 NsPerCall[5], NsPerCall[6], NsPerCall[7], NsPerCall[8], NsWorst, NsWorst - NsBest, NsBatch, NsRegWindow );
+
+        bench_destroy_calib ( &Calib );
+    }
+    }
+    }
+    }
+
+    /* Footprint of calibration data packed by context for each knot grid */
+    printf ( "%-16s %-6s %-3s %8s %10s %10s %10s %10s\n",
+             "footprint", "grid", "pt", "bits", "knot", "calibknot", "lines", "caliblines" );
+
+    for ( g = 0; g < sizeof(s_KnotNum) / sizeof(s_KnotNum[0]); g++ ) {
+        BenchCondition_t        Condition;
+        BenchCalib_t            Calib;
+        PdLibContext_t          *p_Context;
+        PdLibCalibFootprint_t   Footprint;
+
+        Condition.XKnotNum  = s_KnotNum[g][0];
+        Condition.YKnotNum  = s_KnotNum[g][1];
+        Condition.Irregular = 0;
+        Condition.PointNum  = 8;
+        Condition.Mode      = D_BENCH_MODE_NORMAL;
+
+        if ( bench_create_calib ( &Condition, &Calib ) != 0 ) {
+            fprintf ( stderr, "Cannot allocate calibration data\n" );
+            fclose ( p_Json );
+            return 1;
+        }
+
+        if ( PdLibCreateContext ( &(Calib.CalibData), &p_Context ) != D_PD_LIB_E_OK ) {
+            fprintf ( stderr, "Cannot create context\n" );
+            bench_destroy_calib ( &Calib );
+            fclose ( p_Json );
+            return 1;
+        }
+
+        (void)PdLibGetCalibFootprint ( p_Context, &Footprint );
+
+        printf ( "%-16s %2ux%-3u %-3lu %8lu %10lu %10lu %10lu %10lu\n",
+                 "PdLibCreateContext", Condition.XKnotNum, Condition.YKnotNum, Condition.PointNum,
+                 Footprint.SlopeOffsetBits, Footprint.KnotSize, Footprint.CalibKnotSize, Footprint.LineSize, Footprint.CalibLineSize );
+
+        PdLibDestroyContext ( p_Context );
+        bench_destroy_calib ( &Calib );
+    }
+
+    /* CalcAddressOnBrokenLine_ulXulY() for each number of points */
+    for ( p = 0; p < sizeof(s_PointNum) / sizeof(s_PointNum[0]); p++ ) {
+        BenchCondition_t Condition;
+        unsigned long LineX[D_BENCH_MAX_POINT_NUM];
+        unsigned long LineY[D_BENCH_MAX_POINT_NUM];
+        unsigned long PointX[D_BENCH_GAIN_NUM];
+        unsigned long j;
+        double Start;
+        double NsPerCall;
+
+        for ( j = 0; j < s_PointNum[p]; j++ ) {
+            LineX[j] = j * 256;
+            LineY[j] = 100 + test_rand () % 1000;
+        }
+
+        for ( j = 0; j < D_BENCH_GAIN_NUM; j++ ) {
+            PointX[j] = test_rand () % ( s_PointNum[p] * 256 );
+        }
+
+        Start = bench_get_time_ns ();
+        for ( j = 0; j < CallNum; j++ ) {
+            unsigned long PointY;
+
+            Sink += CalcAddressOnBrokenLine_ulXulY ( LineX, LineY, s_PointNum[p], PointX[j % D_BENCH_GAIN_NUM], &PointY );
+            Sink += (signed long)PointY;
+        }
+        NsPerCall = ( bench_get_time_ns () - Start ) / (double)CallNum;
+
+        Condition.XKnotNum  = 0;
+        Condition.YKnotNum  = 0;
+        Condition.Irregular = 0;
+        Condition.PointNum  = s_PointNum[p];
+        Condition.Mode      = D_BENCH_MODE_NORMAL;
+
+        bench_print_json ( p_Json, "CalcAddressOnBrokenLine_ulXulY", &Condition, -1, NsPerCall, First );
+
+        printf ( "%-30s pt %-3lu %8.1f ns/call %12.0f calls/s\n", "CalcAddressOnBrokenLine_ulXulY",
+                 s_PointNum[p], NsPerCall, 1.0e9 / NsPerCall );
+    }
+
+    /* Latency of kernels of area 0 - 8 and constant time side by side */
+    if ( p_EnginePath[0] != NULL && bench_compare_kernels ( p_EnginePath, CallNum, p_Json ) != 0 ) {
+        fclose ( p_Json );
+        return 1;
+    }
+
+    fprintf ( p_Json, "\n  ]\n}\n" );
+    fclose ( p_Json );
+
+    printf ( "JSON : %s (checksum %ld)\n", p_JsonPath, (signed long)Sink );
+
+    return 0;
+}
+
+/****************************************************************/
+/*                       local function                         */
+/****************************************************************/
+
+/* Function for getting monotonic time in nanoseconds */
+static double bench_get_time_ns ( void )
+{
+#if defined _WIN32
+    LARGE_INTEGER Counter;
+    LARGE_INTEGER Frequency;
+
+    QueryPerformanceCounter ( &Counter );
+    QueryPerformanceFrequency ( &Frequency );
+
+    return (double)Counter.QuadPart * 1.0e9 / (double)Frequency.QuadPart;
+#else
+    struct timespec Time;
+
+    clock_gettime ( CLOCK_MONOTONIC, &Time );
+
+    return (double)Time.tv_sec * 1.0e9 + (double)Time.tv_nsec;
+#endif
+}
+
+/* Function for creating synthetic calibration data */
+static signed char bench_create_calib ( BenchCondition_t *pf_Condition, BenchCalib_t *pf_Calib )
+{
+    unsigned long i;
+    unsigned long j;
+    unsigned long KnotNum;
+    PdLibCalibData_t *p_CalibData;
+
+    memset ( pf_Calib, 0, sizeof(BenchCalib_t) );
+
+    KnotNum = (unsigned long)(*pf_Condition).XKnotNum * (*pf_Condition).YKnotNum;
+
+    (*pf_Calib).p_SlopeData    = (signed long *)malloc ( sizeof(signed long) * KnotNum );
+    (*pf_Calib).p_OffsetData   = (signed long *)malloc ( sizeof(signed long) * KnotNum );
+    (*pf_Calib).p_XAddressKnot = (unsigned short *)malloc ( sizeof(unsigned short) * (*pf_Condition).XKnotNum );
+    (*pf_Calib).p_YAddressKnot = (unsigned short *)malloc ( sizeof(unsigned short) * (*pf_Condition).YKnotNum );
+    (*pf_Calib).p_ThrLine      = (DefocusOKNGThrLine_t *)malloc ( sizeof(DefocusOKNGThrLine_t) * KnotNum );
+    (*pf_Calib).p_ThrLineData  = (unsigned long *)malloc ( sizeof(unsigned long) * KnotNum * (*pf_Condition).PointNum * 2 );
+
+    if ( (*pf_Calib).p_SlopeData == NULL || (*pf_Calib).p_OffsetData == NULL ||
+         (*pf_Calib).p_XAddressKnot == NULL || (*pf_Calib).p_YAddressKnot == NULL ||
+         (*pf_Calib).p_ThrLine == NULL || (*pf_Calib).p_ThrLineData == NULL ) {
+        bench_destroy_calib ( pf_Calib );
+        return -1;
+    }
+
+    test_set_knot ( (*pf_Condition).XKnotNum, D_BENCH_X_SIZE_OF_IMAGE, (*pf_Condition).Irregular, (*pf_Calib).p_XAddressKnot );
+    test_set_knot ( (*pf_Condition).YKnotNum, D_BENCH_Y_SIZE_OF_IMAGE, (*pf_Condition).Irregular, (*pf_Calib).p_YAddressKnot );
+
+    for ( i = 0; i < KnotNum; i++ ) {
+        unsigned long *p_Data;
+
+        (*pf_Calib).p_SlopeData[i]  = 1000 + (signed long)( test_rand () % 2000 );
+        (*pf_Calib).p_OffsetData[i] = (signed long)( test_rand () % 2000 ) - 1000;
+
+        p_Data = &((*pf_Calib).p_ThrLineData[i * (*pf_Condition).PointNum * 2]);
+
+        (*pf_Calib).p_ThrLine[i].PointNum     = (*pf_Condition).PointNum;
+        (*pf_Calib).p_ThrLine[i].p_AnalogGain = p_Data;
+        (*pf_Calib).p_ThrLine[i].p_Confidence = p_Data + (*pf_Condition).PointNum;
+
+        for ( j = 0; j < (*pf_Condition).PointNum; j++ ) {
+            (*pf_Calib).p_ThrLine[i].p_AnalogGain[j] = j * 256;
+            (*pf_Calib).p_ThrLine[i].p_Confidence[j] = 100 + test_rand () % 1000;
+        }
+    }
+
+    p_CalibData = &((*pf_Calib).CalibData);
+
+    (*p_CalibData).XSizeOfImage              = D_BENCH_X_SIZE_OF_IMAGE;
+    (*p_CalibData).YSizeOfImage              = D_BENCH_Y_SIZE_OF_IMAGE;
+    (*p_CalibData).XKnotNumSlopeOffset       = (*pf_Condition).XKnotNum;
+    (*p_CalibData).YKnotNumSlopeOffset       = (*pf_Condition).YKnotNum;
+    (*p_CalibData).p_SlopeData               = (*pf_Calib).p_SlopeData;
+    (*p_CalibData).p_OffsetData              = (*pf_Calib).p_OffsetData;
+    (*p_CalibData).p_XAddressKnotSlopeOffset = (*pf_Calib).p_XAddressKnot;
+    (*p_CalibData).p_YAddressKnotSlopeOffset = (*pf_Calib).p_YAddressKnot;
+    (*p_CalibData).AdjCoeffSlope             = D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE0;
+    (*p_CalibData).p_DefocusOKNGThrLine      = (*pf_Calib).p_ThrLine;
+    (*p_CalibData).DensityOfPhasePix         = D_PD_LIB_DENSITY_SENS_MODE0;
+
+    if ( (*pf_Condition).Mode == D_BENCH_MODE_NCW ) {       /* Confidence judgement disabled */
+        (*p_CalibData).XKnotNumDefocusOKNG       = 0;
+        (*p_CalibData).YKnotNumDefocusOKNG       = 0;
+        (*p_CalibData).p_XAddressKnotDefocusOKNG = NULL;
+        (*p_CalibData).p_YAddressKnotDefocusOKNG = NULL;
+    } else {                                                /* Same knots as slope and offset */
+        (*p_CalibData).XKnotNumDefocusOKNG       = (*pf_Condition).XKnotNum;
+        (*p_CalibData).YKnotNumDefocusOKNG       = (*pf_Condition).YKnotNum;
+        (*p_CalibData).p_XAddressKnotDefocusOKNG = (*pf_Calib).p_XAddressKnot;
+        (*p_CalibData).p_YAddressKnotDefocusOKNG = (*pf_Calib).p_YAddressKnot;
+    }
+
+    return 0;
+}
+
+/* Function for releasing synthetic calibration data */
+static void bench_destroy_calib ( BenchCalib_t *pf_Calib )
+{
+    free ( (*pf_Calib).p_SlopeData );
+    free ( (*pf_Calib).p_OffsetData );
+    free ( (*pf_Calib).p_XAddressKnot );
+    free ( (*pf_Calib).p_YAddressKnot );
+    free ( (*pf_Calib).p_ThrLine );
+    free ( (*pf_Calib).p_ThrLineData );
+
+    return ;
+}
+
+/* Function for setting a PDAF window whose center is in the area */
+static void bench_set_window ( BenchCalib_t *pf_Calib, unsigned char f_AreaIndex, PdLibWindow_t *pf_Window )
+{
+    PdLibCalibData_t *p_CalibData;
+    unsigned long Low[2];
+    unsigned long High[2];
+    unsigned long Center[2];
+    unsigned long Size[2];
+    unsigned short *p_Knot[2];
+    unsigned short KnotNum[2];
+    unsigned char Column[2];
+    unsigned long k;
+
+    p_CalibData = &((*pf_Calib).CalibData);
+
+    Size[0]    = (*p_CalibData).XSizeOfImage;
+    Size[1]    = (*p_CalibData).YSizeOfImage;
+    p_Knot[0]  = (*p_CalibData).p_XAddressKnotSlopeOffset;
+    p_Knot[1]  = (*p_CalibData).p_YAddressKnotSlopeOffset;
+    KnotNum[0] = (*p_CalibData).XKnotNumSlopeOffset;
+    KnotNum[1] = (*p_CalibData).YKnotNumSlopeOffset;
+    Column[0]  = f_AreaIndex % 3;                           /* 0 : before knots, 1 : in knots, 2 : after knots */
+    Column[1]  = f_AreaIndex / 3;
+
+    for ( k = 0; k < 2; k++ ) {
+        if ( Column[k] == 0 ) {
+            Low[k]  = D_BENCH_WINDOW_SIZE / 2;
+            High[k] = p_Knot[k][0] - 1;
+        } else if ( Column[k] == 1 ) {
+            Low[k]  = p_Knot[k][0];
+            High[k] = p_Knot[k][KnotNum[k]-1];
+        } else {
+            Low[k]  = p_Knot[k][KnotNum[k]-1] + 1;
+            High[k] = Size[k] - 1 - D_BENCH_WINDOW_SIZE / 2;
+        }
+
+        Center[k] = Low[k] + test_rand () % ( High[k] - Low[k] + 1 );
+    }
+
+    (*pf_Window).XAddressOfWindowStart = (unsigned short)( Center[0] - D_BENCH_WINDOW_SIZE / 2 );
+    (*pf_Window).XAddressOfWindowEnd   = (unsigned short)( Center[0] + D_BENCH_WINDOW_SIZE / 2 );
+    (*pf_Window).YAddressOfWindowStart = (unsigned short)( Center[1] - D_BENCH_WINDOW_SIZE / 2 );
+    (*pf_Window).YAddressOfWindowEnd   = (unsigned short)( Center[1] + D_BENCH_WINDOW_SIZE / 2 );
+
+    return ;
+}
+
+/* Function for setting input data structure of PdLibGetDefocus() */
+static void bench_set_input ( BenchCalib_t *pf_Calib, PdLibWindow_t *pf_Window, PdLibPhaseDiffData_t *pf_PhaseDiffData, unsigned long f_ImagerAnalogGain, PdLibInputData_t *pf_InputData )
+{
+    PdLibCalibData_t *p_CalibData;
+
+    p_CalibData = &((*pf_Calib).CalibData);
+
+    (*pf_InputData).PhaseDifference           = (*pf_PhaseDiffData).PhaseDifference;
+    (*pf_InputData).ConfidenceLevel           = (*pf_PhaseDiffData).ConfidenceLevel;
+    (*pf_InputData).XSizeOfImage              = (*p_CalibData).XSizeOfImage;
+    (*pf_InputData).YSizeOfImage              = (*p_CalibData).YSizeOfImage;
+    (*pf_InputData).XAddressOfWindowStart     = (*pf_Window).XAddressOfWindowStart;
+    (*pf_InputData).YAddressOfWindowStart     = (*pf_Window).YAddressOfWindowStart;
+    (*pf_InputData).XAddressOfWindowEnd       = (*pf_Window).XAddressOfWindowEnd;
+    (*pf_InputData).YAddressOfWindowEnd       = (*pf_Window).YAddressOfWindowEnd;
+    (*pf_InputData).XKnotNumSlopeOffset       = (*p_CalibData).XKnotNumSlopeOffset;
+    (*pf_InputData).YKnotNumSlopeOffset       = (*p_CalibData).YKnotNumSlopeOffset;
+    (*pf_InputData).p_SlopeData               = (*p_CalibData).p_SlopeData;
+    (*pf_InputData).p_OffsetData              = (*p_CalibData).p_OffsetData;
+    (*pf_InputData).p_XAddressKnotSlopeOffset = (*p_CalibData).p_XAddressKnotSlopeOffset;
+    (*pf_InputData).p_YAddressKnotSlopeOffset = (*p_CalibData).p_YAddressKnotSlopeOffset;
+    (*pf_InputData).AdjCoeffSlope             = (*p_CalibData).AdjCoeffSlope;
+    (*pf_InputData).ImagerAnalogGain          = f_ImagerAnalogGain;
+    (*pf_InputData).XKnotNumDefocusOKNG       = (*p_CalibData).XKnotNumDefocusOKNG;
+    (*pf_InputData).YKnotNumDefocusOKNG       = (*p_CalibData).YKnotNumDefocusOKNG;
+    (*pf_InputData).p_DefocusOKNGThrLine      = (*p_CalibData).p_DefocusOKNGThrLine;
+    (*pf_InputData).p_XAddressKnotDefocusOKNG = (*p_CalibData).p_XAddressKnotDefocusOKNG;
+    (*pf_InputData).p_YAddressKnotDefocusOKNG = (*p_CalibData).p_YAddressKnotDefocusOKNG;
+    (*pf_InputData).DensityOfPhasePix         = (*p_CalibData).DensityOfPhasePix;
+
+    return ;
+}
+
+/* Function for writing a result as JSON object */
+static void bench_print_json ( FILE *pf_File, const char *pf_Api, BenchCondition_t *pf_Condition, signed long f_AreaIndex, double f_NsPerCall, unsigned char f_First )
+{
+    static const char *s_ModeName[] = { "normal", "ncw", "pderror" };
+
+    fprintf ( pf_File, "%s    { \"api\": \"%s\", \"x_knot_num\": %u, \"y_knot_num\": %u, \"pitch\": \"%s\", "
+                       "\"point_num\": %lu, \"mode\": \"%s\", \"area\": ",
+              f_First ? "" : ",\n", pf_Api, (*pf_Condition).XKnotNum, (*pf_Condition).YKnotNum,
+              (*pf_Condition).Irregular ? "irregular" : "uniform", (*pf_Condition).PointNum, s_ModeName[(*pf_Condition).Mode] );
+
+    if ( 0 <= f_AreaIndex ) {
+        fprintf ( pf_File, "%ld", f_AreaIndex );
+    } else {
+        fprintf ( pf_File, "null" );                        /* All areas */
+    }
+
+    fprintf ( pf_File, ", \"ns_per_call\": %.2f, \"calls_per_sec\": %.0f }", f_NsPerCall, 1.0e9 / f_NsPerCall );
+
+    return ;
+}
+
+/* Function for loading PDAF Library from a shared library. Symbols are resolved locally, so that */
+/* libraries do not interpose each other. */
+static signed char bench_load_engine ( const char *pf_Path, BenchEngine_t *pf_Engine )
+{
+    memset ( pf_Engine, 0, sizeof(BenchEngine_t) );
+
+#if defined _WIN32
+    fprintf ( stderr, "Cannot load %s : not supported\n", pf_Path );
+
+    return -1;
+#else
+    (*pf_Engine).p_Handle = dlopen ( pf_Path, RTLD_NOW | RTLD_LOCAL );
+
+    if ( (*pf_Engine).p_Handle == NULL ) {
+        fprintf ( stderr, "Cannot load %s : %s\n", pf_Path, dlerror () );
+        return -1;
+    }
+
+    *(void **)(&(*pf_Engine).p_GetDefocus)                  = dlsym ( (*pf_Engine).p_Handle, "PdLibGetDefocus" );
+    *(void **)(&(*pf_Engine).p_CreateContext)               = dlsym ( (*pf_Engine).p_Handle, "PdLibCreateContext" );
+    *(void **)(&(*pf_Engine).p_ValidateContext)             = dlsym ( (*pf_Engine).p_Handle, "PdLibValidateContext" );
+    *(void **)(&(*pf_Engine).p_DestroyContext)              = dlsym ( (*pf_Engine).p_Handle, "PdLibDestroyContext" );
+    *(void **)(&(*pf_Engine).p_RegisterWindows)             = dlsym ( (*pf_Engine).p_Handle, "PdLibRegisterWindows" );
+    *(void **)(&(*pf_Engine).p_GetDefocusBatchWithContext)  = dlsym ( (*pf_Engine).p_Handle, "PdLibGetDefocusBatchWithContext" );
+
+    if ( (*pf_Engine).p_GetDefocus == NULL || (*pf_Engine).p_CreateContext == NULL ||
+         (*pf_Engine).p_ValidateContext == NULL || (*pf_Engine).p_DestroyContext == NULL ||
+         (*pf_Engine).p_RegisterWindows == NULL || (*pf_Engine).p_GetDefocusBatchWithContext == NULL ) {
+        fprintf ( stderr, "Cannot find APIs in %s\n", pf_Path );
+        dlclose ( (*pf_Engine).p_Handle );
+        (*pf_Engine).p_Handle = NULL;
+        return -1;
+    }
+
+    return 0;
+#endif
+}
+
+/* Function for unloading PDAF Library loaded by bench_load_engine() */
+static void bench_unload_engine ( BenchEngine_t *pf_Engine )
+{
+#if !defined _WIN32
+    if ( (*pf_Engine).p_Handle != NULL ) {
+        dlclose ( (*pf_Engine).p_Handle );
+    }
+#endif
+
+    (*pf_Engine).p_Handle = NULL;
+
+    return ;
+}
+
+/* Function for measuring latency of the kernels of area 0 - 8 and constant time side by side */
+/* Both kernels evaluate the same windows of all areas with the same analog gains, and the worst */
+/* area, tail and maximum of time per call of PdLibGetDefocus() are printed for each kernel. */
+static signed char bench_compare_kernels ( const char **ppf_EnginePath, unsigned long f_CallNum, FILE *pf_File )
+{
+    static const unsigned short s_KnotNum[][2]                  = { { 2, 2 }, { 8, 6 }, { 16, 12 }, { 32, 24 } };
+    static const unsigned long  s_PointNum[]                    = { 8, D_BENCH_MAX_POINT_NUM };
+    static const char           *s_KernelName[D_BENCH_KERNEL_NUM] = { "area", "constant_time" };
+
+    BenchEngine_t   Engine[D_BENCH_KERNEL_NUM];
+    double          *p_Latency;
+    signed char     ret;
+    unsigned long   g;
+    unsigned long   p;
+    unsigned long   k;
+    unsigned char   Irregular;
+
+    ret = 0;
+
+    for ( k = 0; k < D_BENCH_KERNEL_NUM; k++ ) {
+        if ( bench_load_engine ( ppf_EnginePath[k], &(Engine[k]) ) != 0 ) {
+            while ( 0 < k ) {
+                bench_unload_engine ( &(Engine[--k]) );
+            }
+            return -1;
+        }
+    }
+
+    p_Latency = (double *)malloc ( sizeof(double) * D_BENCH_AREA_NUM * f_CallNum );
+
+    if ( p_Latency == NULL ) {
+        fprintf ( stderr, "Cannot allocate latency\n" );
+        bench_unload_engine ( &(Engine[0]) );
+        bench_unload_engine ( &(Engine[1]) );
+        return -1;
+    }
+
+    printf ( "%-16s %-6s %-9s %-3s %10s %10s %10s %10s %10s %10s %10s %10s\n",
+             "latency ns", "grid", "pitch", "pt",
+             "area:worst", "p99", "max", "batch/win", "const:worst", "p99", "max", "batch/win" );
+
+    for ( g = 0; g < sizeof(s_KnotNum) / sizeof(s_KnotNum[0]) && ret == 0; g++ ) {
+    for ( Irregular = 0; Irregular <= 1 && ret == 0; Irregular++ ) {
+    for ( p = 0; p < sizeof(s_PointNum) / sizeof(s_PointNum[0]) && ret == 0; p++ ) {
+        BenchCondition_t        Condition;
+        BenchCalib_t            Calib;
+        PdLibWindow_t           Window[D_BENCH_AREA_NUM * D_BENCH_WINDOW_NUM];
+        PdLibPhaseDiffData_t    PhaseDiffData[D_BENCH_AREA_NUM * D_BENCH_WINDOW_NUM];
+        unsigned long           Gain[D_BENCH_GAIN_NUM];
+        BenchLatency_t          Latency[D_BENCH_KERNEL_NUM];
+        unsigned long           j;
+
+        Condition.XKnotNum  = s_KnotNum[g][0];
+        Condition.YKnotNum  = s_KnotNum[g][1];
+        Condition.Irregular = Irregular;
+        Condition.PointNum  = s_PointNum[p];
+        Condition.Mode      = D_BENCH_MODE_NORMAL;
+
+        if ( bench_create_calib ( &Condition, &Calib ) != 0 ) {
+            fprintf ( stderr, "Cannot allocate calibration data\n" );
+            ret = -1;
+            break ;
+        }
+
+        for ( j = 0; j < D_BENCH_AREA_NUM * D_BENCH_WINDOW_NUM; j++ ) {
+            bench_set_window ( &Calib, (unsigned char)( j / D_BENCH_WINDOW_NUM ), &(Window[j]) );
+
+            PhaseDiffData[j].PhaseDifference = (signed long)( test_rand () % 4096 ) - 2048;
+            PhaseDiffData[j].ConfidenceLevel = test_rand () % 2048;
+        }
+
+        for ( j = 0; j < D_BENCH_GAIN_NUM; j++ ) {
+            Gain[j] = test_rand () % ( Condition.PointNum * 256 );
+        }
+
+        for ( k = 0; k < D_BENCH_KERNEL_NUM && ret == 0; k++ ) {
+            ret = bench_measure_kernel ( &(Engine[k]), &Calib, Window, PhaseDiffData, Gain, f_CallNum, p_Latency, &(Latency[k]) );
+        }
+
+        bench_destroy_calib ( &Calib );
+
+        if ( ret != 0 ) {
+            break ;
+        }
+
+        printf ( "%-16s %2ux%-3u %-9s %-3lu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                 "PdLibGetDefocus", Condition.XKnotNum, Condition.YKnotNum, Irregular ? "irregular" : "uniform", Condition.PointNum,
+                 Latency[0].NsWorst, Latency[0].NsTail, Latency[0].NsMax, Latency[0].NsBatch,
+                 Latency[1].NsWorst, Latency[1].NsTail, Latency[1].NsMax, Latency[1].NsBatch );
+
+        for ( k = 0; k < D_BENCH_KERNEL_NUM; k++ ) {
+            fprintf ( pf_File, ",\n    { \"api\": \"PdLibGetDefocus\", \"kernel\": \"%s\", \"x_knot_num\": %u, \"y_knot_num\": %u, "
+                               "\"pitch\": \"%s\", \"point_num\": %lu, \"ns_worst_area\": %.2f, \"ns_p%u\": %.2f, \"ns_max\": %.2f, "
+                               "\"ns_batch_per_window\": %.2f }",
+                      s_KernelName[k], Condition.XKnotNum, Condition.YKnotNum, Irregular ? "irregular" : "uniform", Condition.PointNum,
+                      Latency[k].NsWorst, D_BENCH_TAIL_PERMILLE / 10, Latency[k].NsTail, Latency[k].NsMax, Latency[k].NsBatch );
+        }
+    }
+    }
+    }
+
+    free ( p_Latency );
+    bench_unload_engine ( &(Engine[0]) );
+    bench_unload_engine ( &(Engine[1]) );
+
+    return ret;
+}
+
+/* Function for measuring latency of a kernel. Each call of PdLibGetDefocus() is timed, */
+/* so time of a call includes reading the clock, which is the same for both kernels. */
+static signed char bench_measure_kernel ( BenchEngine_t *pf_Engine, BenchCalib_t *pf_Calib, PdLibWindow_t *pf_Window, PdLibPhaseDiffData_t *pf_PhaseDiffData, unsigned long *pf_Gain, unsigned long f_CallNum, double *pf_Latency, BenchLatency_t *pf_Result )
+{
+    PdLibContext_t          *p_Context;
+    PdLibOutputData_t       OutputData[D_BENCH_AREA_NUM * D_BENCH_WINDOW_NUM];
+    signed long             Result[D_BENCH_AREA_NUM * D_BENCH_WINDOW_NUM];
+    unsigned long           LatencyNum;
+    unsigned long           Repeat;
+    unsigned long           n;
+    unsigned long           j;
+    unsigned char           a;
+    double                  Start;
+    volatile signed long    Sink;
+
+    Sink       = 0;
+    LatencyNum = 0;
+
+    (*pf_Result).NsWorst = 0.0;
+
+    for ( a = 0; a < D_BENCH_AREA_NUM; a++ ) {
+        PdLibInputData_t InputData[D_BENCH_WINDOW_NUM];
+        double Sum;
+
+        for ( j = 0; j < D_BENCH_WINDOW_NUM; j++ ) {
+            n = a * D_BENCH_WINDOW_NUM + j;
+            bench_set_input ( pf_Calib, &(pf_Window[n]), &(pf_PhaseDiffData[n]), pf_Gain[j], &(InputData[j]) );
+        }
+
+        Sum = 0.0;
+
+        for ( j = 0; j < f_CallNum; j++ ) {
+            PdLibOutputData_t Out;
+
+            Start = bench_get_time_ns ();
+            Sink += (*(*pf_Engine).p_GetDefocus) ( &(InputData[j % D_BENCH_WINDOW_NUM]), &Out );
+            pf_Latency[LatencyNum] = bench_get_time_ns () - Start;
+            Sink += Out.Defocus;
+
+            Sum += pf_Latency[LatencyNum];
+            LatencyNum++;
+        }
+
+        if ( (*pf_Result).NsWorst < Sum / (double)f_CallNum ) {
+            (*pf_Result).NsWorst = Sum / (double)f_CallNum;
+        }
+    }
+
+    qsort ( pf_Latency, LatencyNum, sizeof(double), bench_compare_ns );
+
+    (*pf_Result).NsTail = pf_Latency[( LatencyNum - 1 ) * D_BENCH_TAIL_PERMILLE / 1000];
+    (*pf_Result).NsMax  = pf_Latency[LatencyNum - 1];
+
+    /* PdLibGetDefocusBatchWithContext() for windows of all areas */
+    n      = D_BENCH_AREA_NUM * D_BENCH_WINDOW_NUM;
+    Repeat = f_CallNum / n + 1;
+
+    if ( (*(*pf_Engine).p_CreateContext) ( &((*pf_Calib).CalibData), &p_Context ) != D_PD_LIB_E_OK ) {
+        fprintf ( stderr, "Cannot create context\n" );
+        return -1;
+    }
+
+    (void)(*(*pf_Engine).p_ValidateContext) ( p_Context );
+    (void)(*(*pf_Engine).p_RegisterWindows) ( p_Context, n, pf_Window );
+
+    Start = bench_get_time_ns ();
+    for ( j = 0; j < Repeat; j++ ) {
+        Sink += (*(*pf_Engine).p_GetDefocusBatchWithContext) ( p_Context, pf_Gain[j % D_BENCH_GAIN_NUM], n,
+                                                               pf_Window, pf_PhaseDiffData, OutputData, Result );
+        Sink += OutputData[j % n].Defocus;
+    }
+    (*pf_Result).NsBatch = ( bench_get_time_ns () - Start ) / (double)( Repeat * n );
+
+    (*(*pf_Engine).p_DestroyContext) ( p_Context );
+
+    return 0;
+}
+
+/* Function for comparing time of calls for qsort() */
+static int bench_compare_ns ( const void *pf_A, const void *pf_B )
+{
+    double A;
+    double B;
+
+    A = *(const double *)pf_A;
+    B = *(const double *)pf_B;
+
+    return ( A < B ) ? -1 : ( ( B < A ) ? 1 : 0 );
+}
@@ -0,0 +1,564 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/****************************************************************/
+/*                          include                             */
+/****************************************************************/
+
+#if ( defined __unix__ || defined __APPLE__ ) && !defined _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L                     /* For mmap() */
+#endif
+
+#include "PdafCalibImage.h"
+
+#if defined __unix__ || defined __APPLE__
+#define D_CALIB_IMAGE_MMAP                          /* Map file with mmap() */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <stdio.h>
+#endif
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/****************************************************************/
+/*                 local function declaration                   */
+/****************************************************************/
+
+static unsigned long calib_image_align ( unsigned long f_Size );
+static unsigned long calib_image_calc_line_num ( PdLibCalibData_t *pf_CalibData );
+static unsigned long calib_image_calc_mode_size ( PdLibCalibData_t *pf_CalibData );
+static unsigned long calib_image_calc_checksum ( const unsigned char *pf_Data, unsigned long f_Size );
+static signed char calib_image_check_table ( unsigned long f_Size, unsigned long f_Pos, unsigned long f_Num, unsigned long f_ElementSize );
+static unsigned long calib_image_write_table ( unsigned char *pf_Image, unsigned long f_Pos, const void *pf_Data, unsigned long f_DataSize );
+
+/****************************************************************/
+/*                      external function                       */
+/****************************************************************/
+
+/* Function for calculating size of image of calibration data of f_ModeNum sensor modes */
+extern signed char CalibImageCalcSize
+(
+    /* Input */
+    unsigned long f_ModeNum,
+    PdLibCalibData_t *pf_CalibData,
+    /* Output */
+    unsigned long *pf_Size
+)
+{
+    unsigned long i;
+    double Size;                                            /* Not overflowed before comparison with 32 bit */
+
+    (*pf_Size) = 0;
+
+    Size = (double)calib_image_align ( sizeof(CalibImageHeader_t) ) +
+           (double)calib_image_align ( sizeof(CalibImageMode_t) * f_ModeNum );
+
+    for ( i = 0; i < f_ModeNum; i++ ) {
+        if ( pf_CalibData[i].p_DefocusOKNGThrLine == NULL ) {   /* First line is checked by PDAF Library */
+            return D_CALIB_IMAGE_NG;
+        }
+
+        Size += (double)calib_image_calc_mode_size ( &(pf_CalibData[i]) );
+    }
+
+    if ( 4294967295.0 < Size ) {                            /* FileSize is 32 bit */
+        return D_CALIB_IMAGE_NG;
+    }
+
+    (*pf_Size) = (unsigned long)Size;
+
+    return D_CALIB_IMAGE_OK;
+}
+
+/* Function for writing image of calibration data of f_ModeNum sensor modes */
+extern signed char CalibImageWrite
+(
+    /* Input */
+    unsigned long f_ModeNum,
+    PdLibCalibData_t *pf_CalibData,
+    unsigned long *pf_SensorMode,
+    unsigned long f_Size,
+    /* Output */
+    void *pf_Image
+)
+{
+    unsigned long i;
+    unsigned long j;
+    unsigned long Size;
+    unsigned long Pos;
+    unsigned char *p_Image;
+    CalibImageHeader_t Header;
+
+    if ( CalibImageCalcSize ( f_ModeNum, pf_CalibData, &Size ) != D_CALIB_IMAGE_OK ) {
+        return D_CALIB_IMAGE_NG;
+    }
+
+    if ( f_Size < Size || ( (size_t)pf_Image % D_CALIB_IMAGE_ALIGN ) != 0 ) {
+        return D_CALIB_IMAGE_NG;
+    }
+
+    p_Image = (unsigned char *)pf_Image;
+
+    memset ( p_Image, 0, Size );                            /* Padding is 0 */
+
+    Pos = calib_image_align ( sizeof(CalibImageHeader_t) ) + calib_image_align ( sizeof(CalibImageMode_t) * f_ModeNum );
+
+    for ( i = 0; i < f_ModeNum; i++ ) {
+        PdLibCalibData_t *p_CalibData;
+        CalibImageMode_t Mode;
+        unsigned long KnotNum;
+
+        p_CalibData = &(pf_CalibData[i]);
+        KnotNum = (unsigned long)(*p_CalibData).XKnotNumSlopeOffset * (*p_CalibData).YKnotNumSlopeOffset;
+
+        memset ( &Mode, 0, sizeof(Mode) );
+
+        Mode.SensorMode          = (unsigned int)pf_SensorMode[i];
+        Mode.XSizeOfImage        = (*p_CalibData).XSizeOfImage;
+        Mode.YSizeOfImage        = (*p_CalibData).YSizeOfImage;
+        Mode.XKnotNumSlopeOffset = (*p_CalibData).XKnotNumSlopeOffset;
+        Mode.YKnotNumSlopeOffset = (*p_CalibData).YKnotNumSlopeOffset;
+        Mode.XKnotNumDefocusOKNG = (*p_CalibData).XKnotNumDefocusOKNG;
+        Mode.YKnotNumDefocusOKNG = (*p_CalibData).YKnotNumDefocusOKNG;
+        Mode.AdjCoeffSlope       = (signed int)(*p_CalibData).AdjCoeffSlope;
+        Mode.DensityOfPhasePix   = (unsigned int)(*p_CalibData).DensityOfPhasePix;
+        Mode.LineNum             = (unsigned int)calib_image_calc_line_num ( p_CalibData );
+
+        Mode.SlopePos = (unsigned int)Pos;
+        Pos = calib_image_write_table ( p_Image, Pos, (*p_CalibData).p_SlopeData, sizeof(signed long) * KnotNum );
+
+        Mode.OffsetPos = (unsigned int)Pos;
+        Pos = calib_image_write_table ( p_Image, Pos, (*p_CalibData).p_OffsetData, sizeof(signed long) * KnotNum );
+
+        Mode.ThrDataPos = (unsigned int)Pos;
+        for ( j = 0; j < Mode.LineNum; j++ ) {
+            DefocusOKNGThrLine_t *p_Line;
+
+            p_Line = &((*p_CalibData).p_DefocusOKNGThrLine[j]);
+
+            memcpy ( &(p_Image[Pos]), (*p_Line).p_AnalogGain, sizeof(unsigned long) * (*p_Line).PointNum );
+            Pos += sizeof(unsigned long) * (*p_Line).PointNum;
+            memcpy ( &(p_Image[Pos]), (*p_Line).p_Confidence, sizeof(unsigned long) * (*p_Line).PointNum );
+            Pos += sizeof(unsigned long) * (*p_Line).PointNum;
+        }
+        Pos = calib_image_align ( Pos );
+
+        Mode.ThrPointNumPos = (unsigned int)Pos;
+        for ( j = 0; j < Mode.LineNum; j++ ) {
+            unsigned int PointNum;
+
+            PointNum = (unsigned int)(*p_CalibData).p_DefocusOKNGThrLine[j].PointNum;
+            memcpy ( &(p_Image[Pos]), &PointNum, sizeof(PointNum) );
+            Pos += sizeof(PointNum);
+        }
+        Pos = calib_image_align ( Pos );
+
+        Mode.XKnotSlopeOffsetPos = (unsigned int)Pos;
+        Pos = calib_image_write_table ( p_Image, Pos, (*p_CalibData).p_XAddressKnotSlopeOffset,
+                                        sizeof(unsigned short) * Mode.XKnotNumSlopeOffset );
+
+        Mode.YKnotSlopeOffsetPos = (unsigned int)Pos;
+        Pos = calib_image_write_table ( p_Image, Pos, (*p_CalibData).p_YAddressKnotSlopeOffset,
+                                        sizeof(unsigned short) * Mode.YKnotNumSlopeOffset );
+
+        Mode.XKnotDefocusOKNGPos = (unsigned int)Pos;
+        Pos = calib_image_write_table ( p_Image, Pos, (*p_CalibData).p_XAddressKnotDefocusOKNG,
+                                        sizeof(unsigned short) * Mode.XKnotNumDefocusOKNG );
+
+        Mode.YKnotDefocusOKNGPos = (unsigned int)Pos;
+        Pos = calib_image_write_table ( p_Image, Pos, (*p_CalibData).p_YAddressKnotDefocusOKNG,
+                                        sizeof(unsigned short) * Mode.YKnotNumDefocusOKNG );
+
+        memcpy ( &(p_Image[calib_image_align ( sizeof(CalibImageHeader_t) ) + sizeof(CalibImageMode_t) * i]), &Mode, sizeof(Mode) );
+    }
+
+    Header.Magic        = D_CALIB_IMAGE_MAGIC;
+    Header.MajorVersion = D_CALIB_IMAGE_MAJOR_VERSION;
+    Header.MinorVersion = D_CALIB_IMAGE_MINOR_VERSION;
+    Header.LongSize     = (unsigned short)sizeof(signed long);
+    Header.HeaderSize   = (unsigned short)sizeof(CalibImageHeader_t);
+    Header.ModeNum      = (unsigned int)f_ModeNum;
+    Header.FileSize     = (unsigned int)Size;
+    Header.Checksum     = (unsigned int)calib_image_calc_checksum ( &(p_Image[sizeof(CalibImageHeader_t)]),
+                                                                    Size - sizeof(CalibImageHeader_t) );
+
+    memcpy ( p_Image, &Header, sizeof(Header) );
+
+    return D_CALIB_IMAGE_OK;
+}
+
+/* Function for checking header, alignment and checksum of image */
+extern signed char CalibImageCheck
+(
+    /* Input */
+    const void *pf_Image,
+    unsigned long f_Size
+)
+{
+    const CalibImageHeader_t *p_Header;
+
+    if ( pf_Image == NULL || ( (size_t)pf_Image % D_CALIB_IMAGE_ALIGN ) != 0 || f_Size < sizeof(CalibImageHeader_t) ) {
+        return D_CALIB_IMAGE_NG;
+    }
+
+    p_Header = (const CalibImageHeader_t *)pf_Image;
+
+    if ( (*p_Header).Magic        != D_CALIB_IMAGE_MAGIC ||
+         (*p_Header).MajorVersion != D_CALIB_IMAGE_MAJOR_VERSION ||
+         (*p_Header).LongSize     != sizeof(signed long) ||
+         (*p_Header).HeaderSize   <  sizeof(CalibImageHeader_t) ||
+         (*p_Header).FileSize     <  (*p_Header).HeaderSize ||
+         (*p_Header).FileSize     >  f_Size ) {
+        return D_CALIB_IMAGE_NG;
+    }
+
+    if ( calib_image_calc_checksum ( (const unsigned char *)pf_Image + (*p_Header).HeaderSize,
+                                     (*p_Header).FileSize - (*p_Header).HeaderSize ) != (*p_Header).Checksum ) {
+        return D_CALIB_IMAGE_NG;
+    }
+
+    return D_CALIB_IMAGE_OK;
+}
+
+/* Function for getting calibration data of a sensor mode which points to the tables of image */
+extern signed char CalibImageGetMode
+(
+    /* Input */
+    const void *pf_Image,
+    unsigned long f_Size,
+    unsigned long f_SensorMode,
+    /* Output */
+    PdLibCalibData_t *pf_CalibData,
+    DefocusOKNGThrLine_t *pf_ThrLine,
+    unsigned long *pf_LineNum
+)
+{
+    unsigned long i;
+    unsigned long Size;
+    unsigned long KnotNum;
+    unsigned long DataNum;
+    unsigned char *p_Image;
+    const CalibImageHeader_t *p_Header;
+    const CalibImageMode_t *p_Mode;
+    const unsigned int *p_PointNum;
+    unsigned long *p_ThrData;
+
+    (*pf_LineNum) = 0;
+
+    if ( pf_Image == NULL || ( (size_t)pf_Image % D_CALIB_IMAGE_ALIGN ) != 0 || f_Size < sizeof(CalibImageHeader_t) ) {
+        return D_CALIB_IMAGE_NG;
+    }
+
+    p_Image  = (unsigned char *)pf_Image;                   /* Tables are not written by PDAF Library */
+    p_Header = (const CalibImageHeader_t *)pf_Image;
+    Size     = (*p_Header).FileSize;
+
+    if ( (*p_Header).Magic        != D_CALIB_IMAGE_MAGIC ||
+         (*p_Header).MajorVersion != D_CALIB_IMAGE_MAJOR_VERSION ||
+         (*p_Header).LongSize     != sizeof(signed long) ||
+         (*p_Header).HeaderSize   <  sizeof(CalibImageHeader_t) ||
+         Size > f_Size ||
+         calib_image_check_table ( Size, calib_image_align ( (*p_Header).HeaderSize ),
+                                   (*p_Header).ModeNum, sizeof(CalibImageMode_t) ) != D_CALIB_IMAGE_OK ) {
+        return D_CALIB_IMAGE_NG;
+    }
+
+    /* Search sensor mode */
+    p_Mode = (const CalibImageMode_t *)( p_Image + calib_image_align ( (*p_Header).HeaderSize ) );
+
+    for ( i = 0; i < (*p_Header).ModeNum; i++, p_Mode++ ) {
+        if ( (*p_Mode).SensorMode == f_SensorMode ) {
+            break ;
+        }
+    }
+
+    if ( i == (*p_Header).ModeNum ) {                       /* Sensor mode is not found */
+        return D_CALIB_IMAGE_NG;
+    }
+
+    KnotNum = (unsigned long)(*p_Mode).XKnotNumSlopeOffset * (*p_Mode).YKnotNumSlopeOffset;
+
+    /* Check number of threshold lines and position of tables */
+    if ( (*p_Mode).LineNum != ( ( (*p_Mode).XKnotNumDefocusOKNG * (*p_Mode).YKnotNumDefocusOKNG != 0 ) ?
+                                (unsigned long)(*p_Mode).XKnotNumDefocusOKNG * (*p_Mode).YKnotNumDefocusOKNG : 1 ) ||
+         calib_image_check_table ( Size, (*p_Mode).SlopePos, KnotNum, sizeof(signed long) ) != D_CALIB_IMAGE_OK ||
+         calib_image_check_table ( Size, (*p_Mode).OffsetPos, KnotNum, sizeof(signed long) ) != D_CALIB_IMAGE_OK ||
+         calib_image_check_table ( Size, (*p_Mode).ThrPointNumPos, (*p_Mode).LineNum, sizeof(unsigned int) ) != D_CALIB_IMAGE_OK ||
+         calib_image_check_table ( Size, (*p_Mode).XKnotSlopeOffsetPos, (*p_Mode).XKnotNumSlopeOffset, sizeof(unsigned short) ) != D_CALIB_IMAGE_OK ||
+         calib_image_check_table ( Size, (*p_Mode).YKnotSlopeOffsetPos, (*p_Mode).YKnotNumSlopeOffset, sizeof(unsigned short) ) != D_CALIB_IMAGE_OK ||
+         calib_image_check_table ( Size, (*p_Mode).XKnotDefocusOKNGPos, (*p_Mode).XKnotNumDefocusOKNG, sizeof(unsigned short) ) != D_CALIB_IMAGE_OK ||
+         calib_image_check_table ( Size, (*p_Mode).YKnotDefocusOKNGPos, (*p_Mode).YKnotNumDefocusOKNG, sizeof(unsigned short) ) != D_CALIB_IMAGE_OK ) {
+        return D_CALIB_IMAGE_NG;
+    }
+
+    p_PointNum = (const unsigned int *)( p_Image + (*p_Mode).ThrPointNumPos );
+
+    DataNum = 0;
+    for ( i = 0; i < (*p_Mode).LineNum; i++ ) {
+        if ( Size < p_PointNum[i] ) {                       /* Keep DataNum from overflow */
+            return D_CALIB_IMAGE_NG;
+        }
+        DataNum += (unsigned long)p_PointNum[i] * 2;
+    }
+
+    if ( calib_image_check_table ( Size, (*p_Mode).ThrDataPos, DataNum, sizeof(unsigned long) ) != D_CALIB_IMAGE_OK ) {
+        return D_CALIB_IMAGE_NG;
+    }
+
+    /* Point to the tables of image */
+    (*pf_CalibData).XSizeOfImage              = (*p_Mode).XSizeOfImage;
+    (*pf_CalibData).YSizeOfImage              = (*p_Mode).YSizeOfImage;
+    (*pf_CalibData).XKnotNumSlopeOffset       = (*p_Mode).XKnotNumSlopeOffset;
+    (*pf_CalibData).YKnotNumSlopeOffset       = (*p_Mode).YKnotNumSlopeOffset;
+    (*pf_CalibData).p_SlopeData               = (signed long *)( p_Image + (*p_Mode).SlopePos );
+    (*pf_CalibData).p_OffsetData              = (signed long *)( p_Image + (*p_Mode).OffsetPos );
+    (*pf_CalibData).p_XAddressKnotSlopeOffset = (unsigned short *)( p_Image + (*p_Mode).XKnotSlopeOffsetPos );
+    (*pf_CalibData).p_YAddressKnotSlopeOffset = (unsigned short *)( p_Image + (*p_Mode).YKnotSlopeOffsetPos );
+    (*pf_CalibData).AdjCoeffSlope             = (*p_Mode).AdjCoeffSlope;
+    (*pf_CalibData).XKnotNumDefocusOKNG       = (*p_Mode).XKnotNumDefocusOKNG;
+    (*pf_CalibData).YKnotNumDefocusOKNG       = (*p_Mode).YKnotNumDefocusOKNG;
+    (*pf_CalibData).p_DefocusOKNGThrLine      = pf_ThrLine;
+    (*pf_CalibData).p_XAddressKnotDefocusOKNG = (unsigned short *)( p_Image + (*p_Mode).XKnotDefocusOKNGPos );
+    (*pf_CalibData).p_YAddressKnotDefocusOKNG = (unsigned short *)( p_Image + (*p_Mode).YKnotDefocusOKNGPos );
+    (*pf_CalibData).DensityOfPhasePix         = (*p_Mode).DensityOfPhasePix;
+
+    if ( pf_ThrLine != NULL ) {                             /* Lines point to analog gain and confidence of image */
+        p_ThrData = (unsigned long *)( p_Image + (*p_Mode).ThrDataPos );
+
+        for ( i = 0; i < (*p_Mode).LineNum; i++ ) {
+            pf_ThrLine[i].PointNum     = p_PointNum[i];
+            pf_ThrLine[i].p_AnalogGain = p_ThrData;
+            pf_ThrLine[i].p_Confidence = p_ThrData + p_PointNum[i];
+            p_ThrData += (unsigned long)p_PointNum[i] * 2;
+        }
+    }
+
+    (*pf_LineNum) = (*p_Mode).LineNum;
+
+    return D_CALIB_IMAGE_OK;
+}
+
+/* Function for mapping file of image to memory */
+extern signed char CalibImageMap
+(
+    /* Input */
+    const char *pf_Path,
+    /* Output */
+    void **ppf_Image,
+    unsigned long *pf_Size
+)
+{
+#if defined D_CALIB_IMAGE_MMAP
+    int File;
+    struct stat Stat;
+    void *p_Image;
+
+    (*ppf_Image) = NULL;
+    (*pf_Size)   = 0;
+
+    File = open ( pf_Path, O_RDONLY );
+
+    if ( File < 0 ) {
+        return D_CALIB_IMAGE_NG;
+    }
+
+    if ( fstat ( File, &Stat ) != 0 || Stat.st_size <= 0 ) {
+        close ( File );
+        return D_CALIB_IMAGE_NG;
+    }
+
+    p_Image = mmap ( NULL, (size_t)Stat.st_size, PROT_READ, MAP_PRIVATE, File, 0 );
+
+    close ( File );                                         /* Mapping is kept after close */
+
+    if ( p_Image == MAP_FAILED ) {
+        return D_CALIB_IMAGE_NG;
+    }
+
+    (*ppf_Image) = p_Image;
+    (*pf_Size)   = (unsigned long)Stat.st_size;
+#else
+    FILE *p_File;
+    long Size;
+    void *p_Image;
+
+    (*ppf_Image) = NULL;
+    (*pf_Size)   = 0;
+
+    p_File = fopen ( pf_Path, "rb" );
+
+    if ( p_File == NULL ) {
+        return D_CALIB_IMAGE_NG;
+    }
+
+    if ( fseek ( p_File, 0, SEEK_END ) != 0 || ( Size = ftell ( p_File ) ) <= 0 || fseek ( p_File, 0, SEEK_SET ) != 0 ) {
+        fclose ( p_File );
+        return D_CALIB_IMAGE_NG;
+    }
+
+    p_Image = malloc ( (size_t)Size );                      /* Aligned for any type */
+
+    if ( p_Image == NULL || fread ( p_Image, 1, (size_t)Size, p_File ) != (size_t)Size ) {
+        free ( p_Image );
+        fclose ( p_File );
+        return D_CALIB_IMAGE_NG;
+    }
+
+    fclose ( p_File );
+
+    (*ppf_Image) = p_Image;
+    (*pf_Size)   = (unsigned long)Size;
+#endif
+
+    return D_CALIB_IMAGE_OK;
+}
+
+/* Function for unmapping image mapped by CalibImageMap() */
+extern void CalibImageUnmap
+(
+    /* Input */
+    void *pf_Image,
+    unsigned long f_Size
+)
+{
+    if ( pf_Image == NULL ) {
+        return ;
+    }
+
+#if defined D_CALIB_IMAGE_MMAP
+    munmap ( pf_Image, (size_t)f_Size );
+#else
+    (void)f_Size;
+
+    free ( pf_Image );
+#endif
+
+    return ;
+}
+
+/****************************************************************/
+/*                       local function                         */
+/****************************************************************/
+
+/* Function for rounding size up to D_CALIB_IMAGE_ALIGN */
+static unsigned long calib_image_align ( unsigned long f_Size )
+{
+    return ( f_Size + D_CALIB_IMAGE_ALIGN - 1 ) / D_CALIB_IMAGE_ALIGN * D_CALIB_IMAGE_ALIGN;
+}
+
+/* Function for calculating number of threshold lines in the same way as context */
+static unsigned long calib_image_calc_line_num ( PdLibCalibData_t *pf_CalibData )
+{
+    unsigned long LineNum;
+
+    LineNum = (unsigned long)(*pf_CalibData).XKnotNumDefocusOKNG * (*pf_CalibData).YKnotNumDefocusOKNG;
+
+    if ( LineNum == 0 ) {
+        LineNum = 1;                                        /* First line is checked even if confidence judgement is disabled */
+    }
+
+    return LineNum;
+}
+
+/* Function for calculating size of tables of a sensor mode */
+static unsigned long calib_image_calc_mode_size ( PdLibCalibData_t *pf_CalibData )
+{
+    unsigned long i;
+    unsigned long Size;
+    unsigned long KnotNum;
+    unsigned long LineNum;
+    unsigned long DataNum;
+
+    KnotNum = (unsigned long)(*pf_CalibData).XKnotNumSlopeOffset * (*pf_CalibData).YKnotNumSlopeOffset;
+    LineNum = calib_image_calc_line_num ( pf_CalibData );
+
+    DataNum = 0;
+    for ( i = 0; i < LineNum; i++ ) {
+        DataNum += (*pf_CalibData).p_DefocusOKNGThrLine[i].PointNum * 2;
+    }
+
+    Size  = calib_image_align ( sizeof(signed long) * KnotNum ) * 2;
+    Size += calib_image_align ( sizeof(unsigned long) * DataNum );
+    Size += calib_image_align ( sizeof(unsigned int) * LineNum );
+    Size += calib_image_align ( sizeof(unsigned short) * (*pf_CalibData).XKnotNumSlopeOffset );
+    Size += calib_image_align ( sizeof(unsigned short) * (*pf_CalibData).YKnotNumSlopeOffset );
+    Size += calib_image_align ( sizeof(unsigned short) * (*pf_CalibData).XKnotNumDefocusOKNG );
+    Size += calib_image_align ( sizeof(unsigned short) * (*pf_CalibData).YKnotNumDefocusOKNG );
+
+    return Size;
+}
+
+/* Function for calculating Adler-32 checksum */
+static unsigned long calib_image_calc_checksum ( const unsigned char *pf_Data, unsigned long f_Size )
+{
+    unsigned long Sum1;
+    unsigned long Sum2;
+    unsigned long Num;
+
+    Sum1 = 1;
+    Sum2 = 0;
+
+    while ( 0 < f_Size ) {
+        Num = ( f_Size < 5552 ) ? f_Size : 5552;            /* Sum2 does not overflow 32 bit before modulo */
+        f_Size -= Num;
+
+        while ( 0 < Num-- ) {
+            Sum1 += (*pf_Data++);
+            Sum2 += Sum1;
+        }
+
+        Sum1 %= 65521;
+        Sum2 %= 65521;
+    }
+
+    return ( Sum2 << 16 ) | Sum1;
+}
+
+/* Function for checking that table of f_Num elements at f_Pos is aligned and in the image */
+static signed char calib_image_check_table ( unsigned long f_Size, unsigned long f_Pos, unsigned long f_Num, unsigned long f_ElementSize )
+{
+    if ( ( f_Pos % D_CALIB_IMAGE_ALIGN ) != 0 || f_Size < f_Pos || ( f_Size - f_Pos ) / f_ElementSize < f_Num ) {
+        return D_CALIB_IMAGE_NG;
+    }
+
+    return D_CALIB_IMAGE_OK;
+}
+
+/* Function for writing table at f_Pos and returning aligned position of next table */
+static unsigned long calib_image_write_table ( unsigned char *pf_Image, unsigned long f_Pos, const void *pf_Data, unsigned long f_DataSize )
+{
+    if ( f_DataSize != 0 ) {                                /* Knots are not set if confidence judgement is disabled */
+        memcpy ( &(pf_Image[f_Pos]), pf_Data, f_DataSize );
+    }
+
+    return calib_image_align ( f_Pos + f_DataSize );
+}
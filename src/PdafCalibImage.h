@@ -0,0 +1,194 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef __PDAF_CALIB_IMAGE_H__
+#define __PDAF_CALIB_IMAGE_H__
+
+#include "PdafLibrary.h"
+
+#define D_CALIB_IMAGE_NG    (-1)
+#define D_CALIB_IMAGE_OK    (0)
+
+/*
+
+    Binary calibration image
+
+    +------------------------------+  0
+    | CalibImageHeader_t           |
+    +------------------------------+  HeaderSize
+    | CalibImageMode_t x ModeNum   |
+    +------------------------------+
+    | Tables of each sensor mode   |  Each table starts at a multiple of D_CALIB_IMAGE_ALIGN.
+    |   signed long    Slope       |  XKnotNumSlopeOffset * YKnotNumSlopeOffset
+    |   signed long    Offset      |  XKnotNumSlopeOffset * YKnotNumSlopeOffset
+    |   unsigned long  ThrData     |  AnalogGain[PointNum] and Confidence[PointNum] of each line in order
+    |   unsigned int   ThrPointNum |  LineNum
+    |   unsigned short Knots       |  X and Y of SlopeOffset, X and Y of DefocusOKNG
+    +------------------------------+  FileSize
+
+    Values are in native byte order and tables of long have LongSize bytes,
+    so that PDAF Library uses the tables in place. An image is readable only
+    on the platform of the same byte order and size of long as the writer.
+    Checksum is Adler-32 of bytes from HeaderSize to FileSize.
+    LineNum is XKnotNumDefocusOKNG * YKnotNumDefocusOKNG, or 1 when confidence
+    judgement is disabled, because the first line is checked in any case.
+
+*/
+
+#define D_CALIB_IMAGE_MAGIC         (0x49434450u)   /* "PDCI" in little endian */
+#define D_CALIB_IMAGE_MAJOR_VERSION (1)             /* Incompatible change of format */
+#define D_CALIB_IMAGE_MINOR_VERSION (0)             /* Compatible change of format */
+#define D_CALIB_IMAGE_ALIGN         (8)             /* Alignment of image and its tables */
+
+/* Header of image. unsigned int is 32 bit and unsigned short is 16 bit. */
+typedef struct
+{
+    unsigned int        Magic;                      /* D_CALIB_IMAGE_MAGIC. Also detects byte order. */
+    unsigned short      MajorVersion;               /* D_CALIB_IMAGE_MAJOR_VERSION. */
+    unsigned short      MinorVersion;               /* D_CALIB_IMAGE_MINOR_VERSION. */
+    unsigned short      LongSize;                   /* sizeof(long) of the writer. */
+    unsigned short      HeaderSize;                 /* sizeof(CalibImageHeader_t). */
+    unsigned int        ModeNum;                    /* Number of sensor modes. */
+    unsigned int        FileSize;                   /* Size of image. */
+    unsigned int        Checksum;                   /* Adler-32 of bytes from HeaderSize to FileSize. */
+} CalibImageHeader_t;
+
+/* Calibration data of a sensor mode. Position is the offset of table from the start of image. */
+typedef struct
+{
+    unsigned int        SensorMode;                 /* Sensor mode given by the writer. */
+    unsigned short      XSizeOfImage;
+    unsigned short      YSizeOfImage;
+    unsigned short      XKnotNumSlopeOffset;
+    unsigned short      YKnotNumSlopeOffset;
+    unsigned short      XKnotNumDefocusOKNG;
+    unsigned short      YKnotNumDefocusOKNG;
+    signed int          AdjCoeffSlope;
+    unsigned int        DensityOfPhasePix;
+    unsigned int        LineNum;                    /* Number of threshold lines. */
+    unsigned int        SlopePos;                   /* Position of slope data. */
+    unsigned int        OffsetPos;                  /* Position of offset data. */
+    unsigned int        ThrDataPos;                 /* Position of analog gain and confidence of threshold lines. */
+    unsigned int        ThrPointNumPos;             /* Position of number of points of threshold lines. */
+    unsigned int        XKnotSlopeOffsetPos;        /* Position of x address of knots of slope and offset. */
+    unsigned int        YKnotSlopeOffsetPos;        /* Position of y address of knots of slope and offset. */
+    unsigned int        XKnotDefocusOKNGPos;        /* Position of x address of knots of DefocusOKNG. */
+    unsigned int        YKnotDefocusOKNGPos;        /* Position of y address of knots of DefocusOKNG. */
+    unsigned int        Reserved;                   /* 0. */
+} CalibImageMode_t;
+
+/* Function for calculating size of image of calibration data of f_ModeNum sensor modes */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern signed char CalibImageCalcSize
+#else
+extern signed char CalibImageCalcSize
+#endif
+(
+    /* Input */
+    unsigned long f_ModeNum,
+    PdLibCalibData_t *pf_CalibData,
+    /* Output */
+    unsigned long *pf_Size
+);
+
+/* Function for writing image of calibration data of f_ModeNum sensor modes */
+/* pf_Image must be aligned to D_CALIB_IMAGE_ALIGN and have the size of CalibImageCalcSize(). */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern signed char CalibImageWrite
+#else
+extern signed char CalibImageWrite
+#endif
+(
+    /* Input */
+    unsigned long f_ModeNum,
+    PdLibCalibData_t *pf_CalibData,
+    unsigned long *pf_SensorMode,
+    unsigned long f_Size,
+    /* Output */
+    void *pf_Image
+);
+
+/* Function for checking header, alignment and checksum of image */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern signed char CalibImageCheck
+#else
+extern signed char CalibImageCheck
+#endif
+(
+    /* Input */
+    const void *pf_Image,
+    unsigned long f_Size
+);
+
+/* Function for getting calibration data of a sensor mode which points to the tables of image */
+/* Header is checked and tables are checked to be in the image, but checksum is not checked. */
+/* pf_LineNum is set to the number of threshold lines. When pf_ThrLine is not NULL, it is set */
+/* and pointed by pf_CalibData. Otherwise p_DefocusOKNGThrLine of pf_CalibData is NULL. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern signed char CalibImageGetMode
+#else
+extern signed char CalibImageGetMode
+#endif
+(
+    /* Input */
+    const void *pf_Image,
+    unsigned long f_Size,
+    unsigned long f_SensorMode,
+    /* Output */
+    PdLibCalibData_t *pf_CalibData,
+    DefocusOKNGThrLine_t *pf_ThrLine,
+    unsigned long *pf_LineNum
+);
+
+/* Function for mapping file of image to memory */
+/* mmap() is used with POSIX. Otherwise the file is read to allocated memory. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern signed char CalibImageMap
+#else
+extern signed char CalibImageMap
+#endif
+(
+    /* Input */
+    const char *pf_Path,
+    /* Output */
+    void **ppf_Image,
+    unsigned long *pf_Size
+);
+
+/* Function for unmapping image mapped by CalibImageMap() */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void CalibImageUnmap
+#else
+extern void CalibImageUnmap
+#endif
+(
+    /* Input */
+    void *pf_Image,
+    unsigned long f_Size
+);
+
+#endif
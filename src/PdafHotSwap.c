@@ -0,0 +1,205 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/****************************************************************/
+/*                          include                             */
+/****************************************************************/
+
+#include "PdafHotSwap.h"
+
+#if defined __GNUC__ && !defined _WIN32
+#define D_HOT_SWAP_ATOMIC                           /* Readers with atomic operations and writers with POSIX threads */
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <stdlib.h>
+
+/****************************************************************/
+/*                          structure                           */
+/****************************************************************/
+
+/* Hot swap */
+/* Readers are counted in ReaderNum of parity of Epoch at entering. HotSwapPublish() stores new data, */
+/* increments Epoch and waits until ReaderNum of the previous parity is 0. Readers which entered */
+/* with the new parity see the new data, so the previous data is not read after the wait. */
+struct HotSwap
+{
+    void                *p_Data;                    /* Current data. */
+    unsigned long       Epoch;                      /* Incremented at each publication. */
+    unsigned long       ReaderNum[2];               /* Number of readers inside for each parity of Epoch. */
+#if defined D_HOT_SWAP_ATOMIC
+    pthread_mutex_t     WriterMutex;                /* Serialize writers. Readers do not use it. */
+#endif
+};
+
+/****************************************************************/
+/*                      external function                       */
+/****************************************************************/
+
+/* Function for creating hot swap of pf_Data */
+extern signed char HotSwapCreate
+(
+    /* Input */
+    void *pf_Data,
+    /* Output */
+    HotSwap_t **ppf_HotSwap
+)
+{
+    HotSwap_t *p_HotSwap;
+
+    (*ppf_HotSwap) = NULL;
+
+    p_HotSwap = (HotSwap_t *)malloc ( sizeof(HotSwap_t) );
+
+    if ( p_HotSwap == NULL ) {
+        return D_HOT_SWAP_NG;
+    }
+
+    (*p_HotSwap).p_Data       = pf_Data;
+    (*p_HotSwap).Epoch        = 0;
+    (*p_HotSwap).ReaderNum[0] = 0;
+    (*p_HotSwap).ReaderNum[1] = 0;
+
+#if defined D_HOT_SWAP_ATOMIC
+    if ( pthread_mutex_init ( &((*p_HotSwap).WriterMutex), NULL ) != 0 ) {
+        free ( p_HotSwap );
+        return D_HOT_SWAP_NG;
+    }
+#endif
+
+    (*ppf_HotSwap) = p_HotSwap;
+
+    return D_HOT_SWAP_OK;
+}
+
+/* Function for destroying hot swap. Current data is returned. No reader may be inside. */
+extern void *HotSwapDestroy
+(
+    /* Input */
+    HotSwap_t *pf_HotSwap
+)
+{
+    void *p_Data;
+
+    p_Data = (*pf_HotSwap).p_Data;
+
+#if defined D_HOT_SWAP_ATOMIC
+    pthread_mutex_destroy ( &((*pf_HotSwap).WriterMutex) );
+#endif
+
+    free ( pf_HotSwap );
+
+    return p_Data;
+}
+
+/* Function for entering reader and getting current data */
+extern void *HotSwapEnter
+(
+    /* Input */
+    HotSwap_t *pf_HotSwap,
+    /* Output */
+    unsigned long *pf_Ticket
+)
+{
+#if defined D_HOT_SWAP_ATOMIC
+    unsigned long Epoch;
+
+    for ( ; ; ) {
+        Epoch = __atomic_load_n ( &((*pf_HotSwap).Epoch), __ATOMIC_SEQ_CST );
+
+        __atomic_add_fetch ( &((*pf_HotSwap).ReaderNum[Epoch & 1]), 1, __ATOMIC_SEQ_CST );
+
+        if ( __atomic_load_n ( &((*pf_HotSwap).Epoch), __ATOMIC_SEQ_CST ) == Epoch ) {
+            break ;                                         /* Counted before writer waits for the parity */
+        }
+
+        /* Data was published meanwhile. Enter again with the new parity. */
+        __atomic_sub_fetch ( &((*pf_HotSwap).ReaderNum[Epoch & 1]), 1, __ATOMIC_SEQ_CST );
+    }
+
+    (*pf_Ticket) = Epoch & 1;
+
+    return __atomic_load_n ( &((*pf_HotSwap).p_Data), __ATOMIC_SEQ_CST );
+#else
+    (*pf_Ticket) = 0;
+
+    return (*pf_HotSwap).p_Data;
+#endif
+}
+
+/* Function for exiting reader */
+extern void HotSwapExit
+(
+    /* Input */
+    HotSwap_t *pf_HotSwap,
+    unsigned long f_Ticket
+)
+{
+#if defined D_HOT_SWAP_ATOMIC
+    __atomic_sub_fetch ( &((*pf_HotSwap).ReaderNum[f_Ticket]), 1, __ATOMIC_RELEASE );   /* Reads of data end before */
+#else
+    (void)pf_HotSwap;
+    (void)f_Ticket;
+#endif
+
+    return ;
+}
+
+/* Function for publishing new data and getting replaced data */
+extern void *HotSwapPublish
+(
+    /* Input */
+    HotSwap_t *pf_HotSwap,
+    void *pf_Data
+)
+{
+    void *p_Data;
+#if defined D_HOT_SWAP_ATOMIC
+    unsigned long Epoch;
+
+    pthread_mutex_lock ( &((*pf_HotSwap).WriterMutex) );
+
+    p_Data = (*pf_HotSwap).p_Data;
+    __atomic_store_n ( &((*pf_HotSwap).p_Data), pf_Data, __ATOMIC_SEQ_CST );
+
+    Epoch = (*pf_HotSwap).Epoch;
+    __atomic_store_n ( &((*pf_HotSwap).Epoch), Epoch + 1, __ATOMIC_SEQ_CST );
+
+    /* Wait for readers which entered with the previous parity and might read replaced data */
+    while ( __atomic_load_n ( &((*pf_HotSwap).ReaderNum[Epoch & 1]), __ATOMIC_ACQUIRE ) != 0 ) {
+        sched_yield ();
+    }
+
+    pthread_mutex_unlock ( &((*pf_HotSwap).WriterMutex) );
+#else
+    p_Data = (*pf_HotSwap).p_Data;
+    (*pf_HotSwap).p_Data = pf_Data;
+#endif
+
+    return p_Data;
+}
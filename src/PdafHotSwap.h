@@ -0,0 +1,104 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef __PDAF_HOT_SWAP_H__
+#define __PDAF_HOT_SWAP_H__
+
+#define D_HOT_SWAP_NG   (-1)
+#define D_HOT_SWAP_OK   (0)
+
+/* Hot swap of data read by several threads (read-copy-update) */
+/* Readers enter and exit without lock, and data replaced by HotSwapPublish() is returned to the writer */
+/* after all readers which might read it have exited. Readers use atomic operations of GCC or clang except */
+/* Windows. Otherwise readers and writers must not run at the same time. */
+typedef struct HotSwap HotSwap_t;
+
+/* Function for creating hot swap of pf_Data */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern signed char HotSwapCreate
+#else
+extern signed char HotSwapCreate
+#endif
+(
+    /* Input */
+    void *pf_Data,
+    /* Output */
+    HotSwap_t **ppf_HotSwap
+);
+
+/* Function for destroying hot swap. Current data is returned. No reader may be inside. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void *HotSwapDestroy
+#else
+extern void *HotSwapDestroy
+#endif
+(
+    /* Input */
+    HotSwap_t *pf_HotSwap
+);
+
+/* Function for entering reader and getting current data */
+/* Data is valid until HotSwapExit() with pf_Ticket. Lock-free, retried only when data is published meanwhile. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void *HotSwapEnter
+#else
+extern void *HotSwapEnter
+#endif
+(
+    /* Input */
+    HotSwap_t *pf_HotSwap,
+    /* Output */
+    unsigned long *pf_Ticket
+);
+
+/* Function for exiting reader */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void HotSwapExit
+#else
+extern void HotSwapExit
+#endif
+(
+    /* Input */
+    HotSwap_t *pf_HotSwap,
+    unsigned long f_Ticket
+);
+
+/* Function for publishing new data and getting replaced data */
+/* Readers entering after publication get pf_Data. The function waits until readers which entered before */
+/* have exited, so the replaced data can be released by the caller. Calls of writers are serialized. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void *HotSwapPublish
+#else
+extern void *HotSwapPublish
+#endif
+(
+    /* Input */
+    HotSwap_t *pf_HotSwap,
+    void *pf_Data
+);
+
+#endif
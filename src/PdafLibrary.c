@@ -30,7 +30,21 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /*                          include                             */
 /****************************************************************/
 
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "PdafMathFunc.h"
+#include "PdafThreadPool.h"
+#include "PdafStatistics.h"
+#include "PdafCalibImage.h"
+#include "PdafOtpDecoder.h"
+#include "PdafHotSwap.h"
+#include "PdafPhaseDetect.h"
+#include "PdafRoi.h"
+#include "PdafTracker.h"
+#include "PdafRecord.h"
+#include "PdafTrace.h"
 #include "PdafLibrary.h"
 
 /****************************************************************/
@@ -40,21 +54,372 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define D_MAJOR_VERSION (1)                         /* Integer part of PDAF Library version. */
 #define D_MINOR_VERSION (00)                        /* Decimal part of PDAF Library version. */
 
+/****************************************************************/
+/*                          structure                           */
+/****************************************************************/
+
+/* Slope and offset interpolated at window center, and weight of linear interpolation */
+/* Fixed-point keeps slope and offset with D_MATH_FUNC_COEFF_FRAC_BITS of fraction, and weight as a fraction. */
+#if D_MATH_FUNC_FIXED_POINT
+typedef signed long long PdLibCoeff_t;
+
+typedef struct
+{
+    unsigned long       Num;                        /* Numerator of weight. */
+    unsigned long       Den;                        /* Denominator of weight. Not 0. */
+} PdLibWeight_t;
+#else
+typedef double PdLibCoeff_t;
+typedef double PdLibWeight_t;
+#endif
+
+/* Registered PDAF window */
+typedef struct
+{
+    PdLibWindow_t       Window;                     /* PDAF window. */
+    PdLibCoeff_t        Slope;                      /* Slope interpolated at window center, including AdjCoeffSlope / 2304. */
+    PdLibCoeff_t        Offset;                     /* Offset interpolated at window center. */
+    signed long         DefocusOkNgThr;             /* Threshold of confidence at window center for cached analog gain. */
+    unsigned char       AreaIndex;                  /* Area of window center for statistics. */
+} PdLibRegWindow_t;
+
+/* Cells of registered defocus map in one direction */
+typedef struct
+{
+    PdLibWeight_t       Weight;                     /* Weight of knot of slope and offset next to KnotStart. */
+    signed long         Center;                     /* Address of cell center. */
+    unsigned long       Sample;                     /* Index of sample of phase difference containing cell center. */
+    unsigned short      KnotStart;                  /* Index of knot of slope and offset before cell center. */
+    unsigned short      OkNgKnotStart;              /* Index of knot of DefocusOKNG before cell center. */
+    unsigned char       Side;                       /* 0 : before first knot, 1 : between knots, 2 : after last knot. */
+    unsigned char       OkNgSide;                   /* Side of knots of DefocusOKNG. */
+} PdLibMapAxis_t;
+
+/* Registered defocus map. Arrays are allocated at once from p_Slope. */
+#define D_MAP_TILE_ROW_NUM (8)                      /* Number of rows of cells in a tile taken by a thread at once. */
+#define D_MAP_CHUNK_NUM (64)                        /* Number of cells of a row calculated at once. */
+
+typedef struct
+{
+    unsigned long       XCellNum;                   /* Number of cells in x-direction. 0 : not registered. */
+    unsigned long       YCellNum;                   /* Number of cells in y-direction. */
+    unsigned long       XSampleNum;                 /* Number of samples of phase difference in x-direction. */
+    unsigned long       YSampleNum;                 /* Number of samples of phase difference in y-direction. */
+    PdLibCoeff_t        *p_Slope;                   /* Slope at each cell center, including AdjCoeffSlope / 2304. */
+    PdLibCoeff_t        *p_Offset;                  /* Offset at each cell center. */
+    signed long         *p_DefocusOkNgThr;          /* Threshold of confidence at each cell center for cached analog gain. */
+    PdLibMapAxis_t      *p_XAxis;                   /* Columns of cells. */
+    PdLibMapAxis_t      *p_YAxis;                   /* Rows of cells. */
+    signed long         *p_ThrLine0;                /* Threshold of each column on upper knots of DefocusOKNG of a row. */
+    signed long         *p_ThrLine1;                /* Threshold of each column on lower knots of DefocusOKNG of a row. */
+    unsigned char       ThrCacheValid;              /* 1 : p_DefocusOkNgThr is set for ThrCacheGain. */
+    unsigned char       CoeffValid;                 /* 1 : p_Slope and p_Offset are set for AdjCoeffSlope. */
+} PdLibRegMap_t;
+
+/* Knots of one direction with their pitch */
+typedef struct
+{
+    unsigned short      KnotNum;                    /* Number of knots. */
+    unsigned short      *p_AddressKnot;             /* Array of address of knots. */
+    unsigned long       Pitch;                      /* Pitch of knots when it is uniform, otherwise 0. */
+} PdLibKnotAxis_t;
+
+/* Calibration data of context packed at its creation. Lossless copy of slope, offset and threshold lines. */
+typedef struct
+{
+    unsigned char       SlopeOffsetBits;            /* 16 : signed short, 32 : signed int, 0 : not packed (p_SlopeData is used). */
+    void                *p_SlopeOffset;             /* Slope and offset of each knot interleaved. */
+    unsigned long       LineNum;                    /* Number of threshold lines in p_LineGain. 0 : lines are used in place. */
+    unsigned long       *p_LineStart;               /* Index of first point of each line, and number of all points at LineNum. */
+    unsigned long       *p_LineGain;                /* Analog gain of all points of all lines. */
+    unsigned long       *p_LineConf;                /* Confidence of all points of all lines, in the same order. */
+} PdLibPackedCalib_t;
+
+/* Index of knots for searching knot cell. Built once per checked calibration data. */
+typedef struct
+{
+    PdLibKnotAxis_t     XSlopeOffset;               /* X knots of slope and offset. */
+    PdLibKnotAxis_t     YSlopeOffset;               /* Y knots of slope and offset. */
+    PdLibKnotAxis_t     XDefocusOKNG;               /* X knots of DefocusOKNG. */
+    PdLibKnotAxis_t     YDefocusOKNG;               /* Y knots of DefocusOKNG. */
+    PdLibPackedCalib_t  *p_Packed;                  /* Packed calibration data of context, or NULL. */
+} PdLibKnotIndex_t;
+
+/* Planes of PDAF window centers deferred to CalcAddressOnPlaneArray_slXslYslZ() */
+#define D_PLANE_BATCH_NUM (32)                      /* Number of planes calculated at once. */
+
+typedef struct
+{
+    unsigned long       Num;                        /* Number of deferred planes. */
+    signed long         *p_Defocus[D_PLANE_BATCH_NUM];  /* Destination of defocus of each plane. */
+    signed long         X0[D_PLANE_BATCH_NUM];      /* X address of knots. */
+    signed long         X1[D_PLANE_BATCH_NUM];
+    signed long         Y0[D_PLANE_BATCH_NUM];      /* Y address of knots. */
+    signed long         Y1[D_PLANE_BATCH_NUM];
+    signed long         Z0[D_PLANE_BATCH_NUM];      /* Defocus of knot points. */
+    signed long         Z1[D_PLANE_BATCH_NUM];
+    signed long         Z2[D_PLANE_BATCH_NUM];
+    signed long         Z3[D_PLANE_BATCH_NUM];
+    signed long         XX[D_PLANE_BATCH_NUM];      /* PDAF window center. */
+    signed long         YY[D_PLANE_BATCH_NUM];
+    signed long         ZZ[D_PLANE_BATCH_NUM];      /* Defocus at PDAF window center. */
+} PdLibPlaneBatch_t;
+
+/* Parallel executor */
+#define D_PARALLEL_CHUNK_NUM (16)                   /* Number of windows or input data taken by a thread at once. */
+
+/* Scratch buffer of caller */
+#define D_SCRATCH_ALIGN (64)                        /* Alignment of context, registered windows and defocus map (cache line). */
+#define D_SCRATCH_CELL_MAX (0xFFFF)                 /* Maximum number of cells of defocus map in each direction. */
+
+#if D_PD_LIB_STATS
+#define D_EXECUTOR_THREAD_START (StatisticsPrepare) /* Worker threads allocate their counters at creation. */
+#else
+#define D_EXECUTOR_THREAD_START (NULL)
+#endif
+
+struct PdLibExecutor
+{
+    ThreadPool_t        *p_ThreadPool;              /* Pool of worker threads. */
+};
+
+/* Sensor profile with values for checking and evaluation */
+typedef struct
+{
+    PdLibSensorProfile_t Profile;                   /* Sensor profile. */
+    signed long         PdErrorPhaseDiff;           /* PdErrorValue in the unit of PhaseDifference (1/16). */
+    unsigned long       DensityNum;                 /* Number of values in Density. */
+    unsigned long       Density[D_PD_LIB_SENS_MODE_NUM];    /* DensityOfPhasePix accepted by check, without duplicates. */
+    unsigned long       AdjCoeffNum;                /* Number of values in AdjCoeff. */
+    signed long         AdjCoeff[D_PD_LIB_SENS_MODE_NUM];   /* AdjCoeffSlope accepted by check, without duplicates. */
+} PdLibProfileState_t;
+
+/* Sensor profile of APIs without context, read and written by words of a sequence lock */
+/* All members of PdLibProfileState_t are signed long or unsigned long. Without D_PROFILE_ATOMIC the profile */
+/* is copied plainly, and PdLibSetSensorProfile() must not be called while other threads call APIs. */
+#if defined __GNUC__
+#define D_PROFILE_ATOMIC                            /* Readers and writer in several threads with atomic operations */
+#endif
+#define D_PROFILE_WORD_NUM ( sizeof(PdLibProfileState_t) / sizeof(unsigned long) )
+
+typedef union
+{
+    PdLibProfileState_t State;                      /* Sensor profile with derived values. */
+    unsigned long       Word[D_PROFILE_WORD_NUM];   /* Words copied by atomic operations. */
+} PdLibProfileWord_t;
+
+/* Slot of hot-swapped context */
+struct PdLibContextSlot
+{
+    HotSwap_t           *p_HotSwap;                 /* Context published by PdLibPublishContext(). */
+};
+
+/* Argument of job_run_batch_task() */
+typedef struct
+{
+    PdLibInputData_t    InputData;                  /* Calibration data of context with analog gain. */
+    PdLibKnotIndex_t    *p_KnotIndex;               /* Index of knots of context. */
+    signed long         *p_ThrCache;                /* Threshold cache of context. */
+    signed long         RetCheckCalib;              /* Result of validation of context. */
+    PdLibProfileState_t *p_Profile;                 /* Sensor profile of context. */
+    Trace_t             *p_Trace;                   /* Trace of context, or NULL. */
+    PdLibWindow_t       *p_Window;                  /* Array of PDAF windows. */
+    PdLibPhaseDiffData_t *p_PhaseDiffData;          /* Array of phase difference data. */
+    PdLibOutputData_t   *p_OutputData;              /* Array of output data. */
+    signed long         *p_Result;                  /* Array of return value of each window. */
+} PdLibBatchTask_t;
+
+/* Argument of job_run_input_task() */
+typedef struct
+{
+    PdLibInputData_t    *p_InputData;               /* Array of input data. */
+    PdLibProfileState_t *p_Profile;                 /* Sensor profile of all input data. */
+    PdLibOutputData_t   *p_OutputData;              /* Array of output data. */
+    signed long         *p_Result;                  /* Array of return value of each input data. */
+} PdLibInputTask_t;
+
+/* Argument of job_run_map_task() */
+typedef struct
+{
+    PdLibInputData_t    InputData;                  /* Calibration data of context with analog gain. */
+    PdLibRegMap_t       *p_RegMap;                  /* Registered defocus map of context. */
+    PdLibKnotIndex_t    *p_KnotIndex;               /* Index of knots calculating threshold of cells, or NULL for threshold of map. */
+    PdLibProfileState_t *p_Profile;                 /* Sensor profile of context. */
+    PdLibPhaseDiffData_t *p_Sample;                 /* Array of samples of phase difference. */
+    signed long         *p_DefocusMap;              /* Defocus of each cell. */
+    unsigned long       *p_ConfidenceLevelMap;      /* Defocus confidence level of each cell. */
+} PdLibMapTask_t;
+
+/* Argument of job_run_pd_task() */
+typedef struct
+{
+    const PdLibPdImage_t *p_Image;                  /* Left and right sub-images. */
+    const PdLibPdParam_t *p_Param;                  /* Parameter of disparity search. */
+    PdLibWindow_t       *p_Window;                  /* Array of PDAF windows. */
+    PdLibPhaseDiffData_t *p_PhaseDiffData;          /* Array of phase difference data of each window. */
+    unsigned long       LevelNum;                   /* Number of levels of coarse-to-fine search. */
+    unsigned char       *p_Level;                   /* Array of level of result of each window, or NULL. */
+} PdLibPdTask_t;
+
+/* Calibration context */
+struct PdLibContext
+{
+    PdLibInputData_t    InputData;                  /* Calibration data copied to the context. Window, phase difference */
+                                                    /* and analog gain are set at each call. */
+    signed long         ValidateResult;             /* Result of PdLibValidateContext(). */
+    signed long         ModeResult[D_PD_LIB_SENS_MODE_NUM];    /* Result of PdLibValidateContext() with values of each sensor mode. */
+    PdLibProfileState_t Profile;                    /* Sensor profile of context. */
+    PdLibKnotIndex_t    KnotIndex;                  /* Index of knots built by PdLibValidateContext(). */
+    PdLibPackedCalib_t  Packed;                     /* Calibration data packed at creation. */
+    unsigned long       RegWindowNum;               /* Number of registered windows. */
+    PdLibRegWindow_t    *p_RegWindow;               /* Array of registered windows. */
+    PdLibRegMap_t       RegMap;                     /* Registered defocus map. */
+    signed long         *p_ThrCache;                /* Threshold of confidence at each DefocusOKNG knot. Allocated with context. */
+    unsigned long       ThrCacheGain;               /* Analog gain of p_ThrCache. */
+    unsigned char       ThrCacheValid;              /* 1 : p_ThrCache is set for ThrCacheGain. */
+    unsigned char       RegThrCacheValid;           /* 1 : DefocusOkNgThr of registered windows is set for ThrCacheGain. */
+    unsigned char       RegCoeffValid;              /* 1 : Slope and offset of registered windows are set for AdjCoeffSlope. */
+    PdLibCacheStatistics_t CacheStatistics;         /* Statistics of threshold cache. */
+    unsigned char       Published;                  /* 1 : Context is shared by threads of slot, and evaluation does not write it. */
+    unsigned char       *p_Scratch;                 /* Scratch buffer of registered windows and defocus map, or NULL for heap. */
+    unsigned long       ScratchWindowSize;          /* Size of registered windows at p_Scratch. Defocus map follows. */
+    unsigned long       ScratchMapSize;             /* Size of defocus map. */
+    unsigned char       ScratchContext;             /* 1 : Context is in scratch buffer of caller. */
+#if D_PD_LIB_TRACE_NUM
+    Trace_t             Trace;                      /* Records of recent evaluations. */
+#endif
+};
+
+#if D_PD_LIB_STATS
+/* Index of counter of PdafStatistics for member of PdLibStats_t */
+#define D_STATS_INDEX(Member) ( offsetof ( PdLibStats_t, Member ) / sizeof(unsigned long) )
+
+/* PdLibStats_t must fit in counters of each thread */
+typedef char PdLibStatsSizeCheck_t[ ( sizeof(PdLibStats_t) <= sizeof(unsigned long) * D_STATISTICS_COUNTER_NUM ) ? 1 : -1 ];
+#endif
+
+/* Range of PdErrorValue of sensor profile. PdErrorValue * 16 is within signed 32 bit. */
+#define D_PROFILE_PD_ERROR_MAX (0x7FFFFFF)
+
+/* Built-in sensor profiles of PdLibGetSensorProfile() */
+static const PdLibSensorProfile_t s_SensorProfile[D_PD_LIB_SENSOR_PROFILE_NUM] =
+{
+    /* D_PD_LIB_SENSOR_PROFILE_DEFAULT */
+    { D_PD_ERROR_VALUE,
+      { D_PD_LIB_DENSITY_SENS_MODE0, D_PD_LIB_DENSITY_SENS_MODE1, D_PD_LIB_DENSITY_SENS_MODE2,
+        D_PD_LIB_DENSITY_SENS_MODE3, D_PD_LIB_DENSITY_SENS_MODE4 },
+      { D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE0, D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE1, D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE2,
+        D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE3, D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE4 } },
+    /* D_PD_LIB_SENSOR_PROFILE_PD_ERROR_64 */
+    { -64, { 2304, 2304, 2304/2, 2304/2, 2304/4 }, { 2304, 2304, 2304, 2304, 2304 } },
+    /* D_PD_LIB_SENSOR_PROFILE_PD_ERROR_32 */
+    { -32, { 2304, 2304, 2304/2, 2304/2, 2304/4 }, { 2304, 2304, 2304, 2304, 2304 } }
+};
+
+/* Sensor profile of APIs without context and initial profile of context. Set by PdLibSetSensorProfile(). */
+/* Sequence is odd while the profile is written, so readers copy it again. */
+static unsigned long s_ProfileSequence = 0;
+static PdLibProfileWord_t s_ProfileState =
+{ {
+    { D_PD_ERROR_VALUE,
+      { D_PD_LIB_DENSITY_SENS_MODE0, D_PD_LIB_DENSITY_SENS_MODE1, D_PD_LIB_DENSITY_SENS_MODE2,
+        D_PD_LIB_DENSITY_SENS_MODE3, D_PD_LIB_DENSITY_SENS_MODE4 },
+      { D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE0, D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE1, D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE2,
+        D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE3, D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE4 } },
+    D_PD_ERROR_VALUE * 16,
+    D_PD_LIB_SENS_MODE_NUM,
+    { D_PD_LIB_DENSITY_SENS_MODE0, D_PD_LIB_DENSITY_SENS_MODE1, D_PD_LIB_DENSITY_SENS_MODE2,
+      D_PD_LIB_DENSITY_SENS_MODE3, D_PD_LIB_DENSITY_SENS_MODE4 },
+    D_PD_LIB_SENS_MODE_NUM,
+    { D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE0, D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE1, D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE2,
+      D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE3, D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE4 }
+} };
+
 /****************************************************************/
 /*                 local function declaration                   */
 /****************************************************************/
 
 static void job_init_output_data ( PdLibOutputData_t *pfa_OutputData );
-static signed long job_check_input ( PdLibInputData_t *pfa_InputData );
-static void job_calc_defocus ( PdLibInputData_t *pfa_InputData, signed long *pfa_Defocus );
-static void job_calc_defocus_confidence_level ( PdLibInputData_t *pfa_InputData, unsigned long *pfa_DefocusConfidenceLevel );
+static signed long job_check_input ( PdLibInputData_t *pfa_InputData, PdLibProfileState_t *pfa_Profile );
+static signed long job_check_input_image ( PdLibInputData_t *pfa_InputData );
+static signed long job_check_input_window ( PdLibInputData_t *pfa_InputData );
+static signed long job_check_input_calib ( PdLibInputData_t *pfa_InputData, PdLibProfileState_t *pfa_Profile );
+static void job_set_input_calib ( PdLibCalibData_t *pfa_CalibData, unsigned long fa_ImagerAnalogGain, PdLibInputData_t *pfa_InputData );
+static void job_set_input_window ( PdLibWindow_t *pfa_Window, PdLibPhaseDiffData_t *pfa_PhaseDiffData, PdLibInputData_t *pfa_InputData );
+static void job_get_defocus ( PdLibInputData_t *pfa_InputData, PdLibKnotIndex_t *pfa_KnotIndex, PdLibProfileState_t *pfa_Profile, PdLibOutputData_t *pfa_OutputData );
+static void job_get_defocus_reg_window ( PdLibInputData_t *pfa_InputData, PdLibRegWindow_t *pfa_RegWindow, PdLibKnotIndex_t *pfa_KnotIndex, PdLibProfileState_t *pfa_Profile, PdLibOutputData_t *pfa_OutputData );
+static void job_get_defocus_confidence ( PdLibInputData_t *pfa_InputData, PdLibKnotIndex_t *pfa_KnotIndex, signed long *pfa_ThrCache, signed long *pfa_DefocusOkNgThr, PdLibProfileState_t *pfa_Profile, PdLibOutputData_t *pfa_OutputData );
+static void job_get_defocus_batch ( PdLibInputData_t *pfa_InputData, PdLibKnotIndex_t *pfa_KnotIndex, signed long *pfa_ThrCache, signed long fa_RetCheckCalib, PdLibProfileState_t *pfa_Profile, Trace_t *pfa_Trace, unsigned long fa_WindowNum, PdLibWindow_t *pfa_Window, PdLibPhaseDiffData_t *pfa_PhaseDiffData, PdLibOutputData_t *pfa_OutputData, signed long *pfa_Result );
+static void job_run_batch_task ( void *pfa_Arg, unsigned long fa_Start, unsigned long fa_End );
+static signed long job_get_defocus_input ( PdLibInputData_t *pfa_InputData, PdLibProfileState_t *pfa_Profile, PdLibOutputData_t *pfa_OutputData );
+static void job_run_input_task ( void *pfa_Arg, unsigned long fa_Start, unsigned long fa_End );
+static void job_get_defocus_map ( PdLibInputData_t *pfa_InputData, PdLibRegMap_t *pfa_RegMap, PdLibKnotIndex_t *pfa_KnotIndex, PdLibProfileState_t *pfa_Profile, PdLibPhaseDiffData_t *pfa_Sample, unsigned long fa_YCellStart, unsigned long fa_YCellEnd, signed long *pfa_DefocusMap, unsigned long *pfa_ConfidenceLevelMap );
+static void job_run_map_task ( void *pfa_Arg, unsigned long fa_Start, unsigned long fa_End );
+static void job_run_pd_task ( void *pfa_Arg, unsigned long fa_Start, unsigned long fa_End );
+static signed long job_record_error ( signed char fa_Ret );
+static signed long job_check_context_calib ( PdLibCalibData_t *pfa_CalibData );
+static unsigned long job_calc_context_size ( PdLibCalibData_t *pfa_CalibData );
+static signed long job_calc_scratch_size ( PdLibCalibData_t *pfa_CalibData, unsigned long fa_WindowNum, unsigned long fa_XCellNum, unsigned long fa_YCellNum, unsigned long *pfa_ContextSize, unsigned long *pfa_WindowSize, unsigned long *pfa_MapSize, unsigned long *pfa_ScratchSize );
+static unsigned long job_calc_map_size ( unsigned long fa_XCellNum, unsigned long fa_YCellNum );
+static void job_release_registration ( PdLibContext_t *pfa_Context );
+static signed long job_alloc_registration ( PdLibContext_t *pfa_Context, unsigned char fa_Map, unsigned long fa_Size, void **ppfa_Buffer );
+static void job_copy_context_calib ( PdLibCalibData_t *pfa_CalibData, PdLibContext_t *pfa_Context );
+static unsigned long job_calc_packed_size ( unsigned long fa_KnotNum, unsigned long fa_LineNum, unsigned long fa_PointNum );
+static unsigned char *job_pack_context_calib ( PdLibCalibData_t *pfa_CalibData, unsigned long fa_LineNum, PdLibPackedCalib_t *pfa_Packed, unsigned char *pfa_Table );
+static void job_init_context ( PdLibContext_t *pfa_Context );
+static Trace_t *job_get_trace ( PdLibContext_t *pfa_Context );
+static void job_update_thr_cache ( PdLibContext_t *pfa_Context, unsigned long fa_ImagerAnalogGain );
+static signed long *job_use_thr_cache ( PdLibContext_t *pfa_Context, unsigned long fa_ImagerAnalogGain );
+static void job_publish_context ( PdLibContext_t *pfa_Context );
+static void job_update_reg_thr_cache ( PdLibContext_t *pfa_Context );
+static void job_update_reg_coeff ( PdLibContext_t *pfa_Context );
+static void job_update_map_thr_cache ( PdLibContext_t *pfa_Context );
+static void job_update_map_coeff ( PdLibContext_t *pfa_Context );
+static void job_init_map_axis ( unsigned long fa_CellNum, unsigned long fa_SampleNum, unsigned short fa_Size, PdLibKnotAxis_t *pfa_KnotAxis, PdLibKnotAxis_t *pfa_OkNgKnotAxis, PdLibMapAxis_t *pfa_MapAxis );
+static void job_calc_map_thr_line ( PdLibContext_t *pfa_Context, PdLibMapAxis_t *pfa_YAxis );
+static unsigned char job_search_knot_side ( signed long fa_Address, PdLibKnotAxis_t *pfa_KnotAxis );
+static signed long job_check_profile ( const PdLibSensorProfile_t *pfa_Profile );
+static void job_set_profile ( const PdLibSensorProfile_t *pfa_Profile, PdLibProfileState_t *pfa_ProfileState );
+static void job_get_lib_profile ( PdLibProfileState_t *pfa_ProfileState );
+static void job_set_lib_profile ( const PdLibProfileState_t *pfa_ProfileState );
+static void job_init_knot_index ( PdLibInputData_t *pfa_InputData, PdLibKnotIndex_t *pfa_KnotIndex );
+static void job_init_knot_axis ( unsigned short fa_KnotNum, unsigned short *pfa_AddressKnot, PdLibKnotAxis_t *pfa_KnotAxis );
+static void job_search_knot ( signed long fa_XAddress, signed long fa_YAddress, PdLibKnotAxis_t *pfa_XKnotAxis, PdLibKnotAxis_t *pfa_YKnotAxis, unsigned short *pfa_XKnotStart, unsigned short *pfa_YKnotStart, unsigned char *pfa_AreaIndex );
+static unsigned short job_search_knot_start ( signed long fa_Address, PdLibKnotAxis_t *pfa_KnotAxis );
+static void job_calc_defocus ( PdLibInputData_t *pfa_InputData, PdLibKnotIndex_t *pfa_KnotIndex, PdLibPlaneBatch_t *pfa_PlaneBatch, signed long *pfa_Defocus, unsigned char *pfa_AreaIndex );
+#if D_PD_LIB_CONSTANT_TIME
+static void job_calc_defocus_cell ( PdLibInputData_t *pfa_InputData, PdLibKnotIndex_t *pfa_KnotIndex, PdLibPlaneBatch_t *pfa_PlaneBatch, signed long *pfa_Defocus, unsigned char *pfa_AreaIndex );
+static unsigned short job_search_knot_cell ( signed long fa_Address, PdLibKnotAxis_t *pfa_KnotAxis, signed long *pfa_Address );
+static void job_calc_defocus_ok_ng_thr_cell ( PdLibInputData_t *pfa_InputData, PdLibKnotIndex_t *pfa_KnotIndex, signed long *pfa_ThrCache, signed long *pfa_DefocusOkNgThr );
+#endif
+static void job_flush_plane_batch ( PdLibPlaneBatch_t *pfa_PlaneBatch );
+static void job_calc_defocus_coeff ( PdLibInputData_t *pfa_InputData, PdLibKnotIndex_t *pfa_KnotIndex, PdLibCoeff_t *pfa_Slope, PdLibCoeff_t *pfa_Offset, unsigned char *pfa_AreaIndex );
+static void job_calc_defocus_coeff_area ( PdLibInputData_t *pfa_InputData, PdLibKnotIndex_t *pfa_KnotIndex, unsigned short fa_XKnotStart, unsigned short fa_YKnotStart, unsigned char fa_AreaIndex, PdLibWeight_t fa_XWeight, PdLibWeight_t fa_YWeight, PdLibCoeff_t *pfa_Slope, PdLibCoeff_t *pfa_Offset );
+static void job_calc_defocus_ok_ng_thr ( PdLibInputData_t *pfa_InputData, PdLibKnotIndex_t *pfa_KnotIndex, signed long *pfa_ThrCache, signed long *pfa_DefocusOkNgThr );
+static void job_calc_defocus_confidence_level ( PdLibInputData_t *pfa_InputData, signed long fa_DefocusOkNgThr, unsigned long *pfa_DefocusConfidenceLevel );
 static void job_calc_defocus_confidence ( unsigned long fa_DefocusConfidenceLevel, signed char *pfa_DefocusConfidence );
 static void job_calc_phase_difference ( PdLibInputData_t *pfa_InputData, signed long *pfa_PhaseDifference );
-
-static signed long calc_defocus_formula ( PdLibInputData_t *pfa_InputData, unsigned short fa_Index );
+#if D_PD_LIB_STATS
+static void job_stats_result ( signed long fa_Result );
+static void job_stats_confidence ( PdLibInputData_t *pfa_InputData, PdLibProfileState_t *pfa_Profile, signed char fa_DefocusConfidence );
+static void job_stats_latency ( unsigned long long fa_StartTime );
+#endif
+#if D_PD_LIB_TRACE_NUM
+static void job_trace_windows ( Trace_t *pfa_Trace, PdLibInputData_t *pfa_InputData, PdLibRegWindow_t *pfa_RegWindow, unsigned long fa_WindowNum, PdLibWindow_t *pfa_Window, PdLibPhaseDiffData_t *pfa_PhaseDiffData, PdLibOutputData_t *pfa_OutputData, signed long *pfa_Result, unsigned char *pfa_AreaIndex );
+#endif
+
+static signed long calc_defocus_formula ( PdLibInputData_t *pfa_InputData, PdLibKnotIndex_t *pfa_KnotIndex, unsigned short fa_Index );
+static void calc_slope_offset ( PdLibInputData_t *pfa_InputData, PdLibKnotIndex_t *pfa_KnotIndex, unsigned long fa_Index, signed long *pfa_Slope, signed long *pfa_Offset );
+static PdLibWeight_t calc_line_weight ( signed long fa_X0, signed long fa_X1, signed long fa_X );
+static signed long calc_defocus_ok_ng_thr ( PdLibInputData_t *pfa_InputData, signed long *pfa_ThrCache, unsigned short fa_Index );
+#if D_MATH_FUNC_FIXED_POINT
+static signed long long calc_weighted_fixed ( signed long long fa_X, unsigned long fa_Num, unsigned long fa_Den );
+static signed long limit_defocus_formula_fixed ( signed long long fa_Defocus );
+static unsigned long limit_defocus_confidence_level_fixed ( unsigned long long fa_DefocusConfidenceLevel );
+#else
 static signed long limit_defocus_formula ( double fa_Defocus );
-static signed long calc_defocus_ok_ng_thr ( PdLibInputData_t *pfa_InputData, unsigned short fa_Index );
 static unsigned long limit_defocus_confidence_level ( double fa_DefocusConfidenceLevel );
+#endif
 
 /****************************************************************/
 /*                      external function                       */
@@ -77,241 +442,3445 @@ extern signed long PdLibGetDefocus
     PdLibInputData_t    *pfa_PdLibInputData,                /* Input  : Input data structure */
     PdLibOutputData_t   *pfa_PdLibOutputData                /* Output : Output data structure */
 )
+{
+    PdLibProfileState_t Profile;
+
+    job_get_lib_profile ( &Profile );                       /* Sensor profile of the whole call */
+
+    return job_get_defocus_input ( pfa_PdLibInputData, &Profile, pfa_PdLibOutputData );
+}
+
+/* API : Get defocus data of all PDAF windows in a frame. */
+/* Calibration data is checked once per call. Each window is checked and calculated in order, */
+/* and its return value is set to pfa_PdLibResult. When calibration data is invalid, */
+/* its error value is returned and set to all windows. */
+extern signed long PdLibGetDefocusBatch 
+(
+    PdLibCalibData_t        *pfa_PdLibCalibData,            /* Input  : Calibration data structure */
+    unsigned long           fa_ImagerAnalogGain,            /* Input  : Image sensor analog gain */
+    unsigned long           fa_WindowNum,                   /* Input  : Number of windows */
+    PdLibWindow_t           *pfa_PdLibWindow,               /* Input  : Array of PDAF windows */
+    PdLibPhaseDiffData_t    *pfa_PdLibPhaseDiffData,        /* Input  : Array of phase difference data */
+    PdLibOutputData_t       *pfa_PdLibOutputData,           /* Output : Array of output data structure */
+    signed long             *pfa_PdLibResult                /* Output : Array of return value of each window */
+)
 {
     signed long ret;
-    signed long RetCheckInput;
-    PdLibOutputData_t PdLibOutputData;
+    PdLibInputData_t InputData;
+    PdLibKnotIndex_t KnotIndex;
+    PdLibProfileState_t Profile;
 
-    job_init_output_data ( pfa_PdLibOutputData );           /* Initialization of  output data structure */
+    /* Set calibration data to input data structure */
+    job_set_input_calib ( pfa_PdLibCalibData, fa_ImagerAnalogGain, &InputData );
 
-    RetCheckInput = job_check_input ( pfa_PdLibInputData ); /* Check value of input data structure */
+    job_get_lib_profile ( &Profile );                       /* Sensor profile of the whole call */
 
-    if ( RetCheckInput != D_PD_LIB_E_OK ) {                 /* Check the value of input */
-        ret = RetCheckInput;
+    ret = job_check_input_image ( &InputData );             /* Check size of image */
+
+    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
+        ret = job_check_input_calib ( &InputData, &Profile );   /* Check calibration data */
+    }
+
+    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
+        job_init_knot_index ( &InputData, &KnotIndex );     /* Build index of knots once for all windows */
+    }
+
+    /* Calculate output data of each window */
+    job_get_defocus_batch ( &InputData, &KnotIndex, NULL, ret, &Profile, NULL, fa_WindowNum, pfa_PdLibWindow, pfa_PdLibPhaseDiffData, pfa_PdLibOutputData, pfa_PdLibResult );
+
+    return ret;                                             /* Return result of calibration data */
+}
+
+/* API : Create context and copy calibration data to it. */
+/* Values of calibration data are not checked here. PdLibValidateContext() must be called before use. */
+extern signed long PdLibCreateContext 
+(
+    PdLibCalibData_t        *pfa_PdLibCalibData,            /* Input  : Calibration data structure */
+    PdLibContext_t          **ppfa_PdLibContext             /* Output : Created context */
+)
+{
+    PdLibContext_t *p_Context;
+
+    signed long ret;
+
+    (*ppfa_PdLibContext) = NULL;
+
+    ret = job_check_context_calib ( pfa_PdLibCalibData );   /* Check tables read by copy */
+
+    if ( ret != D_PD_LIB_E_OK ) {                           /* Check result */
         return ret;                                         /* Return error value */
-    } else {
-        ret = D_PD_LIB_E_OK;                                /* Set return value as OK */
     }
 
-    job_calc_defocus ( pfa_PdLibInputData, &(PdLibOutputData.Defocus) );    /* Calculate defocus */
+    /* Allocate context and tables of calibration data in one block */
+    p_Context = (PdLibContext_t *)malloc ( job_calc_context_size ( pfa_PdLibCalibData ) );
 
-    /* Check XKnotNumDefocusOKNG and YKnotNumDefocusOKNG */ 
-    if ((pfa_PdLibInputData->XKnotNumDefocusOKNG != 0) && (pfa_PdLibInputData->YKnotNumDefocusOKNG != 0)) {
-        /* Check the value of input */
-        if ( (*pfa_PdLibInputData).PhaseDifference != ( D_PD_ERROR_VALUE << 4 ) ) {
-            /* Calculate defocus confidence level */
-            job_calc_defocus_confidence_level(pfa_PdLibInputData, &(PdLibOutputData.DefocusConfidenceLevel));
-            /* Calculate defocus confidence */
-            job_calc_defocus_confidence ( PdLibOutputData.DefocusConfidenceLevel, &(PdLibOutputData.DefocusConfidence) );
-        } else {                                            /* Error of phase difference */
-            PdLibOutputData.DefocusConfidenceLevel = 0;     /* Set defocus confidence level as Zero */
-            PdLibOutputData.DefocusConfidence = -EPDVALERR; /* Set defocus confidence as input error */
-        }
+    if ( p_Context == NULL ) {                              /* Check result of allocation */
+        return -EALLOCCTX;                                  /* Return error value */
+    }
 
-    } else {                                                /* Error of XKnotNumDefocusOKNG or YKnotNumDefocusOKNG */
-        PdLibOutputData.DefocusConfidenceLevel = 0;         /* Set defocus confidence level as Zero */
-        PdLibOutputData.DefocusConfidence = -ENCWDDON;      /* Set defocus confidence as NCW */
+    job_copy_context_calib ( pfa_PdLibCalibData, p_Context );   /* Copy calibration data */
+
+    job_init_context ( p_Context );                         /* Set as not validated */
+
+    (*ppfa_PdLibContext) = p_Context;
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Create context which uses tables of calibration image in place. */
+/* Calibration data is not copied, and the image must be kept until the context is destroyed. */
+/* Checksum is not checked here. PdLibValidateContext() must be called before use. */
+extern signed long PdLibCreateContextFromImage 
+(
+    const void              *pfa_Image,                     /* Input  : Calibration image */
+    unsigned long           fa_ImageSize,                   /* Input  : Size of calibration image */
+    unsigned long           fa_SensorMode,                  /* Input  : Sensor mode in calibration image */
+    PdLibContext_t          **ppfa_PdLibContext             /* Output : Created context */
+)
+{
+    PdLibContext_t *p_Context;
+    PdLibCalibData_t CalibData;
+    DefocusOKNGThrLine_t *p_ThrLine;
+    unsigned long LineNum;
+    unsigned long KnotNum;
+
+    (*ppfa_PdLibContext) = NULL;
+
+    /* Get number of threshold lines of the sensor mode */
+    if ( CalibImageGetMode ( pfa_Image, fa_ImageSize, fa_SensorMode, &CalibData, NULL, &LineNum ) != D_CALIB_IMAGE_OK ) {
+        return -EINVALIMG;                                  /* Return error value */
     }
 
-    /* Calculate phase difference */
-    job_calc_phase_difference ( pfa_PdLibInputData, &(PdLibOutputData.PhaseDifference) );
+    KnotNum = (unsigned long)CalibData.XKnotNumSlopeOffset * CalibData.YKnotNumSlopeOffset;
 
-    (*pfa_PdLibOutputData) = PdLibOutputData;               /* Set result of job_calc_phase_difference() */
+    /* Allocate context, pointers of threshold lines, cache of threshold and packed slope and offset in one block */
+    p_Context = (PdLibContext_t *)malloc ( sizeof(PdLibContext_t) + ( sizeof(DefocusOKNGThrLine_t) + sizeof(signed long) ) * LineNum +
+                                           job_calc_packed_size ( KnotNum, 0, 0 ) );
 
-    return ret;                                             /* Return OK */
+    if ( p_Context == NULL ) {                              /* Check result of allocation */
+        return -EALLOCCTX;                                  /* Return error value */
+    }
+
+    p_ThrLine = (DefocusOKNGThrLine_t *)(p_Context + 1);
+    (*p_Context).p_ThrCache = (signed long *)(p_ThrLine + LineNum);
+
+    /* Point threshold lines to the tables of image */
+    (void)CalibImageGetMode ( pfa_Image, fa_ImageSize, fa_SensorMode, &CalibData, p_ThrLine, &LineNum );
+
+    /* Pack slope and offset. Threshold lines are used in place. */
+    (void)job_pack_context_calib ( &CalibData, 0, &((*p_Context).Packed), (unsigned char *)((*p_Context).p_ThrCache + LineNum) );
+
+    job_set_input_calib ( &CalibData, 0, &((*p_Context).InputData) );
+
+    job_init_context ( p_Context );                         /* Set as not validated */
+
+    (*ppfa_PdLibContext) = p_Context;
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
 }
 
-/****************************************************************/
-/*                       local function                         */
-/****************************************************************/
-/* Function for initializing output data structure */
-static void job_init_output_data 
-( 
-    PdLibOutputData_t *pfa_OutputData                       /* Output : Output data structure */
+/* API : Create context from OTP / EEPROM dump. */
+/* Counts of the block are read first to size the context, and then tables are decoded into it. */
+extern signed long PdLibCreateContextFromOtp 
+(
+    const unsigned char     *pfa_Data,                      /* Input  : OTP / EEPROM dump */
+    unsigned long           fa_DataSize,                    /* Input  : Size of dump */
+    PdLibOtpFormat_t        *pfa_Format,                    /* Input  : Format of PDAF calibration block */
+    PdLibContext_t          **ppfa_PdLibContext             /* Output : Created context */
 )
 {
-    (*pfa_OutputData).Defocus                = 0;
-    (*pfa_OutputData).DefocusConfidence      = D_PD_LIB_E_NG;
-    (*pfa_OutputData).DefocusConfidenceLevel = 0;
-    (*pfa_OutputData).PhaseDifference        = 0;
+    PdLibContext_t *p_Context;
+    PdLibCalibData_t CalibData;
+    PdLibSensorProfile_t Profile;
+    PdLibProfileState_t LibProfile;
+    OtpTableNum_t TableNum;
+    unsigned long KnotNum;
+    unsigned char *p_Table;
+    unsigned char *p_Packed;
+
+    (*ppfa_PdLibContext) = NULL;
+
+    /* Check the block and get size of its tables */
+    if ( pfa_Format == NULL || OtpGetTableNum ( pfa_Data, fa_DataSize, pfa_Format, &TableNum ) != D_OTP_DECODER_OK ) {
+        return -EINVALOTP;                                  /* Return error value */
+    }
 
-    return ;
+    /* Sensor profile of PDAF Library with error value of phase difference of the format */
+    job_get_lib_profile ( &LibProfile );
+    Profile = LibProfile.Profile;
+    Profile.PdErrorValue = (*pfa_Format).PdErrorValue;
+
+    if ( job_check_profile ( &Profile ) != D_PD_LIB_E_OK ) {
+        return -EINVALOTP;                                  /* Return error value */
+    }
+
+    KnotNum = (unsigned long)TableNum.XKnotNumSlopeOffset * TableNum.YKnotNumSlopeOffset;
+
+    /* Allocate context and tables in one block in the same order as job_copy_context_calib() */
+    p_Context = (PdLibContext_t *)malloc ( sizeof(PdLibContext_t) +
+                                           sizeof(DefocusOKNGThrLine_t) * TableNum.LineNum +
+                                           sizeof(signed long) * ( KnotNum * 2 + TableNum.LineNum ) +
+                                           sizeof(unsigned long) * TableNum.DataNum * 2 +
+                                           job_calc_packed_size ( KnotNum, 0, 0 ) +
+                                           sizeof(unsigned short) * ( TableNum.XKnotNumSlopeOffset + TableNum.YKnotNumSlopeOffset +
+                                                                      TableNum.XKnotNumDefocusOKNG + TableNum.YKnotNumDefocusOKNG ) );
+
+    if ( p_Context == NULL ) {                              /* Check result of allocation */
+        return -EALLOCCTX;                                  /* Return error value */
+    }
+
+    p_Table = (unsigned char *)(p_Context + 1);             /* Tables follow context */
+
+    CalibData.p_DefocusOKNGThrLine = (DefocusOKNGThrLine_t *)p_Table;
+    p_Table += sizeof(DefocusOKNGThrLine_t) * TableNum.LineNum;
+    CalibData.p_SlopeData = (signed long *)p_Table;
+    p_Table += sizeof(signed long) * KnotNum;
+    CalibData.p_OffsetData = (signed long *)p_Table;
+    p_Table += sizeof(signed long) * KnotNum;
+    (*p_Context).p_ThrCache = (signed long *)p_Table;       /* Set by job_update_thr_cache() */
+    p_Table += sizeof(signed long) * TableNum.LineNum;
+    p_Table += sizeof(unsigned long) * TableNum.DataNum * 2;    /* Analog gain and confidence, decoded below */
+    p_Packed = p_Table;                                     /* Packed slope and offset, packed below */
+    p_Table += job_calc_packed_size ( KnotNum, 0, 0 );
+    CalibData.p_XAddressKnotSlopeOffset = (unsigned short *)p_Table;
+    p_Table += sizeof(unsigned short) * TableNum.XKnotNumSlopeOffset;
+    CalibData.p_YAddressKnotSlopeOffset = (unsigned short *)p_Table;
+    p_Table += sizeof(unsigned short) * TableNum.YKnotNumSlopeOffset;
+    CalibData.p_XAddressKnotDefocusOKNG = (unsigned short *)p_Table;
+    p_Table += sizeof(unsigned short) * TableNum.XKnotNumDefocusOKNG;
+    CalibData.p_YAddressKnotDefocusOKNG = (unsigned short *)p_Table;
+
+    /* Decode the block to the tables */
+    OtpDecode ( pfa_Data, pfa_Format, &CalibData,
+                (unsigned long *)( (unsigned char *)(*p_Context).p_ThrCache + sizeof(signed long) * TableNum.LineNum ) );
+
+    /* Pack slope and offset. Threshold lines are used where they are decoded. */
+    (void)job_pack_context_calib ( &CalibData, 0, &((*p_Context).Packed), p_Packed );
+
+    job_set_input_calib ( &CalibData, 0, &((*p_Context).InputData) );
+
+    job_init_context ( p_Context );                         /* Set as not validated */
+
+    job_set_profile ( &Profile, &((*p_Context).Profile) );
+
+    (*ppfa_PdLibContext) = p_Context;
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
 }
 
-/* Function for checking value of input data structure */
-static signed long job_check_input 
-( 
-    PdLibInputData_t *pfa_InputData                         /* Input : Input data structure */
+/* API : Get size of scratch buffer of context, registered windows and defocus map. */
+extern signed long PdLibQueryScratchSize 
+(
+    PdLibCalibData_t        *pfa_PdLibCalibData,            /* Input  : Calibration data structure, or NULL */
+    unsigned long           fa_WindowNum,                   /* Input  : Maximum number of registered windows */
+    unsigned long           fa_XCellNum,                    /* Input  : Maximum number of cells in x-direction */
+    unsigned long           fa_YCellNum,                    /* Input  : Maximum number of cells in y-direction */
+    unsigned long           *pfa_ScratchSize                /* Output : Size of scratch buffer */
+)
+{
+    unsigned long ContextSize;
+    unsigned long WindowSize;
+    unsigned long MapSize;
+
+    if ( pfa_ScratchSize == NULL ) {                        /* Check output */
+        return -EINVALSCRATCH;                              /* Return error value */
+    }
+
+    return job_calc_scratch_size ( pfa_PdLibCalibData, fa_WindowNum, fa_XCellNum, fa_YCellNum,
+                                   &ContextSize, &WindowSize, &MapSize, pfa_ScratchSize );
+}
+
+/* API : Create context in scratch buffer and copy calibration data to it. */
+/* Values of calibration data are not checked here. PdLibValidateContext() must be called before use. */
+extern signed long PdLibCreateContextWithScratch 
+(
+    PdLibCalibData_t        *pfa_PdLibCalibData,            /* Input  : Calibration data structure */
+    unsigned long           fa_WindowNum,                   /* Input  : Maximum number of registered windows */
+    unsigned long           fa_XCellNum,                    /* Input  : Maximum number of cells in x-direction */
+    unsigned long           fa_YCellNum,                    /* Input  : Maximum number of cells in y-direction */
+    void                    *pfa_Scratch,                   /* Input  : Scratch buffer */
+    unsigned long           fa_ScratchSize,                 /* Input  : Size of scratch buffer */
+    PdLibContext_t          **ppfa_PdLibContext             /* Output : Created context */
 )
 {
     signed long ret;
+    unsigned long ContextSize;
+    unsigned long WindowSize;
+    unsigned long MapSize;
+    unsigned long ScratchSize;
+    size_t Address;
+    PdLibContext_t *p_Context;
 
-    ret = D_PD_LIB_E_OK;                                    /* Set return value as OK */
+    (*ppfa_PdLibContext) = NULL;
 
-    /* Check the value of input */
-    /* Check XSizeOfImage */
-    if ( 2 <= (*pfa_InputData).XSizeOfImage ) {             /* Check XSizeOfImage */
-    } else {
-        ret = -EINXSOI;                                     /* Out of range of XSizeOfImage */
+    if ( pfa_PdLibCalibData == NULL ) {                     /* Calibration data is copied to scratch buffer */
+        return -EINVALSCRATCH;                              /* Return error value */
     }
-    /* Check YSizeOfImage */
-    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
-        if ( 2 <= (*pfa_InputData).YSizeOfImage ) {         /* Check YSizeOfImage */
-        } else {
-            ret = -EINYSOI;                                 /* Out of range of YSizeOfImage */
-        }
+
+    ret = job_calc_scratch_size ( pfa_PdLibCalibData, fa_WindowNum, fa_XCellNum, fa_YCellNum,
+                                  &ContextSize, &WindowSize, &MapSize, &ScratchSize );
+
+    if ( ret != D_PD_LIB_E_OK ) {                           /* Check result */
+        return ret;                                         /* Return error value */
     }
-    /* Check PDAFWindowsX */
-    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
-        if ( ( (*pfa_InputData).XAddressOfWindowStart <= ( (*pfa_InputData).XAddressOfWindowEnd - 1 ) ) &&
-             ( (*pfa_InputData).XAddressOfWindowEnd <= ( (*pfa_InputData).XSizeOfImage - 1 ) ) ) {
-        } else {
-            ret = -EINPDAFWX;                               /* Out of range of PDAFWindowsX */
-        }
+
+    if ( pfa_Scratch == NULL || fa_ScratchSize < ScratchSize ) {    /* Check scratch buffer */
+        return -EINVALSCRATCH;                              /* Return error value */
     }
-    /* Check PDAFWindowsY */
-    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
-        if ( ( (*pfa_InputData).YAddressOfWindowStart <= ( (*pfa_InputData).YAddressOfWindowEnd - 1 ) ) &&
-             ( (*pfa_InputData).YAddressOfWindowEnd <= ( (*pfa_InputData).YSizeOfImage - 1 ) ) ) {
-        } else {
-            ret = -EINPDAFWY;                               /* Out of range of PDAFWindowsY */
-        }
+
+    Address = ( (size_t)pfa_Scratch + D_SCRATCH_ALIGN - 1 ) & ~(size_t)( D_SCRATCH_ALIGN - 1 );
+    p_Context = (PdLibContext_t *)Address;
+
+    job_copy_context_calib ( pfa_PdLibCalibData, p_Context );   /* Copy calibration data */
+
+    job_init_context ( p_Context );                         /* Set as not validated */
+
+    /* Registration follows context and tables */
+    (*p_Context).p_Scratch         = (unsigned char *)Address + ContextSize;
+    (*p_Context).ScratchWindowSize = WindowSize;
+    (*p_Context).ScratchMapSize    = MapSize;
+    (*p_Context).ScratchContext    = 1;
+
+    (*ppfa_PdLibContext) = p_Context;
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Set scratch buffer of registered windows and defocus map of context. */
+extern signed long PdLibSetContextScratch 
+(
+    PdLibContext_t          *pfa_PdLibContext,              /* In/Out : Context */
+    unsigned long           fa_WindowNum,                   /* Input  : Maximum number of registered windows */
+    unsigned long           fa_XCellNum,                    /* Input  : Maximum number of cells in x-direction */
+    unsigned long           fa_YCellNum,                    /* Input  : Maximum number of cells in y-direction */
+    void                    *pfa_Scratch,                   /* Input  : Scratch buffer */
+    unsigned long           fa_ScratchSize                  /* Input  : Size of scratch buffer */
+)
+{
+    signed long ret;
+    unsigned long ContextSize;
+    unsigned long WindowSize;
+    unsigned long MapSize;
+    unsigned long ScratchSize;
+    size_t Address;
+
+    if ( pfa_PdLibContext == NULL ) {                       /* Check context */
+        return -EINVALCTX;                                  /* Return error value */
     }
-    /* Check Slope and Offset (defocus vs phase difference) */
-    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
-        if ( 2 <= (*pfa_InputData).XKnotNumSlopeOffset &&
-             2 <= (*pfa_InputData).YKnotNumSlopeOffset ) {
-        } else {
-            ret = -EINSO;                                   /* Out of range of SlopeOffset */
-        }
+
+    ret = job_calc_scratch_size ( NULL, fa_WindowNum, fa_XCellNum, fa_YCellNum,
+                                  &ContextSize, &WindowSize, &MapSize, &ScratchSize );
+
+    if ( ret != D_PD_LIB_E_OK ) {                           /* Check result */
+        return ret;                                         /* Return error value */
     }
-    /* Check AdjCoeffSlope */
-    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
-        if ( ( (*pfa_InputData).AdjCoeffSlope == D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE0 ) ||
-             ( (*pfa_InputData).AdjCoeffSlope == D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE1 ) ||
-             ( (*pfa_InputData).AdjCoeffSlope == D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE2 ) ||
-             ( (*pfa_InputData).AdjCoeffSlope == D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE3 ) ||
-             ( (*pfa_InputData).AdjCoeffSlope == D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE4 ) ) {
-        } else {
-            ret = -EINACS;                                  /* Out of range of AdjCoeffSlope */
-        }
+
+    if ( pfa_Scratch == NULL || fa_ScratchSize < ScratchSize ) {    /* Check scratch buffer */
+        return -EINVALSCRATCH;                              /* Return error value */
     }
-    /* Check SlopeOffsetXAddressKnot */
-    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
-        unsigned short i;
-        unsigned short XKnotNum;
-        unsigned short *p_XAddressKnot;
-        
-        XKnotNum = (*pfa_InputData).XKnotNumSlopeOffset;
-        p_XAddressKnot = (*pfa_InputData).p_XAddressKnotSlopeOffset;
-        for ( i = 0; i < ( XKnotNum - 1 ); i++ ) {
-            if ( p_XAddressKnot[i] < p_XAddressKnot[i + 1] ){
-            } else {
-                ret = -EINSOXAK;                            /* Out of range of SlopeOffsetXAddressKnot */
-                break ;
-            }
-        }
+
+    job_release_registration ( pfa_PdLibContext );          /* Release registration made before */
+
+    Address = ( (size_t)pfa_Scratch + D_SCRATCH_ALIGN - 1 ) & ~(size_t)( D_SCRATCH_ALIGN - 1 );
+
+    (*pfa_PdLibContext).p_Scratch         = (unsigned char *)Address;
+    (*pfa_PdLibContext).ScratchWindowSize = WindowSize;
+    (*pfa_PdLibContext).ScratchMapSize    = MapSize;
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Get built-in sensor profile. */
+extern signed long PdLibGetSensorProfile 
+(
+    unsigned long           fa_ProfileIndex,                /* Input  : D_PD_LIB_SENSOR_PROFILE_XXX */
+    PdLibSensorProfile_t    *pfa_Profile                    /* Output : Sensor profile */
+)
+{
+    if ( fa_ProfileIndex >= D_PD_LIB_SENSOR_PROFILE_NUM ) { /* Check index of profile */
+        return -EINVALPROF;                                 /* Return error value */
     }
-    /* Check SlopeOffsetYAddressKnot */
+
+    (*pfa_Profile) = s_SensorProfile[fa_ProfileIndex];
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Set sensor profile of APIs without context. */
+extern signed long PdLibSetSensorProfile 
+(
+    const PdLibSensorProfile_t *pfa_Profile                 /* Input  : Sensor profile */
+)
+{
+    signed long ret;
+    PdLibProfileState_t ProfileState;
+
+    ret = job_check_profile ( pfa_Profile );                /* Check sensor profile */
+
     if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
-        unsigned short i;
-        unsigned short YKnotNum;
-        unsigned short *p_YAddressKnot;
-        
-        YKnotNum = (*pfa_InputData).YKnotNumSlopeOffset;
-        p_YAddressKnot = (*pfa_InputData).p_YAddressKnotSlopeOffset;
-        for ( i = 0; i < ( YKnotNum - 1 ); i++ ) {
-            if ( p_YAddressKnot[i] < p_YAddressKnot[i + 1] ) {
-            } else {
-                ret = -EINSOYAK;                            /* Out of range of SlopeOffsetYAddressKnot */
-                break ;
-            }
-        }
+        job_set_profile ( pfa_Profile, &ProfileState );
+        job_set_lib_profile ( &ProfileState );              /* Replace profile read by other threads */
     }
-    /* Check Defocus OK/NG */
+
+    return ret;                                             /* Return result */
+}
+
+/* API : Set sensor profile of context. */
+extern signed long PdLibSetContextSensorProfile 
+(
+    PdLibContext_t          *pfa_PdLibContext,              /* In/Out : Context */
+    const PdLibSensorProfile_t *pfa_Profile                 /* Input  : Sensor profile */
+)
+{
+    signed long ret;
+
+    if ( pfa_PdLibContext == NULL ) {                       /* Check context */
+        return -EINVALCTX;                                  /* Return error value */
+    }
+
+    ret = job_check_profile ( pfa_Profile );                /* Check sensor profile */
+
     if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
-        /* Check disable of the judge function of confidence */
-        if ( 0 == (*pfa_InputData).XKnotNumDefocusOKNG ||
-             0 == (*pfa_InputData).YKnotNumDefocusOKNG ) {
-            if ( 0 == (*pfa_InputData).XKnotNumDefocusOKNG &&
-                 0 == (*pfa_InputData).YKnotNumDefocusOKNG ) {
-            }
-            else {
-                ret = -EINVALDISCONFJ;                      /* Invalid of Disable Confidence Judgement */
+        job_set_profile ( pfa_Profile, &((*pfa_PdLibContext).Profile) );
+        (*pfa_PdLibContext).ValidateResult = -EINVALCTX;    /* Calibration data is checked with new profile */
+    }
+
+    return ret;                                             /* Return result */
+}
+
+/* API : Switch sensor mode of context. */
+/* Values of the mode are taken from sensor profile of context, and calibration data is shared by all modes. */
+/* A validated context takes the result of validation of the mode, which is kept by PdLibValidateContext(). */
+extern signed long PdLibSetContextSensorMode 
+(
+    PdLibContext_t          *pfa_PdLibContext,              /* In/Out : Context */
+    unsigned long           fa_SensMode                     /* Input  : Sensor mode */
+)
+{
+    PdLibSensorProfile_t *p_Profile;
+
+    if ( pfa_PdLibContext == NULL ) {                       /* Check context */
+        return -EINVALCTX;                                  /* Return error value */
+    }
+
+    if ( fa_SensMode >= D_PD_LIB_SENS_MODE_NUM ) {          /* Check sensor mode */
+        return -EINVALPROF;                                 /* Return error value */
+    }
+
+    p_Profile = &((*pfa_PdLibContext).Profile.Profile);
+
+    (*pfa_PdLibContext).InputData.DensityOfPhasePix = (*p_Profile).DensityOfPhasePix[fa_SensMode];
+
+    if ( (*pfa_PdLibContext).InputData.AdjCoeffSlope != (*p_Profile).AdjCoeffSlope[fa_SensMode] ) {
+        (*pfa_PdLibContext).InputData.AdjCoeffSlope = (*p_Profile).AdjCoeffSlope[fa_SensMode];
+        (*pfa_PdLibContext).RegCoeffValid = 0;              /* Slope of registered windows is set at next evaluation */
+        (*pfa_PdLibContext).RegMap.CoeffValid = 0;          /* Slope of registered defocus map as well */
+    }
+
+    if ( (*pfa_PdLibContext).ValidateResult != -EINVALCTX ) {  /* Result with AdjCoeffSlope and DensityOfPhasePix of the mode */
+        (*pfa_PdLibContext).ValidateResult = (*pfa_PdLibContext).ModeResult[fa_SensMode];
+
+        return (*pfa_PdLibContext).ValidateResult;
+    }
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Check calibration data of context. */
+extern signed long PdLibValidateContext 
+(
+    PdLibContext_t          *pfa_PdLibContext               /* Input  : Context */
+)
+{
+    signed long ret;
+    signed long RetCheckImage;
+    unsigned long i;
+    unsigned char IndexKnot;
+    PdLibInputData_t InputData;
+    PdLibSensorProfile_t *p_Profile;
+
+    if ( pfa_PdLibContext == NULL ) {                       /* Check context */
+        return -EINVALCTX;                                  /* Return error value */
+    }
+
+    RetCheckImage = job_check_input_image ( &((*pfa_PdLibContext).InputData) );  /* Check size of image */
+
+    ret = RetCheckImage;
+
+    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
+        /* Check calibration data with sensor profile of context */
+        ret = job_check_input_calib ( &((*pfa_PdLibContext).InputData), &((*pfa_PdLibContext).Profile) );
+    }
+
+    IndexKnot = ( ret == D_PD_LIB_E_OK ) ? 1 : 0;
+
+    /* Check calibration data with values of each sensor mode for PdLibSetContextSensorMode() */
+    InputData = (*pfa_PdLibContext).InputData;
+    p_Profile = &((*pfa_PdLibContext).Profile.Profile);
+
+    for ( i = 0; i < D_PD_LIB_SENS_MODE_NUM; i++ ) {
+        (*pfa_PdLibContext).ModeResult[i] = RetCheckImage;
+
+        if ( RetCheckImage == D_PD_LIB_E_OK ) {             /* Check return value */
+            InputData.AdjCoeffSlope     = (*p_Profile).AdjCoeffSlope[i];
+            InputData.DensityOfPhasePix = (*p_Profile).DensityOfPhasePix[i];
+
+            (*pfa_PdLibContext).ModeResult[i] = job_check_input_calib ( &InputData, &((*pfa_PdLibContext).Profile) );
+        }
+
+        if ( (*pfa_PdLibContext).ModeResult[i] == D_PD_LIB_E_OK ) {
+            IndexKnot = 1;                                  /* Knots are used after switch of sensor mode */
+        }
+    }
+
+    if ( IndexKnot != 0 ) {                                 /* Check knots */
+        /* Build index of knots of the context */
+        job_init_knot_index ( &((*pfa_PdLibContext).InputData), &((*pfa_PdLibContext).KnotIndex) );
+        (*pfa_PdLibContext).KnotIndex.p_Packed = &((*pfa_PdLibContext).Packed);
+    }
+
+    (*pfa_PdLibContext).ValidateResult   = ret;             /* Keep result for evaluation */
+    (*pfa_PdLibContext).ThrCacheValid    = 0;
+    (*pfa_PdLibContext).RegThrCacheValid = 0;
+    (*pfa_PdLibContext).RegMap.ThrCacheValid = 0;
+
+    return ret;                                             /* Return result */
+}
+
+/* API : Destroy context. */
+extern void PdLibDestroyContext 
+(
+    PdLibContext_t          *pfa_PdLibContext               /* Input  : Context */
+)
+{
+    if ( pfa_PdLibContext == NULL ) {                       /* Check context */
+        return ;
+    }
+
+    job_release_registration ( pfa_PdLibContext );          /* Registered windows and defocus map */
+
+    if ( (*pfa_PdLibContext).ScratchContext == 0 ) {        /* Scratch buffer is released by caller */
+        free ( pfa_PdLibContext );                          /* Tables are allocated with context */
+    }
+
+    return ;
+}
+
+/* API : Create slot of hot-swapped context. */
+extern signed long PdLibCreateContextSlot 
+(
+    PdLibContext_t          *pfa_PdLibContext,              /* Input  : First context */
+    PdLibContextSlot_t      **ppfa_PdLibContextSlot         /* Output : Created slot */
+)
+{
+    PdLibContextSlot_t *p_Slot;
+
+    (*ppfa_PdLibContextSlot) = NULL;
+
+    if ( pfa_PdLibContext == NULL ) {                       /* Check context */
+        return -EINVALCTX;                                  /* Return error value */
+    }
+
+    p_Slot = (PdLibContextSlot_t *)malloc ( sizeof(PdLibContextSlot_t) );
+
+    if ( p_Slot == NULL ) {                                 /* Check result of allocation */
+        return -EALLOCSLOT;                                 /* Return error value */
+    }
+
+    job_publish_context ( pfa_PdLibContext );               /* Complete caches before readers share the context */
+
+    if ( HotSwapCreate ( pfa_PdLibContext, &((*p_Slot).p_HotSwap) ) != D_HOT_SWAP_OK ) {
+        free ( p_Slot );
+        return -EALLOCSLOT;                                 /* Return error value */
+    }
+
+    (*ppfa_PdLibContextSlot) = p_Slot;
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Destroy slot and its context. */
+extern void PdLibDestroyContextSlot 
+(
+    PdLibContextSlot_t      *pfa_PdLibContextSlot           /* Input  : Slot */
+)
+{
+    if ( pfa_PdLibContextSlot != NULL ) {                   /* Check slot */
+        PdLibDestroyContext ( (PdLibContext_t *)HotSwapDestroy ( (*pfa_PdLibContextSlot).p_HotSwap ) );
+    }
+
+    free ( pfa_PdLibContextSlot );
+
+    return ;
+}
+
+/* API : Replace context of slot. */
+/* Evaluations on the replaced context end before it is destroyed. */
+extern signed long PdLibPublishContext 
+(
+    PdLibContextSlot_t      *pfa_PdLibContextSlot,          /* Input  : Slot */
+    PdLibContext_t          *pfa_PdLibContext               /* Input  : New context */
+)
+{
+    if ( pfa_PdLibContextSlot == NULL || pfa_PdLibContext == NULL ) {  /* Check slot and context */
+        return -EINVALCTX;                                  /* Return error value */
+    }
+
+    job_publish_context ( pfa_PdLibContext );               /* Complete caches before readers share the context */
+
+    /* Wait for release of replaced context and destroy it */
+    PdLibDestroyContext ( (PdLibContext_t *)HotSwapPublish ( (*pfa_PdLibContextSlot).p_HotSwap, pfa_PdLibContext ) );
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Acquire current context of slot. */
+extern signed long PdLibAcquireContext 
+(
+    PdLibContextSlot_t      *pfa_PdLibContextSlot,          /* Input  : Slot */
+    PdLibContext_t          **ppfa_PdLibContext,            /* Output : Current context */
+    unsigned long           *pfa_Ticket                     /* Output : Ticket of release */
+)
+{
+    if ( pfa_PdLibContextSlot == NULL ) {                   /* Check slot */
+        (*ppfa_PdLibContext) = NULL;
+        return -EINVALCTX;                                  /* Return error value */
+    }
+
+    (*ppfa_PdLibContext) = (PdLibContext_t *)HotSwapEnter ( (*pfa_PdLibContextSlot).p_HotSwap, pfa_Ticket );
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Release context acquired from slot. */
+extern void PdLibReleaseContext 
+(
+    PdLibContextSlot_t      *pfa_PdLibContextSlot,          /* Input  : Slot */
+    unsigned long           fa_Ticket                       /* Input  : Ticket of PdLibAcquireContext() */
+)
+{
+    if ( pfa_PdLibContextSlot != NULL ) {                   /* Check slot */
+        HotSwapExit ( (*pfa_PdLibContextSlot).p_HotSwap, fa_Ticket );
+    }
+
+    return ;
+}
+
+/* API : Get defocus data according to a PDAF window with validated context. */
+extern signed long PdLibGetDefocusWithContext 
+(
+    PdLibContext_t          *pfa_PdLibContext,              /* Input  : Validated context */
+    PdLibWindow_t           *pfa_PdLibWindow,               /* Input  : PDAF window */
+    PdLibPhaseDiffData_t    *pfa_PdLibPhaseDiffData,        /* Input  : Phase difference data */
+    unsigned long           fa_ImagerAnalogGain,            /* Input  : Image sensor analog gain */
+    PdLibOutputData_t       *pfa_PdLibOutputData            /* Output : Output data structure */
+)
+{
+    signed long ret;
+
+    /* Calculate as a batch of one window. Result of context is also set to result of the window. */
+    (void)PdLibGetDefocusBatchWithContext ( pfa_PdLibContext, fa_ImagerAnalogGain, 1,
+                                            pfa_PdLibWindow, pfa_PdLibPhaseDiffData, pfa_PdLibOutputData, &ret );
+
+    return ret;                                             /* Return result of the window */
+}
+
+/* API : Get defocus data of all PDAF windows in a frame with validated context. */
+/* Return value and pfa_PdLibResult are the same as PdLibGetDefocusBatch(). */
+extern signed long PdLibGetDefocusBatchWithContext 
+(
+    PdLibContext_t          *pfa_PdLibContext,              /* Input  : Validated context */
+    unsigned long           fa_ImagerAnalogGain,            /* Input  : Image sensor analog gain */
+    unsigned long           fa_WindowNum,                   /* Input  : Number of windows */
+    PdLibWindow_t           *pfa_PdLibWindow,               /* Input  : Array of PDAF windows */
+    PdLibPhaseDiffData_t    *pfa_PdLibPhaseDiffData,        /* Input  : Array of phase difference data */
+    PdLibOutputData_t       *pfa_PdLibOutputData,           /* Output : Array of output data structure */
+    signed long             *pfa_PdLibResult                /* Output : Array of return value of each window */
+)
+{
+    signed long ret;
+    PdLibInputData_t InputData;
+    PdLibKnotIndex_t *p_KnotIndex;
+    signed long *p_ThrCache;
+    PdLibProfileState_t *p_Profile;
+    PdLibProfileState_t LibProfile;
+    Trace_t *p_Trace;
+
+    if ( pfa_PdLibContext != NULL ) {                       /* Check context */
+        ret = (*pfa_PdLibContext).ValidateResult;
+        InputData = (*pfa_PdLibContext).InputData;          /* Copy calibration data of context */
+        InputData.ImagerAnalogGain = fa_ImagerAnalogGain;
+        p_KnotIndex = &((*pfa_PdLibContext).KnotIndex);
+        p_ThrCache  = NULL;
+        p_Profile   = &((*pfa_PdLibContext).Profile);
+        p_Trace     = job_get_trace ( pfa_PdLibContext );
+
+        if ( ret == D_PD_LIB_E_OK ) {                       /* Check result of validation */
+            p_ThrCache = job_use_thr_cache ( pfa_PdLibContext, fa_ImagerAnalogGain );  /* Update threshold if gain is changed */
+        }
+    } else {
+        ret = -EINVALCTX;
+        p_KnotIndex = NULL;                                 /* Not used for error */
+        p_ThrCache  = NULL;
+        p_Profile   = &LibProfile;
+        p_Trace     = NULL;
+
+        job_get_lib_profile ( &LibProfile );
+    }
+
+    /* Calculate output data of each window */
+    job_get_defocus_batch ( &InputData, p_KnotIndex, p_ThrCache, ret, p_Profile, p_Trace, fa_WindowNum, pfa_PdLibWindow, pfa_PdLibPhaseDiffData, pfa_PdLibOutputData, pfa_PdLibResult );
+
+    return ret;                                             /* Return result of context */
+}
+
+/* API : Register fixed PDAF windows and precompute their coefficients of defocus. */
+/* Windows registered before are replaced. When a window is invalid, its error value is returned */
+/* and no window is registered. */
+extern signed long PdLibRegisterWindows 
+(
+    PdLibContext_t          *pfa_PdLibContext,              /* Input  : Validated context */
+    unsigned long           fa_WindowNum,                   /* Input  : Number of windows */
+    PdLibWindow_t           *pfa_PdLibWindow                /* Input  : Array of PDAF windows */
+)
+{
+    signed long ret;
+    unsigned long i;
+    PdLibInputData_t InputData;
+    PdLibRegWindow_t *p_RegWindow;
+
+    if ( pfa_PdLibContext == NULL ) {                       /* Check context */
+        return -EINVALCTX;                                  /* Return error value */
+    }
+
+    if ( (*pfa_PdLibContext).p_Scratch == NULL ) {
+        free ( (*pfa_PdLibContext).p_RegWindow );           /* Release windows registered before */
+    }
+    (*pfa_PdLibContext).RegWindowNum = 0;
+    (*pfa_PdLibContext).p_RegWindow  = NULL;
+
+    ret = (*pfa_PdLibContext).ValidateResult;
+
+    if ( ret != D_PD_LIB_E_OK ) {                           /* Check result of validation */
+        return ret;                                         /* Return error value */
+    }
+
+    if ( ( (unsigned long)-1 / sizeof(PdLibRegWindow_t) ) - 1 < fa_WindowNum ) {
+        return -EALLOCCTX;                                  /* Size is out of range */
+    }
+
+    /* Windows are kept in scratch buffer of context, or allocated */
+    ret = job_alloc_registration ( pfa_PdLibContext, 0, sizeof(PdLibRegWindow_t) * ( fa_WindowNum + 1 ), (void **)&p_RegWindow );
+
+    if ( ret != D_PD_LIB_E_OK ) {                           /* Check result of allocation */
+        return ret;                                         /* Return error value */
+    }
+
+    InputData = (*pfa_PdLibContext).InputData;              /* Copy calibration data of context */
+
+    for ( i = 0; i < fa_WindowNum; i++ ) {
+        PdLibPhaseDiffData_t PhaseDiffData;
+
+        PhaseDiffData.PhaseDifference = 0;
+        PhaseDiffData.ConfidenceLevel = 0;
+
+        /* Set window to input data structure */
+        job_set_input_window ( &(pfa_PdLibWindow[i]), &PhaseDiffData, &InputData );
+
+        ret = job_check_input_window ( &InputData );        /* Check PDAF window */
+
+        if ( ret != D_PD_LIB_E_OK ) {                       /* Check the value of input */
+            if ( (*pfa_PdLibContext).p_Scratch == NULL ) {
+                free ( p_RegWindow );
+            }
+            return ret;                                     /* Return error value */
+        }
+
+        p_RegWindow[i].Window = pfa_PdLibWindow[i];
+
+        /* Calculate slope and offset at window center */
+        job_calc_defocus_coeff ( &InputData, &((*pfa_PdLibContext).KnotIndex), &(p_RegWindow[i].Slope), &(p_RegWindow[i].Offset),
+                                 &(p_RegWindow[i].AreaIndex) );
+    }
+
+    (*pfa_PdLibContext).RegWindowNum = fa_WindowNum;
+    (*pfa_PdLibContext).p_RegWindow  = p_RegWindow;
+    (*pfa_PdLibContext).RegThrCacheValid = 0;               /* Threshold of windows is set at next evaluation */
+    (*pfa_PdLibContext).RegCoeffValid    = 1;
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Get defocus data of all registered PDAF windows. */
+/* Return value and pfa_PdLibResult are the same as PdLibGetDefocusBatch(). */
+extern signed long PdLibGetDefocusRegisteredWindows 
+(
+    PdLibContext_t          *pfa_PdLibContext,              /* Input  : Validated context with registered windows */
+    unsigned long           fa_ImagerAnalogGain,            /* Input  : Image sensor analog gain */
+    PdLibPhaseDiffData_t    *pfa_PdLibPhaseDiffData,        /* Input  : Array of phase difference data */
+    PdLibOutputData_t       *pfa_PdLibOutputData,           /* Output : Array of output data structure */
+    signed long             *pfa_PdLibResult                /* Output : Array of return value of each window */
+)
+{
+    signed long ret;
+    unsigned long i;
+    PdLibInputData_t InputData;
+    PdLibKnotIndex_t *p_KnotIndex;
+
+    if ( pfa_PdLibContext == NULL ) {                       /* Check context */
+        return -EINVALCTX;                                  /* Return error value */
+    }
+
+    ret = (*pfa_PdLibContext).ValidateResult;
+    InputData = (*pfa_PdLibContext).InputData;              /* Copy calibration data of context */
+    InputData.ImagerAnalogGain = fa_ImagerAnalogGain;
+    p_KnotIndex = NULL;                                     /* Threshold of registered windows is used */
+
+    if ( ret == D_PD_LIB_E_OK ) {                           /* Check result of validation */
+        if ( job_use_thr_cache ( pfa_PdLibContext, fa_ImagerAnalogGain ) != NULL ) {  /* Update threshold if gain is changed */
+            job_update_reg_thr_cache ( pfa_PdLibContext );  /* Update threshold of windows if gain is changed */
+            job_update_reg_coeff ( pfa_PdLibContext );      /* Update slope and offset of windows if sensor mode is changed */
+        } else {
+            p_KnotIndex = &((*pfa_PdLibContext).KnotIndex); /* Published context at other gain calculates threshold of windows */
+        }
+    }
+
+    for ( i = 0; i < (*pfa_PdLibContext).RegWindowNum; i++ ) {
+        PdLibRegWindow_t *p_RegWindow;
+
+        p_RegWindow = &((*pfa_PdLibContext).p_RegWindow[i]);
+
+        job_init_output_data ( &(pfa_PdLibOutputData[i]) ); /* Initialization of  output data structure */
+
+        if ( ret != D_PD_LIB_E_OK ) {                       /* Error of calibration data */
+            pfa_PdLibResult[i] = ret;
+            continue ;
+        }
+
+        /* Set window and phase difference to input data structure. Window was checked at registration. */
+        job_set_input_window ( &((*p_RegWindow).Window), &(pfa_PdLibPhaseDiffData[i]), &InputData );
+
+        /* Calculate output data */
+        job_get_defocus_reg_window ( &InputData, p_RegWindow, p_KnotIndex, &((*pfa_PdLibContext).Profile), &(pfa_PdLibOutputData[i]) );
+
+        pfa_PdLibResult[i] = D_PD_LIB_E_OK;
+    }
+
+#if D_PD_LIB_TRACE_NUM
+    job_trace_windows ( &((*pfa_PdLibContext).Trace), &InputData, (*pfa_PdLibContext).p_RegWindow, (*pfa_PdLibContext).RegWindowNum,
+                        NULL, pfa_PdLibPhaseDiffData, pfa_PdLibOutputData, pfa_PdLibResult, NULL );
+#endif
+
+#if D_PD_LIB_STATS
+    for ( i = 0; i < (*pfa_PdLibContext).RegWindowNum; i++ ) {
+        job_stats_result ( pfa_PdLibResult[i] );
+    }
+#endif
+
+    return ret;                                             /* Return result of context */
+}
+
+/* API : Register defocus map and precompute coefficients of defocus of its cells. */
+/* Image is divided into cells and samples of phase difference in the same way, and each cell takes */
+/* the sample which contains its center. Map registered before is released. */
+extern signed long PdLibRegisterDefocusMap 
+(
+    PdLibContext_t          *pfa_PdLibContext,              /* Input  : Validated context */
+    unsigned long           fa_XCellNum,                    /* Input  : Number of cells in x-direction */
+    unsigned long           fa_YCellNum,                    /* Input  : Number of cells in y-direction */
+    unsigned long           fa_XSampleNum,                  /* Input  : Number of samples in x-direction */
+    unsigned long           fa_YSampleNum                   /* Input  : Number of samples in y-direction */
+)
+{
+    signed long ret;
+    unsigned long CellNum;
+    unsigned char *p_Buffer;
+    PdLibInputData_t *p_InputData;
+    PdLibRegMap_t *p_RegMap;
+
+    if ( pfa_PdLibContext == NULL ) {                       /* Check context */
+        return -EINVALCTX;                                  /* Return error value */
+    }
+
+    p_InputData = &((*pfa_PdLibContext).InputData);
+    p_RegMap    = &((*pfa_PdLibContext).RegMap);
+
+    if ( (*pfa_PdLibContext).p_Scratch == NULL ) {
+        free ( (*p_RegMap).p_Slope );                       /* Release map registered before */
+    }
+    (*p_RegMap).XCellNum = 0;
+    (*p_RegMap).p_Slope  = NULL;
+
+    ret = (*pfa_PdLibContext).ValidateResult;
+
+    if ( ret != D_PD_LIB_E_OK ) {                           /* Check result of validation */
+        return ret;                                         /* Return error value */
+    }
+
+    /* Each cell and sample has one pixel at least */
+    if ( 1 <= fa_XCellNum   && fa_XCellNum   <= (*p_InputData).XSizeOfImage &&
+         1 <= fa_YCellNum   && fa_YCellNum   <= (*p_InputData).YSizeOfImage &&
+         1 <= fa_XSampleNum && fa_XSampleNum <= (*p_InputData).XSizeOfImage &&
+         1 <= fa_YSampleNum && fa_YSampleNum <= (*p_InputData).YSizeOfImage ) {
+    } else {
+        return -EINVALMAP;                                  /* Return error value */
+    }
+
+    CellNum = fa_XCellNum * fa_YCellNum;
+
+    /* Map is kept in scratch buffer of context, or allocated */
+    ret = job_alloc_registration ( pfa_PdLibContext, 1, job_calc_map_size ( fa_XCellNum, fa_YCellNum ), (void **)&p_Buffer );
+
+    if ( ret != D_PD_LIB_E_OK ) {                           /* Check result of allocation */
+        return ret;                                         /* Return error value */
+    }
+
+    (*p_RegMap).p_Slope          = (PdLibCoeff_t *)p_Buffer;
+    (*p_RegMap).p_Offset         = (*p_RegMap).p_Slope + CellNum;
+    (*p_RegMap).p_XAxis          = (PdLibMapAxis_t *)( (*p_RegMap).p_Offset + CellNum );
+    (*p_RegMap).p_YAxis          = (*p_RegMap).p_XAxis + fa_XCellNum;
+    (*p_RegMap).p_DefocusOkNgThr = (signed long *)( (*p_RegMap).p_YAxis + fa_YCellNum );
+    (*p_RegMap).p_ThrLine0       = (*p_RegMap).p_DefocusOkNgThr + CellNum;
+    (*p_RegMap).p_ThrLine1       = (*p_RegMap).p_ThrLine0 + fa_XCellNum;
+
+    /* Search knots once for each column and row of cells */
+    job_init_map_axis ( fa_XCellNum, fa_XSampleNum, (*p_InputData).XSizeOfImage, &((*pfa_PdLibContext).KnotIndex.XSlopeOffset),
+                        &((*pfa_PdLibContext).KnotIndex.XDefocusOKNG), (*p_RegMap).p_XAxis );
+    job_init_map_axis ( fa_YCellNum, fa_YSampleNum, (*p_InputData).YSizeOfImage, &((*pfa_PdLibContext).KnotIndex.YSlopeOffset),
+                        &((*pfa_PdLibContext).KnotIndex.YDefocusOKNG), (*p_RegMap).p_YAxis );
+
+    (*p_RegMap).XCellNum      = fa_XCellNum;
+    (*p_RegMap).YCellNum      = fa_YCellNum;
+    (*p_RegMap).XSampleNum    = fa_XSampleNum;
+    (*p_RegMap).YSampleNum    = fa_YSampleNum;
+    (*p_RegMap).ThrCacheValid = 0;                          /* Threshold of cells is set at next evaluation */
+    (*p_RegMap).CoeffValid    = 0;
+
+    job_update_map_coeff ( pfa_PdLibContext );              /* Calculate slope and offset of cells */
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Get defocus map and defocus confidence level map of registered defocus map. */
+extern signed long PdLibGetDefocusMap 
+(
+    PdLibExecutor_t         *pfa_PdLibExecutor,             /* Input  : Executor, or NULL */
+    PdLibContext_t          *pfa_PdLibContext,              /* Input  : Validated context with registered defocus map */
+    unsigned long           fa_ImagerAnalogGain,            /* Input  : Image sensor analog gain */
+    PdLibPhaseDiffData_t    *pfa_PdLibPhaseDiffData,        /* Input  : Array of samples of phase difference */
+    signed long             *pfa_DefocusMap,                /* Output : Defocus of each cell */
+    unsigned long           *pfa_ConfidenceLevelMap         /* Output : Defocus confidence level of each cell */
+)
+{
+    signed long ret;
+    PdLibMapTask_t Task;
+
+    if ( pfa_PdLibContext == NULL ) {                       /* Check context */
+        return -EINVALCTX;                                  /* Return error value */
+    }
+
+    ret = (*pfa_PdLibContext).ValidateResult;
+
+    if ( ret != D_PD_LIB_E_OK ) {                           /* Check result of validation */
+        return ret;                                         /* Return error value */
+    }
+
+    if ( (*pfa_PdLibContext).RegMap.XCellNum == 0 ) {       /* Check registration of map */
+        return -EINVALMAP;                                  /* Return error value */
+    }
+
+    /* Update threshold and coefficients before threads share them */
+    if ( job_use_thr_cache ( pfa_PdLibContext, fa_ImagerAnalogGain ) != NULL ) {  /* Update threshold if gain is changed */
+        job_update_map_thr_cache ( pfa_PdLibContext );      /* Update threshold of cells if gain is changed */
+        job_update_map_coeff ( pfa_PdLibContext );          /* Update slope and offset of cells if sensor mode is changed */
+        Task.p_KnotIndex = NULL;
+    } else {
+        Task.p_KnotIndex = &((*pfa_PdLibContext).KnotIndex);   /* Published context at other gain calculates threshold of cells */
+    }
+
+    Task.InputData = (*pfa_PdLibContext).InputData;         /* Copy calibration data of context */
+    Task.InputData.ImagerAnalogGain = fa_ImagerAnalogGain;
+    Task.p_RegMap  = &((*pfa_PdLibContext).RegMap);
+    Task.p_Profile = &((*pfa_PdLibContext).Profile);
+    Task.p_Sample  = pfa_PdLibPhaseDiffData;
+    Task.p_DefocusMap         = pfa_DefocusMap;
+    Task.p_ConfidenceLevelMap = pfa_ConfidenceLevelMap;
+
+    /* Calculate tiles of rows of cells in parallel */
+    ThreadPoolRun ( ( pfa_PdLibExecutor != NULL ) ? (*pfa_PdLibExecutor).p_ThreadPool : NULL,
+                    (*pfa_PdLibContext).RegMap.YCellNum, D_MAP_TILE_ROW_NUM, job_run_map_task, &Task );
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Get phase difference of windows from PD image. */
+extern signed long PdLibGetPhaseDiff 
+(
+    PdLibExecutor_t         *pfa_PdLibExecutor,             /* Input  : Executor, or NULL */
+    const PdLibPdImage_t    *pfa_PdLibPdImage,              /* Input  : Left and right sub-images */
+    const PdLibPdParam_t    *pfa_PdLibPdParam,              /* Input  : Parameter of disparity search */
+    unsigned long           fa_WindowNum,                   /* Input  : Number of PDAF windows */
+    PdLibWindow_t           *pfa_PdLibWindow,               /* Input  : Array of PDAF windows */
+    PdLibPhaseDiffData_t    *pfa_PdLibPhaseDiffData         /* Output : Array of phase difference data */
+)
+{
+    PdLibPdTask_t Task;
+
+    /* Check all windows before any of them is calculated */
+    if ( PhaseDetectCheck ( pfa_PdLibPdImage, pfa_PdLibPdParam, fa_WindowNum, pfa_PdLibWindow ) != D_PHASE_DETECT_OK ) {
+        return -EINVALPD;                                   /* Return error value */
+    }
+
+    Task.p_Image         = pfa_PdLibPdImage;
+    Task.p_Param         = pfa_PdLibPdParam;
+    Task.p_Window        = pfa_PdLibWindow;
+    Task.p_PhaseDiffData = pfa_PdLibPhaseDiffData;
+    Task.LevelNum        = 1;                               /* Full resolution only */
+    Task.p_Level         = NULL;
+
+    /* Calculate chunks of windows in parallel */
+    ThreadPoolRun ( ( pfa_PdLibExecutor != NULL ) ? (*pfa_PdLibExecutor).p_ThreadPool : NULL,
+                    fa_WindowNum, D_PARALLEL_CHUNK_NUM, job_run_pd_task, &Task );
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Get phase difference of windows from PD image by coarse-to-fine search. */
+extern signed long PdLibGetPhaseDiffPyramid 
+(
+    PdLibExecutor_t         *pfa_PdLibExecutor,             /* Input  : Executor, or NULL */
+    const PdLibPdImage_t    *pfa_PdLibPdImage,              /* Input  : Left and right sub-images */
+    const PdLibPdParam_t    *pfa_PdLibPdParam,              /* Input  : Parameter of disparity search */
+    unsigned long           fa_LevelNum,                    /* Input  : Number of levels */
+    unsigned long           fa_WindowNum,                   /* Input  : Number of PDAF windows */
+    PdLibWindow_t           *pfa_PdLibWindow,               /* Input  : Array of PDAF windows */
+    PdLibPhaseDiffData_t    *pfa_PdLibPhaseDiffData,        /* Output : Array of phase difference data */
+    unsigned char           *pfa_Level                      /* Output : Array of level of result, or NULL */
+)
+{
+    PdLibPdTask_t Task;
+
+    if ( fa_LevelNum < 1 || D_PD_LIB_PD_LEVEL_NUM_MAX < fa_LevelNum ) {    /* Check number of levels */
+        return -EINVALPD;                                   /* Return error value */
+    }
+
+    /* Check all windows before any of them is calculated */
+    if ( PhaseDetectCheck ( pfa_PdLibPdImage, pfa_PdLibPdParam, fa_WindowNum, pfa_PdLibWindow ) != D_PHASE_DETECT_OK ) {
+        return -EINVALPD;                                   /* Return error value */
+    }
+
+    Task.p_Image         = pfa_PdLibPdImage;
+    Task.p_Param         = pfa_PdLibPdParam;
+    Task.p_Window        = pfa_PdLibWindow;
+    Task.p_PhaseDiffData = pfa_PdLibPhaseDiffData;
+    Task.LevelNum        = fa_LevelNum;
+    Task.p_Level         = pfa_Level;
+
+    /* Calculate chunks of windows in parallel */
+    ThreadPoolRun ( ( pfa_PdLibExecutor != NULL ) ? (*pfa_PdLibExecutor).p_ThreadPool : NULL,
+                    fa_WindowNum, D_PARALLEL_CHUNK_NUM, job_run_pd_task, &Task );
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Get defocus of ROIs from defocus data of windows. */
+extern signed long PdLibGetDefocusRoi 
+(
+    unsigned long           fa_WindowNum,                   /* Input  : Number of windows of the batch */
+    PdLibOutputData_t       *pfa_PdLibOutputData,           /* Input  : Array of defocus data of each window */
+    signed long             *pfa_PdLibResult,               /* Input  : Array of return value of each window, or NULL */
+    unsigned long           fa_RoiNum,                      /* Input  : Number of ROIs */
+    PdLibRoi_t              *pfa_PdLibRoi,                  /* Input  : Array of ROIs */
+    PdLibRoiData_t          *pfa_PdLibRoiData               /* Output : Array of defocus data of each ROI */
+)
+{
+    unsigned long i;
+
+    /* Check all ROIs before any of them is calculated */
+    if ( RoiCheck ( fa_WindowNum, fa_RoiNum, pfa_PdLibRoi ) != D_ROI_OK ) {
+        return -EINVALROI;                                  /* Return error value */
+    }
+
+    for ( i = 0; i < fa_RoiNum; i++ ) {
+        RoiAggregate ( pfa_PdLibOutputData, pfa_PdLibResult, &(pfa_PdLibRoi[i]), &(pfa_PdLibRoiData[i]) );
+
+        /* Same judgement as windows */
+        job_calc_defocus_confidence ( pfa_PdLibRoiData[i].DefocusConfidenceLevel, &(pfa_PdLibRoiData[i].DefocusConfidence) );
+    }
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Create temporal tracker of defocus of windows. */
+extern signed long PdLibCreateTracker 
+(
+    const PdLibTrackerParam_t *pfa_PdLibTrackerParam,       /* Input  : Parameter of filter */
+    unsigned long           fa_WindowNum,                   /* Input  : Number of windows */
+    PdLibTracker_t          **ppfa_PdLibTracker             /* Output : Created tracker */
+)
+{
+    (*ppfa_PdLibTracker) = NULL;
+
+    if ( pfa_PdLibTrackerParam == NULL || fa_WindowNum == 0 ||
+         D_PD_LIB_TRACKER_GAIN_ONE < (*pfa_PdLibTrackerParam).Alpha ||
+         D_PD_LIB_TRACKER_GAIN_ONE < (*pfa_PdLibTrackerParam).Beta ||
+         (*pfa_PdLibTrackerParam).ConfidenceLevelFull == 0 ) {  /* Check parameter */
+        return -EINVALTRK;                                  /* Return error value */
+    }
+
+    if ( TrackerCreate ( pfa_PdLibTrackerParam, fa_WindowNum, ppfa_PdLibTracker ) != D_TRACKER_OK ) {
+        return -EALLOCTRK;                                  /* Return error value */
+    }
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Destroy tracker. */
+extern void PdLibDestroyTracker 
+(
+    PdLibTracker_t          *pfa_PdLibTracker               /* Input  : Tracker */
+)
+{
+    TrackerDestroy ( pfa_PdLibTracker );
+
+    return ;
+}
+
+/* API : Reset all windows of tracker. */
+extern signed long PdLibResetTracker 
+(
+    PdLibTracker_t          *pfa_PdLibTracker               /* Input  : Tracker */
+)
+{
+    if ( pfa_PdLibTracker == NULL ) {                       /* Check tracker */
+        return -EINVALTRK;                                  /* Return error value */
+    }
+
+    TrackerReset ( pfa_PdLibTracker );
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Update tracker by defocus data of a frame. */
+extern signed long PdLibUpdateTracker 
+(
+    PdLibTracker_t          *pfa_PdLibTracker,              /* Input  : Tracker */
+    signed long             fa_LensDelta,                   /* Input  : Lens movement since previous frame */
+    unsigned long           fa_WindowNum,                   /* Input  : Number of windows */
+    PdLibOutputData_t       *pfa_PdLibOutputData,           /* Input  : Array of defocus data of each window */
+    signed long             *pfa_PdLibResult,               /* Input  : Array of return value of each window, or NULL */
+    PdLibTrackData_t        *pfa_PdLibTrackData             /* Output : Array of tracked defocus of each window */
+)
+{
+    if ( pfa_PdLibTracker == NULL ) {                       /* Check tracker */
+        return -EINVALTRK;                                  /* Return error value */
+    }
+
+    if ( TrackerUpdate ( pfa_PdLibTracker, fa_LensDelta, fa_WindowNum, pfa_PdLibOutputData, pfa_PdLibResult, pfa_PdLibTrackData ) != D_TRACKER_OK ) {
+        return -EINVALTRK;                                  /* Number of windows differs */
+    }
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Get statistics of threshold cache of context. */
+extern signed long PdLibGetCacheStatistics 
+(
+    PdLibContext_t          *pfa_PdLibContext,              /* Input  : Context */
+    PdLibCacheStatistics_t  *pfa_PdLibCacheStatistics       /* Output : Statistics of threshold cache */
+)
+{
+    if ( pfa_PdLibContext == NULL ) {                       /* Check context */
+        return -EINVALCTX;                                  /* Return error value */
+    }
+
+    (*pfa_PdLibCacheStatistics) = (*pfa_PdLibContext).CacheStatistics;
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Get memory footprint of calibration data of context. */
+extern signed long PdLibGetCalibFootprint 
+(
+    PdLibContext_t          *pfa_PdLibContext,              /* Input  : Context */
+    PdLibCalibFootprint_t   *pfa_PdLibCalibFootprint        /* Output : Footprint of calibration data */
+)
+{
+    unsigned long i;
+    unsigned long LineNum;
+    unsigned long PointNum;
+    PdLibInputData_t *p_InputData;
+    PdLibPackedCalib_t *p_Packed;
+
+    if ( pfa_PdLibContext == NULL ) {                       /* Check context */
+        return -EINVALCTX;                                  /* Return error value */
+    }
+
+    p_InputData = &((*pfa_PdLibContext).InputData);
+    p_Packed    = &((*pfa_PdLibContext).Packed);
+
+    LineNum = (unsigned long)(*p_InputData).XKnotNumDefocusOKNG * (*p_InputData).YKnotNumDefocusOKNG;
+
+    PointNum = 0;
+    if ( (*p_Packed).LineNum != 0 ) {
+        PointNum = (*p_Packed).p_LineStart[LineNum];
+    } else {
+        for ( i = 0; i < LineNum; i++ ) {
+            PointNum += (*p_InputData).p_DefocusOKNGThrLine[i].PointNum;
+        }
+    }
+
+    (*pfa_PdLibCalibFootprint).KnotNum         = (unsigned long)(*p_InputData).XKnotNumSlopeOffset * (*p_InputData).YKnotNumSlopeOffset;
+    (*pfa_PdLibCalibFootprint).SlopeOffsetBits = (*p_Packed).SlopeOffsetBits;
+    (*pfa_PdLibCalibFootprint).CalibKnotSize   = sizeof(signed long) * 2;
+    (*pfa_PdLibCalibFootprint).KnotSize        = ( (*p_Packed).SlopeOffsetBits != 0 ) ? (*p_Packed).SlopeOffsetBits / 4 : sizeof(signed long) * 2;
+    (*pfa_PdLibCalibFootprint).LineNum         = LineNum;
+    (*pfa_PdLibCalibFootprint).PointNum        = PointNum;
+    (*pfa_PdLibCalibFootprint).CalibLineSize   = sizeof(DefocusOKNGThrLine_t) * LineNum + sizeof(unsigned long) * PointNum * 2;
+    (*pfa_PdLibCalibFootprint).LineSize        = ( (*p_Packed).LineNum != 0 ) ? sizeof(unsigned long) * ( LineNum + 1 + PointNum * 2 ) :
+                                                                               (*pfa_PdLibCalibFootprint).CalibLineSize;
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Copy records of recent evaluations of context. */
+extern signed long PdLibDumpTrace 
+(
+    PdLibContext_t          *pfa_PdLibContext,              /* Input  : Context */
+    unsigned long           fa_RecordNum,                   /* Input  : Size of array of records */
+    PdLibTraceRecord_t      *pfa_PdLibTraceRecord,          /* Output : Array of records, oldest first */
+    unsigned long           *pfa_DumpNum                    /* Output : Number of records copied */
+)
+{
+    if ( pfa_PdLibContext == NULL ) {                       /* Check context */
+        return -EINVALCTX;                                  /* Return error value */
+    }
+
+    if ( pfa_DumpNum == NULL || ( fa_RecordNum != 0 && pfa_PdLibTraceRecord == NULL ) ) {   /* Check arguments */
+        return -EINVALTRACE;                                /* Return error value */
+    }
+
+#if D_PD_LIB_TRACE_NUM
+    TraceDump ( &((*pfa_PdLibContext).Trace), fa_RecordNum, pfa_PdLibTraceRecord, pfa_DumpNum );
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+#else
+    (*pfa_DumpNum) = 0;
+
+    return -EINVALTRACE;                                    /* Not enabled */
+#endif
+}
+
+/* API : Create parallel executor and its worker threads. */
+extern signed long PdLibCreateExecutor 
+(
+    unsigned long           fa_ThreadNum,                   /* Input  : Number of threads including calling thread */
+    signed long             *pfa_CoreAffinity,              /* Input  : Core number of each worker thread, or NULL */
+    PdLibExecutor_t         **ppfa_PdLibExecutor            /* Output : Created executor */
+)
+{
+    PdLibExecutor_t *p_Executor;
+
+    (*ppfa_PdLibExecutor) = NULL;
+
+    if ( 1 <= fa_ThreadNum && fa_ThreadNum <= D_THREAD_POOL_MAX_THREAD_NUM ) {
+    } else {
+        return -EINVALEXEC;                                 /* Return error value */
+    }
+
+    p_Executor = (PdLibExecutor_t *)malloc ( sizeof(PdLibExecutor_t) );
+
+    if ( p_Executor == NULL ) {                             /* Check result of allocation */
+        return -EALLOCEXEC;                                 /* Return error value */
+    }
+
+#if D_PD_LIB_STATS
+    StatisticsPrepare ();                                   /* Counters of calling thread and worker threads before evaluation */
+#endif
+
+    /* Create worker threads */
+    if ( ThreadPoolCreate ( fa_ThreadNum, pfa_CoreAffinity, D_EXECUTOR_THREAD_START, &((*p_Executor).p_ThreadPool) ) != D_THREAD_POOL_OK ) {
+        free ( p_Executor );
+        return -EALLOCEXEC;                                 /* Return error value */
+    }
+
+    (*ppfa_PdLibExecutor) = p_Executor;
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Stop worker threads and destroy executor. */
+extern void PdLibDestroyExecutor 
+(
+    PdLibExecutor_t         *pfa_PdLibExecutor              /* Input  : Executor */
+)
+{
+    if ( pfa_PdLibExecutor != NULL ) {                      /* Check executor */
+        ThreadPoolDestroy ( (*pfa_PdLibExecutor).p_ThreadPool );
+    }
+
+    free ( pfa_PdLibExecutor );
+
+    return ;
+}
+
+/* API : Get defocus data of all PDAF windows in a frame in parallel. */
+/* Return value and pfa_PdLibResult are the same as PdLibGetDefocusBatchWithContext(). */
+extern signed long PdLibGetDefocusBatchParallel 
+(
+    PdLibExecutor_t         *pfa_PdLibExecutor,             /* Input  : Executor, or NULL */
+    PdLibContext_t          *pfa_PdLibContext,              /* Input  : Validated context */
+    unsigned long           fa_ImagerAnalogGain,            /* Input  : Image sensor analog gain */
+    unsigned long           fa_WindowNum,                   /* Input  : Number of windows */
+    PdLibWindow_t           *pfa_PdLibWindow,               /* Input  : Array of PDAF windows */
+    PdLibPhaseDiffData_t    *pfa_PdLibPhaseDiffData,        /* Input  : Array of phase difference data */
+    PdLibOutputData_t       *pfa_PdLibOutputData,           /* Output : Array of output data structure */
+    signed long             *pfa_PdLibResult                /* Output : Array of return value of each window */
+)
+{
+    PdLibBatchTask_t Task;
+    PdLibProfileState_t LibProfile;
+
+    if ( pfa_PdLibContext != NULL ) {                       /* Check context */
+        Task.RetCheckCalib = (*pfa_PdLibContext).ValidateResult;
+        Task.InputData     = (*pfa_PdLibContext).InputData; /* Copy calibration data of context */
+        Task.InputData.ImagerAnalogGain = fa_ImagerAnalogGain;
+        Task.p_KnotIndex   = &((*pfa_PdLibContext).KnotIndex);
+        Task.p_ThrCache    = NULL;
+        Task.p_Profile     = &((*pfa_PdLibContext).Profile);
+        Task.p_Trace       = job_get_trace ( pfa_PdLibContext );
+
+        if ( Task.RetCheckCalib == D_PD_LIB_E_OK ) {        /* Check result of validation */
+            /* Update threshold before threads share it */
+            Task.p_ThrCache = job_use_thr_cache ( pfa_PdLibContext, fa_ImagerAnalogGain );
+        }
+    } else {
+        Task.RetCheckCalib = -EINVALCTX;
+        Task.p_KnotIndex   = NULL;                          /* Not used for error */
+        Task.p_ThrCache    = NULL;
+        Task.p_Profile     = &LibProfile;              /* Shared by threads until the end of the call */
+        Task.p_Trace       = NULL;
+
+        job_get_lib_profile ( &LibProfile );
+    }
+
+    Task.p_Window        = pfa_PdLibWindow;
+    Task.p_PhaseDiffData = pfa_PdLibPhaseDiffData;
+    Task.p_OutputData    = pfa_PdLibOutputData;
+    Task.p_Result        = pfa_PdLibResult;
+
+    /* Calculate output data of each window in parallel */
+    ThreadPoolRun ( ( pfa_PdLibExecutor != NULL ) ? (*pfa_PdLibExecutor).p_ThreadPool : NULL,
+                    fa_WindowNum, D_PARALLEL_CHUNK_NUM, job_run_batch_task, &Task );
+
+    return Task.RetCheckCalib;                              /* Return result of context */
+}
+
+/* API : Get defocus data of array of input data in parallel. */
+extern void PdLibGetDefocusParallel 
+(
+    PdLibExecutor_t         *pfa_PdLibExecutor,             /* Input  : Executor, or NULL */
+    unsigned long           fa_InputNum,                    /* Input  : Number of input data */
+    PdLibInputData_t        *pfa_PdLibInputData,            /* Input  : Array of input data structure */
+    PdLibOutputData_t       *pfa_PdLibOutputData,           /* Output : Array of output data structure */
+    signed long             *pfa_PdLibResult                /* Output : Array of return value of each input data */
+)
+{
+    PdLibInputTask_t Task;
+    PdLibProfileState_t Profile;
+
+    job_get_lib_profile ( &Profile );                       /* Sensor profile of the whole call */
+
+    Task.p_InputData  = pfa_PdLibInputData;
+    Task.p_Profile    = &Profile;
+    Task.p_OutputData = pfa_PdLibOutputData;
+    Task.p_Result     = pfa_PdLibResult;
+
+    /* Calculate output data of each input data in parallel */
+    ThreadPoolRun ( ( pfa_PdLibExecutor != NULL ) ? (*pfa_PdLibExecutor).p_ThreadPool : NULL,
+                    fa_InputNum, D_PARALLEL_CHUNK_NUM, job_run_input_task, &Task );
+
+    return ;
+}
+
+/* API : Create recorder of input data. */
+extern signed long PdLibCreateRecorder 
+(
+    PdLibRecordWrite_t      fa_Write,                       /* Input  : Function writing record stream */
+    void                    *pfa_User,                      /* Input  : First argument of fa_Write */
+    PdLibRecorder_t         **ppfa_PdLibRecorder            /* Output : Created recorder */
+)
+{
+    signed char ret;
+
+    if ( fa_Write == NULL ) {                               /* Check write function */
+        (*ppfa_PdLibRecorder) = NULL;
+        return -EINVALREC;                                  /* Return error value */
+    }
+
+    ret = RecordCreate ( fa_Write, pfa_User, ppfa_PdLibRecorder );
+
+    return job_record_error ( ret );
+}
+
+/* API : Destroy recorder. */
+extern void PdLibDestroyRecorder 
+(
+    PdLibRecorder_t         *pfa_PdLibRecorder              /* Input  : Recorder */
+)
+{
+    RecordDestroy ( pfa_PdLibRecorder );
+
+    return ;
+}
+
+/* API : Write buffered records. */
+extern signed long PdLibFlushRecorder 
+(
+    PdLibRecorder_t         *pfa_PdLibRecorder              /* Input  : Recorder */
+)
+{
+    if ( pfa_PdLibRecorder == NULL ) {                      /* Check recorder */
+        return -EINVALREC;                                  /* Return error value */
+    }
+
+    return job_record_error ( RecordFlush ( pfa_PdLibRecorder ) );
+}
+
+/* API : Tell recorder that tables of calibration data are changed. */
+extern signed long PdLibInvalidateRecorderCalib 
+(
+    PdLibRecorder_t         *pfa_PdLibRecorder              /* Input  : Recorder */
+)
+{
+    if ( pfa_PdLibRecorder == NULL ) {                      /* Check recorder */
+        return -EINVALREC;                                  /* Return error value */
+    }
+
+    RecordInvalidateCalib ( pfa_PdLibRecorder );
+
+    return D_PD_LIB_E_OK;
+}
+
+/* API : Record a frame of windows. */
+extern signed long PdLibRecordBatch 
+(
+    PdLibRecorder_t         *pfa_PdLibRecorder,             /* Input  : Recorder */
+    PdLibCalibData_t        *pfa_PdLibCalibData,            /* Input  : Calibration data shared by all windows */
+    unsigned long           fa_ImagerAnalogGain,            /* Input  : Image sensor analog gain */
+    unsigned long           fa_WindowNum,                   /* Input  : Number of windows */
+    PdLibWindow_t           *pfa_PdLibWindow,               /* Input  : Array of PDAF windows */
+    PdLibPhaseDiffData_t    *pfa_PdLibPhaseDiffData,        /* Input  : Array of phase difference data of each window */
+    PdLibOutputData_t       *pfa_PdLibOutputData,           /* Input  : Array of defocus data of each window, or NULL */
+    signed long             *pfa_PdLibResult                /* Input  : Array of return value of each window, or NULL */
+)
+{
+    if ( pfa_PdLibRecorder == NULL || pfa_PdLibCalibData == NULL ||
+         ( fa_WindowNum != 0 && ( pfa_PdLibWindow == NULL || pfa_PdLibPhaseDiffData == NULL ) ) ) {  /* Check arguments */
+        return -EINVALREC;                                  /* Return error value */
+    }
+
+    return job_record_error ( RecordBatch ( pfa_PdLibRecorder, pfa_PdLibCalibData, fa_ImagerAnalogGain, fa_WindowNum,
+                                        pfa_PdLibWindow, pfa_PdLibPhaseDiffData, pfa_PdLibOutputData, pfa_PdLibResult ) );
+}
+
+/* API : Record array of input data. */
+extern signed long PdLibRecordInput 
+(
+    PdLibRecorder_t         *pfa_PdLibRecorder,             /* Input  : Recorder */
+    unsigned long           fa_InputNum,                    /* Input  : Number of input data */
+    PdLibInputData_t        *pfa_PdLibInputData,            /* Input  : Array of input data */
+    PdLibOutputData_t       *pfa_PdLibOutputData,           /* Input  : Array of defocus data of each input data, or NULL */
+    signed long             *pfa_PdLibResult                /* Input  : Array of return value of each input data, or NULL */
+)
+{
+    if ( pfa_PdLibRecorder == NULL || ( fa_InputNum != 0 && pfa_PdLibInputData == NULL ) ) {  /* Check arguments */
+        return -EINVALREC;                                  /* Return error value */
+    }
+
+    return job_record_error ( RecordInput ( pfa_PdLibRecorder, fa_InputNum, pfa_PdLibInputData, pfa_PdLibOutputData, pfa_PdLibResult ) );
+}
+
+/* API : Replay record stream and compare output data. */
+extern signed long PdLibReplay 
+(
+    PdLibExecutor_t         *pfa_PdLibExecutor,             /* Input  : Executor, or NULL */
+    const void              *pfa_Stream,                    /* Input  : Record stream */
+    unsigned long           fa_StreamSize,                  /* Input  : Size of record stream */
+    unsigned char           fa_Mode,                        /* Input  : D_PD_LIB_REPLAY_XXX */
+    PdLibReplayStats_t      *pfa_PdLibReplayStats           /* Output : Statistics of comparison */
+)
+{
+    if ( pfa_Stream == NULL || pfa_PdLibReplayStats == NULL || D_PD_LIB_REPLAY_PARALLEL < fa_Mode ) {  /* Check arguments */
+        return -EINVALREC;                                  /* Return error value */
+    }
+
+    return job_record_error ( RecordReplay ( pfa_PdLibExecutor, pfa_Stream, fa_StreamSize, fa_Mode, pfa_PdLibReplayStats ) );
+}
+
+/* API : Get size of calibration image of sensor modes. */
+extern signed long PdLibGetCalibImageSize 
+(
+    unsigned long           fa_ModeNum,                     /* Input  : Number of sensor modes */
+    PdLibCalibData_t        *pfa_PdLibCalibData,            /* Input  : Array of calibration data of each sensor mode */
+    unsigned long           *pfa_ImageSize                  /* Output : Size of calibration image */
+)
+{
+    if ( CalibImageCalcSize ( fa_ModeNum, pfa_PdLibCalibData, pfa_ImageSize ) != D_CALIB_IMAGE_OK ) {
+        return -EINVALIMG;                                  /* Return error value */
+    }
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Write calibration image of sensor modes. */
+extern signed long PdLibWriteCalibImage 
+(
+    unsigned long           fa_ModeNum,                     /* Input  : Number of sensor modes */
+    PdLibCalibData_t        *pfa_PdLibCalibData,            /* Input  : Array of calibration data of each sensor mode */
+    unsigned long           *pfa_SensorMode,                /* Input  : Array of sensor mode number of each calibration data */
+    unsigned long           fa_ImageSize,                   /* Input  : Size of buffer of calibration image */
+    void                    *pfa_Image                      /* Output : Calibration image */
+)
+{
+    if ( CalibImageWrite ( fa_ModeNum, pfa_PdLibCalibData, pfa_SensorMode, fa_ImageSize, pfa_Image ) != D_CALIB_IMAGE_OK ) {
+        return -EINVALIMG;                                  /* Return error value */
+    }
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Check header and checksum of calibration image. */
+extern signed long PdLibCheckCalibImage 
+(
+    const void              *pfa_Image,                     /* Input  : Calibration image */
+    unsigned long           fa_ImageSize                    /* Input  : Size of calibration image */
+)
+{
+    if ( CalibImageCheck ( pfa_Image, fa_ImageSize ) != D_CALIB_IMAGE_OK ) {
+        return -EINVALIMG;                                  /* Return error value */
+    }
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Map file of calibration image to memory and check it. */
+extern signed long PdLibMapCalibImage 
+(
+    const char              *pfa_Path,                      /* Input  : Path of calibration image file */
+    void                    **ppfa_Image,                   /* Output : Mapped calibration image */
+    unsigned long           *pfa_ImageSize                  /* Output : Size of calibration image */
+)
+{
+    if ( CalibImageMap ( pfa_Path, ppfa_Image, pfa_ImageSize ) != D_CALIB_IMAGE_OK ) {
+        return -EMAPIMG;                                    /* Return error value */
+    }
+
+    if ( CalibImageCheck ( (*ppfa_Image), (*pfa_ImageSize) ) != D_CALIB_IMAGE_OK ) {
+        CalibImageUnmap ( (*ppfa_Image), (*pfa_ImageSize) );
+        (*ppfa_Image)    = NULL;
+        (*pfa_ImageSize) = 0;
+        return -EINVALIMG;                                  /* Return error value */
+    }
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* API : Unmap calibration image mapped by PdLibMapCalibImage(). */
+extern void PdLibUnmapCalibImage 
+(
+    void                    *pfa_Image,                     /* Input  : Mapped calibration image */
+    unsigned long           fa_ImageSize                    /* Input  : Size of calibration image */
+)
+{
+    CalibImageUnmap ( pfa_Image, fa_ImageSize );
+
+    return ;
+}
+
+/* API : Get statistics of calls since last reset. */
+extern signed long PdLibGetStats 
+(
+    PdLibStats_t            *pfa_PdLibStats                 /* Output : Statistics of calls */
+)
+{
+#if D_PD_LIB_STATS
+    unsigned long Counter[D_STATISTICS_COUNTER_NUM];
+
+    StatisticsMerge ( Counter );                            /* Merge counters of all threads */
+
+    memcpy ( pfa_PdLibStats, Counter, sizeof(PdLibStats_t) );
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+#else
+    memset ( pfa_PdLibStats, 0, sizeof(PdLibStats_t) );
+
+    return -EINVALSTATS;                                    /* Return error value */
+#endif
+}
+
+/* API : Reset statistics of calls. */
+extern void PdLibResetStats 
+(
+    void
+)
+{
+#if D_PD_LIB_STATS
+    StatisticsReset ();
+#endif
+
+    return ;
+}
+
+/****************************************************************/
+/*                       local function                         */
+/****************************************************************/
+/* Function for calculating output data from checked input data structure */
+static void job_get_defocus 
+( 
+    PdLibInputData_t    *pfa_InputData,                     /* Input  : Input data structure */
+    PdLibKnotIndex_t    *pfa_KnotIndex,                     /* Input  : Index of knots */
+    PdLibProfileState_t *pfa_Profile,                       /* Input  : Sensor profile */
+    PdLibOutputData_t   *pfa_OutputData                     /* Output : Output data structure */
+)
+{
+    PdLibOutputData_t OutputData;
+
+    job_calc_defocus ( pfa_InputData, pfa_KnotIndex, NULL, &(OutputData.Defocus), NULL );    /* Calculate defocus */
+
+    /* Calculate defocus confidence */
+    job_get_defocus_confidence ( pfa_InputData, pfa_KnotIndex, NULL, NULL, pfa_Profile, &OutputData );
+
+    /* Calculate phase difference */
+    job_calc_phase_difference ( pfa_InputData, &(OutputData.PhaseDifference) );
+
+    (*pfa_OutputData) = OutputData;                         /* Set result of job_calc_phase_difference() */
+
+    return ;
+}
+
+/* Function for initializing output data structure */
+static void job_init_output_data 
+( 
+    PdLibOutputData_t *pfa_OutputData                       /* Output : Output data structure */
+)
+{
+    (*pfa_OutputData).Defocus                = 0;
+    (*pfa_OutputData).DefocusConfidence      = D_PD_LIB_E_NG;
+    (*pfa_OutputData).DefocusConfidenceLevel = 0;
+    (*pfa_OutputData).PhaseDifference        = 0;
+
+    return ;
+}
+
+/* Function for checking value of input data structure */
+static signed long job_check_input 
+( 
+    PdLibInputData_t *pfa_InputData,                        /* Input : Input data structure */
+    PdLibProfileState_t *pfa_Profile                        /* Input : Sensor profile */
+)
+{
+    signed long ret;
+
+    ret = job_check_input_image ( pfa_InputData );          /* Check size of image */
+
+    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
+        ret = job_check_input_window ( pfa_InputData );     /* Check PDAF window */
+    }
+    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
+        ret = job_check_input_calib ( pfa_InputData, pfa_Profile );     /* Check calibration data */
+    }
+
+    return ret;                                             /* Return result */
+}
+
+/* Sub function of job_check_input() */
+/* Function for checking size of image */
+static signed long job_check_input_image 
+( 
+    PdLibInputData_t *pfa_InputData                         /* Input : Input data structure */
+)
+{
+    signed long ret;
+
+    ret = D_PD_LIB_E_OK;                                    /* Set return value as OK */
+
+    /* Check the value of input */
+    /* Check XSizeOfImage */
+    if ( 2 <= (*pfa_InputData).XSizeOfImage ) {             /* Check XSizeOfImage */
+    } else {
+        ret = -EINXSOI;                                     /* Out of range of XSizeOfImage */
+    }
+    /* Check YSizeOfImage */
+    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
+        if ( 2 <= (*pfa_InputData).YSizeOfImage ) {         /* Check YSizeOfImage */
+        } else {
+            ret = -EINYSOI;                                 /* Out of range of YSizeOfImage */
+        }
+    }
+
+    return ret;                                             /* Return result */
+}
+
+/* Sub function of job_check_input() */
+/* Function for checking PDAF window. Size of image must be checked in advance. */
+static signed long job_check_input_window 
+( 
+    PdLibInputData_t *pfa_InputData                         /* Input : Input data structure */
+)
+{
+    signed long ret;
+
+    ret = D_PD_LIB_E_OK;                                    /* Set return value as OK */
+
+    /* Check PDAFWindowsX */
+    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
+        if ( ( (*pfa_InputData).XAddressOfWindowStart <= ( (*pfa_InputData).XAddressOfWindowEnd - 1 ) ) &&
+             ( (*pfa_InputData).XAddressOfWindowEnd <= ( (*pfa_InputData).XSizeOfImage - 1 ) ) ) {
+        } else {
+            ret = -EINPDAFWX;                               /* Out of range of PDAFWindowsX */
+        }
+    }
+    /* Check PDAFWindowsY */
+    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
+        if ( ( (*pfa_InputData).YAddressOfWindowStart <= ( (*pfa_InputData).YAddressOfWindowEnd - 1 ) ) &&
+             ( (*pfa_InputData).YAddressOfWindowEnd <= ( (*pfa_InputData).YSizeOfImage - 1 ) ) ) {
+        } else {
+            ret = -EINPDAFWY;                               /* Out of range of PDAFWindowsY */
+        }
+    }
+
+    return ret;                                             /* Return result */
+}
+
+/* Sub function of job_check_input() */
+/* Function for checking calibration data (slope, offset, knots and threshold lines) */
+static signed long job_check_input_calib 
+( 
+    PdLibInputData_t *pfa_InputData,                        /* Input : Input data structure */
+    PdLibProfileState_t *pfa_Profile                        /* Input : Sensor profile */
+)
+{
+    signed long ret;
+
+    ret = D_PD_LIB_E_OK;                                    /* Set return value as OK */
+
+    /* Check Slope and Offset (defocus vs phase difference) */
+    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
+        if ( 2 <= (*pfa_InputData).XKnotNumSlopeOffset &&
+             2 <= (*pfa_InputData).YKnotNumSlopeOffset ) {
+        } else {
+            ret = -EINSO;                                   /* Out of range of SlopeOffset */
+        }
+    }
+    /* Check AdjCoeffSlope with values of sensor modes without duplicates */
+    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
+        unsigned long i;
+
+        ret = -EINACS;                                      /* Out of range of AdjCoeffSlope */
+        for ( i = 0; i < (*pfa_Profile).AdjCoeffNum; i++ ) {
+            if ( (*pfa_InputData).AdjCoeffSlope == (*pfa_Profile).AdjCoeff[i] ) {
+                ret = D_PD_LIB_E_OK;
+                break ;
+            }
+        }
+    }
+    /* Check SlopeOffsetXAddressKnot */
+    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
+        unsigned short i;
+        unsigned short XKnotNum;
+        unsigned short *p_XAddressKnot;
+        
+        XKnotNum = (*pfa_InputData).XKnotNumSlopeOffset;
+        p_XAddressKnot = (*pfa_InputData).p_XAddressKnotSlopeOffset;
+        for ( i = 0; i < ( XKnotNum - 1 ); i++ ) {
+            if ( p_XAddressKnot[i] < p_XAddressKnot[i + 1] ){
+            } else {
+                ret = -EINSOXAK;                            /* Out of range of SlopeOffsetXAddressKnot */
+                break ;
+            }
+        }
+    }
+    /* Check SlopeOffsetYAddressKnot */
+    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
+        unsigned short i;
+        unsigned short YKnotNum;
+        unsigned short *p_YAddressKnot;
+        
+        YKnotNum = (*pfa_InputData).YKnotNumSlopeOffset;
+        p_YAddressKnot = (*pfa_InputData).p_YAddressKnotSlopeOffset;
+        for ( i = 0; i < ( YKnotNum - 1 ); i++ ) {
+            if ( p_YAddressKnot[i] < p_YAddressKnot[i + 1] ) {
+            } else {
+                ret = -EINSOYAK;                            /* Out of range of SlopeOffsetYAddressKnot */
+                break ;
+            }
+        }
+    }
+    /* Check Defocus OK/NG */
+    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
+        /* Check disable of the judge function of confidence */
+        if ( 0 == (*pfa_InputData).XKnotNumDefocusOKNG ||
+             0 == (*pfa_InputData).YKnotNumDefocusOKNG ) {
+            if ( 0 == (*pfa_InputData).XKnotNumDefocusOKNG &&
+                 0 == (*pfa_InputData).YKnotNumDefocusOKNG ) {
+            }
+            else {
+                ret = -EINVALDISCONFJ;                      /* Invalid of Disable Confidence Judgement */
+            }
+        }
+        /* Check disable of the judge function of confidence in each image area */
+        else if ( 1 == (*pfa_InputData).XKnotNumDefocusOKNG ||
+                  1 == (*pfa_InputData).YKnotNumDefocusOKNG ) {
+            if ( 1 == (*pfa_InputData).XKnotNumDefocusOKNG &&
+                 1 == (*pfa_InputData).YKnotNumDefocusOKNG ) {
+            } else {
+                ret = -EINVALDISIHC;                        /* Invalid of Disable compensation relation with image height */
+            }
+        }
+    }
+    /* Check DefocusOKNGThrPointNum */
+    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
+        if ( (*pfa_InputData).p_DefocusOKNGThrLine != NULL &&
+             2 <= (*((*pfa_InputData).p_DefocusOKNGThrLine)).PointNum ) {
+        } else {
+            ret = -EINDONTPN;                               /* Out of range of DefocusOKNGThrPointNum */
+        }
+    }
+    /* Check DefocusOKNGXAddressKnot */
+    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
+        unsigned short i;
+        unsigned short XKnotNum;
+        unsigned short *p_XAddressKnot;
+        
+        XKnotNum = (*pfa_InputData).XKnotNumDefocusOKNG;
+        p_XAddressKnot = (*pfa_InputData).p_XAddressKnotDefocusOKNG;
+        for ( i = 0; i < ( XKnotNum - 1 ); i++ ) {
+            if ( p_XAddressKnot[i] < p_XAddressKnot[i + 1] ) {
+            } else {
+                ret = -EINDONXAK;                           /* Out of range of DefocusOKNGXAddressKnot */
+                break ;
+            }
+        }
+    }
+    /*  Check DefocusOKNGYAddressKnot */
+    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
+        unsigned short i;
+        unsigned short YKnotNum;
+        unsigned short *p_YAddressKnot;
+        
+        YKnotNum = (*pfa_InputData).YKnotNumDefocusOKNG;
+        p_YAddressKnot = (*pfa_InputData).p_YAddressKnotDefocusOKNG;
+        for ( i = 0; i < ( YKnotNum - 1 ); i++ ) {
+            if ( p_YAddressKnot[i] < p_YAddressKnot[i + 1] ) {
+            } else {
+                ret = -EINDONYAK;                           /* Out of range of DefocusOKNGYAddressKnot */
+                break ;
+            }
+        }
+    }
+    /* Check Phase Detection Pixel Density with values of sensor modes without duplicates */
+    if ( ret == D_PD_LIB_E_OK ) {               /* Check return value */
+        unsigned long i;
+
+        ret = -EINDOP;                                      /* Out of range of DensityOfPhasePix */
+        for ( i = 0; i < (*pfa_Profile).DensityNum; i++ ) {
+            if ( (*pfa_InputData).DensityOfPhasePix == (*pfa_Profile).Density[i] ) {
+                ret = D_PD_LIB_E_OK;
+                break ;
+            }
+        }
+    }
+
+    return ret;                                             /* Return result */
+}
+
+/* Function for calculating output data of registered window from checked input data structure */
+static void job_get_defocus_reg_window 
+( 
+    PdLibInputData_t    *pfa_InputData,                     /* Input  : Input data structure */
+    PdLibRegWindow_t    *pfa_RegWindow,                     /* Input  : Registered window */
+    PdLibKnotIndex_t    *pfa_KnotIndex,                     /* Input  : Index of knots calculating threshold, or NULL for threshold of the window */
+    PdLibProfileState_t *pfa_Profile,                       /* Input  : Sensor profile */
+    PdLibOutputData_t   *pfa_OutputData                     /* Output : Output data structure */
+)
+{
+    PdLibOutputData_t OutputData;
+
+#if D_PD_LIB_STATS
+    StatisticsAdd ( D_STATS_INDEX(AreaNum) + (*pfa_RegWindow).AreaIndex, 1 );
+#endif
+
+    /* Calculate defocus with slope and offset at window center */
+#if D_MATH_FUNC_FIXED_POINT
+    CalcLinearArray_sllAsllBslX ( 1, &((*pfa_RegWindow).Slope), &((*pfa_RegWindow).Offset), &((*pfa_InputData).PhaseDifference),
+                                  &(OutputData.Defocus) );
+#else
+    OutputData.Defocus = limit_defocus_formula ( (*pfa_RegWindow).Slope * (double)((*pfa_InputData).PhaseDifference) +
+                                                 (*pfa_RegWindow).Offset );
+#endif
+
+    /* Calculate defocus confidence with threshold of the window, or with threshold calculated from calibration data */
+    job_get_defocus_confidence ( pfa_InputData, pfa_KnotIndex, NULL, ( pfa_KnotIndex == NULL ) ? &((*pfa_RegWindow).DefocusOkNgThr) : NULL,
+                                 pfa_Profile, &OutputData );
+
+    /* Calculate phase difference */
+    job_calc_phase_difference ( pfa_InputData, &(OutputData.PhaseDifference) );
+
+    (*pfa_OutputData) = OutputData;                         /* Set result of job_calc_phase_difference() */
+
+    return ;
+}
+
+/* Function for calculating defocus confidence level and defocus confidence */
+static void job_get_defocus_confidence 
+( 
+    PdLibInputData_t    *pfa_InputData,                     /* Input  : Input data structure */
+    PdLibKnotIndex_t    *pfa_KnotIndex,                     /* Input  : Index of knots */
+    signed long         *pfa_ThrCache,                      /* Input  : Threshold at each knot. NULL calculates it */
+    signed long         *pfa_DefocusOkNgThr,                /* Input  : Threshold at window center. NULL calculates it */
+    PdLibProfileState_t *pfa_Profile,                       /* Input  : Sensor profile */
+    PdLibOutputData_t   *pfa_OutputData                     /* Output : Output data structure */
+)
+{
+    /* Check XKnotNumDefocusOKNG and YKnotNumDefocusOKNG */ 
+    if ((pfa_InputData->XKnotNumDefocusOKNG != 0) && (pfa_InputData->YKnotNumDefocusOKNG != 0)) {
+        /* Check the value of input */
+        if ( (*pfa_InputData).PhaseDifference != (*pfa_Profile).PdErrorPhaseDiff ) {
+            signed long DefocusOkNgThr;
+
+            if ( pfa_DefocusOkNgThr != NULL ) {             /* Threshold is calculated before */
+                DefocusOkNgThr = (*pfa_DefocusOkNgThr);
+            } else {
+                /* Calculate threshold of confidence at window center */
+                job_calc_defocus_ok_ng_thr ( pfa_InputData, pfa_KnotIndex, pfa_ThrCache, &DefocusOkNgThr );
+            }
+
+            /* Calculate defocus confidence level */
+            job_calc_defocus_confidence_level(pfa_InputData, DefocusOkNgThr, &((*pfa_OutputData).DefocusConfidenceLevel));
+            /* Calculate defocus confidence */
+            job_calc_defocus_confidence ( (*pfa_OutputData).DefocusConfidenceLevel, &((*pfa_OutputData).DefocusConfidence) );
+        } else {                                            /* Error of phase difference */
+            (*pfa_OutputData).DefocusConfidenceLevel = 0;   /* Set defocus confidence level as Zero */
+            (*pfa_OutputData).DefocusConfidence = -EPDVALERR; /* Set defocus confidence as input error */
+        }
+
+    } else {                                                /* Error of XKnotNumDefocusOKNG or YKnotNumDefocusOKNG */
+        (*pfa_OutputData).DefocusConfidenceLevel = 0;       /* Set defocus confidence level as Zero */
+        (*pfa_OutputData).DefocusConfidence = -ENCWDDON;    /* Set defocus confidence as NCW */
+    }
+
+#if D_PD_LIB_STATS
+    job_stats_confidence ( pfa_InputData, pfa_Profile, (*pfa_OutputData).DefocusConfidence );
+#endif
+
+    return ;
+}
+
+/* Function for calculating output data of each window from checked calibration data */
+static void job_get_defocus_batch 
+( 
+    PdLibInputData_t        *pfa_InputData,                 /* Input  : Input data structure with calibration data */
+    PdLibKnotIndex_t        *pfa_KnotIndex,                 /* Input  : Index of knots of calibration data */
+    signed long             *pfa_ThrCache,                  /* Input  : Threshold at each knot. NULL calculates it */
+    signed long             fa_RetCheckCalib,               /* Input  : Result of checking calibration data */
+    PdLibProfileState_t     *pfa_Profile,                   /* Input  : Sensor profile */
+    Trace_t                 *pfa_Trace,                     /* In/Out : Trace of context, or NULL */
+    unsigned long           fa_WindowNum,                   /* Input  : Number of windows */
+    PdLibWindow_t           *pfa_Window,                    /* Input  : Array of PDAF windows */
+    PdLibPhaseDiffData_t    *pfa_PhaseDiffData,             /* Input  : Array of phase difference data */
+    PdLibOutputData_t       *pfa_OutputData,                /* Output : Array of output data structure */
+    signed long             *pfa_Result                     /* Output : Array of return value of each window */
+)
+{
+    unsigned long       i;
+    PdLibPlaneBatch_t   PlaneBatch;
+#if D_PD_LIB_TRACE_NUM
+    unsigned char       AreaIndex[D_PD_LIB_TRACE_NUM];      /* Area of the windows written to trace */
+    unsigned long       TraceStart;
+
+    /* Only the last D_PD_LIB_TRACE_NUM windows remain in trace */
+    TraceStart = ( pfa_Trace != NULL && D_PD_LIB_TRACE_NUM < fa_WindowNum ) ? fa_WindowNum - D_PD_LIB_TRACE_NUM : 0;
+#endif
+
+    PlaneBatch.Num = 0;
+
+    for ( i = 0; i < fa_WindowNum; i++ ) {
+        signed long RetCheckInput;
+        unsigned char *p_AreaIndex;
+
+        job_init_output_data ( &(pfa_OutputData[i]) );     /* Initialization of  output data structure */
+
+        p_AreaIndex = NULL;
+#if D_PD_LIB_TRACE_NUM
+        if ( pfa_Trace != NULL && TraceStart <= i ) {       /* Area of window written to trace */
+            p_AreaIndex = &(AreaIndex[i - TraceStart]);
+        }
+#endif
+
+        if ( fa_RetCheckCalib != D_PD_LIB_E_OK ) {          /* Error of calibration data */
+            pfa_Result[i] = fa_RetCheckCalib;
+            continue ;
+        }
+
+        /* Set window and phase difference to input data structure */
+        job_set_input_window ( &(pfa_Window[i]), &(pfa_PhaseDiffData[i]), pfa_InputData );
+
+        RetCheckInput = job_check_input_window ( pfa_InputData );   /* Check PDAF window */
+
+        if ( RetCheckInput == D_PD_LIB_E_OK ) {             /* Check the value of input */
+            /* Calculate defocus. Defocus in the center area is deferred to PlaneBatch. */
+            job_calc_defocus ( pfa_InputData, pfa_KnotIndex, &PlaneBatch, &(pfa_OutputData[i].Defocus), p_AreaIndex );
+
+            /* Calculate defocus confidence */
+            job_get_defocus_confidence ( pfa_InputData, pfa_KnotIndex, pfa_ThrCache, NULL, pfa_Profile, &(pfa_OutputData[i]) );
+
+            /* Calculate phase difference */
+            job_calc_phase_difference ( pfa_InputData, &(pfa_OutputData[i].PhaseDifference) );
+
+            if ( PlaneBatch.Num == D_PLANE_BATCH_NUM ) {
+                job_flush_plane_batch ( &PlaneBatch );
+            }
+        }
+
+        pfa_Result[i] = RetCheckInput;
+    }
+
+    job_flush_plane_batch ( &PlaneBatch );                  /* Remainder of deferred defocus */
+
+#if D_PD_LIB_TRACE_NUM
+    if ( pfa_Trace != NULL ) {                              /* Record windows to trace of context */
+        job_trace_windows ( pfa_Trace, pfa_InputData, NULL, fa_WindowNum, pfa_Window, pfa_PhaseDiffData, pfa_OutputData, pfa_Result, AreaIndex );
+    }
+#else
+    (void)pfa_Trace;
+#endif
+
+#if D_PD_LIB_STATS
+    for ( i = 0; i < fa_WindowNum; i++ ) {
+        job_stats_result ( pfa_Result[i] );
+    }
+#endif
+
+    return ;
+}
+
+/* Task of PdLibGetDefocusBatchParallel() for windows from fa_Start to fa_End-1 */
+static void job_run_batch_task 
+( 
+    void            *pfa_Arg,                               /* Input  : PdLibBatchTask_t */
+    unsigned long   fa_Start,                               /* Input  : First window */
+    unsigned long   fa_End                                  /* Input  : Next of last window */
+)
+{
+    PdLibBatchTask_t *p_Task;
+    PdLibInputData_t InputData;
+
+    p_Task    = (PdLibBatchTask_t *)pfa_Arg;
+    InputData = (*p_Task).InputData;                        /* Window is set to the copy of each thread */
+
+    job_get_defocus_batch ( &InputData, (*p_Task).p_KnotIndex, (*p_Task).p_ThrCache, (*p_Task).RetCheckCalib, (*p_Task).p_Profile, (*p_Task).p_Trace,
+                            fa_End - fa_Start, &((*p_Task).p_Window[fa_Start]), &((*p_Task).p_PhaseDiffData[fa_Start]),
+                            &((*p_Task).p_OutputData[fa_Start]), &((*p_Task).p_Result[fa_Start]) );
+
+    return ;
+}
+
+/* Function for getting defocus data of input data with sensor profile, as PdLibGetDefocus() */
+static signed long job_get_defocus_input 
+( 
+    PdLibInputData_t    *pfa_InputData,                     /* Input  : Input data structure */
+    PdLibProfileState_t *pfa_Profile,                       /* Input  : Sensor profile */
+    PdLibOutputData_t   *pfa_OutputData                     /* Output : Output data structure */
+)
+{
+    signed long ret;
+    signed long RetCheckInput;
+    PdLibKnotIndex_t KnotIndex;
+#if D_PD_LIB_STATS
+    unsigned long long StartTime;
+
+    StartTime = StatisticsGetTime ();                       /* Start of latency */
+#endif
+
+    job_init_output_data ( pfa_OutputData );                /* Initialization of  output data structure */
+
+    RetCheckInput = job_check_input ( pfa_InputData, pfa_Profile );  /* Check value of input data structure */
+
+    if ( RetCheckInput != D_PD_LIB_E_OK ) {                 /* Check the value of input */
+        ret = RetCheckInput;
+#if D_PD_LIB_STATS
+        job_stats_result ( ret );
+        job_stats_latency ( StartTime );
+#endif
+        return ret;                                         /* Return error value */
+    } else {
+        ret = D_PD_LIB_E_OK;                                /* Set return value as OK */
+    }
+
+    job_init_knot_index ( pfa_InputData, &KnotIndex );      /* Build index of knots */
+
+    job_get_defocus ( pfa_InputData, &KnotIndex, pfa_Profile, pfa_OutputData );   /* Calculate output data */
+
+#if D_PD_LIB_STATS
+    job_stats_result ( ret );
+    job_stats_latency ( StartTime );
+#endif
+
+    return ret;                                             /* Return OK */
+}
+
+/* Task of PdLibGetDefocusParallel() for input data from fa_Start to fa_End-1 */
+static void job_run_input_task 
+( 
+    void            *pfa_Arg,                               /* Input  : PdLibInputTask_t */
+    unsigned long   fa_Start,                               /* Input  : First input data */
+    unsigned long   fa_End                                  /* Input  : Next of last input data */
+)
+{
+    unsigned long i;
+    PdLibInputTask_t *p_Task;
+
+    p_Task = (PdLibInputTask_t *)pfa_Arg;
+
+    for ( i = fa_Start; i < fa_End; i++ ) {
+        (*p_Task).p_Result[i] = job_get_defocus_input ( &((*p_Task).p_InputData[i]), (*p_Task).p_Profile, &((*p_Task).p_OutputData[i]) );
+    }
+
+    return ;
+}
+
+/* Function for calculating rows of cells of defocus map from fa_YCellStart to fa_YCellEnd-1 */
+static void job_get_defocus_map 
+( 
+    PdLibInputData_t        *pfa_InputData,                 /* Input  : Input data structure with calibration data */
+    PdLibRegMap_t           *pfa_RegMap,                    /* Input  : Registered defocus map */
+    PdLibKnotIndex_t        *pfa_KnotIndex,                 /* Input  : Index of knots calculating threshold, or NULL for threshold of map */
+    PdLibProfileState_t     *pfa_Profile,                   /* Input  : Sensor profile */
+    PdLibPhaseDiffData_t    *pfa_Sample,                    /* Input  : Array of samples of phase difference */
+    unsigned long           fa_YCellStart,                  /* Input  : First row of cells */
+    unsigned long           fa_YCellEnd,                    /* Input  : Next of last row of cells */
+    signed long             *pfa_DefocusMap,                /* Output : Defocus of each cell */
+    unsigned long           *pfa_ConfidenceLevelMap         /* Output : Defocus confidence level of each cell */
+)
+{
+    unsigned long   i;
+    unsigned long   x;
+    unsigned long   y;
+    unsigned long   XCellNum;
+    unsigned char   JudgeConfidence;
+    PdLibMapAxis_t  *p_XAxis;
+    signed long     PhaseDifference[D_MAP_CHUNK_NUM];
+    signed long     CellThr[D_MAP_CHUNK_NUM];
+#if !D_MATH_FUNC_FIXED_POINT
+    double          DensityOfPhasePix;
+    double          ConfidenceLevel[D_MAP_CHUNK_NUM];
+    signed long     DefocusOkNgThr[D_MAP_CHUNK_NUM];
+#endif
+
+    XCellNum = (*pfa_RegMap).XCellNum;
+    p_XAxis  = (*pfa_RegMap).p_XAxis;
+
+#if !D_MATH_FUNC_FIXED_POINT
+    if ( (*pfa_InputData).DensityOfPhasePix == 0 ) {        /* If DensityOfPhasePix is not set */
+        DensityOfPhasePix = 2304.0;                         /* Set default value to DensityOfPhasePix */
+    } else {
+        DensityOfPhasePix = (double)((*pfa_InputData).DensityOfPhasePix);
+    }
+#endif
+
+    /* Confidence is judged only with DefocusOKNG knots, same as job_get_defocus_confidence() */
+    JudgeConfidence = ( (*pfa_InputData).XKnotNumDefocusOKNG != 0 && (*pfa_InputData).YKnotNumDefocusOKNG != 0 ) ? 1 : 0;
+
+    for ( y = fa_YCellStart; y < fa_YCellEnd; y++ ) {
+        PdLibPhaseDiffData_t *p_Sample;
+
+        /* Row of samples containing centers of the row of cells */
+        p_Sample = &(pfa_Sample[(*pfa_RegMap).p_YAxis[y].Sample * (*pfa_RegMap).XSampleNum]);
+
+        for ( x = 0; x < XCellNum; x += D_MAP_CHUNK_NUM ) {
+            unsigned long Num;
+            unsigned long Index;
+
+            Num   = ( XCellNum - x < D_MAP_CHUNK_NUM ) ? XCellNum - x : D_MAP_CHUNK_NUM;
+            Index = y * XCellNum + x;
+
+            for ( i = 0; i < Num; i++ ) {
+                PdLibPhaseDiffData_t *p_CellSample;
+
+                p_CellSample = &(p_Sample[p_XAxis[x+i].Sample]);
+
+                if ( pfa_KnotIndex == NULL ) {
+                    CellThr[i] = (*pfa_RegMap).p_DefocusOkNgThr[Index+i];
+                } else if ( JudgeConfidence == 0 ) {
+                    CellThr[i] = 0;                         /* Confidence is not judged */
+                } else {
+                    /* Calculate threshold at cell center from calibration data, same as job_update_map_thr_cache() */
+                    (*pfa_InputData).XAddressOfWindowStart = (unsigned short)p_XAxis[x+i].Center;
+                    (*pfa_InputData).XAddressOfWindowEnd   = (unsigned short)p_XAxis[x+i].Center;
+                    (*pfa_InputData).YAddressOfWindowStart = (unsigned short)(*pfa_RegMap).p_YAxis[y].Center;
+                    (*pfa_InputData).YAddressOfWindowEnd   = (unsigned short)(*pfa_RegMap).p_YAxis[y].Center;
+
+                    job_calc_defocus_ok_ng_thr ( pfa_InputData, pfa_KnotIndex, NULL, &(CellThr[i]) );
+
+                    if ( CellThr[i] <= 0 ) CellThr[i] = 0;  /* Check DefocusOkNgThr */
+                }
+
+                PhaseDifference[i] = (*p_CellSample).PhaseDifference;
+#if !D_MATH_FUNC_FIXED_POINT
+                ConfidenceLevel[i] = 1024.0 * (double)((*p_CellSample).ConfidenceLevel) * 2304.0;
+                DefocusOkNgThr[i]  = ( CellThr[i] != 0 ) ? CellThr[i] : 1;
+#endif
+            }
+
+            /* Calculate defocus with slope and offset at cell centers */
+#if D_MATH_FUNC_FIXED_POINT
+            CalcLinearArray_sllAsllBslX ( Num, &((*pfa_RegMap).p_Slope[Index]), &((*pfa_RegMap).p_Offset[Index]),
+                                          PhaseDifference, &(pfa_DefocusMap[Index]) );
+#else
+            CalcLinearArray_dAdBslX ( Num, &((*pfa_RegMap).p_Slope[Index]), &((*pfa_RegMap).p_Offset[Index]),
+                                      PhaseDifference, &(pfa_DefocusMap[Index]) );
+#endif
+
+#if D_MATH_FUNC_FIXED_POINT
+            for ( i = 0; i < Num; i++ ) {
+                (*pfa_InputData).ConfidenceLevel = p_Sample[p_XAxis[x+i].Sample].ConfidenceLevel;
+
+                /* Calculate defocus confidence level with threshold of the cell */
+                job_calc_defocus_confidence_level ( pfa_InputData, CellThr[i], &(pfa_ConfidenceLevelMap[Index+i]) );
+            }
+#else
+            /* 1024 * ConfidenceLevel * 2304 / DensityOfPhasePix / DefocusOkNgThr, same as job_calc_defocus_confidence_level(). */
+            /* Zero threshold is divided by 1 and set below. */
+            CalcQuotientArray_dXdYslZ ( Num, ConfidenceLevel, DensityOfPhasePix, DefocusOkNgThr, &(pfa_ConfidenceLevelMap[Index]) );
+#endif
+
+            for ( i = 0; i < Num; i++ ) {
+                if ( JudgeConfidence == 0 || PhaseDifference[i] == (*pfa_Profile).PdErrorPhaseDiff ) {
+                    pfa_ConfidenceLevelMap[Index+i] = 0;    /* Set defocus confidence level as Zero for error or NCW */
+#if !D_MATH_FUNC_FIXED_POINT
+                } else if ( CellThr[i] == 0 ) {             /* If DefocusOkNgThr is Zero */
+                    pfa_ConfidenceLevelMap[Index+i] = 1024; /* Set max value to ConfidenceLevel */
+#endif
+                }
+            }
+        }
+    }
+
+    return ;
+}
+
+/* Task of PdLibGetDefocusMap() for rows of cells from fa_Start to fa_End-1 */
+static void job_run_map_task 
+( 
+    void            *pfa_Arg,                               /* Input  : PdLibMapTask_t */
+    unsigned long   fa_Start,                               /* Input  : First row of cells */
+    unsigned long   fa_End                                  /* Input  : Next of last row of cells */
+)
+{
+    PdLibMapTask_t *p_Task;
+    PdLibInputData_t InputData;
+
+    p_Task    = (PdLibMapTask_t *)pfa_Arg;
+    InputData = (*p_Task).InputData;                        /* Confidence level is set to the copy of each thread */
+
+    job_get_defocus_map ( &InputData, (*p_Task).p_RegMap, (*p_Task).p_KnotIndex, (*p_Task).p_Profile, (*p_Task).p_Sample, fa_Start, fa_End,
+                          (*p_Task).p_DefocusMap, (*p_Task).p_ConfidenceLevelMap );
+
+    return ;
+}
+
+/* Task of PdLibGetPhaseDiff() for windows from fa_Start to fa_End-1 */
+static void job_run_pd_task 
+( 
+    void            *pfa_Arg,                               /* Input  : PdLibPdTask_t */
+    unsigned long   fa_Start,                               /* Input  : First window */
+    unsigned long   fa_End                                  /* Input  : Next of last window */
+)
+{
+    unsigned long i;
+    PdLibPdTask_t *p_Task;
+
+    p_Task = (PdLibPdTask_t *)pfa_Arg;
+
+    for ( i = fa_Start; i < fa_End; i++ ) {
+        PhaseDetectWindow ( (*p_Task).p_Image, (*p_Task).p_Param, (*p_Task).LevelNum, &((*p_Task).p_Window[i]),
+                            &((*p_Task).p_PhaseDiffData[i]), ( (*p_Task).p_Level != NULL ) ? &((*p_Task).p_Level[i]) : NULL );
+    }
+
+    return ;
+}
+
+/* Function for converting return value of record module to error value of API */
+static signed long job_record_error 
+( 
+    signed char fa_Ret                                      /* Input : Return value of record module */
+)
+{
+    if ( fa_Ret == D_RECORD_NG_ALLOC ) {
+        return -EALLOCREC;                                  /* Allocation failed */
+    } else if ( fa_Ret == D_RECORD_NG_WRITE ) {
+        return -EWRITEREC;                                  /* Write function failed */
+    } else if ( fa_Ret != D_RECORD_OK ) {
+        return -EINVALREC;                                  /* Invalid data or stream */
+    }
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* Function for checking pointers and numbers of tables of calibration data read by job_copy_context_calib() */
+/* Values in the tables are checked by PdLibValidateContext(). */
+static signed long job_check_context_calib 
+( 
+    PdLibCalibData_t *pfa_CalibData                         /* Input : Calibration data structure */
+)
+{
+    unsigned long i;
+    unsigned long LineNum;
+
+    if ( pfa_CalibData == NULL ) {                          /* Check calibration data */
+        return -EINVALCTX;                                  /* Return error value */
+    }
+
+    if ( (*pfa_CalibData).XKnotNumSlopeOffset != 0 && (*pfa_CalibData).YKnotNumSlopeOffset != 0 &&
+         ( (*pfa_CalibData).p_SlopeData == NULL || (*pfa_CalibData).p_OffsetData == NULL ) ) {
+        return -EINSO;                                      /* No table of slope and offset */
+    }
+    if ( (*pfa_CalibData).XKnotNumSlopeOffset != 0 && (*pfa_CalibData).p_XAddressKnotSlopeOffset == NULL ) {
+        return -EINSOXAK;                                   /* No table of knots */
+    }
+    if ( (*pfa_CalibData).YKnotNumSlopeOffset != 0 && (*pfa_CalibData).p_YAddressKnotSlopeOffset == NULL ) {
+        return -EINSOYAK;                                   /* No table of knots */
+    }
+    if ( (*pfa_CalibData).XKnotNumDefocusOKNG != 0 && (*pfa_CalibData).p_XAddressKnotDefocusOKNG == NULL ) {
+        return -EINDONXAK;                                  /* No table of knots */
+    }
+    if ( (*pfa_CalibData).YKnotNumDefocusOKNG != 0 && (*pfa_CalibData).p_YAddressKnotDefocusOKNG == NULL ) {
+        return -EINDONYAK;                                  /* No table of knots */
+    }
+
+    LineNum = (unsigned long)(*pfa_CalibData).XKnotNumDefocusOKNG * (*pfa_CalibData).YKnotNumDefocusOKNG;
+
+    if ( (*pfa_CalibData).p_DefocusOKNGThrLine == NULL ) {
+        return -EINDONTPN;                                  /* No table of threshold lines. First line is checked by validation. */
+    }
+    if ( LineNum == 0 ) {
+        LineNum = 1;                                        /* First line is copied even if confidence judgement is disabled */
+    }
+
+    for ( i = 0; i < LineNum; i++ ) {                       /* Check each line */
+        DefocusOKNGThrLine_t *p_Line;
+
+        p_Line = &((*pfa_CalibData).p_DefocusOKNGThrLine[i]);
+
+        if ( (*p_Line).PointNum == 0 || D_PD_LIB_THR_POINT_NUM_MAX < (*p_Line).PointNum ||
+             (*p_Line).p_AnalogGain == NULL || (*p_Line).p_Confidence == NULL ) {
+            return -EINDONTPN;                              /* Out of range of points of line */
+        }
+    }
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* Function for calculating size of context including tables of calibration data */
+static unsigned long job_calc_context_size 
+( 
+    PdLibCalibData_t *pfa_CalibData                         /* Input : Calibration data structure */
+)
+{
+    unsigned long i;
+    unsigned long Size;
+    unsigned long KnotNum;
+    unsigned long LineNum;
+    unsigned long PointNum;
+
+    KnotNum = (unsigned long)(*pfa_CalibData).XKnotNumSlopeOffset * (*pfa_CalibData).YKnotNumSlopeOffset;
+    LineNum = (unsigned long)(*pfa_CalibData).XKnotNumDefocusOKNG * (*pfa_CalibData).YKnotNumDefocusOKNG;
+
+    if ( LineNum == 0 && (*pfa_CalibData).p_DefocusOKNGThrLine != NULL ) {
+        LineNum = 1;                                        /* First line is checked even if confidence judgement is disabled */
+    }
+
+    PointNum = 0;
+    for ( i = 0; i < LineNum; i++ ) {
+        PointNum += (*pfa_CalibData).p_DefocusOKNGThrLine[i].PointNum;
+    }
+
+    /* Keep alignment : context, threshold lines, long arrays, packed data and short arrays in this order */
+    Size  = sizeof(PdLibContext_t);
+    Size += sizeof(DefocusOKNGThrLine_t) * LineNum;
+    Size += sizeof(signed long) * KnotNum * 2;               /* Slope and offset */
+    Size += sizeof(signed long) * LineNum;                  /* Cache of threshold */
+    Size += job_calc_packed_size ( KnotNum, LineNum, PointNum );    /* Packed slope, offset and threshold lines */
+    Size += sizeof(unsigned short) * ( (*pfa_CalibData).XKnotNumSlopeOffset + (*pfa_CalibData).YKnotNumSlopeOffset +
+                                       (*pfa_CalibData).XKnotNumDefocusOKNG + (*pfa_CalibData).YKnotNumDefocusOKNG );
+
+    return Size;
+}
+
+/* Function for calculating size of scratch buffer and of its parts */
+/* Each part is aligned to D_SCRATCH_ALIGN from the aligned start of the buffer. */
+static signed long job_calc_scratch_size 
+( 
+    PdLibCalibData_t *pfa_CalibData,                        /* Input  : Calibration data structure, or NULL */
+    unsigned long fa_WindowNum,                             /* Input  : Maximum number of registered windows */
+    unsigned long fa_XCellNum,                              /* Input  : Maximum number of cells in x-direction */
+    unsigned long fa_YCellNum,                              /* Input  : Maximum number of cells in y-direction */
+    unsigned long *pfa_ContextSize,                         /* Output : Size of context and tables */
+    unsigned long *pfa_WindowSize,                          /* Output : Size of registered windows */
+    unsigned long *pfa_MapSize,                             /* Output : Size of defocus map */
+    unsigned long *pfa_ScratchSize                          /* Output : Size of scratch buffer */
+)
+{
+    unsigned long Limit;
+    unsigned long ContextSize;
+    unsigned long WindowSize;
+    unsigned long MapSize;
+
+    Limit = (unsigned long)-1 / 4;                          /* Sum of parts does not overflow */
+
+    if ( D_SCRATCH_CELL_MAX < fa_XCellNum || D_SCRATCH_CELL_MAX < fa_YCellNum ||
+         Limit / sizeof(PdLibRegWindow_t) - 1 < fa_WindowNum ) {
+        return -EINVALSCRATCH;                              /* Out of range */
+    }
+
+    ContextSize = 0;
+    if ( pfa_CalibData != NULL ) {
+        signed long ret;
+
+        ret = job_check_context_calib ( pfa_CalibData );    /* Check tables read by copy */
+
+        if ( ret != D_PD_LIB_E_OK ) {                       /* Check result */
+            return ret;                                     /* Return error value */
+        }
+
+        ContextSize = job_calc_context_size ( pfa_CalibData );
+        ContextSize = ( ContextSize + D_SCRATCH_ALIGN - 1 ) & ~(unsigned long)( D_SCRATCH_ALIGN - 1 );
+    }
+
+    WindowSize = 0;
+    if ( fa_WindowNum != 0 ) {                              /* One more window as PdLibRegisterWindows() */
+        WindowSize = sizeof(PdLibRegWindow_t) * ( fa_WindowNum + 1 );
+        WindowSize = ( WindowSize + D_SCRATCH_ALIGN - 1 ) & ~(unsigned long)( D_SCRATCH_ALIGN - 1 );
+    }
+
+    MapSize = 0;
+    if ( fa_XCellNum != 0 && fa_YCellNum != 0 ) {
+        if ( (unsigned long long)Limit < (unsigned long long)( sizeof(PdLibCoeff_t) * 2 + sizeof(signed long) ) * fa_XCellNum * fa_YCellNum +
+                                         (unsigned long long)( sizeof(PdLibMapAxis_t) + sizeof(signed long) * 2 ) * ( fa_XCellNum + fa_YCellNum ) ) {
+            return -EINVALSCRATCH;                          /* Out of range */
+        }
+        MapSize = job_calc_map_size ( fa_XCellNum, fa_YCellNum );
+    }
+
+    if ( Limit < ContextSize ) {
+        return -EINVALSCRATCH;                              /* Out of range */
+    }
+
+    (*pfa_ContextSize) = ContextSize;
+    (*pfa_WindowSize)  = WindowSize;
+    (*pfa_MapSize)     = MapSize;
+    (*pfa_ScratchSize) = D_SCRATCH_ALIGN - 1 + ContextSize + WindowSize + MapSize;
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* Function for calculating size of registered defocus map */
+static unsigned long job_calc_map_size 
+( 
+    unsigned long fa_XCellNum,                              /* Input : Number of cells in x-direction */
+    unsigned long fa_YCellNum                               /* Input : Number of cells in y-direction */
+)
+{
+    /* Slope, offset and threshold of cells, axes, and threshold lines of a row in this order */
+    return ( sizeof(PdLibCoeff_t) * 2 + sizeof(signed long) ) * fa_XCellNum * fa_YCellNum +
+           sizeof(PdLibMapAxis_t) * ( fa_XCellNum + fa_YCellNum ) +
+           sizeof(signed long) * 2 * fa_XCellNum;
+}
+
+/* Function for releasing registered windows and defocus map of context */
+static void job_release_registration 
+( 
+    PdLibContext_t *pfa_Context                             /* In/Out : Context */
+)
+{
+    if ( (*pfa_Context).p_Scratch == NULL ) {               /* Scratch buffer is not released */
+        free ( (*pfa_Context).p_RegWindow );
+        free ( (*pfa_Context).RegMap.p_Slope );
+    }
+
+    (*pfa_Context).RegWindowNum    = 0;
+    (*pfa_Context).p_RegWindow     = NULL;
+    (*pfa_Context).RegMap.XCellNum = 0;
+    (*pfa_Context).RegMap.p_Slope  = NULL;
+
+    return ;
+}
+
+/* Function for getting buffer of registered windows or defocus map */
+/* Buffer is taken from scratch buffer of context if it is set, otherwise allocated. */
+static signed long job_alloc_registration 
+( 
+    PdLibContext_t *pfa_Context,                            /* Input  : Context */
+    unsigned char fa_Map,                                   /* Input  : 0 : registered windows, 1 : defocus map */
+    unsigned long fa_Size,                                  /* Input  : Size of buffer */
+    void **ppfa_Buffer                                      /* Output : Buffer */
+)
+{
+    (*ppfa_Buffer) = NULL;
+
+    if ( (*pfa_Context).p_Scratch != NULL ) {
+        if ( ( fa_Map ? (*pfa_Context).ScratchMapSize : (*pfa_Context).ScratchWindowSize ) < fa_Size ) {
+            return -EINVALSCRATCH;                          /* Too many windows or cells for scratch buffer */
+        }
+
+        (*ppfa_Buffer) = (*pfa_Context).p_Scratch + ( fa_Map ? (*pfa_Context).ScratchWindowSize : 0 );
+
+        return D_PD_LIB_E_OK;                               /* Return OK */
+    }
+
+    (*ppfa_Buffer) = malloc ( fa_Size );
+
+    if ( (*ppfa_Buffer) == NULL ) {                         /* Check result of allocation */
+        return -EALLOCCTX;                                  /* Return error value */
+    }
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* Function for copying calibration data to the tables allocated with context */
+static void job_copy_context_calib 
+( 
+    PdLibCalibData_t *pfa_CalibData,                        /* Input  : Calibration data structure */
+    PdLibContext_t *pfa_Context                             /* Output : Context */
+)
+{
+    unsigned long i;
+    unsigned long KnotNum;
+    unsigned long LineNum;
+    unsigned char *p_Table;
+    PdLibCalibData_t CalibData;
+
+    KnotNum = (unsigned long)(*pfa_CalibData).XKnotNumSlopeOffset * (*pfa_CalibData).YKnotNumSlopeOffset;
+    LineNum = (unsigned long)(*pfa_CalibData).XKnotNumDefocusOKNG * (*pfa_CalibData).YKnotNumDefocusOKNG;
+
+    if ( LineNum == 0 && (*pfa_CalibData).p_DefocusOKNGThrLine != NULL ) {
+        LineNum = 1;                                        /* First line is checked even if confidence judgement is disabled */
+    }
+
+    CalibData = (*pfa_CalibData);
+    p_Table = (unsigned char *)(pfa_Context + 1);           /* Tables follow context */
+
+    CalibData.p_DefocusOKNGThrLine = (LineNum != 0) ? (DefocusOKNGThrLine_t *)p_Table : NULL;
+    p_Table += sizeof(DefocusOKNGThrLine_t) * LineNum;
+
+    CalibData.p_SlopeData = (signed long *)p_Table;
+    memcpy ( p_Table, (*pfa_CalibData).p_SlopeData, sizeof(signed long) * KnotNum );
+    p_Table += sizeof(signed long) * KnotNum;
+
+    CalibData.p_OffsetData = (signed long *)p_Table;
+    memcpy ( p_Table, (*pfa_CalibData).p_OffsetData, sizeof(signed long) * KnotNum );
+    p_Table += sizeof(signed long) * KnotNum;
+
+    (*pfa_Context).p_ThrCache = (signed long *)p_Table;     /* Set by job_update_thr_cache() */
+    p_Table += sizeof(signed long) * LineNum;
+
+    for ( i = 0; i < LineNum; i++ ) {                       /* Points are copied by job_pack_context_calib() */
+        CalibData.p_DefocusOKNGThrLine[i] = (*pfa_CalibData).p_DefocusOKNGThrLine[i];
+    }
+
+    /* Pack slope, offset and threshold lines, and point lines to the packed block */
+    p_Table = job_pack_context_calib ( &CalibData, LineNum, &((*pfa_Context).Packed), p_Table );
+
+    CalibData.p_XAddressKnotSlopeOffset = (unsigned short *)p_Table;
+    memcpy ( p_Table, (*pfa_CalibData).p_XAddressKnotSlopeOffset, sizeof(unsigned short) * CalibData.XKnotNumSlopeOffset );
+    p_Table += sizeof(unsigned short) * CalibData.XKnotNumSlopeOffset;
+
+    CalibData.p_YAddressKnotSlopeOffset = (unsigned short *)p_Table;
+    memcpy ( p_Table, (*pfa_CalibData).p_YAddressKnotSlopeOffset, sizeof(unsigned short) * CalibData.YKnotNumSlopeOffset );
+    p_Table += sizeof(unsigned short) * CalibData.YKnotNumSlopeOffset;
+
+    CalibData.p_XAddressKnotDefocusOKNG = (unsigned short *)p_Table;
+    if ( CalibData.XKnotNumDefocusOKNG != 0 ) {             /* Knots are not set if confidence judgement is disabled */
+        memcpy ( p_Table, (*pfa_CalibData).p_XAddressKnotDefocusOKNG, sizeof(unsigned short) * CalibData.XKnotNumDefocusOKNG );
+    }
+    p_Table += sizeof(unsigned short) * CalibData.XKnotNumDefocusOKNG;
+
+    CalibData.p_YAddressKnotDefocusOKNG = (unsigned short *)p_Table;
+    if ( CalibData.YKnotNumDefocusOKNG != 0 ) {             /* Knots are not set if confidence judgement is disabled */
+        memcpy ( p_Table, (*pfa_CalibData).p_YAddressKnotDefocusOKNG, sizeof(unsigned short) * CalibData.YKnotNumDefocusOKNG );
+    }
+
+    /* Set copied calibration data to input data structure of context */
+    job_set_input_calib ( &CalibData, 0, &((*pfa_Context).InputData) );
+
+    return ;
+}
+
+/* Function for calculating size of packed calibration data */
+/* Slope and offset are reserved as 32 bit, since they are packed after the block is allocated. */
+static unsigned long job_calc_packed_size 
+( 
+    unsigned long fa_KnotNum,                               /* Input : Number of knots of slope and offset */
+    unsigned long fa_LineNum,                               /* Input : Number of threshold lines packed, or 0 */
+    unsigned long fa_PointNum                               /* Input : Number of points of the lines */
+)
+{
+    unsigned long Size;
+
+    Size = sizeof(signed int) * 2 * fa_KnotNum;              /* Slope and offset */
+
+    if ( fa_LineNum != 0 ) {                                /* Index, analog gain and confidence of lines */
+        Size += sizeof(unsigned long) * ( fa_LineNum + 1 + fa_PointNum * 2 );
+    }
+
+    return Size;
+}
+
+/* Function for packing calibration data to the block of context */
+/* Slope and offset are packed to the narrowest of 16 and 32 bit which keeps all values. When fa_LineNum is */
+/* not 0, points of the lines are copied to one block and the lines are pointed to it. */
+static unsigned char *job_pack_context_calib 
+( 
+    PdLibCalibData_t *pfa_CalibData,                        /* In/Out : Calibration data with lines of context */
+    unsigned long fa_LineNum,                               /* Input  : Number of threshold lines packed, or 0 */
+    PdLibPackedCalib_t *pfa_Packed,                         /* Output : Packed calibration data */
+    unsigned char *pfa_Table                                /* Input  : Block of packed data */
+)
+{
+    unsigned long i;
+    unsigned long KnotNum;
+    unsigned long PointNum;
+    signed long   Min;
+    signed long   Max;
+    unsigned char *p_Table;
+
+    KnotNum = (unsigned long)(*pfa_CalibData).XKnotNumSlopeOffset * (*pfa_CalibData).YKnotNumSlopeOffset;
+    p_Table = pfa_Table;
+
+    /* Lines first to keep alignment of unsigned long */
+    (*pfa_Packed).LineNum     = fa_LineNum;
+    (*pfa_Packed).p_LineStart = NULL;
+    (*pfa_Packed).p_LineGain  = NULL;
+    (*pfa_Packed).p_LineConf  = NULL;
+
+    if ( fa_LineNum != 0 ) {
+        DefocusOKNGThrLine_t *p_Line;
+
+        p_Line = (*pfa_CalibData).p_DefocusOKNGThrLine;
+
+        (*pfa_Packed).p_LineStart = (unsigned long *)p_Table;
+        p_Table += sizeof(unsigned long) * ( fa_LineNum + 1 );
+
+        PointNum = 0;
+        for ( i = 0; i < fa_LineNum; i++ ) {
+            (*pfa_Packed).p_LineStart[i] = PointNum;
+            PointNum += p_Line[i].PointNum;
+        }
+        (*pfa_Packed).p_LineStart[fa_LineNum] = PointNum;
+
+        (*pfa_Packed).p_LineGain = (unsigned long *)p_Table;
+        p_Table += sizeof(unsigned long) * PointNum;
+        (*pfa_Packed).p_LineConf = (unsigned long *)p_Table;
+        p_Table += sizeof(unsigned long) * PointNum;
+
+        for ( i = 0; i < fa_LineNum; i++ ) {
+            unsigned long *p_Gain;
+            unsigned long *p_Conf;
+
+            p_Gain = &((*pfa_Packed).p_LineGain[(*pfa_Packed).p_LineStart[i]]);
+            p_Conf = &((*pfa_Packed).p_LineConf[(*pfa_Packed).p_LineStart[i]]);
+
+            memcpy ( p_Gain, p_Line[i].p_AnalogGain, sizeof(unsigned long) * p_Line[i].PointNum );
+            memcpy ( p_Conf, p_Line[i].p_Confidence, sizeof(unsigned long) * p_Line[i].PointNum );
+
+            p_Line[i].p_AnalogGain = p_Gain;                /* Checked and evaluated with packed points */
+            p_Line[i].p_Confidence = p_Conf;
+        }
+    }
+
+    /* Range of slope and offset */
+    Min = 0;
+    Max = 0;
+    for ( i = 0; i < KnotNum; i++ ) {
+        signed long Slope;
+        signed long Offset;
+
+        Slope  = (*pfa_CalibData).p_SlopeData[i];
+        Offset = (*pfa_CalibData).p_OffsetData[i];
+
+        Min = ( Slope  < Min ) ? Slope  : Min;
+        Max = ( Max < Slope  ) ? Slope  : Max;
+        Min = ( Offset < Min ) ? Offset : Min;
+        Max = ( Max < Offset ) ? Offset : Max;
+    }
+
+    (*pfa_Packed).p_SlopeOffset = p_Table;
+
+    if ( -0x8000L <= Min && Max <= 0x7FFFL ) {
+        signed short *p_Pair;
+
+        p_Pair = (signed short *)p_Table;
+        for ( i = 0; i < KnotNum; i++ ) {
+            p_Pair[i * 2    ] = (signed short)(*pfa_CalibData).p_SlopeData[i];
+            p_Pair[i * 2 + 1] = (signed short)(*pfa_CalibData).p_OffsetData[i];
+        }
+        (*pfa_Packed).SlopeOffsetBits = 16;
+    } else if ( -0x7FFFFFFFL - 1 <= Min && Max <= 0x7FFFFFFFL ) {
+        signed int *p_Pair;
+
+        p_Pair = (signed int *)p_Table;
+        for ( i = 0; i < KnotNum; i++ ) {
+            p_Pair[i * 2    ] = (signed int)(*pfa_CalibData).p_SlopeData[i];
+            p_Pair[i * 2 + 1] = (signed int)(*pfa_CalibData).p_OffsetData[i];
+        }
+        (*pfa_Packed).SlopeOffsetBits = 32;
+    } else {                                                /* Values of 64 bit signed long are not packed */
+        (*pfa_Packed).SlopeOffsetBits = 0;
+    }
+
+    return p_Table + sizeof(signed int) * 2 * KnotNum;      /* Reserved by job_calc_packed_size() */
+}
+
+/* Function for initializing state of context except calibration data */
+static void job_init_context 
+( 
+    PdLibContext_t *pfa_Context                             /* Output : Context */
+)
+{
+    (*pfa_Context).ValidateResult = -EINVALCTX;             /* Set as not validated */
+    job_get_lib_profile ( &((*pfa_Context).Profile) );      /* Sensor profile of PDAF Library */
+    (*pfa_Context).RegWindowNum   = 0;
+    (*pfa_Context).p_RegWindow    = NULL;
+    (*pfa_Context).RegMap.XCellNum = 0;
+    (*pfa_Context).RegMap.p_Slope  = NULL;
+    (*pfa_Context).ThrCacheGain     = 0;
+    (*pfa_Context).ThrCacheValid    = 0;
+    (*pfa_Context).RegThrCacheValid = 0;
+    (*pfa_Context).RegCoeffValid    = 1;
+    (*pfa_Context).CacheStatistics.CallNum       = 0;
+    (*pfa_Context).CacheStatistics.GainChangeNum = 0;
+    (*pfa_Context).Published         = 0;
+    (*pfa_Context).p_Scratch         = NULL;                /* Registration is allocated from heap */
+    (*pfa_Context).ScratchWindowSize = 0;
+    (*pfa_Context).ScratchMapSize    = 0;
+    (*pfa_Context).ScratchContext    = 0;
+#if D_PD_LIB_TRACE_NUM
+    TraceInit ( &((*pfa_Context).Trace) );
+#endif
+
+    return ;
+}
+
+/* Function for getting trace of context */
+static Trace_t *job_get_trace 
+( 
+    PdLibContext_t *pfa_Context                             /* Input  : Context */
+)
+{
+#if D_PD_LIB_TRACE_NUM
+    return &((*pfa_Context).Trace);
+#else
+    (void)pfa_Context;
+
+    return NULL;                                            /* Not recorded */
+#endif
+}
+
+/* Function for calculating threshold of confidence at each DefocusOKNG knot when analog gain is changed */
+static void job_update_thr_cache 
+( 
+    PdLibContext_t *pfa_Context,                            /* In/Out : Validated context */
+    unsigned long fa_ImagerAnalogGain                       /* Input  : Image sensor analog gain */
+)
+{
+    unsigned long i;
+    unsigned long LineNum;
+    PdLibInputData_t InputData;
+
+    (*pfa_Context).CacheStatistics.CallNum++;
+
+    if ( (*pfa_Context).ThrCacheValid != 0 && (*pfa_Context).ThrCacheGain == fa_ImagerAnalogGain ) {
+        return ;                                            /* Same analog gain */
+    }
+
+    InputData = (*pfa_Context).InputData;
+    InputData.ImagerAnalogGain = fa_ImagerAnalogGain;
+
+    LineNum = (unsigned long)InputData.XKnotNumDefocusOKNG * InputData.YKnotNumDefocusOKNG;
+
+    if ( (*pfa_Context).Packed.LineNum != 0 ) {             /* Lines in one block without their pointers */
+        PdLibPackedCalib_t *p_Packed;
+
+        p_Packed = &((*pfa_Context).Packed);
+
+        for ( i = 0; i < LineNum; i++ ) {
+            unsigned long Start;
+            unsigned long PointY = 0;
+
+            Start = (*p_Packed).p_LineStart[i];
+
+            CalcAddressOnBrokenLine_ulXulY ( &((*p_Packed).p_LineGain[Start]), &((*p_Packed).p_LineConf[Start]),
+                                             (*p_Packed).p_LineStart[i+1] - Start, fa_ImagerAnalogGain, &PointY );
+
+            (*pfa_Context).p_ThrCache[i] = (signed long)PointY;
+        }
+    } else {
+        for ( i = 0; i < LineNum; i++ ) {
+            (*pfa_Context).p_ThrCache[i] = calc_defocus_ok_ng_thr ( &InputData, NULL, (unsigned short)i );
+        }
+    }
+
+    (*pfa_Context).ThrCacheGain     = fa_ImagerAnalogGain;
+    (*pfa_Context).ThrCacheValid    = 1;
+    (*pfa_Context).RegThrCacheValid = 0;                    /* Threshold of windows is changed */
+    (*pfa_Context).RegMap.ThrCacheValid = 0;                /* Threshold of defocus map is changed */
+    (*pfa_Context).CacheStatistics.GainChangeNum++;
+
+    return ;
+}
+
+/* Function for getting threshold cache of context for analog gain. NULL : threshold is calculated from calibration data */
+/* Cache of a context which is not published is updated when analog gain is changed. Published context is */
+/* not written, and its cache is used only for the analog gain prepared by job_publish_context(). */
+static signed long *job_use_thr_cache 
+( 
+    PdLibContext_t *pfa_Context,                            /* In/Out : Validated context */
+    unsigned long fa_ImagerAnalogGain                       /* Input  : Image sensor analog gain */
+)
+{
+    if ( (*pfa_Context).Published == 0 ) {
+        job_update_thr_cache ( pfa_Context, fa_ImagerAnalogGain );  /* Update threshold if gain is changed */
+
+        return (*pfa_Context).p_ThrCache;
+    }
+
+    if ( (*pfa_Context).ThrCacheValid != 0 && (*pfa_Context).ThrCacheGain == fa_ImagerAnalogGain ) {
+        return (*pfa_Context).p_ThrCache;                   /* Same analog gain as publication */
+    }
+
+    return NULL;
+}
+
+/* Function for completing caches of context before it is shared by threads of slot */
+/* Threshold cache is kept for the analog gain of the last evaluation, or 0 if the context is not evaluated. */
+static void job_publish_context 
+( 
+    PdLibContext_t *pfa_Context                             /* In/Out : Context */
+)
+{
+    if ( (*pfa_Context).Published != 0 ) {
+        return ;                                            /* Already shared */
+    }
+
+    if ( (*pfa_Context).ValidateResult == D_PD_LIB_E_OK ) { /* Check result of validation */
+        job_update_thr_cache ( pfa_Context, (*pfa_Context).ThrCacheGain );
+        job_update_reg_thr_cache ( pfa_Context );
+        job_update_reg_coeff ( pfa_Context );
+
+        if ( (*pfa_Context).RegMap.XCellNum != 0 ) {        /* Check registration of map */
+            job_update_map_thr_cache ( pfa_Context );
+            job_update_map_coeff ( pfa_Context );
+        }
+    }
+
+    (*pfa_Context).Published = 1;                           /* Written before publication by slot */
+
+    return ;
+}
+
+/* Function for calculating threshold of confidence at each registered window from job_update_thr_cache() */
+static void job_update_reg_thr_cache 
+( 
+    PdLibContext_t *pfa_Context                             /* In/Out : Validated context with threshold cache */
+)
+{
+    unsigned long i;
+    PdLibInputData_t InputData;
+
+    if ( (*pfa_Context).RegThrCacheValid != 0 ) {
+        return ;                                            /* Same analog gain */
+    }
+
+    InputData = (*pfa_Context).InputData;
+    InputData.ImagerAnalogGain = (*pfa_Context).ThrCacheGain;
+
+    for ( i = 0; i < (*pfa_Context).RegWindowNum; i++ ) {
+        PdLibRegWindow_t *p_RegWindow;
+        PdLibPhaseDiffData_t PhaseDiffData;
+
+        p_RegWindow = &((*pfa_Context).p_RegWindow[i]);
+
+        (*p_RegWindow).DefocusOkNgThr = 0;
+
+        if ( InputData.XKnotNumDefocusOKNG != 0 && InputData.YKnotNumDefocusOKNG != 0 ) {
+            PhaseDiffData.PhaseDifference = 0;
+            PhaseDiffData.ConfidenceLevel = 0;
+
+            /* Set window to input data structure */
+            job_set_input_window ( &((*p_RegWindow).Window), &PhaseDiffData, &InputData );
+
+            /* Calculate threshold of confidence at window center */
+            job_calc_defocus_ok_ng_thr ( &InputData, &((*pfa_Context).KnotIndex), (*pfa_Context).p_ThrCache,
+                                         &((*p_RegWindow).DefocusOkNgThr) );
+        }
+    }
+
+    (*pfa_Context).RegThrCacheValid = 1;
+
+    return ;
+}
+
+/* Function for calculating slope and offset of registered windows when AdjCoeffSlope is changed by sensor mode */
+static void job_update_reg_coeff 
+( 
+    PdLibContext_t *pfa_Context                             /* In/Out : Validated context */
+)
+{
+    unsigned long i;
+    PdLibInputData_t InputData;
+
+    if ( (*pfa_Context).RegCoeffValid != 0 ) {
+        return ;                                            /* Same AdjCoeffSlope */
+    }
+
+    InputData = (*pfa_Context).InputData;
+
+    for ( i = 0; i < (*pfa_Context).RegWindowNum; i++ ) {
+        PdLibRegWindow_t *p_RegWindow;
+        PdLibPhaseDiffData_t PhaseDiffData;
+
+        p_RegWindow = &((*pfa_Context).p_RegWindow[i]);
+
+        PhaseDiffData.PhaseDifference = 0;
+        PhaseDiffData.ConfidenceLevel = 0;
+
+        /* Set window to input data structure */
+        job_set_input_window ( &((*p_RegWindow).Window), &PhaseDiffData, &InputData );
+
+        /* Calculate slope and offset at window center */
+        job_calc_defocus_coeff ( &InputData, &((*pfa_Context).KnotIndex), &((*p_RegWindow).Slope), &((*p_RegWindow).Offset),
+                                 &((*p_RegWindow).AreaIndex) );
+    }
+
+    (*pfa_Context).RegCoeffValid = 1;
+
+    return ;
+}
+
+/* Function for calculating threshold of confidence at each cell of defocus map from job_update_thr_cache() */
+/* Threshold on knots of DefocusOKNG is interpolated in x-direction once for each column of cells, */
+/* and in y-direction for each cell, in the same way as job_calc_defocus_ok_ng_thr(). */
+static void job_update_map_thr_cache 
+( 
+    PdLibContext_t *pfa_Context                             /* In/Out : Validated context with threshold cache */
+)
+{
+    unsigned long   i;
+    unsigned long   x;
+    unsigned long   y;
+    unsigned long   XCellNum;
+    unsigned short  XKnotNum;
+    unsigned short  YKnotNum;
+    PdLibRegMap_t   *p_RegMap;
+    PdLibMapAxis_t  *p_YAxisLine;
+
+    p_RegMap = &((*pfa_Context).RegMap);
+
+    if ( (*p_RegMap).ThrCacheValid != 0 ) {
+        return ;                                            /* Same analog gain */
+    }
+
+    XCellNum = (*p_RegMap).XCellNum;
+    XKnotNum = (*pfa_Context).InputData.XKnotNumDefocusOKNG;
+    YKnotNum = (*pfa_Context).InputData.YKnotNumDefocusOKNG;
+
+    p_YAxisLine = NULL;                                     /* Row of p_ThrLine0 and p_ThrLine1 */
+
+    for ( y = 0; y < (*p_RegMap).YCellNum; y++ ) {
+        PdLibMapAxis_t  *p_YAxis;
+        signed long     *p_Thr;
+
+        p_YAxis = &((*p_RegMap).p_YAxis[y]);
+        p_Thr   = &((*p_RegMap).p_DefocusOkNgThr[y * XCellNum]);
+
+        if ( XKnotNum == 0 || YKnotNum == 0 ) {             /* Confidence is not judged */
+            for ( x = 0; x < XCellNum; x++ ) {
+                p_Thr[x] = 0;
             }
+            continue ;
         }
-        /* Check disable of the judge function of confidence in each image area */
-        else if ( 1 == (*pfa_InputData).XKnotNumDefocusOKNG ||
-                  1 == (*pfa_InputData).YKnotNumDefocusOKNG ) {
-            if ( 1 == (*pfa_InputData).XKnotNumDefocusOKNG &&
-                 1 == (*pfa_InputData).YKnotNumDefocusOKNG ) {
-            } else {
-                ret = -EINVALDISIHC;                        /* Invalid of Disable compensation relation with image height */
+
+        if ( XKnotNum == 1 && YKnotNum == 1 ) {             /* Disable compensation relation with image height */
+            for ( x = 0; x < XCellNum; x++ ) {
+                p_Thr[x] = (*pfa_Context).p_ThrCache[0];
+            }
+        } else {
+            /* Interpolate in x-direction when row of knots is changed */
+            if ( p_YAxisLine == NULL || (*p_YAxisLine).OkNgSide != (*p_YAxis).OkNgSide ||
+                 (*p_YAxisLine).OkNgKnotStart != (*p_YAxis).OkNgKnotStart ) {
+                job_calc_map_thr_line ( pfa_Context, p_YAxis );
+                p_YAxisLine = p_YAxis;
+            }
+
+            if ( (*p_YAxis).OkNgSide == 1 ) {               /* Between rows of knots */
+                signed long LineX0[D_MAP_CHUNK_NUM];
+                signed long LineX1[D_MAP_CHUNK_NUM];
+                signed long PointX[D_MAP_CHUNK_NUM];
+                unsigned short *p_YAddressKnot;
+
+                p_YAddressKnot = (*pfa_Context).InputData.p_YAddressKnotDefocusOKNG;
+
+                for ( i = 0; i < D_MAP_CHUNK_NUM; i++ ) {
+                    LineX0[i] = p_YAddressKnot[(*p_YAxis).OkNgKnotStart  ];
+                    LineX1[i] = p_YAddressKnot[(*p_YAxis).OkNgKnotStart+1];
+                    PointX[i] = (*p_YAxis).Center;
+                }
+
+                /* Calculate coordination at the point of the line in y-direction */
+                for ( x = 0; x < XCellNum; x += D_MAP_CHUNK_NUM ) {
+                    CalcAddressOnLineArray_slXslY ( ( XCellNum - x < D_MAP_CHUNK_NUM ) ? XCellNum - x : D_MAP_CHUNK_NUM,
+                                                    LineX0, LineX1, &((*p_RegMap).p_ThrLine0[x]), &((*p_RegMap).p_ThrLine1[x]),
+                                                    PointX, &(p_Thr[x]) );
+                }
+
+                /* CalcAddressOnPlane_slXslYslZ() returns error and threshold is 0 in the center area out of the plane */
+                if ( LineX0[0] <= PointX[0] && PointX[0] <= LineX1[0] && LineX0[0] < LineX1[0] ) {
+                } else {
+                    for ( x = 0; x < XCellNum; x++ ) {
+                        if ( (*p_RegMap).p_XAxis[x].OkNgSide == 1 ) p_Thr[x] = 0;
+                    }
+                }
+            } else {                                        /* Top or bottom */
+                for ( x = 0; x < XCellNum; x++ ) {
+                    p_Thr[x] = (*p_RegMap).p_ThrLine0[x];
+                }
             }
         }
+
+        for ( x = 0; x < XCellNum; x++ ) {
+            if ( p_Thr[x] <= 0 ) p_Thr[x] = 0;              /* Check DefocusOkNgThr */
+        }
     }
-    /* Check DefocusOKNGThrPointNum */
-    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
-        if ( 2 <= (*((*pfa_InputData).p_DefocusOKNGThrLine)).PointNum ) {
-        } else {
-            ret = -EINDONTPN;                               /* Out of range of DefocusOKNGThrPointNum */
+
+    (*p_RegMap).ThrCacheValid = 1;
+
+    return ;
+}
+
+/* Function for calculating threshold of each column of defocus map on rows of knots of DefocusOKNG around a row of cells */
+static void job_calc_map_thr_line 
+( 
+    PdLibContext_t *pfa_Context,                            /* In/Out : Validated context with threshold cache */
+    PdLibMapAxis_t *pfa_YAxis                               /* Input  : Row of cells */
+)
+{
+    unsigned long   x;
+    unsigned short  XKnotNum;
+    unsigned short  YKnotNum;
+    unsigned short  *p_XAddressKnot;
+    unsigned short  Row0;
+    unsigned short  Row1;
+    signed long     *p_ThrCache;
+    PdLibRegMap_t   *p_RegMap;
+
+    p_RegMap       = &((*pfa_Context).RegMap);
+    p_ThrCache     = (*pfa_Context).p_ThrCache;
+    p_XAddressKnot = (*pfa_Context).InputData.p_XAddressKnotDefocusOKNG;
+    XKnotNum       = (*pfa_Context).InputData.XKnotNumDefocusOKNG;
+    YKnotNum       = (*pfa_Context).InputData.YKnotNumDefocusOKNG;
+
+    /* First knot of rows of knots used by the row of cells. Top and bottom use one row. */
+         if ( (*pfa_YAxis).OkNgSide == 0 ) { Row0 = 0; }
+    else if ( (*pfa_YAxis).OkNgSide == 2 ) { Row0 = (YKnotNum-1)*XKnotNum; }
+    else                                   { Row0 = (*pfa_YAxis).OkNgKnotStart*XKnotNum; }
+    Row1 = Row0 + XKnotNum;
+
+    for ( x = 0; x < (*p_RegMap).XCellNum; x++ ) {
+        PdLibMapAxis_t *p_XAxis;
+
+        p_XAxis = &((*p_RegMap).p_XAxis[x]);
+
+        if ( (*p_XAxis).OkNgSide == 1 ) {                   /* Between columns of knots */
+            signed long LineX[2];
+            signed long LineY[2];
+
+            LineX[0] = p_XAddressKnot[(*p_XAxis).OkNgKnotStart  ];
+            LineX[1] = p_XAddressKnot[(*p_XAxis).OkNgKnotStart+1];    /* Next to LineX[0] */
+
+            LineY[0] = p_ThrCache[Row0+(*p_XAxis).OkNgKnotStart  ];
+            LineY[1] = p_ThrCache[Row0+(*p_XAxis).OkNgKnotStart+1];
+            CalcAddressOnLine_slXslY ( LineX, LineY, (*p_XAxis).Center, &((*p_RegMap).p_ThrLine0[x]) );
+
+            if ( (*pfa_YAxis).OkNgSide == 1 ) {
+                LineY[0] = p_ThrCache[Row1+(*p_XAxis).OkNgKnotStart  ];
+                LineY[1] = p_ThrCache[Row1+(*p_XAxis).OkNgKnotStart+1];
+                CalcAddressOnLine_slXslY ( LineX, LineY, (*p_XAxis).Center, &((*p_RegMap).p_ThrLine1[x]) );
+
+                /* CalcAddressOnPlane_slXslYslZ() returns error and threshold is 0 out of the plane */
+                if ( LineX[0] <= (*p_XAxis).Center && (*p_XAxis).Center <= LineX[1] && LineX[0] < LineX[1] ) {
+                } else {
+                    (*p_RegMap).p_ThrLine0[x] = 0;
+                    (*p_RegMap).p_ThrLine1[x] = 0;
+                }
+            }
+        } else {                                            /* Left or right */
+            unsigned short Column;
+
+            Column = ( (*p_XAxis).OkNgSide == 0 ) ? 0 : XKnotNum-1;
+
+            (*p_RegMap).p_ThrLine0[x] = p_ThrCache[Row0+Column];
+
+            if ( (*pfa_YAxis).OkNgSide == 1 ) {
+                (*p_RegMap).p_ThrLine1[x] = p_ThrCache[Row1+Column];
+            }
         }
     }
-    /* Check DefocusOKNGXAddressKnot */
-    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
-        unsigned short i;
-        unsigned short XKnotNum;
-        unsigned short *p_XAddressKnot;
-        
-        XKnotNum = (*pfa_InputData).XKnotNumDefocusOKNG;
-        p_XAddressKnot = (*pfa_InputData).p_XAddressKnotDefocusOKNG;
-        for ( i = 0; i < ( XKnotNum - 1 ); i++ ) {
-            if ( p_XAddressKnot[i] < p_XAddressKnot[i + 1] ) {
-            } else {
-                ret = -EINDONXAK;                           /* Out of range of DefocusOKNGXAddressKnot */
-                break ;
+
+    return ;
+}
+
+/* Function for calculating slope and offset of cells of defocus map when AdjCoeffSlope is changed by sensor mode */
+static void job_update_map_coeff 
+( 
+    PdLibContext_t *pfa_Context                             /* In/Out : Validated context */
+)
+{
+    unsigned long   i;
+    unsigned long   x;
+    unsigned long   y;
+    PdLibRegMap_t   *p_RegMap;
+
+    p_RegMap = &((*pfa_Context).RegMap);
+
+    if ( (*p_RegMap).CoeffValid != 0 ) {
+        return ;                                            /* Same AdjCoeffSlope */
+    }
+
+    for ( y = 0, i = 0; y < (*p_RegMap).YCellNum; y++ ) {
+        PdLibMapAxis_t *p_YAxis;
+
+        p_YAxis = &((*p_RegMap).p_YAxis[y]);
+
+        for ( x = 0; x < (*p_RegMap).XCellNum; x++, i++ ) {
+            PdLibMapAxis_t *p_XAxis;
+
+            p_XAxis = &((*p_RegMap).p_XAxis[x]);
+
+            /* Calculate slope and offset at cell center with knots searched for its column and row */
+            job_calc_defocus_coeff_area ( &((*pfa_Context).InputData), &((*pfa_Context).KnotIndex), (*p_XAxis).KnotStart, (*p_YAxis).KnotStart,
+                                          (unsigned char)( (*p_YAxis).Side * 3 + (*p_XAxis).Side ),
+                                          (*p_XAxis).Weight, (*p_YAxis).Weight,
+                                          &((*p_RegMap).p_Slope[i]), &((*p_RegMap).p_Offset[i]) );
+        }
+    }
+
+    (*p_RegMap).CoeffValid = 1;
+
+    return ;
+}
+
+/* Function for calculating cell centers of defocus map in one direction and searching their knots */
+static void job_init_map_axis 
+( 
+    unsigned long fa_CellNum,                               /* Input  : Number of cells */
+    unsigned long fa_SampleNum,                             /* Input  : Number of samples of phase difference */
+    unsigned short fa_Size,                                 /* Input  : Size of image */
+    PdLibKnotAxis_t *pfa_KnotAxis,                          /* Input  : Knots of slope and offset */
+    PdLibKnotAxis_t *pfa_OkNgKnotAxis,                      /* Input  : Knots of DefocusOKNG */
+    PdLibMapAxis_t *pfa_MapAxis                             /* Output : Array of cells */
+)
+{
+    unsigned long   i;
+    unsigned short  *p_AddressKnot;
+
+    p_AddressKnot = (*pfa_KnotAxis).p_AddressKnot;
+
+    for ( i = 0; i < fa_CellNum; i++ ) {
+        unsigned long   Start;
+        unsigned long   End;
+        signed long     Center;
+        unsigned short  KnotStart;
+
+        /* Cell i is from i * Size / CellNum to (i+1) * Size / CellNum - 1 */
+        Start  = i * fa_Size / fa_CellNum;
+        End    = ( i + 1 ) * fa_Size / fa_CellNum - 1;
+        Center = (signed long)( ( Start + End ) / 2 );      /* Same as center of PDAF window */
+
+        KnotStart = job_search_knot_start ( Center, pfa_KnotAxis );
+
+        pfa_MapAxis[i].Center    = Center;
+        pfa_MapAxis[i].Sample    = (unsigned long)Center * fa_SampleNum / fa_Size;
+        pfa_MapAxis[i].KnotStart = KnotStart;
+        pfa_MapAxis[i].Side      = job_search_knot_side ( Center, pfa_KnotAxis );
+        pfa_MapAxis[i].Weight    = calc_line_weight ( p_AddressKnot[KnotStart], p_AddressKnot[KnotStart+1], Center );
+
+        pfa_MapAxis[i].OkNgKnotStart = 0;
+        pfa_MapAxis[i].OkNgSide      = 0;
+
+        if ( 2 <= (*pfa_OkNgKnotAxis).KnotNum ) {           /* Threshold is interpolated */
+            pfa_MapAxis[i].OkNgKnotStart = job_search_knot_start ( Center, pfa_OkNgKnotAxis );
+            pfa_MapAxis[i].OkNgSide      = job_search_knot_side ( Center, pfa_OkNgKnotAxis );
+        }
+    }
+
+    return ;
+}
+
+/* Function for searching side of knots of an address in the same way as area of job_search_knot() */
+/* 0 : before first knot, 1 : between knots, 2 : after last knot */
+static unsigned char job_search_knot_side 
+( 
+    signed long fa_Address,                                 /* Input  : Address */
+    PdLibKnotAxis_t *pfa_KnotAxis                           /* Input  : Knots */
+)
+{
+    unsigned char Side;
+
+         if ( fa_Address < (*pfa_KnotAxis).p_AddressKnot[0]                           ) { Side = 0; }
+    else if ( (*pfa_KnotAxis).p_AddressKnot[(*pfa_KnotAxis).KnotNum-1] < fa_Address ) { Side = 2; }
+    else                                                                              { Side = 1; }
+
+    return Side;
+}
+
+/* Function for checking sensor profile */
+static signed long job_check_profile 
+( 
+    const PdLibSensorProfile_t *pfa_Profile                 /* Input  : Sensor profile */
+)
+{
+    if ( pfa_Profile == NULL ) {                            /* Check sensor profile */
+        return -EINVALPROF;                                 /* Return error value */
+    }
+
+    if ( (*pfa_Profile).PdErrorValue < -D_PROFILE_PD_ERROR_MAX || D_PROFILE_PD_ERROR_MAX < (*pfa_Profile).PdErrorValue ) {
+        return -EINVALPROF;                                 /* Out of range of PdErrorValue */
+    }
+
+    return D_PD_LIB_E_OK;                                   /* Return OK */
+}
+
+/* Function for setting sensor profile and values derived from it */
+/* Values of sensor modes are checked without duplicates, so profiles of the same values */
+/* in several modes are checked with fewer comparisons. */
+static void job_set_profile 
+( 
+    const PdLibSensorProfile_t *pfa_Profile,                /* Input  : Checked sensor profile */
+    PdLibProfileState_t *pfa_ProfileState                   /* Output : Sensor profile with derived values */
+)
+{
+    unsigned long i;
+    unsigned long j;
+
+    (*pfa_ProfileState).Profile          = (*pfa_Profile);
+    (*pfa_ProfileState).PdErrorPhaseDiff = (*pfa_Profile).PdErrorValue * 16;
+    (*pfa_ProfileState).DensityNum       = 0;
+    (*pfa_ProfileState).AdjCoeffNum      = 0;
+
+    for ( i = 0; i < D_PD_LIB_SENS_MODE_NUM; i++ ) {
+        for ( j = 0; j < (*pfa_ProfileState).DensityNum; j++ ) {
+            if ( (*pfa_ProfileState).Density[j] == (*pfa_Profile).DensityOfPhasePix[i] ) {
+                break ;                                     /* Same value as other mode */
+            }
+        }
+        if ( j == (*pfa_ProfileState).DensityNum ) {
+            (*pfa_ProfileState).Density[(*pfa_ProfileState).DensityNum++] = (*pfa_Profile).DensityOfPhasePix[i];
+        }
+
+        for ( j = 0; j < (*pfa_ProfileState).AdjCoeffNum; j++ ) {
+            if ( (*pfa_ProfileState).AdjCoeff[j] == (*pfa_Profile).AdjCoeffSlope[i] ) {
+                break ;                                     /* Same value as other mode */
             }
         }
+        if ( j == (*pfa_ProfileState).AdjCoeffNum ) {
+            (*pfa_ProfileState).AdjCoeff[(*pfa_ProfileState).AdjCoeffNum++] = (*pfa_Profile).AdjCoeffSlope[i];
+        }
     }
-    /*  Check DefocusOKNGYAddressKnot */
-    if ( ret == D_PD_LIB_E_OK ) {                           /* Check return value */
-        unsigned short i;
-        unsigned short YKnotNum;
-        unsigned short *p_YAddressKnot;
-        
-        YKnotNum = (*pfa_InputData).YKnotNumDefocusOKNG;
-        p_YAddressKnot = (*pfa_InputData).p_YAddressKnotDefocusOKNG;
-        for ( i = 0; i < ( YKnotNum - 1 ); i++ ) {
-            if ( p_YAddressKnot[i] < p_YAddressKnot[i + 1] ) {
-            } else {
-                ret = -EINDONYAK;                           /* Out of range of DefocusOKNGYAddressKnot */
+
+    return ;
+}
+
+/* Function for copying sensor profile of APIs without context */
+/* Lock-free, copied again only when PdLibSetSensorProfile() writes it meanwhile. */
+static void job_get_lib_profile 
+( 
+    PdLibProfileState_t *pfa_ProfileState                   /* Output : Sensor profile with derived values */
+)
+{
+    PdLibProfileWord_t Copy;
+#if defined D_PROFILE_ATOMIC
+    unsigned long Sequence;
+    unsigned long i;
+
+    do {
+        Sequence = __atomic_load_n ( &s_ProfileSequence, __ATOMIC_ACQUIRE );
+
+        for ( i = 0; i < D_PROFILE_WORD_NUM; i++ ) {
+            Copy.Word[i] = __atomic_load_n ( &(s_ProfileState.Word[i]), __ATOMIC_RELAXED );
+        }
+        __atomic_thread_fence ( __ATOMIC_ACQUIRE );
+
+        /* Copy again while the profile is written or when it was written during the copy */
+    } while ( ( Sequence & 1 ) != 0 || __atomic_load_n ( &s_ProfileSequence, __ATOMIC_RELAXED ) != Sequence );
+#else
+    Copy = s_ProfileState;
+#endif
+
+    (*pfa_ProfileState) = Copy.State;
+
+    return ;
+}
+
+/* Function for replacing sensor profile of APIs without context. Calls of writers are serialized. */
+static void job_set_lib_profile 
+( 
+    const PdLibProfileState_t *pfa_ProfileState             /* Input  : Sensor profile with derived values */
+)
+{
+    PdLibProfileWord_t Copy;
+#if defined D_PROFILE_ATOMIC
+    unsigned long Sequence;
+    unsigned long i;
+#endif
+
+    Copy.State = (*pfa_ProfileState);
+
+#if defined D_PROFILE_ATOMIC
+    /* Odd sequence taken from even one excludes other writers, and is visible before the profile is changed */
+    do {
+        Sequence = __atomic_load_n ( &s_ProfileSequence, __ATOMIC_RELAXED ) & ~1UL;
+    } while ( !__atomic_compare_exchange_n ( &s_ProfileSequence, &Sequence, Sequence + 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED ) );
+    __atomic_thread_fence ( __ATOMIC_RELEASE );
+
+    for ( i = 0; i < D_PROFILE_WORD_NUM; i++ ) {
+        __atomic_store_n ( &(s_ProfileState.Word[i]), Copy.Word[i], __ATOMIC_RELAXED );
+    }
+
+    __atomic_store_n ( &s_ProfileSequence, Sequence + 2, __ATOMIC_RELEASE );
+#else
+    s_ProfileState = Copy;
+#endif
+
+    return ;
+}
+
+/* Function for setting calibration data to input data structure */
+static void job_set_input_calib 
+( 
+    PdLibCalibData_t *pfa_CalibData,                        /* Input  : Calibration data structure */
+    unsigned long fa_ImagerAnalogGain,                      /* Input  : Image sensor analog gain */
+    PdLibInputData_t *pfa_InputData                         /* Output : Input data structure */
+)
+{
+    (*pfa_InputData).PhaseDifference            = 0;
+    (*pfa_InputData).ConfidenceLevel            = 0;
+    (*pfa_InputData).XSizeOfImage               = (*pfa_CalibData).XSizeOfImage;
+    (*pfa_InputData).YSizeOfImage               = (*pfa_CalibData).YSizeOfImage;
+    (*pfa_InputData).XAddressOfWindowStart      = 0;
+    (*pfa_InputData).YAddressOfWindowStart      = 0;
+    (*pfa_InputData).XAddressOfWindowEnd        = 0;
+    (*pfa_InputData).YAddressOfWindowEnd        = 0;
+    (*pfa_InputData).XKnotNumSlopeOffset        = (*pfa_CalibData).XKnotNumSlopeOffset;
+    (*pfa_InputData).YKnotNumSlopeOffset        = (*pfa_CalibData).YKnotNumSlopeOffset;
+    (*pfa_InputData).p_SlopeData                = (*pfa_CalibData).p_SlopeData;
+    (*pfa_InputData).p_OffsetData               = (*pfa_CalibData).p_OffsetData;
+    (*pfa_InputData).p_XAddressKnotSlopeOffset  = (*pfa_CalibData).p_XAddressKnotSlopeOffset;
+    (*pfa_InputData).p_YAddressKnotSlopeOffset  = (*pfa_CalibData).p_YAddressKnotSlopeOffset;
+    (*pfa_InputData).AdjCoeffSlope              = (*pfa_CalibData).AdjCoeffSlope;
+    (*pfa_InputData).ImagerAnalogGain           = fa_ImagerAnalogGain;
+    (*pfa_InputData).XKnotNumDefocusOKNG        = (*pfa_CalibData).XKnotNumDefocusOKNG;
+    (*pfa_InputData).YKnotNumDefocusOKNG        = (*pfa_CalibData).YKnotNumDefocusOKNG;
+    (*pfa_InputData).p_DefocusOKNGThrLine       = (*pfa_CalibData).p_DefocusOKNGThrLine;
+    (*pfa_InputData).p_XAddressKnotDefocusOKNG  = (*pfa_CalibData).p_XAddressKnotDefocusOKNG;
+    (*pfa_InputData).p_YAddressKnotDefocusOKNG  = (*pfa_CalibData).p_YAddressKnotDefocusOKNG;
+    (*pfa_InputData).DensityOfPhasePix          = (*pfa_CalibData).DensityOfPhasePix;
+
+    return ;
+}
+
+/* Function for setting PDAF window and phase difference to input data structure */
+static void job_set_input_window 
+( 
+    PdLibWindow_t *pfa_Window,                              /* Input  : PDAF window */
+    PdLibPhaseDiffData_t *pfa_PhaseDiffData,                /* Input  : Phase difference data */
+    PdLibInputData_t *pfa_InputData                         /* Output : Input data structure */
+)
+{
+    (*pfa_InputData).PhaseDifference            = (*pfa_PhaseDiffData).PhaseDifference;
+    (*pfa_InputData).ConfidenceLevel            = (*pfa_PhaseDiffData).ConfidenceLevel;
+    (*pfa_InputData).XAddressOfWindowStart      = (*pfa_Window).XAddressOfWindowStart;
+    (*pfa_InputData).YAddressOfWindowStart      = (*pfa_Window).YAddressOfWindowStart;
+    (*pfa_InputData).XAddressOfWindowEnd        = (*pfa_Window).XAddressOfWindowEnd;
+    (*pfa_InputData).YAddressOfWindowEnd        = (*pfa_Window).YAddressOfWindowEnd;
+
+    return ;
+}
+
+/* Function for building index of knots from checked calibration data */
+static void job_init_knot_index 
+( 
+    PdLibInputData_t *pfa_InputData,                        /* Input  : Checked input data structure */
+    PdLibKnotIndex_t *pfa_KnotIndex                         /* Output : Index of knots */
+)
+{
+    job_init_knot_axis ( (*pfa_InputData).XKnotNumSlopeOffset, (*pfa_InputData).p_XAddressKnotSlopeOffset,
+                         &((*pfa_KnotIndex).XSlopeOffset) );
+    job_init_knot_axis ( (*pfa_InputData).YKnotNumSlopeOffset, (*pfa_InputData).p_YAddressKnotSlopeOffset,
+                         &((*pfa_KnotIndex).YSlopeOffset) );
+    job_init_knot_axis ( (*pfa_InputData).XKnotNumDefocusOKNG, (*pfa_InputData).p_XAddressKnotDefocusOKNG,
+                         &((*pfa_KnotIndex).XDefocusOKNG) );
+    job_init_knot_axis ( (*pfa_InputData).YKnotNumDefocusOKNG, (*pfa_InputData).p_YAddressKnotDefocusOKNG,
+                         &((*pfa_KnotIndex).YDefocusOKNG) );
+
+    (*pfa_KnotIndex).p_Packed = NULL;                       /* Set by PdLibValidateContext() for context */
+
+    return ;
+}
+
+/* Function for setting knots of one direction and checking whether their pitch is uniform */
+static void job_init_knot_axis 
+( 
+    unsigned short fa_KnotNum,                              /* Input  : Number of knots */
+    unsigned short *pfa_AddressKnot,                        /* Input  : Array of address of knots in ascending order */
+    PdLibKnotAxis_t *pfa_KnotAxis                           /* Output : Knots of one direction */
+)
+{
+    unsigned short  i;
+    unsigned long   Pitch;
+
+    Pitch = 0;
+
+    if ( 2 <= fa_KnotNum ) {
+        Pitch = (unsigned long)pfa_AddressKnot[1] - (unsigned long)pfa_AddressKnot[0];
+
+        for ( i = 1; i < fa_KnotNum-1; i++ ) {              /* Check pitch of all knots */
+            if ( (unsigned long)pfa_AddressKnot[i+1] - (unsigned long)pfa_AddressKnot[i] != Pitch ) {
+                Pitch = 0;                                  /* Not uniform */
                 break ;
             }
         }
     }
-    /* Check Phase Detection Pixel Density */
-    if ( ret == D_PD_LIB_E_OK ) {               /* Check return value */
-        if ( ( (*pfa_InputData).DensityOfPhasePix == D_PD_LIB_DENSITY_SENS_MODE0 ) ||
-             ( (*pfa_InputData).DensityOfPhasePix == D_PD_LIB_DENSITY_SENS_MODE1 ) ||
-             ( (*pfa_InputData).DensityOfPhasePix == D_PD_LIB_DENSITY_SENS_MODE2 ) ||
-             ( (*pfa_InputData).DensityOfPhasePix == D_PD_LIB_DENSITY_SENS_MODE3 ) ||
-             ( (*pfa_InputData).DensityOfPhasePix == D_PD_LIB_DENSITY_SENS_MODE4 ) ) {
-        } else {
-            ret = -EINDOP;                                  /* Out of range of DensityOfPhasePix */
-        }
-    }
 
-    return ret;                                             /* Return result */
+    (*pfa_KnotAxis).KnotNum       = fa_KnotNum;
+    (*pfa_KnotAxis).p_AddressKnot = pfa_AddressKnot;
+    (*pfa_KnotAxis).Pitch         = Pitch;
+
+    return ;
 }
 
-/* Function for calculating defocus */
-static void job_calc_defocus 
+/* Function for searching knot cell and area of PDAF window center */
+static void job_search_knot 
 ( 
-    PdLibInputData_t *pfa_InputData,                        /* Input  : Input data structure */
-    signed long *pfa_Defocus                                /* Output : Defocus */
+    signed long fa_XAddress,                                /* Input  : X address of PDAF window center */
+    signed long fa_YAddress,                                /* Input  : Y address of PDAF window center */
+    PdLibKnotAxis_t *pfa_XKnotAxis,                         /* Input  : Knots in x-direction */
+    PdLibKnotAxis_t *pfa_YKnotAxis,                         /* Input  : Knots in y-direction */
+    unsigned short *pfa_XKnotStart,                         /* Output : Index of knot at left of the cell */
+    unsigned short *pfa_YKnotStart,                         /* Output : Index of knot at top of the cell */
+    unsigned char *pfa_AreaIndex                            /* Output : Area index */
 )
 {
-    unsigned short  i;
     unsigned short  XKnotNum;
     unsigned short  YKnotNum;
     unsigned short  *p_XAddressKnot;
@@ -319,38 +3888,20 @@ static void job_calc_defocus
     unsigned short  XKnotStart;
     unsigned short  YKnotStart;
     unsigned char   AreaIndex;
-    signed long     Defocus;
     signed long     XAddressPDAFWindowCenter;
     signed long     YAddressPDAFWindowCenter;
 
-    XKnotNum = (*pfa_InputData).XKnotNumSlopeOffset;
-    YKnotNum = (*pfa_InputData).YKnotNumSlopeOffset;
+    XKnotNum = (*pfa_XKnotAxis).KnotNum;
+    YKnotNum = (*pfa_YKnotAxis).KnotNum;
 
-    p_XAddressKnot = (*pfa_InputData).p_XAddressKnotSlopeOffset;
-    p_YAddressKnot = (*pfa_InputData).p_YAddressKnotSlopeOffset;
+    p_XAddressKnot = (*pfa_XKnotAxis).p_AddressKnot;
+    p_YAddressKnot = (*pfa_YKnotAxis).p_AddressKnot;
 
-    XAddressPDAFWindowCenter = ( (*pfa_InputData).XAddressOfWindowStart + 
-                                 (*pfa_InputData).XAddressOfWindowEnd ) / 2;
-    YAddressPDAFWindowCenter = ( (*pfa_InputData).YAddressOfWindowStart + 
-                                 (*pfa_InputData).YAddressOfWindowEnd ) / 2;
-    
-    XKnotStart = 0;
-    for ( i = 0; i < XKnotNum-1; i++ ) {                    /* Check XKnotStart */
-        if ( p_XAddressKnot[i] <= XAddressPDAFWindowCenter && 
-             XAddressPDAFWindowCenter <= p_XAddressKnot[i+1] ) {
-            XKnotStart = i;
-            break ;
-        }
-    }
+    XAddressPDAFWindowCenter = fa_XAddress;
+    YAddressPDAFWindowCenter = fa_YAddress;
 
-    YKnotStart = 0;
-    for ( i = 0; i < YKnotNum-1; i++ ) {                    /* Check YKnotStar */
-        if ( p_YAddressKnot[i] <= YAddressPDAFWindowCenter && 
-             YAddressPDAFWindowCenter <= p_YAddressKnot[i+1] ) {
-            YKnotStart = i;
-            break ;
-        }
-    }
+    XKnotStart = job_search_knot_start ( XAddressPDAFWindowCenter, pfa_XKnotAxis );  /* Check XKnotStart */
+    YKnotStart = job_search_knot_start ( YAddressPDAFWindowCenter, pfa_YKnotAxis );  /* Check YKnotStart */
 
 /*
 
@@ -387,6 +3938,107 @@ static void job_calc_defocus
         else                                                              {/* Center */ AreaIndex = 4;}
     }
 
+    (*pfa_XKnotStart) = XKnotStart;
+    (*pfa_YKnotStart) = YKnotStart;
+    (*pfa_AreaIndex)  = AreaIndex;
+
+    return ;
+}
+
+/* Function for searching the first knot i which satisfies knot[i] <= Address <= knot[i+1] */
+/* Knots are in ascending order. When there is no such knot, 0 is returned. */
+static unsigned short job_search_knot_start 
+( 
+    signed long fa_Address,                                 /* Input  : Address of PDAF window center */
+    PdLibKnotAxis_t *pfa_KnotAxis                           /* Input  : Knots of one direction */
+)
+{
+    unsigned short  KnotNum;
+    unsigned short  *p_AddressKnot;
+    unsigned short  Lower;
+    unsigned short  Upper;
+
+    KnotNum       = (*pfa_KnotAxis).KnotNum;
+    p_AddressKnot = (*pfa_KnotAxis).p_AddressKnot;
+
+    /* knot[0] is the first knot when Address is equal to it */
+    if ( KnotNum < 2 || fa_Address <= (signed long)p_AddressKnot[0] || 
+         (signed long)p_AddressKnot[KnotNum-1] < fa_Address ) {
+        return 0;
+    }
+
+    /* knot[i] < Address <= knot[i+1] */
+    if ( (*pfa_KnotAxis).Pitch != 0 ) {                     /* Uniform pitch */
+        return (unsigned short)( ( (unsigned long)( fa_Address - (signed long)p_AddressKnot[0] ) - 1 ) / (*pfa_KnotAxis).Pitch );
+    }
+
+    Lower = 0;                                              /* knot[Lower] < Address */
+    Upper = KnotNum-1;                                      /* Address <= knot[Upper] */
+    while ( 1 < Upper - Lower ) {                           /* Binary search */
+        unsigned short Middle;
+
+        Middle = Lower + ( Upper - Lower ) / 2;
+
+        if ( (signed long)p_AddressKnot[Middle] < fa_Address ) {
+            Lower = Middle;
+        } else {
+            Upper = Middle;
+        }
+    }
+
+    return Lower;
+}
+
+/* Function for calculating defocus */
+static void job_calc_defocus 
+( 
+    PdLibInputData_t *pfa_InputData,                        /* Input  : Input data structure */
+    PdLibKnotIndex_t *pfa_KnotIndex,                        /* Input  : Index of knots */
+    PdLibPlaneBatch_t *pfa_PlaneBatch,                      /* In/Out : Deferred planes. NULL calculates at once */
+    signed long *pfa_Defocus,                               /* Output : Defocus */
+    unsigned char *pfa_AreaIndex                            /* Output : Area of window center, or NULL */
+)
+{
+    unsigned short  XKnotNum;
+    unsigned short  YKnotNum;
+    unsigned short  *p_XAddressKnot;
+    unsigned short  *p_YAddressKnot;
+    unsigned short  XKnotStart;
+    unsigned short  YKnotStart;
+    unsigned char   AreaIndex;
+    signed long     Defocus;
+    signed long     XAddressPDAFWindowCenter;
+    signed long     YAddressPDAFWindowCenter;
+
+#if D_PD_LIB_CONSTANT_TIME
+    job_calc_defocus_cell ( pfa_InputData, pfa_KnotIndex, pfa_PlaneBatch, pfa_Defocus, pfa_AreaIndex );
+
+    return ;
+#endif
+
+    XKnotNum = (*pfa_InputData).XKnotNumSlopeOffset;
+    YKnotNum = (*pfa_InputData).YKnotNumSlopeOffset;
+
+    p_XAddressKnot = (*pfa_InputData).p_XAddressKnotSlopeOffset;
+    p_YAddressKnot = (*pfa_InputData).p_YAddressKnotSlopeOffset;
+
+    XAddressPDAFWindowCenter = ( (*pfa_InputData).XAddressOfWindowStart + 
+                                 (*pfa_InputData).XAddressOfWindowEnd ) / 2;
+    YAddressPDAFWindowCenter = ( (*pfa_InputData).YAddressOfWindowStart + 
+                                 (*pfa_InputData).YAddressOfWindowEnd ) / 2;
+    
+    /* Search knot cell and area of PDAF window center */
+    job_search_knot ( XAddressPDAFWindowCenter, YAddressPDAFWindowCenter,
+                      &((*pfa_KnotIndex).XSlopeOffset), &((*pfa_KnotIndex).YSlopeOffset), &XKnotStart, &YKnotStart, &AreaIndex );
+
+#if D_PD_LIB_STATS
+    StatisticsAdd ( D_STATS_INDEX(AreaNum) + AreaIndex, 1 );
+#endif
+
+    if ( pfa_AreaIndex != NULL ) {
+        (*pfa_AreaIndex) = AreaIndex;
+    }
+
     if ( AreaIndex == 4 ) {                                 /* Center */
         unsigned short  Index;
         signed long     LineX[2];
@@ -404,14 +4056,39 @@ static void job_calc_defocus
         LineY[1]  = p_YAddressKnot[YKnotStart+1];           /* Next to LineY[0] */
 
         /* Calculate defocus value of each knot point */
-        PlaneZ[0] = calc_defocus_formula ( pfa_InputData, Index            );
-        PlaneZ[1] = calc_defocus_formula ( pfa_InputData, Index+1          );
-        PlaneZ[2] = calc_defocus_formula ( pfa_InputData, Index+XKnotNum   );
-        PlaneZ[3] = calc_defocus_formula ( pfa_InputData, Index+XKnotNum+1 );
+        PlaneZ[0] = calc_defocus_formula ( pfa_InputData, pfa_KnotIndex, Index            );
+        PlaneZ[1] = calc_defocus_formula ( pfa_InputData, pfa_KnotIndex, Index+1          );
+        PlaneZ[2] = calc_defocus_formula ( pfa_InputData, pfa_KnotIndex, Index+XKnotNum   );
+        PlaneZ[3] = calc_defocus_formula ( pfa_InputData, pfa_KnotIndex, Index+XKnotNum+1 );
 
         PointX    = XAddressPDAFWindowCenter;
         PointY    = YAddressPDAFWindowCenter;
 
+        /* Defer to job_flush_plane_batch() if the point is inside the plane. */
+        /* Otherwise CalcAddressOnPlane_slXslYslZ() returns error and defocus is 0. */
+        if ( pfa_PlaneBatch != NULL &&
+             LineX[0] <= PointX && PointX <= LineX[1] && LineY[0] <= PointY && PointY <= LineY[1] &&
+             LineX[0] < LineX[1] && LineY[0] < LineY[1] ) {
+            unsigned long Num;
+
+            Num = (*pfa_PlaneBatch).Num;
+
+            (*pfa_PlaneBatch).p_Defocus[Num] = pfa_Defocus;
+            (*pfa_PlaneBatch).X0[Num] = LineX[0];
+            (*pfa_PlaneBatch).X1[Num] = LineX[1];
+            (*pfa_PlaneBatch).Y0[Num] = LineY[0];
+            (*pfa_PlaneBatch).Y1[Num] = LineY[1];
+            (*pfa_PlaneBatch).Z0[Num] = PlaneZ[0];
+            (*pfa_PlaneBatch).Z1[Num] = PlaneZ[1];
+            (*pfa_PlaneBatch).Z2[Num] = PlaneZ[2];
+            (*pfa_PlaneBatch).Z3[Num] = PlaneZ[3];
+            (*pfa_PlaneBatch).XX[Num] = PointX;
+            (*pfa_PlaneBatch).YY[Num] = PointY;
+            (*pfa_PlaneBatch).Num = Num + 1;
+
+            return ;
+        }
+
         /* Calculate coordination at the point of the plane */
         CalcAddressOnPlane_slXslYslZ (LineX, LineY, PlaneZ, PointX, PointY, &PointZ);
 
@@ -425,7 +4102,7 @@ static void job_calc_defocus
         else                       { Index = 0; }
 
         /* Calculate defocus value which uses slope and offset of index point */
-        Defocus = calc_defocus_formula ( pfa_InputData, Index ); 
+        Defocus = calc_defocus_formula ( pfa_InputData, pfa_KnotIndex, Index ); 
 
     } else if ( AreaIndex == 1 ) {                          /* Top Center */
         unsigned short  Index;
@@ -440,107 +4117,576 @@ static void job_calc_defocus
         LineX[1] = p_XAddressKnot[XKnotStart+1];            /* Next to LineX[0] */
 
         /* Calculate defocus value of each knot point */
-        LineY[0] = calc_defocus_formula ( pfa_InputData, Index   );
-        LineY[1] = calc_defocus_formula ( pfa_InputData, Index+1 ); /* Next to LineY[0] */
+        LineY[0] = calc_defocus_formula ( pfa_InputData, pfa_KnotIndex, Index   );
+        LineY[1] = calc_defocus_formula ( pfa_InputData, pfa_KnotIndex, Index+1 ); /* Next to LineY[0] */
+
+        PointX   = XAddressPDAFWindowCenter;
+        /* Calculate coordination at the point of the line */
+        CalcAddressOnLine_slXslY ( LineX, LineY, PointX, &PointY );
+
+        Defocus = PointY;
+    } else if ( AreaIndex == 7 ) {                          /* Bottom Center */
+        unsigned short  Index;
+        signed long     LineX[2];
+        signed long     LineY[2];
+        signed long     PointX;
+        signed long     PointY;
+
+        Index = (YKnotNum-1)*XKnotNum + XKnotStart;
+
+        LineX[0] = p_XAddressKnot[XKnotStart  ];
+        LineX[1] = p_XAddressKnot[XKnotStart+1];            /* Next to LineX[0] */
+
+        /* Calculate defocus value of each knot point */
+        LineY[0] = calc_defocus_formula ( pfa_InputData, pfa_KnotIndex, Index   );
+        LineY[1] = calc_defocus_formula ( pfa_InputData, pfa_KnotIndex, Index+1 ); /* Next to LineY[0] */
 
         PointX   = XAddressPDAFWindowCenter;
+
+        /* Calculate coordination at the point of the line */
+        CalcAddressOnLine_slXslY ( LineX, LineY, PointX, &PointY );
+
+        Defocus = PointY;
+    } else if ( AreaIndex == 3 ) {                          /* Center Left */
+        unsigned short  Index;
+        signed long     LineX[2];
+        signed long     LineY[2];
+        signed long     PointX;
+        signed long     PointY;
+
+        Index = YKnotStart*XKnotNum;
+
+        LineX[0] = p_YAddressKnot[YKnotStart  ];
+        LineX[1] = p_YAddressKnot[YKnotStart+1];            /* Next to LineX[0] */
+
+        /* Calculate defocus value of each knot point */
+        LineY[0] = calc_defocus_formula ( pfa_InputData, pfa_KnotIndex, Index   );
+        LineY[1] = calc_defocus_formula ( pfa_InputData, pfa_KnotIndex, Index+XKnotNum );  /* Next to LineY[0] */
+
+        PointX   = YAddressPDAFWindowCenter;
+
+        /* Calculate coordination at the point of the line */
+        CalcAddressOnLine_slXslY ( LineX, LineY, PointX, &PointY );
+
+        Defocus = PointY;
+    } else {                                                /* Center Right(5) */
+        unsigned short  Index;
+        signed long     LineX[2];
+        signed long     LineY[2];
+        signed long     PointX;
+        signed long     PointY;
+
+        Index = (YKnotStart+1)*XKnotNum-1;
+
+        LineX[0] = p_YAddressKnot[YKnotStart  ];
+        LineX[1] = p_YAddressKnot[YKnotStart+1];            /* Next to LineX[0] */
+
+        /* Calculate defocus value of each knot point */
+        LineY[0] = calc_defocus_formula ( pfa_InputData, pfa_KnotIndex, Index   );
+        LineY[1] = calc_defocus_formula ( pfa_InputData, pfa_KnotIndex, Index+XKnotNum );  /* Next to LineY[0] */
+
+        PointX   = YAddressPDAFWindowCenter;
+
         /* Calculate coordination at the point of the line */
         CalcAddressOnLine_slXslY ( LineX, LineY, PointX, &PointY );
 
-        Defocus = PointY;
-    } else if ( AreaIndex == 7 ) {                          /* Bottom Center */
-        unsigned short  Index;
-        signed long     LineX[2];
-        signed long     LineY[2];
-        signed long     PointX;
-        signed long     PointY;
+        Defocus = PointY;
+    }
+
+    (*pfa_Defocus) = Defocus;
+
+    return ;
+}
+
+/* Function for calculating deferred planes at once and setting defocus to each destination */
+static void job_flush_plane_batch 
+( 
+    PdLibPlaneBatch_t *pfa_PlaneBatch                       /* In/Out : Deferred planes */
+)
+{
+    unsigned long i;
+
+#if D_PD_LIB_CONSTANT_TIME
+    CalcAddressOnCellArray_slXslYslZ  ( (*pfa_PlaneBatch).Num,
+                                        (*pfa_PlaneBatch).X0, (*pfa_PlaneBatch).X1,
+                                        (*pfa_PlaneBatch).Y0, (*pfa_PlaneBatch).Y1,
+                                        (*pfa_PlaneBatch).Z0, (*pfa_PlaneBatch).Z1,
+                                        (*pfa_PlaneBatch).Z2, (*pfa_PlaneBatch).Z3,
+                                        (*pfa_PlaneBatch).XX, (*pfa_PlaneBatch).YY,
+                                        (*pfa_PlaneBatch).ZZ );
+#else
+    CalcAddressOnPlaneArray_slXslYslZ ( (*pfa_PlaneBatch).Num,
+                                        (*pfa_PlaneBatch).X0, (*pfa_PlaneBatch).X1,
+                                        (*pfa_PlaneBatch).Y0, (*pfa_PlaneBatch).Y1,
+                                        (*pfa_PlaneBatch).Z0, (*pfa_PlaneBatch).Z1,
+                                        (*pfa_PlaneBatch).Z2, (*pfa_PlaneBatch).Z3,
+                                        (*pfa_PlaneBatch).XX, (*pfa_PlaneBatch).YY,
+                                        (*pfa_PlaneBatch).ZZ );
+#endif
+
+    for ( i = 0; i < (*pfa_PlaneBatch).Num; i++ ) {
+        (*((*pfa_PlaneBatch).p_Defocus[i])) = (*pfa_PlaneBatch).ZZ[i];
+    }
+
+    (*pfa_PlaneBatch).Num = 0;
+
+    return ;
+}
+
+#if D_PD_LIB_CONSTANT_TIME
+/* Function for calculating defocus in constant time */
+/* PDAF window center is limited into the knots and the cell including it is always interpolated. */
+/* Interpolation at a knot or on a side of the cell is exact, so defocus of area 0 - 3 and 5 - 8 */
+/* is the same as job_calc_defocus(), without branches on addresses or defocus of knot points. */
+static void job_calc_defocus_cell 
+( 
+    PdLibInputData_t *pfa_InputData,                        /* Input  : Input data structure */
+    PdLibKnotIndex_t *pfa_KnotIndex,                        /* Input  : Index of knots */
+    PdLibPlaneBatch_t *pfa_PlaneBatch,                      /* In/Out : Deferred cells. NULL calculates at once */
+    signed long *pfa_Defocus,                               /* Output : Defocus */
+    unsigned char *pfa_AreaIndex                            /* Output : Area of window center, or NULL */
+)
+{
+    unsigned short  XKnotNum;
+    unsigned short  *p_XAddressKnot;
+    unsigned short  *p_YAddressKnot;
+    unsigned short  XKnotStart;
+    unsigned short  YKnotStart;
+    unsigned short  Index;
+    signed long     CellX[2];
+    signed long     CellY[2];
+    signed long     CellZ[4];
+    signed long     PointX;
+    signed long     PointY;
+    signed long     XAddressPDAFWindowCenter;
+    signed long     YAddressPDAFWindowCenter;
+
+    XKnotNum = (*pfa_InputData).XKnotNumSlopeOffset;
+
+    p_XAddressKnot = (*pfa_InputData).p_XAddressKnotSlopeOffset;
+    p_YAddressKnot = (*pfa_InputData).p_YAddressKnotSlopeOffset;
+
+    XAddressPDAFWindowCenter = ( (*pfa_InputData).XAddressOfWindowStart + 
+                                 (*pfa_InputData).XAddressOfWindowEnd ) / 2;
+    YAddressPDAFWindowCenter = ( (*pfa_InputData).YAddressOfWindowStart + 
+                                 (*pfa_InputData).YAddressOfWindowEnd ) / 2;
+
+    /* Area is not used by interpolation, and is searched only for statistics or trace */
+    if ( D_PD_LIB_STATS || pfa_AreaIndex != NULL ) {
+        unsigned char AreaIndex;
+
+        AreaIndex = (unsigned char)( job_search_knot_side ( XAddressPDAFWindowCenter, &((*pfa_KnotIndex).XSlopeOffset) ) +
+                                     job_search_knot_side ( YAddressPDAFWindowCenter, &((*pfa_KnotIndex).YSlopeOffset) ) * 3 );
+#if D_PD_LIB_STATS
+        StatisticsAdd ( D_STATS_INDEX(AreaNum) + AreaIndex, 1 );
+#endif
+        if ( pfa_AreaIndex != NULL ) {
+            (*pfa_AreaIndex) = AreaIndex;
+        }
+    }
+
+    /* Search knot cell of PDAF window center limited into the knots */
+    XKnotStart = job_search_knot_cell ( XAddressPDAFWindowCenter, &((*pfa_KnotIndex).XSlopeOffset), &PointX );
+    YKnotStart = job_search_knot_cell ( YAddressPDAFWindowCenter, &((*pfa_KnotIndex).YSlopeOffset), &PointY );
+
+    Index = YKnotStart*XKnotNum+XKnotStart;
+
+    CellX[0] = p_XAddressKnot[XKnotStart  ];
+    CellX[1] = p_XAddressKnot[XKnotStart+1];                /* Next to CellX[0] */
+    CellY[0] = p_YAddressKnot[YKnotStart  ];
+    CellY[1] = p_YAddressKnot[YKnotStart+1];                /* Next to CellY[0] */
+
+    /* Calculate defocus value of each knot point */
+    CellZ[0] = calc_defocus_formula ( pfa_InputData, pfa_KnotIndex, Index            );
+    CellZ[1] = calc_defocus_formula ( pfa_InputData, pfa_KnotIndex, Index+1          );
+    CellZ[2] = calc_defocus_formula ( pfa_InputData, pfa_KnotIndex, Index+XKnotNum   );
+    CellZ[3] = calc_defocus_formula ( pfa_InputData, pfa_KnotIndex, Index+XKnotNum+1 );
+
+    if ( pfa_PlaneBatch != NULL ) {                         /* Defer to job_flush_plane_batch() */
+        unsigned long Num;
+
+        Num = (*pfa_PlaneBatch).Num;
+
+        (*pfa_PlaneBatch).p_Defocus[Num] = pfa_Defocus;
+        (*pfa_PlaneBatch).X0[Num] = CellX[0];
+        (*pfa_PlaneBatch).X1[Num] = CellX[1];
+        (*pfa_PlaneBatch).Y0[Num] = CellY[0];
+        (*pfa_PlaneBatch).Y1[Num] = CellY[1];
+        (*pfa_PlaneBatch).Z0[Num] = CellZ[0];
+        (*pfa_PlaneBatch).Z1[Num] = CellZ[1];
+        (*pfa_PlaneBatch).Z2[Num] = CellZ[2];
+        (*pfa_PlaneBatch).Z3[Num] = CellZ[3];
+        (*pfa_PlaneBatch).XX[Num] = PointX;
+        (*pfa_PlaneBatch).YY[Num] = PointY;
+        (*pfa_PlaneBatch).Num = Num + 1;
+
+        return ;
+    }
+
+    /* Calculate coordination at the point of the cell */
+    CalcAddressOnCell_slXslYslZ ( CellX, CellY, CellZ, PointX, PointY, pfa_Defocus );
+
+    return ;
+}
+
+/* Function for searching knot cell of an address limited into the knots with fixed number of steps */
+/* The last knot belongs to the last cell. An address on a knot between two cells may be in either cell */
+/* of job_search_knot_start(), and both cells give the same defocus there. */
+static unsigned short job_search_knot_cell 
+( 
+    signed long fa_Address,                                 /* Input  : Address of PDAF window center */
+    PdLibKnotAxis_t *pfa_KnotAxis,                          /* Input  : Knots of one direction */
+    signed long *pfa_Address                                /* Output : Address limited into the knots */
+)
+{
+    unsigned short  KnotNum;
+    unsigned short  *p_AddressKnot;
+    unsigned short  Start;
+    signed long     First;
+    signed long     Last;
+    signed long     Address;
+
+    KnotNum       = (*pfa_KnotAxis).KnotNum;
+    p_AddressKnot = (*pfa_KnotAxis).p_AddressKnot;
+
+    First = (signed long)p_AddressKnot[0];
+    Last  = (signed long)p_AddressKnot[KnotNum-1];
+
+    Address = ( fa_Address < First ) ? First : fa_Address;  /* Limit into the knots */
+    Address = ( Last < Address     ) ? Last  : Address;
+
+    if ( (*pfa_KnotAxis).Pitch != 0 ) {                     /* Uniform pitch */
+        Start = (unsigned short)( (unsigned long)( Address - First ) / (*pfa_KnotAxis).Pitch );
+    } else {
+        unsigned short Num;
+
+        Start = 0;                                          /* knot[Start] < Address, or 0 */
+        Num   = KnotNum-1;                                  /* Number of cells from Start */
+        while ( 1 < Num ) {                                 /* Steps depend on number of knots only */
+            unsigned short Half;
+
+            Half  = Num / 2;
+            Start = ( (signed long)p_AddressKnot[Start+Half] < Address ) ? Start+Half : Start;
+            Num   = Num - Half;
+        }
+    }
+
+    Start = ( KnotNum-2 < Start ) ? KnotNum-2 : Start;      /* Last knot of uniform pitch */
+
+    (*pfa_Address) = Address;
+
+    return Start;
+}
+
+/* Function for calculating threshold of confidence in constant time */
+/* PDAF window center is limited into the knots of DefocusOKNG and the cell including it is always */
+/* interpolated in the same way as job_calc_defocus_cell(), so threshold of area 0 - 3 and 5 - 8 */
+/* is the same as job_calc_defocus_ok_ng_thr(). Threshold of the four knots is read from the cache */
+/* of the analog gain if it is given. */
+static void job_calc_defocus_ok_ng_thr_cell 
+( 
+    PdLibInputData_t *pfa_InputData,                        /* Input  : Input data structure */
+    PdLibKnotIndex_t *pfa_KnotIndex,                        /* Input  : Index of knots */
+    signed long *pfa_ThrCache,                              /* Input  : Threshold at each knot. NULL calculates it */
+    signed long *pfa_DefocusOkNgThr                         /* Output : Threshold of confidence */
+)
+{
+    unsigned short  XKnotNum;
+    unsigned short  *p_XAddressKnot;
+    unsigned short  *p_YAddressKnot;
+    unsigned short  XKnotStart;
+    unsigned short  YKnotStart;
+    unsigned short  Index;
+    signed long     DefocusOkNgThr;
+    signed long     CellX[2];
+    signed long     CellY[2];
+    signed long     CellZ[4];
+    signed long     PointX;
+    signed long     PointY;
+    signed long     XAddressPDAFWindowCenter;
+    signed long     YAddressPDAFWindowCenter;
+
+    XKnotNum = (*pfa_InputData).XKnotNumDefocusOKNG;
+
+    if ( XKnotNum == 1 ) {                                  /* 1 x 1 knot, which depends on calibration data only */
+        DefocusOkNgThr = calc_defocus_ok_ng_thr ( pfa_InputData, pfa_ThrCache, 0 );
+
+        (*pfa_DefocusOkNgThr) = ( DefocusOkNgThr <= 0 ) ? 0 : DefocusOkNgThr;
+
+        return ;
+    }
+
+    p_XAddressKnot = (*pfa_InputData).p_XAddressKnotDefocusOKNG;
+    p_YAddressKnot = (*pfa_InputData).p_YAddressKnotDefocusOKNG;
+
+    XAddressPDAFWindowCenter = ( (*pfa_InputData).XAddressOfWindowStart + 
+                                 (*pfa_InputData).XAddressOfWindowEnd ) / 2;
+    YAddressPDAFWindowCenter = ( (*pfa_InputData).YAddressOfWindowStart + 
+                                 (*pfa_InputData).YAddressOfWindowEnd ) / 2;
+
+    /* Search knot cell of PDAF window center limited into the knots */
+    XKnotStart = job_search_knot_cell ( XAddressPDAFWindowCenter, &((*pfa_KnotIndex).XDefocusOKNG), &PointX );
+    YKnotStart = job_search_knot_cell ( YAddressPDAFWindowCenter, &((*pfa_KnotIndex).YDefocusOKNG), &PointY );
+
+    Index = YKnotStart*XKnotNum+XKnotStart;
+
+    CellX[0] = p_XAddressKnot[XKnotStart  ];
+    CellX[1] = p_XAddressKnot[XKnotStart+1];                /* Next to CellX[0] */
+    CellY[0] = p_YAddressKnot[YKnotStart  ];
+    CellY[1] = p_YAddressKnot[YKnotStart+1];                /* Next to CellY[0] */
+
+    /* Threshold of confidence of each knot point */
+    CellZ[0] = calc_defocus_ok_ng_thr ( pfa_InputData, pfa_ThrCache, Index            );
+    CellZ[1] = calc_defocus_ok_ng_thr ( pfa_InputData, pfa_ThrCache, Index+1          );
+    CellZ[2] = calc_defocus_ok_ng_thr ( pfa_InputData, pfa_ThrCache, Index+XKnotNum   );
+    CellZ[3] = calc_defocus_ok_ng_thr ( pfa_InputData, pfa_ThrCache, Index+XKnotNum+1 );
 
-        Index = (YKnotNum-1)*XKnotNum + XKnotStart;
+    /* Calculate coordination at the point of the cell */
+    CalcAddressOnCell_slXslYslZ ( CellX, CellY, CellZ, PointX, PointY, &DefocusOkNgThr );
 
-        LineX[0] = p_XAddressKnot[XKnotStart  ];
-        LineX[1] = p_XAddressKnot[XKnotStart+1];            /* Next to LineX[0] */
+    (*pfa_DefocusOkNgThr) = ( DefocusOkNgThr <= 0 ) ? 0 : DefocusOkNgThr;
 
-        /* Calculate defocus value of each knot point */
-        LineY[0] = calc_defocus_formula ( pfa_InputData, Index   );
-        LineY[1] = calc_defocus_formula ( pfa_InputData, Index+1 ); /* Next to LineY[0] */
+    return ;
+}
+#endif
 
-        PointX   = XAddressPDAFWindowCenter;
+/* Function for calculating slope and offset of defocus at PDAF window center */
+/* Defocus at window center is Slope * PhaseDifference + Offset, which interpolates */
+/* defocus of knot points in the same way as job_calc_defocus() without truncation. */
+static void job_calc_defocus_coeff 
+( 
+    PdLibInputData_t *pfa_InputData,                        /* Input  : Input data structure */
+    PdLibKnotIndex_t *pfa_KnotIndex,                        /* Input  : Index of knots */
+    PdLibCoeff_t *pfa_Slope,                                /* Output : Slope including AdjCoeffSlope / 2304 */
+    PdLibCoeff_t *pfa_Offset,                               /* Output : Offset */
+    unsigned char *pfa_AreaIndex                            /* Output : Area index */
+)
+{
+    unsigned short  *p_XAddressKnot;
+    unsigned short  *p_YAddressKnot;
+    unsigned short  XKnotStart;
+    unsigned short  YKnotStart;
+    unsigned char   AreaIndex;
+    PdLibWeight_t   XWeight;
+    PdLibWeight_t   YWeight;
+    signed long     XAddressPDAFWindowCenter;
+    signed long     YAddressPDAFWindowCenter;
 
-        /* Calculate coordination at the point of the line */
-        CalcAddressOnLine_slXslY ( LineX, LineY, PointX, &PointY );
+    p_XAddressKnot = (*pfa_InputData).p_XAddressKnotSlopeOffset;
+    p_YAddressKnot = (*pfa_InputData).p_YAddressKnotSlopeOffset;
 
-        Defocus = PointY;
-    } else if ( AreaIndex == 3 ) {                          /* Center Left */
-        unsigned short  Index;
-        signed long     LineX[2];
-        signed long     LineY[2];
-        signed long     PointX;
-        signed long     PointY;
+    XAddressPDAFWindowCenter = ( (*pfa_InputData).XAddressOfWindowStart + 
+                                 (*pfa_InputData).XAddressOfWindowEnd ) / 2;
+    YAddressPDAFWindowCenter = ( (*pfa_InputData).YAddressOfWindowStart + 
+                                 (*pfa_InputData).YAddressOfWindowEnd ) / 2;
 
-        Index = YKnotStart*XKnotNum;
+    /* Search knot cell and area of PDAF window center */
+    job_search_knot ( XAddressPDAFWindowCenter, YAddressPDAFWindowCenter,
+                      &((*pfa_KnotIndex).XSlopeOffset), &((*pfa_KnotIndex).YSlopeOffset), &XKnotStart, &YKnotStart, &AreaIndex );
 
-        LineX[0] = p_YAddressKnot[YKnotStart  ];
-        LineX[1] = p_YAddressKnot[YKnotStart+1];            /* Next to LineX[0] */
+    /* Weight of knot point next to XKnotStart and YKnotStart */
+    XWeight = calc_line_weight ( p_XAddressKnot[XKnotStart], p_XAddressKnot[XKnotStart+1], XAddressPDAFWindowCenter );
+    YWeight = calc_line_weight ( p_YAddressKnot[YKnotStart], p_YAddressKnot[YKnotStart+1], YAddressPDAFWindowCenter );
 
-        /* Calculate defocus value of each knot point */
-        LineY[0] = calc_defocus_formula ( pfa_InputData, Index   );
-        LineY[1] = calc_defocus_formula ( pfa_InputData, Index+XKnotNum );  /* Next to LineY[0] */
+    /* Calculate slope and offset with knot points of the area */
+    job_calc_defocus_coeff_area ( pfa_InputData, pfa_KnotIndex, XKnotStart, YKnotStart, AreaIndex, XWeight, YWeight, pfa_Slope, pfa_Offset );
 
-        PointX   = YAddressPDAFWindowCenter;
+    (*pfa_AreaIndex) = AreaIndex;
 
-        /* Calculate coordination at the point of the line */
-        CalcAddressOnLine_slXslY ( LineX, LineY, PointX, &PointY );
+    return ;
+}
 
-        Defocus = PointY;
-    } else {                                                /* Center Right(5) */
-        unsigned short  Index;
-        signed long     LineX[2];
-        signed long     LineY[2];
-        signed long     PointX;
-        signed long     PointY;
+/* Function for calculating slope and offset of defocus with knots searched before */
+/* Fixed-point interpolates AdjCoeffSlope * Slope / 2304 and offset of each knot with D_MATH_FUNC_COEFF_FRAC_BITS of fraction. */
+static void job_calc_defocus_coeff_area 
+( 
+    PdLibInputData_t *pfa_InputData,                        /* Input  : Input data structure */
+    PdLibKnotIndex_t *pfa_KnotIndex,                        /* Input  : Index of knots with packed calibration data */
+    unsigned short fa_XKnotStart,                           /* Input  : Index of knot at left of the cell */
+    unsigned short fa_YKnotStart,                           /* Input  : Index of knot at top of the cell */
+    unsigned char fa_AreaIndex,                             /* Input  : Area index */
+    PdLibWeight_t fa_XWeight,                               /* Input  : Weight of knot point next to fa_XKnotStart */
+    PdLibWeight_t fa_YWeight,                               /* Input  : Weight of knot point next to fa_YKnotStart */
+    PdLibCoeff_t *pfa_Slope,                                /* Output : Slope including AdjCoeffSlope / 2304 */
+    PdLibCoeff_t *pfa_Offset                                /* Output : Offset */
+)
+{
+    unsigned short  i;
+    unsigned short  XKnotNum;
+    unsigned short  YKnotNum;
+    unsigned short  XKnotStart;
+    unsigned short  YKnotStart;
+    unsigned char   AreaIndex;
+    unsigned short  Index[4];
+    PdLibWeight_t   XWeight;
+    PdLibWeight_t   YWeight;
+#if D_MATH_FUNC_FIXED_POINT
+    unsigned long   XNum[4];                                /* Weight in x-direction is XNum / XDen */
+    unsigned long   YNum[4];                                /* Weight in y-direction is YNum / YDen */
+    unsigned long   XDen;
+    unsigned long   YDen;
+    signed long long Scale;
+    signed long long Slope;
+    signed long long Offset;
+#else
+    double          Weight[4];
+    double          Slope;
+    double          Offset;
+#endif
+
+    XKnotNum   = (*pfa_InputData).XKnotNumSlopeOffset;
+    YKnotNum   = (*pfa_InputData).YKnotNumSlopeOffset;
+    XKnotStart = fa_XKnotStart;
+    YKnotStart = fa_YKnotStart;
+    AreaIndex  = fa_AreaIndex;
+    XWeight    = fa_XWeight;
+    YWeight    = fa_YWeight;
+
+    /* Knot points and their weights used in each area. Unused weights are zero. */
+    Index[0]  = 0;
+    Index[1]  = 0;
+    Index[2]  = 0;
+    Index[3]  = 0;
+#if D_MATH_FUNC_FIXED_POINT
+    XNum[0]   = 1;
+    XNum[1]   = 0;
+    XNum[2]   = 0;
+    XNum[3]   = 0;
+    YNum[0]   = 1;
+    YNum[1]   = 0;
+    YNum[2]   = 0;
+    YNum[3]   = 0;
+    XDen      = 1;
+    YDen      = 1;
+#else
+    Weight[0] = 1.0;
+    Weight[1] = 0.0;
+    Weight[2] = 0.0;
+    Weight[3] = 0.0;
+#endif
 
-        Index = (YKnotStart+1)*XKnotNum-1;
+    if ( AreaIndex == 4 ) {                                 /* Center */
+        Index[0]  = YKnotStart*XKnotNum+XKnotStart;
+        Index[1]  = Index[0]+1;
+        Index[2]  = Index[0]+XKnotNum;
+        Index[3]  = Index[0]+XKnotNum+1;
+#if D_MATH_FUNC_FIXED_POINT
+        XNum[0]   = XWeight.Den - XWeight.Num;
+        XNum[1]   = XWeight.Num;
+        XNum[2]   = XNum[0];
+        XNum[3]   = XNum[1];
+        YNum[0]   = YWeight.Den - YWeight.Num;
+        YNum[1]   = YNum[0];
+        YNum[2]   = YWeight.Num;
+        YNum[3]   = YNum[2];
+        XDen      = XWeight.Den;
+        YDen      = YWeight.Den;
+#else
+        Weight[0] = ( 1.0 - XWeight ) * ( 1.0 - YWeight );
+        Weight[1] = XWeight * ( 1.0 - YWeight );
+        Weight[2] = ( 1.0 - XWeight ) * YWeight;
+        Weight[3] = XWeight * YWeight;
+#endif
+    } else if ( AreaIndex == 0 || AreaIndex == 2 || AreaIndex == 6 || AreaIndex == 8 ) {    /* Cornar of area */
+             if ( AreaIndex == 2 ) { Index[0] = XKnotNum-1; }
+        else if ( AreaIndex == 6 ) { Index[0] = (YKnotNum-1)*XKnotNum; }
+        else if ( AreaIndex == 8 ) { Index[0] = YKnotNum*XKnotNum-1; }
+        else                       { Index[0] = 0; }
+    } else if ( AreaIndex == 1 || AreaIndex == 7 ) {        /* Top Center, Bottom Center */
+        Index[0]  = ( AreaIndex == 1 ) ? XKnotStart : (YKnotNum-1)*XKnotNum + XKnotStart;
+        Index[1]  = Index[0]+1;
+#if D_MATH_FUNC_FIXED_POINT
+        XNum[0]   = XWeight.Den - XWeight.Num;
+        XNum[1]   = XWeight.Num;
+        YNum[1]   = 1;
+        XDen      = XWeight.Den;
+#else
+        Weight[0] = 1.0 - XWeight;
+        Weight[1] = XWeight;
+#endif
+    } else {                                                /* Center Left(3), Center Right(5) */
+        Index[0]  = ( AreaIndex == 3 ) ? YKnotStart*XKnotNum : (YKnotStart+1)*XKnotNum-1;
+        Index[1]  = Index[0]+XKnotNum;
+#if D_MATH_FUNC_FIXED_POINT
+        XNum[1]   = 1;
+        YNum[0]   = YWeight.Den - YWeight.Num;
+        YNum[1]   = YWeight.Num;
+        YDen      = YWeight.Den;
+#else
+        Weight[0] = 1.0 - YWeight;
+        Weight[1] = YWeight;
+#endif
+    }
 
-        LineX[0] = p_YAddressKnot[YKnotStart  ];
-        LineX[1] = p_YAddressKnot[YKnotStart+1];            /* Next to LineX[0] */
+#if D_MATH_FUNC_FIXED_POINT
+    /* 2^D_MATH_FUNC_COEFF_FRAC_BITS / 2304 is Scale / 9 */
+    Scale  = (signed long long)1 << ( D_MATH_FUNC_COEFF_FRAC_BITS - 8 );
+    Slope  = 0;
+    Offset = 0;
+    for ( i = 0; i < 4; i++ ) {
+        signed long KnotSlope;
+        signed long KnotOffset;
+        signed long long K;
 
-        /* Calculate defocus value of each knot point */
-        LineY[0] = calc_defocus_formula ( pfa_InputData, Index   );
-        LineY[1] = calc_defocus_formula ( pfa_InputData, Index+XKnotNum );  /* Next to LineY[0] */
+        calc_slope_offset ( pfa_InputData, pfa_KnotIndex, Index[i], &KnotSlope, &KnotOffset );
 
-        PointX   = YAddressPDAFWindowCenter;
+        /* AdjCoeffSlope * Slope * Scale / 9 split by quotient and remainder to keep 64 bits */
+        K = (signed long long)((*pfa_InputData).AdjCoeffSlope) * (signed long long)KnotSlope;
+        K = ( K / 9 ) * Scale + ( K % 9 ) * Scale / 9;
 
-        /* Calculate coordination at the point of the line */
-        CalcAddressOnLine_slXslY ( LineX, LineY, PointX, &PointY );
+        Slope  += calc_weighted_fixed ( calc_weighted_fixed ( K, XNum[i], XDen ), YNum[i], YDen );
+        Offset += calc_weighted_fixed ( calc_weighted_fixed ( (signed long long)KnotOffset * Scale * 256, XNum[i], XDen ), YNum[i], YDen );
+    }
 
-        Defocus = PointY;
+    (*pfa_Slope)  = Slope;
+    (*pfa_Offset) = Offset;
+#else
+    Slope  = 0.0;
+    Offset = 0.0;
+    for ( i = 0; i < 4; i++ ) {
+        signed long KnotSlope;
+        signed long KnotOffset;
+
+        calc_slope_offset ( pfa_InputData, pfa_KnotIndex, Index[i], &KnotSlope, &KnotOffset );
+
+        Slope  += Weight[i] * (double)KnotSlope;
+        Offset += Weight[i] * (double)KnotOffset;
     }
 
-    (*pfa_Defocus) = Defocus;
+    (*pfa_Slope)  = (double)((*pfa_InputData).AdjCoeffSlope) * Slope / 2304.0;
+    (*pfa_Offset) = Offset;
+#endif
 
     return ;
 }
 
-/* Function for calculating defocus confidence level */
-static void job_calc_defocus_confidence_level 
+/* Function for calculating threshold of confidence at PDAF window center */
+static void job_calc_defocus_ok_ng_thr 
 ( 
     PdLibInputData_t *pfa_InputData,                        /* Input  : Input data structure */
-    unsigned long *pfa_DefocusConfidenceLevel               /* Output : Defocus confidence level */
+    PdLibKnotIndex_t *pfa_KnotIndex,                        /* Input  : Index of knots */
+    signed long *pfa_ThrCache,                              /* Input  : Threshold at each knot. NULL calculates it */
+    signed long *pfa_DefocusOkNgThr                         /* Output : Threshold of confidence */
 )
 {
     signed long     DefocusOkNgThr;
     unsigned short  XKnotNum;
     unsigned short  YKnotNum;
 
+#if D_PD_LIB_CONSTANT_TIME
+    job_calc_defocus_ok_ng_thr_cell ( pfa_InputData, pfa_KnotIndex, pfa_ThrCache, pfa_DefocusOkNgThr );
+
+    return ;
+#endif
+
     XKnotNum = (*pfa_InputData).XKnotNumDefocusOKNG;
     YKnotNum = (*pfa_InputData).YKnotNumDefocusOKNG;
     
     /* Disable of the judge function of confidence in each image area */
     if ( ( XKnotNum == 1 ) && ( YKnotNum == 1 ) ) {
         /* Disable compensation relation with image height. */
-        DefocusOkNgThr = calc_defocus_ok_ng_thr ( pfa_InputData, 0);
+        DefocusOkNgThr = calc_defocus_ok_ng_thr ( pfa_InputData, pfa_ThrCache, 0);
     } else {
-        unsigned short i;    
         unsigned short  *p_XAddressKnot;
         unsigned short  *p_YAddressKnot;
         unsigned short  XKnotStart;
@@ -557,57 +4703,9 @@ static void job_calc_defocus_confidence_level
         YAddressPDAFWindowCenter = ( (*pfa_InputData).YAddressOfWindowStart + 
                                      (*pfa_InputData).YAddressOfWindowEnd ) / 2;
         
-        XKnotStart = 0;
-        for ( i = 0; i < XKnotNum-1; i++ ) {                /* Check XKnotStart */
-            if ( p_XAddressKnot[i] <= XAddressPDAFWindowCenter && 
-                 XAddressPDAFWindowCenter <= p_XAddressKnot[i+1] ) {
-                XKnotStart = i;
-                break ;
-            }
-        }
-
-        YKnotStart = 0;
-        for ( i = 0; i < YKnotNum-1; i++ ) {                /* Check YKnotStar */
-            if ( p_YAddressKnot[i] <= YAddressPDAFWindowCenter && 
-                 YAddressPDAFWindowCenter <= p_YAddressKnot[i+1] ) {
-                YKnotStart = i;
-                break ;
-            }
-        }
-
-    /*
-
-        Divided by area. AreaIndex
-
-        +---+---+---+
-        | 0 | 1 | 2 |
-        +---+---+---+
-        | 3 | 4 | 5 |
-        +---+---+---+
-        | 6 | 7 | 8 |
-        +---+---+---+
-
-        Area 4 is surrounded by the knot points.
-        Other area does not have knot points.
-
-    */
-
-        if ( YAddressPDAFWindowCenter < p_YAddressKnot[0] ) {
-            /* Top */
-                 if ( XAddressPDAFWindowCenter   < p_XAddressKnot[0]        ) {/* Left */   AreaIndex = 0;}
-            else if ( p_XAddressKnot[XKnotNum-1] < XAddressPDAFWindowCenter ) {/* Right */  AreaIndex = 2;}
-            else                                                              {/* Center */ AreaIndex = 1;}       
-        } else if ( p_YAddressKnot[YKnotNum-1] < YAddressPDAFWindowCenter ) {
-            /* Bottom */
-                 if ( XAddressPDAFWindowCenter   < p_XAddressKnot[0]        ) {/* Left */   AreaIndex = 6;}
-            else if ( p_XAddressKnot[XKnotNum-1] < XAddressPDAFWindowCenter ) {/* Right */  AreaIndex = 8;}
-            else                                                              {/* Center */ AreaIndex = 7;}       
-        } else {
-            /* Center */
-                 if ( XAddressPDAFWindowCenter   < p_XAddressKnot[0]        ) {/* Left */   AreaIndex = 3;}
-            else if ( p_XAddressKnot[XKnotNum-1] < XAddressPDAFWindowCenter ) {/* Right */  AreaIndex = 5;}
-            else                                                              {/* Center */ AreaIndex = 4;}
-        }
+        /* Search knot cell and area of PDAF window center */
+        job_search_knot ( XAddressPDAFWindowCenter, YAddressPDAFWindowCenter,
+                          &((*pfa_KnotIndex).XDefocusOKNG), &((*pfa_KnotIndex).YDefocusOKNG), &XKnotStart, &YKnotStart, &AreaIndex );
 
         if ( AreaIndex == 4 ) {                                             /* Center */
             unsigned short  Index;
@@ -626,10 +4724,10 @@ static void job_calc_defocus_confidence_level
             LineY[1]  = p_YAddressKnot[YKnotStart+1];       /* Next to LineY[0] */
             
             /* Calculate threshold of confidence of each knot point */
-            PlaneZ[0] = calc_defocus_ok_ng_thr ( pfa_InputData, Index            );
-            PlaneZ[1] = calc_defocus_ok_ng_thr ( pfa_InputData, Index+1          );
-            PlaneZ[2] = calc_defocus_ok_ng_thr ( pfa_InputData, Index+XKnotNum   );
-            PlaneZ[3] = calc_defocus_ok_ng_thr ( pfa_InputData, Index+XKnotNum+1 );
+            PlaneZ[0] = calc_defocus_ok_ng_thr ( pfa_InputData, pfa_ThrCache, Index            );
+            PlaneZ[1] = calc_defocus_ok_ng_thr ( pfa_InputData, pfa_ThrCache, Index+1          );
+            PlaneZ[2] = calc_defocus_ok_ng_thr ( pfa_InputData, pfa_ThrCache, Index+XKnotNum   );
+            PlaneZ[3] = calc_defocus_ok_ng_thr ( pfa_InputData, pfa_ThrCache, Index+XKnotNum+1 );
 
             PointX    = XAddressPDAFWindowCenter;
             PointY    = YAddressPDAFWindowCenter;
@@ -645,7 +4743,7 @@ static void job_calc_defocus_confidence_level
             else if ( AreaIndex == 6 ) { Index = (YKnotNum-1)*XKnotNum; }
             else if ( AreaIndex == 8 ) { Index = YKnotNum*XKnotNum-1; }
             else                       { Index = 0; }
-            DefocusOkNgThr = calc_defocus_ok_ng_thr ( pfa_InputData, Index );   /* Calculate threshold of confidence */               
+            DefocusOkNgThr = calc_defocus_ok_ng_thr ( pfa_InputData, pfa_ThrCache, Index );   /* Calculate threshold of confidence */               
         } else if ( AreaIndex == 1 ) {                      /* Top Center */
             unsigned short  Index;
             signed long     LineX[2];
@@ -659,8 +4757,8 @@ static void job_calc_defocus_confidence_level
             LineX[1] = p_XAddressKnot[XKnotStart+1];        /* Next to LineX[0] */
 
             /* Calculate threshold of confidence of each knot point */            
-            LineY[0] = calc_defocus_ok_ng_thr ( pfa_InputData, Index   );
-            LineY[1] = calc_defocus_ok_ng_thr ( pfa_InputData, Index+1 );   /* Next to LineY[0] */
+            LineY[0] = calc_defocus_ok_ng_thr ( pfa_InputData, pfa_ThrCache, Index   );
+            LineY[1] = calc_defocus_ok_ng_thr ( pfa_InputData, pfa_ThrCache, Index+1 );   /* Next to LineY[0] */
 
             PointX   = XAddressPDAFWindowCenter;
 
@@ -681,8 +4779,8 @@ static void job_calc_defocus_confidence_level
             LineX[1] = p_XAddressKnot[XKnotStart+1];        /* Next to LineX[0] */
 
             /* Calculate threshold of confidence of each knot point */
-            LineY[0] = calc_defocus_ok_ng_thr ( pfa_InputData, Index   );
-            LineY[1] = calc_defocus_ok_ng_thr ( pfa_InputData, Index+1 );   /* Next to LineY[0] */
+            LineY[0] = calc_defocus_ok_ng_thr ( pfa_InputData, pfa_ThrCache, Index   );
+            LineY[1] = calc_defocus_ok_ng_thr ( pfa_InputData, pfa_ThrCache, Index+1 );   /* Next to LineY[0] */
 
             PointX   = XAddressPDAFWindowCenter;
 
@@ -703,8 +4801,8 @@ static void job_calc_defocus_confidence_level
             LineX[1] = p_YAddressKnot[YKnotStart+1];        /* Next to LineX[0] */
 
             /* Calculate threshold of confidence of each knot point */
-            LineY[0] = calc_defocus_ok_ng_thr ( pfa_InputData, Index   );
-            LineY[1] = calc_defocus_ok_ng_thr ( pfa_InputData, Index+XKnotNum );    /* Next to LineY[0] */
+            LineY[0] = calc_defocus_ok_ng_thr ( pfa_InputData, pfa_ThrCache, Index   );
+            LineY[1] = calc_defocus_ok_ng_thr ( pfa_InputData, pfa_ThrCache, Index+XKnotNum );    /* Next to LineY[0] */
 
             PointX   = YAddressPDAFWindowCenter;
 
@@ -725,8 +4823,8 @@ static void job_calc_defocus_confidence_level
             LineX[1] = p_YAddressKnot[YKnotStart+1];        /* Next to LineX[0] */
 
             /* Calculate threshold of confidence of each knot point */
-            LineY[0] = calc_defocus_ok_ng_thr ( pfa_InputData, Index   );
-            LineY[1] = calc_defocus_ok_ng_thr ( pfa_InputData, Index+XKnotNum );
+            LineY[0] = calc_defocus_ok_ng_thr ( pfa_InputData, pfa_ThrCache, Index   );
+            LineY[1] = calc_defocus_ok_ng_thr ( pfa_InputData, pfa_ThrCache, Index+XKnotNum );
 
             PointX   = YAddressPDAFWindowCenter;
 
@@ -739,10 +4837,65 @@ static void job_calc_defocus_confidence_level
 
     if ( DefocusOkNgThr <= 0 ) DefocusOkNgThr = 0;          /* Check DefocusOkNgThr */
 
+    (*pfa_DefocusOkNgThr) = DefocusOkNgThr;
+
+    return ;
+}
+
+/* Function for calculating defocus confidence level */
+static void job_calc_defocus_confidence_level 
+( 
+    PdLibInputData_t *pfa_InputData,                        /* Input  : Input data structure */
+    signed long fa_DefocusOkNgThr,                          /* Input  : Threshold of confidence at window center */
+    unsigned long *pfa_DefocusConfidenceLevel               /* Output : Defocus confidence level */
+)
+{
+    signed long DefocusOkNgThr;
+
+    DefocusOkNgThr = fa_DefocusOkNgThr;
     
     if ( DefocusOkNgThr == 0 ) {                            /* If DefocusOkNgThr is Zero */
         (*pfa_DefocusConfidenceLevel) = 1024;               /* Set max value to ConfidenceLevel */
     } else {
+#if D_MATH_FUNC_FIXED_POINT
+        unsigned long long ConfidenceLevel;
+        unsigned long long DensityOfPhasePix;
+        unsigned long long Denominator;
+        unsigned long long DefocusConfidenceLevel;
+
+        ConfidenceLevel   = (unsigned long long)((*pfa_InputData).ConfidenceLevel);
+
+        if ( (*pfa_InputData).DensityOfPhasePix == 0 ) {    /* If DensityOfPhasePix is not set */
+            DensityOfPhasePix = 2304;                       /* Set default value to DensityOfPhasePix */
+        } else {
+            DensityOfPhasePix = (unsigned long long)((*pfa_InputData).DensityOfPhasePix);
+        }
+
+        Denominator = DensityOfPhasePix * (unsigned long long)DefocusOkNgThr;
+
+        /* Calculate defocus confidence level */
+        /* 1024 * ConfidenceLevel * 2304 / DensityOfPhasePix / DefocusOkNgThr */
+        if ( ConfidenceLevel <= 0xFFFFFFFF ) {
+            DefocusConfidenceLevel = 1024 * 2304 * ConfidenceLevel / Denominator;
+        } else {
+            /* Split by quotient and remainder to keep 64 bits */
+            unsigned long long Quotient;
+            unsigned long long Remainder;
+
+            Quotient  = ConfidenceLevel / Denominator;
+            Remainder = 1024 * ( ConfidenceLevel % Denominator );
+
+            if ( 2048 <= Quotient ) {
+                DefocusConfidenceLevel = 0xFFFFFFFEULL;     /* Out of limit max */
+            } else {
+                DefocusConfidenceLevel = 1024 * 2304 * Quotient
+                                       + 2304 * ( Remainder / Denominator )
+                                       + 2304 * ( Remainder % Denominator ) / Denominator;
+            }
+        }
+
+        (*pfa_DefocusConfidenceLevel) = limit_defocus_confidence_level_fixed(DefocusConfidenceLevel);
+#else
         double ConfidenceLevel;
         double DensityOfPhasePix;
         double DefocusConfidenceLevel;
@@ -759,6 +4912,7 @@ static void job_calc_defocus_confidence_level
         DefocusConfidenceLevel = 1024.0 * ConfidenceLevel * 2304.0 / DensityOfPhasePix / (double)DefocusOkNgThr;
 
         (*pfa_DefocusConfidenceLevel) = limit_defocus_confidence_level(DefocusConfidenceLevel);
+#endif
     }
 
     return ;
@@ -793,25 +4947,225 @@ static void job_calc_phase_difference
 }
 
 /* Sub function of job_calc_defocus() */
+#if D_PD_LIB_STATS
+
+/* Function for counting a call and its return value */
+static void job_stats_result 
+( 
+    signed long fa_Result                                   /* Input  : Return value */
+)
+{
+    unsigned long Code;
+
+    Code = (unsigned long)( -fa_Result );
+
+    if ( D_PD_LIB_STATS_RESULT_NUM <= Code ) {              /* Out of range is counted as the last */
+        Code = D_PD_LIB_STATS_RESULT_NUM - 1;
+    }
+
+    StatisticsAdd ( D_STATS_INDEX(CallNum), 1 );
+    StatisticsAdd ( D_STATS_INDEX(ResultNum) + Code, 1 );
+
+    return ;
+}
+
+/* Function for counting defocus confidence and sensor mode of a checked window */
+static void job_stats_confidence 
+( 
+    PdLibInputData_t *pfa_InputData,                        /* Input  : Input data structure */
+    PdLibProfileState_t *pfa_Profile,                       /* Input  : Sensor profile */
+    signed char fa_DefocusConfidence                        /* Input  : Defocus confidence */
+)
+{
+    unsigned long Confidence;
+    unsigned long SensMode;
+
+         if ( fa_DefocusConfidence == D_PD_LIB_E_OK ) { Confidence = 0; }
+    else if ( fa_DefocusConfidence == -ELDCL        ) { Confidence = 1; }
+    else if ( fa_DefocusConfidence == -ENCWDDON     ) { Confidence = 2; }
+    else                                              { Confidence = 3; }
+
+    /* Sensor modes of the same density of phase detection pixel are not distinguished */
+         if ( (*pfa_InputData).DensityOfPhasePix == (*pfa_Profile).Profile.DensityOfPhasePix[0] ) { SensMode = 0; }
+    else if ( (*pfa_InputData).DensityOfPhasePix == (*pfa_Profile).Profile.DensityOfPhasePix[2] ) { SensMode = 1; }
+    else if ( (*pfa_InputData).DensityOfPhasePix == (*pfa_Profile).Profile.DensityOfPhasePix[4] ) { SensMode = 2; }
+    else                                                                                            { SensMode = 3; }
+
+    StatisticsAdd ( D_STATS_INDEX(ConfidenceNum) + Confidence, 1 );
+    StatisticsAdd ( D_STATS_INDEX(SensModeNum) + SensMode, 1 );
+
+    return ;
+}
+
+/* Function for counting latency in the bucket of its logarithm */
+static void job_stats_latency 
+( 
+    unsigned long long fa_StartTime                         /* Input  : Time at start of call */
+)
+{
+    unsigned long long Latency;
+    unsigned long Bucket;
+
+    Latency = StatisticsGetTime () - fa_StartTime;
+
+    for ( Bucket = 0; ( Latency >> 1 ) != 0 && Bucket < D_PD_LIB_STATS_LATENCY_NUM - 1; Bucket++ ) {
+        Latency >>= 1;
+    }
+
+    StatisticsAdd ( D_STATS_INDEX(LatencyNum) + Bucket, 1 );
+
+    return ;
+}
+
+#endif
+
+#if D_PD_LIB_TRACE_NUM
+/* Function for writing records of evaluated windows to trace */
+/* Numbers of all windows are reserved, but only the last D_PD_LIB_TRACE_NUM windows are written, */
+/* because records of the others would be overwritten in the ring at once. Area of window center is */
+/* taken from registered window, or from pfa_AreaIndex of the windows written. */
+static void job_trace_windows 
+( 
+    Trace_t                 *pfa_Trace,                     /* In/Out : Trace of context */
+    PdLibInputData_t        *pfa_InputData,                 /* Input  : Input data structure with analog gain */
+    PdLibRegWindow_t        *pfa_RegWindow,                 /* Input  : Array of registered windows, or NULL */
+    unsigned long           fa_WindowNum,                   /* Input  : Number of windows */
+    PdLibWindow_t           *pfa_Window,                    /* Input  : Array of PDAF windows, or NULL for registered windows */
+    PdLibPhaseDiffData_t    *pfa_PhaseDiffData,             /* Input  : Array of phase difference data */
+    PdLibOutputData_t       *pfa_OutputData,                /* Input  : Array of output data structure */
+    signed long             *pfa_Result,                    /* Input  : Array of return value of each window */
+    unsigned char           *pfa_AreaIndex                  /* Input  : Area of each window written, or NULL for registered windows */
+)
+{
+    unsigned long i;
+    unsigned long Start;
+    unsigned long long Number;
+    TraceRecord_t Record;
+
+    if ( fa_WindowNum == 0 ) {
+        return ;
+    }
+
+    Number = TraceReserve ( pfa_Trace, fa_WindowNum );      /* One atomic operation for all windows */
+
+    Start = ( D_PD_LIB_TRACE_NUM < fa_WindowNum ) ? fa_WindowNum - D_PD_LIB_TRACE_NUM : 0;
+
+    Record.ImagerAnalogGain = (unsigned int)(*pfa_InputData).ImagerAnalogGain;
+    Record.Reserved         = 0;
+
+    for ( i = Start; i < fa_WindowNum; i++ ) {
+        PdLibWindow_t *p_Window;
+
+        p_Window = ( pfa_RegWindow != NULL ) ? &(pfa_RegWindow[i].Window) : &(pfa_Window[i]);
+
+        Record.XAddressOfWindowStart  = (*p_Window).XAddressOfWindowStart;
+        Record.YAddressOfWindowStart  = (*p_Window).YAddressOfWindowStart;
+        Record.XAddressOfWindowEnd    = (*p_Window).XAddressOfWindowEnd;
+        Record.YAddressOfWindowEnd    = (*p_Window).YAddressOfWindowEnd;
+        Record.PhaseDifference        = (unsigned int)pfa_PhaseDiffData[i].PhaseDifference;
+        Record.ConfidenceLevel        = (unsigned int)pfa_PhaseDiffData[i].ConfidenceLevel;
+        Record.Defocus                = (unsigned int)pfa_OutputData[i].Defocus;
+        Record.DefocusConfidenceLevel = (unsigned int)pfa_OutputData[i].DefocusConfidenceLevel;
+        Record.DefocusConfidence      = pfa_OutputData[i].DefocusConfidence;
+        Record.Result                 = (signed char)pfa_Result[i];
+
+        if ( pfa_Result[i] != D_PD_LIB_E_OK ) {             /* Window not evaluated */
+            Record.AreaIndex = D_PD_LIB_TRACE_AREA_NONE;
+        } else if ( pfa_RegWindow != NULL ) {
+            Record.AreaIndex = pfa_RegWindow[i].AreaIndex;
+        } else {
+            Record.AreaIndex = pfa_AreaIndex[i - Start];
+        }
+
+        TraceWrite ( pfa_Trace, Number + i, &Record );
+    }
+
+    return ;
+}
+#endif
+
 /* Function for calculating defocus value which uses slope and offset of index point */
 static signed long calc_defocus_formula 
 ( 
     PdLibInputData_t *pfa_InputData,                        /* Input : Input data structure */
+    PdLibKnotIndex_t *pfa_KnotIndex,                        /* Input : Index of knots with packed calibration data */
     unsigned short fa_Index                                 /* Input : Index of knot point  */
 )
 {
     signed long PhaseDifference;
     signed long AdjCoeffSlope;
+    signed long Slope;
+    signed long Offset;
+#if D_MATH_FUNC_FIXED_POINT
+    signed long long K;
+    signed long long AbsK;
+    signed long long AbsPD;
+    signed long long Z;
+
+    PhaseDifference = (*pfa_InputData).PhaseDifference;
+    AdjCoeffSlope   = (*pfa_InputData).AdjCoeffSlope;
+
+    calc_slope_offset ( pfa_InputData, pfa_KnotIndex, fa_Index, &Slope, &Offset );
+
+    K     = (signed long long)AdjCoeffSlope * (signed long long)Slope;
+    AbsK  = ( K < 0 ) ? -K : K;
+    AbsPD = ( PhaseDifference < 0 ) ? -(signed long long)PhaseDifference : (signed long long)PhaseDifference;
+
+    /* Z = ( AdjCoeffSlope * Slope * PhaseDifference + 2304 * Offset ) / 2304 */
+    /* When the product exceeds 62 bits, defocus is out of limit. */
+    if ( ( AbsK <= 0x7FFFFFFF && AbsPD <= 0x7FFFFFFF ) || AbsPD == 0 || AbsK <= ( 0x3FFFFFFFFFFFFFFFLL / AbsPD ) ) {
+        Z = ( K * (signed long long)PhaseDifference + 2304 * (signed long long)Offset ) / 2304;
+    } else if ( ( K < 0 ) == ( PhaseDifference < 0 ) ) {
+        Z = 0x3FFFFFFFFFFFFFFFLL;                           /* Out of limit max */
+    } else {
+        Z = -0x3FFFFFFFFFFFFFFFLL;                          /* Out of limit min */
+    }
+
+    return limit_defocus_formula_fixed(Z);                  /* Return defocus value with limitation */
+#else
     double Z;
 
     PhaseDifference = (*pfa_InputData).PhaseDifference;
     AdjCoeffSlope   = (*pfa_InputData).AdjCoeffSlope;
 
-    Z = (double)AdjCoeffSlope * (double)((*pfa_InputData).p_SlopeData[fa_Index]) * (double)PhaseDifference / 2304.0 + (double)((*pfa_InputData).p_OffsetData[fa_Index]);
+    calc_slope_offset ( pfa_InputData, pfa_KnotIndex, fa_Index, &Slope, &Offset );
+
+    Z = (double)AdjCoeffSlope * (double)Slope * (double)PhaseDifference / 2304.0 + (double)Offset;
 
     return limit_defocus_formula(Z);                        /* Return defocus value with limitation */
+#endif
+}
+
+/* Sub function of calc_defocus_formula() and job_calc_defocus_coeff_area() */
+/* Function for getting slope and offset of knot point from packed calibration data of context if any */
+static void calc_slope_offset 
+( 
+    PdLibInputData_t *pfa_InputData,                        /* Input  : Input data structure */
+    PdLibKnotIndex_t *pfa_KnotIndex,                        /* Input  : Index of knots with packed calibration data */
+    unsigned long fa_Index,                                 /* Input  : Index of knot point */
+    signed long *pfa_Slope,                                 /* Output : Slope */
+    signed long *pfa_Offset                                 /* Output : Offset */
+)
+{
+    PdLibPackedCalib_t *p_Packed;
+
+    p_Packed = (*pfa_KnotIndex).p_Packed;
+
+    if ( p_Packed == NULL || (*p_Packed).SlopeOffsetBits == 0 ) {  /* Calibration data without context */
+        (*pfa_Slope)  = (*pfa_InputData).p_SlopeData[fa_Index];
+        (*pfa_Offset) = (*pfa_InputData).p_OffsetData[fa_Index];
+    } else if ( (*p_Packed).SlopeOffsetBits == 16 ) {
+        (*pfa_Slope)  = ((signed short *)(*p_Packed).p_SlopeOffset)[fa_Index * 2    ];
+        (*pfa_Offset) = ((signed short *)(*p_Packed).p_SlopeOffset)[fa_Index * 2 + 1];
+    } else {
+        (*pfa_Slope)  = ((signed int *)(*p_Packed).p_SlopeOffset)[fa_Index * 2    ];
+        (*pfa_Offset) = ((signed int *)(*p_Packed).p_SlopeOffset)[fa_Index * 2 + 1];
+    }
+
+    return ;
 }
 
+#if !D_MATH_FUNC_FIXED_POINT
 /* Sub function of calc_defocus_formula() */
 /* Function for Limiting defocus value as  0x80000000 - 0x7FFFFFFF */
 static signed long limit_defocus_formula 
@@ -835,12 +5189,49 @@ static signed long limit_defocus_formula
 
     return ret;                                             /* Return limited value */
 }
+#endif
+
+/* Sub function of job_calc_defocus_coeff() */
+/* Function for calculating weight of x1 for linear interpolation at x. Same limitation as CalcAddressOnLine_slXslY(). */
+static PdLibWeight_t calc_line_weight 
+( 
+    signed long fa_X0,                                      /* Input : x0 ( x0 < x1 ) */
+    signed long fa_X1,                                      /* Input : x1 */
+    signed long fa_X                                        /* Input : x */
+)
+{
+    PdLibWeight_t ret;
+
+#if D_MATH_FUNC_FIXED_POINT
+    ret.Den = 1;
+
+    if ( fa_X <= fa_X0 ) {
+        ret.Num = 0;                                        /* Limit min */
+    } else if ( fa_X1 <= fa_X ) {
+        ret.Num = 1;                                        /* Limit max */
+    } else {
+        ret.Num = (unsigned long)( fa_X - fa_X0 );
+        ret.Den = (unsigned long)( fa_X1 - fa_X0 );
+    }
+#else
+    if ( fa_X <= fa_X0 ) {
+        ret = 0.0;                                          /* Limit min */
+    } else if ( fa_X1 <= fa_X ) {
+        ret = 1.0;                                          /* Limit max */
+    } else {
+        ret = ( (double)fa_X - (double)fa_X0 ) / ( (double)fa_X1 - (double)fa_X0 );
+    }
+#endif
+
+    return ret;                                             /* Return weight */
+}
 
 /* Sub function of job_calc_defocus_confidence_level() */
 /* Function for calculating threshold of confidence */
 static signed long calc_defocus_ok_ng_thr 
 ( 
     PdLibInputData_t *pfa_InputData,                        /* Input : Input data structure */
+    signed long *pfa_ThrCache,                              /* Input : Threshold at each knot. NULL calculates it */
     unsigned short fa_Index                                 /* Input : Index of knot point  */
 )
 {
@@ -851,6 +5242,10 @@ static signed long calc_defocus_ok_ng_thr
     unsigned long PointX;
     unsigned long PointY = 0;
 
+    if ( pfa_ThrCache != NULL ) {                           /* Threshold for the same analog gain */
+        return pfa_ThrCache[fa_Index];
+    }
+
     LineX    = (*pfa_InputData).p_DefocusOKNGThrLine[fa_Index].p_AnalogGain;
     LineY    = (*pfa_InputData).p_DefocusOKNGThrLine[fa_Index].p_Confidence;
     PointNum = (*pfa_InputData).p_DefocusOKNGThrLine[fa_Index].PointNum;
@@ -862,6 +5257,7 @@ static signed long calc_defocus_ok_ng_thr
     return (signed long)PointY;                             /* return threshold of confidence */
 }
 
+#if !D_MATH_FUNC_FIXED_POINT
 /* Sub function of job_calc_defocus_confidence_level() */
 /* Function for Limiting defocus confidence level */
 static unsigned long limit_defocus_confidence_level 
@@ -886,3 +5282,65 @@ static unsigned long limit_defocus_confidence_level
 
     return ret;                                             /* Return defocus confidence level */
 }
+#endif
+
+#if D_MATH_FUNC_FIXED_POINT
+/* Sub function of job_calc_defocus_coeff_area() */
+/* Function for calculating x * Num / Den of fixed-point truncated toward zero. Num <= Den and Den is less than 2^16. */
+static signed long long calc_weighted_fixed 
+( 
+    signed long long fa_X,                                  /* Input : x */
+    unsigned long fa_Num,                                   /* Input : Numerator of weight */
+    unsigned long fa_Den                                    /* Input : Denominator of weight */
+)
+{
+    signed long long Num;
+    signed long long Den;
+
+    Num = (signed long long)fa_Num;
+    Den = (signed long long)fa_Den;
+
+    /* Split by quotient and remainder to keep 64 bits */
+    return ( fa_X / Den ) * Num + ( fa_X % Den ) * Num / Den;
+}
+
+/* Sub function of calc_defocus_formula() */
+/* Function for Limiting defocus value of fixed-point as  0x80000000 - 0x7FFFFFFF */
+static signed long limit_defocus_formula_fixed 
+( 
+    signed long long fa_Defocus                             /* Input : Defocus */
+)
+{
+    signed long ret;
+
+    /* Same limitation as limit_defocus_formula() */
+    if ( fa_Defocus <= -2147483647LL ) {
+        ret = -2147483647;                                  /* Limit min */
+    } else  if ( +2147483646LL <= fa_Defocus ) {
+        ret = 2147483646;                                   /* Limit max */
+    } else {
+        ret = (signed long)fa_Defocus;
+    }
+
+    return ret;                                             /* Return limited value */
+}
+
+/* Sub function of job_calc_defocus_confidence_level() */
+/* Function for Limiting defocus confidence level of fixed-point */
+static unsigned long limit_defocus_confidence_level_fixed 
+( 
+    unsigned long long fa_DefocusConfidenceLevel            /* Input : Defocus confidence level */
+)
+{
+    unsigned long ret;
+
+    /* Same limitation as limit_defocus_confidence_level() */
+    if ( 0xFFFFFFFEULL <= fa_DefocusConfidenceLevel ) {     /* limit max */
+        ret = 0xFFFFFFFE;
+    } else {
+        ret = (unsigned long)fa_DefocusConfidenceLevel;
+    }
+
+    return ret;                                             /* Return defocus confidence level */
+}
+#endif
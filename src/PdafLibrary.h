@@ -48,6 +48,66 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE3         (2304)  /* Adjustment coefficient of slope of mode 0 */
 #define D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE4         (2304)  /* Adjustment coefficient of slope of mode 0 */
 
+/* For PdLibSetSensorProfile */
+/* Values above are the default sensor profile. Other sensors are selected at runtime by sensor profile. */
+#define D_PD_LIB_SENS_MODE_NUM                      (5)     /* Number of sensor modes of a sensor profile */
+#define D_PD_LIB_SENSOR_PROFILE_DEFAULT             (0)     /* Built-in profile of values above */
+#define D_PD_LIB_SENSOR_PROFILE_PD_ERROR_64         (1)     /* Built-in profile of error value -64 : Other sensor type */
+#define D_PD_LIB_SENSOR_PROFILE_PD_ERROR_32         (2)     /* Built-in profile of error value -32 : IMX230, IMX298, IMX330, IMX338 */
+#define D_PD_LIB_SENSOR_PROFILE_NUM                 (3)     /* Number of built-in profiles */
+
+/* For PdLibGetStats */
+/* 0 : disable (default), 1 : enable. Statistics of calls are counted only when enabled. */
+/* When enabled, counters of each thread are allocated at its first counted call, except the thread */
+/* creating an executor and its worker threads, whose counters are allocated by PdLibCreateExecutor(). */
+#ifndef D_PD_LIB_STATS
+#define D_PD_LIB_STATS                              (0)
+#endif
+#define D_PD_LIB_STATS_RESULT_NUM                   (96)    /* Return values 0 - -95 */
+#define D_PD_LIB_STATS_AREA_NUM                     (9)     /* AreaIndex 0 - 8 */
+#define D_PD_LIB_STATS_CONFIDENCE_NUM               (4)     /* 0 : OK, 1 : -ELDCL, 2 : -ENCWDDON, 3 : -EPDVALERR */
+#define D_PD_LIB_STATS_SENS_MODE_NUM                (4)     /* DensityOfPhasePix 0 : mode 0, 1, 1 : mode 2, 3, */
+                                                            /* 2 : mode 4, 3 : other value */
+#define D_PD_LIB_STATS_LATENCY_NUM                  (32)    /* Bucket i : 2^i <= ns < 2^(i+1). Bucket 0 includes 0 ns */
+
+/* For PdLibGetPhaseDiff */
+#define D_PD_LIB_PD_COST_SAD                        (0)     /* Sum of absolute differences of line profiles */
+#define D_PD_LIB_PD_COST_SSD                        (1)     /* Sum of squared differences of line profiles */
+#define D_PD_LIB_PD_SEARCH_RANGE_MAX                (64)    /* Maximum shift of disparity search in PD pixels */
+#define D_PD_LIB_PD_WINDOW_SIZE_MAX                 (512)   /* Maximum width and height of window in PD pixels */
+#define D_PD_LIB_PD_PHASE_DIFF_SCALE_MAX            (256)   /* Maximum PhaseDifference of one PD pixel */
+#define D_PD_LIB_PD_LEVEL_NUM_MAX                   (4)     /* Maximum number of levels of PdLibGetPhaseDiffPyramid */
+
+/* For PdLibGetDefocus and batch of windows */
+/* Kernel of defocus interpolation. 0 : interpolation selected by area 0 - 8 of PDAF window center (default), */
+/* 1 : constant time. Window center is limited into the knots and one cell is always interpolated */
+/*     without branches on data, for both defocus and threshold of confidence, which gives the same */
+/*     output data with flat cost of each window. */
+#ifndef D_PD_LIB_CONSTANT_TIME
+#define D_PD_LIB_CONSTANT_TIME                      (0)
+#endif
+
+/* For PdLibGetDefocusRoi */
+#define D_PD_LIB_ROI_WINDOW_NUM_MAX                 (256)   /* Maximum number of windows of a ROI */
+
+/* For PdLibUpdateTracker */
+#define D_PD_LIB_TRACKER_GAIN_ONE                   (256)   /* Alpha and Beta of 1.0 */
+
+/* For PdLibDumpTrace */
+/* Number of records of recent evaluations kept in each context, or 0 to disable. Power of 2 is faster. */
+#ifndef D_PD_LIB_TRACE_NUM
+#define D_PD_LIB_TRACE_NUM                          (256)
+#endif
+#define D_PD_LIB_TRACE_AREA_NONE                    (255)   /* AreaIndex of window not evaluated */
+
+/* For PdLibCreateContext */
+#define D_PD_LIB_THR_POINT_NUM_MAX                  (65535) /* Maximum number of points of a threshold line */
+
+/* For PdLibReplay */
+#define D_PD_LIB_REPLAY_SINGLE                      (0)     /* PdLibGetDefocus() of each window */
+#define D_PD_LIB_REPLAY_BATCH                       (1)     /* PdLibGetDefocusBatch() of each frame */
+#define D_PD_LIB_REPLAY_PARALLEL                    (2)     /* PdLibGetDefocusBatchParallel() of each frame */
+
 #define D_PD_LIB_E_OK                               (0)     /* OK value */
 #define D_PD_LIB_E_NG                               (-1)    /* NG value of DefocusConfidence */
 
@@ -67,6 +127,26 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define EINDONXAK                                   (51)    /* DefocusOKNGXAddressKnot Input out of range */
 #define EINDONYAK                                   (52)    /* DefocusOKNGYAddressKnot Input out of range */
 #define EINDOP                                      (53)    /* DensityOfPhasePix Input out of range */
+#define EINVALCTX                                   (54)    /* Invalid of Context (not created or not validated) */
+#define EINVALEXEC                                  (55)    /* Invalid of Executor (number of threads out of range) */
+#define EINVALSTATS                                 (56)    /* Invalid of Statistics (not enabled by D_PD_LIB_STATS) */
+#define EINVALIMG                                   (57)    /* Invalid of calibration image (format, checksum or sensor mode) */
+#define EINVALOTP                                   (58)    /* Invalid of OTP calibration block (format, size or checksum) */
+#define EINVALPROF                                  (59)    /* Invalid of sensor profile or sensor mode */
+#define EALLOCCTX                                   (60)    /* Allocation of Context failed */
+#define EALLOCEXEC                                  (61)    /* Allocation of Executor or creation of its threads failed */
+#define EMAPIMG                                     (62)    /* Mapping of calibration image file failed */
+#define EALLOCSLOT                                  (63)    /* Allocation of context slot failed */
+#define EINVALMAP                                   (64)    /* Invalid of defocus map (size out of range or not registered) */
+#define EINVALPD                                    (65)    /* Invalid of PD image, PD parameter or window of PD extraction */
+#define EINVALROI                                   (66)    /* Invalid of ROI (number of windows or index out of range) */
+#define EINVALTRK                                   (67)    /* Invalid of tracker (parameter or number of windows) */
+#define EALLOCTRK                                   (68)    /* Allocation of tracker failed */
+#define EINVALREC                                   (69)    /* Invalid of recorder, record stream or replay mode */
+#define EALLOCREC                                   (70)    /* Allocation of recorder or replay failed */
+#define EWRITEREC                                   (71)    /* Write function of recorder failed */
+#define EINVALTRACE                                 (72)    /* Invalid of Trace (disabled by D_PD_LIB_TRACE_NUM) */
+#define EINVALSCRATCH                               (73)    /* Invalid of scratch buffer (too small or too many windows or cells) */
 #define ELDCL                                       (80)    /* Low DefocusConfidenceLevel */
 
 typedef struct
@@ -108,6 +188,39 @@ typedef struct
     unsigned long       DensityOfPhasePix;          /* Density of phase detection pixel. */
 } PdLibInputData_t;
 
+typedef struct
+{
+    unsigned short      XSizeOfImage;               /* X size of image in all-pixel mode */
+    unsigned short      YSizeOfImage;               /* Y size of image in all-pixel mode. */
+    unsigned short      XKnotNumSlopeOffset;        /* Number of knots in x-direction. */
+    unsigned short      YKnotNumSlopeOffset;        /* Number of knots in y-direction. */
+    signed long         *p_SlopeData;               /* Array of slope data. */
+    signed long         *p_OffsetData;              /* Array of offset data. */
+    unsigned short      *p_XAddressKnotSlopeOffset; /* Array of x address of knots. */
+    unsigned short      *p_YAddressKnotSlopeOffset; /* Array of y address of knots. */
+    signed long         AdjCoeffSlope;              /* Adjustment coefficient of slope. */
+    unsigned short      XKnotNumDefocusOKNG;        /* Number of knots in x-direction. */
+    unsigned short      YKnotNumDefocusOKNG;        /* Number of knots in y-direction. */
+    DefocusOKNGThrLine_t    *p_DefocusOKNGThrLine;  /* Array of threshold line data which determines Defocus OK/NG. */
+    unsigned short      *p_XAddressKnotDefocusOKNG; /* Array of x address of knots. */
+    unsigned short      *p_YAddressKnotDefocusOKNG; /* Array of y address of knots. */
+    unsigned long       DensityOfPhasePix;          /* Density of phase detection pixel. */
+} PdLibCalibData_t;
+
+typedef struct
+{
+    unsigned short      XAddressOfWindowStart;      /* X address of PDAF window start position in all-pixel mode. */
+    unsigned short      YAddressOfWindowStart;      /* Y address of PDAF window start position in all-pixel mode. */
+    unsigned short      XAddressOfWindowEnd;        /* X address of PDAF window end position in all-pixel mode. */
+    unsigned short      YAddressOfWindowEnd;        /* Y address of PDAF window end position in all-pixel mode. */
+} PdLibWindow_t;
+
+typedef struct
+{
+    signed long         PhaseDifference;            /* Phase difference data which is output data from image sensor. */
+    unsigned long       ConfidenceLevel;            /* Confidence level which is output data from image sensor. */
+} PdLibPhaseDiffData_t;
+
 typedef struct
 {
     signed long         Defocus;                    /* Defocus. Unit is DN (Digital Number). */
@@ -116,6 +229,171 @@ typedef struct
     signed long         PhaseDifference;            /* Phase difference which is the same information as input data. */
 } PdLibOutputData_t;
 
+typedef struct
+{
+    unsigned long       CallNum;                    /* Number of evaluations with context. */
+    unsigned long       GainChangeNum;              /* Number of evaluations which updated threshold of confidence */
+                                                    /* because analog gain was changed. */
+} PdLibCacheStatistics_t;
+
+typedef struct
+{
+    unsigned long       KnotNum;                    /* Number of knots of slope and offset. */
+    unsigned long       SlopeOffsetBits;            /* Bits of packed slope and offset. 16 or 32, 0 : not packed. */
+    unsigned long       KnotSize;                   /* Bytes of slope and offset per knot read by evaluation. */
+    unsigned long       CalibKnotSize;              /* Bytes of slope and offset per knot in PdLibCalibData_t. */
+    unsigned long       LineNum;                    /* Number of threshold lines. */
+    unsigned long       PointNum;                   /* Number of points of all threshold lines. */
+    unsigned long       LineSize;                   /* Bytes of threshold lines read when analog gain is changed. */
+    unsigned long       CalibLineSize;              /* Bytes of threshold lines with their pointers in PdLibCalibData_t. */
+} PdLibCalibFootprint_t;
+
+typedef struct
+{
+    unsigned long       CallNum;                    /* Number of calls of PdLibGetDefocus() and windows of batch APIs. */
+    unsigned long       ResultNum[D_PD_LIB_STATS_RESULT_NUM];          /* Number of each return value. Index is -return value. */
+    unsigned long       AreaNum[D_PD_LIB_STATS_AREA_NUM];              /* Number of each AreaIndex of PDAF window center. */
+    unsigned long       ConfidenceNum[D_PD_LIB_STATS_CONFIDENCE_NUM];  /* Number of each DefocusConfidence. */
+    unsigned long       SensModeNum[D_PD_LIB_STATS_SENS_MODE_NUM];     /* Number of each sensor mode. */
+    unsigned long       LatencyNum[D_PD_LIB_STATS_LATENCY_NUM];        /* Histogram of latency of PdLibGetDefocus(). */
+} PdLibStats_t;
+
+/*
+
+    PDAF calibration block of OTP / EEPROM dump read by PdLibCreateContextFromOtp()
+
+    Bytes   Item
+    2       XSizeOfImage
+    2       YSizeOfImage
+    1       XKnotNumSlopeOffset (X)
+    1       YKnotNumSlopeOffset (Y)
+    2 * X   X address of knots of slope and offset
+    2 * Y   Y address of knots of slope and offset
+    V * X*Y Slope in row-major order, signed
+    V * X*Y Offset in row-major order, signed
+    1       XKnotNumDefocusOKNG (XD)
+    1       YKnotNumDefocusOKNG (YD)
+    2 * XD  X address of knots of DefocusOKNG
+    2 * YD  Y address of knots of DefocusOKNG
+            Threshold lines, XD * YD lines or 1 line when XD * YD is 0, each of
+    1         PointNum (P)
+    V * P     AnalogGain
+    V * P     Confidence
+    1       8-bit sum of all bytes above (when Checksum is 1)
+
+    V is ValueSize. Values of 2 or more bytes are in byte order of BigEndian.
+
+*/
+typedef struct
+{
+    unsigned long       BlockOffset;                /* Position of PDAF calibration block in the dump. */
+    unsigned char       BigEndian;                  /* 1 : big endian, 0 : little endian. */
+    unsigned char       ValueSize;                  /* Bytes of slope, offset, analog gain and confidence (2 or 4). */
+    unsigned char       Checksum;                   /* 1 : block ends with 8-bit sum, 0 : no checksum. */
+    signed long         PdErrorValue;               /* Error value of phase difference of the sensor, like D_PD_ERROR_VALUE. */
+    signed long         AdjCoeffSlope;              /* Adjustment coefficient of slope of the sensor mode. */
+    unsigned long       DensityOfPhasePix;          /* Density of phase detection pixel of the sensor mode. */
+} PdLibOtpFormat_t;
+
+typedef struct
+{
+    signed long         PdErrorValue;               /* Error value of phase difference of the sensor. */
+    unsigned long       DensityOfPhasePix[D_PD_LIB_SENS_MODE_NUM];  /* Density of phase detection pixel of each mode. */
+    signed long         AdjCoeffSlope[D_PD_LIB_SENS_MODE_NUM];      /* Adjustment coefficient of slope of each mode. */
+} PdLibSensorProfile_t;
+
+typedef struct
+{
+    const unsigned short *p_Left;                   /* Left sub-image (left-opened or right-shielded pixels). */
+    const unsigned short *p_Right;                  /* Right sub-image of the same size. */
+    unsigned long       Stride;                     /* Number of pixels from a row to the next row. */
+    unsigned short      XSize;                      /* X size of sub-images in PD pixels. */
+    unsigned short      YSize;                      /* Y size of sub-images in PD pixels. */
+    unsigned short      XSizeOfImage;               /* X size of image in all-pixel mode covered by sub-images. */
+    unsigned short      YSizeOfImage;               /* Y size of image in all-pixel mode covered by sub-images. */
+} PdLibPdImage_t;
+
+typedef struct
+{
+    unsigned short      SearchRange;                /* Disparity is searched from -SearchRange to +SearchRange PD pixels. */
+    unsigned char       CostType;                   /* D_PD_LIB_PD_COST_XXX. */
+    unsigned short      PhaseDiffScale;             /* PhaseDifference of disparity of one PD pixel. */
+    unsigned short      ConfidenceGain;             /* ConfidenceLevel of slope of cost of one pixel value per column. */
+    signed long         PdErrorValue;               /* PhaseDifference of windows whose disparity is not found. */
+} PdLibPdParam_t;
+
+typedef struct
+{
+    const unsigned short *p_WindowIndex;            /* Array of indices of windows of ROI in the batch. */
+    unsigned short      WindowNum;                  /* Number of windows of ROI. 1 - D_PD_LIB_ROI_WINDOW_NUM_MAX. */
+} PdLibRoi_t;
+
+typedef struct
+{
+    signed long         Defocus;                    /* Confidence-weighted mean of defocus of inlier windows. Unit is DN. */
+    signed char         DefocusConfidence;          /* Defocus OK/NG of ROI. */
+    unsigned long       DefocusConfidenceLevel;     /* Mean of DefocusConfidenceLevel of windows of ROI. */
+                                                    /* Windows of errors and outliers count as 0. */
+    unsigned long       Spread;                     /* Confidence-weighted mean absolute deviation of defocus */
+                                                    /* of inlier windows from Defocus. Unit is DN. */
+    unsigned short      InlierNum;                  /* Number of inlier windows. */
+} PdLibRoiData_t;
+
+typedef struct
+{
+    unsigned short      Alpha;                      /* Gain of defocus. 0 - D_PD_LIB_TRACKER_GAIN_ONE. */
+    unsigned short      Beta;                       /* Gain of defocus change per frame. 0 - D_PD_LIB_TRACKER_GAIN_ONE. */
+    unsigned long       ConfidenceLevelFull;        /* DefocusConfidenceLevel with full gains. Gains are */
+                                                    /* proportional to lower levels. 1 or more. */
+    unsigned long       ResetThr;                   /* Difference of defocus from prediction which restarts */
+                                                    /* the window, such as scene change. Unit is DN. 0 : never. */
+    unsigned short      HoldNum;                    /* Number of frames predicted without confident defocus */
+                                                    /* before the window is lost. */
+} PdLibTrackerParam_t;
+
+typedef struct
+{
+    signed long         Defocus;                    /* Smoothed defocus of current frame. Unit is DN. */
+    signed long         PredictedDefocus;           /* Defocus predicted one frame ahead without lens movement. */
+    unsigned char       Valid;                      /* 1 : tracked, 0 : not yet or lost (defocus is 0). */
+} PdLibTrackData_t;
+
+typedef struct
+{
+    unsigned long       FrameNum;                   /* Number of frames replayed. */
+    unsigned long       WindowNum;                  /* Number of windows replayed. */
+    unsigned long       CheckedWindowNum;           /* Number of windows with recorded output data. */
+    unsigned long       MismatchNum;                /* Number of windows whose output data or result differ. */
+    unsigned long       FirstMismatchFrame;         /* Frame of first mismatch (0 : first frame). */
+    unsigned long       FirstMismatchWindow;        /* Window of first mismatch in the frame. */
+} PdLibReplayStats_t;
+
+typedef struct
+{
+    unsigned long long  Sequence;                   /* Number of evaluation of window in the context from 0. */
+    PdLibWindow_t       Window;                     /* PDAF window. */
+    signed long         PhaseDifference;            /* Phase difference of input in 32 bits. */
+    unsigned long       ConfidenceLevel;            /* Confidence level of input in 32 bits. */
+    unsigned long       ImagerAnalogGain;           /* Image sensor analog gain in 32 bits. */
+    unsigned char       AreaIndex;                  /* Area of window center 0 - 8, or D_PD_LIB_TRACE_AREA_NONE. */
+    signed long         Defocus;                    /* Defocus of output. */
+    signed char         DefocusConfidence;          /* Defocus confidence of output. */
+    unsigned long       DefocusConfidenceLevel;     /* Defocus confidence level of output. */
+    signed long         Result;                     /* Return value of the window. */
+} PdLibTraceRecord_t;
+
+/* Function which writes Size bytes of record stream, and returns 0 when it succeeds. */
+typedef signed long (*PdLibRecordWrite_t) ( void *p_User, const void *p_Data, unsigned long Size );
+
+typedef struct PdLibContext PdLibContext_t;         /* Calibration context. Contents are private to PDAF Library. */
+typedef struct PdLibExecutor PdLibExecutor_t;       /* Parallel executor. Contents are private to PDAF Library. */
+
+typedef struct PdLibContextSlot PdLibContextSlot_t; /* Slot of hot-swapped context. Contents are private to PDAF Library. */
+
+typedef struct PdLibTracker PdLibTracker_t;         /* Temporal tracker of defocus. Contents are private to PDAF Library. */
+
+typedef struct PdLibRecorder PdLibRecorder_t;       /* Recorder of input data. Contents are private to PDAF Library. */
+
 /* ------- PdLibGetVersion API */
 #ifdef __cplusplus 
 extern "C" {
@@ -145,6 +423,913 @@ extern signed long PdLibGetDefocus                  /* Get defocus data accordin
     PdLibOutputData_t   *pfa_PdLibOutputData        /* Defocus data. */
 );
 
+/* ------- PdLibGetDefocusBatch API */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibGetDefocusBatch
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibGetDefocusBatch
+#else
+extern signed long PdLibGetDefocusBatch             /* Get defocus data of all PDAF windows in a frame. */
+#endif
+(
+    PdLibCalibData_t        *pfa_PdLibCalibData,    /* Calibration data shared by all windows. */
+    unsigned long           fa_ImagerAnalogGain,    /* Image sensor analog gain. */
+    unsigned long           fa_WindowNum,           /* Number of windows. */
+    PdLibWindow_t           *pfa_PdLibWindow,       /* Array of PDAF windows. */
+    PdLibPhaseDiffData_t    *pfa_PdLibPhaseDiffData,/* Array of phase difference data of each window. */
+    PdLibOutputData_t       *pfa_PdLibOutputData,   /* Array of defocus data of each window. */
+    signed long             *pfa_PdLibResult        /* Array of return value of each window. */
+);
+
+/* ------- PdLibCreateContext API */
+/* Pointers and numbers of tables of calibration data are checked before they are copied. NULL table */
+/* returns -EINSO, -EINSOXAK, -EINSOYAK, -EINDONXAK or -EINDONYAK, and NULL threshold line or points, */
+/* or PointNum of 0 or more than D_PD_LIB_THR_POINT_NUM_MAX, returns -EINDONTPN. First threshold line */
+/* is required even without knots of DefocusOKNG, because PdLibValidateContext() checks it. */
+/* Values are checked by PdLibValidateContext(), which must be called before use. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibCreateContext
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibCreateContext
+#else
+extern signed long PdLibCreateContext               /* Create context and copy calibration data to it. */
+#endif
+(
+    PdLibCalibData_t        *pfa_PdLibCalibData,    /* Calibration data copied to the context. */
+    PdLibContext_t          **ppfa_PdLibContext     /* Created context. */
+);
+
+/* ------- PdLibCreateContextFromImage API */
+/* Same as PdLibCreateContext(), except that the context points to the tables of calibration image of */
+/* fa_SensorMode without copying them. Only the context, pointers of threshold lines and packed slope */
+/* and offset are allocated. */
+/* The image must be kept until the context is destroyed. Header and position of tables are checked, */
+/* but checksum is checked by PdLibMapCalibImage() or PdLibCheckCalibImage(). */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibCreateContextFromImage
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibCreateContextFromImage
+#else
+extern signed long PdLibCreateContextFromImage      /* Create context which uses tables of calibration image in place. */
+#endif
+(
+    const void              *pfa_Image,             /* Calibration image. */
+    unsigned long           fa_ImageSize,           /* Size of calibration image. */
+    unsigned long           fa_SensorMode,          /* Sensor mode in calibration image. */
+    PdLibContext_t          **ppfa_PdLibContext     /* Created context. */
+);
+
+/* ------- PdLibCreateContextFromOtp API */
+/* Same as PdLibCreateContext(), except that calibration data is decoded from the PDAF calibration block */
+/* of OTP / EEPROM dump directly to the tables of context with one allocation. Error value of phase */
+/* difference of the context is PdErrorValue of pfa_Format instead of the sensor profile. */
+/* PdLibValidateContext() must be called before use. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibCreateContextFromOtp
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibCreateContextFromOtp
+#else
+extern signed long PdLibCreateContextFromOtp        /* Create context from OTP / EEPROM dump. */
+#endif
+(
+    const unsigned char     *pfa_Data,              /* OTP / EEPROM dump. */
+    unsigned long           fa_DataSize,            /* Size of dump. */
+    PdLibOtpFormat_t        *pfa_Format,            /* Format of PDAF calibration block. */
+    PdLibContext_t          **ppfa_PdLibContext     /* Created context. */
+);
+
+/* ------- PdLibQueryScratchSize API */
+/* Size of scratch buffer owned by caller, in which registered windows and defocus map are kept */
+/* instead of heap. With pfa_PdLibCalibData, the size includes the context and copy of calibration */
+/* data for PdLibCreateContextWithScratch(), and its tables are checked as PdLibCreateContext(). */
+/* With NULL, it is the size for PdLibSetContextScratch(). */
+/* Buffer is aligned inside, so any address can be given. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibQueryScratchSize
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibQueryScratchSize
+#else
+extern signed long PdLibQueryScratchSize            /* Get size of scratch buffer of context. */
+#endif
+(
+    PdLibCalibData_t        *pfa_PdLibCalibData,    /* Calibration data copied to the context, or NULL. */
+    unsigned long           fa_WindowNum,           /* Maximum number of registered windows. */
+    unsigned long           fa_XCellNum,            /* Maximum number of cells of defocus map in x-direction. 0 - 65535. */
+    unsigned long           fa_YCellNum,            /* Maximum number of cells of defocus map in y-direction. 0 - 65535. */
+    unsigned long           *pfa_ScratchSize        /* Size of scratch buffer in bytes. */
+);
+
+/* ------- PdLibCreateContextWithScratch API */
+/* Same as PdLibCreateContext(), except that the context is created in the scratch buffer without */
+/* allocation. Registration of up to fa_WindowNum windows and of a defocus map of up to fa_XCellNum x */
+/* fa_YCellNum cells uses the rest of the buffer, and no API allocates heap for the context after this. */
+/* With D_PD_LIB_STATS, the first counted call of a thread allocates its counters once (see D_PD_LIB_STATS). */
+/* The buffer must be kept until PdLibDestroyContext(), which does not release it. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibCreateContextWithScratch
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibCreateContextWithScratch
+#else
+extern signed long PdLibCreateContextWithScratch    /* Create context in scratch buffer owned by caller. */
+#endif
+(
+    PdLibCalibData_t        *pfa_PdLibCalibData,    /* Calibration data copied to the context. */
+    unsigned long           fa_WindowNum,           /* Maximum number of registered windows. */
+    unsigned long           fa_XCellNum,            /* Maximum number of cells of defocus map in x-direction. */
+    unsigned long           fa_YCellNum,            /* Maximum number of cells of defocus map in y-direction. */
+    void                    *pfa_Scratch,           /* Scratch buffer. */
+    unsigned long           fa_ScratchSize,         /* Size of scratch buffer. PdLibQueryScratchSize() or more. */
+    PdLibContext_t          **ppfa_PdLibContext     /* Created context. */
+);
+
+/* ------- PdLibSetContextScratch API */
+/* Keep registered windows and defocus map of a created context in the scratch buffer instead of heap. */
+/* Registration made before is released. Registration of more windows or cells than the buffer holds */
+/* returns -EINVALSCRATCH. The buffer must be kept until the context is destroyed. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibSetContextScratch
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibSetContextScratch
+#else
+extern signed long PdLibSetContextScratch           /* Set scratch buffer of registration of context. */
+#endif
+(
+    PdLibContext_t          *pfa_PdLibContext,      /* Context. */
+    unsigned long           fa_WindowNum,           /* Maximum number of registered windows. */
+    unsigned long           fa_XCellNum,            /* Maximum number of cells of defocus map in x-direction. */
+    unsigned long           fa_YCellNum,            /* Maximum number of cells of defocus map in y-direction. */
+    void                    *pfa_Scratch,           /* Scratch buffer. */
+    unsigned long           fa_ScratchSize          /* Size of scratch buffer. PdLibQueryScratchSize() with NULL or more. */
+);
+
+/* ------- PdLibGetSensorProfile API */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibGetSensorProfile
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibGetSensorProfile
+#else
+extern signed long PdLibGetSensorProfile            /* Get built-in sensor profile. */
+#endif
+(
+    unsigned long           fa_ProfileIndex,        /* D_PD_LIB_SENSOR_PROFILE_XXX. */
+    PdLibSensorProfile_t    *pfa_Profile            /* Sensor profile. */
+);
+
+/* ------- PdLibSetSensorProfile API */
+/* Sensor profile is used by APIs without context and is the initial profile of contexts created later. */
+/* With GCC or clang it may be called while other threads call APIs. Each call of APIs without context, */
+/* and each context created, uses the profile set before or after it as a whole. Contexts created before keep */
+/* their profile. With other compilers it is not synchronized, so call it before other threads call APIs. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibSetSensorProfile
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibSetSensorProfile
+#else
+extern signed long PdLibSetSensorProfile            /* Set sensor profile of PDAF Library. */
+#endif
+(
+    const PdLibSensorProfile_t *pfa_Profile         /* Sensor profile. */
+);
+
+/* ------- PdLibSetContextSensorProfile API */
+/* PdLibValidateContext() must be called again after the sensor profile of context is changed. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibSetContextSensorProfile
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibSetContextSensorProfile
+#else
+extern signed long PdLibSetContextSensorProfile     /* Set sensor profile of context. */
+#endif
+(
+    PdLibContext_t          *pfa_PdLibContext,      /* Context. */
+    const PdLibSensorProfile_t *pfa_Profile         /* Sensor profile. */
+);
+
+/* ------- PdLibSetContextSensorMode API */
+/* DensityOfPhasePix and AdjCoeffSlope of the mode in sensor profile of context are set to the context. */
+/* One calibration data is shared by all sensor modes, and only these two values change with the mode. */
+/* PdLibValidateContext() checks calibration data with the values of every mode of the profile, and a */
+/* validated context takes the result of the mode without checking again, which is returned and used by */
+/* evaluation. Registered windows and defocus map are updated at next evaluation. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibSetContextSensorMode
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibSetContextSensorMode
+#else
+extern signed long PdLibSetContextSensorMode        /* Switch sensor mode of context. */
+#endif
+(
+    PdLibContext_t          *pfa_PdLibContext,      /* Context. */
+    unsigned long           fa_SensMode             /* Sensor mode 0 - D_PD_LIB_SENS_MODE_NUM-1. */
+);
+
+/* ------- PdLibValidateContext API */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibValidateContext
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibValidateContext
+#else
+extern signed long PdLibValidateContext             /* Check calibration data of context. */
+#endif
+(
+    PdLibContext_t          *pfa_PdLibContext       /* Context to be checked. */
+);
+
+/* ------- PdLibDestroyContext API */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) void PdLibDestroyContext
+#elif defined(_DLL)
+__declspec( dllexport ) void PdLibDestroyContext
+#else
+extern void PdLibDestroyContext                     /* Destroy context. */
+#endif
+(
+    PdLibContext_t          *pfa_PdLibContext       /* Context to be destroyed. */
+);
+
+/* ------- PdLibCreateContextSlot API */
+/* Slot holds the context used by AF thread, and a new context is published to it while AF thread is */
+/* running. The slot owns pfa_PdLibContext and contexts published later, which are prepared in the same */
+/* way as PdLibPublishContext(). */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibCreateContextSlot
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibCreateContextSlot
+#else
+extern signed long PdLibCreateContextSlot           /* Create slot of hot-swapped context. */
+#endif
+(
+    PdLibContext_t          *pfa_PdLibContext,      /* First context of the slot. */
+    PdLibContextSlot_t      **ppfa_PdLibContextSlot /* Created slot. */
+);
+
+/* ------- PdLibDestroyContextSlot API */
+/* Context of the slot is also destroyed. No context of the slot may be acquired. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) void PdLibDestroyContextSlot
+#elif defined(_DLL)
+__declspec( dllexport ) void PdLibDestroyContextSlot
+#else
+extern void PdLibDestroyContextSlot                 /* Destroy slot and its context. */
+#endif
+(
+    PdLibContextSlot_t      *pfa_PdLibContextSlot   /* Slot to be destroyed. */
+);
+
+/* ------- PdLibPublishContext API */
+/* Prepared context (validated, with registered windows) replaces the context of the slot atomically. */
+/* Before that, slope and offset of registered windows and defocus map and the threshold cache for the */
+/* analog gain of the last evaluation of the context (0 if not evaluated) are completed, and the context */
+/* is not written after this. Contexts acquired before continue to be used until released. This function */
+/* waits for their release and destroys the replaced context, so it must be called from other thread */
+/* than AF thread. */
+/* Slot uses atomic operations of GCC or clang except Windows. Otherwise publication and evaluation */
+/* must not run at the same time. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibPublishContext
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibPublishContext
+#else
+extern signed long PdLibPublishContext              /* Replace context of slot. */
+#endif
+(
+    PdLibContextSlot_t      *pfa_PdLibContextSlot,  /* Slot. */
+    PdLibContext_t          *pfa_PdLibContext       /* New context owned by the slot. */
+);
+
+/* ------- PdLibAcquireContext API */
+/* Context of the slot is used with APIs of context until PdLibReleaseContext() with the ticket. */
+/* Acquire and release do not take a lock, and evaluation of the acquired context only reads it, so */
+/* several threads may evaluate it at the same time. At other analog gain than the threshold cache, */
+/* threshold is calculated from calibration data at each evaluation without updating the cache. */
+/* APIs which change the context, such as registration or sensor mode, must not be used with it. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibAcquireContext
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibAcquireContext
+#else
+extern signed long PdLibAcquireContext              /* Acquire current context of slot. */
+#endif
+(
+    PdLibContextSlot_t      *pfa_PdLibContextSlot,  /* Slot. */
+    PdLibContext_t          **ppfa_PdLibContext,    /* Current context. */
+    unsigned long           *pfa_Ticket             /* Ticket of PdLibReleaseContext(). */
+);
+
+/* ------- PdLibReleaseContext API */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) void PdLibReleaseContext
+#elif defined(_DLL)
+__declspec( dllexport ) void PdLibReleaseContext
+#else
+extern void PdLibReleaseContext                     /* Release context acquired from slot. */
+#endif
+(
+    PdLibContextSlot_t      *pfa_PdLibContextSlot,  /* Slot. */
+    unsigned long           fa_Ticket               /* Ticket of PdLibAcquireContext(). */
+);
+
+/* ------- PdLibGetDefocusWithContext API */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibGetDefocusWithContext
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibGetDefocusWithContext
+#else
+extern signed long PdLibGetDefocusWithContext       /* Get defocus data according to a PDAF window with validated context. */
+#endif
+(
+    PdLibContext_t          *pfa_PdLibContext,      /* Validated context. */
+    PdLibWindow_t           *pfa_PdLibWindow,       /* PDAF window. */
+    PdLibPhaseDiffData_t    *pfa_PdLibPhaseDiffData,/* Phase difference data of the window. */
+    unsigned long           fa_ImagerAnalogGain,    /* Image sensor analog gain. */
+    PdLibOutputData_t       *pfa_PdLibOutputData    /* Defocus data. */
+);
+
+/* ------- PdLibGetDefocusBatchWithContext API */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibGetDefocusBatchWithContext
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibGetDefocusBatchWithContext
+#else
+extern signed long PdLibGetDefocusBatchWithContext  /* Get defocus data of all PDAF windows in a frame with validated context. */
+#endif
+(
+    PdLibContext_t          *pfa_PdLibContext,      /* Validated context. */
+    unsigned long           fa_ImagerAnalogGain,    /* Image sensor analog gain. */
+    unsigned long           fa_WindowNum,           /* Number of windows. */
+    PdLibWindow_t           *pfa_PdLibWindow,       /* Array of PDAF windows. */
+    PdLibPhaseDiffData_t    *pfa_PdLibPhaseDiffData,/* Array of phase difference data of each window. */
+    PdLibOutputData_t       *pfa_PdLibOutputData,   /* Array of defocus data of each window. */
+    signed long             *pfa_PdLibResult        /* Array of return value of each window. */
+);
+
+/* ------- PdLibRegisterWindows API */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibRegisterWindows
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibRegisterWindows
+#else
+extern signed long PdLibRegisterWindows             /* Register fixed PDAF windows and precompute their coefficients of defocus. */
+#endif
+(
+    PdLibContext_t          *pfa_PdLibContext,      /* Validated context. */
+    unsigned long           fa_WindowNum,           /* Number of windows. */
+    PdLibWindow_t           *pfa_PdLibWindow        /* Array of PDAF windows. */
+);
+
+/* ------- PdLibGetDefocusRegisteredWindows API */
+/* Defocus is calculated as one multiply-add of precomputed slope and offset. */
+/* Compared with PdLibGetDefocus(), Defocus differs by 3 DN at most (1 DN at corner area), */
+/* as long as defocus at each knot is within the limit of signed 32 bit. */
+/* Other output data are the same as PdLibGetDefocus(). */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibGetDefocusRegisteredWindows
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibGetDefocusRegisteredWindows
+#else
+extern signed long PdLibGetDefocusRegisteredWindows /* Get defocus data of all registered PDAF windows. */
+#endif
+(
+    PdLibContext_t          *pfa_PdLibContext,      /* Validated context with registered windows. */
+    unsigned long           fa_ImagerAnalogGain,    /* Image sensor analog gain. */
+    PdLibPhaseDiffData_t    *pfa_PdLibPhaseDiffData,/* Array of phase difference data of each registered window. */
+    PdLibOutputData_t       *pfa_PdLibOutputData,   /* Array of defocus data of each registered window. */
+    signed long             *pfa_PdLibResult        /* Array of return value of each registered window. */
+);
+
+/* ------- PdLibGetCacheStatistics API */
+/* Threshold of confidence at each DefocusOKNG knot and registered window is kept in the context, */
+/* and calculated again only when analog gain is changed. Hit rate is 1 - GainChangeNum / CallNum. */
+/* As evaluation updates the cache, a context must not be used by several threads at the same time, */
+/* except a context published to a slot, whose cache and statistics are not updated. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibGetCacheStatistics
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibGetCacheStatistics
+#else
+extern signed long PdLibGetCacheStatistics          /* Get statistics of threshold cache of context. */
+#endif
+(
+    PdLibContext_t          *pfa_PdLibContext,      /* Context. */
+    PdLibCacheStatistics_t  *pfa_PdLibCacheStatistics /* Statistics of threshold cache. */
+);
+
+/* ------- PdLibGetCalibFootprint API */
+/* Slope and offset are packed at creation of context to 16 bit, or 32 bit, pairs interleaved per knot when */
+/* all values fit without loss, and evaluation reads 4 or 8 bytes per knot instead of 2 signed long. */
+/* Threshold lines copied by PdLibCreateContext() are kept in one block of all analog gains followed by */
+/* all confidences, with index of first point of each line. Contexts from image or OTP use their lines in place. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibGetCalibFootprint
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibGetCalibFootprint
+#else
+extern signed long PdLibGetCalibFootprint           /* Get memory footprint of calibration data of context. */
+#endif
+(
+    PdLibContext_t          *pfa_PdLibContext,      /* Context. */
+    PdLibCalibFootprint_t   *pfa_PdLibCalibFootprint /* Footprint of calibration data. */
+);
+
+/* ------- PdLibDumpTrace API */
+/* Each context keeps records of the last D_PD_LIB_TRACE_NUM windows evaluated with it, for debugging */
+/* of focus hunting after the fact. Records are written without lock by evaluation in any thread. Dump */
+/* copies the newest records in order of Sequence without stopping evaluation, and skips records being */
+/* written. Evaluation of defocus map is not recorded. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibDumpTrace
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibDumpTrace
+#else
+extern signed long PdLibDumpTrace                   /* Copy records of recent evaluations of context. */
+#endif
+(
+    PdLibContext_t          *pfa_PdLibContext,      /* Context. */
+    unsigned long           fa_RecordNum,           /* Size of array of records. */
+    PdLibTraceRecord_t      *pfa_PdLibTraceRecord,  /* Array of records, oldest first. */
+    unsigned long           *pfa_DumpNum            /* Number of records copied. */
+);
+
+/* ------- PdLibCreateExecutor API */
+/* Executor evaluates windows or input data in parallel with a pool of worker threads. */
+/* fa_ThreadNum is the number of threads including calling thread (1 - 64). pfa_CoreAffinity is NULL */
+/* or array of (fa_ThreadNum - 1) core numbers of worker threads, and negative number does not bind it. */
+/* Worker threads are available with POSIX threads. In other environments, evaluation is serial. */
+/* With D_PD_LIB_STATS, counters of calling thread and worker threads are allocated before it returns. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibCreateExecutor
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibCreateExecutor
+#else
+extern signed long PdLibCreateExecutor              /* Create parallel executor and its worker threads. */
+#endif
+(
+    unsigned long           fa_ThreadNum,           /* Number of threads including calling thread. */
+    signed long             *pfa_CoreAffinity,      /* Core number of each worker thread, or NULL. */
+    PdLibExecutor_t         **ppfa_PdLibExecutor    /* Created executor. */
+);
+
+/* ------- PdLibDestroyExecutor API */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) void PdLibDestroyExecutor
+#elif defined(_DLL)
+__declspec( dllexport ) void PdLibDestroyExecutor
+#else
+extern void PdLibDestroyExecutor                    /* Stop worker threads and destroy executor. */
+#endif
+(
+    PdLibExecutor_t         *pfa_PdLibExecutor      /* Executor to be destroyed. */
+);
+
+/* ------- PdLibGetDefocusBatchParallel API */
+/* Same as PdLibGetDefocusBatchWithContext(), with windows divided among threads of executor. */
+/* Results are set in input order and identical to serial evaluation. When pfa_PdLibExecutor is NULL, */
+/* windows are evaluated in calling thread. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibGetDefocusBatchParallel
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibGetDefocusBatchParallel
+#else
+extern signed long PdLibGetDefocusBatchParallel     /* Get defocus data of all PDAF windows in a frame in parallel. */
+#endif
+(
+    PdLibExecutor_t         *pfa_PdLibExecutor,     /* Executor, or NULL. */
+    PdLibContext_t          *pfa_PdLibContext,      /* Validated context. */
+    unsigned long           fa_ImagerAnalogGain,    /* Image sensor analog gain. */
+    unsigned long           fa_WindowNum,           /* Number of windows. */
+    PdLibWindow_t           *pfa_PdLibWindow,       /* Array of PDAF windows. */
+    PdLibPhaseDiffData_t    *pfa_PdLibPhaseDiffData,/* Array of phase difference data of each window. */
+    PdLibOutputData_t       *pfa_PdLibOutputData,   /* Array of defocus data of each window. */
+    signed long             *pfa_PdLibResult        /* Array of return value of each window. */
+);
+
+/* ------- PdLibGetDefocusParallel API */
+/* PdLibGetDefocus() of each input data, divided among threads of executor. Input data may have */
+/* different calibration data, such as frames of several cameras. Results are set in input order */
+/* and identical to serial evaluation. When pfa_PdLibExecutor is NULL, they are evaluated in calling thread. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) void PdLibGetDefocusParallel
+#elif defined(_DLL)
+__declspec( dllexport ) void PdLibGetDefocusParallel
+#else
+extern void PdLibGetDefocusParallel                 /* Get defocus data of array of input data in parallel. */
+#endif
+(
+    PdLibExecutor_t         *pfa_PdLibExecutor,     /* Executor, or NULL. */
+    unsigned long           fa_InputNum,            /* Number of input data. */
+    PdLibInputData_t        *pfa_PdLibInputData,    /* Array of input data. */
+    PdLibOutputData_t       *pfa_PdLibOutputData,   /* Array of defocus data of each input data. */
+    signed long             *pfa_PdLibResult        /* Array of return value of PdLibGetDefocus() of each input data. */
+);
+
+/* ------- PdLibRegisterDefocusMap API */
+/* Image is divided into fa_XCellNum x fa_YCellNum cells of defocus map, and into fa_XSampleNum x fa_YSampleNum */
+/* samples of phase difference in the same way: cell i covers i * XSizeOfImage / fa_XCellNum to */
+/* (i+1) * XSizeOfImage / fa_XCellNum - 1, and likewise in y-direction. Each cell takes the sample which */
+/* contains its center. Knots are searched once for each column and row of cells, and slope and offset */
+/* of each cell are kept in the context as those of registered windows. Map registered before is released. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibRegisterDefocusMap
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibRegisterDefocusMap
+#else
+extern signed long PdLibRegisterDefocusMap          /* Register defocus map and precompute coefficients of its cells. */
+#endif
+(
+    PdLibContext_t          *pfa_PdLibContext,      /* Validated context. */
+    unsigned long           fa_XCellNum,            /* Number of cells in x-direction. 1 - XSizeOfImage. */
+    unsigned long           fa_YCellNum,            /* Number of cells in y-direction. 1 - YSizeOfImage. */
+    unsigned long           fa_XSampleNum,          /* Number of samples in x-direction. 1 - XSizeOfImage. */
+    unsigned long           fa_YSampleNum           /* Number of samples in y-direction. 1 - YSizeOfImage. */
+);
+
+/* ------- PdLibGetDefocusMap API */
+/* Defocus and DefocusConfidenceLevel of each cell are the same as PdLibGetDefocusRegisteredWindows() */
+/* for a window of the cell with its sample. DefocusConfidenceLevel is 0 when PhaseDifference is PdErrorValue */
+/* or confidence is not judged (NCW), and the cell is confident when it is 1024 or more. Tiles of rows */
+/* of cells are divided among threads of executor, and evaluated in calling thread when it is NULL. */
+/* Maps are arrays of fa_YCellNum rows of fa_XCellNum cells, and samples are arrays in the same order. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibGetDefocusMap
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibGetDefocusMap
+#else
+extern signed long PdLibGetDefocusMap               /* Get defocus map and defocus confidence level map. */
+#endif
+(
+    PdLibExecutor_t         *pfa_PdLibExecutor,     /* Executor, or NULL. */
+    PdLibContext_t          *pfa_PdLibContext,      /* Validated context with registered defocus map. */
+    unsigned long           fa_ImagerAnalogGain,    /* Image sensor analog gain. */
+    PdLibPhaseDiffData_t    *pfa_PdLibPhaseDiffData,/* Array of samples of phase difference. */
+    signed long             *pfa_DefocusMap,        /* Array of defocus of each cell. */
+    unsigned long           *pfa_ConfidenceLevelMap /* Array of DefocusConfidenceLevel of each cell. */
+);
+
+/* ------- PdLibGetPhaseDiff API */
+/* Phase difference is computed from raw left and right sub-images of dual-pixel or shielded-pixel sensors. */
+/* Rows of a window are averaged to line profiles, and the left profile is correlated with the right profile */
+/* shifted by each disparity of the search range. Peak of the minimum cost is interpolated to sub-pixel */
+/* (equiangular line for SAD, parabola for SSD), and PhaseDifference is disparity * PhaseDiffScale, */
+/* positive when the right sub-image is shifted to the right. ConfidenceLevel is the slope of cost at the peak, */
+/* which grows with contrast. Windows whose peak is at the end of the search range, which are flat, or which */
+/* have too few columns inside sub-images for the search range, get PdErrorValue and ConfidenceLevel 0. */
+/* Results are input data of PdLibGetDefocus() and batch APIs, so the same conversion to defocus applies. */
+/* Windows are divided among threads of executor, and evaluated in calling thread when it is NULL. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibGetPhaseDiff
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibGetPhaseDiff
+#else
+extern signed long PdLibGetPhaseDiff                /* Get phase difference of windows from PD image. */
+#endif
+(
+    PdLibExecutor_t         *pfa_PdLibExecutor,     /* Executor, or NULL. */
+    const PdLibPdImage_t    *pfa_PdLibPdImage,      /* Left and right sub-images. */
+    const PdLibPdParam_t    *pfa_PdLibPdParam,      /* Parameter of disparity search. */
+    unsigned long           fa_WindowNum,           /* Number of PDAF windows. */
+    PdLibWindow_t           *pfa_PdLibWindow,       /* Array of PDAF windows in all-pixel mode. */
+    PdLibPhaseDiffData_t    *pfa_PdLibPhaseDiffData /* Array of phase difference and confidence level of each window. */
+);
+
+/* ------- PdLibGetPhaseDiffPyramid API */
+/* Same as PdLibGetPhaseDiff() with coarse-to-fine search of fa_LevelNum levels. Level l decimates */
+/* line profiles by 2^l after [1 3 3 1] filter. The coarsest level searches the whole range, and each */
+/* finer level searches only 2 shifts of its own around disparity of the coarser level, so cost hardly */
+/* depends on defocus. SearchRange is rounded up to a multiple of 2^(fa_LevelNum-1). Level of each window */
+/* is the finest level whose peak was in its band, and ConfidenceLevel is normalized to level 0. */
+/* Narrow windows use fewer levels. fa_LevelNum 1 is the same as PdLibGetPhaseDiff(). */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibGetPhaseDiffPyramid
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibGetPhaseDiffPyramid
+#else
+extern signed long PdLibGetPhaseDiffPyramid         /* Get phase difference of windows from PD image by coarse-to-fine search. */
+#endif
+(
+    PdLibExecutor_t         *pfa_PdLibExecutor,     /* Executor, or NULL. */
+    const PdLibPdImage_t    *pfa_PdLibPdImage,      /* Left and right sub-images. */
+    const PdLibPdParam_t    *pfa_PdLibPdParam,      /* Parameter of disparity search. */
+    unsigned long           fa_LevelNum,            /* Number of levels. 1 - D_PD_LIB_PD_LEVEL_NUM_MAX. */
+    unsigned long           fa_WindowNum,           /* Number of PDAF windows. */
+    PdLibWindow_t           *pfa_PdLibWindow,       /* Array of PDAF windows in all-pixel mode. */
+    PdLibPhaseDiffData_t    *pfa_PdLibPhaseDiffData,/* Array of phase difference and confidence level of each window. */
+    unsigned char           *pfa_Level              /* Array of level of result of each window (0 : full resolution), or NULL. */
+);
+
+/* ------- PdLibGetDefocusRoi API */
+/* Output data of a batch are reduced to one defocus of each ROI, such as a face or a touched area, which is */
+/* made of several windows. Windows vote with their DefocusConfidenceLevel as weight, and windows of errors, */
+/* NCW or level 0 do not vote. Windows farther than 3 times weighted median absolute deviation (+1 DN) from */
+/* weighted median are rejected as outliers, and Defocus is weighted mean of the rest. DefocusConfidence */
+/* of ROI is judged from its DefocusConfidenceLevel as that of a window, and ROI without votes gets -ELDCL */
+/* with level 0. Output data may come from any batch API, and pfa_PdLibResult may be NULL if they have */
+/* no error. Nothing is allocated, and only windows of ROIs are read. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibGetDefocusRoi
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibGetDefocusRoi
+#else
+extern signed long PdLibGetDefocusRoi               /* Get defocus of ROIs from defocus data of windows. */
+#endif
+(
+    unsigned long           fa_WindowNum,           /* Number of windows of the batch. */
+    PdLibOutputData_t       *pfa_PdLibOutputData,   /* Array of defocus data of each window. */
+    signed long             *pfa_PdLibResult,       /* Array of return value of each window, or NULL. */
+    unsigned long           fa_RoiNum,              /* Number of ROIs. */
+    PdLibRoi_t              *pfa_PdLibRoi,          /* Array of ROIs. */
+    PdLibRoiData_t          *pfa_PdLibRoiData       /* Array of defocus data of each ROI. */
+);
+
+/* ------- PdLibCreateTracker API */
+/* Tracker keeps an alpha-beta filter of defocus for each of fa_WindowNum windows, such as registered windows */
+/* or cells of a map, in one cache-aligned array of 32 bytes per window. Windows start not tracked. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibCreateTracker
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibCreateTracker
+#else
+extern signed long PdLibCreateTracker               /* Create temporal tracker of defocus of windows. */
+#endif
+(
+    const PdLibTrackerParam_t *pfa_PdLibTrackerParam,   /* Parameter of filter. */
+    unsigned long           fa_WindowNum,           /* Number of windows. 1 or more. */
+    PdLibTracker_t          **ppfa_PdLibTracker     /* Created tracker. */
+);
+
+/* ------- PdLibDestroyTracker API */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) void PdLibDestroyTracker
+#elif defined(_DLL)
+__declspec( dllexport ) void PdLibDestroyTracker
+#else
+extern void PdLibDestroyTracker                     /* Destroy tracker. */
+#endif
+(
+    PdLibTracker_t          *pfa_PdLibTracker       /* Tracker to be destroyed. */
+);
+
+/* ------- PdLibResetTracker API */
+/* All windows are no longer tracked, e.g. after sensor mode or calibration is changed. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibResetTracker
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibResetTracker
+#else
+extern signed long PdLibResetTracker                /* Reset all windows of tracker. */
+#endif
+(
+    PdLibTracker_t          *pfa_PdLibTracker       /* Tracker. */
+);
+
+/* ------- PdLibUpdateTracker API */
+/* Each window is predicted from its defocus and its change per frame, minus fa_LensDelta which the lens */
+/* moved since the previous frame (positive in the direction of positive defocus). Defocus of a confident */
+/* window (result OK and DefocusConfidence OK) corrects the prediction by Alpha and Beta scaled by its level, */
+/* and other windows keep the prediction for HoldNum frames. The first confident defocus, or one farther than */
+/* ResetThr from the prediction, restarts the window. Filter runs in 1/256 DN fixed point, so results are */
+/* the same on all platforms. Output data may come from any batch API in the same order of windows, */
+/* and pfa_PdLibResult may be NULL if they have no error. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibUpdateTracker
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibUpdateTracker
+#else
+extern signed long PdLibUpdateTracker               /* Update tracker by defocus data of a frame. */
+#endif
+(
+    PdLibTracker_t          *pfa_PdLibTracker,      /* Tracker. */
+    signed long             fa_LensDelta,           /* Lens movement since previous frame. Unit is DN. */
+    unsigned long           fa_WindowNum,           /* Number of windows. Same as PdLibCreateTracker(). */
+    PdLibOutputData_t       *pfa_PdLibOutputData,   /* Array of defocus data of each window. */
+    signed long             *pfa_PdLibResult,       /* Array of return value of each window, or NULL. */
+    PdLibTrackData_t        *pfa_PdLibTrackData     /* Array of tracked defocus of each window. */
+);
+
+/* ------- PdLibCreateRecorder API */
+/* Recorder writes a compact binary stream of input data of PDAF Library, such as frames of a field failure, */
+/* which is replayed offline by PdLibReplay(). Each calibration data is written once as a calibration image */
+/* and referred to by its id, and each frame is written as deltas from the previous frame. Calibration data */
+/* of the same values and table pointers as one recorded before is not serialized again, so call */
+/* PdLibInvalidateRecorderCalib() after changing contents of tables in place. Records are buffered and */
+/* written by fa_Write, which is called in the thread calling the recorder. A recorder is used by one thread */
+/* at a time. Format is described in PdafRecord.h. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibCreateRecorder
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibCreateRecorder
+#else
+extern signed long PdLibCreateRecorder              /* Create recorder of input data. */
+#endif
+(
+    PdLibRecordWrite_t      fa_Write,               /* Function writing record stream, such as to a file. */
+    void                    *pfa_User,              /* First argument of fa_Write. */
+    PdLibRecorder_t         **ppfa_PdLibRecorder    /* Created recorder. */
+);
+
+/* ------- PdLibDestroyRecorder API */
+/* Buffered records are written before destruction. Call PdLibFlushRecorder() first to know their result. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) void PdLibDestroyRecorder
+#elif defined(_DLL)
+__declspec( dllexport ) void PdLibDestroyRecorder
+#else
+extern void PdLibDestroyRecorder                    /* Destroy recorder. */
+#endif
+(
+    PdLibRecorder_t         *pfa_PdLibRecorder      /* Recorder to be destroyed. */
+);
+
+/* ------- PdLibFlushRecorder API */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibFlushRecorder
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibFlushRecorder
+#else
+extern signed long PdLibFlushRecorder               /* Write buffered records. */
+#endif
+(
+    PdLibRecorder_t         *pfa_PdLibRecorder      /* Recorder. */
+);
+
+/* ------- PdLibInvalidateRecorderCalib API */
+/* Tables of calibration data recorded before may have been changed in place or freed and reused. */
+/* Calibration data recorded next is serialized and compared with calibration images of the recorder. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibInvalidateRecorderCalib
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibInvalidateRecorderCalib
+#else
+extern signed long PdLibInvalidateRecorderCalib     /* Tell recorder that tables of calibration data are changed. */
+#endif
+(
+    PdLibRecorder_t         *pfa_PdLibRecorder      /* Recorder. */
+);
+
+/* ------- PdLibRecordBatch API */
+/* Arguments of PdLibGetDefocusBatch() are recorded as a frame. Output data and results are recorded */
+/* for comparison in replay when both are not NULL. p_DefocusOKNGThrLine of calibration data must not be NULL. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibRecordBatch
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibRecordBatch
+#else
+extern signed long PdLibRecordBatch                 /* Record a frame of windows. */
+#endif
+(
+    PdLibRecorder_t         *pfa_PdLibRecorder,     /* Recorder. */
+    PdLibCalibData_t        *pfa_PdLibCalibData,    /* Calibration data shared by all windows. */
+    unsigned long           fa_ImagerAnalogGain,    /* Image sensor analog gain. */
+    unsigned long           fa_WindowNum,           /* Number of windows. */
+    PdLibWindow_t           *pfa_PdLibWindow,       /* Array of PDAF windows. */
+    PdLibPhaseDiffData_t    *pfa_PdLibPhaseDiffData,/* Array of phase difference data of each window. */
+    PdLibOutputData_t       *pfa_PdLibOutputData,   /* Array of defocus data of each window, or NULL. */
+    signed long             *pfa_PdLibResult        /* Array of return value of each window, or NULL. */
+);
+
+/* ------- PdLibRecordInput API */
+/* Input data of PdLibGetDefocus() are recorded with the contents of their tables. Consecutive input data */
+/* with the same calibration data and analog gain are recorded as a frame. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibRecordInput
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibRecordInput
+#else
+extern signed long PdLibRecordInput                 /* Record array of input data. */
+#endif
+(
+    PdLibRecorder_t         *pfa_PdLibRecorder,     /* Recorder. */
+    unsigned long           fa_InputNum,            /* Number of input data. */
+    PdLibInputData_t        *pfa_PdLibInputData,    /* Array of input data. */
+    PdLibOutputData_t       *pfa_PdLibOutputData,   /* Array of defocus data of each input data, or NULL. */
+    signed long             *pfa_PdLibResult        /* Array of return value of each input data, or NULL. */
+);
+
+/* ------- PdLibReplay API */
+/* Frames of record stream are evaluated by PdLibGetDefocus() of each window, PdLibGetDefocusBatch(), */
+/* or PdLibGetDefocusBatchParallel() with a validated context of each calibration and executor (or NULL). */
+/* Frames whose calibration is not valid as a context are evaluated by PdLibGetDefocusBatch() in parallel mode. */
+/* Output data and results are compared bit for bit with recorded ones. Sensor profile must be the same */
+/* as the recording. Calibration images are copied, so the stream may have any alignment. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibReplay
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibReplay
+#else
+extern signed long PdLibReplay                      /* Replay record stream and compare output data. */
+#endif
+(
+    PdLibExecutor_t         *pfa_PdLibExecutor,     /* Executor, or NULL. */
+    const void              *pfa_Stream,            /* Record stream. */
+    unsigned long           fa_StreamSize,          /* Size of record stream. */
+    unsigned char           fa_Mode,                /* D_PD_LIB_REPLAY_XXX. */
+    PdLibReplayStats_t      *pfa_PdLibReplayStats   /* Statistics of comparison. */
+);
+
+/* ------- PdLibGetCalibImageSize API */
+/* Calibration image is a versioned binary file of calibration data of several sensor modes, */
+/* which is used by PdLibCreateContextFromImage() without parsing or copying. Tables are aligned */
+/* and in native byte order and size of long, so an image is written on the platform which reads it. */
+/* Format is described in PdafCalibImage.h. p_DefocusOKNGThrLine of each calibration data must not be NULL. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibGetCalibImageSize
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibGetCalibImageSize
+#else
+extern signed long PdLibGetCalibImageSize           /* Get size of calibration image of sensor modes. */
+#endif
+(
+    unsigned long           fa_ModeNum,             /* Number of sensor modes. */
+    PdLibCalibData_t        *pfa_PdLibCalibData,    /* Array of calibration data of each sensor mode. */
+    unsigned long           *pfa_ImageSize          /* Size of calibration image. */
+);
+
+/* ------- PdLibWriteCalibImage API */
+/* pfa_Image must be aligned to 8 bytes and have the size of PdLibGetCalibImageSize(). */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibWriteCalibImage
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibWriteCalibImage
+#else
+extern signed long PdLibWriteCalibImage             /* Write calibration image of sensor modes. */
+#endif
+(
+    unsigned long           fa_ModeNum,             /* Number of sensor modes. */
+    PdLibCalibData_t        *pfa_PdLibCalibData,    /* Array of calibration data of each sensor mode. */
+    unsigned long           *pfa_SensorMode,        /* Array of sensor mode number of each calibration data. */
+    unsigned long           fa_ImageSize,           /* Size of buffer of calibration image. */
+    void                    *pfa_Image              /* Calibration image. */
+);
+
+/* ------- PdLibCheckCalibImage API */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibCheckCalibImage
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibCheckCalibImage
+#else
+extern signed long PdLibCheckCalibImage             /* Check header and checksum of calibration image. */
+#endif
+(
+    const void              *pfa_Image,             /* Calibration image aligned to 8 bytes. */
+    unsigned long           fa_ImageSize            /* Size of calibration image. */
+);
+
+/* ------- PdLibMapCalibImage API */
+/* File is mapped with mmap() on POSIX platforms, and read to allocated memory on others. */
+/* Header and checksum are checked, and the image is unmapped when they are invalid. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibMapCalibImage
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibMapCalibImage
+#else
+extern signed long PdLibMapCalibImage               /* Map file of calibration image to memory and check it. */
+#endif
+(
+    const char              *pfa_Path,              /* Path of calibration image file. */
+    void                    **ppfa_Image,           /* Mapped calibration image. */
+    unsigned long           *pfa_ImageSize          /* Size of calibration image. */
+);
+
+/* ------- PdLibUnmapCalibImage API */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) void PdLibUnmapCalibImage
+#elif defined(_DLL)
+__declspec( dllexport ) void PdLibUnmapCalibImage
+#else
+extern void PdLibUnmapCalibImage                    /* Unmap calibration image mapped by PdLibMapCalibImage(). */
+#endif
+(
+    void                    *pfa_Image,             /* Mapped calibration image. */
+    unsigned long           fa_ImageSize            /* Size of calibration image. */
+);
+
+/* ------- PdLibGetStats API */
+/* Statistics are counted when PDAF Library is built with D_PD_LIB_STATS = 1. Each thread has its own */
+/* counters without lock, and counters of all threads are merged here. AreaNum and ConfidenceNum are */
+/* counted for windows which passed the check, and latency only for PdLibGetDefocus(). */
+/* When statistics are disabled, pfa_PdLibStats is cleared and -EINVALSTATS is returned. */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) signed long PdLibGetStats
+#elif defined(_DLL)
+__declspec( dllexport ) signed long PdLibGetStats
+#else
+extern signed long PdLibGetStats                    /* Get statistics of calls since last reset. */
+#endif
+(
+    PdLibStats_t            *pfa_PdLibStats         /* Statistics of calls. */
+);
+
+/* ------- PdLibResetStats API */
+#if defined __GNUC__
+__attribute__ ((visibility ("default"))) void PdLibResetStats
+#elif defined(_DLL)
+__declspec( dllexport ) void PdLibResetStats
+#else
+extern void PdLibResetStats                         /* Reset statistics of calls. */
+#endif
+(
+    void
+);
+
 #ifdef __cplusplus
 }
 #endif          /* __cplusplus */
@@ -0,0 +1,542 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef __PDAF_LIBRARY_HPP__
+#define __PDAF_LIBRARY_HPP__
+
+/* C++17 layer of PDAF Library. C API and ABI of PdafLibrary.h are not changed by this header. */
+/* D_MATH_FUNC_FIXED_POINT must be defined as same as the build of PDAF Library. */
+
+#if defined _MSVC_LANG
+#if _MSVC_LANG < 201703L
+#error "PdafLibrary.hpp needs C++17"
+#endif
+#elif __cplusplus < 201703L
+#error "PdafLibrary.hpp needs C++17"
+#endif
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "PdafLibrary.h"
+
+namespace PdLib
+{
+
+/****************************************************************/
+/*                      Context                                 */
+/****************************************************************/
+/* Owner of context, which destroys it by PdLibDestroyContext(). Move only. */
+class Context
+{
+public:
+    Context () noexcept : p_Context ( nullptr ) {}
+    explicit Context ( PdLibContext_t *pfa_PdLibContext ) noexcept : p_Context ( pfa_PdLibContext ) {}
+    ~Context () { Reset (); }
+
+    Context ( const Context & ) = delete;
+    Context &operator= ( const Context & ) = delete;
+
+    Context ( Context &&fa_Other ) noexcept : p_Context ( fa_Other.Release () ) {}
+
+    Context &operator= ( Context &&fa_Other ) noexcept
+    {
+        if ( this != &fa_Other ) {
+            Reset ( fa_Other.Release () );
+        }
+        return *this;
+    }
+
+    /* Create context by PdLibCreateContext(). pfa_Context is not changed by error. */
+    static signed long Create ( PdLibCalibData_t *pfa_PdLibCalibData, Context *pfa_Context )
+    {
+        PdLibContext_t *p_PdLibContext = nullptr;
+        signed long ret;
+
+        ret = PdLibCreateContext ( pfa_PdLibCalibData, &p_PdLibContext );
+
+        if ( ret == D_PD_LIB_E_OK ) {                       /* Take ownership */
+            pfa_Context->Reset ( p_PdLibContext );
+        }
+
+        return ret;
+    }
+
+    signed long Validate () { return PdLibValidateContext ( p_Context ); }
+
+    PdLibContext_t *Get () const noexcept { return p_Context; }
+
+    explicit operator bool () const noexcept { return p_Context != nullptr; }
+
+    /* Give up ownership without destroying the context */
+    PdLibContext_t *Release () noexcept
+    {
+        PdLibContext_t *p_PdLibContext = p_Context;
+
+        p_Context = nullptr;
+
+        return p_PdLibContext;
+    }
+
+    /* Destroy the owned context, and own pfa_PdLibContext */
+    void Reset ( PdLibContext_t *pfa_PdLibContext = nullptr ) noexcept
+    {
+        if ( p_Context != nullptr && p_Context != pfa_PdLibContext ) {
+            PdLibDestroyContext ( p_Context );
+        }
+        p_Context = pfa_PdLibContext;
+    }
+
+private:
+    PdLibContext_t *p_Context;                              /* Owned context, or nullptr */
+};
+
+/****************************************************************/
+/*                      Sub functions                           */
+/****************************************************************/
+namespace Detail
+{
+
+/* Same as job_search_knot_cell() with knots of non-uniform pitch. Steps are unrolled by Num. */
+/* Start is fa_Start or later with knot[Start] < Address, and not later than fa_Start+Num-1. */
+template < unsigned short Num >
+inline unsigned short SearchKnotCell ( const signed long *pfa_AddressKnot, signed long fa_Address, unsigned short fa_Start )
+{
+    if constexpr ( Num <= 1 ) {
+        (void)pfa_AddressKnot;
+        (void)fa_Address;
+        return fa_Start;
+    } else {
+        constexpr unsigned short Half = Num / 2;
+        unsigned short Start;
+
+        Start = ( pfa_AddressKnot[fa_Start+Half] < fa_Address ) ? (unsigned short)( fa_Start+Half ) : fa_Start;
+
+        return SearchKnotCell< Num - Half > ( pfa_AddressKnot, fa_Address, Start );
+    }
+}
+
+/* Same as calc_line_in_cell() of PdafMathFunc.c with double, x0 <= x <= x1 and x0 < x1 */
+inline signed long CalcLineInCell ( signed long fa_X0, signed long fa_X1, signed long fa_Y0, signed long fa_Y1, signed long fa_X )
+{
+    double yy;
+
+    /* y = y0 + (y1 - y0) * (x - x0) / (x1 - x0) */
+    yy  = (double)fa_Y0
+        + ((double)fa_Y1 - (double)fa_Y0)
+        * ((double)fa_X  - (double)fa_X0)
+        / ((double)fa_X1 - (double)fa_X0);
+
+    return (signed long)yy;
+}
+
+/* Same as limit_defocus_formula() */
+constexpr signed long LimitDefocusFormula ( double fa_Defocus )
+{
+    return ( fa_Defocus <= -2147483647.0 ) ? -2147483647
+         : ( +2147483646.0 <= fa_Defocus ) ? 2147483646
+         : (signed long)fa_Defocus;
+}
+
+/* Same as limit_defocus_confidence_level() */
+constexpr unsigned long LimitDefocusConfidenceLevel ( double fa_DefocusConfidenceLevel )
+{
+    return ( fa_DefocusConfidenceLevel <= 0.0 ) ? 0
+         : ( +4294967294.0 <= fa_DefocusConfidenceLevel ) ? 0xFFFFFFFE
+         : (unsigned long)fa_DefocusConfidenceLevel;
+}
+
+/* Same as CalcAddressOnBrokenLine_ulXulY() of threshold line with 0 for invalid line */
+inline signed long CalcThrOnLine ( const unsigned long *pfa_Gain, const unsigned long *pfa_Conf, unsigned long fa_PointNum, unsigned long fa_Gain )
+{
+    unsigned long i;
+
+    if ( fa_PointNum < 2 || 0x7FFFFFFF < pfa_Gain[fa_PointNum-1] || 0x7FFFFFFF < fa_Gain ) {
+        return 0;
+    }
+    for ( i = 0; i < fa_PointNum; i++ ) {
+        if ( 0x7FFFFFFF < pfa_Conf[i] || ( i + 1 < fa_PointNum && pfa_Gain[i+1] < pfa_Gain[i] ) ) {
+            return 0;
+        }
+    }
+
+    if ( fa_Gain < pfa_Gain[0] ) {
+        return (signed long)pfa_Conf[0];
+    }
+    if ( pfa_Gain[fa_PointNum-1] < fa_Gain ) {
+        return (signed long)pfa_Conf[fa_PointNum-1];
+    }
+
+    for ( i = 0; i < fa_PointNum-1; i++ ) {
+        if ( pfa_Gain[i] <= fa_Gain && fa_Gain <= pfa_Gain[i+1] ) {
+            signed long x0 = (signed long)pfa_Gain[i];
+            signed long x1 = (signed long)pfa_Gain[i+1];
+            signed long y0 = (signed long)pfa_Conf[i];
+            signed long y1 = (signed long)pfa_Conf[i+1];
+            signed long y;
+
+            /* Same as CalcAddressOnLine_slXslY() */
+            if ( y0 == y1 ) {
+                y = y0;
+            } else if ( x0 == x1 ) {
+                y = ( y0 + y1 ) / 2;
+            } else {
+                y = CalcLineInCell ( x0, x1, y0, y1, (signed long)fa_Gain );
+            }
+
+            return ( y <= 0 ) ? 0 : y;
+        }
+    }
+
+    return 0;
+}
+
+} /* namespace Detail */
+
+/****************************************************************/
+/*                      FixedGridEvaluator                      */
+/****************************************************************/
+/* Evaluator of calibration data whose numbers of knots and sensor mode are fixed at compile time, */
+/* like FixedGridEvaluator< 8, 6, 3, 3, 2304, 2304 >. Knot search is unrolled by the numbers of knots, */
+/* AdjCoeffSlope * Slope of each knot is calculated at creation, and branches of OK/NG knots and */
+/* DensityOfPhasePix are folded. Output data and return values are the same as */
+/* PdLibGetDefocusBatchWithContext() of the owned context. */
+/* With D_MATH_FUNC_FIXED_POINT, evaluation is forwarded to PdLibGetDefocusBatchWithContext(). */
+/* The owned context may be used by other APIs, but the evaluator keeps calibration data, sensor mode */
+/* and sensor profile given to Create(). */
+template < unsigned short XKnotNum, unsigned short YKnotNum,
+           unsigned short XKnotNumOkNg, unsigned short YKnotNumOkNg,
+           signed long AdjCoeffSlope, unsigned long DensityOfPhasePix >
+class FixedGridEvaluator
+{
+    static_assert ( 2 <= XKnotNum && 2 <= YKnotNum, "Knots of slope and offset must be 2 or more in each direction" );
+    static_assert ( ( XKnotNumOkNg == 0 && YKnotNumOkNg == 0 ) || ( XKnotNumOkNg == 1 && YKnotNumOkNg == 1 ) ||
+                    ( 2 <= XKnotNumOkNg && 2 <= YKnotNumOkNg ), "Knots of DefocusOKNG must be 0x0, 1x1 or 2 or more in each direction" );
+    static_assert ( (unsigned long)XKnotNum * YKnotNum <= 0xFFFF, "Too many knots of slope and offset" );
+
+public:
+    static constexpr unsigned long KnotNum = (unsigned long)XKnotNum * YKnotNum;
+    static constexpr unsigned long LineNum = (unsigned long)XKnotNumOkNg * YKnotNumOkNg;
+
+    FixedGridEvaluator () : ValidateResult ( -EINVALCTX ), PdErrorPhaseDiff ( 0 ), XSizeOfImage ( 0 ), YSizeOfImage ( 0 ),
+                            XAddressKnot (), YAddressKnot (), SlopeCoeff (), Offset (), XAddressKnotOkNg (), YAddressKnotOkNg (),
+                            LineStart (), ThrCache (), ThrCacheGain ( 0 ), ThrCacheValid ( 0 ) {}
+
+    /* Create context of pfa_PdLibCalibData with pfa_Profile (built-in default profile for nullptr), */
+    /* validate it and check that it matches the template arguments. Error of validation is returned as is. */
+    /* Different number of knots returns -EINVALCTX, different AdjCoeffSlope -EINACS and */
+    /* different DensityOfPhasePix -EINDOP. pfa_Evaluator is not changed by error. */
+    static signed long Create ( PdLibCalibData_t *pfa_PdLibCalibData, const PdLibSensorProfile_t *pfa_Profile,
+                                FixedGridEvaluator *pfa_Evaluator )
+    {
+        FixedGridEvaluator Evaluator;
+        PdLibSensorProfile_t Profile;
+        signed long ret;
+        unsigned long i;
+
+        if ( pfa_Profile != nullptr ) {
+            Profile = (*pfa_Profile);
+        } else {
+            PdLibGetSensorProfile ( D_PD_LIB_SENSOR_PROFILE_DEFAULT, &Profile );
+        }
+
+        ret = Context::Create ( pfa_PdLibCalibData, &Evaluator.PdLibContext );
+
+        if ( ret == D_PD_LIB_E_OK ) {                       /* Same profile as the evaluator */
+            ret = PdLibSetContextSensorProfile ( Evaluator.PdLibContext.Get (), &Profile );
+        }
+        if ( ret == D_PD_LIB_E_OK ) {
+            ret = Evaluator.PdLibContext.Validate ();
+        }
+        if ( ret == D_PD_LIB_E_OK ) {                       /* Check numbers of knots */
+            if ( (*pfa_PdLibCalibData).XKnotNumSlopeOffset != XKnotNum || (*pfa_PdLibCalibData).YKnotNumSlopeOffset != YKnotNum ||
+                 (*pfa_PdLibCalibData).XKnotNumDefocusOKNG != XKnotNumOkNg || (*pfa_PdLibCalibData).YKnotNumDefocusOKNG != YKnotNumOkNg ) {
+                ret = -EINVALCTX;
+            } else if ( (*pfa_PdLibCalibData).AdjCoeffSlope != AdjCoeffSlope ) {
+                ret = -EINACS;
+            } else if ( (*pfa_PdLibCalibData).DensityOfPhasePix != DensityOfPhasePix ) {
+                ret = -EINDOP;
+            }
+        }
+        if ( ret != D_PD_LIB_E_OK ) {
+            return ret;
+        }
+
+        Evaluator.ValidateResult   = D_PD_LIB_E_OK;
+        Evaluator.PdErrorPhaseDiff = Profile.PdErrorValue * 16;
+        Evaluator.XSizeOfImage     = (*pfa_PdLibCalibData).XSizeOfImage;
+        Evaluator.YSizeOfImage     = (*pfa_PdLibCalibData).YSizeOfImage;
+
+        for ( i = 0; i < XKnotNum; i++ ) {
+            Evaluator.XAddressKnot[i] = (*pfa_PdLibCalibData).p_XAddressKnotSlopeOffset[i];
+        }
+        for ( i = 0; i < YKnotNum; i++ ) {
+            Evaluator.YAddressKnot[i] = (*pfa_PdLibCalibData).p_YAddressKnotSlopeOffset[i];
+        }
+        for ( i = 0; i < KnotNum; i++ ) {                   /* First product of calc_defocus_formula() */
+            Evaluator.SlopeCoeff[i] = (double)AdjCoeffSlope * (double)(*pfa_PdLibCalibData).p_SlopeData[i];
+            Evaluator.Offset[i]     = (double)(*pfa_PdLibCalibData).p_OffsetData[i];
+        }
+
+        if constexpr ( 2 <= XKnotNumOkNg ) {
+            for ( i = 0; i < XKnotNumOkNg; i++ ) {
+                Evaluator.XAddressKnotOkNg[i] = (*pfa_PdLibCalibData).p_XAddressKnotDefocusOKNG[i];
+            }
+            for ( i = 0; i < YKnotNumOkNg; i++ ) {
+                Evaluator.YAddressKnotOkNg[i] = (*pfa_PdLibCalibData).p_YAddressKnotDefocusOKNG[i];
+            }
+        }
+
+        for ( i = 0; i < LineNum; i++ ) {                   /* Lines in one block */
+            const DefocusOKNGThrLine_t *p_Line = &((*pfa_PdLibCalibData).p_DefocusOKNGThrLine[i]);
+
+            Evaluator.LineStart[i] = Evaluator.LineGain.size ();
+            Evaluator.LineGain.insert ( Evaluator.LineGain.end (), (*p_Line).p_AnalogGain, (*p_Line).p_AnalogGain + (*p_Line).PointNum );
+            Evaluator.LineConf.insert ( Evaluator.LineConf.end (), (*p_Line).p_Confidence, (*p_Line).p_Confidence + (*p_Line).PointNum );
+        }
+        Evaluator.LineStart[LineNum] = Evaluator.LineGain.size ();
+
+        (*pfa_Evaluator) = std::move ( Evaluator );
+
+        return D_PD_LIB_E_OK;
+    }
+
+    /* Owned context */
+    PdLibContext_t *GetContext () const noexcept { return PdLibContext.Get (); }
+
+    /* Same as PdLibGetDefocusBatchWithContext(). Evaluator which is not created returns -EINVALCTX. */
+    signed long GetDefocusBatch ( unsigned long fa_ImagerAnalogGain, unsigned long fa_WindowNum, const PdLibWindow_t *pfa_PdLibWindow,
+                                  const PdLibPhaseDiffData_t *pfa_PdLibPhaseDiffData, PdLibOutputData_t *pfa_PdLibOutputData,
+                                  signed long *pfa_PdLibResult )
+    {
+#if defined D_MATH_FUNC_FIXED_POINT && D_MATH_FUNC_FIXED_POINT
+        return PdLibGetDefocusBatchWithContext ( PdLibContext.Get (), fa_ImagerAnalogGain, fa_WindowNum,
+                                                 const_cast< PdLibWindow_t * > ( pfa_PdLibWindow ),
+                                                 const_cast< PdLibPhaseDiffData_t * > ( pfa_PdLibPhaseDiffData ),
+                                                 pfa_PdLibOutputData, pfa_PdLibResult );
+#else
+        unsigned long i;
+
+        if ( ValidateResult == D_PD_LIB_E_OK ) {
+            UpdateThrCache ( fa_ImagerAnalogGain );
+        }
+
+        for ( i = 0; i < fa_WindowNum; i++ ) {
+            pfa_PdLibResult[i] = GetDefocusWindow ( pfa_PdLibWindow[i], pfa_PdLibPhaseDiffData[i], &(pfa_PdLibOutputData[i]) );
+        }
+
+        return ValidateResult;
+#endif
+    }
+
+    /* Same as GetDefocusBatch() with one window. Return value of the window is returned. */
+    signed long GetDefocus ( unsigned long fa_ImagerAnalogGain, const PdLibWindow_t &fa_PdLibWindow,
+                             const PdLibPhaseDiffData_t &fa_PdLibPhaseDiffData, PdLibOutputData_t *pfa_PdLibOutputData )
+    {
+        signed long Result;
+
+        GetDefocusBatch ( fa_ImagerAnalogGain, 1, &fa_PdLibWindow, &fa_PdLibPhaseDiffData, pfa_PdLibOutputData, &Result );
+
+        return Result;
+    }
+
+private:
+    static constexpr unsigned long LineArrayNum = ( LineNum == 0 ) ? 1 : LineNum;
+    static constexpr unsigned short XKnotArrayNumOkNg = ( XKnotNumOkNg < 2 ) ? 1 : XKnotNumOkNg;
+    static constexpr unsigned short YKnotArrayNumOkNg = ( YKnotNumOkNg < 2 ) ? 1 : YKnotNumOkNg;
+    static constexpr double Density = ( DensityOfPhasePix == 0 ) ? 2304.0 : (double)DensityOfPhasePix;
+
+    /* Same as job_update_thr_cache() */
+    void UpdateThrCache ( unsigned long fa_ImagerAnalogGain )
+    {
+        unsigned long i;
+
+        if ( ThrCacheValid != 0 && ThrCacheGain == fa_ImagerAnalogGain ) {
+            return ;                                        /* Same analog gain */
+        }
+
+        for ( i = 0; i < LineNum; i++ ) {
+            ThrCache[i] = Detail::CalcThrOnLine ( &(LineGain.data ()[LineStart[i]]), &(LineConf.data ()[LineStart[i]]),
+                                                  LineStart[i+1] - LineStart[i], fa_ImagerAnalogGain );
+        }
+
+        ThrCacheGain  = fa_ImagerAnalogGain;
+        ThrCacheValid = 1;
+    }
+
+    /* Same as calc_defocus_formula() */
+    signed long CalcDefocusFormula ( unsigned long fa_Index, double fa_PhaseDifference ) const
+    {
+        return Detail::LimitDefocusFormula ( SlopeCoeff[fa_Index] * fa_PhaseDifference / 2304.0 + Offset[fa_Index] );
+    }
+
+    /* Same as job_get_defocus_batch() for a window */
+    signed long GetDefocusWindow ( const PdLibWindow_t &fa_Window, const PdLibPhaseDiffData_t &fa_PhaseDiffData, PdLibOutputData_t *pfa_OutputData ) const
+    {
+        signed long XStart;
+        signed long XEnd;
+        signed long YStart;
+        signed long YEnd;
+        signed long PointX;
+        signed long PointY;
+
+        (*pfa_OutputData).Defocus                = 0;       /* Same as job_init_output_data() */
+        (*pfa_OutputData).DefocusConfidence      = D_PD_LIB_E_NG;
+        (*pfa_OutputData).DefocusConfidenceLevel = 0;
+        (*pfa_OutputData).PhaseDifference        = 0;
+
+        if ( ValidateResult != D_PD_LIB_E_OK ) {            /* Not created */
+            return ValidateResult;
+        }
+
+        XStart = fa_Window.XAddressOfWindowStart;
+        XEnd   = fa_Window.XAddressOfWindowEnd;
+        YStart = fa_Window.YAddressOfWindowStart;
+        YEnd   = fa_Window.YAddressOfWindowEnd;
+
+        if ( !( XStart <= XEnd - 1 && XEnd <= XSizeOfImage - 1 ) ) {
+            return -EINPDAFWX;                              /* Out of range of PDAFWindowsX */
+        }
+        if ( !( YStart <= YEnd - 1 && YEnd <= YSizeOfImage - 1 ) ) {
+            return -EINPDAFWY;                              /* Out of range of PDAFWindowsY */
+        }
+
+        PointX = ( XStart + XEnd ) / 2;                     /* PDAF window center */
+        PointY = ( YStart + YEnd ) / 2;
+
+        /* Defocus of knot cell of window center limited into the knots */
+        {
+            signed long     X;
+            signed long     Y;
+            unsigned short  XKnotStart;
+            unsigned short  YKnotStart;
+            unsigned long   Index;
+            double          PhaseDifference;
+            signed long     Z1;
+            signed long     Z2;
+
+            X = ( PointX < XAddressKnot[0] ) ? XAddressKnot[0] : PointX;
+            X = ( XAddressKnot[XKnotNum-1] < X ) ? XAddressKnot[XKnotNum-1] : X;
+            Y = ( PointY < YAddressKnot[0] ) ? YAddressKnot[0] : PointY;
+            Y = ( YAddressKnot[YKnotNum-1] < Y ) ? YAddressKnot[YKnotNum-1] : Y;
+
+            XKnotStart = Detail::SearchKnotCell< XKnotNum - 1 > ( XAddressKnot.data (), X, 0 );
+            YKnotStart = Detail::SearchKnotCell< YKnotNum - 1 > ( YAddressKnot.data (), Y, 0 );
+
+            Index = (unsigned long)YKnotStart * XKnotNum + XKnotStart;
+            PhaseDifference = (double)fa_PhaseDiffData.PhaseDifference;
+
+            Z1 = Detail::CalcLineInCell ( XAddressKnot[XKnotStart], XAddressKnot[XKnotStart+1],
+                                          CalcDefocusFormula ( Index,   PhaseDifference ),
+                                          CalcDefocusFormula ( Index+1, PhaseDifference ), X );
+            Z2 = Detail::CalcLineInCell ( XAddressKnot[XKnotStart], XAddressKnot[XKnotStart+1],
+                                          CalcDefocusFormula ( Index+XKnotNum,   PhaseDifference ),
+                                          CalcDefocusFormula ( Index+XKnotNum+1, PhaseDifference ), X );
+
+            (*pfa_OutputData).Defocus = Detail::CalcLineInCell ( YAddressKnot[YKnotStart], YAddressKnot[YKnotStart+1], Z1, Z2, Y );
+        }
+
+        /* Defocus confidence. Same as job_get_defocus_confidence() */
+        if constexpr ( LineNum == 0 ) {
+            (*pfa_OutputData).DefocusConfidenceLevel = 0;
+            (*pfa_OutputData).DefocusConfidence      = -ENCWDDON;  /* NCW */
+        } else {
+            if ( fa_PhaseDiffData.PhaseDifference != PdErrorPhaseDiff ) {
+                signed long DefocusOkNgThr;
+
+                if constexpr ( LineNum == 1 ) {
+                    DefocusOkNgThr = ThrCache[0];
+                } else {
+                    signed long     X;
+                    signed long     Y;
+                    unsigned short  XKnotStart;
+                    unsigned short  YKnotStart;
+                    unsigned long   Index;
+                    signed long     Z1;
+                    signed long     Z2;
+
+                    X = ( PointX < XAddressKnotOkNg[0] ) ? XAddressKnotOkNg[0] : PointX;
+                    X = ( XAddressKnotOkNg[XKnotNumOkNg-1] < X ) ? XAddressKnotOkNg[XKnotNumOkNg-1] : X;
+                    Y = ( PointY < YAddressKnotOkNg[0] ) ? YAddressKnotOkNg[0] : PointY;
+                    Y = ( YAddressKnotOkNg[YKnotNumOkNg-1] < Y ) ? YAddressKnotOkNg[YKnotNumOkNg-1] : Y;
+
+                    XKnotStart = Detail::SearchKnotCell< XKnotNumOkNg - 1 > ( XAddressKnotOkNg.data (), X, 0 );
+                    YKnotStart = Detail::SearchKnotCell< YKnotNumOkNg - 1 > ( YAddressKnotOkNg.data (), Y, 0 );
+
+                    Index = (unsigned long)YKnotStart * XKnotNumOkNg + XKnotStart;
+
+                    Z1 = Detail::CalcLineInCell ( XAddressKnotOkNg[XKnotStart], XAddressKnotOkNg[XKnotStart+1],
+                                                  ThrCache[Index], ThrCache[Index+1], X );
+                    Z2 = Detail::CalcLineInCell ( XAddressKnotOkNg[XKnotStart], XAddressKnotOkNg[XKnotStart+1],
+                                                  ThrCache[Index+XKnotNumOkNg], ThrCache[Index+XKnotNumOkNg+1], X );
+
+                    DefocusOkNgThr = Detail::CalcLineInCell ( YAddressKnotOkNg[YKnotStart], YAddressKnotOkNg[YKnotStart+1], Z1, Z2, Y );
+                }
+
+                if ( DefocusOkNgThr <= 0 ) {
+                    (*pfa_OutputData).DefocusConfidenceLevel = 1024;   /* Max value for Zero threshold */
+                } else {
+                    (*pfa_OutputData).DefocusConfidenceLevel =
+                        Detail::LimitDefocusConfidenceLevel ( 1024.0 * (double)fa_PhaseDiffData.ConfidenceLevel * 2304.0 / Density / (double)DefocusOkNgThr );
+                }
+
+                (*pfa_OutputData).DefocusConfidence = ( 1024 <= (*pfa_OutputData).DefocusConfidenceLevel ) ? D_PD_LIB_E_OK : -ELDCL;
+            } else {                                        /* Error of phase difference */
+                (*pfa_OutputData).DefocusConfidenceLevel = 0;
+                (*pfa_OutputData).DefocusConfidence      = -EPDVALERR;
+            }
+        }
+
+        (*pfa_OutputData).PhaseDifference = fa_PhaseDiffData.PhaseDifference;
+
+        return D_PD_LIB_E_OK;
+    }
+
+    Context         PdLibContext;                           /* Owned context validated with the profile */
+    signed long     ValidateResult;                         /* D_PD_LIB_E_OK after Create() */
+    signed long     PdErrorPhaseDiff;                       /* PdErrorValue in the unit of PhaseDifference */
+    signed long     XSizeOfImage;                           /* Size of image */
+    signed long     YSizeOfImage;
+    std::array< signed long, XKnotNum > XAddressKnot;       /* Knots of slope and offset */
+    std::array< signed long, YKnotNum > YAddressKnot;
+    std::array< double, KnotNum >       SlopeCoeff;         /* AdjCoeffSlope * Slope of each knot */
+    std::array< double, KnotNum >       Offset;             /* Offset of each knot */
+    std::array< signed long, XKnotArrayNumOkNg > XAddressKnotOkNg;  /* Knots of DefocusOKNG */
+    std::array< signed long, YKnotArrayNumOkNg > YAddressKnotOkNg;
+    std::array< std::size_t, LineArrayNum + 1 > LineStart;  /* First point of each line, and the end */
+    std::vector< unsigned long >        LineGain;           /* Points of all threshold lines */
+    std::vector< unsigned long >        LineConf;
+    std::array< signed long, LineArrayNum > ThrCache;       /* Threshold of each knot for ThrCacheGain */
+    unsigned long   ThrCacheGain;
+    unsigned char   ThrCacheValid;
+};
+
+} /* namespace PdLib */
+
+#endif
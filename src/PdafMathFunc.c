@@ -30,8 +30,56 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /*                          include                             */
 /****************************************************************/
 
+#include <limits.h>
+
 #include "PdafMathFunc.h"
 
+#if ( D_MATH_FUNC_SIMD != 0 ) && ( D_MATH_FUNC_FIXED_POINT == 0 ) && defined __GNUC__ && ( defined __x86_64__ || defined __i386__ )
+#define D_MATH_FUNC_SIMD_X86                        /* AVX2 and SSE4.1 selected at runtime */
+#include <immintrin.h>
+#elif ( D_MATH_FUNC_SIMD != 0 ) && ( D_MATH_FUNC_FIXED_POINT == 0 ) && defined __GNUC__ && defined __aarch64__
+#define D_MATH_FUNC_SIMD_NEON                       /* NEON of AArch64 */
+#include <arm_neon.h>
+#endif
+
+/****************************************************************/
+/*                 local function declaration                   */
+/****************************************************************/
+
+static void calc_line_array_scalar ( unsigned long f_Start, unsigned long f_Num, signed long *pf_x0, signed long *pf_x1, signed long *pf_y0, signed long *pf_y1, signed long *pf_xx, signed long *pf_yy );
+static void calc_plane_array_scalar ( unsigned long f_Start, unsigned long f_Num, signed long *pf_x0, signed long *pf_x1, signed long *pf_y0, signed long *pf_y1, signed long *pf_z0, signed long *pf_z1, signed long *pf_z2, signed long *pf_z3, signed long *pf_xx, signed long *pf_yy, signed long *pf_zz );
+static void calc_cell_array_scalar ( unsigned long f_Start, unsigned long f_Num, signed long *pf_x0, signed long *pf_x1, signed long *pf_y0, signed long *pf_y1, signed long *pf_z0, signed long *pf_z1, signed long *pf_z2, signed long *pf_z3, signed long *pf_xx, signed long *pf_yy, signed long *pf_zz );
+static signed long calc_line_in_cell ( signed long f_x0, signed long f_x1, signed long f_y0, signed long f_y1, signed long f_xx );
+static void calc_linear_array_scalar ( unsigned long f_Start, unsigned long f_Num, double *pf_a, double *pf_b, signed long *pf_xx, signed long *pf_yy );
+static void calc_quotient_array_scalar ( unsigned long f_Start, unsigned long f_Num, double *pf_x, double f_y, signed long *pf_z, unsigned long *pf_qq );
+static void calc_correlation_array_scalar ( unsigned long f_Start, unsigned long f_Num, signed long *pf_x, signed long *pf_y, unsigned long f_ShiftNum, unsigned char f_Square, unsigned long long *pf_cost );
+
+#if defined D_MATH_FUNC_SIMD_X86 || defined D_MATH_FUNC_SIMD_NEON
+static unsigned char is_in_half_range ( unsigned long f_Num, signed long *pf_v );
+#endif
+
+#if defined D_MATH_FUNC_SIMD_X86
+static signed char get_simd_level ( void );
+static void calc_line_array_sse41 ( unsigned long f_Num, signed long *pf_x0, signed long *pf_x1, signed long *pf_y0, signed long *pf_y1, signed long *pf_xx, signed long *pf_yy );
+static void calc_line_array_avx2 ( unsigned long f_Num, signed long *pf_x0, signed long *pf_x1, signed long *pf_y0, signed long *pf_y1, signed long *pf_xx, signed long *pf_yy );
+static void calc_plane_array_sse41 ( unsigned long f_Num, signed long *pf_x0, signed long *pf_x1, signed long *pf_y0, signed long *pf_y1, signed long *pf_z0, signed long *pf_z1, signed long *pf_z2, signed long *pf_z3, signed long *pf_xx, signed long *pf_yy, signed long *pf_zz );
+static void calc_plane_array_avx2 ( unsigned long f_Num, signed long *pf_x0, signed long *pf_x1, signed long *pf_y0, signed long *pf_y1, signed long *pf_z0, signed long *pf_z1, signed long *pf_z2, signed long *pf_z3, signed long *pf_xx, signed long *pf_yy, signed long *pf_zz );
+static void calc_linear_array_sse41 ( unsigned long f_Num, double *pf_a, double *pf_b, signed long *pf_xx, signed long *pf_yy );
+static void calc_linear_array_avx2 ( unsigned long f_Num, double *pf_a, double *pf_b, signed long *pf_xx, signed long *pf_yy );
+static void calc_quotient_array_sse41 ( unsigned long f_Num, double *pf_x, double f_y, signed long *pf_z, unsigned long *pf_qq );
+static void calc_quotient_array_avx2 ( unsigned long f_Num, double *pf_x, double f_y, signed long *pf_z, unsigned long *pf_qq );
+static void calc_correlation_array_sse41 ( unsigned long f_Num, signed long *pf_x, signed long *pf_y, unsigned long f_ShiftNum, unsigned char f_Square, unsigned long long *pf_cost );
+static void calc_correlation_array_avx2 ( unsigned long f_Num, signed long *pf_x, signed long *pf_y, unsigned long f_ShiftNum, unsigned char f_Square, unsigned long long *pf_cost );
+#endif
+
+#if defined D_MATH_FUNC_SIMD_NEON
+static void calc_line_array_neon ( unsigned long f_Num, signed long *pf_x0, signed long *pf_x1, signed long *pf_y0, signed long *pf_y1, signed long *pf_xx, signed long *pf_yy );
+static void calc_plane_array_neon ( unsigned long f_Num, signed long *pf_x0, signed long *pf_x1, signed long *pf_y0, signed long *pf_y1, signed long *pf_z0, signed long *pf_z1, signed long *pf_z2, signed long *pf_z3, signed long *pf_xx, signed long *pf_yy, signed long *pf_zz );
+static void calc_linear_array_neon ( unsigned long f_Num, double *pf_a, double *pf_b, signed long *pf_xx, signed long *pf_yy );
+static void calc_quotient_array_neon ( unsigned long f_Num, double *pf_x, double f_y, signed long *pf_z, unsigned long *pf_qq );
+static void calc_correlation_array_neon ( unsigned long f_Num, signed long *pf_x, signed long *pf_y, unsigned long f_ShiftNum, unsigned char f_Square, unsigned long long *pf_cost );
+#endif
+
 /****************************************************************/
 /*                      external function                       */
 /****************************************************************/
@@ -81,6 +129,16 @@ extern void CalcAddressOnLine_slXslY
         } else if ( x1 < x ) {
             y = y1;
         } else {
+#if D_MATH_FUNC_FIXED_POINT
+            signed long long yy;
+            /* y = ( y0 * (x1 - x0) + (y1 - y0) * (x - x0) ) / (x1 - x0) */
+            /* Division truncates toward zero as same as conversion from double. */
+            yy  = (signed long long)y0
+                * ((signed long long)x1 - (signed long long)x0)
+                + ((signed long long)y1 - (signed long long)y0)
+                * ((signed long long) x - (signed long long)x0);
+            y = (signed long)( yy / ((signed long long)x1 - (signed long long)x0) );
+#else
             double yy;
             /* y = y0 + (y1 - y0) * (x - x0) / (x1 - x0) */
             yy  = (double)y0 
@@ -88,6 +146,7 @@ extern void CalcAddressOnLine_slXslY
                 * ((double) x - (double)x0) 
                 / ((double)x1 - (double)x0);
             y = (signed long)yy;
+#endif
         }
         
     }
@@ -252,3 +311,1615 @@ extern signed char CalcAddressOnPlane_slXslYslZ
 
     return D_MATH_FUNC_OK;
 }
+
+/* Function for calculating coordination at the point of the cell without branches */
+/* The point is limited into the cell, and x0 < x1 and y0 < y1 are assumed. */
+/* Inside the cell the result is the same as CalcAddressOnPlane_slXslYslZ(). */
+extern void CalcAddressOnCell_slXslYslZ
+(
+    /* Input */
+    signed long *pf_x,
+    signed long *pf_y,
+    signed long *pf_z,
+    signed long f_xx,
+    signed long f_yy,
+    /* Output */
+    signed long *pf_zz
+)
+{
+    signed long x;
+    signed long y;
+    signed long z1;
+    signed long z2;
+
+    /* Limit the point into the cell with conditional moves */
+    x = ( f_xx < pf_x[0] ) ? pf_x[0] : f_xx;
+    x = ( pf_x[1] < x    ) ? pf_x[1] : x;
+    y = ( f_yy < pf_y[0] ) ? pf_y[0] : f_yy;
+    y = ( pf_y[1] < y    ) ? pf_y[1] : y;
+
+    z1 = calc_line_in_cell ( pf_x[0], pf_x[1], pf_z[0], pf_z[1], x );
+    z2 = calc_line_in_cell ( pf_x[0], pf_x[1], pf_z[2], pf_z[3], x );
+
+    (*pf_zz) = calc_line_in_cell ( pf_y[0], pf_y[1], z1, z2, y );
+
+    return ;
+}
+
+/* Function for calculating coordination at the point of the line for arrays of lines */
+extern void CalcAddressOnLineArray_slXslY
+(
+    /* Input */
+    unsigned long f_Num,
+    signed long *pf_x0,
+    signed long *pf_x1,
+    signed long *pf_y0,
+    signed long *pf_y1,
+    signed long *pf_xx,
+    /* Output */
+    signed long *pf_yy
+)
+{
+#if defined D_MATH_FUNC_SIMD_X86
+    signed char SimdLevel;
+
+    SimdLevel = get_simd_level ();
+
+    if ( SimdLevel == 2 ) {
+        calc_line_array_avx2  ( f_Num, pf_x0, pf_x1, pf_y0, pf_y1, pf_xx, pf_yy );
+    } else if ( SimdLevel == 1 ) {
+        calc_line_array_sse41 ( f_Num, pf_x0, pf_x1, pf_y0, pf_y1, pf_xx, pf_yy );
+    } else {
+        calc_line_array_scalar ( 0, f_Num, pf_x0, pf_x1, pf_y0, pf_y1, pf_xx, pf_yy );
+    }
+#elif defined D_MATH_FUNC_SIMD_NEON
+    calc_line_array_neon ( f_Num, pf_x0, pf_x1, pf_y0, pf_y1, pf_xx, pf_yy );
+#else
+    calc_line_array_scalar ( 0, f_Num, pf_x0, pf_x1, pf_y0, pf_y1, pf_xx, pf_yy );
+#endif
+
+    return ;
+}
+
+/* Function for calculating coordination at the point of the plane for arrays of planes */
+extern void CalcAddressOnPlaneArray_slXslYslZ
+(
+    /* Input */
+    unsigned long f_Num,
+    signed long *pf_x0,
+    signed long *pf_x1,
+    signed long *pf_y0,
+    signed long *pf_y1,
+    signed long *pf_z0,
+    signed long *pf_z1,
+    signed long *pf_z2,
+    signed long *pf_z3,
+    signed long *pf_xx,
+    signed long *pf_yy,
+    /* Output */
+    signed long *pf_zz
+)
+{
+#if defined D_MATH_FUNC_SIMD_X86
+    signed char SimdLevel;
+
+    SimdLevel = get_simd_level ();
+
+    if ( SimdLevel == 2 ) {
+        calc_plane_array_avx2  ( f_Num, pf_x0, pf_x1, pf_y0, pf_y1, pf_z0, pf_z1, pf_z2, pf_z3, pf_xx, pf_yy, pf_zz );
+    } else if ( SimdLevel == 1 ) {
+        calc_plane_array_sse41 ( f_Num, pf_x0, pf_x1, pf_y0, pf_y1, pf_z0, pf_z1, pf_z2, pf_z3, pf_xx, pf_yy, pf_zz );
+    } else {
+        calc_plane_array_scalar ( 0, f_Num, pf_x0, pf_x1, pf_y0, pf_y1, pf_z0, pf_z1, pf_z2, pf_z3, pf_xx, pf_yy, pf_zz );
+    }
+#elif defined D_MATH_FUNC_SIMD_NEON
+    calc_plane_array_neon ( f_Num, pf_x0, pf_x1, pf_y0, pf_y1, pf_z0, pf_z1, pf_z2, pf_z3, pf_xx, pf_yy, pf_zz );
+#else
+    calc_plane_array_scalar ( 0, f_Num, pf_x0, pf_x1, pf_y0, pf_y1, pf_z0, pf_z1, pf_z2, pf_z3, pf_xx, pf_yy, pf_zz );
+#endif
+
+    return ;
+}
+
+/* Function for calculating coordination at the point of the cell for arrays of cells */
+/* Each element gives the same result as CalcAddressOnCell_slXslYslZ(), and each point must be in its cell. */
+/* Vector functions take multiples of 4 cells, and the remainder is calculated without branches. */
+extern void CalcAddressOnCellArray_slXslYslZ
+(
+    /* Input */
+    unsigned long f_Num,
+    signed long *pf_x0,
+    signed long *pf_x1,
+    signed long *pf_y0,
+    signed long *pf_y1,
+    signed long *pf_z0,
+    signed long *pf_z1,
+    signed long *pf_z2,
+    signed long *pf_z3,
+    signed long *pf_xx,
+    signed long *pf_yy,
+    /* Output */
+    signed long *pf_zz
+)
+{
+    unsigned long Num;
+
+    Num = 0;
+
+#if defined D_MATH_FUNC_SIMD_X86
+    {
+        signed char SimdLevel;
+
+        SimdLevel = get_simd_level ();
+        Num       = f_Num & ~3UL;                           /* Multiple of lanes of AVX2 and SSE4.1 */
+
+        if ( SimdLevel == 2 ) {
+            calc_plane_array_avx2  ( Num, pf_x0, pf_x1, pf_y0, pf_y1, pf_z0, pf_z1, pf_z2, pf_z3, pf_xx, pf_yy, pf_zz );
+        } else if ( SimdLevel == 1 ) {
+            calc_plane_array_sse41 ( Num, pf_x0, pf_x1, pf_y0, pf_y1, pf_z0, pf_z1, pf_z2, pf_z3, pf_xx, pf_yy, pf_zz );
+        } else {
+            Num = 0;
+        }
+    }
+#elif defined D_MATH_FUNC_SIMD_NEON
+    Num = f_Num & ~1UL;                                     /* Multiple of lanes of NEON */
+    calc_plane_array_neon ( Num, pf_x0, pf_x1, pf_y0, pf_y1, pf_z0, pf_z1, pf_z2, pf_z3, pf_xx, pf_yy, pf_zz );
+#endif
+
+    calc_cell_array_scalar ( Num, f_Num, pf_x0, pf_x1, pf_y0, pf_y1, pf_z0, pf_z1, pf_z2, pf_z3, pf_xx, pf_yy, pf_zz );
+
+    return ;
+}
+
+/* Function for calculating a * x + b for arrays, truncated toward zero and limited to -2147483647 - +2147483646 */
+extern void CalcLinearArray_dAdBslX
+(
+    /* Input */
+    unsigned long f_Num,
+    double *pf_a,
+    double *pf_b,
+    signed long *pf_xx,
+    /* Output */
+    signed long *pf_yy
+)
+{
+#if defined D_MATH_FUNC_SIMD_X86
+    signed char SimdLevel;
+
+    SimdLevel = get_simd_level ();
+
+    if ( SimdLevel == 2 ) {
+        calc_linear_array_avx2  ( f_Num, pf_a, pf_b, pf_xx, pf_yy );
+    } else if ( SimdLevel == 1 ) {
+        calc_linear_array_sse41 ( f_Num, pf_a, pf_b, pf_xx, pf_yy );
+    } else {
+        calc_linear_array_scalar ( 0, f_Num, pf_a, pf_b, pf_xx, pf_yy );
+    }
+#elif defined D_MATH_FUNC_SIMD_NEON
+    calc_linear_array_neon ( f_Num, pf_a, pf_b, pf_xx, pf_yy );
+#else
+    calc_linear_array_scalar ( 0, f_Num, pf_a, pf_b, pf_xx, pf_yy );
+#endif
+
+    return ;
+}
+
+#if D_MATH_FUNC_FIXED_POINT
+/* Function for calculating ( a * x + b ) / 2^D_MATH_FUNC_COEFF_FRAC_BITS for arrays of fixed-point */
+extern void CalcLinearArray_sllAsllBslX
+(
+    /* Input */
+    unsigned long f_Num,
+    signed long long *pf_a,
+    signed long long *pf_b,
+    signed long *pf_xx,
+    /* Output */
+    signed long *pf_yy
+)
+{
+    unsigned long i;
+
+    for ( i = 0; i < f_Num; i++ ) {
+        signed long long a;
+        signed long long x;
+        signed long long AbsA;
+        signed long long AbsX;
+        signed long long y;
+
+        a    = pf_a[i];
+        x    = (signed long long)pf_xx[i];
+        AbsA = ( a < 0 ) ? -a : a;
+        AbsX = ( x < 0 ) ? -x : x;
+
+        /* When the product exceeds 62 bits, y is out of limit. */
+        if ( AbsX == 0 || AbsA <= ( 0x3FFFFFFFFFFFFFFFLL / AbsX ) ) {
+            y = ( a * x + pf_b[i] ) / ( (signed long long)1 << D_MATH_FUNC_COEFF_FRAC_BITS );
+        } else if ( ( a < 0 ) == ( x < 0 ) ) {
+            y = 0x3FFFFFFFFFFFFFFFLL;                       /* Out of limit max */
+        } else {
+            y = -0x3FFFFFFFFFFFFFFFLL;                      /* Out of limit min */
+        }
+
+        if ( y <= -2147483647LL ) {
+            pf_yy[i] = -2147483647;                         /* Limit min */
+        } else if ( +2147483646LL <= y ) {
+            pf_yy[i] = 2147483646;                          /* Limit max */
+        } else {
+            pf_yy[i] = (signed long)y;
+        }
+    }
+
+    return ;
+}
+#endif
+
+/* Function for calculating x / y / z for arrays, truncated toward zero and limited to 0 - 4294967294 */
+extern void CalcQuotientArray_dXdYslZ
+(
+    /* Input */
+    unsigned long f_Num,
+    double *pf_x,
+    double f_y,
+    signed long *pf_z,
+    /* Output */
+    unsigned long *pf_qq
+)
+{
+#if defined D_MATH_FUNC_SIMD_X86
+    signed char SimdLevel;
+
+    SimdLevel = get_simd_level ();
+
+    if ( SimdLevel == 2 ) {
+        calc_quotient_array_avx2  ( f_Num, pf_x, f_y, pf_z, pf_qq );
+    } else if ( SimdLevel == 1 ) {
+        calc_quotient_array_sse41 ( f_Num, pf_x, f_y, pf_z, pf_qq );
+    } else {
+        calc_quotient_array_scalar ( 0, f_Num, pf_x, f_y, pf_z, pf_qq );
+    }
+#elif defined D_MATH_FUNC_SIMD_NEON
+    calc_quotient_array_neon ( f_Num, pf_x, f_y, pf_z, pf_qq );
+#else
+    calc_quotient_array_scalar ( 0, f_Num, pf_x, f_y, pf_z, pf_qq );
+#endif
+
+    return ;
+}
+
+/* Function for calculating costs of correlation of x with y shifted by 0 to f_ShiftNum-1 */
+extern void CalcCorrelationArray_slXslY
+(
+    /* Input */
+    unsigned long f_Num,
+    signed long *pf_x,
+    signed long *pf_y,
+    unsigned long f_ShiftNum,
+    unsigned char f_Square,
+    /* Output */
+    unsigned long long *pf_cost
+)
+{
+#if defined D_MATH_FUNC_SIMD_X86
+    signed char SimdLevel;
+
+    SimdLevel = get_simd_level ();
+
+    /* Vector functions use differences of signed 32 bit, which hold values within signed 31 bit */
+    if ( is_in_half_range ( f_Num, pf_x ) == 0 ||
+         ( f_ShiftNum != 0 && is_in_half_range ( f_Num + f_ShiftNum - 1, pf_y ) == 0 ) ) {
+        SimdLevel = 0;
+    }
+
+    if ( SimdLevel == 2 ) {
+        calc_correlation_array_avx2  ( f_Num, pf_x, pf_y, f_ShiftNum, f_Square, pf_cost );
+    } else if ( SimdLevel == 1 ) {
+        calc_correlation_array_sse41 ( f_Num, pf_x, pf_y, f_ShiftNum, f_Square, pf_cost );
+    } else {
+        calc_correlation_array_scalar ( 0, f_Num, pf_x, pf_y, f_ShiftNum, f_Square, pf_cost );
+    }
+#elif defined D_MATH_FUNC_SIMD_NEON
+    /* Vector functions use differences of signed 32 bit, which hold values within signed 31 bit */
+    if ( is_in_half_range ( f_Num, pf_x ) == 0 ||
+         ( f_ShiftNum != 0 && is_in_half_range ( f_Num + f_ShiftNum - 1, pf_y ) == 0 ) ) {
+        calc_correlation_array_scalar ( 0, f_Num, pf_x, pf_y, f_ShiftNum, f_Square, pf_cost );
+    } else {
+        calc_correlation_array_neon ( f_Num, pf_x, pf_y, f_ShiftNum, f_Square, pf_cost );
+    }
+#else
+    calc_correlation_array_scalar ( 0, f_Num, pf_x, pf_y, f_ShiftNum, f_Square, pf_cost );
+#endif
+
+    return ;
+}
+
+/****************************************************************/
+/*                       local function                         */
+/****************************************************************/
+
+/* Function for calculating lines from f_Start to f_Num-1 with scalar function */
+static void calc_line_array_scalar
+(
+    unsigned long f_Start,
+    unsigned long f_Num,
+    signed long *pf_x0,
+    signed long *pf_x1,
+    signed long *pf_y0,
+    signed long *pf_y1,
+    signed long *pf_xx,
+    signed long *pf_yy
+)
+{
+    unsigned long i;
+
+    for ( i = f_Start; i < f_Num; i++ ) {
+        signed long LineX[2];
+        signed long LineY[2];
+
+        LineX[0] = pf_x0[i];
+        LineX[1] = pf_x1[i];
+        LineY[0] = pf_y0[i];
+        LineY[1] = pf_y1[i];
+
+        CalcAddressOnLine_slXslY ( LineX, LineY, pf_xx[i], &(pf_yy[i]) );
+    }
+
+    return ;
+}
+
+/* Function for calculating planes from f_Start to f_Num-1 with scalar function */
+static void calc_plane_array_scalar
+(
+    unsigned long f_Start,
+    unsigned long f_Num,
+    signed long *pf_x0,
+    signed long *pf_x1,
+    signed long *pf_y0,
+    signed long *pf_y1,
+    signed long *pf_z0,
+    signed long *pf_z1,
+    signed long *pf_z2,
+    signed long *pf_z3,
+    signed long *pf_xx,
+    signed long *pf_yy,
+    signed long *pf_zz
+)
+{
+    unsigned long i;
+
+    for ( i = f_Start; i < f_Num; i++ ) {
+        signed long PlaneX[2];
+        signed long PlaneY[2];
+        signed long PlaneZ[4];
+
+        PlaneX[0] = pf_x0[i];
+        PlaneX[1] = pf_x1[i];
+        PlaneY[0] = pf_y0[i];
+        PlaneY[1] = pf_y1[i];
+        PlaneZ[0] = pf_z0[i];
+        PlaneZ[1] = pf_z1[i];
+        PlaneZ[2] = pf_z2[i];
+        PlaneZ[3] = pf_z3[i];
+
+        (void)CalcAddressOnPlane_slXslYslZ ( PlaneX, PlaneY, PlaneZ, pf_xx[i], pf_yy[i], &(pf_zz[i]) );
+    }
+
+    return ;
+}
+
+/* Function for calculating cells from f_Start to f_Num-1 with scalar function */
+static void calc_cell_array_scalar
+(
+    unsigned long f_Start,
+    unsigned long f_Num,
+    signed long *pf_x0,
+    signed long *pf_x1,
+    signed long *pf_y0,
+    signed long *pf_y1,
+    signed long *pf_z0,
+    signed long *pf_z1,
+    signed long *pf_z2,
+    signed long *pf_z3,
+    signed long *pf_xx,
+    signed long *pf_yy,
+    signed long *pf_zz
+)
+{
+    unsigned long i;
+
+    for ( i = f_Start; i < f_Num; i++ ) {
+        signed long CellX[2];
+        signed long CellY[2];
+        signed long CellZ[4];
+
+        CellX[0] = pf_x0[i];
+        CellX[1] = pf_x1[i];
+        CellY[0] = pf_y0[i];
+        CellY[1] = pf_y1[i];
+        CellZ[0] = pf_z0[i];
+        CellZ[1] = pf_z1[i];
+        CellZ[2] = pf_z2[i];
+        CellZ[3] = pf_z3[i];
+
+        CalcAddressOnCell_slXslYslZ ( CellX, CellY, CellZ, pf_xx[i], pf_yy[i], &(pf_zz[i]) );
+    }
+
+    return ;
+}
+
+/* Function for calculating the line at x0 <= x <= x1 with x0 < x1 without branches */
+/* The result is the same as CalcAddressOnLine_slXslY(), because the interpolation is exact */
+/* at both ends and gives y0 when y0 == y1. */
+static signed long calc_line_in_cell
+(
+    signed long f_x0,
+    signed long f_x1,
+    signed long f_y0,
+    signed long f_y1,
+    signed long f_xx
+)
+{
+#if D_MATH_FUNC_FIXED_POINT
+    signed long long yy;
+
+    /* y = ( y0 * (x1 - x0) + (y1 - y0) * (x - x0) ) / (x1 - x0) */
+    yy  = (signed long long)f_y0
+        * ((signed long long)f_x1 - (signed long long)f_x0)
+        + ((signed long long)f_y1 - (signed long long)f_y0)
+        * ((signed long long)f_xx - (signed long long)f_x0);
+
+    return (signed long)( yy / ((signed long long)f_x1 - (signed long long)f_x0) );
+#else
+    double yy;
+
+    /* y = y0 + (y1 - y0) * (x - x0) / (x1 - x0) */
+    yy  = (double)f_y0
+        + ((double)f_y1 - (double)f_y0)
+        * ((double)f_xx - (double)f_x0)
+        / ((double)f_x1 - (double)f_x0);
+
+    return (signed long)yy;
+#endif
+}
+
+/* Function for calculating a * x + b from f_Start to f_Num-1 with scalar operations */
+static void calc_linear_array_scalar
+(
+    unsigned long f_Start,
+    unsigned long f_Num,
+    double *pf_a,
+    double *pf_b,
+    signed long *pf_xx,
+    signed long *pf_yy
+)
+{
+    unsigned long i;
+
+    for ( i = f_Start; i < f_Num; i++ ) {
+        double y;
+
+        y = pf_a[i] * (double)pf_xx[i] + pf_b[i];
+
+        if ( y <= -2147483647.0 ) {
+            pf_yy[i] = -2147483647;                         /* Limit min */
+        } else if ( +2147483646.0 <= y ) {
+            pf_yy[i] = 2147483646;                          /* Limit max */
+        } else {
+            pf_yy[i] = (signed long)y;
+        }
+    }
+
+    return ;
+}
+
+/* Function for calculating x / y / z from f_Start to f_Num-1 with scalar operations */
+static void calc_quotient_array_scalar
+(
+    unsigned long f_Start,
+    unsigned long f_Num,
+    double *pf_x,
+    double f_y,
+    signed long *pf_z,
+    unsigned long *pf_qq
+)
+{
+    unsigned long i;
+
+    for ( i = f_Start; i < f_Num; i++ ) {
+        double q;
+
+        q = pf_x[i] / f_y / (double)pf_z[i];
+
+        if ( q <= 0.0 ) {
+            pf_qq[i] = 0;                                   /* Limit min */
+        } else if ( +4294967294.0 <= q ) {
+            pf_qq[i] = 0xFFFFFFFE;                          /* Limit max */
+        } else {
+            pf_qq[i] = (unsigned long)q;
+        }
+    }
+
+    return ;
+}
+
+/* Function for calculating costs of shift from f_Start to f_ShiftNum-1 with scalar operations */
+static void calc_correlation_array_scalar
+(
+    unsigned long f_Start,
+    unsigned long f_Num,
+    signed long *pf_x,
+    signed long *pf_y,
+    unsigned long f_ShiftNum,
+    unsigned char f_Square,
+    unsigned long long *pf_cost
+)
+{
+    unsigned long i;
+    unsigned long k;
+
+    for ( k = f_Start; k < f_ShiftNum; k++ ) {
+        unsigned long long Cost;
+
+        Cost = 0;
+
+        for ( i = 0; i < f_Num; i++ ) {
+            signed long long d;
+
+            d = (signed long long)pf_x[i] - (signed long long)pf_y[i+k];
+
+            if ( f_Square != 0 ) {
+                Cost += (unsigned long long)( d * d );
+            } else {
+                Cost += (unsigned long long)( ( d < 0 ) ? -d : d );
+            }
+        }
+
+        pf_cost[k] = Cost;
+    }
+
+    return ;
+}
+
+#if defined D_MATH_FUNC_SIMD_X86 || defined D_MATH_FUNC_SIMD_NEON
+/* Function for checking that values are within signed 31 bit */
+static unsigned char is_in_half_range ( unsigned long f_Num, signed long *pf_v )
+{
+    unsigned long i;
+    signed long Min;
+    signed long Max;
+
+    Min = 0;
+    Max = 0;
+
+    for ( i = 0; i < f_Num; i++ ) {
+        Min = ( pf_v[i] < Min ) ? pf_v[i] : Min;
+        Max = ( Max < pf_v[i] ) ? pf_v[i] : Max;
+    }
+
+    return ( -0x40000000L <= Min && Max <= 0x3FFFFFFFL ) ? 1 : 0;
+}
+#endif
+
+/*
+    Vector version of CalcAddressOnLine_slXslY().
+    Each lane follows the branches of the scalar function with masks, in this priority.
+
+    y0 == y1                : y0
+    x0 == x1                : (y0 + y1) / 2
+    x < min(x0, x1)         : y of the smaller x
+    max(x0, x1) < x         : y of the larger x
+    otherwise               : y0 + (y1 - y0) * (x - x0) / (x1 - x0) truncated toward zero
+
+    The same double operations are done in the same order, so results are identical.
+*/
+
+#if defined D_MATH_FUNC_SIMD_X86
+
+/* Function for detecting vector instructions. 0 : none, 1 : SSE4.1, 2 : AVX2 */
+static signed char get_simd_level ( void )
+{
+    static signed char s_SimdLevel = -1;                    /* Not detected yet. Accessed atomically. */
+    signed char SimdLevel;
+
+    SimdLevel = __atomic_load_n ( &s_SimdLevel, __ATOMIC_RELAXED );
+
+    if ( SimdLevel < 0 ) {                                  /* Threads detecting at the same time store the same level */
+        __builtin_cpu_init ();
+
+        if ( __builtin_cpu_supports ( "avx2" ) ) {
+            SimdLevel = 2;
+        } else if ( __builtin_cpu_supports ( "sse4.1" ) ) {
+            SimdLevel = 1;
+        } else {
+            SimdLevel = 0;
+        }
+
+        __atomic_store_n ( &s_SimdLevel, SimdLevel, __ATOMIC_RELAXED );
+    }
+
+    return SimdLevel;
+}
+
+/* Load 4 signed long to signed 32 bit. Lanes of pf_OutOfRange are set when a value is out of signed 32 bit. */
+__attribute__ ((target ("sse4.1"))) static __m128i load_sse41 ( signed long *pf_v, __m128i *pf_OutOfRange )
+{
+#if LONG_MAX > 0x7FFFFFFF
+    __m128 v0;
+    __m128 v1;
+    __m128i Low;
+    __m128i High;
+
+    v0   = _mm_loadu_ps ( (float *)pf_v );
+    v1   = _mm_loadu_ps ( (float *)&(pf_v[2]) );
+    Low  = _mm_castps_si128 ( _mm_shuffle_ps ( v0, v1, _MM_SHUFFLE ( 2, 0, 2, 0 ) ) );
+    High = _mm_castps_si128 ( _mm_shuffle_ps ( v0, v1, _MM_SHUFFLE ( 3, 1, 3, 1 ) ) );
+
+    /* High 32 bit of a value within signed 32 bit are the sign of low 32 bit */
+    (*pf_OutOfRange) = _mm_or_si128 ( (*pf_OutOfRange), _mm_xor_si128 ( High, _mm_srai_epi32 ( Low, 31 ) ) );
+
+    return Low;
+#else
+    (void)pf_OutOfRange;
+
+    return _mm_loadu_si128 ( (__m128i *)pf_v );
+#endif
+}
+
+/* Convert lanes 0 and 1 of 4 signed 32 bit to double */
+__attribute__ ((target ("sse4.1"))) static __m128d low_sse41 ( __m128i f_v )
+{
+    return _mm_cvtepi32_pd ( f_v );
+}
+
+/* Convert lanes 2 and 3 of 4 signed 32 bit to double */
+__attribute__ ((target ("sse4.1"))) static __m128d high_sse41 ( __m128i f_v )
+{
+    return _mm_cvtepi32_pd ( _mm_unpackhi_epi64 ( f_v, f_v ) );
+}
+
+/* Store 2 vectors of integral double to 4 signed long */
+__attribute__ ((target ("sse4.1"))) static void store_sse41 ( signed long *pf_v, __m128d f_Low, __m128d f_High )
+{
+    __m128i v;
+
+    v = _mm_unpacklo_epi64 ( _mm_cvttpd_epi32 ( f_Low ), _mm_cvttpd_epi32 ( f_High ) );
+
+#if LONG_MAX > 0x7FFFFFFF
+    _mm_storeu_si128 ( (__m128i *)pf_v,       _mm_cvtepi32_epi64 ( v ) );
+    _mm_storeu_si128 ( (__m128i *)&(pf_v[2]), _mm_cvtepi32_epi64 ( _mm_unpackhi_epi64 ( v, v ) ) );
+#else
+    _mm_storeu_si128 ( (__m128i *)pf_v, v );
+#endif
+}
+
+/* Vector version of CalcAddressOnLine_slXslY() with SSE4.1. Inlined to keep vectors in registers. */
+__attribute__ ((target ("sse4.1"), always_inline)) static inline __m128d calc_line_sse41 ( __m128d f_x0, __m128d f_x1, __m128d f_y0, __m128d f_y1, __m128d f_xx )
+{
+    __m128d Swap;
+    __m128d x0;
+    __m128d x1;
+    __m128d y0;
+    __m128d y1;
+    __m128d y;
+    __m128d Half;
+
+    Swap = _mm_cmpgt_pd ( f_x0, f_x1 );                     /* Order as x0 <= x1 */
+    x0   = _mm_blendv_pd ( f_x0, f_x1, Swap );
+    x1   = _mm_blendv_pd ( f_x1, f_x0, Swap );
+    y0   = _mm_blendv_pd ( f_y0, f_y1, Swap );
+    y1   = _mm_blendv_pd ( f_y1, f_y0, Swap );
+
+    /* y = y0 + (y1 - y0) * (x - x0) / (x1 - x0) */
+    y = _mm_add_pd ( y0, _mm_div_pd ( _mm_mul_pd ( _mm_sub_pd ( y1, y0 ), _mm_sub_pd ( f_xx, x0 ) ), _mm_sub_pd ( x1, x0 ) ) );
+    y = _mm_round_pd ( y, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC );
+
+    y = _mm_blendv_pd ( y, y1, _mm_cmplt_pd ( x1, f_xx ) ); /* x1 < x */
+    y = _mm_blendv_pd ( y, y0, _mm_cmplt_pd ( f_xx, x0 ) ); /* x < x0 */
+
+    Half = _mm_round_pd ( _mm_div_pd ( _mm_add_pd ( f_y0, f_y1 ), _mm_set1_pd ( 2.0 ) ), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC );
+
+    y = _mm_blendv_pd ( y, Half, _mm_cmpeq_pd ( f_x0, f_x1 ) ); /* x0 == x1 */
+    y = _mm_blendv_pd ( y, f_y0, _mm_cmpeq_pd ( f_y0, f_y1 ) ); /* y0 == y1 */
+
+    return y;
+}
+
+/* Function for calculating arrays of lines with SSE4.1. 4 lines in each step. */
+/* Lines with a value out of signed 32 bit are calculated by the scalar function. */
+__attribute__ ((target ("sse4.1"))) static void calc_line_array_sse41
+(
+    unsigned long f_Num,
+    signed long *pf_x0,
+    signed long *pf_x1,
+    signed long *pf_y0,
+    signed long *pf_y1,
+    signed long *pf_xx,
+    signed long *pf_yy
+)
+{
+    unsigned long i;
+
+    for ( i = 0; i + 4 <= f_Num; i += 4 ) {
+        __m128i OutOfRange;
+        __m128i x0;
+        __m128i x1;
+        __m128i y0;
+        __m128i y1;
+        __m128i xx;
+
+        OutOfRange = _mm_setzero_si128 ();
+
+        x0 = load_sse41 ( &(pf_x0[i]), &OutOfRange );
+        x1 = load_sse41 ( &(pf_x1[i]), &OutOfRange );
+        y0 = load_sse41 ( &(pf_y0[i]), &OutOfRange );
+        y1 = load_sse41 ( &(pf_y1[i]), &OutOfRange );
+        xx = load_sse41 ( &(pf_xx[i]), &OutOfRange );
+
+        if ( _mm_testz_si128 ( OutOfRange, OutOfRange ) == 0 ) {
+            calc_line_array_scalar ( i, i + 4, pf_x0, pf_x1, pf_y0, pf_y1, pf_xx, pf_yy );
+            continue ;
+        }
+
+        store_sse41 ( &(pf_yy[i]),
+                      calc_line_sse41 ( low_sse41  ( x0 ), low_sse41  ( x1 ), low_sse41  ( y0 ), low_sse41  ( y1 ), low_sse41  ( xx ) ),
+                      calc_line_sse41 ( high_sse41 ( x0 ), high_sse41 ( x1 ), high_sse41 ( y0 ), high_sse41 ( y1 ), high_sse41 ( xx ) ) );
+    }
+
+    calc_line_array_scalar ( i, f_Num, pf_x0, pf_x1, pf_y0, pf_y1, pf_xx, pf_yy ); /* Remainder */
+
+    return ;
+}
+
+/* Vector version of CalcAddressOnPlane_slXslYslZ() with SSE4.1 for 2 planes. Inlined to keep vectors in registers. */
+__attribute__ ((target ("sse4.1"), always_inline)) static inline __m128d calc_plane_sse41 ( __m128d f_x0, __m128d f_x1, __m128d f_y0, __m128d f_y1, __m128d f_z0, __m128d f_z1, __m128d f_z2, __m128d f_z3, __m128d f_xx, __m128d f_yy )
+{
+    __m128d z1;
+    __m128d z2;
+
+    z1 = calc_line_sse41 ( f_x0, f_x1, f_z0, f_z1, f_xx );
+    z2 = calc_line_sse41 ( f_x0, f_x1, f_z2, f_z3, f_xx );
+
+    return calc_line_sse41 ( f_y0, f_y1, z1, z2, f_yy );
+}
+
+/* Function for calculating arrays of planes with SSE4.1. 4 planes in each step. */
+/* Planes with a value out of signed 32 bit are calculated by the scalar function. */
+__attribute__ ((target ("sse4.1"))) static void calc_plane_array_sse41
+(
+    unsigned long f_Num,
+    signed long *pf_x0,
+    signed long *pf_x1,
+    signed long *pf_y0,
+    signed long *pf_y1,
+    signed long *pf_z0,
+    signed long *pf_z1,
+    signed long *pf_z2,
+    signed long *pf_z3,
+    signed long *pf_xx,
+    signed long *pf_yy,
+    signed long *pf_zz
+)
+{
+    unsigned long i;
+
+    for ( i = 0; i + 4 <= f_Num; i += 4 ) {
+        __m128i OutOfRange;
+        __m128i x0;
+        __m128i x1;
+        __m128i y0;
+        __m128i y1;
+        __m128i z0;
+        __m128i z1;
+        __m128i z2;
+        __m128i z3;
+        __m128i xx;
+        __m128i yy;
+
+        OutOfRange = _mm_setzero_si128 ();
+
+        x0 = load_sse41 ( &(pf_x0[i]), &OutOfRange );
+        x1 = load_sse41 ( &(pf_x1[i]), &OutOfRange );
+        y0 = load_sse41 ( &(pf_y0[i]), &OutOfRange );
+        y1 = load_sse41 ( &(pf_y1[i]), &OutOfRange );
+        z0 = load_sse41 ( &(pf_z0[i]), &OutOfRange );
+        z1 = load_sse41 ( &(pf_z1[i]), &OutOfRange );
+        z2 = load_sse41 ( &(pf_z2[i]), &OutOfRange );
+        z3 = load_sse41 ( &(pf_z3[i]), &OutOfRange );
+        xx = load_sse41 ( &(pf_xx[i]), &OutOfRange );
+        yy = load_sse41 ( &(pf_yy[i]), &OutOfRange );
+
+        if ( _mm_testz_si128 ( OutOfRange, OutOfRange ) == 0 ) {
+            calc_plane_array_scalar ( i, i + 4, pf_x0, pf_x1, pf_y0, pf_y1, pf_z0, pf_z1, pf_z2, pf_z3, pf_xx, pf_yy, pf_zz );
+            continue ;
+        }
+
+        store_sse41 ( &(pf_zz[i]),
+                      calc_plane_sse41 ( low_sse41  ( x0 ), low_sse41  ( x1 ), low_sse41  ( y0 ), low_sse41  ( y1 ),
+                                         low_sse41  ( z0 ), low_sse41  ( z1 ), low_sse41  ( z2 ), low_sse41  ( z3 ),
+                                         low_sse41  ( xx ), low_sse41  ( yy ) ),
+                      calc_plane_sse41 ( high_sse41 ( x0 ), high_sse41 ( x1 ), high_sse41 ( y0 ), high_sse41 ( y1 ),
+                                         high_sse41 ( z0 ), high_sse41 ( z1 ), high_sse41 ( z2 ), high_sse41 ( z3 ),
+                                         high_sse41 ( xx ), high_sse41 ( yy ) ) );
+    }
+
+    calc_plane_array_scalar ( i, f_Num, pf_x0, pf_x1, pf_y0, pf_y1, pf_z0, pf_z1, pf_z2, pf_z3, pf_xx, pf_yy, pf_zz ); /* Remainder */
+
+    return ;
+}
+
+/* Function for calculating a * x + b of arrays with SSE4.1. 4 elements in each step. */
+/* Limit before truncation gives the same result as the branches of the scalar function. */
+__attribute__ ((target ("sse4.1"))) static void calc_linear_array_sse41
+(
+    unsigned long f_Num,
+    double *pf_a,
+    double *pf_b,
+    signed long *pf_xx,
+    signed long *pf_yy
+)
+{
+    unsigned long i;
+
+    for ( i = 0; i + 4 <= f_Num; i += 4 ) {
+        __m128i OutOfRange;
+        __m128i xx;
+        __m128d Min;
+        __m128d Max;
+        __m128d y0;
+        __m128d y1;
+
+        OutOfRange = _mm_setzero_si128 ();
+
+        xx = load_sse41 ( &(pf_xx[i]), &OutOfRange );
+
+        if ( _mm_testz_si128 ( OutOfRange, OutOfRange ) == 0 ) {
+            calc_linear_array_scalar ( i, i + 4, pf_a, pf_b, pf_xx, pf_yy );
+            continue ;
+        }
+
+        Min = _mm_set1_pd ( -2147483647.0 );
+        Max = _mm_set1_pd ( 2147483646.0 );
+
+        y0 = _mm_add_pd ( _mm_mul_pd ( _mm_loadu_pd ( &(pf_a[i  ]) ), low_sse41  ( xx ) ), _mm_loadu_pd ( &(pf_b[i  ]) ) );
+        y1 = _mm_add_pd ( _mm_mul_pd ( _mm_loadu_pd ( &(pf_a[i+2]) ), high_sse41 ( xx ) ), _mm_loadu_pd ( &(pf_b[i+2]) ) );
+
+        store_sse41 ( &(pf_yy[i]), _mm_min_pd ( _mm_max_pd ( y0, Min ), Max ), _mm_min_pd ( _mm_max_pd ( y1, Min ), Max ) );
+    }
+
+    calc_linear_array_scalar ( i, f_Num, pf_a, pf_b, pf_xx, pf_yy ); /* Remainder */
+
+    return ;
+}
+
+/* Function for calculating x / y / z of arrays with SSE4.1. 4 elements in each step. */
+/* Quotient is truncated and shifted by 2^31 to be converted as signed 32 bit. */
+__attribute__ ((target ("sse4.1"))) static void calc_quotient_array_sse41
+(
+    unsigned long f_Num,
+    double *pf_x,
+    double f_y,
+    signed long *pf_z,
+    unsigned long *pf_qq
+)
+{
+    unsigned long i;
+
+    for ( i = 0; i + 4 <= f_Num; i += 4 ) {
+        __m128i OutOfRange;
+        __m128i z;
+        __m128d q0;
+        __m128d q1;
+        __m128i u;
+
+        OutOfRange = _mm_setzero_si128 ();
+
+        z = load_sse41 ( &(pf_z[i]), &OutOfRange );
+
+        if ( _mm_testz_si128 ( OutOfRange, OutOfRange ) == 0 ) {
+            calc_quotient_array_scalar ( i, i + 4, pf_x, f_y, pf_z, pf_qq );
+            continue ;
+        }
+
+        q0 = _mm_div_pd ( _mm_div_pd ( _mm_loadu_pd ( &(pf_x[i  ]) ), _mm_set1_pd ( f_y ) ), low_sse41  ( z ) );
+        q1 = _mm_div_pd ( _mm_div_pd ( _mm_loadu_pd ( &(pf_x[i+2]) ), _mm_set1_pd ( f_y ) ), high_sse41 ( z ) );
+        q0 = _mm_min_pd ( _mm_max_pd ( q0, _mm_setzero_pd () ), _mm_set1_pd ( 4294967294.0 ) );
+        q1 = _mm_min_pd ( _mm_max_pd ( q1, _mm_setzero_pd () ), _mm_set1_pd ( 4294967294.0 ) );
+        q0 = _mm_sub_pd ( _mm_round_pd ( q0, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC ), _mm_set1_pd ( 2147483648.0 ) );
+        q1 = _mm_sub_pd ( _mm_round_pd ( q1, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC ), _mm_set1_pd ( 2147483648.0 ) );
+        u  = _mm_unpacklo_epi64 ( _mm_cvttpd_epi32 ( q0 ), _mm_cvttpd_epi32 ( q1 ) );
+        u  = _mm_xor_si128 ( u, _mm_set1_epi32 ( (int)0x80000000 ) );
+
+#if LONG_MAX > 0x7FFFFFFF
+        _mm_storeu_si128 ( (__m128i *)&(pf_qq[i  ]), _mm_cvtepu32_epi64 ( u ) );
+        _mm_storeu_si128 ( (__m128i *)&(pf_qq[i+2]), _mm_cvtepu32_epi64 ( _mm_unpackhi_epi64 ( u, u ) ) );
+#else
+        _mm_storeu_si128 ( (__m128i *)&(pf_qq[i]), u );
+#endif
+    }
+
+    calc_quotient_array_scalar ( i, f_Num, pf_x, f_y, pf_z, pf_qq ); /* Remainder */
+
+    return ;
+}
+
+/* Load 4 signed long to double. Lanes of pf_InRange are cleared when a value is out of signed 32 bit. */
+__attribute__ ((target ("avx2"))) static __m256d load_avx2 ( signed long *pf_v, __m256i *pf_InRange )
+{
+#if LONG_MAX > 0x7FFFFFFF
+    __m256i v0;
+    __m128i v;
+
+    v0 = _mm256_loadu_si256 ( (__m256i *)pf_v );
+    v  = _mm256_castsi256_si128 ( _mm256_permutevar8x32_epi32 ( v0, _mm256_setr_epi32 ( 0, 2, 4, 6, 0, 2, 4, 6 ) ) );
+
+    /* Sign extension of low 32 bit gives the value again when it is within signed 32 bit */
+    (*pf_InRange) = _mm256_and_si256 ( (*pf_InRange), _mm256_cmpeq_epi64 ( v0, _mm256_cvtepi32_epi64 ( v ) ) );
+
+    return _mm256_cvtepi32_pd ( v );
+#else
+    (void)pf_InRange;
+
+    return _mm256_cvtepi32_pd ( _mm_loadu_si128 ( (__m128i *)pf_v ) );
+#endif
+}
+
+/* Check that all lanes of pf_InRange are set by load_avx2() */
+__attribute__ ((target ("avx2"))) static int is_in_range_avx2 ( __m256i f_InRange )
+{
+    return _mm256_testc_si256 ( f_InRange, _mm256_set1_epi32 ( -1 ) );
+}
+
+/* Store 4 integral double to signed long */
+__attribute__ ((target ("avx2"))) static void store_avx2 ( signed long *pf_v, __m256d f_v )
+{
+#if LONG_MAX > 0x7FFFFFFF
+    _mm256_storeu_si256 ( (__m256i *)pf_v, _mm256_cvtepi32_epi64 ( _mm256_cvttpd_epi32 ( f_v ) ) );
+#else
+    _mm_storeu_si128 ( (__m128i *)pf_v, _mm256_cvttpd_epi32 ( f_v ) );
+#endif
+}
+
+/* Vector version of CalcAddressOnLine_slXslY() with AVX2. Inlined to keep vectors in registers. */
+__attribute__ ((target ("avx2"), always_inline)) static inline __m256d calc_line_avx2 ( __m256d f_x0, __m256d f_x1, __m256d f_y0, __m256d f_y1, __m256d f_xx )
+{
+    __m256d Swap;
+    __m256d x0;
+    __m256d x1;
+    __m256d y0;
+    __m256d y1;
+    __m256d y;
+    __m256d Half;
+
+    Swap = _mm256_cmp_pd ( f_x0, f_x1, _CMP_GT_OQ );        /* Order as x0 <= x1 */
+    x0   = _mm256_blendv_pd ( f_x0, f_x1, Swap );
+    x1   = _mm256_blendv_pd ( f_x1, f_x0, Swap );
+    y0   = _mm256_blendv_pd ( f_y0, f_y1, Swap );
+    y1   = _mm256_blendv_pd ( f_y1, f_y0, Swap );
+
+    /* y = y0 + (y1 - y0) * (x - x0) / (x1 - x0) */
+    y = _mm256_add_pd ( y0, _mm256_div_pd ( _mm256_mul_pd ( _mm256_sub_pd ( y1, y0 ), _mm256_sub_pd ( f_xx, x0 ) ), _mm256_sub_pd ( x1, x0 ) ) );
+    y = _mm256_round_pd ( y, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC );
+
+    y = _mm256_blendv_pd ( y, y1, _mm256_cmp_pd ( x1, f_xx, _CMP_LT_OQ ) ); /* x1 < x */
+    y = _mm256_blendv_pd ( y, y0, _mm256_cmp_pd ( f_xx, x0, _CMP_LT_OQ ) ); /* x < x0 */
+
+    Half = _mm256_round_pd ( _mm256_div_pd ( _mm256_add_pd ( f_y0, f_y1 ), _mm256_set1_pd ( 2.0 ) ), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC );
+
+    y = _mm256_blendv_pd ( y, Half, _mm256_cmp_pd ( f_x0, f_x1, _CMP_EQ_OQ ) ); /* x0 == x1 */
+    y = _mm256_blendv_pd ( y, f_y0, _mm256_cmp_pd ( f_y0, f_y1, _CMP_EQ_OQ ) ); /* y0 == y1 */
+
+    return y;
+}
+
+/* Function for calculating arrays of lines with AVX2 */
+__attribute__ ((target ("avx2"))) static void calc_line_array_avx2
+(
+    unsigned long f_Num,
+    signed long *pf_x0,
+    signed long *pf_x1,
+    signed long *pf_y0,
+    signed long *pf_y1,
+    signed long *pf_xx,
+    signed long *pf_yy
+)
+{
+    unsigned long i;
+
+    for ( i = 0; i + 4 <= f_Num; i += 4 ) {
+        __m256i InRange;
+        __m256d y;
+
+        InRange = _mm256_set1_epi32 ( -1 );
+
+        y = calc_line_avx2 ( load_avx2 ( &(pf_x0[i]), &InRange ), load_avx2 ( &(pf_x1[i]), &InRange ),
+                             load_avx2 ( &(pf_y0[i]), &InRange ), load_avx2 ( &(pf_y1[i]), &InRange ), load_avx2 ( &(pf_xx[i]), &InRange ) );
+
+        if ( is_in_range_avx2 ( InRange ) == 0 ) {
+            calc_line_array_scalar ( i, i + 4, pf_x0, pf_x1, pf_y0, pf_y1, pf_xx, pf_yy );
+            continue ;
+        }
+
+        store_avx2 ( &(pf_yy[i]), y );
+    }
+
+    _mm256_zeroupper ();                                    /* Avoid penalty of SSE code after AVX */
+
+    calc_line_array_scalar ( i, f_Num, pf_x0, pf_x1, pf_y0, pf_y1, pf_xx, pf_yy ); /* Remainder */
+
+    return ;
+}
+
+/* Function for calculating arrays of planes with AVX2 */
+__attribute__ ((target ("avx2"))) static void calc_plane_array_avx2
+(
+    unsigned long f_Num,
+    signed long *pf_x0,
+    signed long *pf_x1,
+    signed long *pf_y0,
+    signed long *pf_y1,
+    signed long *pf_z0,
+    signed long *pf_z1,
+    signed long *pf_z2,
+    signed long *pf_z3,
+    signed long *pf_xx,
+    signed long *pf_yy,
+    signed long *pf_zz
+)
+{
+    unsigned long i;
+
+    for ( i = 0; i + 4 <= f_Num; i += 4 ) {
+        __m256i InRange;
+        __m256d x0;
+        __m256d x1;
+        __m256d xx;
+        __m256d z1;
+        __m256d z2;
+        __m256d z;
+
+        InRange = _mm256_set1_epi32 ( -1 );
+
+        x0 = load_avx2 ( &(pf_x0[i]), &InRange );
+        x1 = load_avx2 ( &(pf_x1[i]), &InRange );
+        xx = load_avx2 ( &(pf_xx[i]), &InRange );
+
+        z1 = calc_line_avx2 ( x0, x1, load_avx2 ( &(pf_z0[i]), &InRange ), load_avx2 ( &(pf_z1[i]), &InRange ), xx );
+        z2 = calc_line_avx2 ( x0, x1, load_avx2 ( &(pf_z2[i]), &InRange ), load_avx2 ( &(pf_z3[i]), &InRange ), xx );
+        z  = calc_line_avx2 ( load_avx2 ( &(pf_y0[i]), &InRange ), load_avx2 ( &(pf_y1[i]), &InRange ), z1, z2, load_avx2 ( &(pf_yy[i]), &InRange ) );
+
+        if ( is_in_range_avx2 ( InRange ) == 0 ) {
+            calc_plane_array_scalar ( i, i + 4, pf_x0, pf_x1, pf_y0, pf_y1, pf_z0, pf_z1, pf_z2, pf_z3, pf_xx, pf_yy, pf_zz );
+            continue ;
+        }
+
+        store_avx2 ( &(pf_zz[i]), z );
+    }
+
+    _mm256_zeroupper ();                                    /* Avoid penalty of SSE code after AVX */
+
+    calc_plane_array_scalar ( i, f_Num, pf_x0, pf_x1, pf_y0, pf_y1, pf_z0, pf_z1, pf_z2, pf_z3, pf_xx, pf_yy, pf_zz ); /* Remainder */
+
+    return ;
+}
+
+/* Function for calculating a * x + b of arrays with AVX2 */
+__attribute__ ((target ("avx2"))) static void calc_linear_array_avx2
+(
+    unsigned long f_Num,
+    double *pf_a,
+    double *pf_b,
+    signed long *pf_xx,
+    signed long *pf_yy
+)
+{
+    unsigned long i;
+
+    for ( i = 0; i + 4 <= f_Num; i += 4 ) {
+        __m256i InRange;
+        __m256d xx;
+        __m256d y;
+
+        InRange = _mm256_set1_epi32 ( -1 );
+
+        xx = load_avx2 ( &(pf_xx[i]), &InRange );
+
+        if ( is_in_range_avx2 ( InRange ) == 0 ) {
+            calc_linear_array_scalar ( i, i + 4, pf_a, pf_b, pf_xx, pf_yy );
+            continue ;
+        }
+
+        y = _mm256_add_pd ( _mm256_mul_pd ( _mm256_loadu_pd ( &(pf_a[i]) ), xx ), _mm256_loadu_pd ( &(pf_b[i]) ) );
+        y = _mm256_min_pd ( _mm256_max_pd ( y, _mm256_set1_pd ( -2147483647.0 ) ), _mm256_set1_pd ( 2147483646.0 ) );
+
+        store_avx2 ( &(pf_yy[i]), y );
+    }
+
+    _mm256_zeroupper ();                                    /* Avoid penalty of SSE code after AVX */
+
+    calc_linear_array_scalar ( i, f_Num, pf_a, pf_b, pf_xx, pf_yy ); /* Remainder */
+
+    return ;
+}
+
+/* Function for calculating x / y / z of arrays with AVX2 */
+__attribute__ ((target ("avx2"))) static void calc_quotient_array_avx2
+(
+    unsigned long f_Num,
+    double *pf_x,
+    double f_y,
+    signed long *pf_z,
+    unsigned long *pf_qq
+)
+{
+    unsigned long i;
+
+    for ( i = 0; i + 4 <= f_Num; i += 4 ) {
+        __m256i InRange;
+        __m256d z;
+        __m256d q;
+        __m128i u;
+
+        InRange = _mm256_set1_epi32 ( -1 );
+
+        z = load_avx2 ( &(pf_z[i]), &InRange );
+
+        if ( is_in_range_avx2 ( InRange ) == 0 ) {
+            calc_quotient_array_scalar ( i, i + 4, pf_x, f_y, pf_z, pf_qq );
+            continue ;
+        }
+
+        q = _mm256_div_pd ( _mm256_div_pd ( _mm256_loadu_pd ( &(pf_x[i]) ), _mm256_set1_pd ( f_y ) ), z );
+        q = _mm256_min_pd ( _mm256_max_pd ( q, _mm256_setzero_pd () ), _mm256_set1_pd ( 4294967294.0 ) );
+        q = _mm256_sub_pd ( _mm256_round_pd ( q, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC ), _mm256_set1_pd ( 2147483648.0 ) );
+        u = _mm_xor_si128 ( _mm256_cvttpd_epi32 ( q ), _mm_set1_epi32 ( (int)0x80000000 ) );
+
+#if LONG_MAX > 0x7FFFFFFF
+        _mm256_storeu_si256 ( (__m256i *)&(pf_qq[i]), _mm256_cvtepu32_epi64 ( u ) );
+#else
+        _mm_storeu_si128 ( (__m128i *)&(pf_qq[i]), u );
+#endif
+    }
+
+    _mm256_zeroupper ();                                    /* Avoid penalty of SSE code after AVX */
+
+    calc_quotient_array_scalar ( i, f_Num, pf_x, f_y, pf_z, pf_qq ); /* Remainder */
+
+    return ;
+}
+
+/* Load 2 signed long to 64 bit integer */
+__attribute__ ((target ("sse4.1"))) static __m128i load_epi64_sse41 ( signed long *pf_v )
+{
+#if LONG_MAX > 0x7FFFFFFF
+    return _mm_loadu_si128 ( (__m128i *)pf_v );
+#else
+    return _mm_cvtepi32_epi64 ( _mm_loadl_epi64 ( (__m128i *)pf_v ) );
+#endif
+}
+
+/* Cost of difference of 64 bit lanes with SSE4.1. Difference is within signed 32 bit, so low 32 bit are used. */
+__attribute__ ((target ("sse4.1"))) static __m128i calc_cost_sse41 ( __m128i f_x, __m128i f_y, unsigned char f_Square )
+{
+    __m128i d;
+
+    d = _mm_sub_epi64 ( f_x, f_y );
+
+    if ( f_Square != 0 ) {
+        return _mm_mul_epi32 ( d, d );
+    }
+
+    return _mm_and_si128 ( _mm_abs_epi32 ( d ), _mm_set1_epi64x ( 0xFFFFFFFF ) );
+}
+
+/* Function for calculating costs of correlation with SSE4.1. 2 shifts in each vector. */
+__attribute__ ((target ("sse4.1"))) static void calc_correlation_array_sse41
+(
+    unsigned long f_Num,
+    signed long *pf_x,
+    signed long *pf_y,
+    unsigned long f_ShiftNum,
+    unsigned char f_Square,
+    unsigned long long *pf_cost
+)
+{
+    unsigned long i;
+    unsigned long k;
+
+    for ( k = 0; k + 8 <= f_ShiftNum; k += 8 ) {           /* x is loaded once for 8 shifts */
+        __m128i Cost0;
+        __m128i Cost1;
+        __m128i Cost2;
+        __m128i Cost3;
+
+        Cost0 = _mm_setzero_si128 ();
+        Cost1 = _mm_setzero_si128 ();
+        Cost2 = _mm_setzero_si128 ();
+        Cost3 = _mm_setzero_si128 ();
+
+        for ( i = 0; i < f_Num; i++ ) {
+            __m128i x;
+
+            x = _mm_set1_epi64x ( (long long)pf_x[i] );
+
+            Cost0 = _mm_add_epi64 ( Cost0, calc_cost_sse41 ( x, load_epi64_sse41 ( &(pf_y[i+k  ]) ), f_Square ) );
+            Cost1 = _mm_add_epi64 ( Cost1, calc_cost_sse41 ( x, load_epi64_sse41 ( &(pf_y[i+k+2]) ), f_Square ) );
+            Cost2 = _mm_add_epi64 ( Cost2, calc_cost_sse41 ( x, load_epi64_sse41 ( &(pf_y[i+k+4]) ), f_Square ) );
+            Cost3 = _mm_add_epi64 ( Cost3, calc_cost_sse41 ( x, load_epi64_sse41 ( &(pf_y[i+k+6]) ), f_Square ) );
+        }
+
+        _mm_storeu_si128 ( (__m128i *)&(pf_cost[k  ]), Cost0 );
+        _mm_storeu_si128 ( (__m128i *)&(pf_cost[k+2]), Cost1 );
+        _mm_storeu_si128 ( (__m128i *)&(pf_cost[k+4]), Cost2 );
+        _mm_storeu_si128 ( (__m128i *)&(pf_cost[k+6]), Cost3 );
+    }
+
+    for ( ; k + 2 <= f_ShiftNum; k += 2 ) {
+        __m128i Cost;
+
+        Cost = _mm_setzero_si128 ();
+
+        for ( i = 0; i < f_Num; i++ ) {
+            Cost = _mm_add_epi64 ( Cost, calc_cost_sse41 ( _mm_set1_epi64x ( (long long)pf_x[i] ),
+                                                           load_epi64_sse41 ( &(pf_y[i+k]) ), f_Square ) );
+        }
+
+        _mm_storeu_si128 ( (__m128i *)&(pf_cost[k]), Cost );
+    }
+
+    calc_correlation_array_scalar ( k, f_Num, pf_x, pf_y, f_ShiftNum, f_Square, pf_cost ); /* Remainder */
+
+    return ;
+}
+
+/* Load 4 signed long to 64 bit integer */
+__attribute__ ((target ("avx2"))) static __m256i load_epi64_avx2 ( signed long *pf_v )
+{
+#if LONG_MAX > 0x7FFFFFFF
+    return _mm256_loadu_si256 ( (__m256i *)pf_v );
+#else
+    return _mm256_cvtepi32_epi64 ( _mm_loadu_si128 ( (__m128i *)pf_v ) );
+#endif
+}
+
+/* Cost of difference of 64 bit lanes with AVX2. Difference is within signed 32 bit, so low 32 bit are used. */
+__attribute__ ((target ("avx2"))) static __m256i calc_cost_avx2 ( __m256i f_x, __m256i f_y, unsigned char f_Square )
+{
+    __m256i d;
+
+    d = _mm256_sub_epi64 ( f_x, f_y );
+
+    if ( f_Square != 0 ) {
+        return _mm256_mul_epi32 ( d, d );
+    }
+
+    return _mm256_and_si256 ( _mm256_abs_epi32 ( d ), _mm256_set1_epi64x ( 0xFFFFFFFF ) );
+}
+
+/* Function for calculating costs of correlation with AVX2. 4 shifts in each vector. */
+__attribute__ ((target ("avx2"))) static void calc_correlation_array_avx2
+(
+    unsigned long f_Num,
+    signed long *pf_x,
+    signed long *pf_y,
+    unsigned long f_ShiftNum,
+    unsigned char f_Square,
+    unsigned long long *pf_cost
+)
+{
+    unsigned long i;
+    unsigned long k;
+
+    for ( k = 0; k + 16 <= f_ShiftNum; k += 16 ) {          /* x is loaded once for 16 shifts */
+        __m256i Cost0;
+        __m256i Cost1;
+        __m256i Cost2;
+        __m256i Cost3;
+
+        Cost0 = _mm256_setzero_si256 ();
+        Cost1 = _mm256_setzero_si256 ();
+        Cost2 = _mm256_setzero_si256 ();
+        Cost3 = _mm256_setzero_si256 ();
+
+        for ( i = 0; i < f_Num; i++ ) {
+            __m256i x;
+
+            x = _mm256_set1_epi64x ( (long long)pf_x[i] );
+
+            Cost0 = _mm256_add_epi64 ( Cost0, calc_cost_avx2 ( x, load_epi64_avx2 ( &(pf_y[i+k   ]) ), f_Square ) );
+            Cost1 = _mm256_add_epi64 ( Cost1, calc_cost_avx2 ( x, load_epi64_avx2 ( &(pf_y[i+k+ 4]) ), f_Square ) );
+            Cost2 = _mm256_add_epi64 ( Cost2, calc_cost_avx2 ( x, load_epi64_avx2 ( &(pf_y[i+k+ 8]) ), f_Square ) );
+            Cost3 = _mm256_add_epi64 ( Cost3, calc_cost_avx2 ( x, load_epi64_avx2 ( &(pf_y[i+k+12]) ), f_Square ) );
+        }
+
+        _mm256_storeu_si256 ( (__m256i *)&(pf_cost[k   ]), Cost0 );
+        _mm256_storeu_si256 ( (__m256i *)&(pf_cost[k+ 4]), Cost1 );
+        _mm256_storeu_si256 ( (__m256i *)&(pf_cost[k+ 8]), Cost2 );
+        _mm256_storeu_si256 ( (__m256i *)&(pf_cost[k+12]), Cost3 );
+    }
+
+    for ( ; k + 4 <= f_ShiftNum; k += 4 ) {
+        __m256i Cost;
+
+        Cost = _mm256_setzero_si256 ();
+
+        for ( i = 0; i < f_Num; i++ ) {
+            Cost = _mm256_add_epi64 ( Cost, calc_cost_avx2 ( _mm256_set1_epi64x ( (long long)pf_x[i] ),
+                                                             load_epi64_avx2 ( &(pf_y[i+k]) ), f_Square ) );
+        }
+
+        _mm256_storeu_si256 ( (__m256i *)&(pf_cost[k]), Cost );
+    }
+
+    _mm256_zeroupper ();                                    /* Avoid penalty of SSE code after AVX */
+
+    calc_correlation_array_scalar ( k, f_Num, pf_x, pf_y, f_ShiftNum, f_Square, pf_cost ); /* Remainder */
+
+    return ;
+}
+
+#endif  /* D_MATH_FUNC_SIMD_X86 */
+
+#if defined D_MATH_FUNC_SIMD_NEON
+
+/* Load 2 signed long to double */
+static float64x2_t load_neon ( signed long *pf_v )
+{
+#if LONG_MAX > 0x7FFFFFFF
+    return vcvtq_f64_s64 ( vld1q_s64 ( (const int64_t *)pf_v ) );
+#else
+    return vcvtq_f64_s64 ( vmovl_s32 ( vld1_s32 ( (const int32_t *)pf_v ) ) );
+#endif
+}
+
+/* Store 2 integral double to signed long */
+static void store_neon ( signed long *pf_v, float64x2_t f_v )
+{
+#if LONG_MAX > 0x7FFFFFFF
+    vst1q_s64 ( (int64_t *)pf_v, vcvtq_s64_f64 ( f_v ) );
+#else
+    vst1_s32 ( (int32_t *)pf_v, vmovn_s64 ( vcvtq_s64_f64 ( f_v ) ) );
+#endif
+}
+
+/* Vector version of CalcAddressOnLine_slXslY() with NEON */
+static float64x2_t calc_line_neon ( float64x2_t f_x0, float64x2_t f_x1, float64x2_t f_y0, float64x2_t f_y1, float64x2_t f_xx )
+{
+    uint64x2_t  Swap;
+    float64x2_t x0;
+    float64x2_t x1;
+    float64x2_t y0;
+    float64x2_t y1;
+    float64x2_t y;
+    float64x2_t Half;
+
+    Swap = vcgtq_f64 ( f_x0, f_x1 );                        /* Order as x0 <= x1 */
+    x0   = vbslq_f64 ( Swap, f_x1, f_x0 );
+    x1   = vbslq_f64 ( Swap, f_x0, f_x1 );
+    y0   = vbslq_f64 ( Swap, f_y1, f_y0 );
+    y1   = vbslq_f64 ( Swap, f_y0, f_y1 );
+
+    /* y = y0 + (y1 - y0) * (x - x0) / (x1 - x0) */
+    y = vaddq_f64 ( y0, vdivq_f64 ( vmulq_f64 ( vsubq_f64 ( y1, y0 ), vsubq_f64 ( f_xx, x0 ) ), vsubq_f64 ( x1, x0 ) ) );
+    y = vrndq_f64 ( y );                                    /* Truncate toward zero */
+
+    y = vbslq_f64 ( vcltq_f64 ( x1, f_xx ), y1, y );        /* x1 < x */
+    y = vbslq_f64 ( vcltq_f64 ( f_xx, x0 ), y0, y );        /* x < x0 */
+
+    Half = vrndq_f64 ( vdivq_f64 ( vaddq_f64 ( f_y0, f_y1 ), vdupq_n_f64 ( 2.0 ) ) );
+
+    y = vbslq_f64 ( vceqq_f64 ( f_x0, f_x1 ), Half, y );    /* x0 == x1 */
+    y = vbslq_f64 ( vceqq_f64 ( f_y0, f_y1 ), f_y0, y );    /* y0 == y1 */
+
+    return y;
+}
+
+/* Function for calculating arrays of lines with NEON */
+static void calc_line_array_neon
+(
+    unsigned long f_Num,
+    signed long *pf_x0,
+    signed long *pf_x1,
+    signed long *pf_y0,
+    signed long *pf_y1,
+    signed long *pf_xx,
+    signed long *pf_yy
+)
+{
+    unsigned long i;
+
+    for ( i = 0; i + 2 <= f_Num; i += 2 ) {
+        float64x2_t y;
+
+        y = calc_line_neon ( load_neon ( &(pf_x0[i]) ), load_neon ( &(pf_x1[i]) ),
+                             load_neon ( &(pf_y0[i]) ), load_neon ( &(pf_y1[i]) ), load_neon ( &(pf_xx[i]) ) );
+
+        store_neon ( &(pf_yy[i]), y );
+    }
+
+    calc_line_array_scalar ( i, f_Num, pf_x0, pf_x1, pf_y0, pf_y1, pf_xx, pf_yy ); /* Remainder */
+
+    return ;
+}
+
+/* Function for calculating arrays of planes with NEON */
+static void calc_plane_array_neon
+(
+    unsigned long f_Num,
+    signed long *pf_x0,
+    signed long *pf_x1,
+    signed long *pf_y0,
+    signed long *pf_y1,
+    signed long *pf_z0,
+    signed long *pf_z1,
+    signed long *pf_z2,
+    signed long *pf_z3,
+    signed long *pf_xx,
+    signed long *pf_yy,
+    signed long *pf_zz
+)
+{
+    unsigned long i;
+
+    for ( i = 0; i + 2 <= f_Num; i += 2 ) {
+        float64x2_t x0;
+        float64x2_t x1;
+        float64x2_t xx;
+        float64x2_t z1;
+        float64x2_t z2;
+        float64x2_t z;
+
+        x0 = load_neon ( &(pf_x0[i]) );
+        x1 = load_neon ( &(pf_x1[i]) );
+        xx = load_neon ( &(pf_xx[i]) );
+
+        z1 = calc_line_neon ( x0, x1, load_neon ( &(pf_z0[i]) ), load_neon ( &(pf_z1[i]) ), xx );
+        z2 = calc_line_neon ( x0, x1, load_neon ( &(pf_z2[i]) ), load_neon ( &(pf_z3[i]) ), xx );
+        z  = calc_line_neon ( load_neon ( &(pf_y0[i]) ), load_neon ( &(pf_y1[i]) ), z1, z2, load_neon ( &(pf_yy[i]) ) );
+
+        store_neon ( &(pf_zz[i]), z );
+    }
+
+    calc_plane_array_scalar ( i, f_Num, pf_x0, pf_x1, pf_y0, pf_y1, pf_z0, pf_z1, pf_z2, pf_z3, pf_xx, pf_yy, pf_zz ); /* Remainder */
+
+    return ;
+}
+
+/* Function for calculating a * x + b of arrays with NEON */
+static void calc_linear_array_neon
+(
+    unsigned long f_Num,
+    double *pf_a,
+    double *pf_b,
+    signed long *pf_xx,
+    signed long *pf_yy
+)
+{
+    unsigned long i;
+
+    for ( i = 0; i + 2 <= f_Num; i += 2 ) {
+        float64x2_t y;
+
+        y = vaddq_f64 ( vmulq_f64 ( vld1q_f64 ( &(pf_a[i]) ), load_neon ( &(pf_xx[i]) ) ), vld1q_f64 ( &(pf_b[i]) ) );
+        y = vminq_f64 ( vmaxq_f64 ( y, vdupq_n_f64 ( -2147483647.0 ) ), vdupq_n_f64 ( 2147483646.0 ) );
+
+        store_neon ( &(pf_yy[i]), y );
+    }
+
+    calc_linear_array_scalar ( i, f_Num, pf_a, pf_b, pf_xx, pf_yy ); /* Remainder */
+
+    return ;
+}
+
+/* Function for calculating x / y / z of arrays with NEON */
+static void calc_quotient_array_neon
+(
+    unsigned long f_Num,
+    double *pf_x,
+    double f_y,
+    signed long *pf_z,
+    unsigned long *pf_qq
+)
+{
+    unsigned long i;
+
+    for ( i = 0; i + 2 <= f_Num; i += 2 ) {
+        float64x2_t q;
+
+        q = vdivq_f64 ( vdivq_f64 ( vld1q_f64 ( &(pf_x[i]) ), vdupq_n_f64 ( f_y ) ), load_neon ( &(pf_z[i]) ) );
+        q = vminq_f64 ( vmaxq_f64 ( q, vdupq_n_f64 ( 0.0 ) ), vdupq_n_f64 ( 4294967294.0 ) );
+
+#if LONG_MAX > 0x7FFFFFFF
+        vst1q_u64 ( (uint64_t *)&(pf_qq[i]), vcvtq_u64_f64 ( q ) );
+#else
+        vst1_u32 ( (uint32_t *)&(pf_qq[i]), vmovn_u64 ( vcvtq_u64_f64 ( q ) ) );
+#endif
+    }
+
+    calc_quotient_array_scalar ( i, f_Num, pf_x, f_y, pf_z, pf_qq ); /* Remainder */
+
+    return ;
+}
+
+/* Load 2 signed long to 64 bit integer */
+static int64x2_t load_s64_neon ( signed long *pf_v )
+{
+#if LONG_MAX > 0x7FFFFFFF
+    return vld1q_s64 ( (int64_t *)pf_v );
+#else
+    return vmovl_s32 ( vld1_s32 ( (int32_t *)pf_v ) );
+#endif
+}
+
+/* Cost of difference of 64 bit lanes with NEON. Difference is within signed 32 bit, so low 32 bit are used. */
+static uint64x2_t calc_cost_neon ( int64x2_t f_x, int64x2_t f_y, unsigned char f_Square )
+{
+    int32x2_t d;
+
+    d = vmovn_s64 ( vsubq_s64 ( f_x, f_y ) );
+
+    if ( f_Square != 0 ) {
+        return vreinterpretq_u64_s64 ( vmull_s32 ( d, d ) );
+    }
+
+    return vmovl_u32 ( vreinterpret_u32_s32 ( vabs_s32 ( d ) ) );
+}
+
+/* Function for calculating costs of correlation with NEON. 2 shifts in each vector. */
+static void calc_correlation_array_neon
+(
+    unsigned long f_Num,
+    signed long *pf_x,
+    signed long *pf_y,
+    unsigned long f_ShiftNum,
+    unsigned char f_Square,
+    unsigned long long *pf_cost
+)
+{
+    unsigned long i;
+    unsigned long k;
+
+    for ( k = 0; k + 8 <= f_ShiftNum; k += 8 ) {           /* x is loaded once for 8 shifts */
+        uint64x2_t Cost0;
+        uint64x2_t Cost1;
+        uint64x2_t Cost2;
+        uint64x2_t Cost3;
+
+        Cost0 = vdupq_n_u64 ( 0 );
+        Cost1 = vdupq_n_u64 ( 0 );
+        Cost2 = vdupq_n_u64 ( 0 );
+        Cost3 = vdupq_n_u64 ( 0 );
+
+        for ( i = 0; i < f_Num; i++ ) {
+            int64x2_t x;
+
+            x = vdupq_n_s64 ( (int64_t)pf_x[i] );
+
+            Cost0 = vaddq_u64 ( Cost0, calc_cost_neon ( x, load_s64_neon ( &(pf_y[i+k  ]) ), f_Square ) );
+            Cost1 = vaddq_u64 ( Cost1, calc_cost_neon ( x, load_s64_neon ( &(pf_y[i+k+2]) ), f_Square ) );
+            Cost2 = vaddq_u64 ( Cost2, calc_cost_neon ( x, load_s64_neon ( &(pf_y[i+k+4]) ), f_Square ) );
+            Cost3 = vaddq_u64 ( Cost3, calc_cost_neon ( x, load_s64_neon ( &(pf_y[i+k+6]) ), f_Square ) );
+        }
+
+        vst1q_u64 ( (uint64_t *)&(pf_cost[k  ]), Cost0 );
+        vst1q_u64 ( (uint64_t *)&(pf_cost[k+2]), Cost1 );
+        vst1q_u64 ( (uint64_t *)&(pf_cost[k+4]), Cost2 );
+        vst1q_u64 ( (uint64_t *)&(pf_cost[k+6]), Cost3 );
+    }
+
+    for ( ; k + 2 <= f_ShiftNum; k += 2 ) {
+        uint64x2_t Cost;
+
+        Cost = vdupq_n_u64 ( 0 );
+
+        for ( i = 0; i < f_Num; i++ ) {
+            Cost = vaddq_u64 ( Cost, calc_cost_neon ( vdupq_n_s64 ( (int64_t)pf_x[i] ), load_s64_neon ( &(pf_y[i+k]) ), f_Square ) );
+        }
+
+        vst1q_u64 ( (uint64_t *)&(pf_cost[k]), Cost );
+    }
+
+    calc_correlation_array_scalar ( k, f_Num, pf_x, pf_y, f_ShiftNum, f_Square, pf_cost ); /* Remainder */
+
+    return ;
+}
+
+#endif  /* D_MATH_FUNC_SIMD_NEON */
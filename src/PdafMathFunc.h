@@ -32,6 +32,33 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define D_MATH_FUNC_NG  (-1)
 #define D_MATH_FUNC_OK  (0)
 
+/* Arithmetic of interpolation and formula of PDAF Library */
+/* 0 : double (default)                                                                  */
+/* 1 : fixed-point. Integer arithmetic with 64-bit intermediates and no double.          */
+/*     Results are the exact truncation of each formula, and the same as double          */
+/*     as long as double is exact. Maximum deviation from double is 1 DN, which can      */
+/*     appear only when a product in line interpolation exceeds 2^53 (analog gain        */
+/*     spans of threshold lines). Defocus of windows is the same as double over whole    */
+/*     range. Registered windows and defocus maps keep slope and offset interpolated at  */
+/*     their centers with D_MATH_FUNC_COEFF_FRAC_BITS of fraction instead of double, and */
+/*     their defocus deviates from double by 1 DN at most, while AdjCoeffSlope * Slope   */
+/*     is less than 2^50 and PhaseDifference is less than 2^20 in magnitude.             */
+/*     Slope and offset are assumed to be within signed 32 bit, and DensityOfPhasePix    */
+/*     to be less than 4096.                                                             */
+#ifndef D_MATH_FUNC_FIXED_POINT
+#define D_MATH_FUNC_FIXED_POINT (0)
+#endif
+
+/* Number of fraction bits of slope and offset of fixed-point. 8 or more. */
+#define D_MATH_FUNC_COEFF_FRAC_BITS (24)
+
+/* Vector instructions of arrays of lines and planes */
+/* 0 : disable, 1 : enable (default). AVX2 or SSE4.1 is selected at runtime on x86 with GCC or clang, */
+/* and NEON is used on AArch64. Other environments and fixed-point use scalar functions. */
+#ifndef D_MATH_FUNC_SIMD
+#define D_MATH_FUNC_SIMD        (1)
+#endif
+
 /* Function for calculating coordination at the point of the line */
 #if defined __GNUC__
 __attribute__ ((visibility ("hidden"))) extern void CalcAddressOnLine_slXslY
@@ -80,4 +107,167 @@ extern signed char CalcAddressOnPlane_slXslYslZ
     signed long *pf_zz
 );
 
+/* Function for calculating coordination at the point of the cell without branches */
+/* The point is limited into the cell, and x0 < x1 and y0 < y1 are assumed. */
+/* Inside the cell the result is the same as CalcAddressOnPlane_slXslYslZ(). */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void CalcAddressOnCell_slXslYslZ
+#else
+extern void CalcAddressOnCell_slXslYslZ
+#endif
+(
+    /* Input */
+    signed long *pf_x,
+    signed long *pf_y,
+    signed long *pf_z,
+    signed long f_xx,
+    signed long f_yy,
+    /* Output */
+    signed long *pf_zz
+);
+
+/* Function for calculating coordination at the point of the line for arrays of lines */
+/* Arrays are structure of arrays. Each element gives the same result as CalcAddressOnLine_slXslY(). */
+/* Elements with a value out of signed 32 bit are calculated by the scalar function. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void CalcAddressOnLineArray_slXslY
+#else
+extern void CalcAddressOnLineArray_slXslY
+#endif
+(
+    /* Input */
+    unsigned long f_Num,
+    signed long *pf_x0,
+    signed long *pf_x1,
+    signed long *pf_y0,
+    signed long *pf_y1,
+    signed long *pf_xx,
+    /* Output */
+    signed long *pf_yy
+);
+
+/* Function for calculating coordination at the point of the plane for arrays of planes */
+/* Arrays are structure of arrays. Each element gives the same result as CalcAddressOnPlane_slXslYslZ(), */
+/* and each point must be in its plane. Elements with a value out of signed 32 bit are calculated by the scalar function. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void CalcAddressOnPlaneArray_slXslYslZ
+#else
+extern void CalcAddressOnPlaneArray_slXslYslZ
+#endif
+(
+    /* Input */
+    unsigned long f_Num,
+    signed long *pf_x0,
+    signed long *pf_x1,
+    signed long *pf_y0,
+    signed long *pf_y1,
+    signed long *pf_z0,
+    signed long *pf_z1,
+    signed long *pf_z2,
+    signed long *pf_z3,
+    signed long *pf_xx,
+    signed long *pf_yy,
+    /* Output */
+    signed long *pf_zz
+);
+
+/* Function for calculating coordination at the point of the cell for arrays of cells */
+/* Arrays are structure of arrays. Each element gives the same result as CalcAddressOnCell_slXslYslZ(), */
+/* and each point must be in its cell. Elements with a value out of signed 32 bit are calculated by the scalar function. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void CalcAddressOnCellArray_slXslYslZ
+#else
+extern void CalcAddressOnCellArray_slXslYslZ
+#endif
+(
+    /* Input */
+    unsigned long f_Num,
+    signed long *pf_x0,
+    signed long *pf_x1,
+    signed long *pf_y0,
+    signed long *pf_y1,
+    signed long *pf_z0,
+    signed long *pf_z1,
+    signed long *pf_z2,
+    signed long *pf_z3,
+    signed long *pf_xx,
+    signed long *pf_yy,
+    /* Output */
+    signed long *pf_zz
+);
+
+/* Function for calculating a * x + b for arrays, truncated toward zero and limited to -2147483647 - +2147483646 */
+/* Arrays are structure of arrays. Elements whose x is out of signed 32 bit are calculated by the scalar function. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void CalcLinearArray_dAdBslX
+#else
+extern void CalcLinearArray_dAdBslX
+#endif
+(
+    /* Input */
+    unsigned long f_Num,
+    double *pf_a,
+    double *pf_b,
+    signed long *pf_xx,
+    /* Output */
+    signed long *pf_yy
+);
+
+#if D_MATH_FUNC_FIXED_POINT
+/* Function for calculating ( a * x + b ) / 2^D_MATH_FUNC_COEFF_FRAC_BITS for arrays of fixed-point, */
+/* truncated toward zero and limited to -2147483647 - +2147483646. Arrays are structure of arrays. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void CalcLinearArray_sllAsllBslX
+#else
+extern void CalcLinearArray_sllAsllBslX
+#endif
+(
+    /* Input */
+    unsigned long f_Num,
+    signed long long *pf_a,
+    signed long long *pf_b,
+    signed long *pf_xx,
+    /* Output */
+    signed long *pf_yy
+);
+#endif
+
+/* Function for calculating x / y / z for arrays, truncated toward zero and limited to 0 - 4294967294 */
+/* Arrays are structure of arrays. x must not be negative, and z must not be 0. Elements whose z is out of */
+/* signed 32 bit are calculated by the scalar function. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void CalcQuotientArray_dXdYslZ
+#else
+extern void CalcQuotientArray_dXdYslZ
+#endif
+(
+    /* Input */
+    unsigned long f_Num,
+    double *pf_x,
+    double f_y,
+    signed long *pf_z,
+    /* Output */
+    unsigned long *pf_qq
+);
+
+/* Function for calculating costs of correlation of x with y shifted by 0 to f_ShiftNum-1 */
+/* pf_cost[k] is sum of |x[i] - y[i+k]| (f_Square 0) or (x[i] - y[i+k])^2 (f_Square 1) for i of 0 to f_Num-1, */
+/* and y has f_Num + f_ShiftNum - 1 elements. Vector functions are used when x and y are within signed 31 bit. */
+/* Integer arithmetic is used, so results are the same with and without vector instructions. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void CalcCorrelationArray_slXslY
+#else
+extern void CalcCorrelationArray_slXslY
+#endif
+(
+    /* Input */
+    unsigned long f_Num,
+    signed long *pf_x,
+    signed long *pf_y,
+    unsigned long f_ShiftNum,
+    unsigned char f_Square,
+    /* Output */
+    unsigned long long *pf_cost
+);
+
 #endif
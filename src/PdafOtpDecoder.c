@@ -0,0 +1,254 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/****************************************************************/
+/*                          include                             */
+/****************************************************************/
+
+#include <stddef.h>
+#include "PdafOtpDecoder.h"
+
+/****************************************************************/
+/*                 local function declaration                   */
+/****************************************************************/
+
+static unsigned long otp_read ( const unsigned char *pf_Data, unsigned long f_Size, unsigned char f_BigEndian );
+static signed long otp_read_signed ( const unsigned char *pf_Data, unsigned long f_Size, unsigned char f_BigEndian );
+static unsigned long otp_decode_knot ( const unsigned char *pf_Data, unsigned short f_KnotNum, unsigned char f_BigEndian, unsigned short *pf_AddressKnot );
+
+/****************************************************************/
+/*                      external function                       */
+/****************************************************************/
+
+/* Function for getting number of elements of tables of PDAF calibration block */
+extern signed char OtpGetTableNum
+(
+    /* Input */
+    const unsigned char *pf_Data,
+    unsigned long f_Size,
+    PdLibOtpFormat_t *pf_Format,
+    /* Output */
+    OtpTableNum_t *pf_TableNum
+)
+{
+    unsigned long i;
+    unsigned long Pos;
+    unsigned long End;
+    unsigned long ValueSize;
+    unsigned long KnotNum;
+    const unsigned char *p_Block;
+
+    ValueSize = (*pf_Format).ValueSize;
+
+    if ( pf_Data == NULL || ( ValueSize != 2 && ValueSize != 4 ) || f_Size < (*pf_Format).BlockOffset ) {
+        return D_OTP_DECODER_NG;
+    }
+
+    p_Block = pf_Data + (*pf_Format).BlockOffset;
+    End     = f_Size - (*pf_Format).BlockOffset;            /* Bytes from the start of block */
+
+    /* Image size and knots of slope and offset */
+    if ( End < 6 ) {
+        return D_OTP_DECODER_NG;
+    }
+
+    (*pf_TableNum).XKnotNumSlopeOffset = p_Block[4];
+    (*pf_TableNum).YKnotNumSlopeOffset = p_Block[5];
+
+    KnotNum = (unsigned long)(*pf_TableNum).XKnotNumSlopeOffset * (*pf_TableNum).YKnotNumSlopeOffset;
+    Pos = 6 + 2 * ( (*pf_TableNum).XKnotNumSlopeOffset + (*pf_TableNum).YKnotNumSlopeOffset ) + 2 * ValueSize * KnotNum;
+
+    /* Knots of DefocusOKNG */
+    if ( End < Pos + 2 ) {
+        return D_OTP_DECODER_NG;
+    }
+
+    (*pf_TableNum).XKnotNumDefocusOKNG = p_Block[Pos];
+    (*pf_TableNum).YKnotNumDefocusOKNG = p_Block[Pos+1];
+
+    Pos += 2 + 2 * ( (*pf_TableNum).XKnotNumDefocusOKNG + (*pf_TableNum).YKnotNumDefocusOKNG );
+
+    (*pf_TableNum).LineNum = (unsigned long)(*pf_TableNum).XKnotNumDefocusOKNG * (*pf_TableNum).YKnotNumDefocusOKNG;
+
+    if ( (*pf_TableNum).LineNum == 0 ) {
+        (*pf_TableNum).LineNum = 1;                         /* First line is checked even if confidence judgement is disabled */
+    }
+
+    /* Threshold lines */
+    (*pf_TableNum).DataNum = 0;
+
+    for ( i = 0; i < (*pf_TableNum).LineNum; i++ ) {
+        if ( End < Pos + 1 ) {
+            return D_OTP_DECODER_NG;
+        }
+
+        (*pf_TableNum).DataNum += p_Block[Pos];
+        Pos += 1 + 2 * ValueSize * p_Block[Pos];
+    }
+
+    if ( (*pf_Format).Checksum != 0 ) {                     /* 8-bit sum of bytes of block */
+        unsigned char Sum;
+
+        if ( End < Pos + 1 ) {
+            return D_OTP_DECODER_NG;
+        }
+
+        Sum = 0;
+        for ( i = 0; i < Pos; i++ ) {
+            Sum = (unsigned char)( Sum + p_Block[i] );
+        }
+
+        if ( Sum != p_Block[Pos] ) {
+            return D_OTP_DECODER_NG;
+        }
+    } else if ( End < Pos ) {
+        return D_OTP_DECODER_NG;
+    }
+
+    return D_OTP_DECODER_OK;
+}
+
+/* Function for decoding PDAF calibration block to tables */
+extern void OtpDecode
+(
+    /* Input */
+    const unsigned char *pf_Data,
+    PdLibOtpFormat_t *pf_Format,
+    /* Output */
+    PdLibCalibData_t *pf_CalibData,
+    unsigned long *pf_ThrData
+)
+{
+    unsigned long i;
+    unsigned long j;
+    unsigned long KnotNum;
+    unsigned long LineNum;
+    unsigned long ValueSize;
+    unsigned char BigEndian;
+    const unsigned char *p_Block;
+
+    ValueSize = (*pf_Format).ValueSize;
+    BigEndian = (*pf_Format).BigEndian;
+    p_Block   = pf_Data + (*pf_Format).BlockOffset;
+
+    (*pf_CalibData).XSizeOfImage        = (unsigned short)otp_read ( p_Block, 2, BigEndian );
+    (*pf_CalibData).YSizeOfImage        = (unsigned short)otp_read ( p_Block + 2, 2, BigEndian );
+    (*pf_CalibData).XKnotNumSlopeOffset = p_Block[4];
+    (*pf_CalibData).YKnotNumSlopeOffset = p_Block[5];
+    p_Block += 6;
+
+    p_Block += otp_decode_knot ( p_Block, (*pf_CalibData).XKnotNumSlopeOffset, BigEndian, (*pf_CalibData).p_XAddressKnotSlopeOffset );
+    p_Block += otp_decode_knot ( p_Block, (*pf_CalibData).YKnotNumSlopeOffset, BigEndian, (*pf_CalibData).p_YAddressKnotSlopeOffset );
+
+    KnotNum = (unsigned long)(*pf_CalibData).XKnotNumSlopeOffset * (*pf_CalibData).YKnotNumSlopeOffset;
+
+    for ( i = 0; i < KnotNum; i++, p_Block += ValueSize ) {
+        (*pf_CalibData).p_SlopeData[i] = otp_read_signed ( p_Block, ValueSize, BigEndian );
+    }
+    for ( i = 0; i < KnotNum; i++, p_Block += ValueSize ) {
+        (*pf_CalibData).p_OffsetData[i] = otp_read_signed ( p_Block, ValueSize, BigEndian );
+    }
+
+    (*pf_CalibData).XKnotNumDefocusOKNG = p_Block[0];
+    (*pf_CalibData).YKnotNumDefocusOKNG = p_Block[1];
+    p_Block += 2;
+
+    p_Block += otp_decode_knot ( p_Block, (*pf_CalibData).XKnotNumDefocusOKNG, BigEndian, (*pf_CalibData).p_XAddressKnotDefocusOKNG );
+    p_Block += otp_decode_knot ( p_Block, (*pf_CalibData).YKnotNumDefocusOKNG, BigEndian, (*pf_CalibData).p_YAddressKnotDefocusOKNG );
+
+    LineNum = (unsigned long)(*pf_CalibData).XKnotNumDefocusOKNG * (*pf_CalibData).YKnotNumDefocusOKNG;
+
+    if ( LineNum == 0 ) {
+        LineNum = 1;                                        /* First line is checked even if confidence judgement is disabled */
+    }
+
+    for ( i = 0; i < LineNum; i++ ) {
+        DefocusOKNGThrLine_t *p_Line;
+
+        p_Line = &((*pf_CalibData).p_DefocusOKNGThrLine[i]);
+
+        (*p_Line).PointNum     = p_Block[0];
+        (*p_Line).p_AnalogGain = pf_ThrData;
+        (*p_Line).p_Confidence = pf_ThrData + (*p_Line).PointNum;
+        p_Block += 1;
+
+        for ( j = 0; j < (*p_Line).PointNum * 2; j++, p_Block += ValueSize ) {
+            pf_ThrData[j] = otp_read ( p_Block, ValueSize, BigEndian );
+        }
+
+        pf_ThrData += (*p_Line).PointNum * 2;
+    }
+
+    (*pf_CalibData).AdjCoeffSlope     = (*pf_Format).AdjCoeffSlope;
+    (*pf_CalibData).DensityOfPhasePix = (*pf_Format).DensityOfPhasePix;
+
+    return ;
+}
+
+/****************************************************************/
+/*                       local function                         */
+/****************************************************************/
+
+/* Function for reading unsigned value of f_Size bytes */
+static unsigned long otp_read ( const unsigned char *pf_Data, unsigned long f_Size, unsigned char f_BigEndian )
+{
+    unsigned long i;
+    unsigned long Value;
+
+    Value = 0;
+
+    for ( i = 0; i < f_Size; i++ ) {
+        Value = ( Value << 8 ) | pf_Data[ ( f_BigEndian != 0 ) ? i : f_Size - 1 - i ];
+    }
+
+    return Value;
+}
+
+/* Function for reading signed value of f_Size bytes in two's complement */
+static signed long otp_read_signed ( const unsigned char *pf_Data, unsigned long f_Size, unsigned char f_BigEndian )
+{
+    unsigned long Value;
+    unsigned long Sign;
+
+    Value = otp_read ( pf_Data, f_Size, f_BigEndian );
+    Sign  = 1UL << ( 8 * f_Size - 1 );
+
+    /* Value - 2 * Sign for negative value without overflow */
+    return ( ( Value & Sign ) != 0 ) ? -(signed long)( ( Sign - 1 ) - ( Value & ( Sign - 1 ) ) ) - 1 : (signed long)Value;
+}
+
+/* Function for decoding 16-bit address of knots and returning size of them */
+static unsigned long otp_decode_knot ( const unsigned char *pf_Data, unsigned short f_KnotNum, unsigned char f_BigEndian, unsigned short *pf_AddressKnot )
+{
+    unsigned long i;
+
+    for ( i = 0; i < f_KnotNum; i++ ) {
+        pf_AddressKnot[i] = (unsigned short)otp_read ( pf_Data + 2 * i, 2, f_BigEndian );
+    }
+
+    return 2 * (unsigned long)f_KnotNum;
+}
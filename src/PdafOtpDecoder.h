@@ -0,0 +1,80 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef __PDAF_OTP_DECODER_H__
+#define __PDAF_OTP_DECODER_H__
+
+#include "PdafLibrary.h"
+
+#define D_OTP_DECODER_NG    (-1)
+#define D_OTP_DECODER_OK    (0)
+
+/* Number of elements of tables of a PDAF calibration block */
+typedef struct
+{
+    unsigned short      XKnotNumSlopeOffset;
+    unsigned short      YKnotNumSlopeOffset;
+    unsigned short      XKnotNumDefocusOKNG;
+    unsigned short      YKnotNumDefocusOKNG;
+    unsigned long       LineNum;                    /* Number of threshold lines. */
+    unsigned long       DataNum;                    /* Sum of number of points of threshold lines. */
+} OtpTableNum_t;
+
+/* Function for getting number of elements of tables of PDAF calibration block */
+/* Only counts in the block are read. Block is checked to be in the dump and its checksum is checked. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern signed char OtpGetTableNum
+#else
+extern signed char OtpGetTableNum
+#endif
+(
+    /* Input */
+    const unsigned char *pf_Data,
+    unsigned long f_Size,
+    PdLibOtpFormat_t *pf_Format,
+    /* Output */
+    OtpTableNum_t *pf_TableNum
+);
+
+/* Function for decoding PDAF calibration block to tables */
+/* Tables of pf_CalibData and p_DefocusOKNGThrLine must be set by caller with the size of OtpGetTableNum(). */
+/* Analog gain and confidence of threshold lines are decoded to pf_ThrData in order. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void OtpDecode
+#else
+extern void OtpDecode
+#endif
+(
+    /* Input */
+    const unsigned char *pf_Data,
+    PdLibOtpFormat_t *pf_Format,
+    /* Output */
+    PdLibCalibData_t *pf_CalibData,
+    unsigned long *pf_ThrData
+);
+
+#endif
@@ -0,0 +1,382 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/****************************************************************/
+/*                          include                             */
+/****************************************************************/
+
+#include <stddef.h>
+#include "PdafMathFunc.h"
+#include "PdafPhaseDetect.h"
+
+#define D_PHASE_DETECT_PROFILE_SHIFT    (4)                 /* Fraction bits of line profile. */
+#define D_PHASE_DETECT_COLUMN_MIN       (4)                 /* Minimum number of columns correlated. */
+#define D_PHASE_DETECT_SHIFT_NUM_MAX    ( 2 * D_PD_LIB_PD_SEARCH_RANGE_MAX + 1 )    /* Number of disparities. */
+#define D_PHASE_DETECT_BAND             (2)                 /* Shifts searched around disparity of coarser level. */
+
+/****************************************************************/
+/*                 local function declaration                   */
+/****************************************************************/
+
+static void phase_detect_profile ( const unsigned short *pf_Image, unsigned long f_Stride, unsigned long f_XStart, unsigned long f_Num, unsigned long f_YStart, unsigned long f_YEnd, signed long *pf_Profile );
+static void phase_detect_downsample ( signed long *pf_Profile, unsigned long f_Num, signed long *pf_Downsampled );
+static signed char phase_detect_peak ( const PdLibPdParam_t *pf_Param, signed long *pf_Left, signed long *pf_Right, unsigned long f_Num, unsigned long f_ShiftNum, signed long long *pf_Disparity, unsigned long long *pf_Slope );
+static signed long long phase_detect_round ( signed long long f_x, signed long long f_y );
+
+/****************************************************************/
+/*                      external function                       */
+/****************************************************************/
+
+/* Function for checking PD image, parameter and windows of PD extraction */
+extern signed char PhaseDetectCheck
+(
+    /* Input */
+    const PdLibPdImage_t *pf_Image,
+    const PdLibPdParam_t *pf_Param,
+    unsigned long f_WindowNum,
+    PdLibWindow_t *pf_Window
+)
+{
+    unsigned long i;
+
+    if ( pf_Image == NULL || pf_Param == NULL || ( f_WindowNum != 0 && pf_Window == NULL ) ) {
+        return D_PHASE_DETECT_NG;
+    }
+
+    if ( (*pf_Image).p_Left == NULL || (*pf_Image).p_Right == NULL ||
+         (*pf_Image).XSize == 0 || (*pf_Image).YSize == 0 || (*pf_Image).Stride < (*pf_Image).XSize ||
+         (*pf_Image).XSizeOfImage < (*pf_Image).XSize || (*pf_Image).YSizeOfImage < (*pf_Image).YSize ) {
+        return D_PHASE_DETECT_NG;
+    }
+
+    if ( (*pf_Param).SearchRange < 1 || D_PD_LIB_PD_SEARCH_RANGE_MAX < (*pf_Param).SearchRange ||
+         D_PD_LIB_PD_COST_SSD < (*pf_Param).CostType ||
+         (*pf_Param).PhaseDiffScale < 1 || D_PD_LIB_PD_PHASE_DIFF_SCALE_MAX < (*pf_Param).PhaseDiffScale ) {
+        return D_PHASE_DETECT_NG;
+    }
+
+    for ( i = 0; i < f_WindowNum; i++ ) {
+        PdLibWindow_t *p_Window;
+        unsigned long XStart;
+        unsigned long XEnd;
+        unsigned long YStart;
+        unsigned long YEnd;
+
+        p_Window = &(pf_Window[i]);
+
+        if ( (*p_Window).XAddressOfWindowEnd < (*p_Window).XAddressOfWindowStart ||
+             (*p_Window).YAddressOfWindowEnd < (*p_Window).YAddressOfWindowStart ||
+             (*pf_Image).XSizeOfImage <= (*p_Window).XAddressOfWindowEnd ||
+             (*pf_Image).YSizeOfImage <= (*p_Window).YAddressOfWindowEnd ) {
+            return D_PHASE_DETECT_NG;
+        }
+
+        /* Size in PD pixels */
+        XStart = (unsigned long)(*p_Window).XAddressOfWindowStart * (*pf_Image).XSize / (*pf_Image).XSizeOfImage;
+        XEnd   = (unsigned long)(*p_Window).XAddressOfWindowEnd   * (*pf_Image).XSize / (*pf_Image).XSizeOfImage;
+        YStart = (unsigned long)(*p_Window).YAddressOfWindowStart * (*pf_Image).YSize / (*pf_Image).YSizeOfImage;
+        YEnd   = (unsigned long)(*p_Window).YAddressOfWindowEnd   * (*pf_Image).YSize / (*pf_Image).YSizeOfImage;
+
+        if ( D_PD_LIB_PD_WINDOW_SIZE_MAX < XEnd - XStart + 1 || D_PD_LIB_PD_WINDOW_SIZE_MAX < YEnd - YStart + 1 ) {
+            return D_PHASE_DETECT_NG;
+        }
+    }
+
+    return D_PHASE_DETECT_OK;
+}
+
+/* Function for calculating phase difference and confidence level of a window from line profiles */
+extern void PhaseDetectWindow
+(
+    /* Input */
+    const PdLibPdImage_t *pf_Image,
+    const PdLibPdParam_t *pf_Param,
+    unsigned long f_LevelNum,
+    PdLibWindow_t *pf_Window,
+    /* Output */
+    PdLibPhaseDiffData_t *pf_PhaseDiffData,
+    unsigned char *pf_Level
+)
+{
+    unsigned long       l;
+    unsigned long       Range;
+    unsigned long       Num;
+    unsigned long       Level;
+    signed long         XStart;
+    signed long         XEnd;
+    unsigned long       YStart;
+    unsigned long       YEnd;
+    unsigned long long  Slope;
+    unsigned long long  Div;
+    unsigned long long  ConfidenceLevel;
+    signed long long    Disparity;
+    signed long long    PhaseDifference;
+    signed long         *p_Left[D_PD_LIB_PD_LEVEL_NUM_MAX];
+    signed long         *p_Right[D_PD_LIB_PD_LEVEL_NUM_MAX];
+    signed long         Left[2 * D_PD_LIB_PD_WINDOW_SIZE_MAX];                                      /* Profiles of all levels */
+    signed long         Right[2 * ( D_PD_LIB_PD_WINDOW_SIZE_MAX + 2 * D_PD_LIB_PD_SEARCH_RANGE_MAX )];
+
+    (*pf_PhaseDiffData).PhaseDifference = (*pf_Param).PdErrorValue;
+    (*pf_PhaseDiffData).ConfidenceLevel = 0;
+
+    if ( pf_Level != NULL ) {
+        (*pf_Level) = 0;
+    }
+
+    /* Range is a multiple of columns of the coarsest level, so that disparity of each level is integral */
+    Range = ( ( (*pf_Param).SearchRange - 1 ) >> ( f_LevelNum - 1 ) ) + 1;
+    Range = Range << ( f_LevelNum - 1 );
+
+    XStart = (signed long)( (unsigned long)(*pf_Window).XAddressOfWindowStart * (*pf_Image).XSize / (*pf_Image).XSizeOfImage );
+    XEnd   = (signed long)( (unsigned long)(*pf_Window).XAddressOfWindowEnd   * (*pf_Image).XSize / (*pf_Image).XSizeOfImage );
+    YStart = (unsigned long)(*pf_Window).YAddressOfWindowStart * (*pf_Image).YSize / (*pf_Image).YSizeOfImage;
+    YEnd   = (unsigned long)(*pf_Window).YAddressOfWindowEnd   * (*pf_Image).YSize / (*pf_Image).YSizeOfImage;
+
+    /* Columns are limited so that the right profile shifted by the search range is in sub-images */
+    if ( XStart < (signed long)Range ) {
+        XStart = (signed long)Range;
+    }
+    if ( (signed long)(*pf_Image).XSize - 1 - (signed long)Range < XEnd ) {
+        XEnd = (signed long)(*pf_Image).XSize - 1 - (signed long)Range;
+    }
+
+    if ( XEnd - XStart + 1 < D_PHASE_DETECT_COLUMN_MIN ) {
+        return ;                                            /* Window is too close to the edge */
+    }
+
+    Num = (unsigned long)( XEnd - XStart + 1 );
+
+    while ( 1 < f_LevelNum && ( Num >> ( f_LevelNum - 1 ) ) < D_PHASE_DETECT_COLUMN_MIN ) {
+        f_LevelNum--;                                       /* Narrow window uses fewer levels */
+    }
+
+    /* Average rows of the window to line profiles of level 0 */
+    p_Left[0]  = Left;
+    p_Right[0] = Right;
+
+    phase_detect_profile ( (*pf_Image).p_Left,  (*pf_Image).Stride, (unsigned long)XStart,         Num,             YStart, YEnd, p_Left[0]  );
+    phase_detect_profile ( (*pf_Image).p_Right, (*pf_Image).Stride, (unsigned long)XStart - Range, Num + 2 * Range, YStart, YEnd, p_Right[0] );
+
+    /* Level l averages 2^l columns */
+    for ( l = 1; l < f_LevelNum; l++ ) {
+        p_Left[l]  = p_Left[l-1]  + ( Num >> ( l - 1 ) );
+        p_Right[l] = p_Right[l-1] + ( ( Num + 2 * Range ) >> ( l - 1 ) );
+
+        phase_detect_downsample ( p_Left[l-1],  Num >> l,                 p_Left[l]  );
+        phase_detect_downsample ( p_Right[l-1], ( Num + 2 * Range ) >> l, p_Right[l] );
+    }
+
+    /* The coarsest level searches the whole range */
+    Level = f_LevelNum - 1;
+
+    if ( phase_detect_peak ( pf_Param, p_Left[Level], p_Right[Level], Num >> Level, 2 * ( Range >> Level ) + 1,
+                             &Disparity, &Slope ) != D_PHASE_DETECT_OK ) {
+        return ;                                            /* Peak is out of search range, or profiles are flat */
+    }
+
+    Disparity -= (signed long long)( Range >> Level ) * (*pf_Param).PhaseDiffScale;
+
+    /* Each finer level searches a narrow band around disparity of the coarser level */
+    for ( l = Level; 0 < l; l-- ) {
+        signed long long    Center;
+        signed long long    Start;
+        signed long long    End;
+        signed long long    RangeOfLevel;
+        signed long long    DisparityOfLevel;
+        unsigned long long  SlopeOfLevel;
+
+        RangeOfLevel = (signed long long)( Range >> ( l - 1 ) );
+        Center = phase_detect_round ( 2 * Disparity, (*pf_Param).PhaseDiffScale );
+
+        Start = ( Center - D_PHASE_DETECT_BAND < -RangeOfLevel ) ? -RangeOfLevel : Center - D_PHASE_DETECT_BAND;
+        End   = ( RangeOfLevel < Center + D_PHASE_DETECT_BAND  ) ?  RangeOfLevel : Center + D_PHASE_DETECT_BAND;
+
+        if ( phase_detect_peak ( pf_Param, p_Left[l-1], p_Right[l-1] + ( Start + RangeOfLevel ), Num >> ( l - 1 ),
+                                 (unsigned long)( End - Start + 1 ), &DisparityOfLevel, &SlopeOfLevel ) != D_PHASE_DETECT_OK ) {
+            break ;                                         /* Peak is out of the band. Disparity of coarser level is kept. */
+        }
+
+        Disparity = DisparityOfLevel + Start * (*pf_Param).PhaseDiffScale;
+        Slope     = SlopeOfLevel;
+        Level     = l - 1;
+    }
+
+    PhaseDifference = Disparity * ( 1 << Level );           /* Disparity of level 0 */
+
+    if ( PhaseDifference == (*pf_Param).PdErrorValue ) {
+        PhaseDifference += ( PhaseDifference < 0 ) ? 1 : -1;   /* Keep it apart from error value by the least unit */
+    }
+
+    /* Slope of cost per column in pixel value, and per PD pixel of level 0 */
+    if ( (*pf_Param).CostType == D_PD_LIB_PD_COST_SSD ) {
+        Div = (unsigned long long)( Num >> Level ) << ( 2 * ( D_PHASE_DETECT_PROFILE_SHIFT + Level ) );
+    } else {
+        Div = (unsigned long long)( Num >> Level ) << ( D_PHASE_DETECT_PROFILE_SHIFT + Level );
+    }
+
+    ConfidenceLevel = Slope / Div * (*pf_Param).ConfidenceGain + Slope % Div * (*pf_Param).ConfidenceGain / Div;
+
+    if ( 0xFFFFFFFF < ConfidenceLevel ) {
+        ConfidenceLevel = 0xFFFFFFFF;                       /* Limit max */
+    }
+
+    (*pf_PhaseDiffData).PhaseDifference = (signed long)PhaseDifference;
+    (*pf_PhaseDiffData).ConfidenceLevel = (unsigned long)ConfidenceLevel;
+
+    if ( pf_Level != NULL ) {
+        (*pf_Level) = (unsigned char)Level;
+    }
+
+    return ;
+}
+
+/****************************************************************/
+/*                       local function                         */
+/****************************************************************/
+
+/* Function for averaging rows from f_YStart to f_YEnd of f_Num columns to line profile */
+/* Profile has D_PHASE_DETECT_PROFILE_SHIFT fraction bits. */
+static void phase_detect_profile ( const unsigned short *pf_Image, unsigned long f_Stride, unsigned long f_XStart, unsigned long f_Num, unsigned long f_YStart, unsigned long f_YEnd, signed long *pf_Profile )
+{
+    unsigned long i;
+    unsigned long y;
+    unsigned long RowNum;
+
+    for ( i = 0; i < f_Num; i++ ) {
+        pf_Profile[i] = 0;
+    }
+
+    /* Sum of D_PD_LIB_PD_WINDOW_SIZE_MAX rows is within 32 bit. 4 rows are added at once to reduce stores. */
+    for ( y = f_YStart; y + 3 <= f_YEnd; y += 4 ) {
+        const unsigned short *p_Row;
+
+        p_Row = pf_Image + y * f_Stride + f_XStart;
+
+        for ( i = 0; i < f_Num; i++ ) {
+            pf_Profile[i] += (signed long)p_Row[i] + (signed long)p_Row[i+f_Stride] +
+                             (signed long)p_Row[i+2*f_Stride] + (signed long)p_Row[i+3*f_Stride];
+        }
+    }
+
+    for ( ; y <= f_YEnd; y++ ) {
+        const unsigned short *p_Row;
+
+        p_Row = pf_Image + y * f_Stride + f_XStart;
+
+        for ( i = 0; i < f_Num; i++ ) {
+            pf_Profile[i] += p_Row[i];
+        }
+    }
+
+    RowNum = f_YEnd - f_YStart + 1;
+
+    for ( i = 0; i < f_Num; i++ ) {
+        pf_Profile[i] = (signed long)( ( ( (unsigned long)pf_Profile[i] << D_PHASE_DETECT_PROFILE_SHIFT ) + RowNum / 2 ) / RowNum );
+    }
+
+    return ;
+}
+
+/* Function for filtering profile by [1 3 3 1] and decimating it to f_Num columns */
+/* Simple average of pairs aliases fine texture and misleads the coarsest level. */
+static void phase_detect_downsample ( signed long *pf_Profile, unsigned long f_Num, signed long *pf_Downsampled )
+{
+    unsigned long i;
+
+    for ( i = 0; i < f_Num; i++ ) {
+        signed long Prev;
+        signed long Next;
+
+        Prev = pf_Profile[ ( i == 0 ) ? 2*i : 2*i-1 ];      /* Edge is repeated */
+        Next = pf_Profile[ ( i == f_Num - 1 ) ? 2*i+1 : 2*i+2 ];
+
+        pf_Downsampled[i] = ( Prev + 3 * pf_Profile[2*i] + 3 * pf_Profile[2*i+1] + Next + 4 ) >> 3;
+    }
+
+    return ;
+}
+
+/* Function for searching the minimum cost of f_ShiftNum shifts of the right profile and its sub-pixel position */
+/* Disparity is the position from the first shift multiplied by PhaseDiffScale, and slope is the larger */
+/* difference of costs next to the minimum. NG is returned when the minimum is at the first or last shift. */
+static signed char phase_detect_peak
+(
+    const PdLibPdParam_t *pf_Param,
+    signed long *pf_Left,
+    signed long *pf_Right,
+    unsigned long f_Num,
+    unsigned long f_ShiftNum,
+    signed long long *pf_Disparity,
+    unsigned long long *pf_Slope
+)
+{
+    unsigned long       k;
+    unsigned long       Min;
+    unsigned long long  Slope;
+    signed long long    Den;
+    unsigned long long  Cost[D_PHASE_DETECT_SHIFT_NUM_MAX];
+
+    CalcCorrelationArray_slXslY ( f_Num, pf_Left, pf_Right, f_ShiftNum,
+                                  (unsigned char)( ( (*pf_Param).CostType == D_PD_LIB_PD_COST_SSD ) ? 1 : 0 ), Cost );
+
+    Min = 0;
+
+    for ( k = 1; k < f_ShiftNum; k++ ) {
+        if ( Cost[k] < Cost[Min] ) {
+            Min = k;                                        /* First minimum */
+        }
+    }
+
+    if ( Min == 0 || Min == f_ShiftNum - 1 ) {
+        return D_PHASE_DETECT_NG;
+    }
+
+    /* Cost[Min-1] is larger than Cost[Min] because Min is the first minimum */
+    Slope = ( ( Cost[Min-1] < Cost[Min+1] ) ? Cost[Min+1] : Cost[Min-1] ) - Cost[Min];
+
+    if ( (*pf_Param).CostType == D_PD_LIB_PD_COST_SSD ) {
+        Den = 2 * ( (signed long long)Cost[Min-1] + (signed long long)Cost[Min+1] - 2 * (signed long long)Cost[Min] );    /* Parabola */
+    } else {
+        Den = 2 * (signed long long)Slope;                  /* Equiangular line */
+    }
+
+    (*pf_Disparity) = (signed long long)Min * (*pf_Param).PhaseDiffScale +
+                      phase_detect_round ( ( (signed long long)Cost[Min-1] - (signed long long)Cost[Min+1] ) * (*pf_Param).PhaseDiffScale, Den );
+    (*pf_Slope)     = Slope;
+
+    return D_PHASE_DETECT_OK;
+}
+
+/* Function for rounding f_x / f_y to the nearest integer, halves away from zero. f_y must be positive. */
+static signed long long phase_detect_round ( signed long long f_x, signed long long f_y )
+{
+    if ( f_x < 0 ) {
+        return -( ( -f_x + f_y / 2 ) / f_y );
+    }
+
+    return ( f_x + f_y / 2 ) / f_y;
+}
@@ -0,0 +1,70 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef __PDAF_PHASE_DETECT_H__
+#define __PDAF_PHASE_DETECT_H__
+
+#include "PdafLibrary.h"
+
+#define D_PHASE_DETECT_NG   (-1)
+#define D_PHASE_DETECT_OK   (0)
+
+/* Function for checking PD image, parameter and windows of PD extraction */
+/* Windows must be in the image, and their size in PD pixels must be D_PD_LIB_PD_WINDOW_SIZE_MAX or less. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern signed char PhaseDetectCheck
+#else
+extern signed char PhaseDetectCheck
+#endif
+(
+    /* Input */
+    const PdLibPdImage_t *pf_Image,
+    const PdLibPdParam_t *pf_Param,
+    unsigned long f_WindowNum,
+    PdLibWindow_t *pf_Window
+);
+
+/* Function for calculating phase difference and confidence level of a window from line profiles */
+/* Profiles are searched from coarse to fine in f_LevelNum levels, and the level of the result is set to pf_Level */
+/* unless it is NULL. Image, parameter and window must be checked by PhaseDetectCheck(). */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void PhaseDetectWindow
+#else
+extern void PhaseDetectWindow
+#endif
+(
+    /* Input */
+    const PdLibPdImage_t *pf_Image,
+    const PdLibPdParam_t *pf_Param,
+    unsigned long f_LevelNum,
+    PdLibWindow_t *pf_Window,
+    /* Output */
+    PdLibPhaseDiffData_t *pf_PhaseDiffData,
+    unsigned char *pf_Level
+);
+
+#endif
@@ -0,0 +1,1074 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/****************************************************************/
+/*                          include                             */
+/****************************************************************/
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "PdafCalibImage.h"
+#include "PdafRecord.h"
+
+#define D_RECORD_BUFFER_SIZE        (65536)         /* Size of buffer of recorder. */
+#define D_RECORD_WINDOW_SIZE_MAX    (96)            /* Maximum size of a window of frame record. */
+#define D_RECORD_FRAME_SIZE_MAX     (32)            /* Maximum size of head of frame record. */
+#define D_RECORD_CALIB_NUM          (16)            /* Number of calibrations remembered by recorder. */
+
+/* Values of windows of the previous frame */
+typedef struct
+{
+    unsigned long       WindowNum;                  /* Number of windows. */
+    unsigned long       Capacity;                   /* Number of windows allocated. */
+    PdLibWindow_t       *p_Window;                  /* Array of PDAF windows. */
+    PdLibPhaseDiffData_t *p_PhaseDiffData;          /* Array of phase difference data. */
+    PdLibOutputData_t   *p_OutputData;              /* Array of output data, 0 when not recorded. */
+    signed long         *p_Result;                  /* Array of results, 0 when not recorded. */
+} RecordHistory_t;
+
+/* Calibration remembered by recorder */
+typedef struct
+{
+    unsigned long       Id;                         /* Id of calibration, 0 when not used. */
+    unsigned long       Size;                       /* Size of calibration image. */
+    unsigned int        Checksum;                   /* Checksum of calibration image. */
+    void                *p_Image;                   /* Calibration image. */
+    PdLibCalibData_t    Key;                        /* Values and table pointers of calibration data last given. */
+    unsigned long       KeyGeneration;              /* Generation of recorder when Key was set. */
+} RecordCalib_t;
+
+struct PdLibRecorder
+{
+    PdLibRecordWrite_t  p_Write;                    /* Write function. */
+    void                *p_User;                    /* First argument of write function. */
+    signed char         Error;                      /* D_RECORD_NG_WRITE after failure of write function. */
+    unsigned long       Pos;                        /* Size of buffered records. */
+    unsigned char       *p_Buffer;                  /* Buffer of D_RECORD_BUFFER_SIZE bytes. */
+    unsigned long       CalibNum;                   /* Number of ids of calibration given. */
+    unsigned long       Generation;                 /* Incremented when tables of calibration data may be changed. */
+    RecordCalib_t       Calib[D_RECORD_CALIB_NUM];  /* Calibration of id i is at (i - 1) % D_RECORD_CALIB_NUM. */
+    void                *p_Image;                   /* Calibration image being checked. */
+    unsigned long       ImageCapacity;              /* Size of p_Image allocated. */
+    RecordHistory_t     History;                    /* Previous frame. */
+};
+
+/* Calibration of replay */
+typedef struct
+{
+    void                *p_Image;                   /* Copy of calibration image aligned for its tables. */
+    PdLibCalibData_t    CalibData;                  /* Calibration data pointing to tables of image. */
+    DefocusOKNGThrLine_t *p_ThrLine;                /* Threshold lines of calibration data. */
+    PdLibContext_t      *p_Context;                 /* Validated context in parallel mode, or NULL. */
+} RecordReplayCalib_t;
+
+/* Reader of stream */
+typedef struct
+{
+    const unsigned char *p_Data;                    /* Stream. */
+    unsigned long       Pos;                        /* Position of next byte. */
+    unsigned long       Size;                       /* Size of stream. */
+    signed char         Error;                      /* D_RECORD_NG after reading out of stream. */
+} RecordReader_t;
+
+/****************************************************************/
+/*                 local function declaration                   */
+/****************************************************************/
+
+static signed char record_history_set ( RecordHistory_t *pf_History, unsigned long f_WindowNum );
+static void record_history_free ( RecordHistory_t *pf_History );
+static signed char record_reserve ( PdLibRecorder_t *pf_Recorder, unsigned long f_Size );
+static signed char record_calib ( PdLibRecorder_t *pf_Recorder, PdLibCalibData_t *pf_CalibData, unsigned long *pf_Id );
+static signed char record_begin_frame ( PdLibRecorder_t *pf_Recorder, unsigned long f_Id, unsigned long f_ImagerAnalogGain, unsigned long f_WindowNum, unsigned char f_Flags );
+static void record_put_window ( PdLibRecorder_t *pf_Recorder, unsigned long f_Index, unsigned char f_Flags, PdLibWindow_t *pf_Window, PdLibPhaseDiffData_t *pf_PhaseDiffData, PdLibOutputData_t *pf_OutputData, signed long f_Result );
+static void record_put_varint ( PdLibRecorder_t *pf_Recorder, unsigned long long f_Value );
+static void record_put_delta ( PdLibRecorder_t *pf_Recorder, signed long long f_Value, signed long long f_Prev );
+static signed char record_get_window ( RecordReader_t *pf_Reader, RecordHistory_t *pf_History, unsigned long f_Index, unsigned char f_Flags );
+static unsigned long long record_get_varint ( RecordReader_t *pf_Reader );
+static signed long long record_get_delta ( RecordReader_t *pf_Reader, signed long long f_Prev );
+static signed char record_replay_calib ( RecordReader_t *pf_Reader, unsigned char f_Mode, unsigned long *pf_CalibNum, unsigned long *pf_Capacity, RecordReplayCalib_t **ppf_Calib );
+static void record_replay_frame ( PdLibExecutor_t *pf_Executor, unsigned char f_Mode, RecordReplayCalib_t *pf_Calib, unsigned long f_ImagerAnalogGain, RecordHistory_t *pf_History, PdLibOutputData_t *pf_OutputData, signed long *pf_Result );
+static void record_set_input_calib ( PdLibCalibData_t *pf_CalibData, unsigned long f_ImagerAnalogGain, PdLibInputData_t *pf_InputData );
+static void record_get_input_calib ( PdLibInputData_t *pf_InputData, PdLibCalibData_t *pf_CalibData );
+static unsigned char record_is_same_calib ( PdLibInputData_t *pf_InputData0, PdLibInputData_t *pf_InputData1 );
+static unsigned char record_is_same_key ( PdLibCalibData_t *pf_CalibData0, PdLibCalibData_t *pf_CalibData1 );
+
+/****************************************************************/
+/*                      external function                       */
+/****************************************************************/
+
+/* Function for creating recorder and writing header of stream */
+extern signed char RecordCreate
+(
+    /* Input */
+    PdLibRecordWrite_t pf_Write,
+    void *pf_User,
+    /* Output */
+    PdLibRecorder_t **ppf_Recorder
+)
+{
+    PdLibRecorder_t *p_Recorder;
+    RecordHeader_t Header;
+
+    (*ppf_Recorder) = NULL;
+
+    /* Pointers and counts are 0 */
+    p_Recorder = (PdLibRecorder_t *)calloc ( 1, sizeof(PdLibRecorder_t) );
+
+    if ( p_Recorder == NULL ) {
+        return D_RECORD_NG_ALLOC;
+    }
+
+    (*p_Recorder).p_Buffer = (unsigned char *)malloc ( D_RECORD_BUFFER_SIZE );
+
+    if ( (*p_Recorder).p_Buffer == NULL ) {
+        free ( p_Recorder );
+        return D_RECORD_NG_ALLOC;
+    }
+
+    (*p_Recorder).p_Write = pf_Write;
+    (*p_Recorder).p_User  = pf_User;
+    (*p_Recorder).Error   = D_RECORD_OK;
+
+    memset ( &Header, 0, sizeof(Header) );
+    Header.Magic        = D_RECORD_MAGIC;
+    Header.MajorVersion = D_RECORD_MAJOR_VERSION;
+    Header.MinorVersion = D_RECORD_MINOR_VERSION;
+    Header.LongSize     = (unsigned short)sizeof(long);
+    Header.HeaderSize   = (unsigned short)sizeof(RecordHeader_t);
+
+    memcpy ( (*p_Recorder).p_Buffer, &Header, sizeof(Header) );
+    (*p_Recorder).Pos = sizeof(Header);
+
+    (*ppf_Recorder) = p_Recorder;
+
+    return D_RECORD_OK;
+}
+
+/* Function for flushing and destroying recorder */
+extern void RecordDestroy
+(
+    /* Input */
+    PdLibRecorder_t *pf_Recorder
+)
+{
+    unsigned long i;
+
+    if ( pf_Recorder == NULL ) {
+        return ;
+    }
+
+    (void)RecordFlush ( pf_Recorder );                      /* Result is given by RecordFlush() before */
+
+    for ( i = 0; i < D_RECORD_CALIB_NUM; i++ ) {
+        free ( (*pf_Recorder).Calib[i].p_Image );
+    }
+
+    record_history_free ( &((*pf_Recorder).History) );
+    free ( (*pf_Recorder).p_Image );
+    free ( (*pf_Recorder).p_Buffer );
+    free ( pf_Recorder );
+
+    return ;
+}
+
+/* Function for writing buffered records by write function */
+extern signed char RecordFlush
+(
+    /* Input */
+    PdLibRecorder_t *pf_Recorder
+)
+{
+    if ( (*pf_Recorder).Error != D_RECORD_OK ) {
+        return (*pf_Recorder).Error;
+    }
+
+    if ( (*pf_Recorder).Pos != 0 ) {
+        if ( (*pf_Recorder).p_Write ( (*pf_Recorder).p_User, (*pf_Recorder).p_Buffer, (*pf_Recorder).Pos ) != 0 ) {
+            (*pf_Recorder).Error = D_RECORD_NG_WRITE;
+            return D_RECORD_NG_WRITE;
+        }
+
+        (*pf_Recorder).Pos = 0;
+    }
+
+    return D_RECORD_OK;
+}
+
+/* Function for telling recorder that tables of calibration data may have been changed */
+extern void RecordInvalidateCalib
+(
+    /* Input */
+    PdLibRecorder_t *pf_Recorder
+)
+{
+    (*pf_Recorder).Generation++;                            /* Keys of all calibrations are out of date */
+
+    return ;
+}
+
+/* Function for recording a frame of windows sharing calibration data */
+extern signed char RecordBatch
+(
+    /* Input */
+    PdLibRecorder_t *pf_Recorder,
+    PdLibCalibData_t *pf_CalibData,
+    unsigned long f_ImagerAnalogGain,
+    unsigned long f_WindowNum,
+    PdLibWindow_t *pf_Window,
+    PdLibPhaseDiffData_t *pf_PhaseDiffData,
+    PdLibOutputData_t *pf_OutputData,
+    signed long *pf_Result
+)
+{
+    unsigned long i;
+    unsigned long Id;
+    unsigned char Flags;
+    signed char ret;
+    RecordHistory_t *p_History;
+
+    ret = record_calib ( pf_Recorder, pf_CalibData, &Id );
+
+    if ( ret != D_RECORD_OK ) {
+        return ret;
+    }
+
+    p_History = &((*pf_Recorder).History);
+    Flags     = ( pf_OutputData != NULL && pf_Result != NULL ) ? D_RECORD_FLAG_OUTPUT : 0;
+
+    if ( f_WindowNum == (*p_History).WindowNum ) {
+        Flags |= D_RECORD_FLAG_SAME_WINDOW;
+
+        for ( i = 0; i < f_WindowNum; i++ ) {
+            if ( memcmp ( &(pf_Window[i]), &((*p_History).p_Window[i]), sizeof(PdLibWindow_t) ) != 0 ) {
+                Flags &= (unsigned char)~D_RECORD_FLAG_SAME_WINDOW;
+                break ;
+            }
+        }
+    }
+
+    ret = record_begin_frame ( pf_Recorder, Id, f_ImagerAnalogGain, f_WindowNum, Flags );
+
+    for ( i = 0; i < f_WindowNum && ret == D_RECORD_OK; i++ ) {
+        ret = record_reserve ( pf_Recorder, D_RECORD_WINDOW_SIZE_MAX );
+
+        if ( ret == D_RECORD_OK ) {
+            record_put_window ( pf_Recorder, i, Flags, &(pf_Window[i]), &(pf_PhaseDiffData[i]),
+                                ( ( Flags & D_RECORD_FLAG_OUTPUT ) != 0 ) ? &(pf_OutputData[i]) : NULL,
+                                ( ( Flags & D_RECORD_FLAG_OUTPUT ) != 0 ) ? pf_Result[i] : 0 );
+        }
+    }
+
+    return ret;
+}
+
+/* Function for recording input data */
+extern signed char RecordInput
+(
+    /* Input */
+    PdLibRecorder_t *pf_Recorder,
+    unsigned long f_InputNum,
+    PdLibInputData_t *pf_InputData,
+    PdLibOutputData_t *pf_OutputData,
+    signed long *pf_Result
+)
+{
+    unsigned long Start;
+    unsigned long End;
+    signed char ret;
+
+    ret = D_RECORD_OK;
+
+    for ( Start = 0; Start < f_InputNum && ret == D_RECORD_OK; Start = End ) {
+        unsigned long i;
+        unsigned long Id;
+        unsigned char Flags;
+        PdLibCalibData_t CalibData;
+        RecordHistory_t *p_History;
+
+        /* Input data of the same calibration and gain */
+        for ( End = Start + 1; End < f_InputNum; End++ ) {
+            if ( record_is_same_calib ( &(pf_InputData[Start]), &(pf_InputData[End]) ) == 0 ) {
+                break ;
+            }
+        }
+
+        record_get_input_calib ( &(pf_InputData[Start]), &CalibData );
+
+        ret = record_calib ( pf_Recorder, &CalibData, &Id );
+
+        if ( ret != D_RECORD_OK ) {
+            break ;
+        }
+
+        p_History = &((*pf_Recorder).History);
+        Flags     = ( pf_OutputData != NULL && pf_Result != NULL ) ? D_RECORD_FLAG_OUTPUT : 0;
+
+        if ( End - Start == (*p_History).WindowNum ) {
+            Flags |= D_RECORD_FLAG_SAME_WINDOW;
+
+            for ( i = 0; i < End - Start; i++ ) {
+                PdLibInputData_t *p_Input;
+                PdLibWindow_t *p_Window;
+
+                p_Input  = &(pf_InputData[Start+i]);
+                p_Window = &((*p_History).p_Window[i]);
+
+                if ( (*p_Input).XAddressOfWindowStart != (*p_Window).XAddressOfWindowStart ||
+                     (*p_Input).YAddressOfWindowStart != (*p_Window).YAddressOfWindowStart ||
+                     (*p_Input).XAddressOfWindowEnd   != (*p_Window).XAddressOfWindowEnd   ||
+                     (*p_Input).YAddressOfWindowEnd   != (*p_Window).YAddressOfWindowEnd ) {
+                    Flags &= (unsigned char)~D_RECORD_FLAG_SAME_WINDOW;
+                    break ;
+                }
+            }
+        }
+
+        ret = record_begin_frame ( pf_Recorder, Id, pf_InputData[Start].ImagerAnalogGain, End - Start, Flags );
+
+        for ( i = Start; i < End && ret == D_RECORD_OK; i++ ) {
+            PdLibWindow_t Window;
+            PdLibPhaseDiffData_t PhaseDiffData;
+
+            Window.XAddressOfWindowStart   = pf_InputData[i].XAddressOfWindowStart;
+            Window.YAddressOfWindowStart   = pf_InputData[i].YAddressOfWindowStart;
+            Window.XAddressOfWindowEnd     = pf_InputData[i].XAddressOfWindowEnd;
+            Window.YAddressOfWindowEnd     = pf_InputData[i].YAddressOfWindowEnd;
+            PhaseDiffData.PhaseDifference  = pf_InputData[i].PhaseDifference;
+            PhaseDiffData.ConfidenceLevel  = pf_InputData[i].ConfidenceLevel;
+
+            ret = record_reserve ( pf_Recorder, D_RECORD_WINDOW_SIZE_MAX );
+
+            if ( ret == D_RECORD_OK ) {
+                record_put_window ( pf_Recorder, i - Start, Flags, &Window, &PhaseDiffData,
+                                    ( ( Flags & D_RECORD_FLAG_OUTPUT ) != 0 ) ? &(pf_OutputData[i]) : NULL,
+                                    ( ( Flags & D_RECORD_FLAG_OUTPUT ) != 0 ) ? pf_Result[i] : 0 );
+            }
+        }
+    }
+
+    return ret;
+}
+
+/* Function for replaying stream and comparing output data with recorded ones */
+extern signed char RecordReplay
+(
+    /* Input */
+    PdLibExecutor_t *pf_Executor,
+    const void *pf_Stream,
+    unsigned long f_Size,
+    unsigned char f_Mode,
+    /* Output */
+    PdLibReplayStats_t *pf_Stats
+)
+{
+    unsigned long i;
+    unsigned long CalibNum;
+    unsigned long CalibCapacity;
+    unsigned long OutputCapacity;
+    signed char ret;
+    RecordHeader_t Header;
+    RecordReader_t Reader;
+    RecordHistory_t History;
+    RecordReplayCalib_t *p_Calib;
+    PdLibOutputData_t *p_OutputData;
+    signed long *p_Result;
+
+    memset ( pf_Stats, 0, sizeof(PdLibReplayStats_t) );
+
+    if ( f_Size < sizeof(RecordHeader_t) ) {
+        return D_RECORD_NG;
+    }
+
+    memcpy ( &Header, pf_Stream, sizeof(Header) );          /* Stream may not be aligned */
+
+    if ( Header.Magic != D_RECORD_MAGIC || Header.MajorVersion != D_RECORD_MAJOR_VERSION ||
+         Header.LongSize != sizeof(long) || Header.HeaderSize < sizeof(RecordHeader_t) || f_Size < Header.HeaderSize ) {
+        return D_RECORD_NG;
+    }
+
+    Reader.p_Data = (const unsigned char *)pf_Stream;
+    Reader.Pos    = Header.HeaderSize;
+    Reader.Size   = f_Size;
+    Reader.Error  = D_RECORD_OK;
+
+    memset ( &History, 0, sizeof(History) );
+    CalibNum       = 0;
+    CalibCapacity  = 0;
+    OutputCapacity = 0;
+    p_Calib        = NULL;
+    p_OutputData   = NULL;
+    p_Result       = NULL;
+    ret            = D_RECORD_OK;
+
+    while ( Reader.Pos < Reader.Size && ret == D_RECORD_OK ) {
+        unsigned char Type;
+
+        Type = Reader.p_Data[Reader.Pos++];
+
+        if ( Type == D_RECORD_TYPE_CALIB ) {
+            ret = record_replay_calib ( &Reader, f_Mode, &CalibNum, &CalibCapacity, &p_Calib );
+        } else if ( Type == D_RECORD_TYPE_FRAME ) {
+            unsigned long long Id;
+            unsigned long long ImagerAnalogGain;
+            unsigned long long WindowNum;
+            unsigned char Flags;
+
+            Id               = record_get_varint ( &Reader );
+            ImagerAnalogGain = record_get_varint ( &Reader );
+            WindowNum        = record_get_varint ( &Reader );
+            Flags            = (unsigned char)record_get_varint ( &Reader );
+
+            /* A window has 2 bytes at least, which limits allocation for broken stream */
+            if ( Reader.Error != D_RECORD_OK || Id == 0 || CalibNum < Id || (unsigned long)ImagerAnalogGain != ImagerAnalogGain ||
+                 ( Reader.Size - Reader.Pos ) / 2 < WindowNum ||
+                 ( ( Flags & D_RECORD_FLAG_SAME_WINDOW ) != 0 && WindowNum != History.WindowNum ) ) {
+                ret = D_RECORD_NG;
+                break ;
+            }
+
+            ret = record_history_set ( &History, (unsigned long)WindowNum );
+
+            if ( ret == D_RECORD_OK && OutputCapacity < WindowNum ) {
+                free ( p_OutputData );
+                free ( p_Result );
+                p_OutputData   = (PdLibOutputData_t *)malloc ( sizeof(PdLibOutputData_t) * (size_t)WindowNum );
+                p_Result       = (signed long *)malloc ( sizeof(signed long) * (size_t)WindowNum );
+                OutputCapacity = ( p_OutputData != NULL && p_Result != NULL ) ? (unsigned long)WindowNum : 0;
+                ret            = ( OutputCapacity != 0 ) ? D_RECORD_OK : D_RECORD_NG_ALLOC;
+            }
+
+            for ( i = 0; i < WindowNum && ret == D_RECORD_OK; i++ ) {
+                ret = record_get_window ( &Reader, &History, i, Flags );
+            }
+
+            if ( ret != D_RECORD_OK ) {
+                break ;
+            }
+
+            if ( ( Flags & D_RECORD_FLAG_OUTPUT ) == 0 ) {  /* Output data of the next frame are deltas from 0 */
+                memset ( History.p_OutputData, 0, sizeof(PdLibOutputData_t) * History.WindowNum );
+                memset ( History.p_Result, 0, sizeof(signed long) * History.WindowNum );
+            }
+
+            record_replay_frame ( pf_Executor, f_Mode, &(p_Calib[Id-1]), (unsigned long)ImagerAnalogGain, &History, p_OutputData, p_Result );
+
+            if ( ( Flags & D_RECORD_FLAG_OUTPUT ) != 0 ) {  /* Compare with recorded output data */
+                for ( i = 0; i < WindowNum; i++ ) {
+                    PdLibOutputData_t *p_Recorded;
+
+                    p_Recorded = &(History.p_OutputData[i]);
+
+                    if ( p_Result[i] != History.p_Result[i] ||
+                         p_OutputData[i].Defocus != (*p_Recorded).Defocus ||
+                         p_OutputData[i].DefocusConfidence != (*p_Recorded).DefocusConfidence ||
+                         p_OutputData[i].DefocusConfidenceLevel != (*p_Recorded).DefocusConfidenceLevel ||
+                         p_OutputData[i].PhaseDifference != (*p_Recorded).PhaseDifference ) {
+                        if ( (*pf_Stats).MismatchNum == 0 ) {
+                            (*pf_Stats).FirstMismatchFrame  = (*pf_Stats).FrameNum;
+                            (*pf_Stats).FirstMismatchWindow = i;
+                        }
+                        (*pf_Stats).MismatchNum++;
+                    }
+                }
+
+                (*pf_Stats).CheckedWindowNum += (unsigned long)WindowNum;
+            }
+
+            (*pf_Stats).FrameNum++;
+            (*pf_Stats).WindowNum += (unsigned long)WindowNum;
+        } else {
+            ret = D_RECORD_NG;                              /* Unknown record */
+        }
+    }
+
+    for ( i = 0; i < CalibNum; i++ ) {
+        PdLibDestroyContext ( p_Calib[i].p_Context );
+        free ( p_Calib[i].p_ThrLine );
+        free ( p_Calib[i].p_Image );
+    }
+
+    free ( p_Calib );
+    free ( p_OutputData );
+    free ( p_Result );
+    record_history_free ( &History );
+
+    return ret;
+}
+
+/****************************************************************/
+/*                       local function                         */
+/****************************************************************/
+
+/* Function for setting number of windows of history. Values are cleared to 0 when it is changed. */
+static signed char record_history_set ( RecordHistory_t *pf_History, unsigned long f_WindowNum )
+{
+    size_t Size;
+    unsigned char *p_Memory;
+
+    if ( f_WindowNum == (*pf_History).WindowNum ) {
+        return D_RECORD_OK;
+    }
+
+    if ( (*pf_History).Capacity < f_WindowNum ) {
+        record_history_free ( pf_History );
+
+        /* Arrays in one allocation. Each element size is a multiple of the alignment of the next array. */
+        Size = ( sizeof(PdLibOutputData_t) + sizeof(PdLibPhaseDiffData_t) + sizeof(signed long) + sizeof(PdLibWindow_t) ) * (size_t)f_WindowNum;
+
+        p_Memory = (unsigned char *)malloc ( Size );
+
+        if ( p_Memory == NULL ) {
+            return D_RECORD_NG_ALLOC;
+        }
+
+        (*pf_History).p_OutputData    = (PdLibOutputData_t *)p_Memory;
+        (*pf_History).p_PhaseDiffData = (PdLibPhaseDiffData_t *)( (*pf_History).p_OutputData + f_WindowNum );
+        (*pf_History).p_Result        = (signed long *)( (*pf_History).p_PhaseDiffData + f_WindowNum );
+        (*pf_History).p_Window        = (PdLibWindow_t *)( (*pf_History).p_Result + f_WindowNum );
+        (*pf_History).Capacity        = f_WindowNum;
+    }
+
+    memset ( (*pf_History).p_OutputData, 0, sizeof(PdLibOutputData_t) * f_WindowNum );
+    memset ( (*pf_History).p_PhaseDiffData, 0, sizeof(PdLibPhaseDiffData_t) * f_WindowNum );
+    memset ( (*pf_History).p_Result, 0, sizeof(signed long) * f_WindowNum );
+    memset ( (*pf_History).p_Window, 0, sizeof(PdLibWindow_t) * f_WindowNum );
+
+    (*pf_History).WindowNum = f_WindowNum;
+
+    return D_RECORD_OK;
+}
+
+/* Function for releasing arrays of history */
+static void record_history_free ( RecordHistory_t *pf_History )
+{
+    free ( (*pf_History).p_OutputData );                    /* Head of allocation */
+
+    (*pf_History).WindowNum       = 0;
+    (*pf_History).Capacity        = 0;
+    (*pf_History).p_OutputData    = NULL;
+    (*pf_History).p_PhaseDiffData = NULL;
+    (*pf_History).p_Result        = NULL;
+    (*pf_History).p_Window        = NULL;
+
+    return ;
+}
+
+/* Function for making f_Size bytes of buffer available */
+static signed char record_reserve ( PdLibRecorder_t *pf_Recorder, unsigned long f_Size )
+{
+    if ( D_RECORD_BUFFER_SIZE < (*pf_Recorder).Pos + f_Size ) {
+        return RecordFlush ( pf_Recorder );
+    }
+
+    return (*pf_Recorder).Error;
+}
+
+/* Function for getting id of calibration, and writing it when recorder does not remember it */
+/* Calibration data of the same values and tables as the last one of an id in the same generation */
+/* has the id without serialization. Otherwise its image is compared with the remembered ones. */
+static signed char record_calib ( PdLibRecorder_t *pf_Recorder, PdLibCalibData_t *pf_CalibData, unsigned long *pf_Id )
+{
+    unsigned long i;
+    unsigned long Size;
+    unsigned long SensorMode;
+    unsigned int Checksum;
+    signed char ret;
+    RecordCalib_t *p_Calib;
+
+    /* Calibration given before whose tables are not changed */
+    for ( i = 0; i < D_RECORD_CALIB_NUM; i++ ) {
+        p_Calib = &((*pf_Recorder).Calib[i]);
+
+        if ( (*p_Calib).Id != 0 && (*p_Calib).KeyGeneration == (*pf_Recorder).Generation &&
+             record_is_same_key ( &((*p_Calib).Key), pf_CalibData ) != 0 ) {
+            (*pf_Id) = (*p_Calib).Id;
+            return D_RECORD_OK;
+        }
+    }
+
+    if ( CalibImageCalcSize ( 1, pf_CalibData, &Size ) != D_CALIB_IMAGE_OK ) {
+        return D_RECORD_NG;
+    }
+
+    if ( (*pf_Recorder).ImageCapacity < Size ) {
+        free ( (*pf_Recorder).p_Image );
+
+        (*pf_Recorder).p_Image       = malloc ( Size );     /* Aligned for any type */
+        (*pf_Recorder).ImageCapacity = ( (*pf_Recorder).p_Image != NULL ) ? Size : 0;
+
+        if ( (*pf_Recorder).p_Image == NULL ) {
+            return D_RECORD_NG_ALLOC;
+        }
+    }
+
+    SensorMode = 0;
+
+    if ( CalibImageWrite ( 1, pf_CalibData, &SensorMode, Size, (*pf_Recorder).p_Image ) != D_CALIB_IMAGE_OK ) {
+        return D_RECORD_NG;
+    }
+
+    Checksum = (*(CalibImageHeader_t *)(*pf_Recorder).p_Image).Checksum;
+
+    /* Calibration remembered. Checksum is compared first. */
+    for ( i = 0; i < D_RECORD_CALIB_NUM; i++ ) {
+        p_Calib = &((*pf_Recorder).Calib[i]);
+
+        if ( (*p_Calib).Id != 0 && (*p_Calib).Size == Size && (*p_Calib).Checksum == Checksum &&
+             memcmp ( (*p_Calib).p_Image, (*pf_Recorder).p_Image, Size ) == 0 ) {
+            (*p_Calib).Key           = (*pf_CalibData);
+            (*p_Calib).KeyGeneration = (*pf_Recorder).Generation;
+
+            (*pf_Id) = (*p_Calib).Id;
+            return D_RECORD_OK;
+        }
+    }
+
+    /* New calibration replaces the oldest one */
+    ret = record_reserve ( pf_Recorder, D_RECORD_FRAME_SIZE_MAX );
+
+    if ( ret != D_RECORD_OK ) {
+        return ret;
+    }
+
+    p_Calib = &((*pf_Recorder).Calib[ (*pf_Recorder).CalibNum % D_RECORD_CALIB_NUM ]);
+
+    free ( (*p_Calib).p_Image );
+    (*p_Calib).Id      = 0;
+    (*p_Calib).p_Image = malloc ( Size );
+
+    if ( (*p_Calib).p_Image == NULL ) {
+        return D_RECORD_NG_ALLOC;
+    }
+
+    (*pf_Recorder).CalibNum++;
+
+    memcpy ( (*p_Calib).p_Image, (*pf_Recorder).p_Image, Size );
+    (*p_Calib).Id            = (*pf_Recorder).CalibNum;
+    (*p_Calib).Size          = Size;
+    (*p_Calib).Checksum      = Checksum;
+    (*p_Calib).Key           = (*pf_CalibData);
+    (*p_Calib).KeyGeneration = (*pf_Recorder).Generation;
+
+    (*pf_Recorder).p_Buffer[(*pf_Recorder).Pos++] = D_RECORD_TYPE_CALIB;
+    record_put_varint ( pf_Recorder, (*p_Calib).Id );
+    record_put_varint ( pf_Recorder, Size );
+
+    if ( Size <= D_RECORD_BUFFER_SIZE - (*pf_Recorder).Pos ) {
+        memcpy ( (*pf_Recorder).p_Buffer + (*pf_Recorder).Pos, (*p_Calib).p_Image, Size );
+        (*pf_Recorder).Pos += Size;
+    } else {                                                /* Image larger than buffer is written directly */
+        ret = RecordFlush ( pf_Recorder );
+
+        if ( ret != D_RECORD_OK ) {
+            return ret;
+        }
+
+        if ( (*pf_Recorder).p_Write ( (*pf_Recorder).p_User, (*p_Calib).p_Image, Size ) != 0 ) {
+            (*pf_Recorder).Error = D_RECORD_NG_WRITE;
+            return D_RECORD_NG_WRITE;
+        }
+    }
+
+    (*pf_Id) = (*p_Calib).Id;
+
+    return D_RECORD_OK;
+}
+
+/* Function for writing head of frame record and setting number of windows of history */
+static signed char record_begin_frame ( PdLibRecorder_t *pf_Recorder, unsigned long f_Id, unsigned long f_ImagerAnalogGain, unsigned long f_WindowNum, unsigned char f_Flags )
+{
+    signed char ret;
+
+    ret = record_history_set ( &((*pf_Recorder).History), f_WindowNum );
+
+    if ( ret == D_RECORD_OK ) {
+        ret = record_reserve ( pf_Recorder, D_RECORD_FRAME_SIZE_MAX );
+    }
+
+    if ( ret != D_RECORD_OK ) {
+        return ret;
+    }
+
+    (*pf_Recorder).p_Buffer[(*pf_Recorder).Pos++] = D_RECORD_TYPE_FRAME;
+    record_put_varint ( pf_Recorder, f_Id );
+    record_put_varint ( pf_Recorder, f_ImagerAnalogGain );
+    record_put_varint ( pf_Recorder, f_WindowNum );
+    record_put_varint ( pf_Recorder, f_Flags );
+
+    if ( ( f_Flags & D_RECORD_FLAG_OUTPUT ) == 0 ) {        /* Output data of the next frame are deltas from 0 */
+        memset ( (*pf_Recorder).History.p_OutputData, 0, sizeof(PdLibOutputData_t) * f_WindowNum );
+        memset ( (*pf_Recorder).History.p_Result, 0, sizeof(signed long) * f_WindowNum );
+    }
+
+    return D_RECORD_OK;
+}
+
+/* Function for writing a window of frame record. D_RECORD_WINDOW_SIZE_MAX bytes must be reserved. */
+static void record_put_window ( PdLibRecorder_t *pf_Recorder, unsigned long f_Index, unsigned char f_Flags, PdLibWindow_t *pf_Window, PdLibPhaseDiffData_t *pf_PhaseDiffData, PdLibOutputData_t *pf_OutputData, signed long f_Result )
+{
+    RecordHistory_t *p_History;
+
+    p_History = &((*pf_Recorder).History);
+
+    if ( ( f_Flags & D_RECORD_FLAG_SAME_WINDOW ) == 0 ) {
+        PdLibWindow_t Prev;
+
+        if ( f_Index != 0 ) {
+            Prev = (*p_History).p_Window[f_Index-1];        /* Previous window of this frame */
+        } else {
+            memset ( &Prev, 0, sizeof(Prev) );
+        }
+
+        record_put_delta ( pf_Recorder, (*pf_Window).XAddressOfWindowStart, Prev.XAddressOfWindowStart );
+        record_put_delta ( pf_Recorder, (*pf_Window).YAddressOfWindowStart, Prev.YAddressOfWindowStart );
+        record_put_delta ( pf_Recorder, (*pf_Window).XAddressOfWindowEnd,   Prev.XAddressOfWindowEnd );
+        record_put_delta ( pf_Recorder, (*pf_Window).YAddressOfWindowEnd,   Prev.YAddressOfWindowEnd );
+
+        (*p_History).p_Window[f_Index] = (*pf_Window);
+    }
+
+    record_put_delta ( pf_Recorder, (*pf_PhaseDiffData).PhaseDifference, (*p_History).p_PhaseDiffData[f_Index].PhaseDifference );
+    record_put_delta ( pf_Recorder, (signed long long)(*pf_PhaseDiffData).ConfidenceLevel, (signed long long)(*p_History).p_PhaseDiffData[f_Index].ConfidenceLevel );
+
+    (*p_History).p_PhaseDiffData[f_Index] = (*pf_PhaseDiffData);
+
+    if ( pf_OutputData != NULL ) {
+        PdLibOutputData_t *p_Prev;
+
+        p_Prev = &((*p_History).p_OutputData[f_Index]);
+
+        record_put_delta ( pf_Recorder, f_Result, 0 );
+        record_put_delta ( pf_Recorder, (*pf_OutputData).DefocusConfidence, 0 );
+        record_put_delta ( pf_Recorder, (*pf_OutputData).Defocus, (*p_Prev).Defocus );
+        record_put_delta ( pf_Recorder, (signed long long)(*pf_OutputData).DefocusConfidenceLevel, (signed long long)(*p_Prev).DefocusConfidenceLevel );
+        record_put_delta ( pf_Recorder, (*pf_OutputData).PhaseDifference, (*p_Prev).PhaseDifference );
+
+        (*p_Prev) = (*pf_OutputData);
+        (*p_History).p_Result[f_Index] = f_Result;
+    }
+
+    return ;
+}
+
+/* Function for writing LEB128 varint to reserved buffer */
+static void record_put_varint ( PdLibRecorder_t *pf_Recorder, unsigned long long f_Value )
+{
+    unsigned char *p_Buffer;
+
+    p_Buffer = (*pf_Recorder).p_Buffer + (*pf_Recorder).Pos;
+
+    while ( 0x80 <= f_Value ) {
+        *p_Buffer++ = (unsigned char)( f_Value | 0x80 );
+        f_Value >>= 7;
+    }
+    *p_Buffer++ = (unsigned char)f_Value;
+
+    (*pf_Recorder).Pos = (unsigned long)( p_Buffer - (*pf_Recorder).p_Buffer );
+
+    return ;
+}
+
+/* Function for writing zigzag coded delta in 64 bit two's complement */
+static void record_put_delta ( PdLibRecorder_t *pf_Recorder, signed long long f_Value, signed long long f_Prev )
+{
+    unsigned long long Delta;
+
+    Delta = (unsigned long long)f_Value - (unsigned long long)f_Prev;
+
+    record_put_varint ( pf_Recorder, ( Delta << 1 ) ^ ( 0 - ( Delta >> 63 ) ) );
+
+    return ;
+}
+
+/* Function for reading a window of frame record to history */
+static signed char record_get_window ( RecordReader_t *pf_Reader, RecordHistory_t *pf_History, unsigned long f_Index, unsigned char f_Flags )
+{
+    if ( ( f_Flags & D_RECORD_FLAG_SAME_WINDOW ) == 0 ) {
+        PdLibWindow_t Prev;
+        PdLibWindow_t *p_Window;
+
+        if ( f_Index != 0 ) {
+            Prev = (*pf_History).p_Window[f_Index-1];
+        } else {
+            memset ( &Prev, 0, sizeof(Prev) );
+        }
+
+        p_Window = &((*pf_History).p_Window[f_Index]);
+
+        (*p_Window).XAddressOfWindowStart = (unsigned short)record_get_delta ( pf_Reader, Prev.XAddressOfWindowStart );
+        (*p_Window).YAddressOfWindowStart = (unsigned short)record_get_delta ( pf_Reader, Prev.YAddressOfWindowStart );
+        (*p_Window).XAddressOfWindowEnd   = (unsigned short)record_get_delta ( pf_Reader, Prev.XAddressOfWindowEnd );
+        (*p_Window).YAddressOfWindowEnd   = (unsigned short)record_get_delta ( pf_Reader, Prev.YAddressOfWindowEnd );
+    }
+
+    (*pf_History).p_PhaseDiffData[f_Index].PhaseDifference = (signed long)record_get_delta ( pf_Reader, (*pf_History).p_PhaseDiffData[f_Index].PhaseDifference );
+    (*pf_History).p_PhaseDiffData[f_Index].ConfidenceLevel = (unsigned long)record_get_delta ( pf_Reader, (signed long long)(*pf_History).p_PhaseDiffData[f_Index].ConfidenceLevel );
+
+    if ( ( f_Flags & D_RECORD_FLAG_OUTPUT ) != 0 ) {
+        PdLibOutputData_t *p_Prev;
+
+        p_Prev = &((*pf_History).p_OutputData[f_Index]);
+
+        (*pf_History).p_Result[f_Index] = (signed long)record_get_delta ( pf_Reader, 0 );
+        (*p_Prev).DefocusConfidence      = (signed char)record_get_delta ( pf_Reader, 0 );
+        (*p_Prev).Defocus                = (signed long)record_get_delta ( pf_Reader, (*p_Prev).Defocus );
+        (*p_Prev).DefocusConfidenceLevel = (unsigned long)record_get_delta ( pf_Reader, (signed long long)(*p_Prev).DefocusConfidenceLevel );
+        (*p_Prev).PhaseDifference        = (signed long)record_get_delta ( pf_Reader, (*p_Prev).PhaseDifference );
+    }
+
+    return (*pf_Reader).Error;
+}
+
+/* Function for reading LEB128 varint */
+static unsigned long long record_get_varint ( RecordReader_t *pf_Reader )
+{
+    unsigned long Shift;
+    unsigned long long Value;
+
+    Value = 0;
+
+    for ( Shift = 0; Shift < 64; Shift += 7 ) {
+        unsigned char Byte;
+
+        if ( (*pf_Reader).Size <= (*pf_Reader).Pos ) {
+            break ;
+        }
+
+        Byte   = (*pf_Reader).p_Data[(*pf_Reader).Pos++];
+        Value |= (unsigned long long)( Byte & 0x7F ) << Shift;
+
+        if ( ( Byte & 0x80 ) == 0 ) {
+            return Value;
+        }
+    }
+
+    (*pf_Reader).Error = D_RECORD_NG;                       /* End of stream or longer than 64 bit */
+
+    return 0;
+}
+
+/* Function for reading zigzag coded delta in 64 bit two's complement */
+static signed long long record_get_delta ( RecordReader_t *pf_Reader, signed long long f_Prev )
+{
+    unsigned long long Zigzag;
+    unsigned long long Value;
+
+    Zigzag = record_get_varint ( pf_Reader );
+    Value  = (unsigned long long)f_Prev + ( ( Zigzag >> 1 ) ^ ( 0 - ( Zigzag & 1 ) ) );
+
+    /* Value - 2^64 for negative value without overflow */
+    return ( ( Value >> 63 ) != 0 ) ? -(signed long long)( ~Value ) - 1 : (signed long long)Value;
+}
+
+/* Function for reading calibration record, and keeping its image and context */
+static signed char record_replay_calib ( RecordReader_t *pf_Reader, unsigned char f_Mode, unsigned long *pf_CalibNum, unsigned long *pf_Capacity, RecordReplayCalib_t **ppf_Calib )
+{
+    unsigned long long Id;
+    unsigned long long Size;
+    unsigned long LineNum;
+    RecordReplayCalib_t *p_Calib;
+
+    Id   = record_get_varint ( pf_Reader );
+    Size = record_get_varint ( pf_Reader );
+
+    if ( (*pf_Reader).Error != D_RECORD_OK || Id != (*pf_CalibNum) + 1 || (*pf_Reader).Size - (*pf_Reader).Pos < Size ) {
+        return D_RECORD_NG;
+    }
+
+    if ( (*pf_Capacity) == (*pf_CalibNum) ) {               /* Capacity is doubled */
+        RecordReplayCalib_t *p_New;
+        unsigned long Capacity;
+
+        Capacity = ( (*pf_Capacity) != 0 ) ? 2 * (*pf_Capacity) : 8;
+        p_New    = (RecordReplayCalib_t *)realloc ( (*ppf_Calib), sizeof(RecordReplayCalib_t) * Capacity );
+
+        if ( p_New == NULL ) {
+            return D_RECORD_NG_ALLOC;
+        }
+
+        (*ppf_Calib)   = p_New;
+        (*pf_Capacity) = Capacity;
+    }
+
+    p_Calib = &((*ppf_Calib)[(*pf_CalibNum)]);
+    memset ( p_Calib, 0, sizeof(RecordReplayCalib_t) );
+    (*pf_CalibNum)++;                                       /* Released by caller from here */
+
+    (*p_Calib).p_Image = malloc ( (size_t)Size );           /* Aligned for any type */
+
+    if ( (*p_Calib).p_Image == NULL ) {
+        return D_RECORD_NG_ALLOC;
+    }
+
+    memcpy ( (*p_Calib).p_Image, (*pf_Reader).p_Data + (*pf_Reader).Pos, (size_t)Size );
+    (*pf_Reader).Pos += (unsigned long)Size;
+
+    if ( CalibImageCheck ( (*p_Calib).p_Image, (unsigned long)Size ) != D_CALIB_IMAGE_OK ||
+         CalibImageGetMode ( (*p_Calib).p_Image, (unsigned long)Size, 0, &((*p_Calib).CalibData), NULL, &LineNum ) != D_CALIB_IMAGE_OK ) {
+        return D_RECORD_NG;
+    }
+
+    (*p_Calib).p_ThrLine = (DefocusOKNGThrLine_t *)malloc ( sizeof(DefocusOKNGThrLine_t) * LineNum );
+
+    if ( (*p_Calib).p_ThrLine == NULL ) {
+        return D_RECORD_NG_ALLOC;
+    }
+
+    (void)CalibImageGetMode ( (*p_Calib).p_Image, (unsigned long)Size, 0, &((*p_Calib).CalibData), (*p_Calib).p_ThrLine, &LineNum );
+
+    if ( f_Mode == D_PD_LIB_REPLAY_PARALLEL ) {
+        if ( PdLibCreateContext ( &((*p_Calib).CalibData), &((*p_Calib).p_Context) ) != D_PD_LIB_E_OK ) {
+            return D_RECORD_NG_ALLOC;
+        }
+
+        if ( PdLibValidateContext ( (*p_Calib).p_Context ) != D_PD_LIB_E_OK ) {
+            PdLibDestroyContext ( (*p_Calib).p_Context );   /* Evaluated by PdLibGetDefocusBatch() */
+            (*p_Calib).p_Context = NULL;
+        }
+    }
+
+    return D_RECORD_OK;
+}
+
+/* Function for evaluating windows of history in replay mode */
+static void record_replay_frame ( PdLibExecutor_t *pf_Executor, unsigned char f_Mode, RecordReplayCalib_t *pf_Calib, unsigned long f_ImagerAnalogGain, RecordHistory_t *pf_History, PdLibOutputData_t *pf_OutputData, signed long *pf_Result )
+{
+    unsigned long i;
+
+    if ( f_Mode == D_PD_LIB_REPLAY_SINGLE ) {
+        PdLibInputData_t InputData;
+
+        record_set_input_calib ( &((*pf_Calib).CalibData), f_ImagerAnalogGain, &InputData );
+
+        for ( i = 0; i < (*pf_History).WindowNum; i++ ) {
+            InputData.XAddressOfWindowStart = (*pf_History).p_Window[i].XAddressOfWindowStart;
+            InputData.YAddressOfWindowStart = (*pf_History).p_Window[i].YAddressOfWindowStart;
+            InputData.XAddressOfWindowEnd   = (*pf_History).p_Window[i].XAddressOfWindowEnd;
+            InputData.YAddressOfWindowEnd   = (*pf_History).p_Window[i].YAddressOfWindowEnd;
+            InputData.PhaseDifference       = (*pf_History).p_PhaseDiffData[i].PhaseDifference;
+            InputData.ConfidenceLevel       = (*pf_History).p_PhaseDiffData[i].ConfidenceLevel;
+
+            pf_Result[i] = PdLibGetDefocus ( &InputData, &(pf_OutputData[i]) );
+        }
+    } else if ( f_Mode == D_PD_LIB_REPLAY_PARALLEL && (*pf_Calib).p_Context != NULL ) {
+        (void)PdLibGetDefocusBatchParallel ( pf_Executor, (*pf_Calib).p_Context, f_ImagerAnalogGain, (*pf_History).WindowNum,
+                                             (*pf_History).p_Window, (*pf_History).p_PhaseDiffData, pf_OutputData, pf_Result );
+    } else {
+        (void)PdLibGetDefocusBatch ( &((*pf_Calib).CalibData), f_ImagerAnalogGain, (*pf_History).WindowNum,
+                                     (*pf_History).p_Window, (*pf_History).p_PhaseDiffData, pf_OutputData, pf_Result );
+    }
+
+    return ;
+}
+
+/* Function for setting calibration data and analog gain to input data */
+static void record_set_input_calib ( PdLibCalibData_t *pf_CalibData, unsigned long f_ImagerAnalogGain, PdLibInputData_t *pf_InputData )
+{
+    (*pf_InputData).XSizeOfImage              = (*pf_CalibData).XSizeOfImage;
+    (*pf_InputData).YSizeOfImage              = (*pf_CalibData).YSizeOfImage;
+    (*pf_InputData).XKnotNumSlopeOffset       = (*pf_CalibData).XKnotNumSlopeOffset;
+    (*pf_InputData).YKnotNumSlopeOffset       = (*pf_CalibData).YKnotNumSlopeOffset;
+    (*pf_InputData).p_SlopeData               = (*pf_CalibData).p_SlopeData;
+    (*pf_InputData).p_OffsetData              = (*pf_CalibData).p_OffsetData;
+    (*pf_InputData).p_XAddressKnotSlopeOffset = (*pf_CalibData).p_XAddressKnotSlopeOffset;
+    (*pf_InputData).p_YAddressKnotSlopeOffset = (*pf_CalibData).p_YAddressKnotSlopeOffset;
+    (*pf_InputData).AdjCoeffSlope             = (*pf_CalibData).AdjCoeffSlope;
+    (*pf_InputData).ImagerAnalogGain          = f_ImagerAnalogGain;
+    (*pf_InputData).XKnotNumDefocusOKNG       = (*pf_CalibData).XKnotNumDefocusOKNG;
+    (*pf_InputData).YKnotNumDefocusOKNG       = (*pf_CalibData).YKnotNumDefocusOKNG;
+    (*pf_InputData).p_DefocusOKNGThrLine      = (*pf_CalibData).p_DefocusOKNGThrLine;
+    (*pf_InputData).p_XAddressKnotDefocusOKNG = (*pf_CalibData).p_XAddressKnotDefocusOKNG;
+    (*pf_InputData).p_YAddressKnotDefocusOKNG = (*pf_CalibData).p_YAddressKnotDefocusOKNG;
+    (*pf_InputData).DensityOfPhasePix         = (*pf_CalibData).DensityOfPhasePix;
+
+    return ;
+}
+
+/* Function for getting calibration data of input data */
+static void record_get_input_calib ( PdLibInputData_t *pf_InputData, PdLibCalibData_t *pf_CalibData )
+{
+    (*pf_CalibData).XSizeOfImage              = (*pf_InputData).XSizeOfImage;
+    (*pf_CalibData).YSizeOfImage              = (*pf_InputData).YSizeOfImage;
+    (*pf_CalibData).XKnotNumSlopeOffset       = (*pf_InputData).XKnotNumSlopeOffset;
+    (*pf_CalibData).YKnotNumSlopeOffset       = (*pf_InputData).YKnotNumSlopeOffset;
+    (*pf_CalibData).p_SlopeData               = (*pf_InputData).p_SlopeData;
+    (*pf_CalibData).p_OffsetData              = (*pf_InputData).p_OffsetData;
+    (*pf_CalibData).p_XAddressKnotSlopeOffset = (*pf_InputData).p_XAddressKnotSlopeOffset;
+    (*pf_CalibData).p_YAddressKnotSlopeOffset = (*pf_InputData).p_YAddressKnotSlopeOffset;
+    (*pf_CalibData).AdjCoeffSlope             = (*pf_InputData).AdjCoeffSlope;
+    (*pf_CalibData).XKnotNumDefocusOKNG       = (*pf_InputData).XKnotNumDefocusOKNG;
+    (*pf_CalibData).YKnotNumDefocusOKNG       = (*pf_InputData).YKnotNumDefocusOKNG;
+    (*pf_CalibData).p_DefocusOKNGThrLine      = (*pf_InputData).p_DefocusOKNGThrLine;
+    (*pf_CalibData).p_XAddressKnotDefocusOKNG = (*pf_InputData).p_XAddressKnotDefocusOKNG;
+    (*pf_CalibData).p_YAddressKnotDefocusOKNG = (*pf_InputData).p_YAddressKnotDefocusOKNG;
+    (*pf_CalibData).DensityOfPhasePix         = (*pf_InputData).DensityOfPhasePix;
+
+    return ;
+}
+
+/* Function for checking that input data have the same calibration data and analog gain */
+/* Tables are compared by pointers. Contents are compared by record_calib() when their tables are not remembered. */
+static unsigned char record_is_same_calib ( PdLibInputData_t *pf_InputData0, PdLibInputData_t *pf_InputData1 )
+{
+    return ( (*pf_InputData0).XSizeOfImage              == (*pf_InputData1).XSizeOfImage &&
+             (*pf_InputData0).YSizeOfImage              == (*pf_InputData1).YSizeOfImage &&
+             (*pf_InputData0).XKnotNumSlopeOffset       == (*pf_InputData1).XKnotNumSlopeOffset &&
+             (*pf_InputData0).YKnotNumSlopeOffset       == (*pf_InputData1).YKnotNumSlopeOffset &&
+             (*pf_InputData0).p_SlopeData               == (*pf_InputData1).p_SlopeData &&
+             (*pf_InputData0).p_OffsetData              == (*pf_InputData1).p_OffsetData &&
+             (*pf_InputData0).p_XAddressKnotSlopeOffset == (*pf_InputData1).p_XAddressKnotSlopeOffset &&
+             (*pf_InputData0).p_YAddressKnotSlopeOffset == (*pf_InputData1).p_YAddressKnotSlopeOffset &&
+             (*pf_InputData0).AdjCoeffSlope             == (*pf_InputData1).AdjCoeffSlope &&
+             (*pf_InputData0).ImagerAnalogGain          == (*pf_InputData1).ImagerAnalogGain &&
+             (*pf_InputData0).XKnotNumDefocusOKNG       == (*pf_InputData1).XKnotNumDefocusOKNG &&
+             (*pf_InputData0).YKnotNumDefocusOKNG       == (*pf_InputData1).YKnotNumDefocusOKNG &&
+             (*pf_InputData0).p_DefocusOKNGThrLine      == (*pf_InputData1).p_DefocusOKNGThrLine &&
+             (*pf_InputData0).p_XAddressKnotDefocusOKNG == (*pf_InputData1).p_XAddressKnotDefocusOKNG &&
+             (*pf_InputData0).p_YAddressKnotDefocusOKNG == (*pf_InputData1).p_YAddressKnotDefocusOKNG &&
+             (*pf_InputData0).DensityOfPhasePix         == (*pf_InputData1).DensityOfPhasePix ) ? 1 : 0;
+}
+
+/* Function for checking that calibration data have the same values and tables. Tables are compared by pointers. */
+static unsigned char record_is_same_key ( PdLibCalibData_t *pf_CalibData0, PdLibCalibData_t *pf_CalibData1 )
+{
+    return ( (*pf_CalibData0).XSizeOfImage              == (*pf_CalibData1).XSizeOfImage &&
+             (*pf_CalibData0).YSizeOfImage              == (*pf_CalibData1).YSizeOfImage &&
+             (*pf_CalibData0).XKnotNumSlopeOffset       == (*pf_CalibData1).XKnotNumSlopeOffset &&
+             (*pf_CalibData0).YKnotNumSlopeOffset       == (*pf_CalibData1).YKnotNumSlopeOffset &&
+             (*pf_CalibData0).p_SlopeData               == (*pf_CalibData1).p_SlopeData &&
+             (*pf_CalibData0).p_OffsetData              == (*pf_CalibData1).p_OffsetData &&
+             (*pf_CalibData0).p_XAddressKnotSlopeOffset == (*pf_CalibData1).p_XAddressKnotSlopeOffset &&
+             (*pf_CalibData0).p_YAddressKnotSlopeOffset == (*pf_CalibData1).p_YAddressKnotSlopeOffset &&
+             (*pf_CalibData0).AdjCoeffSlope             == (*pf_CalibData1).AdjCoeffSlope &&
+             (*pf_CalibData0).XKnotNumDefocusOKNG       == (*pf_CalibData1).XKnotNumDefocusOKNG &&
+             (*pf_CalibData0).YKnotNumDefocusOKNG       == (*pf_CalibData1).YKnotNumDefocusOKNG &&
+             (*pf_CalibData0).p_DefocusOKNGThrLine      == (*pf_CalibData1).p_DefocusOKNGThrLine &&
+             (*pf_CalibData0).p_XAddressKnotDefocusOKNG == (*pf_CalibData1).p_XAddressKnotDefocusOKNG &&
+             (*pf_CalibData0).p_YAddressKnotDefocusOKNG == (*pf_CalibData1).p_YAddressKnotDefocusOKNG &&
+             (*pf_CalibData0).DensityOfPhasePix         == (*pf_CalibData1).DensityOfPhasePix ) ? 1 : 0;
+}
@@ -0,0 +1,190 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef __PDAF_RECORD_H__
+#define __PDAF_RECORD_H__
+
+#include "PdafLibrary.h"
+
+#define D_RECORD_OK         (0)
+#define D_RECORD_NG         (-1)                    /* Invalid input or stream */
+#define D_RECORD_NG_ALLOC   (-2)                    /* Allocation failed */
+#define D_RECORD_NG_WRITE   (-3)                    /* Write function failed */
+
+/*
+
+    Record stream
+
+    +------------------------------+  0
+    | RecordHeader_t               |
+    +------------------------------+  HeaderSize
+    | Records                      |  Each record starts with 1 byte of type.
+    +------------------------------+
+
+    D_RECORD_TYPE_CALIB    Id, Size, Size bytes of calibration image of 1 sensor mode
+    D_RECORD_TYPE_FRAME    CalibId, ImagerAnalogGain, WindowNum, 1 byte of D_RECORD_FLAG_XXX,
+                           and for each window:
+                             XAddressOfWindowStart, YAddressOfWindowStart,  unless D_RECORD_FLAG_SAME_WINDOW
+                             XAddressOfWindowEnd, YAddressOfWindowEnd       (delta from previous window)
+                             PhaseDifference, ConfidenceLevel               (delta from previous frame)
+                             Result, DefocusConfidence,                     if D_RECORD_FLAG_OUTPUT
+                             Defocus, DefocusConfidenceLevel,               (delta from previous frame)
+                             PhaseDifference                                (delta from previous frame)
+
+    Numbers are LEB128 varints, and signed numbers and deltas are zigzag coded.
+    Ids of calibration start from 1 and increase by 1. A calibration is written
+    before the first frame which refers to it, and again only when the recorder
+    has forgotten it. Delta from previous frame is taken only when the previous
+    frame has the same WindowNum, otherwise from 0. Output data of the previous
+    frame are 0 when it has none. Calibration image and header are in native
+    byte order as described in PdafCalibImage.h.
+
+*/
+
+#define D_RECORD_MAGIC              (0x53524450u)   /* "PDRS" in little endian */
+#define D_RECORD_MAJOR_VERSION      (1)             /* Incompatible change of format */
+#define D_RECORD_MINOR_VERSION      (0)             /* Compatible change of format */
+
+#define D_RECORD_TYPE_CALIB         (1)             /* Calibration image */
+#define D_RECORD_TYPE_FRAME         (2)             /* Windows of a frame */
+
+#define D_RECORD_FLAG_SAME_WINDOW   (0x01)          /* Windows are the same as the previous frame */
+#define D_RECORD_FLAG_OUTPUT        (0x02)          /* Output data and results are recorded */
+
+/* Header of stream. unsigned int is 32 bit and unsigned short is 16 bit. */
+typedef struct
+{
+    unsigned int        Magic;                      /* D_RECORD_MAGIC. Also detects byte order. */
+    unsigned short      MajorVersion;               /* D_RECORD_MAJOR_VERSION. */
+    unsigned short      MinorVersion;               /* D_RECORD_MINOR_VERSION. */
+    unsigned short      LongSize;                   /* sizeof(long) of the writer. */
+    unsigned short      HeaderSize;                 /* sizeof(RecordHeader_t). */
+    unsigned int        Reserved;                   /* 0. */
+} RecordHeader_t;
+
+/* Function for creating recorder and writing header of stream */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern signed char RecordCreate
+#else
+extern signed char RecordCreate
+#endif
+(
+    /* Input */
+    PdLibRecordWrite_t pf_Write,
+    void *pf_User,
+    /* Output */
+    PdLibRecorder_t **ppf_Recorder
+);
+
+/* Function for flushing and destroying recorder */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void RecordDestroy
+#else
+extern void RecordDestroy
+#endif
+(
+    /* Input */
+    PdLibRecorder_t *pf_Recorder
+);
+
+/* Function for writing buffered records by write function */
+/* Failure of write function is kept, and later calls of recorder also fail. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern signed char RecordFlush
+#else
+extern signed char RecordFlush
+#endif
+(
+    /* Input */
+    PdLibRecorder_t *pf_Recorder
+);
+
+/* Function for telling recorder that tables of calibration data may have been changed */
+/* Calibration data given next is serialized and compared with remembered calibrations. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void RecordInvalidateCalib
+#else
+extern void RecordInvalidateCalib
+#endif
+(
+    /* Input */
+    PdLibRecorder_t *pf_Recorder
+);
+
+/* Function for recording a frame of windows sharing calibration data */
+/* pf_OutputData and pf_Result are recorded when both are not NULL. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern signed char RecordBatch
+#else
+extern signed char RecordBatch
+#endif
+(
+    /* Input */
+    PdLibRecorder_t *pf_Recorder,
+    PdLibCalibData_t *pf_CalibData,
+    unsigned long f_ImagerAnalogGain,
+    unsigned long f_WindowNum,
+    PdLibWindow_t *pf_Window,
+    PdLibPhaseDiffData_t *pf_PhaseDiffData,
+    PdLibOutputData_t *pf_OutputData,
+    signed long *pf_Result
+);
+
+/* Function for recording input data. Consecutive input data of the same calibration data */
+/* (same tables and values) and analog gain are recorded as a frame. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern signed char RecordInput
+#else
+extern signed char RecordInput
+#endif
+(
+    /* Input */
+    PdLibRecorder_t *pf_Recorder,
+    unsigned long f_InputNum,
+    PdLibInputData_t *pf_InputData,
+    PdLibOutputData_t *pf_OutputData,
+    signed long *pf_Result
+);
+
+/* Function for replaying stream by PdLibGetDefocus(), PdLibGetDefocusBatch() or */
+/* PdLibGetDefocusBatchParallel(), and comparing output data with recorded ones */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern signed char RecordReplay
+#else
+extern signed char RecordReplay
+#endif
+(
+    /* Input */
+    PdLibExecutor_t *pf_Executor,
+    const void *pf_Stream,
+    unsigned long f_Size,
+    unsigned char f_Mode,
+    /* Output */
+    PdLibReplayStats_t *pf_Stats
+);
+
+#endif
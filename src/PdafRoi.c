@@ -0,0 +1,275 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/****************************************************************/
+/*                          include                             */
+/****************************************************************/
+
+#include <stddef.h>
+#include "PdafRoi.h"
+
+#define D_ROI_WEIGHT_BIT        (20)                        /* Bits of weight, so that sums fit in 64 bits. */
+#define D_ROI_REJECT_SCALE      (3)                         /* Deviation over this times MAD is outlier. */
+
+/****************************************************************/
+/*                 local function declaration                   */
+/****************************************************************/
+
+static void roi_sort ( unsigned long f_Num, signed long *pf_Value, unsigned long *pf_Weight );
+static signed long roi_weighted_median ( unsigned long f_Num, signed long *pf_Value, unsigned long *pf_Weight, unsigned long long f_WeightSum );
+static signed long long roi_round ( signed long long f_x, unsigned long long f_y );
+
+/****************************************************************/
+/*                      external function                       */
+/****************************************************************/
+
+/* Function for checking ROIs of windows of a batch */
+extern signed char RoiCheck
+(
+    /* Input */
+    unsigned long f_WindowNum,
+    unsigned long f_RoiNum,
+    PdLibRoi_t *pf_Roi
+)
+{
+    unsigned long i;
+    unsigned long j;
+
+    if ( f_RoiNum != 0 && pf_Roi == NULL ) {
+        return D_ROI_NG;
+    }
+
+    for ( i = 0; i < f_RoiNum; i++ ) {
+        if ( pf_Roi[i].WindowNum == 0 || D_PD_LIB_ROI_WINDOW_NUM_MAX < pf_Roi[i].WindowNum || pf_Roi[i].p_WindowIndex == NULL ) {
+            return D_ROI_NG;
+        }
+
+        for ( j = 0; j < pf_Roi[i].WindowNum; j++ ) {
+            if ( f_WindowNum <= pf_Roi[i].p_WindowIndex[j] ) {
+                return D_ROI_NG;
+            }
+        }
+    }
+
+    return D_ROI_OK;
+}
+
+/* Function for aggregating output data of windows of a ROI */
+extern void RoiAggregate
+(
+    /* Input */
+    PdLibOutputData_t *pf_OutputData,
+    signed long *pf_Result,
+    PdLibRoi_t *pf_Roi,
+    /* Output */
+    PdLibRoiData_t *pf_RoiData
+)
+{
+    unsigned long i;
+    unsigned long Num;
+    unsigned long Shift;
+    unsigned long WeightMax;
+    unsigned long long WeightSum;
+    unsigned long long InlierWeightSum;
+    unsigned long long LevelSum;
+    signed long long DefocusSum;
+    signed long long DeviationSum;
+    signed long long Threshold;
+    signed long Median;
+    signed long Defocus[D_PD_LIB_ROI_WINDOW_NUM_MAX];
+    unsigned long Level[D_PD_LIB_ROI_WINDOW_NUM_MAX];
+    signed long Value[D_PD_LIB_ROI_WINDOW_NUM_MAX];         /* Sorted defocus or deviation */
+    unsigned long Weight[D_PD_LIB_ROI_WINDOW_NUM_MAX];      /* Weight of Value */
+
+    (*pf_RoiData).Defocus                = 0;
+    (*pf_RoiData).DefocusConfidenceLevel = 0;
+    (*pf_RoiData).Spread                 = 0;
+    (*pf_RoiData).InlierNum              = 0;
+
+    /* Windows which have a vote. Errors and NCW have DefocusConfidenceLevel 0. */
+    Num       = 0;
+    WeightMax = 0;
+
+    for ( i = 0; i < (*pf_Roi).WindowNum; i++ ) {
+        unsigned short Index;
+
+        Index = (*pf_Roi).p_WindowIndex[i];
+
+        if ( ( pf_Result != NULL && pf_Result[Index] != D_PD_LIB_E_OK ) || pf_OutputData[Index].DefocusConfidenceLevel == 0 ) {
+            continue ;
+        }
+
+        Defocus[Num] = pf_OutputData[Index].Defocus;
+        Level[Num]   = pf_OutputData[Index].DefocusConfidenceLevel;
+
+        if ( WeightMax < Level[Num] ) {
+            WeightMax = Level[Num];
+        }
+        Num++;
+    }
+
+    if ( Num == 0 ) {
+        return ;
+    }
+
+    /* Weight is level reduced to D_ROI_WEIGHT_BIT bits. Weight which becomes 0 is raised to 1 to keep its vote. */
+    Shift = 0;
+    while ( ( WeightMax >> Shift ) >= ( 1UL << D_ROI_WEIGHT_BIT ) ) {
+        Shift++;
+    }
+
+    /* Weighted median of defocus */
+    WeightSum = 0;
+    for ( i = 0; i < Num; i++ ) {
+        Value[i]  = Defocus[i];
+        Weight[i] = ( ( Level[i] >> Shift ) != 0 ) ? Level[i] >> Shift : 1;
+        WeightSum += Weight[i];
+    }
+
+    roi_sort ( Num, Value, Weight );
+    Median = roi_weighted_median ( Num, Value, Weight, WeightSum );
+
+    /* Weighted median of absolute deviation (MAD). 1 DN is added not to reject quantization error. */
+    for ( i = 0; i < Num; i++ ) {
+        signed long long Dev;
+
+        Dev = (signed long long)Defocus[i] - Median;
+        Dev = ( Dev < 0 ) ? -Dev : Dev;
+
+        Value[i]  = ( Dev < 0x7FFFFFFF ) ? (signed long)Dev : 0x7FFFFFFF;  /* Limit of signed 32 bit */
+        Weight[i] = ( ( Level[i] >> Shift ) != 0 ) ? Level[i] >> Shift : 1;
+    }
+
+    roi_sort ( Num, Value, Weight );
+    Threshold = (signed long long)D_ROI_REJECT_SCALE * roi_weighted_median ( Num, Value, Weight, WeightSum ) + 1;
+
+    /* Weighted mean of inliers */
+    InlierWeightSum = 0;
+    DefocusSum      = 0;
+    LevelSum        = 0;
+
+    for ( i = 0; i < Num; i++ ) {
+        signed long long Dev;
+
+        Dev = (signed long long)Defocus[i] - Median;
+
+        if ( -Threshold <= Dev && Dev <= Threshold ) {
+            Weight[i] = ( ( Level[i] >> Shift ) != 0 ) ? Level[i] >> Shift : 1;
+
+            InlierWeightSum += Weight[i];
+            DefocusSum      += (signed long long)Weight[i] * Defocus[i];
+            LevelSum        += Level[i];
+        } else {
+            Weight[i] = 0;                                  /* Outlier */
+        }
+    }
+
+    (*pf_RoiData).Defocus = (signed long)roi_round ( DefocusSum, InlierWeightSum );
+
+    /* Spread of inliers around defocus of ROI */
+    DeviationSum = 0;
+
+    for ( i = 0; i < Num; i++ ) {
+        signed long long Dev;
+
+        if ( Weight[i] == 0 ) {
+            continue ;
+        }
+
+        Dev = (signed long long)Defocus[i] - (*pf_RoiData).Defocus;
+
+        DeviationSum += (signed long long)Weight[i] * ( ( Dev < 0 ) ? -Dev : Dev );
+        (*pf_RoiData).InlierNum++;
+    }
+
+    (*pf_RoiData).Spread = (unsigned long)roi_round ( DeviationSum, InlierWeightSum );
+
+    /* Level of ROI is mean of levels of windows, where errors and outliers count as 0 */
+    (*pf_RoiData).DefocusConfidenceLevel = (unsigned long)( LevelSum / (*pf_Roi).WindowNum );
+
+    return ;
+}
+
+/****************************************************************/
+/*                       local function                         */
+/****************************************************************/
+
+/* Function for sorting values in ascending order with their weights */
+/* Insertion sort, because a ROI has a few dozen windows. */
+static void roi_sort ( unsigned long f_Num, signed long *pf_Value, unsigned long *pf_Weight )
+{
+    unsigned long i;
+
+    for ( i = 1; i < f_Num; i++ ) {
+        signed long Value;
+        unsigned long Weight;
+        unsigned long j;
+
+        Value  = pf_Value[i];
+        Weight = pf_Weight[i];
+
+        for ( j = i; j > 0 && Value < pf_Value[j-1]; j-- ) {
+            pf_Value[j]  = pf_Value[j-1];
+            pf_Weight[j] = pf_Weight[j-1];
+        }
+
+        pf_Value[j]  = Value;
+        pf_Weight[j] = Weight;
+    }
+
+    return ;
+}
+
+/* Function for getting weighted median of sorted values */
+/* Lower one is taken when half of weight is just between two values. */
+static signed long roi_weighted_median ( unsigned long f_Num, signed long *pf_Value, unsigned long *pf_Weight, unsigned long long f_WeightSum )
+{
+    unsigned long i;
+    unsigned long long Sum;
+
+    Sum = 0;
+
+    for ( i = 0; i < f_Num - 1; i++ ) {
+        Sum += pf_Weight[i];
+
+        if ( f_WeightSum <= 2 * Sum ) {
+            break ;
+        }
+    }
+
+    return pf_Value[i];
+}
+
+/* Function for rounding f_x / f_y to nearest integer, where f_y is positive */
+static signed long long roi_round ( signed long long f_x, unsigned long long f_y )
+{
+    signed long long y;
+
+    y = (signed long long)f_y;
+
+    return ( f_x < 0 ) ? -( ( -f_x + y / 2 ) / y ) : ( f_x + y / 2 ) / y;
+}
@@ -0,0 +1,66 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef __PDAF_ROI_H__
+#define __PDAF_ROI_H__
+
+#include "PdafLibrary.h"
+
+#define D_ROI_NG    (-1)
+#define D_ROI_OK    (0)
+
+/* Function for checking ROIs of windows of a batch */
+/* Each ROI must have 1 - D_PD_LIB_ROI_WINDOW_NUM_MAX windows, and their indices must be less than f_WindowNum. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern signed char RoiCheck
+#else
+extern signed char RoiCheck
+#endif
+(
+    /* Input */
+    unsigned long f_WindowNum,
+    unsigned long f_RoiNum,
+    PdLibRoi_t *pf_Roi
+);
+
+/* Function for aggregating output data of windows of a ROI */
+/* DefocusConfidence of ROI is not set. ROI must be checked by RoiCheck(). */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void RoiAggregate
+#else
+extern void RoiAggregate
+#endif
+(
+    /* Input */
+    PdLibOutputData_t *pf_OutputData,
+    signed long *pf_Result,
+    PdLibRoi_t *pf_Roi,
+    /* Output */
+    PdLibRoiData_t *pf_RoiData
+);
+
+#endif
@@ -0,0 +1,305 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/****************************************************************/
+/*                          include                             */
+/****************************************************************/
+
+#if !defined _WIN32 && !defined _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L                     /* For clock_gettime() and POSIX threads */
+#endif
+
+#include "PdafStatistics.h"
+
+#if defined __GNUC__ && !defined _WIN32
+#define D_STATISTICS_PTHREAD                        /* Counters of each thread with POSIX threads */
+#include <pthread.h>
+#endif
+
+#if defined _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+/****************************************************************/
+/*                          structure                           */
+/****************************************************************/
+
+/* Counters of a thread */
+typedef struct StatisticsBlock
+{
+    struct StatisticsBlock *p_Next;                 /* Next block of live threads. */
+    unsigned long       Counter[D_STATISTICS_COUNTER_NUM];
+} StatisticsBlock_t;
+
+#if defined D_STATISTICS_PTHREAD
+static pthread_mutex_t      s_Mutex = PTHREAD_MUTEX_INITIALIZER;    /* Protect list of blocks, s_Retired and s_Baseline. */
+static pthread_once_t       s_Once  = PTHREAD_ONCE_INIT;
+static pthread_key_t        s_Key;                  /* Key for merging block when thread exits. */
+static unsigned char        s_KeyValid;             /* 1 : s_Key is created. */
+static __thread StatisticsBlock_t *s_p_Block;       /* Block of calling thread. */
+static StatisticsBlock_t    *s_p_Head;              /* List of blocks of live threads. */
+static unsigned long        s_Retired[D_STATISTICS_COUNTER_NUM];   /* Sum of counters of exited threads. */
+#else
+static StatisticsBlock_t    s_Block;                /* Counters shared by all calls. */
+#endif
+static unsigned long        s_Baseline[D_STATISTICS_COUNTER_NUM];  /* Sum of counters at last reset. */
+
+/****************************************************************/
+/*                 local function declaration                   */
+/****************************************************************/
+
+#if defined D_STATISTICS_PTHREAD
+static void statistics_create_key ( void );
+static void statistics_exit_thread ( void *pf_Block );
+static StatisticsBlock_t *statistics_get_block ( void );
+#endif
+static void statistics_sum ( unsigned long *pf_Counter );
+
+/****************************************************************/
+/*                      external function                       */
+/****************************************************************/
+
+/* Function for adding f_Value to counter f_Index of calling thread */
+extern void StatisticsAdd
+(
+    /* Input */
+    unsigned long f_Index,
+    unsigned long f_Value
+)
+{
+#if defined D_STATISTICS_PTHREAD
+    StatisticsBlock_t *p_Block;
+    unsigned long *p_Counter;
+
+    p_Block = s_p_Block;
+
+    if ( p_Block == NULL ) {
+        p_Block = statistics_get_block ();
+
+        if ( p_Block == NULL ) {                            /* Not counted when allocation failed */
+            return ;
+        }
+    }
+
+    p_Counter = &((*p_Block).Counter[f_Index]);
+
+    /* Only this thread writes the counter. Atomic store keeps concurrent StatisticsMerge() well-defined. */
+    __atomic_store_n ( p_Counter, __atomic_load_n ( p_Counter, __ATOMIC_RELAXED ) + f_Value, __ATOMIC_RELAXED );
+#else
+    s_Block.Counter[f_Index] += f_Value;
+#endif
+
+    return ;
+}
+
+/* Function for allocating counters of calling thread before its first StatisticsAdd() */
+extern void StatisticsPrepare
+(
+    void
+)
+{
+#if defined D_STATISTICS_PTHREAD
+    if ( s_p_Block == NULL ) {
+        (void)statistics_get_block ();                      /* Counted again at first StatisticsAdd() when allocation failed */
+    }
+#endif
+
+    return ;
+}
+
+/* Function for merging counters of all threads since last StatisticsReset() */
+extern void StatisticsMerge
+(
+    /* Output */
+    unsigned long *pf_Counter
+)
+{
+    unsigned long i;
+
+#if defined D_STATISTICS_PTHREAD
+    pthread_mutex_lock ( &s_Mutex );
+#endif
+
+    statistics_sum ( pf_Counter );
+
+    for ( i = 0; i < D_STATISTICS_COUNTER_NUM; i++ ) {
+        pf_Counter[i] -= s_Baseline[i];
+    }
+
+#if defined D_STATISTICS_PTHREAD
+    pthread_mutex_unlock ( &s_Mutex );
+#endif
+
+    return ;
+}
+
+/* Function for resetting counters of all threads */
+extern void StatisticsReset
+(
+    void
+)
+{
+#if defined D_STATISTICS_PTHREAD
+    pthread_mutex_lock ( &s_Mutex );
+#endif
+
+    statistics_sum ( s_Baseline );                          /* Values at reset are subtracted at merge */
+
+#if defined D_STATISTICS_PTHREAD
+    pthread_mutex_unlock ( &s_Mutex );
+#endif
+
+    return ;
+}
+
+/* Function for getting monotonic time in nanoseconds */
+extern unsigned long long StatisticsGetTime
+(
+    void
+)
+{
+#if defined _WIN32
+    LARGE_INTEGER Counter;
+    LARGE_INTEGER Frequency;
+
+    QueryPerformanceCounter ( &Counter );
+    QueryPerformanceFrequency ( &Frequency );
+
+    return (unsigned long long)( (double)Counter.QuadPart * 1.0e9 / (double)Frequency.QuadPart );
+#else
+    struct timespec Time;
+
+    clock_gettime ( CLOCK_MONOTONIC, &Time );
+
+    return (unsigned long long)Time.tv_sec * 1000000000ULL + (unsigned long long)Time.tv_nsec;
+#endif
+}
+
+/****************************************************************/
+/*                       local function                         */
+/****************************************************************/
+
+#if defined D_STATISTICS_PTHREAD
+
+/* Function for creating key of blocks once */
+static void statistics_create_key ( void )
+{
+    if ( pthread_key_create ( &s_Key, statistics_exit_thread ) == 0 ) {
+        s_KeyValid = 1;
+    }
+
+    return ;
+}
+
+/* Function for merging counters of exiting thread to s_Retired and releasing its block */
+static void statistics_exit_thread ( void *pf_Block )
+{
+    StatisticsBlock_t *p_Block;
+    StatisticsBlock_t **pp_Link;
+    unsigned long i;
+
+    p_Block = (StatisticsBlock_t *)pf_Block;
+
+    pthread_mutex_lock ( &s_Mutex );
+
+    for ( i = 0; i < D_STATISTICS_COUNTER_NUM; i++ ) {
+        s_Retired[i] += (*p_Block).Counter[i];
+    }
+
+    for ( pp_Link = &s_p_Head; (*pp_Link) != NULL; pp_Link = &((**pp_Link).p_Next) ) {
+        if ( (*pp_Link) == p_Block ) {
+            (*pp_Link) = (*p_Block).p_Next;                 /* Remove from list of live threads */
+            break ;
+        }
+    }
+
+    pthread_mutex_unlock ( &s_Mutex );
+
+    free ( p_Block );
+
+    return ;
+}
+
+/* Function for allocating block of calling thread and adding it to list */
+static StatisticsBlock_t *statistics_get_block ( void )
+{
+    StatisticsBlock_t *p_Block;
+
+    pthread_once ( &s_Once, statistics_create_key );
+
+    if ( s_KeyValid == 0 ) {
+        return NULL;
+    }
+
+    p_Block = (StatisticsBlock_t *)calloc ( 1, sizeof(StatisticsBlock_t) );
+
+    if ( p_Block == NULL ) {
+        return NULL;
+    }
+
+    if ( pthread_setspecific ( s_Key, p_Block ) != 0 ) {    /* Block is merged when the thread exits */
+        free ( p_Block );
+        return NULL;
+    }
+
+    pthread_mutex_lock ( &s_Mutex );
+    (*p_Block).p_Next = s_p_Head;
+    s_p_Head = p_Block;
+    pthread_mutex_unlock ( &s_Mutex );
+
+    s_p_Block = p_Block;
+
+    return p_Block;
+}
+
+#endif
+
+/* Function for summing counters of all threads. Lock must be held by caller. */
+static void statistics_sum ( unsigned long *pf_Counter )
+{
+#if defined D_STATISTICS_PTHREAD
+    StatisticsBlock_t *p_Block;
+    unsigned long i;
+
+    memcpy ( pf_Counter, s_Retired, sizeof(s_Retired) );
+
+    for ( p_Block = s_p_Head; p_Block != NULL; p_Block = (*p_Block).p_Next ) {
+        for ( i = 0; i < D_STATISTICS_COUNTER_NUM; i++ ) {
+            pf_Counter[i] += __atomic_load_n ( &((*p_Block).Counter[i]), __ATOMIC_RELAXED );
+        }
+    }
+#else
+    memcpy ( pf_Counter, s_Block.Counter, sizeof(s_Block.Counter) );
+#endif
+
+    return ;
+}
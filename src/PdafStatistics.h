@@ -0,0 +1,92 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef __PDAF_STATISTICS_H__
+#define __PDAF_STATISTICS_H__
+
+#define D_STATISTICS_COUNTER_NUM    (192)           /* Number of counters of each thread */
+
+/* Function for adding f_Value to counter f_Index of calling thread */
+/* Counters of each thread are written only by the thread, so no lock or atomic read-modify-write is used. */
+/* With POSIX threads counters of each thread are allocated at first call or by StatisticsPrepare(), and merged */
+/* when the thread exits. */
+/* Otherwise one set of counters is shared, and calls must not be made from several threads at the same time. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void StatisticsAdd
+#else
+extern void StatisticsAdd
+#endif
+(
+    /* Input */
+    unsigned long f_Index,
+    unsigned long f_Value
+);
+
+/* Function for allocating counters of calling thread before its first StatisticsAdd() */
+/* Threads which must not allocate while they count call it in advance. It does nothing without POSIX threads. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void StatisticsPrepare
+#else
+extern void StatisticsPrepare
+#endif
+(
+    void
+);
+
+/* Function for merging counters of all threads since last StatisticsReset() */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void StatisticsMerge
+#else
+extern void StatisticsMerge
+#endif
+(
+    /* Output */
+    unsigned long *pf_Counter
+);
+
+/* Function for resetting counters of all threads */
+/* Counters are not cleared. Their values at reset are kept and subtracted by StatisticsMerge(). */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void StatisticsReset
+#else
+extern void StatisticsReset
+#endif
+(
+    void
+);
+
+/* Function for getting monotonic time in nanoseconds */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern unsigned long long StatisticsGetTime
+#else
+extern unsigned long long StatisticsGetTime
+#endif
+(
+    void
+);
+
+#endif
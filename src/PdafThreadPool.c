@@ -0,0 +1,405 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/****************************************************************/
+/*                          include                             */
+/****************************************************************/
+
+#include "PdafThreadPool.h"
+
+#if ( D_THREAD_POOL_ENABLE != 0 ) && defined __GNUC__ && !defined _WIN32
+#define D_THREAD_POOL_PTHREAD                       /* Worker threads with POSIX threads */
+#if defined __linux__ && !defined _GNU_SOURCE
+#define _GNU_SOURCE                                 /* For sched_setaffinity() */
+#endif
+#include <pthread.h>
+#if defined __linux__
+#include <sched.h>
+#endif
+#endif
+
+#include <stdlib.h>
+
+/****************************************************************/
+/*                          structure                           */
+/****************************************************************/
+
+#if defined D_THREAD_POOL_PTHREAD
+
+/* Range of chunks of each thread. Next is taken by own thread and stolen by other threads. */
+typedef struct
+{
+    unsigned long       Next;                       /* Next chunk to be taken. Updated atomically. */
+    unsigned long       End;                        /* End of chunks of the thread. */
+    unsigned char       Padding[64 - 2 * sizeof(unsigned long)];    /* Keep each range in its own cache line. */
+} ThreadPoolRange_t;
+
+/* Worker thread */
+typedef struct
+{
+    ThreadPool_t        *p_ThreadPool;              /* Thread pool of the worker. */
+    unsigned long       ThreadIndex;                /* Index of the worker. 0 is calling thread. */
+    signed long         CoreAffinity;               /* Core number of the worker. Negative is not bound. */
+    pthread_t           Thread;                     /* Thread of the worker. */
+} ThreadPoolWorker_t;
+
+#endif
+
+/* Thread pool */
+struct ThreadPool
+{
+    unsigned long       ThreadNum;                  /* Number of threads including calling thread. */
+#if defined D_THREAD_POOL_PTHREAD
+    unsigned long       StartedNum;                 /* Number of started worker threads. */
+    ThreadPoolStart_t   Start;                      /* Function called by each worker thread when it starts, or NULL. */
+    ThreadPoolWorker_t  Worker[D_THREAD_POOL_MAX_THREAD_NUM];
+    ThreadPoolRange_t   Range[D_THREAD_POOL_MAX_THREAD_NUM];
+    pthread_mutex_t     RunMutex;                   /* Serialize ThreadPoolRun(). */
+    pthread_mutex_t     Mutex;                      /* Protect members below. */
+    pthread_cond_t      StartCond;                  /* Signaled when task is started or pool is destroyed. */
+    pthread_cond_t      DoneCond;                   /* Signaled when all worker threads end task or are ready. */
+    unsigned long       Generation;                 /* Incremented at each task. */
+    unsigned long       RunningNum;                 /* Number of worker threads running task. */
+    unsigned long       ReadyNum;                   /* Number of worker threads which have returned from Start. */
+    unsigned char       Exit;                       /* 1 : Worker threads exit. */
+    unsigned long       Num;                        /* Number of elements of task. */
+    unsigned long       ChunkSize;                  /* Number of elements of chunk. */
+    ThreadPoolTask_t    Task;                       /* Task. */
+    void                *p_Arg;                     /* Argument of task. */
+#endif
+};
+
+/****************************************************************/
+/*                 local function declaration                   */
+/****************************************************************/
+
+#if defined D_THREAD_POOL_PTHREAD
+static void *worker_main ( void *pf_Worker );
+static void worker_run_task ( ThreadPool_t *pf_ThreadPool, unsigned long f_ThreadIndex );
+static void worker_set_affinity ( signed long f_CoreAffinity );
+#endif
+
+/****************************************************************/
+/*                      external function                       */
+/****************************************************************/
+
+/* Function for creating thread pool */
+extern signed char ThreadPoolCreate
+(
+    /* Input */
+    unsigned long f_ThreadNum,
+    signed long *pf_CoreAffinity,
+    ThreadPoolStart_t pf_Start,
+    /* Output */
+    ThreadPool_t **ppf_ThreadPool
+)
+{
+    ThreadPool_t *p_ThreadPool;
+
+    (*ppf_ThreadPool) = NULL;
+
+    if ( 1 <= f_ThreadNum && f_ThreadNum <= D_THREAD_POOL_MAX_THREAD_NUM ) {
+    } else {
+        return D_THREAD_POOL_NG;
+    }
+
+    p_ThreadPool = (ThreadPool_t *)malloc ( sizeof(ThreadPool_t) );
+
+    if ( p_ThreadPool == NULL ) {
+        return D_THREAD_POOL_NG;
+    }
+
+#if defined D_THREAD_POOL_PTHREAD
+    {
+        unsigned long i;
+
+        (*p_ThreadPool).ThreadNum  = f_ThreadNum;
+        (*p_ThreadPool).StartedNum = 0;
+        (*p_ThreadPool).Start      = pf_Start;
+        (*p_ThreadPool).ReadyNum   = 0;
+        (*p_ThreadPool).Generation = 0;
+        (*p_ThreadPool).RunningNum = 0;
+        (*p_ThreadPool).Exit       = 0;
+
+        pthread_mutex_init ( &((*p_ThreadPool).RunMutex), NULL );
+        pthread_mutex_init ( &((*p_ThreadPool).Mutex), NULL );
+        pthread_cond_init  ( &((*p_ThreadPool).StartCond), NULL );
+        pthread_cond_init  ( &((*p_ThreadPool).DoneCond), NULL );
+
+        for ( i = 1; i < f_ThreadNum; i++ ) {               /* Thread 0 is calling thread */
+            ThreadPoolWorker_t *p_Worker;
+
+            p_Worker = &((*p_ThreadPool).Worker[i]);
+
+            (*p_Worker).p_ThreadPool = p_ThreadPool;
+            (*p_Worker).ThreadIndex  = i;
+            (*p_Worker).CoreAffinity = ( pf_CoreAffinity != NULL ) ? pf_CoreAffinity[i-1] : -1;
+
+            if ( pthread_create ( &((*p_Worker).Thread), NULL, worker_main, p_Worker ) != 0 ) {
+                ThreadPoolDestroy ( p_ThreadPool );         /* Stop threads created before */
+                return D_THREAD_POOL_NG;
+            }
+
+            (*p_ThreadPool).StartedNum = i;
+        }
+
+        pthread_mutex_lock ( &((*p_ThreadPool).Mutex) );
+        while ( (*p_ThreadPool).ReadyNum != f_ThreadNum - 1 ) {  /* Wait for Start of worker threads */
+            pthread_cond_wait ( &((*p_ThreadPool).DoneCond), &((*p_ThreadPool).Mutex) );
+        }
+        pthread_mutex_unlock ( &((*p_ThreadPool).Mutex) );
+    }
+#else
+    (void)pf_CoreAffinity;
+    (void)pf_Start;
+
+    (*p_ThreadPool).ThreadNum = 1;                          /* Calling thread only */
+#endif
+
+    (*ppf_ThreadPool) = p_ThreadPool;
+
+    return D_THREAD_POOL_OK;
+}
+
+/* Function for destroying thread pool */
+extern void ThreadPoolDestroy
+(
+    /* Input */
+    ThreadPool_t *pf_ThreadPool
+)
+{
+    if ( pf_ThreadPool == NULL ) {
+        return ;
+    }
+
+#if defined D_THREAD_POOL_PTHREAD
+    {
+        unsigned long i;
+
+        pthread_mutex_lock ( &((*pf_ThreadPool).Mutex) );
+        (*pf_ThreadPool).Exit = 1;
+        pthread_cond_broadcast ( &((*pf_ThreadPool).StartCond) );
+        pthread_mutex_unlock ( &((*pf_ThreadPool).Mutex) );
+
+        for ( i = 1; i <= (*pf_ThreadPool).StartedNum; i++ ) {
+            pthread_join ( (*pf_ThreadPool).Worker[i].Thread, NULL );
+        }
+
+        pthread_cond_destroy  ( &((*pf_ThreadPool).DoneCond) );
+        pthread_cond_destroy  ( &((*pf_ThreadPool).StartCond) );
+        pthread_mutex_destroy ( &((*pf_ThreadPool).Mutex) );
+        pthread_mutex_destroy ( &((*pf_ThreadPool).RunMutex) );
+    }
+#endif
+
+    free ( pf_ThreadPool );
+
+    return ;
+}
+
+/* Function for running task over f_Num elements and waiting for its end */
+extern void ThreadPoolRun
+(
+    /* Input */
+    ThreadPool_t *pf_ThreadPool,
+    unsigned long f_Num,
+    unsigned long f_ChunkSize,
+    ThreadPoolTask_t f_Task,
+    void *pf_Arg
+)
+{
+#if defined D_THREAD_POOL_PTHREAD
+    unsigned long i;
+    unsigned long ThreadNum;
+    unsigned long ChunkNum;
+
+    if ( f_ChunkSize == 0 ) {
+        f_ChunkSize = 1;
+    }
+
+    ChunkNum = f_Num / f_ChunkSize + ( ( f_Num % f_ChunkSize != 0 ) ? 1 : 0 );
+
+    if ( pf_ThreadPool == NULL || (*pf_ThreadPool).ThreadNum <= 1 || ChunkNum <= 1 ) {
+        if ( f_Num != 0 ) {
+            f_Task ( pf_Arg, 0, f_Num );                    /* Run in calling thread */
+        }
+        return ;
+    }
+
+    pthread_mutex_lock ( &((*pf_ThreadPool).RunMutex) );
+
+    ThreadNum = (*pf_ThreadPool).ThreadNum;
+
+    /* Divide chunks equally into ranges of threads */
+    for ( i = 0; i < ThreadNum; i++ ) {
+        (*pf_ThreadPool).Range[i].Next = ChunkNum * i / ThreadNum;
+        (*pf_ThreadPool).Range[i].End  = ChunkNum * ( i + 1 ) / ThreadNum;
+    }
+
+    pthread_mutex_lock ( &((*pf_ThreadPool).Mutex) );
+    (*pf_ThreadPool).Num        = f_Num;
+    (*pf_ThreadPool).ChunkSize  = f_ChunkSize;
+    (*pf_ThreadPool).Task       = f_Task;
+    (*pf_ThreadPool).p_Arg      = pf_Arg;
+    (*pf_ThreadPool).RunningNum = ThreadNum - 1;
+    (*pf_ThreadPool).Generation++;
+    pthread_cond_broadcast ( &((*pf_ThreadPool).StartCond) );
+    pthread_mutex_unlock ( &((*pf_ThreadPool).Mutex) );
+
+    worker_run_task ( pf_ThreadPool, 0 );                   /* Calling thread is thread 0 */
+
+    pthread_mutex_lock ( &((*pf_ThreadPool).Mutex) );
+    while ( (*pf_ThreadPool).RunningNum != 0 ) {            /* Wait for worker threads */
+        pthread_cond_wait ( &((*pf_ThreadPool).DoneCond), &((*pf_ThreadPool).Mutex) );
+    }
+    pthread_mutex_unlock ( &((*pf_ThreadPool).Mutex) );
+
+    pthread_mutex_unlock ( &((*pf_ThreadPool).RunMutex) );
+#else
+    (void)pf_ThreadPool;
+    (void)f_ChunkSize;
+
+    if ( f_Num != 0 ) {
+        f_Task ( pf_Arg, 0, f_Num );                        /* Run in calling thread */
+    }
+#endif
+
+    return ;
+}
+
+/****************************************************************/
+/*                       local function                         */
+/****************************************************************/
+
+#if defined D_THREAD_POOL_PTHREAD
+
+/* Main function of worker thread */
+static void *worker_main ( void *pf_Worker )
+{
+    ThreadPoolWorker_t *p_Worker;
+    ThreadPool_t *p_ThreadPool;
+    unsigned long Generation;
+
+    p_Worker     = (ThreadPoolWorker_t *)pf_Worker;
+    p_ThreadPool = (*p_Worker).p_ThreadPool;
+
+    worker_set_affinity ( (*p_Worker).CoreAffinity );
+
+    if ( (*p_ThreadPool).Start != NULL ) {
+        (*p_ThreadPool).Start ();
+    }
+
+    Generation = 0;                                         /* Generation at creation */
+
+    pthread_mutex_lock ( &((*p_ThreadPool).Mutex) );
+    (*p_ThreadPool).ReadyNum++;
+    pthread_cond_signal ( &((*p_ThreadPool).DoneCond) );
+
+    for ( ;; ) {
+        while ( (*p_ThreadPool).Generation == Generation && (*p_ThreadPool).Exit == 0 ) {
+            pthread_cond_wait ( &((*p_ThreadPool).StartCond), &((*p_ThreadPool).Mutex) );
+        }
+
+        if ( (*p_ThreadPool).Exit != 0 ) {
+            break ;
+        }
+
+        Generation = (*p_ThreadPool).Generation;
+        pthread_mutex_unlock ( &((*p_ThreadPool).Mutex) );
+
+        worker_run_task ( p_ThreadPool, (*p_Worker).ThreadIndex );
+
+        pthread_mutex_lock ( &((*p_ThreadPool).Mutex) );
+        (*p_ThreadPool).RunningNum--;
+        if ( (*p_ThreadPool).RunningNum == 0 ) {
+            pthread_cond_signal ( &((*p_ThreadPool).DoneCond) );
+        }
+    }
+
+    pthread_mutex_unlock ( &((*p_ThreadPool).Mutex) );
+
+    return NULL;
+}
+
+/* Function for running chunks of own range and then stealing chunks of other threads */
+static void worker_run_task ( ThreadPool_t *pf_ThreadPool, unsigned long f_ThreadIndex )
+{
+    unsigned long i;
+    unsigned long ThreadNum;
+    unsigned long Num;
+    unsigned long ChunkSize;
+
+    ThreadNum = (*pf_ThreadPool).ThreadNum;
+    Num       = (*pf_ThreadPool).Num;
+    ChunkSize = (*pf_ThreadPool).ChunkSize;
+
+    for ( i = 0; i < ThreadNum; i++ ) {
+        ThreadPoolRange_t *p_Range;
+        unsigned long Chunk;
+
+        p_Range = &((*pf_ThreadPool).Range[( f_ThreadIndex + i ) % ThreadNum]);  /* Own range first */
+
+        for ( ;; ) {
+            unsigned long Start;
+            unsigned long End;
+
+            Chunk = __atomic_fetch_add ( &((*p_Range).Next), 1, __ATOMIC_RELAXED );
+
+            if ( (*p_Range).End <= Chunk ) {
+                break ;                                     /* No chunk left in the range */
+            }
+
+            Start = Chunk * ChunkSize;
+            End   = ( Num - Start < ChunkSize ) ? Num : Start + ChunkSize;
+
+            (*pf_ThreadPool).Task ( (*pf_ThreadPool).p_Arg, Start, End );
+        }
+    }
+
+    return ;
+}
+
+/* Function for binding calling thread to a core */
+static void worker_set_affinity ( signed long f_CoreAffinity )
+{
+#if defined __linux__ && defined CPU_SET
+    if ( 0 <= f_CoreAffinity && f_CoreAffinity < CPU_SETSIZE ) {
+        cpu_set_t CpuSet;
+
+        CPU_ZERO ( &CpuSet );
+        CPU_SET ( f_CoreAffinity, &CpuSet );
+
+        (void)sched_setaffinity ( 0, sizeof(CpuSet), &CpuSet );    /* Thread runs anywhere if it fails */
+    }
+#else
+    (void)f_CoreAffinity;
+#endif
+
+    return ;
+}
+
+#endif  /* D_THREAD_POOL_PTHREAD */
@@ -0,0 +1,97 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef __PDAF_THREAD_POOL_H__
+#define __PDAF_THREAD_POOL_H__
+
+#define D_THREAD_POOL_NG    (-1)
+#define D_THREAD_POOL_OK    (0)
+
+/* Worker threads of thread pool */
+/* 0 : disable, 1 : enable (default). Worker threads use POSIX threads and are available */
+/* with GCC or clang except Windows. Otherwise all tasks are run in the calling thread. */
+#ifndef D_THREAD_POOL_ENABLE
+#define D_THREAD_POOL_ENABLE    (1)
+#endif
+
+#define D_THREAD_POOL_MAX_THREAD_NUM    (64)        /* Maximum number of threads including calling thread */
+
+typedef struct ThreadPool ThreadPool_t;
+
+/* Task called for elements from f_Start to f_End-1. Tasks of different ranges must be independent. */
+typedef void (*ThreadPoolTask_t)( void *pf_Arg, unsigned long f_Start, unsigned long f_End );
+
+/* Function called by each worker thread when it starts */
+typedef void (*ThreadPoolStart_t)( void );
+
+/* Function for creating thread pool */
+/* f_ThreadNum is the number of threads including calling thread. pf_CoreAffinity is NULL or */
+/* array of (f_ThreadNum - 1) core numbers of worker threads. Negative number does not bind the thread. */
+/* pf_Start is NULL or called by each worker thread, and all calls have returned when the pool is created. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern signed char ThreadPoolCreate
+#else
+extern signed char ThreadPoolCreate
+#endif
+(
+    /* Input */
+    unsigned long f_ThreadNum,
+    signed long *pf_CoreAffinity,
+    ThreadPoolStart_t pf_Start,
+    /* Output */
+    ThreadPool_t **ppf_ThreadPool
+);
+
+/* Function for destroying thread pool */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void ThreadPoolDestroy
+#else
+extern void ThreadPoolDestroy
+#endif
+(
+    /* Input */
+    ThreadPool_t *pf_ThreadPool
+);
+
+/* Function for running task over f_Num elements and waiting for its end */
+/* Elements are divided into chunks of f_ChunkSize. Each thread takes chunks of its own range in order, */
+/* and then steals chunks left in the ranges of other threads. Calls from several threads are serialized. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void ThreadPoolRun
+#else
+extern void ThreadPoolRun
+#endif
+(
+    /* Input */
+    ThreadPool_t *pf_ThreadPool,
+    unsigned long f_Num,
+    unsigned long f_ChunkSize,
+    ThreadPoolTask_t f_Task,
+    void *pf_Arg
+);
+
+#endif
@@ -0,0 +1,201 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/****************************************************************/
+/*                          include                             */
+/****************************************************************/
+
+#include "PdafTrace.h"
+
+#if D_PD_LIB_TRACE_NUM
+
+#if defined __GNUC__
+#define D_TRACE_ATOMIC                              /* Writers in several threads with atomic operations */
+#endif
+
+#include <string.h>
+
+/****************************************************************/
+/*                 local function declaration                   */
+/****************************************************************/
+
+static signed long trace_signed ( unsigned int f_Value );
+
+/****************************************************************/
+/*                      external function                       */
+/****************************************************************/
+
+/* Function for clearing ring buffer */
+extern void TraceInit
+(
+    /* Output */
+    Trace_t *pf_Trace
+)
+{
+    memset ( pf_Trace, 0, sizeof(Trace_t) );                /* No record */
+
+    return ;
+}
+
+/* Function for reserving f_Num records. Number of the first record is returned. */
+extern unsigned long long TraceReserve
+(
+    /* Input */
+    Trace_t *pf_Trace,
+    unsigned long f_Num
+)
+{
+#if defined D_TRACE_ATOMIC
+    return __atomic_fetch_add ( &((*pf_Trace).RecordNum), (unsigned long long)f_Num, __ATOMIC_RELAXED );
+#else
+    unsigned long long Number;
+
+    Number = (*pf_Trace).RecordNum;
+    (*pf_Trace).RecordNum += f_Num;
+
+    return Number;
+#endif
+}
+
+/* Function for writing record of reserved number */
+extern void TraceWrite
+(
+    /* Input */
+    Trace_t *pf_Trace,
+    unsigned long long f_Number,
+    const TraceRecord_t *pf_Record
+)
+{
+    TraceSlot_t *p_Slot;
+
+    p_Slot = &((*pf_Trace).Slot[f_Number % D_PD_LIB_TRACE_NUM]);
+
+#if defined D_TRACE_ATOMIC
+    /* Odd sequence is visible before the record is changed, and even sequence after it is written */
+    __atomic_store_n ( &((*p_Slot).Sequence), f_Number * 2 + 1, __ATOMIC_RELAXED );
+    __atomic_thread_fence ( __ATOMIC_RELEASE );
+    (*p_Slot).Record = (*pf_Record);
+    __atomic_store_n ( &((*p_Slot).Sequence), f_Number * 2 + 2, __ATOMIC_RELEASE );
+#else
+    (*p_Slot).Record   = (*pf_Record);
+    (*p_Slot).Sequence = f_Number * 2 + 2;
+#endif
+
+    return ;
+}
+
+/* Function for copying the newest f_RecordNum records or less, oldest first */
+extern void TraceDump
+(
+    /* Input */
+    Trace_t *pf_Trace,
+    unsigned long f_RecordNum,
+    /* Output */
+    PdLibTraceRecord_t *pf_Record,
+    unsigned long *pf_DumpNum
+)
+{
+    unsigned long long Number;
+    unsigned long long End;
+    unsigned long DumpNum;
+
+#if defined D_TRACE_ATOMIC
+    End = __atomic_load_n ( &((*pf_Trace).RecordNum), __ATOMIC_ACQUIRE );
+#else
+    End = (*pf_Trace).RecordNum;
+#endif
+
+    /* The newest records in ring buffer and array */
+    Number = ( End < D_PD_LIB_TRACE_NUM ) ? 0 : End - D_PD_LIB_TRACE_NUM;
+
+    if ( Number < End && End - Number > f_RecordNum ) {
+        Number = End - f_RecordNum;
+    }
+
+    DumpNum = 0;
+
+    for ( ; Number < End; Number++ ) {
+        TraceSlot_t *p_Slot;
+        TraceRecord_t Record;
+        unsigned long long Sequence;
+        PdLibTraceRecord_t *p_Out;
+
+        p_Slot = &((*pf_Trace).Slot[Number % D_PD_LIB_TRACE_NUM]);
+
+#if defined D_TRACE_ATOMIC
+        Sequence = __atomic_load_n ( &((*p_Slot).Sequence), __ATOMIC_ACQUIRE );
+        Record   = (*p_Slot).Record;
+        __atomic_thread_fence ( __ATOMIC_ACQUIRE );
+
+        /* Skip record being written, not yet written or overwritten during the copy */
+        if ( Sequence != Number * 2 + 2 || __atomic_load_n ( &((*p_Slot).Sequence), __ATOMIC_RELAXED ) != Sequence ) {
+            continue ;
+        }
+#else
+        Sequence = (*p_Slot).Sequence;
+        Record   = (*p_Slot).Record;
+
+        if ( Sequence != Number * 2 + 2 ) {
+            continue ;
+        }
+#endif
+
+        p_Out = &(pf_Record[DumpNum]);
+
+        (*p_Out).Sequence                     = Number;
+        (*p_Out).Window.XAddressOfWindowStart = Record.XAddressOfWindowStart;
+        (*p_Out).Window.YAddressOfWindowStart = Record.YAddressOfWindowStart;
+        (*p_Out).Window.XAddressOfWindowEnd   = Record.XAddressOfWindowEnd;
+        (*p_Out).Window.YAddressOfWindowEnd   = Record.YAddressOfWindowEnd;
+        (*p_Out).PhaseDifference              = trace_signed ( Record.PhaseDifference );
+        (*p_Out).ConfidenceLevel              = Record.ConfidenceLevel;
+        (*p_Out).ImagerAnalogGain             = Record.ImagerAnalogGain;
+        (*p_Out).AreaIndex                    = Record.AreaIndex;
+        (*p_Out).Defocus                      = trace_signed ( Record.Defocus );
+        (*p_Out).DefocusConfidence            = Record.DefocusConfidence;
+        (*p_Out).DefocusConfidenceLevel       = Record.DefocusConfidenceLevel;
+        (*p_Out).Result                       = Record.Result;
+
+        DumpNum++;
+    }
+
+    (*pf_DumpNum) = DumpNum;
+
+    return ;
+}
+
+/****************************************************************/
+/*                       local function                         */
+/****************************************************************/
+
+/* Function for converting low 32 bits in two's complement to signed value */
+static signed long trace_signed ( unsigned int f_Value )
+{
+    return ( ( f_Value & 0x80000000u ) != 0 ) ? -(signed long)( ~f_Value ) - 1 : (signed long)f_Value;
+}
+
+#endif
@@ -0,0 +1,126 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef __PDAF_TRACE_H__
+#define __PDAF_TRACE_H__
+
+#include "PdafLibrary.h"
+
+typedef struct Trace Trace_t;                       /* Ring buffer of records of a context. */
+
+#if D_PD_LIB_TRACE_NUM
+
+/* Compact record of an evaluated window */
+typedef struct
+{
+    unsigned short      XAddressOfWindowStart;      /* PDAF window. */
+    unsigned short      YAddressOfWindowStart;
+    unsigned short      XAddressOfWindowEnd;
+    unsigned short      YAddressOfWindowEnd;
+    unsigned int        PhaseDifference;            /* Low 32 bits of phase difference. */
+    unsigned int        ConfidenceLevel;            /* Low 32 bits of confidence level. */
+    unsigned int        ImagerAnalogGain;           /* Low 32 bits of analog gain. */
+    unsigned int        Defocus;                    /* Low 32 bits of defocus. */
+    unsigned int        DefocusConfidenceLevel;     /* Defocus confidence level. */
+    signed char         DefocusConfidence;          /* Defocus confidence. */
+    signed char         Result;                     /* Return value of the window. */
+    unsigned char       AreaIndex;                  /* Area of window center, or D_PD_LIB_TRACE_AREA_NONE. */
+    unsigned char       Reserved;
+} TraceRecord_t;
+
+/* Slot of ring buffer */
+/* Sequence is 2 * n + 1 while record n is written, 2 * n + 2 after that, and 0 before the first record. */
+typedef struct
+{
+    unsigned long long  Sequence;                   /* State of record. */
+    TraceRecord_t       Record;                     /* Record. */
+} TraceSlot_t;
+
+/* Ring buffer of records */
+/* Writers reserve numbers of records by atomic addition, and write them to slot (n % D_PD_LIB_TRACE_NUM) */
+/* as a sequence lock. A record can be torn only when writers of n and n + D_PD_LIB_TRACE_NUM overlap, */
+/* which needs the ring to wrap during a write of a record. */
+struct Trace
+{
+    unsigned long long  RecordNum;                  /* Number of records reserved. */
+    TraceSlot_t         Slot[D_PD_LIB_TRACE_NUM];   /* Slots. */
+};
+
+/* Function for clearing ring buffer */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void TraceInit
+#else
+extern void TraceInit
+#endif
+(
+    /* Output */
+    Trace_t *pf_Trace
+);
+
+/* Function for reserving f_Num records. Number of the first record is returned. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern unsigned long long TraceReserve
+#else
+extern unsigned long long TraceReserve
+#endif
+(
+    /* Input */
+    Trace_t *pf_Trace,
+    unsigned long f_Num
+);
+
+/* Function for writing record of reserved number */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void TraceWrite
+#else
+extern void TraceWrite
+#endif
+(
+    /* Input */
+    Trace_t *pf_Trace,
+    unsigned long long f_Number,
+    const TraceRecord_t *pf_Record
+);
+
+/* Function for copying the newest f_RecordNum records or less, oldest first */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void TraceDump
+#else
+extern void TraceDump
+#endif
+(
+    /* Input */
+    Trace_t *pf_Trace,
+    unsigned long f_RecordNum,
+    /* Output */
+    PdLibTraceRecord_t *pf_Record,
+    unsigned long *pf_DumpNum
+);
+
+#endif
+
+#endif
@@ -0,0 +1,270 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/****************************************************************/
+/*                          include                             */
+/****************************************************************/
+
+#include <stddef.h>
+#include <stdlib.h>
+#include "PdafTracker.h"
+
+#define D_TRACKER_FRAC_BIT      (8)                         /* Fraction bits of state. */
+#define D_TRACKER_ALIGN         (64)                        /* Alignment of state of windows (cache line). */
+#define D_TRACKER_DEFOCUS_MAX   (0x7FFFFFFFLL)              /* Limit of signed 32 bit. */
+
+/* State of a window. 32 bytes, so that 2 windows share a cache line. */
+typedef struct
+{
+    signed long long    Defocus;                    /* Defocus in 1/256 DN. */
+    signed long long    Velocity;                   /* Change of defocus per frame in 1/256 DN. */
+    unsigned short      HoldCount;                  /* Frames predicted without confident defocus. */
+    unsigned char       Valid;                      /* 1 : tracked. */
+    unsigned char       Reserved[13];
+} TrackerState_t;
+
+struct PdLibTracker
+{
+    PdLibTrackerParam_t Param;                      /* Parameter of filter. */
+    unsigned long       WindowNum;                  /* Number of windows. */
+    TrackerState_t      *p_State;                   /* Array of state of windows, aligned in the same allocation. */
+};
+
+/****************************************************************/
+/*                 local function declaration                   */
+/****************************************************************/
+
+static signed long long tracker_gain ( signed long long f_x, unsigned long f_Gain );
+static signed long long tracker_limit ( signed long long f_x );
+static signed long tracker_output ( signed long long f_x );
+
+/****************************************************************/
+/*                      external function                       */
+/****************************************************************/
+
+/* Function for creating tracker of f_WindowNum windows which are not tracked */
+extern signed char TrackerCreate
+(
+    /* Input */
+    const PdLibTrackerParam_t *pf_Param,
+    unsigned long f_WindowNum,
+    /* Output */
+    PdLibTracker_t **ppf_Tracker
+)
+{
+    PdLibTracker_t *p_Tracker;
+    size_t Address;
+
+    (*ppf_Tracker) = NULL;
+
+    if ( ( (size_t)-1 - sizeof(PdLibTracker_t) - D_TRACKER_ALIGN ) / sizeof(TrackerState_t) < f_WindowNum ) {
+        return D_TRACKER_NG;
+    }
+
+    p_Tracker = (PdLibTracker_t *)malloc ( sizeof(PdLibTracker_t) + D_TRACKER_ALIGN - 1 + sizeof(TrackerState_t) * f_WindowNum );
+
+    if ( p_Tracker == NULL ) {
+        return D_TRACKER_NG;
+    }
+
+    Address = (size_t)( p_Tracker + 1 );
+    Address = ( Address + D_TRACKER_ALIGN - 1 ) & ~(size_t)( D_TRACKER_ALIGN - 1 );
+
+    (*p_Tracker).Param     = (*pf_Param);
+    (*p_Tracker).WindowNum = f_WindowNum;
+    (*p_Tracker).p_State   = (TrackerState_t *)Address;
+
+    TrackerReset ( p_Tracker );
+
+    (*ppf_Tracker) = p_Tracker;
+
+    return D_TRACKER_OK;
+}
+
+/* Function for destroying tracker */
+extern void TrackerDestroy
+(
+    /* Input */
+    PdLibTracker_t *pf_Tracker
+)
+{
+    free ( pf_Tracker );                                    /* State is allocated with tracker */
+
+    return ;
+}
+
+/* Function for resetting all windows to not tracked */
+extern void TrackerReset
+(
+    /* Input */
+    PdLibTracker_t *pf_Tracker
+)
+{
+    unsigned long i;
+
+    for ( i = 0; i < (*pf_Tracker).WindowNum; i++ ) {
+        (*pf_Tracker).p_State[i].Defocus   = 0;
+        (*pf_Tracker).p_State[i].Velocity  = 0;
+        (*pf_Tracker).p_State[i].HoldCount = 0;
+        (*pf_Tracker).p_State[i].Valid     = 0;
+    }
+
+    return ;
+}
+
+/* Function for updating all windows by output data of a frame */
+extern signed char TrackerUpdate
+(
+    /* Input */
+    PdLibTracker_t *pf_Tracker,
+    signed long f_LensDelta,
+    unsigned long f_WindowNum,
+    PdLibOutputData_t *pf_OutputData,
+    signed long *pf_Result,
+    /* Output */
+    PdLibTrackData_t *pf_TrackData
+)
+{
+    unsigned long i;
+    signed long long LensDelta;
+    signed long long ResetThr;
+    PdLibTrackerParam_t *p_Param;
+
+    if ( f_WindowNum != (*pf_Tracker).WindowNum ) {
+        return D_TRACKER_NG;
+    }
+
+    p_Param   = &((*pf_Tracker).Param);
+    LensDelta = (signed long long)f_LensDelta * ( 1 << D_TRACKER_FRAC_BIT );
+    ResetThr  = (signed long long)(*p_Param).ResetThr * ( 1 << D_TRACKER_FRAC_BIT );
+
+    for ( i = 0; i < f_WindowNum; i++ ) {
+        TrackerState_t *p_State;
+        unsigned long Level;
+
+        p_State = &((*pf_Tracker).p_State[i]);
+
+        /* Level of confident defocus, otherwise 0 */
+        Level = 0;
+        if ( ( pf_Result == NULL || pf_Result[i] == D_PD_LIB_E_OK ) && pf_OutputData[i].DefocusConfidence == D_PD_LIB_E_OK ) {
+            Level = pf_OutputData[i].DefocusConfidenceLevel;
+        }
+
+        if ( (*p_State).Valid != 0 ) {
+            /* Prediction. Lens movement reduces defocus by the same amount. */
+            (*p_State).Defocus = tracker_limit ( (*p_State).Defocus + (*p_State).Velocity - LensDelta );
+
+            if ( Level != 0 ) {
+                signed long long Residual;
+
+                Residual = (signed long long)pf_OutputData[i].Defocus * ( 1 << D_TRACKER_FRAC_BIT ) - (*p_State).Defocus;
+
+                if ( ResetThr != 0 && ( Residual < -ResetThr || ResetThr < Residual ) ) {
+                    (*p_State).Valid = 0;                   /* Restarted below */
+                } else {
+                    unsigned long Gain;
+
+                    /* Gain of D_PD_LIB_TRACKER_GAIN_ONE at ConfidenceLevelFull or higher */
+                    Gain = ( Level < (*p_Param).ConfidenceLevelFull ) ?
+                           (unsigned long)( ( (unsigned long long)D_PD_LIB_TRACKER_GAIN_ONE * Level ) / (*p_Param).ConfidenceLevelFull ) :
+                           D_PD_LIB_TRACKER_GAIN_ONE;
+
+                    (*p_State).Defocus  += tracker_gain ( Residual, ( Gain * (*p_Param).Alpha ) / D_PD_LIB_TRACKER_GAIN_ONE );
+                    (*p_State).Velocity  = tracker_limit ( (*p_State).Velocity + tracker_gain ( Residual, ( Gain * (*p_Param).Beta ) / D_PD_LIB_TRACKER_GAIN_ONE ) );
+                    (*p_State).HoldCount = 0;
+                }
+            } else if ( (*p_State).HoldCount < (*p_Param).HoldNum ) {
+                (*p_State).HoldCount++;                     /* Keep prediction */
+            } else {
+                (*p_State).Valid = 0;                       /* Lost */
+            }
+        }
+
+        if ( (*p_State).Valid == 0 && Level != 0 ) {        /* Start from measured defocus */
+            (*p_State).Defocus   = (signed long long)pf_OutputData[i].Defocus * ( 1 << D_TRACKER_FRAC_BIT );
+            (*p_State).Velocity  = 0;
+            (*p_State).HoldCount = 0;
+            (*p_State).Valid     = 1;
+        }
+
+        if ( (*p_State).Valid != 0 ) {
+            pf_TrackData[i].Defocus          = tracker_output ( (*p_State).Defocus );
+            pf_TrackData[i].PredictedDefocus = tracker_output ( (*p_State).Defocus + (*p_State).Velocity );
+            pf_TrackData[i].Valid            = 1;
+        } else {
+            pf_TrackData[i].Defocus          = 0;
+            pf_TrackData[i].PredictedDefocus = 0;
+            pf_TrackData[i].Valid            = 0;
+        }
+    }
+
+    return D_TRACKER_OK;
+}
+
+/****************************************************************/
+/*                       local function                         */
+/****************************************************************/
+
+/* Function for multiplying f_x by f_Gain / D_PD_LIB_TRACKER_GAIN_ONE with rounding half away from zero */
+static signed long long tracker_gain ( signed long long f_x, unsigned long f_Gain )
+{
+    signed long long x;
+
+    x = ( f_x < 0 ) ? -f_x : f_x;
+    x = ( x * (signed long long)f_Gain + D_PD_LIB_TRACKER_GAIN_ONE / 2 ) / D_PD_LIB_TRACKER_GAIN_ONE;
+
+    return ( f_x < 0 ) ? -x : x;
+}
+
+/* Function for limiting state to signed 32 bit DN, so that it cannot overflow however long it is predicted */
+static signed long long tracker_limit ( signed long long f_x )
+{
+    if ( f_x < -D_TRACKER_DEFOCUS_MAX * ( 1 << D_TRACKER_FRAC_BIT ) ) {
+        return -D_TRACKER_DEFOCUS_MAX * ( 1 << D_TRACKER_FRAC_BIT );
+    } else if ( D_TRACKER_DEFOCUS_MAX * ( 1 << D_TRACKER_FRAC_BIT ) < f_x ) {
+        return D_TRACKER_DEFOCUS_MAX * ( 1 << D_TRACKER_FRAC_BIT );
+    }
+
+    return f_x;
+}
+
+/* Function for rounding state to DN within signed 32 bit */
+static signed long tracker_output ( signed long long f_x )
+{
+    signed long long x;
+
+    x = ( f_x < 0 ) ? -( ( -f_x + ( 1 << ( D_TRACKER_FRAC_BIT - 1 ) ) ) >> D_TRACKER_FRAC_BIT ) :
+                      ( f_x + ( 1 << ( D_TRACKER_FRAC_BIT - 1 ) ) ) >> D_TRACKER_FRAC_BIT;
+
+    if ( x < -D_TRACKER_DEFOCUS_MAX ) {
+        x = -D_TRACKER_DEFOCUS_MAX;
+    } else if ( D_TRACKER_DEFOCUS_MAX < x ) {
+        x = D_TRACKER_DEFOCUS_MAX;
+    }
+
+    return (signed long)x;
+}
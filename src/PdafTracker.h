@@ -0,0 +1,91 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef __PDAF_TRACKER_H__
+#define __PDAF_TRACKER_H__
+
+#include "PdafLibrary.h"
+
+#define D_TRACKER_NG    (-1)
+#define D_TRACKER_OK    (0)
+
+/* Function for creating tracker of f_WindowNum windows which are not tracked */
+/* Parameter must be checked, and it is copied. NG is returned for failure of allocation. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern signed char TrackerCreate
+#else
+extern signed char TrackerCreate
+#endif
+(
+    /* Input */
+    const PdLibTrackerParam_t *pf_Param,
+    unsigned long f_WindowNum,
+    /* Output */
+    PdLibTracker_t **ppf_Tracker
+);
+
+/* Function for destroying tracker */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void TrackerDestroy
+#else
+extern void TrackerDestroy
+#endif
+(
+    /* Input */
+    PdLibTracker_t *pf_Tracker
+);
+
+/* Function for resetting all windows to not tracked */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern void TrackerReset
+#else
+extern void TrackerReset
+#endif
+(
+    /* Input */
+    PdLibTracker_t *pf_Tracker
+);
+
+/* Function for updating all windows by output data of a frame */
+/* NG is returned without update when f_WindowNum differs from that of tracker. */
+#if defined __GNUC__
+__attribute__ ((visibility ("hidden"))) extern signed char TrackerUpdate
+#else
+extern signed char TrackerUpdate
+#endif
+(
+    /* Input */
+    PdLibTracker_t *pf_Tracker,
+    signed long f_LensDelta,
+    unsigned long f_WindowNum,
+    PdLibOutputData_t *pf_OutputData,
+    signed long *pf_Result,
+    /* Output */
+    PdLibTrackData_t *pf_TrackData
+);
+
+#endif
@@ -0,0 +1,367 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/*
+    Comparison of PdLib::FixedGridEvaluator of PdafLibrary.hpp with PdLibGetDefocusBatchWithContext().
+
+    The sources of PDAF Library are built as C, and the test as C++17, for example
+
+        gcc -O2 -c -I../src ../src/PdafLibrary.c ../src/PdafMathFunc.c ../src/PdafThreadPool.c ../src/PdafStatistics.c ../src/PdafCalibImage.c ../src/PdafOtpDecoder.c ../src/PdafHotSwap.c ../src/PdafPhaseDetect.c ../src/PdafRoi.c ../src/PdafTracker.c ../src/PdafRecord.c ../src/PdafTrace.c
+        g++ -std=c++17 -O2 -I../src PdafFixedGridTest.cpp PdafLibrary.o PdafMathFunc.o PdafThreadPool.o PdafStatistics.o PdafCalibImage.o PdafOtpDecoder.o PdafHotSwap.o PdafPhaseDetect.o PdafRoi.o PdafTracker.o PdafRecord.o PdafTrace.o -lpthread -o PdafFixedGridTest
+
+    Usage : PdafFixedGridTest
+
+    For several knot grids, grids of DefocusOKNG (disabled, 1 x 1, the same knots or knots of their
+    own) and sensor modes, random calibration data of irregular knots is given to an evaluator, and
+    windows at random places, at corners and edges of image, with centers on knots and next to
+    them, and out of knots, are evaluated with analog gains at and between points of threshold lines
+    and beyond them, and with phase differences including the error value and the limits. Output
+    data, results of windows and return values must be the same bit for bit as the owned context.
+*/
+
+/****************************************************************/
+/*                          include                             */
+/****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "PdafLibrary.hpp"
+#include "PdafTestCommon.h"
+
+/****************************************************************/
+/*                          define                              */
+/****************************************************************/
+
+#define D_TEST_CALIB_NUM            (8)             /* Number of random calibration data of each grid */
+#define D_TEST_WINDOW_NUM           (256)           /* Number of windows of a batch */
+#define D_TEST_GAIN_NUM             (12)            /* Number of analog gains of each calibration data */
+#define D_TEST_PD_NUM               (6)             /* Number of sets of phase differences */
+#define D_TEST_REPORT_NUM           (10)            /* Number of failures printed */
+
+/****************************************************************/
+/*                        global variable                       */
+/****************************************************************/
+
+/* Sensor profile with several DensityOfPhasePix and AdjCoeffSlope */
+static const PdLibSensorProfile_t s_Profile =
+{
+    D_PD_ERROR_VALUE,
+    { 2304, 1152, 576, 2304, 1152 },
+    { 2304, 1999, 3001, 4608, 577 }
+};
+
+static const TestCalibKind_t s_CalibKind = { 0, 0, D_TEST_MAX_KNOT_NUM, D_TEST_OKNG_SAME, 1, &s_Profile };
+
+static unsigned long s_ReportNum;
+
+/****************************************************************/
+/*                       local function                         */
+/****************************************************************/
+
+/* Function for setting grids of random calibration data. Knots of DefocusOKNG of 2 or more are */
+/* the same as slope and offset when the numbers are the same, otherwise their own. */
+static void test_set_grid ( unsigned short f_XKnotNum, unsigned short f_YKnotNum, unsigned short f_XKnotNumOkNg, unsigned short f_YKnotNumOkNg,
+                            signed long f_AdjCoeffSlope, unsigned long f_DensityOfPhasePix, TestCalib_t *pf_Calib )
+{
+    PdLibCalibData_t *p_CalibData;
+
+    p_CalibData = &((*pf_Calib).CalibData);
+
+    (*p_CalibData).XKnotNumSlopeOffset = f_XKnotNum;
+    (*p_CalibData).YKnotNumSlopeOffset = f_YKnotNum;
+    (*p_CalibData).XKnotNumDefocusOKNG = f_XKnotNumOkNg;
+    (*p_CalibData).YKnotNumDefocusOKNG = f_YKnotNumOkNg;
+    (*p_CalibData).AdjCoeffSlope       = f_AdjCoeffSlope;
+    (*p_CalibData).DensityOfPhasePix   = f_DensityOfPhasePix;
+
+    test_set_knot ( f_XKnotNum, (*p_CalibData).XSizeOfImage, 1, (*pf_Calib).XAddressKnot );
+    test_set_knot ( f_YKnotNum, (*p_CalibData).YSizeOfImage, 1, (*pf_Calib).YAddressKnot );
+
+    if ( f_XKnotNumOkNg == f_XKnotNum && f_YKnotNumOkNg == f_YKnotNum ) {
+        memcpy ( (*pf_Calib).XAddressKnotOkNg, (*pf_Calib).XAddressKnot, sizeof((*pf_Calib).XAddressKnot) );
+        memcpy ( (*pf_Calib).YAddressKnotOkNg, (*pf_Calib).YAddressKnot, sizeof((*pf_Calib).YAddressKnot) );
+    } else if ( 2 <= f_XKnotNumOkNg ) {
+        test_set_knot ( f_XKnotNumOkNg, (*p_CalibData).XSizeOfImage, 1, (*pf_Calib).XAddressKnotOkNg );
+        test_set_knot ( f_YKnotNumOkNg, (*p_CalibData).YSizeOfImage, 1, (*pf_Calib).YAddressKnotOkNg );
+    }
+
+    return ;
+}
+
+/* Function for setting a window of the center and half size limited into image */
+static void test_set_window_at ( const PdLibCalibData_t *pf_CalibData, signed long f_X, signed long f_Y, signed long f_Half, PdLibWindow_t *pf_Window )
+{
+    signed long XStart;
+    signed long YStart;
+    signed long XEnd;
+    signed long YEnd;
+
+    XStart = ( f_X - f_Half < 0 ) ? 0 : f_X - f_Half;
+    YStart = ( f_Y - f_Half < 0 ) ? 0 : f_Y - f_Half;
+    XEnd   = ( (signed long)(*pf_CalibData).XSizeOfImage - 1 < f_X + f_Half ) ? (signed long)(*pf_CalibData).XSizeOfImage - 1 : f_X + f_Half;
+    YEnd   = ( (signed long)(*pf_CalibData).YSizeOfImage - 1 < f_Y + f_Half ) ? (signed long)(*pf_CalibData).YSizeOfImage - 1 : f_Y + f_Half;
+
+    (*pf_Window).XAddressOfWindowStart = (unsigned short)XStart;
+    (*pf_Window).YAddressOfWindowStart = (unsigned short)YStart;
+    (*pf_Window).XAddressOfWindowEnd   = (unsigned short)XEnd;
+    (*pf_Window).YAddressOfWindowEnd   = (unsigned short)YEnd;
+
+    return ;
+}
+
+/* Function for setting windows of random places, corners, edges and knots, and invalid windows */
+static void test_set_windows ( TestCalib_t *pf_Calib, PdLibWindow_t *pf_Window )
+{
+    const PdLibCalibData_t *p_CalibData;
+    const unsigned short *p_XKnot;
+    const unsigned short *p_YKnot;
+    unsigned short XKnotNum;
+    unsigned short YKnotNum;
+    signed long XSize;
+    signed long YSize;
+    unsigned long i;
+
+    p_CalibData = &((*pf_Calib).CalibData);
+    XSize       = (*p_CalibData).XSizeOfImage;
+    YSize       = (*p_CalibData).YSizeOfImage;
+
+    for ( i = 0; i < D_TEST_WINDOW_NUM; i++ ) {
+        /* Knots of slope and offset, or of DefocusOKNG */
+        if ( 2 <= (*p_CalibData).XKnotNumDefocusOKNG && i % 2 == 1 ) {
+            p_XKnot  = (*pf_Calib).XAddressKnotOkNg;
+            p_YKnot  = (*pf_Calib).YAddressKnotOkNg;
+            XKnotNum = (*p_CalibData).XKnotNumDefocusOKNG;
+            YKnotNum = (*p_CalibData).YKnotNumDefocusOKNG;
+        } else {
+            p_XKnot  = (*pf_Calib).XAddressKnot;
+            p_YKnot  = (*pf_Calib).YAddressKnot;
+            XKnotNum = (*p_CalibData).XKnotNumSlopeOffset;
+            YKnotNum = (*p_CalibData).YKnotNumSlopeOffset;
+        }
+
+        switch ( i % 8 ) {
+        case 0 :                                            /* Corners of image */
+            test_set_window_at ( p_CalibData, ( test_rand () % 2 == 0 ) ? 0 : XSize - 1, ( test_rand () % 2 == 0 ) ? 0 : YSize - 1,
+                                 test_rand_range ( 1, 64 ), &(pf_Window[i]) );
+            break ;
+        case 1 :                                            /* Centers on knots, or next to them */
+        case 2 :
+            test_set_window_at ( p_CalibData, p_XKnot[test_rand () % XKnotNum] + test_rand_range ( -1, 1 ),
+                                 p_YKnot[test_rand () % YKnotNum] + test_rand_range ( -1, 1 ), test_rand_range ( 1, 32 ), &(pf_Window[i]) );
+            break ;
+        case 3 :                                            /* Edges of image out of knots */
+            test_set_window_at ( p_CalibData, test_rand_range ( 0, XSize - 1 ), ( test_rand () % 2 == 0 ) ? 0 : YSize - 1,
+                                 test_rand_range ( 1, 16 ), &(pf_Window[i]) );
+            break ;
+        case 4 :                                            /* Whole image */
+            test_set_window_at ( p_CalibData, XSize / 2, YSize / 2, ( XSize < YSize ) ? YSize : XSize, &(pf_Window[i]) );
+            break ;
+        case 5 :                                            /* Invalid windows */
+            test_set_window ( (unsigned short)XSize, (unsigned short)YSize, 256, &(pf_Window[i]) );
+            if ( test_rand () % 2 == 0 ) {
+                pf_Window[i].XAddressOfWindowEnd = pf_Window[i].XAddressOfWindowStart;
+            } else {
+                pf_Window[i].YAddressOfWindowEnd = (unsigned short)YSize;
+            }
+            break ;
+        default :                                           /* Random places */
+            test_set_window ( (unsigned short)XSize, (unsigned short)YSize, 512, &(pf_Window[i]) );
+            break ;
+        }
+    }
+
+    return ;
+}
+
+/* Function for setting phase differences of the set */
+static void test_set_phase_diff ( unsigned long f_Set, PdLibPhaseDiffData_t *pf_PhaseDiffData )
+{
+    unsigned long i;
+
+    for ( i = 0; i < D_TEST_WINDOW_NUM; i++ ) {
+        switch ( f_Set ) {
+        case 0 :
+            pf_PhaseDiffData[i].PhaseDifference = D_PD_ERROR_VALUE * 16;                    /* Error value */
+            break ;
+        case 1 :
+            pf_PhaseDiffData[i].PhaseDifference = ( i % 2 == 0 ) ? 2147483647L : -2147483647L - 1;   /* Limits */
+            break ;
+        case 2 :
+            pf_PhaseDiffData[i].PhaseDifference = (signed long)( i % 3 ) - 1;
+            break ;
+        default :
+            pf_PhaseDiffData[i].PhaseDifference = test_rand_range ( -32768, 32767 );
+            break ;
+        }
+
+        pf_PhaseDiffData[i].ConfidenceLevel = ( test_rand () % 8 == 0 ) ? test_rand () : test_rand () % 8192;
+    }
+
+    return ;
+}
+
+/* Function for setting analog gains at, between and beyond points of threshold lines */
+static void test_set_gains ( TestCalib_t *pf_Calib, unsigned long *pf_Gain )
+{
+    const DefocusOKNGThrLine_t *p_Line;
+    unsigned long Point;
+    unsigned long i;
+
+    p_Line = &((*pf_Calib).ThrLine[test_rand () % ( (unsigned long)D_TEST_MAX_KNOT_NUM * D_TEST_MAX_KNOT_NUM )]);
+
+    for ( i = 0; i < D_TEST_GAIN_NUM; i++ ) {
+        Point = test_rand () % (*p_Line).PointNum;
+
+        switch ( i % 4 ) {
+        case 0 :
+            pf_Gain[i] = (*p_Line).p_AnalogGain[Point];
+            break ;
+        case 1 :
+            pf_Gain[i] = (*p_Line).p_AnalogGain[Point] + 1;
+            break ;
+        case 2 :
+            pf_Gain[i] = (unsigned long)test_rand_range ( 0, (signed long)( (*pf_Calib).MaxAnalogGain + 1 ) );
+            break ;
+        default :
+            pf_Gain[i] = ( i == D_TEST_GAIN_NUM - 1 ) ? 0xFFFFFFFFUL : (*pf_Calib).MaxAnalogGain + test_rand () % 1024;
+            break ;
+        }
+    }
+
+    pf_Gain[1] = pf_Gain[0];                                /* Same analog gain as previous batch */
+
+    return ;
+}
+
+/* Function for comparing an evaluator with its context for random calibration data of its grid */
+template < unsigned short XKnotNum, unsigned short YKnotNum, unsigned short XKnotNumOkNg, unsigned short YKnotNumOkNg,
+           signed long AdjCoeffSlope, unsigned long DensityOfPhasePix >
+static unsigned long test_compare_grid ( void )
+{
+    static TestCalib_t          s_Calib;
+    static PdLibWindow_t        s_Window[D_TEST_WINDOW_NUM];
+    static PdLibPhaseDiffData_t s_PhaseDiffData[D_TEST_WINDOW_NUM];
+    static PdLibOutputData_t    s_Output[D_TEST_WINDOW_NUM];
+    static PdLibOutputData_t    s_Expected[D_TEST_WINDOW_NUM];
+    static signed long          s_Result[D_TEST_WINDOW_NUM];
+    static signed long          s_ResultExpected[D_TEST_WINDOW_NUM];
+    unsigned long Gain[D_TEST_GAIN_NUM];
+    unsigned long FailNum;
+    unsigned long CallNum;
+    unsigned long c;
+    unsigned long g;
+    unsigned long p;
+    unsigned long i;
+
+    FailNum = 0;
+    CallNum = 0;
+
+    for ( c = 0; c < D_TEST_CALIB_NUM; c++ ) {
+        PdLib::FixedGridEvaluator< XKnotNum, YKnotNum, XKnotNumOkNg, YKnotNumOkNg, AdjCoeffSlope, DensityOfPhasePix > Evaluator;
+        signed long ret;
+
+        test_create_calib ( &s_CalibKind, &s_Calib );
+        test_set_grid ( XKnotNum, YKnotNum, XKnotNumOkNg, YKnotNumOkNg, AdjCoeffSlope, DensityOfPhasePix, &s_Calib );
+
+        ret = decltype ( Evaluator )::Create ( &(s_Calib.CalibData), &s_Profile, &Evaluator );
+
+        if ( ret != D_PD_LIB_E_OK ) {
+            printf ( "Grid %u x %u, %u x %u : creation returns %ld\n", XKnotNum, YKnotNum, XKnotNumOkNg, YKnotNumOkNg, ret );
+            FailNum++;
+            continue ;
+        }
+
+        test_set_windows ( &s_Calib, s_Window );
+        test_set_gains ( &s_Calib, Gain );
+
+        for ( g = 0; g < D_TEST_GAIN_NUM; g++ ) {
+            for ( p = 0; p < D_TEST_PD_NUM; p++ ) {
+                signed long RetEvaluator;
+                signed long RetContext;
+
+                test_set_phase_diff ( p, s_PhaseDiffData );
+
+                memset ( s_Output, 0x5A, sizeof(s_Output) );
+                memset ( s_Expected, 0x5A, sizeof(s_Expected) );
+
+                RetEvaluator = Evaluator.GetDefocusBatch ( Gain[g], D_TEST_WINDOW_NUM, s_Window, s_PhaseDiffData, s_Output, s_Result );
+                RetContext   = PdLibGetDefocusBatchWithContext ( Evaluator.GetContext (), Gain[g], D_TEST_WINDOW_NUM, s_Window,
+                                                                 s_PhaseDiffData, s_Expected, s_ResultExpected );
+                CallNum++;
+
+                for ( i = 0; i < D_TEST_WINDOW_NUM; i++ ) {
+                    if ( RetEvaluator != RetContext || s_Result[i] != s_ResultExpected[i] ||
+                         s_Output[i].Defocus                != s_Expected[i].Defocus ||
+                         s_Output[i].DefocusConfidence      != s_Expected[i].DefocusConfidence ||
+                         s_Output[i].DefocusConfidenceLevel != s_Expected[i].DefocusConfidenceLevel ||
+                         s_Output[i].PhaseDifference        != s_Expected[i].PhaseDifference ) {
+                        if ( s_ReportNum < D_TEST_REPORT_NUM ) {
+                            printf ( "Grid %u x %u, %u x %u, calibration %lu, gain %lu, window %lu ( %u, %u, %u, %u ) : "
+                                     "evaluator ( %ld, %ld, %ld, %d, %lu ), context ( %ld, %ld, %ld, %d, %lu )\n",
+                                     XKnotNum, YKnotNum, XKnotNumOkNg, YKnotNumOkNg, c, Gain[g], i,
+                                     s_Window[i].XAddressOfWindowStart, s_Window[i].YAddressOfWindowStart,
+                                     s_Window[i].XAddressOfWindowEnd, s_Window[i].YAddressOfWindowEnd,
+                                     RetEvaluator, s_Result[i], s_Output[i].Defocus, s_Output[i].DefocusConfidence, s_Output[i].DefocusConfidenceLevel,
+                                     RetContext, s_ResultExpected[i], s_Expected[i].Defocus, s_Expected[i].DefocusConfidence, s_Expected[i].DefocusConfidenceLevel );
+                            s_ReportNum++;
+                        }
+                        FailNum++;
+                    }
+                }
+            }
+        }
+    }
+
+    printf ( "Grid %2u x %2u, DefocusOKNG %2u x %2u, AdjCoeffSlope %4ld, DensityOfPhasePix %4lu : %6lu batches, %lu failures\n",
+             XKnotNum, YKnotNum, XKnotNumOkNg, YKnotNumOkNg, AdjCoeffSlope, DensityOfPhasePix, CallNum, FailNum );
+
+    return FailNum;
+}
+
+/****************************************************************/
+/*                           main                               */
+/****************************************************************/
+
+int main ( void )
+{
+    unsigned long FailNum;
+
+    FailNum = 0;
+
+    FailNum += test_compare_grid<  8,  6,  8,  6, 2304, 2304 > ();
+    FailNum += test_compare_grid<  8,  6,  3,  3, 2304, 2304 > ();
+    FailNum += test_compare_grid<  2,  2,  1,  1, 1999, 1152 > ();
+    FailNum += test_compare_grid< 16, 12,  0,  0, 3001,  576 > ();
+    FailNum += test_compare_grid<  5,  9,  4,  2,  577, 1152 > ();
+    FailNum += test_compare_grid<  3, 16,  2,  7, 4608, 2304 > ();
+
+    printf ( "%s\n", ( FailNum == 0 ) ? "PASS" : "FAIL" );
+
+    return ( FailNum == 0 ) ? 0 : 1;
+}
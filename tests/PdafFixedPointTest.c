@@ -0,0 +1,450 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/*
+    Comparison of double and fixed-point engines of PDAF Library.
+
+    Both engines are built as shared libraries from the same sources, and loaded side by side,
+    for example
+
+        gcc -O2 -shared -fPIC -I../src ../src/PdafLibrary.c ../src/PdafMathFunc.c ../src/PdafThreadPool.c ../src/PdafStatistics.c ../src/PdafCalibImage.c ../src/PdafOtpDecoder.c ../src/PdafHotSwap.c ../src/PdafPhaseDetect.c ../src/PdafRoi.c ../src/PdafTracker.c ../src/PdafRecord.c ../src/PdafTrace.c -lpthread -o libPdafDouble.so
+        gcc -O2 -shared -fPIC -DD_MATH_FUNC_FIXED_POINT=1 -I../src ../src/PdafLibrary.c ../src/PdafMathFunc.c ../src/PdafThreadPool.c ../src/PdafStatistics.c ../src/PdafCalibImage.c ../src/PdafOtpDecoder.c ../src/PdafHotSwap.c ../src/PdafPhaseDetect.c ../src/PdafRoi.c ../src/PdafTracker.c ../src/PdafRecord.c ../src/PdafTrace.c -lpthread -o libPdafFixed.so
+        gcc -O2 -I../src PdafFixedPointTest.c -ldl -o PdafFixedPointTest
+
+    Usage : PdafFixedPointTest [DoubleLibrary FixedLibrary]
+
+    For random calibration data, PhaseDifference is swept from -32768 to 32767, which contains
+    the error value -64 << 4 of the sensor profile, with random ConfidenceLevel and analog gain
+    interpolated on threshold lines whose spans are up to 2^31. PdLibGetDefocus(),
+    PdLibGetDefocusRegisteredWindows() and PdLibGetDefocusMap() of both engines are compared,
+    and the test fails when Defocus or DefocusConfidenceLevel deviates by more than 1 DN,
+    which is the bound of D_MATH_FUNC_FIXED_POINT documented in PdafMathFunc.h.
+    Other output data and return values must be the same.
+*/
+
+/****************************************************************/
+/*                          include                             */
+/****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <dlfcn.h>
+
+#include "PdafLibrary.h"
+#include "PdafTestCommon.h"
+
+/****************************************************************/
+/*                          define                              */
+/****************************************************************/
+
+#define D_TEST_CALIB_NUM            (32)            /* Number of random calibration data */
+#define D_TEST_WINDOW_NUM           (16)            /* Number of registered windows */
+#define D_TEST_X_CELL_NUM           (16)            /* Number of cells of defocus map */
+#define D_TEST_Y_CELL_NUM           (12)
+#define D_TEST_X_SAMPLE_NUM         (8)             /* Number of samples of phase difference of defocus map */
+#define D_TEST_Y_SAMPLE_NUM         (6)
+#define D_TEST_PD_MIN               (-32768)        /* Range of PhaseDifference */
+#define D_TEST_PD_MAX               (32767)
+#define D_TEST_DEVIATION_MAX        (1)             /* Maximum deviation of fixed-point from double */
+#define D_TEST_REPORT_NUM           (10)            /* Number of failures printed */
+
+/* API compared */
+#define D_TEST_API_GET_DEFOCUS      (0)
+#define D_TEST_API_REG_WINDOWS      (1)
+#define D_TEST_API_MAP              (2)
+#define D_TEST_API_NUM              (3)
+
+/****************************************************************/
+/*                          structure                           */
+/****************************************************************/
+
+/* APIs of an engine loaded from shared library */
+typedef struct
+{
+    void            *p_Handle;
+    signed long     (*p_SetSensorProfile) ( const PdLibSensorProfile_t * );
+    signed long     (*p_GetDefocus) ( PdLibInputData_t *, PdLibOutputData_t * );
+    signed long     (*p_CreateContext) ( PdLibCalibData_t *, PdLibContext_t ** );
+    signed long     (*p_ValidateContext) ( PdLibContext_t * );
+    void            (*p_DestroyContext) ( PdLibContext_t * );
+    signed long     (*p_RegisterWindows) ( PdLibContext_t *, unsigned long, PdLibWindow_t * );
+    signed long     (*p_GetDefocusRegisteredWindows) ( PdLibContext_t *, unsigned long, PdLibPhaseDiffData_t *, PdLibOutputData_t *, signed long * );
+    signed long     (*p_RegisterDefocusMap) ( PdLibContext_t *, unsigned long, unsigned long, unsigned long, unsigned long );
+    signed long     (*p_GetDefocusMap) ( PdLibExecutor_t *, PdLibContext_t *, unsigned long, PdLibPhaseDiffData_t *, signed long *, unsigned long * );
+} TestEngine_t;
+
+/* Result of comparison of an API */
+typedef struct
+{
+    unsigned long           CallNum;                /* Number of compared output data */
+    unsigned long           FailNum;                /* Number of failures */
+    signed long             MaxDefocusDeviation;    /* Maximum deviation of Defocus */
+    signed long             MaxLevelDeviation;      /* Maximum deviation of DefocusConfidenceLevel */
+} TestResult_t;
+
+/****************************************************************/
+/*                 local function declaration                   */
+/****************************************************************/
+
+static signed char test_load_engine ( const char *pf_Path, TestEngine_t *pf_Engine );
+static unsigned long test_rand_confidence_level ( void );
+static unsigned long test_rand_analog_gain ( TestCalib_t *pf_Calib );
+static void test_compare_calib ( TestEngine_t *pf_Double, TestEngine_t *pf_Fixed, TestCalib_t *pf_Calib, unsigned long f_CalibIndex, TestResult_t *pf_Result );
+static void test_check_output ( TestResult_t *pf_Result, const char *pf_Api, unsigned long f_CalibIndex, signed long f_PhaseDifference, signed long f_RetDouble, signed long f_RetFixed, PdLibOutputData_t *pf_Double, PdLibOutputData_t *pf_Fixed );
+static void test_check_map ( TestResult_t *pf_Result, unsigned long f_CalibIndex, signed long f_PhaseDifference, signed long f_DefocusDouble, signed long f_DefocusFixed, unsigned long f_LevelDouble, unsigned long f_LevelFixed );
+static signed long test_deviation ( signed long f_Double, signed long f_Fixed );
+
+/****************************************************************/
+/*                        global variable                       */
+/****************************************************************/
+
+/* Sensor profile with several AdjCoeffSlope and DensityOfPhasePix */
+static const PdLibSensorProfile_t s_Profile =
+{
+    D_PD_ERROR_VALUE,
+    { 2304, 1152, 576, 2304, 1152 },
+    { 2304, 1999, 3001, 4608, 577 }
+};
+
+/* Random size and knots. Knots of DefocusOKNG are disabled, 1 x 1 or of their own. Slope and offset of */
+/* some knots, and spans of some threshold lines, are up to the limit of signed 32 bit. */
+static const TestCalibKind_t s_CalibKind = { 0, 0, 0, D_TEST_OKNG_OWN_OR_NONE, 1, &s_Profile };
+
+static const char *s_ApiName[D_TEST_API_NUM] = { "PdLibGetDefocus", "PdLibGetDefocusRegisteredWindows", "PdLibGetDefocusMap" };
+
+/****************************************************************/
+/*                           main                               */
+/****************************************************************/
+
+int main ( int argc, char *argv[] )
+{
+    const char      *p_DoublePath;
+    const char      *p_FixedPath;
+    TestEngine_t    Double;
+    TestEngine_t    Fixed;
+    TestResult_t    Result[D_TEST_API_NUM];
+    unsigned long   FailNum;
+    unsigned long   c;
+    unsigned long   a;
+
+    p_DoublePath = "./libPdafDouble.so";
+    p_FixedPath  = "./libPdafFixed.so";
+
+    if ( argc == 3 ) {
+        p_DoublePath = argv[1];
+        p_FixedPath  = argv[2];
+    } else if ( argc != 1 ) {
+        fprintf ( stderr, "Usage : %s [DoubleLibrary FixedLibrary]\n", argv[0] );
+        return 1;
+    }
+
+    if ( test_load_engine ( p_DoublePath, &Double ) != 0 || test_load_engine ( p_FixedPath, &Fixed ) != 0 ) {
+        return 1;
+    }
+
+    if ( (*Double.p_SetSensorProfile) ( &s_Profile ) != D_PD_LIB_E_OK || (*Fixed.p_SetSensorProfile) ( &s_Profile ) != D_PD_LIB_E_OK ) {
+        fprintf ( stderr, "Cannot set sensor profile\n" );
+        return 1;
+    }
+
+    memset ( Result, 0, sizeof(Result) );
+
+    for ( c = 0; c < D_TEST_CALIB_NUM; c++ ) {
+        TestCalib_t Calib;
+
+        test_create_calib ( &s_CalibKind, &Calib );
+        test_compare_calib ( &Double, &Fixed, &Calib, c, Result );
+    }
+
+    FailNum = 0;
+
+    for ( a = 0; a < D_TEST_API_NUM; a++ ) {
+        printf ( "%-34s %10lu outputs, max deviation Defocus %ld DN, DefocusConfidenceLevel %ld DN, %lu failures\n",
+                 s_ApiName[a], Result[a].CallNum, Result[a].MaxDefocusDeviation, Result[a].MaxLevelDeviation, Result[a].FailNum );
+        FailNum += Result[a].FailNum;
+    }
+
+    printf ( "%s\n", ( FailNum == 0 ) ? "PASS" : "FAIL" );
+
+    dlclose ( Double.p_Handle );
+    dlclose ( Fixed.p_Handle );
+
+    return ( FailNum == 0 ) ? 0 : 1;
+}
+
+/****************************************************************/
+/*                       local function                         */
+/****************************************************************/
+
+/* Function for loading an engine. Symbols are resolved locally, so that engines do not interpose each other. */
+static signed char test_load_engine ( const char *pf_Path, TestEngine_t *pf_Engine )
+{
+    memset ( pf_Engine, 0, sizeof(TestEngine_t) );
+
+    (*pf_Engine).p_Handle = dlopen ( pf_Path, RTLD_NOW | RTLD_LOCAL );
+
+    if ( (*pf_Engine).p_Handle == NULL ) {
+        fprintf ( stderr, "Cannot load %s : %s\n", pf_Path, dlerror () );
+        return -1;
+    }
+
+    *(void **)(&(*pf_Engine).p_SetSensorProfile)            = dlsym ( (*pf_Engine).p_Handle, "PdLibSetSensorProfile" );
+    *(void **)(&(*pf_Engine).p_GetDefocus)                  = dlsym ( (*pf_Engine).p_Handle, "PdLibGetDefocus" );
+    *(void **)(&(*pf_Engine).p_CreateContext)               = dlsym ( (*pf_Engine).p_Handle, "PdLibCreateContext" );
+    *(void **)(&(*pf_Engine).p_ValidateContext)             = dlsym ( (*pf_Engine).p_Handle, "PdLibValidateContext" );
+    *(void **)(&(*pf_Engine).p_DestroyContext)              = dlsym ( (*pf_Engine).p_Handle, "PdLibDestroyContext" );
+    *(void **)(&(*pf_Engine).p_RegisterWindows)             = dlsym ( (*pf_Engine).p_Handle, "PdLibRegisterWindows" );
+    *(void **)(&(*pf_Engine).p_GetDefocusRegisteredWindows) = dlsym ( (*pf_Engine).p_Handle, "PdLibGetDefocusRegisteredWindows" );
+    *(void **)(&(*pf_Engine).p_RegisterDefocusMap)          = dlsym ( (*pf_Engine).p_Handle, "PdLibRegisterDefocusMap" );
+    *(void **)(&(*pf_Engine).p_GetDefocusMap)               = dlsym ( (*pf_Engine).p_Handle, "PdLibGetDefocusMap" );
+
+    if ( (*pf_Engine).p_SetSensorProfile == NULL || (*pf_Engine).p_GetDefocus == NULL ||
+         (*pf_Engine).p_CreateContext == NULL || (*pf_Engine).p_ValidateContext == NULL || (*pf_Engine).p_DestroyContext == NULL ||
+         (*pf_Engine).p_RegisterWindows == NULL || (*pf_Engine).p_GetDefocusRegisteredWindows == NULL ||
+         (*pf_Engine).p_RegisterDefocusMap == NULL || (*pf_Engine).p_GetDefocusMap == NULL ) {
+        fprintf ( stderr, "Cannot find APIs in %s\n", pf_Path );
+        dlclose ( (*pf_Engine).p_Handle );
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Function for generating ConfidenceLevel, which is sometimes up to the limit of signed 32 bit */
+static unsigned long test_rand_confidence_level ( void )
+{
+    if ( test_rand () % 16 == 0 ) {
+        return test_rand ();
+    }
+
+    return test_rand () % 8192;
+}
+
+/* Function for generating analog gain on and around threshold lines */
+static unsigned long test_rand_analog_gain ( TestCalib_t *pf_Calib )
+{
+    unsigned long Max;
+
+    Max = (*pf_Calib).MaxAnalogGain;
+    Max = ( Max < 0x7FFFFFFFUL - Max / 8 ) ? Max + Max / 8 : 0x7FFFFFFFUL;
+
+    return test_rand () % ( Max + 1 );
+}
+
+/* Function for comparing APIs of both engines with a calibration data */
+static void test_compare_calib ( TestEngine_t *pf_Double, TestEngine_t *pf_Fixed, TestCalib_t *pf_Calib, unsigned long f_CalibIndex, TestResult_t *pf_Result )
+{
+    PdLibContext_t          *p_DoubleContext;
+    PdLibContext_t          *p_FixedContext;
+    PdLibWindow_t           Window[D_TEST_WINDOW_NUM];
+    PdLibPhaseDiffData_t    PhaseDiffData[D_TEST_WINDOW_NUM];
+    PdLibOutputData_t       DoubleOutput[D_TEST_WINDOW_NUM];
+    PdLibOutputData_t       FixedOutput[D_TEST_WINDOW_NUM];
+    signed long             DoubleResult[D_TEST_WINDOW_NUM];
+    signed long             FixedResult[D_TEST_WINDOW_NUM];
+    PdLibPhaseDiffData_t    Sample[D_TEST_X_SAMPLE_NUM * D_TEST_Y_SAMPLE_NUM];
+    signed long             DoubleDefocusMap[D_TEST_X_CELL_NUM * D_TEST_Y_CELL_NUM];
+    signed long             FixedDefocusMap[D_TEST_X_CELL_NUM * D_TEST_Y_CELL_NUM];
+    unsigned long           DoubleLevelMap[D_TEST_X_CELL_NUM * D_TEST_Y_CELL_NUM];
+    unsigned long           FixedLevelMap[D_TEST_X_CELL_NUM * D_TEST_Y_CELL_NUM];
+    signed long             RetDouble;
+    signed long             RetFixed;
+    signed long             PhaseDifference;
+    unsigned long           i;
+
+    for ( i = 0; i < D_TEST_WINDOW_NUM; i++ ) {
+        test_set_window ( (*pf_Calib).CalibData.XSizeOfImage, (*pf_Calib).CalibData.YSizeOfImage, 256, &(Window[i]) );
+    }
+
+    p_DoubleContext = NULL;
+    p_FixedContext  = NULL;
+
+    RetDouble = (*(*pf_Double).p_CreateContext) ( &((*pf_Calib).CalibData), &p_DoubleContext );
+    RetFixed  = (*(*pf_Fixed).p_CreateContext) ( &((*pf_Calib).CalibData), &p_FixedContext );
+
+    if ( RetDouble == D_PD_LIB_E_OK && RetFixed == D_PD_LIB_E_OK ) {
+        RetDouble = (*(*pf_Double).p_ValidateContext) ( p_DoubleContext );
+        RetFixed  = (*(*pf_Fixed).p_ValidateContext) ( p_FixedContext );
+    }
+    if ( RetDouble == D_PD_LIB_E_OK && RetFixed == D_PD_LIB_E_OK ) {
+        RetDouble = (*(*pf_Double).p_RegisterWindows) ( p_DoubleContext, D_TEST_WINDOW_NUM, Window );
+        RetFixed  = (*(*pf_Fixed).p_RegisterWindows) ( p_FixedContext, D_TEST_WINDOW_NUM, Window );
+    }
+    if ( RetDouble == D_PD_LIB_E_OK && RetFixed == D_PD_LIB_E_OK ) {
+        RetDouble = (*(*pf_Double).p_RegisterDefocusMap) ( p_DoubleContext, D_TEST_X_CELL_NUM, D_TEST_Y_CELL_NUM, D_TEST_X_SAMPLE_NUM, D_TEST_Y_SAMPLE_NUM );
+        RetFixed  = (*(*pf_Fixed).p_RegisterDefocusMap) ( p_FixedContext, D_TEST_X_CELL_NUM, D_TEST_Y_CELL_NUM, D_TEST_X_SAMPLE_NUM, D_TEST_Y_SAMPLE_NUM );
+    }
+
+    if ( RetDouble != D_PD_LIB_E_OK || RetFixed != D_PD_LIB_E_OK ) {
+        printf ( "Calibration %lu : context is not ready, double %ld, fixed-point %ld\n", f_CalibIndex, RetDouble, RetFixed );
+        (*pf_Result).FailNum++;
+    } else {
+        for ( PhaseDifference = D_TEST_PD_MIN; PhaseDifference <= D_TEST_PD_MAX; PhaseDifference++ ) {
+            PdLibInputData_t InputData;
+            unsigned long AnalogGain;
+
+            /* Each PhaseDifference is evaluated for a window in turn */
+            test_set_input ( pf_Calib, &(Window[(unsigned long)( PhaseDifference - D_TEST_PD_MIN ) % D_TEST_WINDOW_NUM]), PhaseDifference,
+                             test_rand_confidence_level (), test_rand_analog_gain ( pf_Calib ), &InputData );
+
+            RetDouble = (*(*pf_Double).p_GetDefocus) ( &InputData, &(DoubleOutput[0]) );
+            RetFixed  = (*(*pf_Fixed).p_GetDefocus) ( &InputData, &(FixedOutput[0]) );
+
+            test_check_output ( &(pf_Result[D_TEST_API_GET_DEFOCUS]), s_ApiName[D_TEST_API_GET_DEFOCUS], f_CalibIndex, PhaseDifference,
+                                RetDouble, RetFixed, &(DoubleOutput[0]), &(FixedOutput[0]) );
+
+            /* Each PhaseDifference is evaluated for all registered windows */
+            for ( i = 0; i < D_TEST_WINDOW_NUM; i++ ) {
+                PhaseDiffData[i].PhaseDifference = PhaseDifference;
+                PhaseDiffData[i].ConfidenceLevel = test_rand_confidence_level ();
+            }
+
+            AnalogGain = test_rand_analog_gain ( pf_Calib );
+
+            RetDouble = (*(*pf_Double).p_GetDefocusRegisteredWindows) ( p_DoubleContext, AnalogGain, PhaseDiffData, DoubleOutput, DoubleResult );
+            RetFixed  = (*(*pf_Fixed).p_GetDefocusRegisteredWindows) ( p_FixedContext, AnalogGain, PhaseDiffData, FixedOutput, FixedResult );
+
+            if ( RetDouble != RetFixed ) {
+                printf ( "Calibration %lu : %s returns double %ld, fixed-point %ld\n", f_CalibIndex, s_ApiName[D_TEST_API_REG_WINDOWS], RetDouble, RetFixed );
+                pf_Result[D_TEST_API_REG_WINDOWS].FailNum++;
+            }
+
+            for ( i = 0; i < D_TEST_WINDOW_NUM; i++ ) {
+                test_check_output ( &(pf_Result[D_TEST_API_REG_WINDOWS]), s_ApiName[D_TEST_API_REG_WINDOWS], f_CalibIndex, PhaseDifference,
+                                    DoubleResult[i], FixedResult[i], &(DoubleOutput[i]), &(FixedOutput[i]) );
+            }
+
+            /* Samples of defocus map take the next values of PhaseDifference in turn */
+            if ( ( PhaseDifference - D_TEST_PD_MIN ) % ( D_TEST_X_SAMPLE_NUM * D_TEST_Y_SAMPLE_NUM ) == 0 ) {
+                for ( i = 0; i < D_TEST_X_SAMPLE_NUM * D_TEST_Y_SAMPLE_NUM; i++ ) {
+                    Sample[i].PhaseDifference = ( PhaseDifference + (signed long)i <= D_TEST_PD_MAX ) ? PhaseDifference + (signed long)i : PhaseDifference;
+                    Sample[i].ConfidenceLevel = test_rand_confidence_level ();
+                }
+
+                AnalogGain = test_rand_analog_gain ( pf_Calib );
+
+                RetDouble = (*(*pf_Double).p_GetDefocusMap) ( NULL, p_DoubleContext, AnalogGain, Sample, DoubleDefocusMap, DoubleLevelMap );
+                RetFixed  = (*(*pf_Fixed).p_GetDefocusMap) ( NULL, p_FixedContext, AnalogGain, Sample, FixedDefocusMap, FixedLevelMap );
+
+                if ( RetDouble != D_PD_LIB_E_OK || RetFixed != D_PD_LIB_E_OK ) {
+                    printf ( "Calibration %lu : %s returns double %ld, fixed-point %ld\n", f_CalibIndex, s_ApiName[D_TEST_API_MAP], RetDouble, RetFixed );
+                    pf_Result[D_TEST_API_MAP].FailNum++;
+                } else {
+                    for ( i = 0; i < D_TEST_X_CELL_NUM * D_TEST_Y_CELL_NUM; i++ ) {
+                        test_check_map ( &(pf_Result[D_TEST_API_MAP]), f_CalibIndex, PhaseDifference,
+                                         DoubleDefocusMap[i], FixedDefocusMap[i], DoubleLevelMap[i], FixedLevelMap[i] );
+                    }
+                }
+            }
+        }
+    }
+
+    if ( p_DoubleContext != NULL ) {
+        (*(*pf_Double).p_DestroyContext) ( p_DoubleContext );
+    }
+    if ( p_FixedContext != NULL ) {
+        (*(*pf_Fixed).p_DestroyContext) ( p_FixedContext );
+    }
+
+    return ;
+}
+
+/* Function for checking output data of both engines */
+/* DefocusConfidence may differ only when DefocusConfidenceLevel differs. */
+static void test_check_output ( TestResult_t *pf_Result, const char *pf_Api, unsigned long f_CalibIndex, signed long f_PhaseDifference, signed long f_RetDouble, signed long f_RetFixed, PdLibOutputData_t *pf_Double, PdLibOutputData_t *pf_Fixed )
+{
+    signed long DefocusDeviation;
+    signed long LevelDeviation;
+
+    DefocusDeviation = test_deviation ( (*pf_Double).Defocus, (*pf_Fixed).Defocus );
+    LevelDeviation   = test_deviation ( (signed long)(*pf_Double).DefocusConfidenceLevel, (signed long)(*pf_Fixed).DefocusConfidenceLevel );
+
+    (*pf_Result).CallNum++;
+
+    if ( (*pf_Result).MaxDefocusDeviation < DefocusDeviation ) {
+        (*pf_Result).MaxDefocusDeviation = DefocusDeviation;
+    }
+    if ( (*pf_Result).MaxLevelDeviation < LevelDeviation ) {
+        (*pf_Result).MaxLevelDeviation = LevelDeviation;
+    }
+
+    if ( f_RetDouble != f_RetFixed || D_TEST_DEVIATION_MAX < DefocusDeviation || D_TEST_DEVIATION_MAX < LevelDeviation ||
+         (*pf_Double).PhaseDifference != (*pf_Fixed).PhaseDifference ||
+         ( LevelDeviation == 0 && (*pf_Double).DefocusConfidence != (*pf_Fixed).DefocusConfidence ) ) {
+        if ( (*pf_Result).FailNum < D_TEST_REPORT_NUM ) {
+            printf ( "Calibration %lu : %s with PhaseDifference %ld : double ( %ld, %ld, %d, %lu, %ld ), fixed-point ( %ld, %ld, %d, %lu, %ld )\n",
+                     f_CalibIndex, pf_Api, f_PhaseDifference,
+                     f_RetDouble, (*pf_Double).Defocus, (*pf_Double).DefocusConfidence, (*pf_Double).DefocusConfidenceLevel, (*pf_Double).PhaseDifference,
+                     f_RetFixed, (*pf_Fixed).Defocus, (*pf_Fixed).DefocusConfidence, (*pf_Fixed).DefocusConfidenceLevel, (*pf_Fixed).PhaseDifference );
+        }
+        (*pf_Result).FailNum++;
+    }
+
+    return ;
+}
+
+/* Function for checking a cell of defocus maps of both engines */
+static void test_check_map ( TestResult_t *pf_Result, unsigned long f_CalibIndex, signed long f_PhaseDifference, signed long f_DefocusDouble, signed long f_DefocusFixed, unsigned long f_LevelDouble, unsigned long f_LevelFixed )
+{
+    signed long DefocusDeviation;
+    signed long LevelDeviation;
+
+    DefocusDeviation = test_deviation ( f_DefocusDouble, f_DefocusFixed );
+    LevelDeviation   = test_deviation ( (signed long)f_LevelDouble, (signed long)f_LevelFixed );
+
+    (*pf_Result).CallNum++;
+
+    if ( (*pf_Result).MaxDefocusDeviation < DefocusDeviation ) {
+        (*pf_Result).MaxDefocusDeviation = DefocusDeviation;
+    }
+    if ( (*pf_Result).MaxLevelDeviation < LevelDeviation ) {
+        (*pf_Result).MaxLevelDeviation = LevelDeviation;
+    }
+
+    if ( D_TEST_DEVIATION_MAX < DefocusDeviation || D_TEST_DEVIATION_MAX < LevelDeviation ) {
+        if ( (*pf_Result).FailNum < D_TEST_REPORT_NUM ) {
+            printf ( "Calibration %lu : %s with PhaseDifference from %ld : double ( %ld, %lu ), fixed-point ( %ld, %lu )\n",
+                     f_CalibIndex, s_ApiName[D_TEST_API_MAP], f_PhaseDifference, f_DefocusDouble, f_LevelDouble, f_DefocusFixed, f_LevelFixed );
+        }
+        (*pf_Result).FailNum++;
+    }
+
+    return ;
+}
+
+/* Function for calculating absolute difference, limited to the range of signed long */
+static signed long test_deviation ( signed long f_Double, signed long f_Fixed )
+{
+    double Deviation;
+
+    Deviation = (double)f_Double - (double)f_Fixed;
+    Deviation = ( Deviation < 0.0 ) ? -Deviation : Deviation;
+
+    return ( 2147483647.0 <= Deviation ) ? 2147483647L : (signed long)Deviation;
+}
@@ -0,0 +1,383 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/*
+    Stress test of hot swap of context of PDAF Library.
+
+    Build, for example
+
+        gcc -O2 -I../src PdafHotSwapTest.c ../src/PdafLibrary.c ../src/PdafMathFunc.c ../src/PdafThreadPool.c ../src/PdafStatistics.c ../src/PdafCalibImage.c ../src/PdafOtpDecoder.c ../src/PdafHotSwap.c ../src/PdafPhaseDetect.c ../src/PdafRoi.c ../src/PdafTracker.c ../src/PdafRecord.c ../src/PdafTrace.c -lpthread -o PdafHotSwapTest
+
+    Usage : PdafHotSwapTest [-r reader_num] [-n publish_num]
+
+        -r : Number of reader threads (default 4)
+        -n : Number of contexts published by writer (default 2000)
+
+    Reader threads acquire the context of a slot, evaluate registered windows, a batch of windows and
+    a defocus map at two analog gains, and release it, while the writer creates contexts from several
+    calibration data and publishes them in a loop. Each publication destroys the replaced context.
+    Readers acquire and evaluate the context at the same time without lock. Threshold cache of a
+    published context is kept for analog gain 0, and other analog gains calculate threshold from
+    calibration data. The test fails if output data of an acquisition is not the output data of one
+    of the calibration data at both analog gains evaluated by a context which is not published, which
+    detects a context destroyed, replaced or written while it is acquired.
+*/
+
+/****************************************************************/
+/*                          include                             */
+/****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "PdafLibrary.h"
+
+/****************************************************************/
+/*                          define                              */
+/****************************************************************/
+
+#define D_TEST_CALIB_NUM            (3)             /* Number of calibration data published in turn */
+#define D_TEST_GAIN_NUM             (4)             /* Number of analog gains evaluated by readers */
+#define D_TEST_KNOT_NUM             (6)             /* Number of knots in each direction */
+#define D_TEST_MAX_KNOT_NUM         D_TEST_KNOT_NUM
+#define D_TEST_MAX_POINT_NUM        D_TEST_POINT_NUM
+#define D_TEST_WINDOW_NUM           (16)            /* Number of windows */
+#define D_TEST_X_CELL_NUM           (24)            /* Number of cells and samples of defocus map */
+#define D_TEST_Y_CELL_NUM           (18)
+#define D_TEST_MAX_READER_NUM       (64)            /* Maximum number of reader threads */
+#define D_TEST_X_SIZE_OF_IMAGE      (4000)          /* Size of image */
+#define D_TEST_Y_SIZE_OF_IMAGE      (3000)
+
+#include "PdafTestCommon.h"
+
+/****************************************************************/
+/*                          structure                           */
+/****************************************************************/
+
+/* Output data of windows */
+typedef struct
+{
+    PdLibOutputData_t       RegWindow[D_TEST_WINDOW_NUM];
+    signed long             RegWindowResult[D_TEST_WINDOW_NUM];
+    PdLibOutputData_t       Batch[D_TEST_WINDOW_NUM];
+    signed long             BatchResult[D_TEST_WINDOW_NUM];
+    signed long             DefocusMap[D_TEST_X_CELL_NUM * D_TEST_Y_CELL_NUM];
+    unsigned long           ConfidenceLevelMap[D_TEST_X_CELL_NUM * D_TEST_Y_CELL_NUM];
+} TestOutput_t;
+
+/* State of reader thread */
+typedef struct
+{
+    pthread_t               Thread;
+    unsigned long           Seed;                   /* Seed of test_rand_seed() */
+    unsigned long           EvalNum;                /* Number of evaluations */
+    unsigned long           FailNum;                /* Number of evaluations not matching any calibration data */
+    unsigned long           CalibFound[D_TEST_CALIB_NUM];   /* Number of evaluations matching each calibration data */
+} TestReader_t;
+
+/****************************************************************/
+/*                 local function declaration                   */
+/****************************************************************/
+
+static signed long test_create_context ( TestCalib_t *pf_Calib, PdLibContext_t **ppf_Context );
+static void test_evaluate ( PdLibContext_t *pf_Context, unsigned long f_AnalogGain, TestOutput_t *pf_Output );
+static unsigned char test_same_output ( TestOutput_t *pf_Output, TestOutput_t *pf_Expected );
+static void *test_reader ( void *pf_Arg );
+
+/****************************************************************/
+/*                        global variable                       */
+/****************************************************************/
+
+/* Fixed size and knots of uniform pitch, which are the same for slope, offset and DefocusOKNG */
+static const TestCalibKind_t    s_CalibKind = { D_TEST_X_SIZE_OF_IMAGE, D_TEST_Y_SIZE_OF_IMAGE, D_TEST_KNOT_NUM, D_TEST_OKNG_SAME, 0, NULL };
+static TestCalib_t              s_Calib[D_TEST_CALIB_NUM];
+static TestOutput_t             s_Expected[D_TEST_CALIB_NUM][D_TEST_GAIN_NUM];
+static PdLibWindow_t            s_Window[D_TEST_WINDOW_NUM];
+static PdLibPhaseDiffData_t     s_PhaseDiffData[D_TEST_WINDOW_NUM];
+static PdLibPhaseDiffData_t     s_Sample[D_TEST_X_CELL_NUM * D_TEST_Y_CELL_NUM];
+static const unsigned long      s_AnalogGain[D_TEST_GAIN_NUM] = { 0, 700, 1300, 2048 };
+
+static PdLibContextSlot_t       *s_Slot;
+static unsigned char            s_WriterDone;       /* 1 : writer has published all contexts. Accessed atomically. */
+
+/****************************************************************/
+/*                           main                               */
+/****************************************************************/
+
+int main ( int argc, char *argv[] )
+{
+    TestReader_t    Reader[D_TEST_MAX_READER_NUM];
+    PdLibContext_t  *p_Context;
+    unsigned long   ReaderNum;
+    unsigned long   PublishNum;
+    unsigned long   EvalNum;
+    unsigned long   FailNum;
+    unsigned long   i;
+    unsigned long   j;
+    int             arg;
+
+    ReaderNum  = 4;
+    PublishNum = 2000;
+
+    for ( arg = 1; arg + 1 < argc; arg += 2 ) {
+        if ( strcmp ( argv[arg], "-r" ) == 0 ) {
+            ReaderNum = strtoul ( argv[arg + 1], NULL, 0 );
+        } else if ( strcmp ( argv[arg], "-n" ) == 0 ) {
+            PublishNum = strtoul ( argv[arg + 1], NULL, 0 );
+        }
+    }
+
+    if ( ReaderNum == 0 || D_TEST_MAX_READER_NUM < ReaderNum ) {
+        fprintf ( stderr, "Number of readers must be 1 to %d\n", D_TEST_MAX_READER_NUM );
+        return 1;
+    }
+
+    /* Calibration data, windows and output data expected for each of them */
+    for ( i = 0; i < D_TEST_CALIB_NUM; i++ ) {
+        test_create_calib ( &s_CalibKind, &(s_Calib[i]) );
+    }
+
+    for ( i = 0; i < D_TEST_WINDOW_NUM; i++ ) {
+        test_set_window ( D_TEST_X_SIZE_OF_IMAGE, D_TEST_Y_SIZE_OF_IMAGE, 512, &(s_Window[i]) );
+
+        s_PhaseDiffData[i].PhaseDifference = (signed long)( test_rand () % 8192 ) - 4096;
+        s_PhaseDiffData[i].ConfidenceLevel = test_rand () % 1024;
+    }
+
+    for ( i = 0; i < D_TEST_X_CELL_NUM * D_TEST_Y_CELL_NUM; i++ ) {
+        s_Sample[i].PhaseDifference = (signed long)( test_rand () % 8192 ) - 4096;
+        s_Sample[i].ConfidenceLevel = test_rand () % 1024;
+    }
+
+    for ( i = 0; i < D_TEST_CALIB_NUM; i++ ) {
+        if ( test_create_context ( &(s_Calib[i]), &p_Context ) != D_PD_LIB_E_OK ) {
+            fprintf ( stderr, "Cannot create context of calibration data %lu\n", i );
+            return 1;
+        }
+
+        for ( j = 0; j < D_TEST_GAIN_NUM; j++ ) {
+            test_evaluate ( p_Context, s_AnalogGain[j], &(s_Expected[i][j]) );
+        }
+
+        for ( j = 0; j < i; j++ ) {
+            if ( test_same_output ( &(s_Expected[i][0]), &(s_Expected[j][0]) ) != 0 ) {
+                fprintf ( stderr, "Calibration data %lu and %lu give the same output data\n", j, i );
+                PdLibDestroyContext ( p_Context );
+                return 1;
+            }
+        }
+
+        PdLibDestroyContext ( p_Context );
+    }
+
+    /* Slot with first calibration data */
+    if ( test_create_context ( &(s_Calib[0]), &p_Context ) != D_PD_LIB_E_OK ||
+         PdLibCreateContextSlot ( p_Context, &s_Slot ) != D_PD_LIB_E_OK ) {
+        fprintf ( stderr, "Cannot create slot\n" );
+        return 1;
+    }
+
+    __atomic_store_n ( &s_WriterDone, 0, __ATOMIC_SEQ_CST );
+
+    for ( i = 0; i < ReaderNum; i++ ) {
+        memset ( &(Reader[i]), 0, sizeof(TestReader_t) );
+        Reader[i].Seed = 1 + i;
+
+        if ( pthread_create ( &(Reader[i].Thread), NULL, test_reader, &(Reader[i]) ) != 0 ) {
+            fprintf ( stderr, "Cannot create reader thread\n" );
+            return 1;
+        }
+    }
+
+    /* Writer publishes calibration data in turn. Replaced context is destroyed by publication. */
+    FailNum = 0;
+
+    for ( i = 1; i <= PublishNum; i++ ) {
+        if ( test_create_context ( &(s_Calib[i % D_TEST_CALIB_NUM]), &p_Context ) != D_PD_LIB_E_OK ||
+             PdLibPublishContext ( s_Slot, p_Context ) != D_PD_LIB_E_OK ) {
+            printf ( "Publication %lu fails\n", i );
+            FailNum++;
+            break ;
+        }
+
+        sched_yield ();                                     /* Let readers acquire the context */
+    }
+
+    __atomic_store_n ( &s_WriterDone, 1, __ATOMIC_SEQ_CST );
+
+    EvalNum = 0;
+
+    for ( i = 0; i < ReaderNum; i++ ) {
+        pthread_join ( Reader[i].Thread, NULL );
+
+        printf ( "Reader %lu : %lu evaluations, %lu failures, calibration data", i, Reader[i].EvalNum, Reader[i].FailNum );
+
+        for ( j = 0; j < D_TEST_CALIB_NUM; j++ ) {
+            printf ( " %lu", Reader[i].CalibFound[j] );
+        }
+
+        printf ( "\n" );
+
+        EvalNum += Reader[i].EvalNum;
+        FailNum += Reader[i].FailNum;
+    }
+
+    PdLibDestroyContextSlot ( s_Slot );
+
+    printf ( "%lu publications, %lu evaluations, %lu failures\n%s\n", PublishNum, EvalNum, FailNum, ( FailNum == 0 ) ? "PASS" : "FAIL" );
+
+    return ( FailNum == 0 ) ? 0 : 1;
+}
+
+/****************************************************************/
+/*                       local function                         */
+/****************************************************************/
+
+/* Function for creating context prepared for publication, which is validated and has registered windows and defocus map */
+static signed long test_create_context ( TestCalib_t *pf_Calib, PdLibContext_t **ppf_Context )
+{
+    signed long ret;
+
+    ret = PdLibCreateContext ( &((*pf_Calib).CalibData), ppf_Context );
+
+    if ( ret != D_PD_LIB_E_OK ) {
+        return ret;
+    }
+
+    ret = PdLibValidateContext ( *ppf_Context );
+
+    if ( ret == D_PD_LIB_E_OK ) {
+        ret = PdLibRegisterWindows ( *ppf_Context, D_TEST_WINDOW_NUM, s_Window );
+    }
+
+    if ( ret == D_PD_LIB_E_OK ) {
+        ret = PdLibRegisterDefocusMap ( *ppf_Context, D_TEST_X_CELL_NUM, D_TEST_Y_CELL_NUM, D_TEST_X_CELL_NUM, D_TEST_Y_CELL_NUM );
+    }
+
+    if ( ret != D_PD_LIB_E_OK ) {
+        PdLibDestroyContext ( *ppf_Context );
+        (*ppf_Context) = NULL;
+    }
+
+    return ret;
+}
+
+/* Function for evaluating registered windows, a batch of windows and defocus map with context */
+static void test_evaluate ( PdLibContext_t *pf_Context, unsigned long f_AnalogGain, TestOutput_t *pf_Output )
+{
+    memset ( pf_Output, 0, sizeof(TestOutput_t) );
+
+    PdLibGetDefocusRegisteredWindows ( pf_Context, f_AnalogGain, s_PhaseDiffData, (*pf_Output).RegWindow, (*pf_Output).RegWindowResult );
+    PdLibGetDefocusBatchWithContext ( pf_Context, f_AnalogGain, D_TEST_WINDOW_NUM, s_Window, s_PhaseDiffData, (*pf_Output).Batch, (*pf_Output).BatchResult );
+    PdLibGetDefocusMap ( NULL, pf_Context, f_AnalogGain, s_Sample, (*pf_Output).DefocusMap, (*pf_Output).ConfidenceLevelMap );
+
+    return ;
+}
+
+/* Function for comparing output data. 1 : same */
+static unsigned char test_same_output ( TestOutput_t *pf_Output, TestOutput_t *pf_Expected )
+{
+    unsigned long i;
+
+    for ( i = 0; i < D_TEST_WINDOW_NUM; i++ ) {
+        if ( (*pf_Output).RegWindowResult[i] != (*pf_Expected).RegWindowResult[i] ||
+             (*pf_Output).RegWindow[i].Defocus != (*pf_Expected).RegWindow[i].Defocus ||
+             (*pf_Output).RegWindow[i].DefocusConfidence != (*pf_Expected).RegWindow[i].DefocusConfidence ||
+             (*pf_Output).RegWindow[i].DefocusConfidenceLevel != (*pf_Expected).RegWindow[i].DefocusConfidenceLevel ||
+             (*pf_Output).BatchResult[i] != (*pf_Expected).BatchResult[i] ||
+             (*pf_Output).Batch[i].Defocus != (*pf_Expected).Batch[i].Defocus ||
+             (*pf_Output).Batch[i].DefocusConfidence != (*pf_Expected).Batch[i].DefocusConfidence ||
+             (*pf_Output).Batch[i].DefocusConfidenceLevel != (*pf_Expected).Batch[i].DefocusConfidenceLevel ) {
+            return 0;
+        }
+    }
+
+    for ( i = 0; i < D_TEST_X_CELL_NUM * D_TEST_Y_CELL_NUM; i++ ) {
+        if ( (*pf_Output).DefocusMap[i] != (*pf_Expected).DefocusMap[i] ||
+             (*pf_Output).ConfidenceLevelMap[i] != (*pf_Expected).ConfidenceLevelMap[i] ) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/* Function of reader thread, which acquires, evaluates and releases the context of slot until writer ends */
+static void *test_reader ( void *pf_Arg )
+{
+    TestReader_t    *p_Reader;
+    PdLibContext_t  *p_Context;
+    TestOutput_t    Output[2];
+    unsigned long   Ticket;
+    unsigned long   Gain[2];
+    unsigned long   i;
+    unsigned char   Found;
+
+    p_Reader = (TestReader_t *)pf_Arg;
+
+    while ( __atomic_load_n ( &s_WriterDone, __ATOMIC_SEQ_CST ) == 0 ) {
+        Gain[0] = test_rand_seed ( &((*p_Reader).Seed) ) % D_TEST_GAIN_NUM;
+        Gain[1] = ( Gain[0] + 1 ) % D_TEST_GAIN_NUM;
+
+        if ( PdLibAcquireContext ( s_Slot, &p_Context, &Ticket ) != D_PD_LIB_E_OK ) {
+            (*p_Reader).FailNum++;
+            break ;
+        }
+
+        sched_yield ();                                     /* Overlap acquisitions of readers and publication */
+
+        test_evaluate ( p_Context, s_AnalogGain[Gain[0]], &(Output[0]) );
+
+        sched_yield ();
+
+        test_evaluate ( p_Context, s_AnalogGain[Gain[1]], &(Output[1]) );  /* One of the gains is not that of the cache */
+
+        PdLibReleaseContext ( s_Slot, Ticket );
+
+        Found = 0;
+
+        for ( i = 0; i < D_TEST_CALIB_NUM; i++ ) {
+            if ( test_same_output ( &(Output[0]), &(s_Expected[i][Gain[0]]) ) != 0 &&
+                 test_same_output ( &(Output[1]), &(s_Expected[i][Gain[1]]) ) != 0 ) {
+                (*p_Reader).CalibFound[i]++;
+                Found = 1;
+                break ;
+            }
+        }
+
+        if ( Found == 0 ) {
+            (*p_Reader).FailNum++;
+        }
+
+        (*p_Reader).EvalNum++;
+    }
+
+    return NULL;
+}
@@ -0,0 +1,377 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/*
+    Comparison of parallel and serial evaluation of PDAF Library.
+
+    Build, for example
+
+        gcc -O2 -I../src PdafParallelTest.c ../src/PdafLibrary.c ../src/PdafMathFunc.c ../src/PdafThreadPool.c ../src/PdafStatistics.c ../src/PdafCalibImage.c ../src/PdafOtpDecoder.c ../src/PdafHotSwap.c ../src/PdafPhaseDetect.c ../src/PdafRoi.c ../src/PdafTracker.c ../src/PdafRecord.c ../src/PdafTrace.c -lpthread -o PdafParallelTest
+
+    Usage : PdafParallelTest [-t thread_num] [-n repeat_num]
+
+        -t : Number of threads of the largest executor (default 8, 1 - 64)
+        -n : Number of repetitions of each executor and batch size (default 20)
+
+    Executors of 1, 2 and thread_num threads, and NULL executor, evaluate batches of sizes which do not
+    divide evenly among threads, including 0, 1, fewer windows than threads and some thousands of
+    windows. Windows are random, some of them invalid, with analog gains which change between calls
+    or stay the same. Output data, results of windows and return values of PdLibGetDefocusBatchParallel()
+    must be the same bit for bit as PdLibGetDefocusBatchWithContext() of the same context, including a
+    context which is not validated. PdLibGetDefocusParallel() of input data of several calibration data
+    must be the same as PdLibGetDefocus() of each input data.
+*/
+
+/****************************************************************/
+/*                          include                             */
+/****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "PdafLibrary.h"
+#include "PdafTestCommon.h"
+
+/****************************************************************/
+/*                          define                              */
+/****************************************************************/
+
+#define D_TEST_CALIB_NUM            (4)             /* Number of calibration data */
+#define D_TEST_EXECUTOR_NUM         (4)             /* NULL executor and executors of 1, 2 and thread_num threads */
+#define D_TEST_MAX_THREAD_NUM       (64)            /* Maximum number of threads of executor */
+#define D_TEST_WINDOW_NUM           (4099)          /* Maximum number of windows of a batch */
+#define D_TEST_REPORT_NUM           (10)            /* Number of failures printed */
+
+/****************************************************************/
+/*                          structure                           */
+/****************************************************************/
+
+/* Result of comparison */
+typedef struct
+{
+    unsigned long           BatchCallNum;           /* Number of compared calls of PdLibGetDefocusBatchParallel() */
+    unsigned long           InputCallNum;           /* Number of compared calls of PdLibGetDefocusParallel() */
+    unsigned long           FailNum;                /* Number of failures */
+} TestResult_t;
+
+/****************************************************************/
+/*                 local function declaration                   */
+/****************************************************************/
+
+static void test_set_windows ( TestCalib_t *pf_Calib, unsigned long f_WindowNum );
+static unsigned long test_window_num ( unsigned long f_Index, unsigned long f_ThreadNum );
+static void test_compare_batch ( PdLibExecutor_t *pf_Executor, unsigned long f_ThreadNum, PdLibContext_t *pf_Context, unsigned long f_CalibIndex, unsigned long f_WindowNum, unsigned long f_AnalogGain, TestResult_t *pf_Result );
+static void test_compare_input ( PdLibExecutor_t *pf_Executor, unsigned long f_ThreadNum, unsigned long f_InputNum, TestResult_t *pf_Result );
+static unsigned char test_same_output ( PdLibOutputData_t *pf_Output, PdLibOutputData_t *pf_Expected );
+
+/****************************************************************/
+/*                        global variable                       */
+/****************************************************************/
+
+/* Random size and knots. Knots of DefocusOKNG are disabled, 1 x 1 or of their own. Slope and offset of */
+/* some knots, and spans of some threshold lines, are up to the limit of signed 32 bit. */
+static const TestCalibKind_t s_CalibKind = { 0, 0, 0, D_TEST_OKNG_OWN_OR_NONE, 1, NULL };
+
+static TestCalib_t          s_Calib[D_TEST_CALIB_NUM];
+static PdLibWindow_t        s_Window[D_TEST_WINDOW_NUM];
+static PdLibPhaseDiffData_t s_PhaseDiffData[D_TEST_WINDOW_NUM];
+static PdLibInputData_t     s_InputData[D_TEST_WINDOW_NUM];
+static PdLibOutputData_t    s_Output[D_TEST_WINDOW_NUM];
+static PdLibOutputData_t    s_Expected[D_TEST_WINDOW_NUM];
+static signed long          s_Result[D_TEST_WINDOW_NUM];
+static signed long          s_ResultExpected[D_TEST_WINDOW_NUM];
+
+/****************************************************************/
+/*                           main                               */
+/****************************************************************/
+
+int main ( int argc, char *argv[] )
+{
+    PdLibExecutor_t *p_Executor[D_TEST_EXECUTOR_NUM];
+    PdLibContext_t  *p_Context[D_TEST_CALIB_NUM + 1];
+    unsigned long   ThreadNum[D_TEST_EXECUTOR_NUM];
+    unsigned long   MaxThreadNum;
+    unsigned long   RepeatNum;
+    TestResult_t    Result;
+    unsigned long   e;
+    unsigned long   c;
+    unsigned long   n;
+    unsigned long   r;
+    int             arg;
+    signed long     ret;
+
+    MaxThreadNum = 8;
+    RepeatNum    = 20;
+
+    for ( arg = 1; arg + 1 < argc; arg += 2 ) {
+        if ( strcmp ( argv[arg], "-t" ) == 0 ) {
+            MaxThreadNum = strtoul ( argv[arg + 1], NULL, 0 );
+        } else if ( strcmp ( argv[arg], "-n" ) == 0 ) {
+            RepeatNum = strtoul ( argv[arg + 1], NULL, 0 );
+        } else {
+            break ;
+        }
+    }
+
+    if ( arg != argc || MaxThreadNum < 1 || D_TEST_MAX_THREAD_NUM < MaxThreadNum ) {
+        fprintf ( stderr, "Usage : %s [-t thread_num] [-n repeat_num]\n", argv[0] );
+        return 1;
+    }
+
+    memset ( &Result, 0, sizeof(Result) );
+
+    /* Contexts of random calibration data, and a context which is not validated */
+    for ( c = 0; c < D_TEST_CALIB_NUM + 1; c++ ) {
+        p_Context[c] = NULL;
+
+        if ( c < D_TEST_CALIB_NUM ) {
+            test_create_calib ( &s_CalibKind, &(s_Calib[c]) );
+        }
+
+        ret = PdLibCreateContext ( &(s_Calib[c % D_TEST_CALIB_NUM].CalibData), &(p_Context[c]) );
+
+        if ( ret == D_PD_LIB_E_OK && c < D_TEST_CALIB_NUM ) {
+            ret = PdLibValidateContext ( p_Context[c] );
+        }
+
+        if ( ret != D_PD_LIB_E_OK ) {
+            fprintf ( stderr, "Cannot create context of calibration %lu : %ld\n", c, ret );
+            return 1;
+        }
+    }
+
+    ThreadNum[0] = 0;                                       /* NULL executor */
+    ThreadNum[1] = 1;
+    ThreadNum[2] = 2;
+    ThreadNum[3] = MaxThreadNum;
+
+    for ( e = 0; e < D_TEST_EXECUTOR_NUM; e++ ) {
+        p_Executor[e] = NULL;
+
+        if ( ThreadNum[e] != 0 ) {
+            ret = PdLibCreateExecutor ( ThreadNum[e], NULL, &(p_Executor[e]) );
+
+            if ( ret != D_PD_LIB_E_OK ) {
+                fprintf ( stderr, "Cannot create executor of %lu threads : %ld\n", ThreadNum[e], ret );
+                return 1;
+            }
+        }
+    }
+
+    for ( r = 0; r < RepeatNum; r++ ) {
+        for ( e = 0; e < D_TEST_EXECUTOR_NUM; e++ ) {
+            for ( n = 0; n < 16; n++ ) {
+                unsigned long WindowNum;
+                unsigned long AnalogGain;
+
+                WindowNum = test_window_num ( n, MaxThreadNum );
+                c         = ( r + n ) % ( D_TEST_CALIB_NUM + 1 );
+
+                test_set_windows ( &(s_Calib[c % D_TEST_CALIB_NUM]), WindowNum );
+
+                /* Same analog gain twice in a row, which keeps threshold cache of context */
+                AnalogGain = test_rand () % ( s_Calib[c % D_TEST_CALIB_NUM].MaxAnalogGain + 1 );
+
+                test_compare_batch ( p_Executor[e], ThreadNum[e], p_Context[c], c, WindowNum, AnalogGain, &Result );
+                test_compare_batch ( p_Executor[e], ThreadNum[e], p_Context[c], c, WindowNum, AnalogGain, &Result );
+
+                test_compare_input ( p_Executor[e], ThreadNum[e], WindowNum, &Result );
+            }
+        }
+    }
+
+    printf ( "Thread numbers 1, 2 and %lu : %lu batches, %lu arrays of input data, %lu failures\n",
+             MaxThreadNum, Result.BatchCallNum, Result.InputCallNum, Result.FailNum );
+
+    printf ( "%s\n", ( Result.FailNum == 0 ) ? "PASS" : "FAIL" );
+
+    for ( e = 0; e < D_TEST_EXECUTOR_NUM; e++ ) {
+        if ( p_Executor[e] != NULL ) {
+            PdLibDestroyExecutor ( p_Executor[e] );
+        }
+    }
+    for ( c = 0; c < D_TEST_CALIB_NUM + 1; c++ ) {
+        PdLibDestroyContext ( p_Context[c] );
+    }
+
+    return ( Result.FailNum == 0 ) ? 0 : 1;
+}
+
+/****************************************************************/
+/*                       local function                         */
+/****************************************************************/
+
+/* Function for setting random windows, phase difference data and input data of several calibration data */
+/* One of 16 windows is out of image. */
+static void test_set_windows ( TestCalib_t *pf_Calib, unsigned long f_WindowNum )
+{
+    PdLibCalibData_t *p_CalibData;
+    unsigned long i;
+
+    p_CalibData = &((*pf_Calib).CalibData);
+
+    for ( i = 0; i < f_WindowNum; i++ ) {
+        TestCalib_t *p_InputCalib;
+
+        test_set_window ( (*p_CalibData).XSizeOfImage, (*p_CalibData).YSizeOfImage, 512, &(s_Window[i]) );
+
+        if ( test_rand () % 16 == 0 ) {
+            s_Window[i].YAddressOfWindowEnd = (*p_CalibData).YSizeOfImage;
+        }
+
+        s_PhaseDiffData[i].PhaseDifference = ( test_rand () % 16 == 0 ) ? D_PD_ERROR_VALUE * 16 : test_rand_range ( -32768, 32767 );
+        s_PhaseDiffData[i].ConfidenceLevel = ( test_rand () % 16 == 0 ) ? test_rand () : test_rand () % 8192;
+
+        /* Input data of a calibration data in turn, with its own window */
+        p_InputCalib = &(s_Calib[i % D_TEST_CALIB_NUM]);
+
+        test_set_input ( p_InputCalib, &(s_Window[i]), s_PhaseDiffData[i].PhaseDifference, s_PhaseDiffData[i].ConfidenceLevel,
+                         test_rand () % ( (*p_InputCalib).MaxAnalogGain + 1 ), &(s_InputData[i]) );
+
+        if ( (*p_InputCalib).CalibData.XSizeOfImage <= s_InputData[i].XAddressOfWindowEnd ) {
+            s_InputData[i].XAddressOfWindowEnd = (*p_InputCalib).CalibData.XSizeOfImage - 1;
+        }
+        if ( (*p_InputCalib).CalibData.YSizeOfImage <= s_InputData[i].YAddressOfWindowEnd && test_rand () % 2 == 0 ) {
+            s_InputData[i].YAddressOfWindowEnd = (*p_InputCalib).CalibData.YSizeOfImage - 1;
+        }
+    }
+
+    return ;
+}
+
+/* Function for getting number of windows which does not divide evenly among threads */
+static unsigned long test_window_num ( unsigned long f_Index, unsigned long f_ThreadNum )
+{
+    switch ( f_Index ) {
+    case 0 :
+        return 0;
+    case 1 :
+        return 1;
+    case 2 :
+        return 2;
+    case 3 :
+        return 3;
+    case 4 :
+        return ( f_ThreadNum - 1 < 1 ) ? 1 : f_ThreadNum - 1;      /* Fewer windows than threads */
+    case 5 :
+        return f_ThreadNum + 1;
+    case 6 :
+        return 2 * f_ThreadNum + 1;
+    case 7 :
+        return 63;
+    case 8 :
+        return 65;
+    case 9 :
+        return 1023;
+    case 10 :
+        return D_TEST_WINDOW_NUM;
+    default :
+        return test_rand () % ( D_TEST_WINDOW_NUM + 1 );
+    }
+}
+
+/* Function for comparing PdLibGetDefocusBatchParallel() with PdLibGetDefocusBatchWithContext() */
+static void test_compare_batch ( PdLibExecutor_t *pf_Executor, unsigned long f_ThreadNum, PdLibContext_t *pf_Context, unsigned long f_CalibIndex, unsigned long f_WindowNum, unsigned long f_AnalogGain, TestResult_t *pf_Result )
+{
+    signed long ret;
+    signed long RetExpected;
+    unsigned long i;
+
+    /* Output data of both are filled with different values, which must all be overwritten */
+    memset ( s_Output, 0x5A, sizeof(PdLibOutputData_t) * f_WindowNum );
+    memset ( s_Result, 0x5A, sizeof(signed long) * f_WindowNum );
+    memset ( s_Expected, 0xA5, sizeof(PdLibOutputData_t) * f_WindowNum );
+    memset ( s_ResultExpected, 0xA5, sizeof(signed long) * f_WindowNum );
+
+    ret         = PdLibGetDefocusBatchParallel ( pf_Executor, pf_Context, f_AnalogGain, f_WindowNum, s_Window, s_PhaseDiffData, s_Output, s_Result );
+    RetExpected = PdLibGetDefocusBatchWithContext ( pf_Context, f_AnalogGain, f_WindowNum, s_Window, s_PhaseDiffData, s_Expected, s_ResultExpected );
+
+    (*pf_Result).BatchCallNum++;
+
+    if ( ret != RetExpected ) {
+        if ( (*pf_Result).FailNum < D_TEST_REPORT_NUM ) {
+            printf ( "%lu threads, calibration %lu, %lu windows : PdLibGetDefocusBatchParallel returns %ld, serial %ld\n",
+                     f_ThreadNum, f_CalibIndex, f_WindowNum, ret, RetExpected );
+        }
+        (*pf_Result).FailNum++;
+    }
+
+    for ( i = 0; i < f_WindowNum; i++ ) {
+        if ( s_Result[i] != s_ResultExpected[i] || test_same_output ( &(s_Output[i]), &(s_Expected[i]) ) == 0 ) {
+            if ( (*pf_Result).FailNum < D_TEST_REPORT_NUM ) {
+                printf ( "%lu threads, calibration %lu, %lu windows, window %lu : parallel ( %ld, %ld, %d, %lu, %ld ), serial ( %ld, %ld, %d, %lu, %ld )\n",
+                         f_ThreadNum, f_CalibIndex, f_WindowNum, i,
+                         s_Result[i], s_Output[i].Defocus, s_Output[i].DefocusConfidence, s_Output[i].DefocusConfidenceLevel, s_Output[i].PhaseDifference,
+                         s_ResultExpected[i], s_Expected[i].Defocus, s_Expected[i].DefocusConfidence, s_Expected[i].DefocusConfidenceLevel, s_Expected[i].PhaseDifference );
+            }
+            (*pf_Result).FailNum++;
+        }
+    }
+
+    return ;
+}
+
+/* Function for comparing PdLibGetDefocusParallel() with PdLibGetDefocus() of each input data */
+static void test_compare_input ( PdLibExecutor_t *pf_Executor, unsigned long f_ThreadNum, unsigned long f_InputNum, TestResult_t *pf_Result )
+{
+    unsigned long i;
+
+    memset ( s_Output, 0x5A, sizeof(PdLibOutputData_t) * f_InputNum );
+    memset ( s_Result, 0x5A, sizeof(signed long) * f_InputNum );
+
+    PdLibGetDefocusParallel ( pf_Executor, f_InputNum, s_InputData, s_Output, s_Result );
+
+    (*pf_Result).InputCallNum++;
+
+    for ( i = 0; i < f_InputNum; i++ ) {
+        memset ( &(s_Expected[i]), 0xA5, sizeof(PdLibOutputData_t) );
+
+        s_ResultExpected[i] = PdLibGetDefocus ( &(s_InputData[i]), &(s_Expected[i]) );
+
+        if ( s_Result[i] != s_ResultExpected[i] || test_same_output ( &(s_Output[i]), &(s_Expected[i]) ) == 0 ) {
+            if ( (*pf_Result).FailNum < D_TEST_REPORT_NUM ) {
+                printf ( "%lu threads, %lu input data, input data %lu : parallel ( %ld, %ld, %d, %lu, %ld ), serial ( %ld, %ld, %d, %lu, %ld )\n",
+                         f_ThreadNum, f_InputNum, i,
+                         s_Result[i], s_Output[i].Defocus, s_Output[i].DefocusConfidence, s_Output[i].DefocusConfidenceLevel, s_Output[i].PhaseDifference,
+                         s_ResultExpected[i], s_Expected[i].Defocus, s_Expected[i].DefocusConfidence, s_Expected[i].DefocusConfidenceLevel, s_Expected[i].PhaseDifference );
+            }
+            (*pf_Result).FailNum++;
+        }
+    }
+
+    return ;
+}
+
+/* Function for comparing output data field by field */
+static unsigned char test_same_output ( PdLibOutputData_t *pf_Output, PdLibOutputData_t *pf_Expected )
+{
+    return ( (*pf_Output).Defocus                == (*pf_Expected).Defocus &&
+             (*pf_Output).DefocusConfidence      == (*pf_Expected).DefocusConfidence &&
+             (*pf_Output).DefocusConfidenceLevel == (*pf_Expected).DefocusConfidenceLevel &&
+             (*pf_Output).PhaseDifference        == (*pf_Expected).PhaseDifference ) ? 1 : 0;
+}
@@ -0,0 +1,574 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+    Accuracy of phase difference of PDAF Library from synthetic PD images.
+
+    The test is built with the sources of PDAF Library, for example
+
+        gcc -O2 -I../src PdafPhaseDetectTest.c ../src/PdafLibrary.c ../src/PdafMathFunc.c ../src/PdafThreadPool.c ../src/PdafStatistics.c ../src/PdafCalibImage.c ../src/PdafOtpDecoder.c ../src/PdafHotSwap.c ../src/PdafPhaseDetect.c ../src/PdafRoi.c ../src/PdafTracker.c ../src/PdafRecord.c ../src/PdafTrace.c -lpthread -lm -o PdafPhaseDetectTest
+
+    Usage : PdafPhaseDetectTest
+
+    Left sub-image is a sum of Gaussian bumps of random position, width and height, and right sub-image
+    is the same bumps shifted by a known sub-pixel disparity, with the same offset of each row. For
+    SAD and SSD and disparities over the search range, PhaseDifference of PdLibGetPhaseDiffPyramid()
+    of 1 level (full search) must deviate from disparity * PhaseDiffScale by D_TEST_DEVIATION_MAX or
+    less. Pyramid of 2 - 4 levels must give level 0 of result and the same PhaseDifference and
+    ConfidenceLevel as the full search, except that error value is also correct for disparity within
+    a shift of the coarsest level from the end of the search range. In a single row with noise, whose
+    result is often of a coarser level, PhaseDifference of level l > 0 must be within a shift of level l+2.
+    PhaseDetectWindow() of each window must give the same bits as PdLibGetPhaseDiffPyramid() with an
+    executor, and PdLibGetPhaseDiff() the same as 1 level. Flat images, windows too close to the edge
+    of sub-images, ConfidenceLevel of higher contrast and invalid parameters are also checked.
+*/
+
+/****************************************************************/
+/*                          include                             */
+/****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "PdafLibrary.h"
+#include "PdafPhaseDetect.h"
+#include "PdafTestCommon.h"
+
+/****************************************************************/
+/*                          define                              */
+/****************************************************************/
+
+#define D_TEST_X_SIZE               (1024)          /* Size of sub-images in PD pixels */
+#define D_TEST_Y_SIZE               (64)
+#define D_TEST_PIXEL_PITCH          (4)             /* Pixels of image in all-pixel mode of a PD pixel */
+#define D_TEST_BUMP_PITCH           (4)             /* Mean pitch of Gaussian bumps in PD pixels */
+#define D_TEST_BUMP_NUM             ( ( D_TEST_X_SIZE + 2 * 128 ) / D_TEST_BUMP_PITCH )
+#define D_TEST_BASE_VALUE           (2048)          /* Mean pixel value */
+#define D_TEST_MAX_VALUE            (4095)          /* Maximum pixel value */
+#define D_TEST_WINDOW_NUM           (3)             /* Windows of 512, 128 and 32 PD pixels */
+#define D_TEST_SEARCH_RANGE         (32)            /* Search range of disparities swept over it */
+#define D_TEST_SHIFT_STEP           (0.375)         /* Step of disparity in PD pixels */
+#define D_TEST_PHASE_DIFF_SCALE     (64)            /* PhaseDifference of a PD pixel */
+#define D_TEST_NOISE                (800)           /* Noise of pixels of a single row, often found in coarser levels only */
+#define D_TEST_DEVIATION_MAX        (2)             /* Maximum deviation of full search from disparity */
+#define D_TEST_REPORT_NUM           (10)            /* Number of failures printed */
+
+/****************************************************************/
+/*                          structure                           */
+/****************************************************************/
+
+/* Result of comparison */
+typedef struct
+{
+    unsigned long           CallNum;                /* Number of checked windows */
+    unsigned long           FailNum;                /* Number of failures */
+    signed long             MaxDeviation[2];        /* Maximum deviation of full search of each cost */
+} TestResult_t;
+
+/****************************************************************/
+/*                 local function declaration                   */
+/****************************************************************/
+
+static void test_set_bumps ( void );
+static void test_set_image ( double f_Shift, double f_Contrast, signed long f_Noise );
+static unsigned short test_pixel ( double f_Value, signed long f_Noise );
+static void test_set_pd_image ( PdLibPdImage_t *pf_Image );
+static void test_set_param ( unsigned char f_CostType, unsigned short f_SearchRange, PdLibPdParam_t *pf_Param );
+static void test_set_pd_window ( unsigned long f_XStart, unsigned long f_XNum, PdLibWindow_t *pf_Window );
+static void test_detect ( PdLibExecutor_t *pf_Executor, const PdLibPdImage_t *pf_Image, const PdLibPdParam_t *pf_Param, double f_Shift, unsigned long f_LevelNum, unsigned long f_WindowNum, PdLibWindow_t *pf_Window, PdLibPhaseDiffData_t *pf_PhaseDiffData, unsigned char *pf_Level, TestResult_t *pf_Result );
+static void test_check_shift ( PdLibExecutor_t *pf_Executor, unsigned char f_CostType, unsigned short f_SearchRange, double f_Shift, unsigned long f_WindowNum, PdLibWindow_t *pf_Window, TestResult_t *pf_Result );
+static void test_check_noise ( PdLibExecutor_t *pf_Executor, TestResult_t *pf_Result );
+static void test_check_error ( PdLibExecutor_t *pf_Executor, TestResult_t *pf_Result );
+static void test_check_contrast ( PdLibExecutor_t *pf_Executor, TestResult_t *pf_Result );
+static void test_fail ( TestResult_t *pf_Result, const char *pf_Message, unsigned char f_CostType, unsigned long f_LevelNum, double f_Shift, unsigned long f_Window, signed long f_Value, signed long f_Expected );
+static signed long test_deviation ( signed long f_Value, signed long f_Expected );
+
+/****************************************************************/
+/*                        global variable                       */
+/****************************************************************/
+
+static double           s_BumpCenter[D_TEST_BUMP_NUM];      /* Gaussian bumps of texture */
+static double           s_BumpSigma[D_TEST_BUMP_NUM];
+static double           s_BumpHeight[D_TEST_BUMP_NUM];
+static unsigned short   s_Left[D_TEST_Y_SIZE * D_TEST_X_SIZE];
+static unsigned short   s_Right[D_TEST_Y_SIZE * D_TEST_X_SIZE];
+
+/****************************************************************/
+/*                           main                               */
+/****************************************************************/
+
+int main ( void )
+{
+    PdLibExecutor_t *p_Executor;
+    PdLibWindow_t   Window[D_TEST_WINDOW_NUM];
+    TestResult_t    Result;
+    unsigned char   c;
+    double          Shift;
+    signed long     ret;
+
+    memset ( &Result, 0, sizeof(Result) );
+
+    ret = PdLibCreateExecutor ( 2, NULL, &p_Executor );
+
+    if ( ret != D_PD_LIB_E_OK ) {
+        fprintf ( stderr, "Cannot create executor : %ld\n", ret );
+        return 1;
+    }
+
+    test_set_bumps ();
+
+    /* Windows of 512, 128 and 32 PD pixels, the last of which is searched in fewer levels */
+    test_set_pd_window ( 256, 512, &(Window[0]) );
+    test_set_pd_window ( 600, 128, &(Window[1]) );
+    test_set_pd_window ( 100, 32,  &(Window[2]) );
+
+    for ( c = D_PD_LIB_PD_COST_SAD; c <= D_PD_LIB_PD_COST_SSD; c++ ) {
+        /* Disparities over the search range except the last 2 PD pixels, whose peak can be at the end */
+        for ( Shift = -( D_TEST_SEARCH_RANGE - 2 ); Shift <= D_TEST_SEARCH_RANGE - 2; Shift += D_TEST_SHIFT_STEP ) {
+            test_check_shift ( p_Executor, c, D_TEST_SEARCH_RANGE, Shift, D_TEST_WINDOW_NUM, Window, &Result );
+        }
+
+        /* Large disparities of the maximum search range in the widest window */
+        test_check_shift ( p_Executor, c, D_PD_LIB_PD_SEARCH_RANGE_MAX, 50.5, 1, Window, &Result );
+        test_check_shift ( p_Executor, c, D_PD_LIB_PD_SEARCH_RANGE_MAX, -60.25, 1, Window, &Result );
+    }
+
+    test_check_noise ( p_Executor, &Result );
+    test_check_error ( p_Executor, &Result );
+    test_check_contrast ( p_Executor, &Result );
+
+    printf ( "%lu windows, %lu failures\n", Result.CallNum, Result.FailNum );
+    printf ( "Maximum deviation of full search : SAD %ld, SSD %ld of %d a PD pixel\n",
+             Result.MaxDeviation[0], Result.MaxDeviation[1], D_TEST_PHASE_DIFF_SCALE );
+
+    printf ( "%s\n", ( Result.FailNum == 0 ) ? "PASS" : "FAIL" );
+
+    PdLibDestroyExecutor ( p_Executor );
+
+    return ( Result.FailNum == 0 ) ? 0 : 1;
+}
+
+/****************************************************************/
+/*                       local function                         */
+/****************************************************************/
+
+/* Function for setting random Gaussian bumps of texture, which cover sub-images with margin of shift */
+static void test_set_bumps ( void )
+{
+    unsigned long i;
+
+    for ( i = 0; i < D_TEST_BUMP_NUM; i++ ) {
+        s_BumpCenter[i] = -128.0 + (double)( i * D_TEST_BUMP_PITCH ) + (double)( test_rand () % 1024 ) * D_TEST_BUMP_PITCH / 1024.0;
+        s_BumpSigma[i]  = 1.5 + (double)( test_rand () % 1024 ) * 2.5 / 1024.0;
+        s_BumpHeight[i] = (double)test_rand_range ( -400, 400 );
+    }
+
+    return ;
+}
+
+/* Function for setting sub-images, whose right sub-image is the left one shifted by f_Shift PD pixels */
+static void test_set_image ( double f_Shift, double f_Contrast, signed long f_Noise )
+{
+    unsigned long x;
+    unsigned long y;
+    unsigned long i;
+
+    for ( x = 0; x < D_TEST_X_SIZE; x++ ) {
+        double Left;
+        double Right;
+
+        Left  = 0.0;
+        Right = 0.0;
+
+        for ( i = 0; i < D_TEST_BUMP_NUM; i++ ) {
+            double dl;
+            double dr;
+
+            dl = ( (double)x - s_BumpCenter[i] ) / s_BumpSigma[i];
+            dr = ( (double)x - f_Shift - s_BumpCenter[i] ) / s_BumpSigma[i];
+
+            Left  += s_BumpHeight[i] * exp ( -0.5 * dl * dl );
+            Right += s_BumpHeight[i] * exp ( -0.5 * dr * dr );
+        }
+
+        /* Offset of each row is the same in both sub-images, which averaging of rows cancels */
+        for ( y = 0; y < D_TEST_Y_SIZE; y++ ) {
+            s_Left[y * D_TEST_X_SIZE + x]  = test_pixel ( (double)( y % 7 ) * 16.0 + f_Contrast * Left,  f_Noise );
+            s_Right[y * D_TEST_X_SIZE + x] = test_pixel ( (double)( y % 7 ) * 16.0 + f_Contrast * Right, f_Noise );
+        }
+    }
+
+    return ;
+}
+
+/* Function for getting 12 bit pixel value of f_Value from the mean, with random noise from -f_Noise to f_Noise */
+static unsigned short test_pixel ( double f_Value, signed long f_Noise )
+{
+    signed long Value;
+
+    Value = (signed long)floor ( D_TEST_BASE_VALUE + f_Value + 0.5 ) + test_rand_range ( -f_Noise, f_Noise );
+
+    if ( Value < 0 ) {
+        Value = 0;
+    } else if ( D_TEST_MAX_VALUE < Value ) {
+        Value = D_TEST_MAX_VALUE;
+    }
+
+    return (unsigned short)Value;
+}
+
+/* Function for setting PD image of the sub-images */
+static void test_set_pd_image ( PdLibPdImage_t *pf_Image )
+{
+    (*pf_Image).p_Left       = s_Left;
+    (*pf_Image).p_Right      = s_Right;
+    (*pf_Image).Stride       = D_TEST_X_SIZE;
+    (*pf_Image).XSize        = D_TEST_X_SIZE;
+    (*pf_Image).YSize        = D_TEST_Y_SIZE;
+    (*pf_Image).XSizeOfImage = D_TEST_X_SIZE * D_TEST_PIXEL_PITCH;
+    (*pf_Image).YSizeOfImage = D_TEST_Y_SIZE * D_TEST_PIXEL_PITCH;
+
+    return ;
+}
+
+/* Function for setting parameter of disparity search */
+static void test_set_param ( unsigned char f_CostType, unsigned short f_SearchRange, PdLibPdParam_t *pf_Param )
+{
+    (*pf_Param).SearchRange    = f_SearchRange;
+    (*pf_Param).CostType       = f_CostType;
+    (*pf_Param).PhaseDiffScale = D_TEST_PHASE_DIFF_SCALE;
+    (*pf_Param).ConfidenceGain = 16;
+    (*pf_Param).PdErrorValue   = D_PD_ERROR_VALUE * D_TEST_PHASE_DIFF_SCALE;
+
+    return ;
+}
+
+/* Function for setting window of f_XNum PD pixels from f_XStart and rows 8 to 55, in all-pixel mode */
+static void test_set_pd_window ( unsigned long f_XStart, unsigned long f_XNum, PdLibWindow_t *pf_Window )
+{
+    (*pf_Window).XAddressOfWindowStart = (unsigned short)( f_XStart * D_TEST_PIXEL_PITCH );
+    (*pf_Window).XAddressOfWindowEnd   = (unsigned short)( ( f_XStart + f_XNum - 1 ) * D_TEST_PIXEL_PITCH );
+    (*pf_Window).YAddressOfWindowStart = 8 * D_TEST_PIXEL_PITCH;
+    (*pf_Window).YAddressOfWindowEnd   = 55 * D_TEST_PIXEL_PITCH;
+
+    return ;
+}
+
+/* Function for getting phase difference of windows by PdLibGetPhaseDiffPyramid() */
+/* PhaseDetectWindow() of each window, and PdLibGetPhaseDiff() of 1 level, must give the same bits. */
+static void test_detect ( PdLibExecutor_t *pf_Executor, const PdLibPdImage_t *pf_Image, const PdLibPdParam_t *pf_Param, double f_Shift, unsigned long f_LevelNum, unsigned long f_WindowNum, PdLibWindow_t *pf_Window, PdLibPhaseDiffData_t *pf_PhaseDiffData, unsigned char *pf_Level, TestResult_t *pf_Result )
+{
+    PdLibPhaseDiffData_t PhaseDiffData;
+    PdLibPhaseDiffData_t FullData[D_TEST_WINDOW_NUM];
+    unsigned char Level;
+    unsigned long i;
+    signed long ret;
+
+    ret = PdLibGetPhaseDiffPyramid ( pf_Executor, pf_Image, pf_Param, f_LevelNum, f_WindowNum, pf_Window, pf_PhaseDiffData, pf_Level );
+
+    if ( ret != D_PD_LIB_E_OK ) {
+        test_fail ( pf_Result, "PdLibGetPhaseDiffPyramid returns", (*pf_Param).CostType, f_LevelNum, f_Shift, 0, ret, D_PD_LIB_E_OK );
+        return ;
+    }
+
+    if ( f_LevelNum == 1 ) {
+        ret = PdLibGetPhaseDiff ( pf_Executor, pf_Image, pf_Param, f_WindowNum, pf_Window, FullData );
+
+        for ( i = 0; i < f_WindowNum; i++ ) {
+            if ( ret != D_PD_LIB_E_OK ||
+                 FullData[i].PhaseDifference != pf_PhaseDiffData[i].PhaseDifference ||
+                 FullData[i].ConfidenceLevel != pf_PhaseDiffData[i].ConfidenceLevel ) {
+                test_fail ( pf_Result, "PdLibGetPhaseDiff differs from 1 level", (*pf_Param).CostType, f_LevelNum, f_Shift, i,
+                            FullData[i].PhaseDifference, pf_PhaseDiffData[i].PhaseDifference );
+            }
+        }
+    }
+
+    for ( i = 0; i < f_WindowNum; i++ ) {
+        PhaseDetectWindow ( pf_Image, pf_Param, f_LevelNum, &(pf_Window[i]), &PhaseDiffData, &Level );
+
+        if ( PhaseDiffData.PhaseDifference != pf_PhaseDiffData[i].PhaseDifference ||
+             PhaseDiffData.ConfidenceLevel != pf_PhaseDiffData[i].ConfidenceLevel || Level != pf_Level[i] ) {
+            test_fail ( pf_Result, "PhaseDetectWindow differs from executor", (*pf_Param).CostType, f_LevelNum, f_Shift, i,
+                        PhaseDiffData.PhaseDifference, pf_PhaseDiffData[i].PhaseDifference );
+        }
+    }
+
+    return ;
+}
+
+/* Function for checking full search and pyramid of windows of sub-images shifted by f_Shift PD pixels */
+static void test_check_shift ( PdLibExecutor_t *pf_Executor, unsigned char f_CostType, unsigned short f_SearchRange, double f_Shift, unsigned long f_WindowNum, PdLibWindow_t *pf_Window, TestResult_t *pf_Result )
+{
+    PdLibPdImage_t          Image;
+    PdLibPdParam_t          Param;
+    PdLibPhaseDiffData_t    Full[D_TEST_WINDOW_NUM];
+    PdLibPhaseDiffData_t    Pyramid[D_TEST_WINDOW_NUM];
+    unsigned char           Level[D_TEST_WINDOW_NUM];
+    signed long             Expected;
+    signed long             Deviation;
+    unsigned long           l;
+    unsigned long           i;
+
+    test_set_image ( f_Shift, 1.0, 0 );
+    test_set_pd_image ( &Image );
+    test_set_param ( f_CostType, f_SearchRange, &Param );
+
+    Expected = (signed long)floor ( f_Shift * D_TEST_PHASE_DIFF_SCALE + 0.5 );
+
+    /* Full search */
+    test_detect ( pf_Executor, &Image, &Param, f_Shift, 1, f_WindowNum, pf_Window, Full, Level, pf_Result );
+
+    for ( i = 0; i < f_WindowNum; i++ ) {
+        (*pf_Result).CallNum++;
+
+        Deviation = test_deviation ( Full[i].PhaseDifference, Expected );
+
+        if ( (*pf_Result).MaxDeviation[f_CostType] < Deviation ) {
+            (*pf_Result).MaxDeviation[f_CostType] = Deviation;
+        }
+
+        if ( D_TEST_DEVIATION_MAX < Deviation || Full[i].ConfidenceLevel == 0 || Level[i] != 0 ) {
+            test_fail ( pf_Result, "Full search deviates from disparity", f_CostType, 1, f_Shift, i, Full[i].PhaseDifference, Expected );
+        }
+    }
+
+    /* Pyramid of 2 - 4 levels */
+    for ( l = 2; l <= D_PD_LIB_PD_LEVEL_NUM_MAX; l++ ) {
+        test_detect ( pf_Executor, &Image, &Param, f_Shift, l, f_WindowNum, pf_Window, Pyramid, Level, pf_Result );
+
+        for ( i = 0; i < f_WindowNum; i++ ) {
+            (*pf_Result).CallNum++;
+
+            /* Peak of the coarsest level is at the end of its search range when disparity is within a shift */
+            /* of the coarsest level from the end of the range, where error value is also correct. */
+            if ( f_SearchRange - ( 1 << ( l - 1 ) ) - 1 < fabs ( f_Shift ) &&
+                 Pyramid[i].PhaseDifference == Param.PdErrorValue && Pyramid[i].ConfidenceLevel == 0 && Level[i] == 0 ) {
+                continue ;
+            }
+
+            /* Level 0 searches the band of the same costs as full search */
+            if ( Pyramid[i].PhaseDifference != Full[i].PhaseDifference || Pyramid[i].ConfidenceLevel != Full[i].ConfidenceLevel || Level[i] != 0 ) {
+                test_fail ( pf_Result, "Pyramid deviates from full search", f_CostType, l, f_Shift, i, Pyramid[i].PhaseDifference, Full[i].PhaseDifference );
+            }
+        }
+    }
+
+    return ;
+}
+
+/* Function for checking pyramid of a row with noise, whose result is often of a coarser level */
+/* PhaseDifference of level l > 0 must be within a shift of level l+2 from disparity, or error value. */
+static void test_check_noise ( PdLibExecutor_t *pf_Executor, TestResult_t *pf_Result )
+{
+    PdLibPdImage_t          Image;
+    PdLibPdParam_t          Param;
+    PdLibWindow_t           Window;
+    PdLibPhaseDiffData_t    PhaseDiffData;
+    unsigned char           Level;
+    unsigned char           c;
+    unsigned long           CoarseNum[2];
+    signed long             Expected;
+    double                  Shift;
+
+    test_set_pd_image ( &Image );
+    test_set_pd_window ( 256, 512, &Window );
+
+    Window.YAddressOfWindowEnd = Window.YAddressOfWindowStart;
+
+    CoarseNum[0] = 0;
+    CoarseNum[1] = 0;
+
+    for ( Shift = -24.0; Shift <= 24.0; Shift += 0.625 ) {
+        test_set_image ( Shift, 1.0, D_TEST_NOISE );
+
+        Expected = (signed long)floor ( Shift * D_TEST_PHASE_DIFF_SCALE + 0.5 );
+
+        for ( c = D_PD_LIB_PD_COST_SAD; c <= D_PD_LIB_PD_COST_SSD; c++ ) {
+            test_set_param ( c, D_TEST_SEARCH_RANGE, &Param );
+            test_detect ( pf_Executor, &Image, &Param, Shift, D_PD_LIB_PD_LEVEL_NUM_MAX, 1, &Window, &PhaseDiffData, &Level, pf_Result );
+
+            (*pf_Result).CallNum++;
+
+            if ( PhaseDiffData.PhaseDifference == Param.PdErrorValue ) {
+                continue ;
+            }
+
+            if ( 0 < Level ) {
+                CoarseNum[c]++;
+            }
+
+            /* Peak of level 0 in noise can be a few PD pixels away, and its accuracy is checked without noise */
+            if ( ( 0 < Level && ( D_TEST_PHASE_DIFF_SCALE << ( Level + 2 ) ) < test_deviation ( PhaseDiffData.PhaseDifference, Expected ) ) ||
+                 PhaseDiffData.ConfidenceLevel == 0 ) {
+                test_fail ( pf_Result, "Noisy row deviates from disparity", c, D_PD_LIB_PD_LEVEL_NUM_MAX, Shift, 0, PhaseDiffData.PhaseDifference, Expected );
+            }
+        }
+    }
+
+    /* Results of coarser levels must be checked */
+    for ( c = D_PD_LIB_PD_COST_SAD; c <= D_PD_LIB_PD_COST_SSD; c++ ) {
+        if ( CoarseNum[c] == 0 ) {
+            test_fail ( pf_Result, "No result of coarser level", c, D_PD_LIB_PD_LEVEL_NUM_MAX, 0.0, 0, 0, 1 );
+        }
+    }
+
+    return ;
+}
+
+/* Function for checking flat sub-images, windows too close to the edge and invalid parameters */
+static void test_check_error ( PdLibExecutor_t *pf_Executor, TestResult_t *pf_Result )
+{
+    PdLibPdImage_t          Image;
+    PdLibPdParam_t          Param;
+    PdLibWindow_t           Window[D_TEST_WINDOW_NUM];
+    PdLibPhaseDiffData_t    PhaseDiffData[D_TEST_WINDOW_NUM];
+    unsigned char           Level[D_TEST_WINDOW_NUM];
+    unsigned char           c;
+    unsigned long           l;
+    unsigned long           i;
+    signed long             ret;
+
+    test_set_pd_image ( &Image );
+
+    /* Flat sub-images, and windows whose columns inside sub-images for the search range are fewer than 4 */
+    test_set_image ( 3.5, 0.0, 0 );
+    test_set_pd_window ( 256, 512, &(Window[0]) );
+    test_set_pd_window ( 0, D_TEST_SEARCH_RANGE + 3, &(Window[1]) );
+    test_set_pd_window ( D_TEST_X_SIZE - D_TEST_SEARCH_RANGE - 3, D_TEST_SEARCH_RANGE + 3, &(Window[2]) );
+
+    for ( c = D_PD_LIB_PD_COST_SAD; c <= D_PD_LIB_PD_COST_SSD; c++ ) {
+        test_set_param ( c, D_TEST_SEARCH_RANGE, &Param );
+
+        for ( l = 1; l <= D_PD_LIB_PD_LEVEL_NUM_MAX; l++ ) {
+            test_detect ( pf_Executor, &Image, &Param, 3.5, l, D_TEST_WINDOW_NUM, Window, PhaseDiffData, Level, pf_Result );
+
+            for ( i = 0; i < D_TEST_WINDOW_NUM; i++ ) {
+                (*pf_Result).CallNum++;
+
+                if ( PhaseDiffData[i].PhaseDifference != Param.PdErrorValue || PhaseDiffData[i].ConfidenceLevel != 0 || Level[i] != 0 ) {
+                    test_fail ( pf_Result, "Window is not error value", c, l, 3.5, i, PhaseDiffData[i].PhaseDifference, Param.PdErrorValue );
+                }
+            }
+        }
+    }
+
+    /* Invalid number of levels, search range, cost and window out of image */
+    test_set_param ( D_PD_LIB_PD_COST_SAD, D_TEST_SEARCH_RANGE, &Param );
+    test_set_pd_window ( 256, 512, &(Window[0]) );
+
+    for ( i = 0; i < 5; i++ ) {
+        PdLibPdParam_t  InvalidParam;
+        PdLibWindow_t   InvalidWindow;
+        unsigned long   LevelNum;
+
+        InvalidParam  = Param;
+        InvalidWindow = Window[0];
+        LevelNum      = 1;
+
+        if ( i == 0 ) {
+            LevelNum = 0;
+        } else if ( i == 1 ) {
+            LevelNum = D_PD_LIB_PD_LEVEL_NUM_MAX + 1;
+        } else if ( i == 2 ) {
+            InvalidParam.SearchRange = D_PD_LIB_PD_SEARCH_RANGE_MAX + 1;
+        } else if ( i == 3 ) {
+            InvalidParam.CostType = D_PD_LIB_PD_COST_SSD + 1;
+        } else {
+            InvalidWindow.XAddressOfWindowEnd = D_TEST_X_SIZE * D_TEST_PIXEL_PITCH;
+        }
+
+        ret = PdLibGetPhaseDiffPyramid ( pf_Executor, &Image, &InvalidParam, LevelNum, 1, &InvalidWindow, PhaseDiffData, Level );
+
+        (*pf_Result).CallNum++;
+
+        if ( ret != -EINVALPD ) {
+            test_fail ( pf_Result, "Invalid parameter is not -EINVALPD", InvalidParam.CostType, LevelNum, 0.0, i, ret, -EINVALPD );
+        }
+    }
+
+    return ;
+}
+
+/* Function for checking that ConfidenceLevel grows with contrast */
+static void test_check_contrast ( PdLibExecutor_t *pf_Executor, TestResult_t *pf_Result )
+{
+    PdLibPdImage_t          Image;
+    PdLibPdParam_t          Param;
+    PdLibWindow_t           Window;
+    PdLibPhaseDiffData_t    Low;
+    PdLibPhaseDiffData_t    High;
+    unsigned char           Level;
+    unsigned char           c;
+    unsigned long           l;
+
+    test_set_pd_image ( &Image );
+    test_set_pd_window ( 256, 512, &Window );
+
+    for ( c = D_PD_LIB_PD_COST_SAD; c <= D_PD_LIB_PD_COST_SSD; c++ ) {
+        test_set_param ( c, D_TEST_SEARCH_RANGE, &Param );
+
+        for ( l = 1; l <= D_PD_LIB_PD_LEVEL_NUM_MAX; l++ ) {
+            test_set_image ( 5.25, 0.5, 0 );
+            test_detect ( pf_Executor, &Image, &Param, 5.25, l, 1, &Window, &Low, &Level, pf_Result );
+
+            test_set_image ( 5.25, 2.0, 0 );
+            test_detect ( pf_Executor, &Image, &Param, 5.25, l, 1, &Window, &High, &Level, pf_Result );
+
+            (*pf_Result).CallNum++;
+
+            if ( Low.ConfidenceLevel == 0 || High.ConfidenceLevel <= Low.ConfidenceLevel ) {
+                test_fail ( pf_Result, "ConfidenceLevel does not grow with contrast", c, l, 5.25, 0,
+                            (signed long)High.ConfidenceLevel, (signed long)Low.ConfidenceLevel );
+            }
+        }
+    }
+
+    return ;
+}
+
+/* Function for counting and printing a failure */
+static void test_fail ( TestResult_t *pf_Result, const char *pf_Message, unsigned char f_CostType, unsigned long f_LevelNum, double f_Shift, unsigned long f_Window, signed long f_Value, signed long f_Expected )
+{
+    if ( (*pf_Result).FailNum < D_TEST_REPORT_NUM ) {
+        printf ( "%s : %s, %lu levels, shift %.3f, window %lu : %ld, expected %ld\n",
+                 pf_Message, ( f_CostType == D_PD_LIB_PD_COST_SSD ) ? "SSD" : "SAD", f_LevelNum, f_Shift, f_Window, f_Value, f_Expected );
+    }
+
+    (*pf_Result).FailNum++;
+
+    return ;
+}
+
+/* Function for getting absolute difference */
+static signed long test_deviation ( signed long f_Value, signed long f_Expected )
+{
+    return ( f_Value < f_Expected ) ? f_Expected - f_Value : f_Value - f_Expected;
+}
@@ -0,0 +1,505 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+    Comparison of PdLibGetDefocusRegisteredWindows() with PdLibGetDefocus().
+
+    The test is built with the sources of PDAF Library, for example
+
+        gcc -O2 -I../src PdafRegWindowTest.c ../src/PdafLibrary.c ../src/PdafMathFunc.c ../src/PdafThreadPool.c ../src/PdafStatistics.c ../src/PdafCalibImage.c ../src/PdafOtpDecoder.c ../src/PdafHotSwap.c ../src/PdafPhaseDetect.c ../src/PdafRoi.c ../src/PdafTracker.c ../src/PdafRecord.c ../src/PdafTrace.c -lpthread -o PdafRegWindowTest
+
+    Usage : PdafRegWindowTest
+
+    For random calibration data whose defocus at each knot is within the limit of signed 32 bit,
+    windows are registered with centers swept over the whole image, on each knot of slope and
+    offset and of DefocusOKNG and next to it, at the corners and edges of image, and over the
+    whole image. Each sensor mode of the context is evaluated with several PhaseDifference,
+    ConfidenceLevel and analog gains, and the test fails when Defocus deviates from PdLibGetDefocus()
+    by more than 1 DN in the corner areas or 3 DN in the other areas, which is the bound documented
+    in PdafLibrary.h for defocus at each knot within the limit of signed 32 bit. PhaseDifference of
+    defocus out of the limit at some knot is compared except Defocus. Other output data and return
+    values must be the same.
+*/
+
+/****************************************************************/
+/*                          include                             */
+/****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "PdafLibrary.h"
+#include "PdafTestCommon.h"
+
+/****************************************************************/
+/*                          define                              */
+/****************************************************************/
+
+#define D_TEST_CALIB_NUM            (12)            /* Number of random calibration data */
+#define D_TEST_X_SWEEP_NUM          (48)            /* Number of window centers swept over image */
+#define D_TEST_Y_SWEEP_NUM          (36)
+#define D_TEST_WINDOW_NUM           ( D_TEST_X_SWEEP_NUM * D_TEST_Y_SWEEP_NUM + 2 * 9 * D_TEST_MAX_KNOT_NUM * D_TEST_MAX_KNOT_NUM + 64 )
+#define D_TEST_GAIN_NUM             (2)             /* Number of analog gains of each sensor mode */
+#define D_TEST_PD_NUM               (8)             /* Number of PhaseDifference of each analog gain */
+#define D_TEST_CORNER_DEVIATION_MAX (1)             /* Maximum deviation of Defocus in the corner areas */
+#define D_TEST_DEVIATION_MAX        (3)             /* Maximum deviation of Defocus in the other areas */
+#define D_TEST_REPORT_NUM           (10)            /* Number of failures printed */
+
+/****************************************************************/
+/*                          structure                           */
+/****************************************************************/
+
+/* Result of comparison */
+typedef struct
+{
+    unsigned long           CallNum;                /* Number of compared output data */
+    unsigned long           FailNum;                /* Number of failures */
+    signed long             MaxDeviation[9];        /* Maximum deviation of Defocus of each area */
+    unsigned long           AreaNum[9];             /* Number of compared Defocus of each area */
+    unsigned long           OutOfLimitNum;          /* Number of output data of defocus out of limit at some knot */
+} TestResult_t;
+
+/****************************************************************/
+/*                 local function declaration                   */
+/****************************************************************/
+
+static void test_add_window ( TestCalib_t *pf_Calib, signed long f_XCenter, signed long f_YCenter, signed long f_Half, PdLibWindow_t *pf_Window, unsigned long *pf_WindowNum );
+static void test_add_knot_windows ( TestCalib_t *pf_Calib, unsigned short f_XKnotNum, unsigned short f_YKnotNum, unsigned short *pf_XKnot, unsigned short *pf_YKnot, PdLibWindow_t *pf_Window, unsigned long *pf_WindowNum );
+static unsigned long test_set_windows ( TestCalib_t *pf_Calib, PdLibWindow_t *pf_Window );
+static unsigned char test_area ( TestCalib_t *pf_Calib, PdLibWindow_t *pf_Window );
+static signed long test_rand_phase_difference ( unsigned long f_Index );
+static unsigned char test_is_in_limit ( TestCalib_t *pf_Calib, signed long f_AdjCoeffSlope, signed long f_PhaseDifference );
+static unsigned long test_rand_analog_gain ( TestCalib_t *pf_Calib );
+static void test_compare_calib ( TestCalib_t *pf_Calib, unsigned long f_CalibIndex, TestResult_t *pf_Result );
+static void test_check_output ( TestResult_t *pf_Result, unsigned long f_CalibIndex, unsigned long f_SensMode, unsigned char f_InLimit, unsigned char f_Area, PdLibWindow_t *pf_Window, PdLibPhaseDiffData_t *pf_PhaseDiffData, signed long f_Ret, signed long f_RetExpected, PdLibOutputData_t *pf_Output, PdLibOutputData_t *pf_Expected );
+static signed long test_deviation ( signed long f_Value, signed long f_Expected );
+
+/****************************************************************/
+/*                        global variable                       */
+/****************************************************************/
+
+/* Sensor profile with several DensityOfPhasePix and AdjCoeffSlope */
+static const PdLibSensorProfile_t s_Profile =
+{
+    D_PD_ERROR_VALUE,
+    { 2304, 1152, 576, 2304, 1152 },
+    { 2304, 1999, 3001, 4608, 577 }
+};
+
+/* Random size and knots. Knots of DefocusOKNG are disabled, 1 x 1 or of their own. Slope and offset */
+/* are within the range of the documented bound. */
+static const TestCalibKind_t s_CalibKind = { 0, 0, 0, D_TEST_OKNG_OWN_OR_NONE, 0, &s_Profile };
+
+static PdLibWindow_t        s_Window[D_TEST_WINDOW_NUM];
+static PdLibPhaseDiffData_t s_PhaseDiffData[D_TEST_WINDOW_NUM];
+static PdLibOutputData_t    s_Output[D_TEST_WINDOW_NUM];
+static signed long          s_Result[D_TEST_WINDOW_NUM];
+static unsigned char        s_Area[D_TEST_WINDOW_NUM];
+
+/****************************************************************/
+/*                           main                               */
+/****************************************************************/
+
+int main ( void )
+{
+    TestResult_t    Result;
+    unsigned long   c;
+    unsigned long   a;
+
+    if ( PdLibSetSensorProfile ( &s_Profile ) != D_PD_LIB_E_OK ) {
+        fprintf ( stderr, "Cannot set sensor profile\n" );
+        return 1;
+    }
+
+    memset ( &Result, 0, sizeof(Result) );
+
+    for ( c = 0; c < D_TEST_CALIB_NUM; c++ ) {
+        TestCalib_t Calib;
+
+        test_create_calib ( &s_CalibKind, &Calib );
+        test_compare_calib ( &Calib, c, &Result );
+    }
+
+    for ( a = 0; a < 9; a++ ) {
+        printf ( "Area %lu : %9lu outputs, max deviation Defocus %ld DN\n", a, Result.AreaNum[a], Result.MaxDeviation[a] );
+    }
+    printf ( "%lu outputs, %lu of defocus out of limit at some knot, %lu failures\n", Result.CallNum, Result.OutOfLimitNum, Result.FailNum );
+
+    printf ( "%s\n", ( Result.FailNum == 0 ) ? "PASS" : "FAIL" );
+
+    return ( Result.FailNum == 0 ) ? 0 : 1;
+}
+
+/****************************************************************/
+/*                       local function                         */
+/****************************************************************/
+
+/* Function for adding a window whose center is at the address, or next to it at the last pixel of image */
+static void test_add_window ( TestCalib_t *pf_Calib, signed long f_XCenter, signed long f_YCenter, signed long f_Half, PdLibWindow_t *pf_Window, unsigned long *pf_WindowNum )
+{
+    signed long Size[2];
+    signed long Center[2];
+    signed long Start[2];
+    signed long End[2];
+    unsigned long d;
+
+    Size[0]   = (*pf_Calib).CalibData.XSizeOfImage;
+    Size[1]   = (*pf_Calib).CalibData.YSizeOfImage;
+    Center[0] = f_XCenter;
+    Center[1] = f_YCenter;
+
+    for ( d = 0; d < 2; d++ ) {
+        signed long Half;
+
+        Center[d] = ( Center[d] < 0 ) ? 0 : ( Size[d] - 1 < Center[d] ) ? Size[d] - 1 : Center[d];
+
+        Half = f_Half;
+        Half = ( Center[d] < Half ) ? Center[d] : Half;
+        Half = ( Size[d] - 1 - Center[d] < Half ) ? Size[d] - 1 - Center[d] : Half;
+
+        if ( Half != 0 ) {
+            Start[d] = Center[d] - Half;
+            End[d]   = Center[d] + Half;
+        } else if ( Center[d] == 0 ) {                      /* Center at the first pixel */
+            Start[d] = 0;
+            End[d]   = 1;
+        } else {                                            /* Center next to the last pixel */
+            Start[d] = Center[d] - 1;
+            End[d]   = Center[d];
+        }
+    }
+
+    pf_Window[*pf_WindowNum].XAddressOfWindowStart = (unsigned short)Start[0];
+    pf_Window[*pf_WindowNum].YAddressOfWindowStart = (unsigned short)Start[1];
+    pf_Window[*pf_WindowNum].XAddressOfWindowEnd   = (unsigned short)End[0];
+    pf_Window[*pf_WindowNum].YAddressOfWindowEnd   = (unsigned short)End[1];
+
+    (*pf_WindowNum)++;
+
+    return ;
+}
+
+/* Function for adding windows whose centers are on each knot and next to it */
+static void test_add_knot_windows ( TestCalib_t *pf_Calib, unsigned short f_XKnotNum, unsigned short f_YKnotNum, unsigned short *pf_XKnot, unsigned short *pf_YKnot, PdLibWindow_t *pf_Window, unsigned long *pf_WindowNum )
+{
+    unsigned long x;
+    unsigned long y;
+    signed long dx;
+    signed long dy;
+
+    for ( y = 0; y < f_YKnotNum; y++ ) {
+        for ( x = 0; x < f_XKnotNum; x++ ) {
+            for ( dy = -1; dy <= 1; dy++ ) {
+                for ( dx = -1; dx <= 1; dx++ ) {
+                    test_add_window ( pf_Calib, (signed long)pf_XKnot[x] + dx, (signed long)pf_YKnot[y] + dy, test_rand_range ( 0, 32 ),
+                                      pf_Window, pf_WindowNum );
+                }
+            }
+        }
+    }
+
+    return ;
+}
+
+/* Function for setting windows over the whole image, on knots, at corners and edges. Number of windows is returned. */
+static unsigned long test_set_windows ( TestCalib_t *pf_Calib, PdLibWindow_t *pf_Window )
+{
+    PdLibCalibData_t *p_CalibData;
+    signed long XSize;
+    signed long YSize;
+    unsigned long WindowNum;
+    unsigned long x;
+    unsigned long y;
+    unsigned long i;
+
+    p_CalibData = &((*pf_Calib).CalibData);
+    XSize       = (*p_CalibData).XSizeOfImage;
+    YSize       = (*p_CalibData).YSizeOfImage;
+    WindowNum   = 0;
+
+    /* Centers swept over the whole image including its first and last pixels */
+    for ( y = 0; y < D_TEST_Y_SWEEP_NUM; y++ ) {
+        for ( x = 0; x < D_TEST_X_SWEEP_NUM; x++ ) {
+            test_add_window ( pf_Calib, (signed long)( x * (unsigned long)( XSize - 1 ) / ( D_TEST_X_SWEEP_NUM - 1 ) ),
+                              (signed long)( y * (unsigned long)( YSize - 1 ) / ( D_TEST_Y_SWEEP_NUM - 1 ) ), test_rand_range ( 0, 64 ),
+                              pf_Window, &WindowNum );
+        }
+    }
+
+    /* Centers on knots and next to them */
+    test_add_knot_windows ( pf_Calib, (*p_CalibData).XKnotNumSlopeOffset, (*p_CalibData).YKnotNumSlopeOffset,
+                            (*pf_Calib).XAddressKnot, (*pf_Calib).YAddressKnot, pf_Window, &WindowNum );
+
+    if ( 2 <= (*p_CalibData).XKnotNumDefocusOKNG ) {
+        test_add_knot_windows ( pf_Calib, (*p_CalibData).XKnotNumDefocusOKNG, (*p_CalibData).YKnotNumDefocusOKNG,
+                                (*pf_Calib).XAddressKnotOkNg, (*pf_Calib).YAddressKnotOkNg, pf_Window, &WindowNum );
+    }
+
+    /* Corners and edges of image with several sizes, and the whole image */
+    for ( i = 0; i < 4; i++ ) {
+        signed long Half;
+
+        Half = ( i == 0 ) ? 0 : test_rand_range ( 1, 256 );
+
+        test_add_window ( pf_Calib, 0,         0,         Half, pf_Window, &WindowNum );
+        test_add_window ( pf_Calib, XSize - 1, 0,         Half, pf_Window, &WindowNum );
+        test_add_window ( pf_Calib, 0,         YSize - 1, Half, pf_Window, &WindowNum );
+        test_add_window ( pf_Calib, XSize - 1, YSize - 1, Half, pf_Window, &WindowNum );
+        test_add_window ( pf_Calib, test_rand_range ( 0, XSize - 1 ), 0,         Half, pf_Window, &WindowNum );
+        test_add_window ( pf_Calib, test_rand_range ( 0, XSize - 1 ), YSize - 1, Half, pf_Window, &WindowNum );
+        test_add_window ( pf_Calib, 0,         test_rand_range ( 0, YSize - 1 ), Half, pf_Window, &WindowNum );
+        test_add_window ( pf_Calib, XSize - 1, test_rand_range ( 0, YSize - 1 ), Half, pf_Window, &WindowNum );
+    }
+
+    pf_Window[WindowNum].XAddressOfWindowStart = 0;
+    pf_Window[WindowNum].YAddressOfWindowStart = 0;
+    pf_Window[WindowNum].XAddressOfWindowEnd   = (unsigned short)( XSize - 1 );
+    pf_Window[WindowNum].YAddressOfWindowEnd   = (unsigned short)( YSize - 1 );
+    WindowNum++;
+
+    return WindowNum;
+}
+
+/* Function for getting area of window center in the same way as PDAF Library */
+static unsigned char test_area ( TestCalib_t *pf_Calib, PdLibWindow_t *pf_Window )
+{
+    signed long XCenter;
+    signed long YCenter;
+    unsigned char XSide;
+    unsigned char YSide;
+    unsigned short XKnotNum;
+    unsigned short YKnotNum;
+
+    XKnotNum = (*pf_Calib).CalibData.XKnotNumSlopeOffset;
+    YKnotNum = (*pf_Calib).CalibData.YKnotNumSlopeOffset;
+
+    XCenter = ( (*pf_Window).XAddressOfWindowStart + (*pf_Window).XAddressOfWindowEnd ) / 2;
+    YCenter = ( (*pf_Window).YAddressOfWindowStart + (*pf_Window).YAddressOfWindowEnd ) / 2;
+
+    XSide = ( XCenter < (*pf_Calib).XAddressKnot[0] ) ? 0 : ( (*pf_Calib).XAddressKnot[XKnotNum-1] < XCenter ) ? 2 : 1;
+    YSide = ( YCenter < (*pf_Calib).YAddressKnot[0] ) ? 0 : ( (*pf_Calib).YAddressKnot[YKnotNum-1] < YCenter ) ? 2 : 1;
+
+    return (unsigned char)( XSide + YSide * 3 );
+}
+
+/* Function for generating PhaseDifference, with the limits, the error value and around 0 */
+static signed long test_rand_phase_difference ( unsigned long f_Index )
+{
+    switch ( f_Index ) {
+    case 0 :
+        return ( test_rand () % 2 == 0 ) ? -32768 : 32767;
+    case 1 :
+        return D_PD_ERROR_VALUE * 16;
+    case 2 :
+        return test_rand_range ( -1, 1 );
+    case 3 :
+        return test_rand_range ( -32768, 32767 );
+    default :
+        return test_rand_range ( -2048, 2047 );
+    }
+}
+
+/* Function for checking that defocus at each knot is within the limit of signed 32 bit */
+static unsigned char test_is_in_limit ( TestCalib_t *pf_Calib, signed long f_AdjCoeffSlope, signed long f_PhaseDifference )
+{
+    unsigned long KnotNum;
+    unsigned long i;
+
+    KnotNum = (unsigned long)(*pf_Calib).CalibData.XKnotNumSlopeOffset * (*pf_Calib).CalibData.YKnotNumSlopeOffset;
+
+    for ( i = 0; i < KnotNum; i++ ) {
+        double Defocus;
+
+        Defocus = (double)f_AdjCoeffSlope * (double)(*pf_Calib).SlopeData[i] * (double)f_PhaseDifference / 2304.0
+                + (double)(*pf_Calib).OffsetData[i];
+
+        if ( Defocus <= -2147483647.0 || 2147483646.0 <= Defocus ) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/* Function for generating analog gain on and around threshold lines */
+static unsigned long test_rand_analog_gain ( TestCalib_t *pf_Calib )
+{
+    unsigned long Max;
+
+    Max = (*pf_Calib).MaxAnalogGain;
+    Max = ( Max < 0x7FFFFFFFUL - Max / 8 ) ? Max + Max / 8 : 0x7FFFFFFFUL;
+
+    return test_rand () % ( Max + 1 );
+}
+
+/* Function for comparing registered windows with PdLibGetDefocus() in each sensor mode */
+static void test_compare_calib ( TestCalib_t *pf_Calib, unsigned long f_CalibIndex, TestResult_t *pf_Result )
+{
+    PdLibContext_t  *p_Context;
+    unsigned long   WindowNum;
+    unsigned long   m;
+    unsigned long   g;
+    unsigned long   p;
+    unsigned long   i;
+    signed long     ret;
+
+    WindowNum = test_set_windows ( pf_Calib, s_Window );
+
+    for ( i = 0; i < WindowNum; i++ ) {
+        s_Area[i] = test_area ( pf_Calib, &(s_Window[i]) );
+    }
+
+    p_Context = NULL;
+
+    ret = PdLibCreateContext ( &((*pf_Calib).CalibData), &p_Context );
+
+    if ( ret == D_PD_LIB_E_OK ) {
+        ret = PdLibValidateContext ( p_Context );
+    }
+    if ( ret == D_PD_LIB_E_OK ) {
+        ret = PdLibRegisterWindows ( p_Context, WindowNum, s_Window );
+    }
+
+    if ( ret != D_PD_LIB_E_OK ) {
+        printf ( "Calibration %lu : context is not ready, %ld\n", f_CalibIndex, ret );
+        (*pf_Result).FailNum++;
+    } else {
+        for ( m = 0; m < D_PD_LIB_SENS_MODE_NUM; m++ ) {
+            ret = PdLibSetContextSensorMode ( p_Context, m );
+
+            if ( ret != D_PD_LIB_E_OK ) {
+                printf ( "Calibration %lu : sensor mode %lu is not ready, %ld\n", f_CalibIndex, m, ret );
+                (*pf_Result).FailNum++;
+                continue ;
+            }
+
+            for ( g = 0; g < D_TEST_GAIN_NUM; g++ ) {
+                unsigned long AnalogGain;
+
+                AnalogGain = test_rand_analog_gain ( pf_Calib );
+
+                for ( p = 0; p < D_TEST_PD_NUM; p++ ) {
+                    signed long PhaseDifference;
+                    unsigned char InLimit;
+
+                    PhaseDifference = test_rand_phase_difference ( p );
+                    InLimit         = test_is_in_limit ( pf_Calib, s_Profile.AdjCoeffSlope[m], PhaseDifference );
+
+                    for ( i = 0; i < WindowNum; i++ ) {
+                        s_PhaseDiffData[i].PhaseDifference = PhaseDifference;
+                        s_PhaseDiffData[i].ConfidenceLevel = ( test_rand () % 16 == 0 ) ? test_rand () : test_rand () % 8192;
+                    }
+
+                    ret = PdLibGetDefocusRegisteredWindows ( p_Context, AnalogGain, s_PhaseDiffData, s_Output, s_Result );
+
+                    if ( ret != D_PD_LIB_E_OK ) {
+                        printf ( "Calibration %lu : PdLibGetDefocusRegisteredWindows returns %ld\n", f_CalibIndex, ret );
+                        (*pf_Result).FailNum++;
+                        continue ;
+                    }
+
+                    for ( i = 0; i < WindowNum; i++ ) {
+                        PdLibInputData_t InputData;
+                        PdLibOutputData_t Expected;
+                        signed long RetExpected;
+
+                        test_set_input ( pf_Calib, &(s_Window[i]), s_PhaseDiffData[i].PhaseDifference, s_PhaseDiffData[i].ConfidenceLevel,
+                                         AnalogGain, &InputData );
+                        InputData.AdjCoeffSlope     = s_Profile.AdjCoeffSlope[m];
+                        InputData.DensityOfPhasePix = s_Profile.DensityOfPhasePix[m];
+
+                        RetExpected = PdLibGetDefocus ( &InputData, &Expected );
+
+                        test_check_output ( pf_Result, f_CalibIndex, m, InLimit, s_Area[i], &(s_Window[i]), &(s_PhaseDiffData[i]),
+                                            s_Result[i], RetExpected, &(s_Output[i]), &Expected );
+                    }
+                }
+            }
+        }
+    }
+
+    if ( p_Context != NULL ) {
+        PdLibDestroyContext ( p_Context );
+    }
+
+    return ;
+}
+
+/* Function for checking output data of a registered window with PdLibGetDefocus() */
+static void test_check_output ( TestResult_t *pf_Result, unsigned long f_CalibIndex, unsigned long f_SensMode, unsigned char f_InLimit, unsigned char f_Area, PdLibWindow_t *pf_Window, PdLibPhaseDiffData_t *pf_PhaseDiffData, signed long f_Ret, signed long f_RetExpected, PdLibOutputData_t *pf_Output, PdLibOutputData_t *pf_Expected )
+{
+    signed long Deviation;
+    signed long DeviationMax;
+
+    Deviation    = test_deviation ( (*pf_Output).Defocus, (*pf_Expected).Defocus );
+    DeviationMax = ( f_Area == 0 || f_Area == 2 || f_Area == 6 || f_Area == 8 ) ? D_TEST_CORNER_DEVIATION_MAX : D_TEST_DEVIATION_MAX;
+
+    (*pf_Result).CallNum++;
+
+    if ( f_InLimit == 0 ) {                                 /* Defocus is not bounded */
+        Deviation = 0;
+        (*pf_Result).OutOfLimitNum++;
+    } else {
+        (*pf_Result).AreaNum[f_Area]++;
+
+        if ( (*pf_Result).MaxDeviation[f_Area] < Deviation ) {
+            (*pf_Result).MaxDeviation[f_Area] = Deviation;
+        }
+    }
+
+    if ( f_Ret != f_RetExpected || DeviationMax < Deviation ||
+         (*pf_Output).DefocusConfidence      != (*pf_Expected).DefocusConfidence ||
+         (*pf_Output).DefocusConfidenceLevel != (*pf_Expected).DefocusConfidenceLevel ||
+         (*pf_Output).PhaseDifference        != (*pf_Expected).PhaseDifference ) {
+        if ( (*pf_Result).FailNum < D_TEST_REPORT_NUM ) {
+            printf ( "Calibration %lu, sensor mode %lu, area %u, window ( %u, %u, %u, %u ), PhaseDifference %ld, ConfidenceLevel %lu : "
+                     "registered ( %ld, %ld, %d, %lu, %ld ), PdLibGetDefocus ( %ld, %ld, %d, %lu, %ld )\n",
+                     f_CalibIndex, f_SensMode, f_Area,
+                     (*pf_Window).XAddressOfWindowStart, (*pf_Window).YAddressOfWindowStart,
+                     (*pf_Window).XAddressOfWindowEnd, (*pf_Window).YAddressOfWindowEnd,
+                     (*pf_PhaseDiffData).PhaseDifference, (*pf_PhaseDiffData).ConfidenceLevel,
+                     f_Ret, (*pf_Output).Defocus, (*pf_Output).DefocusConfidence, (*pf_Output).DefocusConfidenceLevel, (*pf_Output).PhaseDifference,
+                     f_RetExpected, (*pf_Expected).Defocus, (*pf_Expected).DefocusConfidence, (*pf_Expected).DefocusConfidenceLevel, (*pf_Expected).PhaseDifference );
+        }
+        (*pf_Result).FailNum++;
+    }
+
+    return ;
+}
+
+/* Function for absolute deviation, saturated at the limit of signed 32 bit */
+static signed long test_deviation ( signed long f_Value, signed long f_Expected )
+{
+    double Deviation;
+
+    Deviation = (double)f_Value - (double)f_Expected;
+    Deviation = ( Deviation < 0.0 ) ? -Deviation : Deviation;
+
+    return ( 2147483647.0 <= Deviation ) ? 2147483647L : (signed long)Deviation;
+}
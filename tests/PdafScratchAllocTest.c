@@ -0,0 +1,470 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/*
+    Test of caller-owned scratch buffers of PDAF Library without heap allocation.
+
+    Allocation functions are interposed by the linker, for example
+
+        gcc -O2 -I../src PdafScratchAllocTest.c ../src/PdafLibrary.c ../src/PdafMathFunc.c ../src/PdafThreadPool.c ../src/PdafStatistics.c ../src/PdafCalibImage.c ../src/PdafOtpDecoder.c ../src/PdafHotSwap.c ../src/PdafPhaseDetect.c ../src/PdafRoi.c ../src/PdafTracker.c ../src/PdafRecord.c ../src/PdafTrace.c -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free -lpthread -o PdafScratchAllocTest
+
+    and with statistics, whose counters of the calling thread and worker threads of the executor are
+    allocated by PdLibCreateExecutor()
+
+        gcc -O2 -DD_PD_LIB_STATS=1 -I../src PdafScratchAllocTest.c ../src/PdafLibrary.c ../src/PdafMathFunc.c ../src/PdafThreadPool.c ../src/PdafStatistics.c ../src/PdafCalibImage.c ../src/PdafOtpDecoder.c ../src/PdafHotSwap.c ../src/PdafPhaseDetect.c ../src/PdafRoi.c ../src/PdafTracker.c ../src/PdafRecord.c ../src/PdafTrace.c -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free -lpthread -o PdafScratchAllocTestStats
+
+    Usage : PdafScratchAllocTest, PdafScratchAllocTestStats
+
+    For random calibration data, a context is created by PdLibCreateContextWithScratch(), and
+    the test fails if malloc(), calloc(), realloc() or free() is called by validation, registration
+    of windows and defocus map, evaluation of registered windows, batch, parallel batch and defocus
+    map, aggregation of ROIs, dump of trace, or destruction of the context. Registration beyond the
+    buffer must return -EINVALSCRATCH. A context of heap gives the reference output data, and is
+    then given a scratch buffer by PdLibSetContextScratch(), after which registration and evaluation
+    must not allocate either. Calibration data without knots of DefocusOKNG must be rejected by
+    creation of context when its threshold lines are NULL.
+*/
+
+/****************************************************************/
+/*                          include                             */
+/****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "PdafLibrary.h"
+
+/****************************************************************/
+/*                          define                              */
+/****************************************************************/
+
+#define D_TEST_ITERATION_NUM        (64)            /* Number of random calibration data */
+#define D_TEST_MAX_KNOT_NUM         (12)            /* Maximum number of knots in each direction */
+#define D_TEST_MAX_WINDOW_NUM       (32)            /* Maximum number of registered windows */
+#define D_TEST_MAX_X_CELL_NUM       (16)            /* Maximum number of cells of defocus map */
+#define D_TEST_MAX_Y_CELL_NUM       (12)
+#define D_TEST_THREAD_NUM           (4)             /* Number of threads of executor */
+#define D_TEST_SCRATCH_SIZE         (1 << 20)       /* Size of scratch buffer */
+#define D_TEST_TRACE_NUM            (16)            /* Number of records of trace dumped */
+
+#include "PdafTestCommon.h"
+
+/****************************************************************/
+/*                          structure                           */
+/****************************************************************/
+
+/* Output data of windows and defocus map */
+typedef struct
+{
+    PdLibOutputData_t       RegWindow[D_TEST_MAX_WINDOW_NUM];
+    signed long             RegWindowResult[D_TEST_MAX_WINDOW_NUM];
+    PdLibOutputData_t       Batch[D_TEST_MAX_WINDOW_NUM];
+    signed long             BatchResult[D_TEST_MAX_WINDOW_NUM];
+    signed long             DefocusMap[D_TEST_MAX_X_CELL_NUM * D_TEST_MAX_Y_CELL_NUM];
+    unsigned long           ConfidenceLevelMap[D_TEST_MAX_X_CELL_NUM * D_TEST_MAX_Y_CELL_NUM];
+} TestOutput_t;
+
+/****************************************************************/
+/*                 local function declaration                   */
+/****************************************************************/
+
+extern void *__real_malloc ( size_t f_Size );
+extern void *__real_calloc ( size_t f_Num, size_t f_Size );
+extern void *__real_realloc ( void *pf_Ptr, size_t f_Size );
+extern void __real_free ( void *pf_Ptr );
+extern void *__wrap_malloc ( size_t f_Size );
+extern void *__wrap_calloc ( size_t f_Num, size_t f_Size );
+extern void *__wrap_realloc ( void *pf_Ptr, size_t f_Size );
+extern void __wrap_free ( void *pf_Ptr );
+
+static void test_set_phase_diff ( PdLibPhaseDiffData_t *pf_PhaseDiffData );
+static void test_arm ( void );
+static void test_check_alloc ( const char *pf_Step, unsigned long f_Iteration, unsigned long *pf_FailNum );
+static void test_check_ret ( const char *pf_Step, unsigned long f_Iteration, signed long f_Ret, signed long f_Expected, unsigned long *pf_FailNum );
+static void test_check_windows ( const char *pf_Step, unsigned long f_Iteration, unsigned long f_WindowNum, PdLibOutputData_t *pf_Output, signed long *pf_Result, PdLibOutputData_t *pf_Expected, signed long *pf_ExpectedResult, unsigned long *pf_FailNum );
+static void test_check_map ( const char *pf_Step, unsigned long f_Iteration, unsigned long f_CellNum, TestOutput_t *pf_Output, TestOutput_t *pf_Expected, unsigned long *pf_FailNum );
+
+/****************************************************************/
+/*                        global variable                       */
+/****************************************************************/
+
+/* Random size and knots. Knots of DefocusOKNG are disabled, 1 x 1 or the same as knots of slope and offset. */
+static const TestCalibKind_t s_CalibKind = { 0, 0, 0, D_TEST_OKNG_SAME_OR_NONE, 0, NULL };
+
+static volatile unsigned char s_Armed;              /* 1 : allocation is counted */
+static volatile unsigned long s_AllocNum;           /* Number of calls of allocation functions while armed */
+
+static unsigned char s_Scratch[D_TEST_SCRATCH_SIZE];
+
+/****************************************************************/
+/*                           main                               */
+/****************************************************************/
+
+int main ( void )
+{
+    PdLibExecutor_t *p_Executor;
+    unsigned long   FailNum;
+    unsigned long   it;
+
+    FailNum = 0;
+
+    if ( PdLibCreateExecutor ( D_TEST_THREAD_NUM, NULL, &p_Executor ) != D_PD_LIB_E_OK ) {
+        fprintf ( stderr, "Cannot create executor\n" );
+        return 1;
+    }
+
+    for ( it = 0; it < D_TEST_ITERATION_NUM; it++ ) {
+        TestCalib_t             Calib;
+        PdLibContext_t          *p_HeapContext;
+        PdLibContext_t          *p_ScratchContext;
+        PdLibWindow_t           Window[D_TEST_MAX_WINDOW_NUM];
+        PdLibPhaseDiffData_t    PhaseDiffData[D_TEST_MAX_WINDOW_NUM];
+        PdLibPhaseDiffData_t    Sample[D_TEST_MAX_X_CELL_NUM * D_TEST_MAX_Y_CELL_NUM];
+        TestOutput_t            Expected;
+        TestOutput_t            Output;
+        PdLibRoi_t              Roi;
+        PdLibRoiData_t          RoiData;
+        PdLibTraceRecord_t      TraceRecord[D_TEST_TRACE_NUM];
+        unsigned short          RoiIndex[D_TEST_MAX_WINDOW_NUM];
+        unsigned long           DumpNum;
+        unsigned long           WindowNum;
+        unsigned long           XCellNum;
+        unsigned long           YCellNum;
+        unsigned long           ScratchSize;
+        unsigned long           AnalogGain;
+        unsigned char           *p_Scratch;
+        signed long             RetValidate;
+        unsigned long           i;
+
+        test_create_calib ( &s_CalibKind, &Calib );
+
+        WindowNum  = 1 + test_rand () % D_TEST_MAX_WINDOW_NUM;
+        XCellNum   = 1 + test_rand () % D_TEST_MAX_X_CELL_NUM;
+        YCellNum   = 1 + test_rand () % D_TEST_MAX_Y_CELL_NUM;
+        AnalogGain = test_rand () % ( D_TEST_POINT_NUM * D_TEST_POINT_PITCH );
+        p_Scratch  = &(s_Scratch[it % 8]);                 /* Buffer is aligned inside */
+
+        for ( i = 0; i < WindowNum; i++ ) {
+            test_set_window ( Calib.CalibData.XSizeOfImage, Calib.CalibData.YSizeOfImage, 256, &(Window[i]) );
+            test_set_phase_diff ( &(PhaseDiffData[i]) );
+            RoiIndex[i] = (unsigned short)i;
+        }
+        for ( i = 0; i < XCellNum * YCellNum; i++ ) {
+            test_set_phase_diff ( &(Sample[i]) );
+        }
+
+        Roi.p_WindowIndex = RoiIndex;
+        Roi.WindowNum     = (unsigned short)WindowNum;
+
+        /* NULL threshold lines are rejected before copy even if confidence is not judged */
+        if ( Calib.CalibData.XKnotNumDefocusOKNG == 0 ) {
+            PdLibCalibData_t NullLineCalibData;
+
+            NullLineCalibData = Calib.CalibData;
+            NullLineCalibData.p_DefocusOKNGThrLine = NULL;
+
+            test_check_ret ( "PdLibCreateContext with NULL threshold lines", it,
+                             PdLibCreateContext ( &NullLineCalibData, &p_HeapContext ), -EINDONTPN, &FailNum );
+            test_check_ret ( "PdLibQueryScratchSize with NULL threshold lines", it,
+                             PdLibQueryScratchSize ( &NullLineCalibData, WindowNum, XCellNum, YCellNum, &ScratchSize ), -EINDONTPN, &FailNum );
+            test_check_ret ( "PdLibCreateContextWithScratch with NULL threshold lines", it,
+                             PdLibCreateContextWithScratch ( &NullLineCalibData, WindowNum, XCellNum, YCellNum, p_Scratch, D_TEST_SCRATCH_SIZE - 8,
+                                                             &p_ScratchContext ), -EINDONTPN, &FailNum );
+        }
+
+        /* Reference output data of context of heap */
+        if ( PdLibCreateContext ( &(Calib.CalibData), &p_HeapContext ) != D_PD_LIB_E_OK ) {
+            printf ( "Iteration %lu : PdLibCreateContext fails\n", it );
+            FailNum++;
+            continue ;
+        }
+
+        RetValidate = PdLibValidateContext ( p_HeapContext );
+
+        if ( RetValidate != D_PD_LIB_E_OK ||
+             PdLibRegisterWindows ( p_HeapContext, WindowNum, Window ) != D_PD_LIB_E_OK ||
+             PdLibRegisterDefocusMap ( p_HeapContext, XCellNum, YCellNum, XCellNum, YCellNum ) != D_PD_LIB_E_OK ) {
+            printf ( "Iteration %lu : registration of context of heap fails\n", it );
+            PdLibDestroyContext ( p_HeapContext );
+            FailNum++;
+            continue ;
+        }
+
+        PdLibGetDefocusRegisteredWindows ( p_HeapContext, AnalogGain, PhaseDiffData, Expected.RegWindow, Expected.RegWindowResult );
+        PdLibGetDefocusBatchWithContext ( p_HeapContext, AnalogGain, WindowNum, Window, PhaseDiffData, Expected.Batch, Expected.BatchResult );
+        PdLibGetDefocusMap ( NULL, p_HeapContext, AnalogGain, Sample, Expected.DefocusMap, Expected.ConfidenceLevelMap );
+
+        /* Context in scratch buffer */
+        if ( PdLibQueryScratchSize ( &(Calib.CalibData), WindowNum, XCellNum, YCellNum, &ScratchSize ) != D_PD_LIB_E_OK ||
+             D_TEST_SCRATCH_SIZE - 8 < ScratchSize ) {
+            printf ( "Iteration %lu : PdLibQueryScratchSize fails\n", it );
+            PdLibDestroyContext ( p_HeapContext );
+            FailNum++;
+            continue ;
+        }
+
+        test_check_ret ( "PdLibCreateContextWithScratch with small buffer", it,
+                         PdLibCreateContextWithScratch ( &(Calib.CalibData), WindowNum, XCellNum, YCellNum, p_Scratch, ScratchSize - 1, &p_ScratchContext ),
+                         -EINVALSCRATCH, &FailNum );
+
+        if ( PdLibCreateContextWithScratch ( &(Calib.CalibData), WindowNum, XCellNum, YCellNum, p_Scratch, ScratchSize, &p_ScratchContext ) != D_PD_LIB_E_OK ) {
+            printf ( "Iteration %lu : PdLibCreateContextWithScratch fails\n", it );
+            PdLibDestroyContext ( p_HeapContext );
+            FailNum++;
+            continue ;
+        }
+
+        test_arm ();
+
+        test_check_ret ( "PdLibValidateContext", it, PdLibValidateContext ( p_ScratchContext ), RetValidate, &FailNum );
+        test_check_alloc ( "PdLibValidateContext", it, &FailNum );
+
+        test_check_ret ( "PdLibRegisterWindows", it, PdLibRegisterWindows ( p_ScratchContext, WindowNum, Window ), D_PD_LIB_E_OK, &FailNum );
+        test_check_ret ( "PdLibRegisterWindows beyond buffer", it,
+                         PdLibRegisterWindows ( p_ScratchContext, WindowNum + 64, Window ), -EINVALSCRATCH, &FailNum );
+        test_check_ret ( "PdLibRegisterWindows again", it, PdLibRegisterWindows ( p_ScratchContext, WindowNum, Window ), D_PD_LIB_E_OK, &FailNum );
+        test_check_alloc ( "PdLibRegisterWindows", it, &FailNum );
+
+        test_check_ret ( "PdLibRegisterDefocusMap beyond buffer", it,
+                         PdLibRegisterDefocusMap ( p_ScratchContext, XCellNum + 1, YCellNum, XCellNum, YCellNum ), -EINVALSCRATCH, &FailNum );
+        test_check_ret ( "PdLibRegisterDefocusMap", it,
+                         PdLibRegisterDefocusMap ( p_ScratchContext, XCellNum, YCellNum, XCellNum, YCellNum ), D_PD_LIB_E_OK, &FailNum );
+        test_check_alloc ( "PdLibRegisterDefocusMap", it, &FailNum );
+
+        PdLibGetDefocusRegisteredWindows ( p_ScratchContext, AnalogGain, PhaseDiffData, Output.RegWindow, Output.RegWindowResult );
+        test_check_alloc ( "PdLibGetDefocusRegisteredWindows", it, &FailNum );
+        test_check_windows ( "PdLibGetDefocusRegisteredWindows", it, WindowNum, Output.RegWindow, Output.RegWindowResult,
+                             Expected.RegWindow, Expected.RegWindowResult, &FailNum );
+
+        PdLibGetDefocusBatchWithContext ( p_ScratchContext, AnalogGain, WindowNum, Window, PhaseDiffData, Output.Batch, Output.BatchResult );
+        test_check_alloc ( "PdLibGetDefocusBatchWithContext", it, &FailNum );
+        test_check_windows ( "PdLibGetDefocusBatchWithContext", it, WindowNum, Output.Batch, Output.BatchResult,
+                             Expected.Batch, Expected.BatchResult, &FailNum );
+
+        PdLibGetDefocusBatchParallel ( p_Executor, p_ScratchContext, AnalogGain, WindowNum, Window, PhaseDiffData, Output.Batch, Output.BatchResult );
+        test_check_alloc ( "PdLibGetDefocusBatchParallel", it, &FailNum );
+        test_check_windows ( "PdLibGetDefocusBatchParallel", it, WindowNum, Output.Batch, Output.BatchResult,
+                             Expected.Batch, Expected.BatchResult, &FailNum );
+
+        PdLibGetDefocusMap ( p_Executor, p_ScratchContext, AnalogGain, Sample, Output.DefocusMap, Output.ConfidenceLevelMap );
+        test_check_alloc ( "PdLibGetDefocusMap", it, &FailNum );
+        test_check_map ( "PdLibGetDefocusMap", it, XCellNum * YCellNum, &Output, &Expected, &FailNum );
+
+        PdLibGetDefocusMap ( NULL, p_ScratchContext, AnalogGain, Sample, Output.DefocusMap, Output.ConfidenceLevelMap );
+        test_check_alloc ( "PdLibGetDefocusMap without executor", it, &FailNum );
+        test_check_map ( "PdLibGetDefocusMap without executor", it, XCellNum * YCellNum, &Output, &Expected, &FailNum );
+
+        PdLibGetDefocusRoi ( WindowNum, Output.Batch, Output.BatchResult, 1, &Roi, &RoiData );
+        test_check_alloc ( "PdLibGetDefocusRoi", it, &FailNum );
+
+        PdLibDumpTrace ( p_ScratchContext, D_TEST_TRACE_NUM, TraceRecord, &DumpNum );
+        test_check_alloc ( "PdLibDumpTrace", it, &FailNum );
+
+        PdLibDestroyContext ( p_ScratchContext );
+        test_check_alloc ( "PdLibDestroyContext", it, &FailNum );
+
+        s_Armed = 0;
+
+        /* Scratch buffer of registration given to context of heap */
+        if ( PdLibQueryScratchSize ( NULL, WindowNum, XCellNum, YCellNum, &ScratchSize ) != D_PD_LIB_E_OK ||
+             PdLibSetContextScratch ( p_HeapContext, WindowNum, XCellNum, YCellNum, p_Scratch, ScratchSize ) != D_PD_LIB_E_OK ) {
+            printf ( "Iteration %lu : PdLibSetContextScratch fails\n", it );
+            PdLibDestroyContext ( p_HeapContext );
+            FailNum++;
+            continue ;
+        }
+
+        test_arm ();
+
+        test_check_ret ( "PdLibRegisterWindows with PdLibSetContextScratch", it,
+                         PdLibRegisterWindows ( p_HeapContext, WindowNum, Window ), D_PD_LIB_E_OK, &FailNum );
+        test_check_ret ( "PdLibRegisterDefocusMap with PdLibSetContextScratch", it,
+                         PdLibRegisterDefocusMap ( p_HeapContext, XCellNum, YCellNum, XCellNum, YCellNum ), D_PD_LIB_E_OK, &FailNum );
+        test_check_alloc ( "Registration with PdLibSetContextScratch", it, &FailNum );
+
+        PdLibGetDefocusRegisteredWindows ( p_HeapContext, AnalogGain, PhaseDiffData, Output.RegWindow, Output.RegWindowResult );
+        PdLibGetDefocusMap ( p_Executor, p_HeapContext, AnalogGain, Sample, Output.DefocusMap, Output.ConfidenceLevelMap );
+        test_check_alloc ( "Evaluation with PdLibSetContextScratch", it, &FailNum );
+        test_check_windows ( "PdLibGetDefocusRegisteredWindows with PdLibSetContextScratch", it, WindowNum, Output.RegWindow, Output.RegWindowResult,
+                             Expected.RegWindow, Expected.RegWindowResult, &FailNum );
+        test_check_map ( "PdLibGetDefocusMap with PdLibSetContextScratch", it, XCellNum * YCellNum, &Output, &Expected, &FailNum );
+
+        s_Armed = 0;
+
+        PdLibDestroyContext ( p_HeapContext );
+    }
+
+    PdLibDestroyExecutor ( p_Executor );
+
+    printf ( "%lu iterations, %lu failures\n%s\n", (unsigned long)D_TEST_ITERATION_NUM, FailNum, ( FailNum == 0 ) ? "PASS" : "FAIL" );
+
+    return ( FailNum == 0 ) ? 0 : 1;
+}
+
+/****************************************************************/
+/*                    interposed allocation                     */
+/****************************************************************/
+
+/* Allocation functions called by PDAF Library are counted while armed */
+void *__wrap_malloc ( size_t f_Size )
+{
+    if ( s_Armed != 0 ) {
+        s_AllocNum++;
+    }
+
+    return __real_malloc ( f_Size );
+}
+
+void *__wrap_calloc ( size_t f_Num, size_t f_Size )
+{
+    if ( s_Armed != 0 ) {
+        s_AllocNum++;
+    }
+
+    return __real_calloc ( f_Num, f_Size );
+}
+
+void *__wrap_realloc ( void *pf_Ptr, size_t f_Size )
+{
+    if ( s_Armed != 0 ) {
+        s_AllocNum++;
+    }
+
+    return __real_realloc ( pf_Ptr, f_Size );
+}
+
+void __wrap_free ( void *pf_Ptr )
+{
+    if ( s_Armed != 0 && pf_Ptr != NULL ) {
+        s_AllocNum++;
+    }
+
+    __real_free ( pf_Ptr );
+
+    return ;
+}
+
+/****************************************************************/
+/*                       local function                         */
+/****************************************************************/
+
+/* Function for setting random phase difference data of a PDAF window */
+static void test_set_phase_diff ( PdLibPhaseDiffData_t *pf_PhaseDiffData )
+{
+    (*pf_PhaseDiffData).PhaseDifference = ( test_rand () % 16 == 0 ) ? D_PD_ERROR_VALUE * 16 : (signed long)( test_rand () % 8192 ) - 4096;
+    (*pf_PhaseDiffData).ConfidenceLevel = test_rand () % 4096;
+
+    return ;
+}
+
+/* Function for starting to count allocation */
+static void test_arm ( void )
+{
+    s_AllocNum = 0;
+    s_Armed    = 1;
+
+    return ;
+}
+
+/* Function for checking allocation since last check. Result is printed after counting is stopped. */
+static void test_check_alloc ( const char *pf_Step, unsigned long f_Iteration, unsigned long *pf_FailNum )
+{
+    unsigned long AllocNum;
+
+    s_Armed  = 0;
+    AllocNum = s_AllocNum;
+
+    if ( AllocNum != 0 ) {
+        printf ( "Iteration %lu : %s calls allocation functions %lu times\n", f_Iteration, pf_Step, AllocNum );
+        (*pf_FailNum)++;
+    }
+
+    test_arm ();
+
+    return ;
+}
+
+/* Function for checking return value */
+static void test_check_ret ( const char *pf_Step, unsigned long f_Iteration, signed long f_Ret, signed long f_Expected, unsigned long *pf_FailNum )
+{
+    unsigned char Armed;
+
+    if ( f_Ret != f_Expected ) {
+        Armed   = s_Armed;
+        s_Armed = 0;
+        printf ( "Iteration %lu : %s returns %ld, expected %ld\n", f_Iteration, pf_Step, f_Ret, f_Expected );
+        (*pf_FailNum)++;
+        s_Armed = Armed;
+    }
+
+    return ;
+}
+
+/* Function for checking output data of windows with reference */
+static void test_check_windows ( const char *pf_Step, unsigned long f_Iteration, unsigned long f_WindowNum, PdLibOutputData_t *pf_Output, signed long *pf_Result, PdLibOutputData_t *pf_Expected, signed long *pf_ExpectedResult, unsigned long *pf_FailNum )
+{
+    unsigned long i;
+    unsigned char Armed;
+
+    for ( i = 0; i < f_WindowNum; i++ ) {
+        if ( pf_Result[i] != pf_ExpectedResult[i] || pf_Output[i].Defocus != pf_Expected[i].Defocus ||
+             pf_Output[i].DefocusConfidence != pf_Expected[i].DefocusConfidence ||
+             pf_Output[i].DefocusConfidenceLevel != pf_Expected[i].DefocusConfidenceLevel ||
+             pf_Output[i].PhaseDifference != pf_Expected[i].PhaseDifference ) {
+            Armed   = s_Armed;
+            s_Armed = 0;
+            printf ( "Iteration %lu : %s differs from context of heap at window %lu\n", f_Iteration, pf_Step, i );
+            (*pf_FailNum)++;
+            s_Armed = Armed;
+            break ;
+        }
+    }
+
+    return ;
+}
+
+/* Function for checking defocus map with reference */
+static void test_check_map ( const char *pf_Step, unsigned long f_Iteration, unsigned long f_CellNum, TestOutput_t *pf_Output, TestOutput_t *pf_Expected, unsigned long *pf_FailNum )
+{
+    unsigned long i;
+    unsigned char Armed;
+
+    for ( i = 0; i < f_CellNum; i++ ) {
+        if ( (*pf_Output).DefocusMap[i] != (*pf_Expected).DefocusMap[i] ||
+             (*pf_Output).ConfidenceLevelMap[i] != (*pf_Expected).ConfidenceLevelMap[i] ) {
+            Armed   = s_Armed;
+            s_Armed = 0;
+            printf ( "Iteration %lu : %s differs from context of heap at cell %lu\n", f_Iteration, pf_Step, i );
+            (*pf_FailNum)++;
+            s_Armed = Armed;
+            break ;
+        }
+    }
+
+    return ;
+}
@@ -0,0 +1,426 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/*
+    Comparison of vector and scalar functions of arrays of PdafMathFunc.c.
+
+    PdafMathFunc.c is included by the test to call the vector function of each instruction set,
+    for example
+
+        gcc -O2 -I../src PdafSimdTest.c -o PdafSimdTest
+
+    Usage : PdafSimdTest
+
+    Arrays of lines, planes, cells, a * x + b, quotients and costs of correlation are calculated
+    by the scalar functions and by SSE4.1, AVX2 (when the CPU supports them) or NEON functions,
+    and by the dispatching functions. The test fails when any element differs. Arrays contain
+    random values, equal knots, equal values, points out of lines to be clamped, values at the
+    limits of signed 32 bit, and values out of signed 32 bit where signed long is 64 bit, which
+    must be calculated by the scalar functions. Numbers of elements are not multiples of lanes.
+*/
+
+/****************************************************************/
+/*                          include                             */
+/****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "PdafLibrary.h"
+#include "PdafTestCommon.h"
+
+#include "PdafMathFunc.c"                           /* Local vector functions are called by the test */
+
+/****************************************************************/
+/*                          define                              */
+/****************************************************************/
+
+#define D_TEST_ELEMENT_NUM          (1027)          /* Number of elements of arrays */
+#define D_TEST_CORR_NUM             (61)            /* Number of elements of x of correlation */
+#define D_TEST_SHIFT_NUM            (45)            /* Maximum number of shifts of correlation */
+#define D_TEST_REPORT_NUM           (10)            /* Number of failures printed */
+
+/* Kind of values of arrays */
+#define D_TEST_DATA_RANDOM          (0)             /* Random values */
+#define D_TEST_DATA_EQUAL           (1)             /* Equal knots, equal values and points out of lines */
+#define D_TEST_DATA_LIMIT           (2)             /* Values at the limits of signed 32 bit */
+#define D_TEST_DATA_WIDE            (3)             /* Values out of signed 32 bit in some elements */
+#define D_TEST_DATA_NUM             (4)
+
+/****************************************************************/
+/*                          structure                           */
+/****************************************************************/
+
+/* Functions of arrays of an instruction set */
+typedef struct
+{
+    const char      *p_Name;
+    void            (*p_Line) ( unsigned long, signed long *, signed long *, signed long *, signed long *, signed long *, signed long * );
+    void            (*p_Plane) ( unsigned long, signed long *, signed long *, signed long *, signed long *, signed long *, signed long *, signed long *, signed long *, signed long *, signed long *, signed long * );
+    void            (*p_Linear) ( unsigned long, double *, double *, signed long *, signed long * );
+    void            (*p_Quotient) ( unsigned long, double *, double, signed long *, unsigned long * );
+    void            (*p_Correlation) ( unsigned long, signed long *, signed long *, unsigned long, unsigned char, unsigned long long * );
+    unsigned char   CorrelationGuard;               /* 1 : correlation of values out of signed 31 bit is given */
+} TestKernel_t;
+
+/* Input data of arrays */
+typedef struct
+{
+    signed long     x0[D_TEST_ELEMENT_NUM];
+    signed long     x1[D_TEST_ELEMENT_NUM];
+    signed long     y0[D_TEST_ELEMENT_NUM];
+    signed long     y1[D_TEST_ELEMENT_NUM];
+    signed long     z[4][D_TEST_ELEMENT_NUM];
+    signed long     xx[D_TEST_ELEMENT_NUM];
+    signed long     yy[D_TEST_ELEMENT_NUM];
+    double          a[D_TEST_ELEMENT_NUM];
+    double          b[D_TEST_ELEMENT_NUM];
+    signed long     CorrX[D_TEST_CORR_NUM];
+    signed long     CorrY[D_TEST_CORR_NUM + D_TEST_SHIFT_NUM - 1];
+} TestData_t;
+
+/****************************************************************/
+/*                 local function declaration                   */
+/****************************************************************/
+
+static signed long test_rand_value ( unsigned char f_Kind );
+static void test_order_knot ( signed long *pf_Knot0, signed long *pf_Knot1 );
+static void test_set_data ( unsigned char f_Kind, TestData_t *pf_Data );
+static unsigned long test_compare_kernel ( const TestKernel_t *pf_Kernel, unsigned char f_Kind, TestData_t *pf_Data );
+static unsigned long test_check ( const char *pf_Name, const char *pf_Function, unsigned char f_Kind, unsigned long f_Num, const void *pf_Output, const void *pf_Expected, unsigned long f_Size );
+
+/****************************************************************/
+/*                        global variable                       */
+/****************************************************************/
+
+static const TestKernel_t s_Dispatch =
+{
+    "Dispatch", CalcAddressOnLineArray_slXslY, CalcAddressOnPlaneArray_slXslYslZ,
+    CalcLinearArray_dAdBslX, CalcQuotientArray_dXdYslZ, CalcCorrelationArray_slXslY, 1
+};
+
+#if defined D_MATH_FUNC_SIMD_X86
+static const TestKernel_t s_Sse41 =
+{
+    "SSE4.1", calc_line_array_sse41, calc_plane_array_sse41,
+    calc_linear_array_sse41, calc_quotient_array_sse41, calc_correlation_array_sse41, 0
+};
+
+static const TestKernel_t s_Avx2 =
+{
+    "AVX2", calc_line_array_avx2, calc_plane_array_avx2,
+    calc_linear_array_avx2, calc_quotient_array_avx2, calc_correlation_array_avx2, 0
+};
+#endif
+
+#if defined D_MATH_FUNC_SIMD_NEON
+static const TestKernel_t s_Neon =
+{
+    "NEON", calc_line_array_neon, calc_plane_array_neon,
+    calc_linear_array_neon, calc_quotient_array_neon, calc_correlation_array_neon, 0
+};
+#endif
+
+static const char *s_DataName[D_TEST_DATA_NUM] = { "random", "equal", "limit", "wide" };
+
+static TestData_t s_Data;
+static unsigned long s_ReportNum;
+
+/****************************************************************/
+/*                           main                               */
+/****************************************************************/
+
+int main ( void )
+{
+    unsigned long FailNum;
+    unsigned char k;
+
+    FailNum = 0;
+
+    for ( k = 0; k < D_TEST_DATA_NUM; k++ ) {
+        test_set_data ( k, &s_Data );
+
+#if defined D_MATH_FUNC_SIMD_X86
+        __builtin_cpu_init ();
+
+        if ( __builtin_cpu_supports ( "sse4.1" ) ) {
+            FailNum += test_compare_kernel ( &s_Sse41, k, &s_Data );
+        }
+
+        if ( __builtin_cpu_supports ( "avx2" ) ) {
+            FailNum += test_compare_kernel ( &s_Avx2, k, &s_Data );
+        }
+#endif
+
+#if defined D_MATH_FUNC_SIMD_NEON
+        FailNum += test_compare_kernel ( &s_Neon, k, &s_Data );
+#endif
+
+        FailNum += test_compare_kernel ( &s_Dispatch, k, &s_Data );
+    }
+
+    printf ( "%lu failures\n", FailNum );
+    printf ( "%s\n", ( FailNum == 0 ) ? "PASS" : "FAIL" );
+
+    return ( FailNum == 0 ) ? 0 : 1;
+}
+
+/****************************************************************/
+/*                       local function                         */
+/****************************************************************/
+
+/* Function for generating a value of the kind of arrays */
+static signed long test_rand_value ( unsigned char f_Kind )
+{
+    static const signed long s_Limit[6] = { -2147483647L - 1, -2147483647L, -1, 0, 2147483646L, 2147483647L };
+
+    switch ( f_Kind ) {
+    case D_TEST_DATA_LIMIT :
+        return ( test_rand () % 2 == 0 ) ? s_Limit[test_rand () % 6] : test_rand_range ( -2147483647L - 1, 2147483647L );
+#if LONG_MAX > 0x7FFFFFFF
+    case D_TEST_DATA_WIDE :
+        if ( test_rand () % 16 == 0 ) {
+            return ( test_rand () % 2 == 0 ) ? ( 2147483647L + 1 ) : -( 1L << 40 ) + test_rand_range ( 0, 65535 );
+        }
+        return test_rand_range ( -65536, 65535 );
+#endif
+    default :
+        return test_rand_range ( -65536, 65535 );
+    }
+}
+
+/* Function for ordering knots as knot 0 < knot 1 */
+static void test_order_knot ( signed long *pf_Knot0, signed long *pf_Knot1 )
+{
+    signed long Knot;
+
+    if ( (*pf_Knot1) < (*pf_Knot0) ) {
+        Knot        = (*pf_Knot0);
+        (*pf_Knot0) = (*pf_Knot1);
+        (*pf_Knot1) = Knot;
+    }
+
+    if ( (*pf_Knot0) == (*pf_Knot1) ) {
+        if ( (*pf_Knot0) == -2147483647L - 1 ) {
+            (*pf_Knot1)++;
+        } else {
+            (*pf_Knot0)--;
+        }
+    }
+
+    return ;
+}
+
+/* Function for setting arrays of the kind */
+static void test_set_data ( unsigned char f_Kind, TestData_t *pf_Data )
+{
+    unsigned long i;
+    unsigned long j;
+
+    for ( i = 0; i < D_TEST_ELEMENT_NUM; i++ ) {
+        /* Knots of plane are x0 < x1 and y0 < y1 with the point between them */
+        (*pf_Data).x0[i] = test_rand_value ( f_Kind );
+        (*pf_Data).x1[i] = test_rand_value ( f_Kind );
+        (*pf_Data).y0[i] = test_rand_value ( f_Kind );
+        (*pf_Data).y1[i] = test_rand_value ( f_Kind );
+
+        test_order_knot ( &((*pf_Data).x0[i]), &((*pf_Data).x1[i]) );
+        test_order_knot ( &((*pf_Data).y0[i]), &((*pf_Data).y1[i]) );
+
+        for ( j = 0; j < 4; j++ ) {
+            (*pf_Data).z[j][i] = test_rand_value ( f_Kind );
+        }
+
+        switch ( test_rand () % 4 ) {
+        case 0 :                                            /* Ends of the cell */
+            (*pf_Data).xx[i] = (*pf_Data).x0[i];
+            (*pf_Data).yy[i] = (*pf_Data).y1[i];
+            break ;
+        case 1 :
+            (*pf_Data).xx[i] = (*pf_Data).x1[i];
+            (*pf_Data).yy[i] = (*pf_Data).y0[i];
+            break ;
+        default :
+            (*pf_Data).xx[i] = (*pf_Data).x0[i] + (signed long)( (double)test_rand () / 2147483648.0 * ( (double)(*pf_Data).x1[i] - (double)(*pf_Data).x0[i] ) );
+            (*pf_Data).yy[i] = (*pf_Data).y0[i] + (signed long)( (double)test_rand () / 2147483648.0 * ( (double)(*pf_Data).y1[i] - (double)(*pf_Data).y0[i] ) );
+            break ;
+        }
+
+        if ( f_Kind == D_TEST_DATA_EQUAL ) {
+            if ( test_rand () % 2 == 0 ) {
+                (*pf_Data).z[1][i] = (*pf_Data).z[0][i];        /* Equal values */
+            }
+            if ( test_rand () % 2 == 0 ) {
+                (*pf_Data).z[3][i] = (*pf_Data).z[2][i];
+            }
+        }
+
+        (*pf_Data).a[i] = ( (double)test_rand () - 1073741824.0 ) / 65536.0;
+        (*pf_Data).b[i] = ( (double)test_rand () - 1073741824.0 ) * 4.0;
+
+        if ( test_rand () % 8 == 0 ) {
+            (*pf_Data).a[i] *= 1.0e9;                       /* Limited to signed 32 bit */
+        }
+    }
+
+    for ( i = 0; i < D_TEST_CORR_NUM; i++ ) {
+        (*pf_Data).CorrX[i] = test_rand_value ( f_Kind );
+    }
+
+    for ( i = 0; i < D_TEST_CORR_NUM + D_TEST_SHIFT_NUM - 1; i++ ) {
+        (*pf_Data).CorrY[i] = test_rand_value ( f_Kind );
+    }
+
+    return ;
+}
+
+/* Function for comparing functions of an instruction set with the scalar functions */
+static unsigned long test_compare_kernel ( const TestKernel_t *pf_Kernel, unsigned char f_Kind, TestData_t *pf_Data )
+{
+    static signed long          s_x0[D_TEST_ELEMENT_NUM];
+    static signed long          s_x1[D_TEST_ELEMENT_NUM];
+    static signed long          s_y0[D_TEST_ELEMENT_NUM];
+    static signed long          s_y1[D_TEST_ELEMENT_NUM];
+    static signed long          s_Output[D_TEST_ELEMENT_NUM];
+    static signed long          s_Expected[D_TEST_ELEMENT_NUM];
+    static unsigned long        s_Quotient[D_TEST_ELEMENT_NUM];
+    static unsigned long        s_QuotientExpected[D_TEST_ELEMENT_NUM];
+    static double               s_Dividend[D_TEST_ELEMENT_NUM];
+    static unsigned long long   s_Cost[D_TEST_SHIFT_NUM];
+    static unsigned long long   s_CostExpected[D_TEST_SHIFT_NUM];
+    unsigned long FailNum;
+    unsigned long i;
+    unsigned long Num;
+    unsigned long ShiftNum;
+    unsigned char Square;
+
+    FailNum = 0;
+
+    /* Lines of any order of knots, including equal knots, with points out of them. Equal knots and */
+    /* values are more frequent in D_TEST_DATA_EQUAL. */
+    for ( i = 0; i < D_TEST_ELEMENT_NUM; i++ ) {
+        s_x0[i] = ( test_rand () % 2 == 0 ) ? (*pf_Data).x0[i] : (*pf_Data).x1[i];
+        s_x1[i] = ( s_x0[i] == (*pf_Data).x0[i] ) ? (*pf_Data).x1[i] : (*pf_Data).x0[i];
+        s_y0[i] = (*pf_Data).z[0][i];
+        s_y1[i] = (*pf_Data).z[1][i];
+
+        if ( f_Kind == D_TEST_DATA_EQUAL && test_rand () % 2 == 0 ) {
+            s_x1[i] = s_x0[i];
+        }
+        if ( test_rand () % 4 == 0 ) {
+            s_y1[i] = s_y0[i];
+        }
+    }
+
+    for ( Num = D_TEST_ELEMENT_NUM - 3; Num <= D_TEST_ELEMENT_NUM; Num++ ) {
+        memset ( s_Output, 0, sizeof(s_Output) );
+        memset ( s_Expected, 0, sizeof(s_Expected) );
+
+        (*(*pf_Kernel).p_Line) ( Num, s_x0, s_x1, s_y0, s_y1, (*pf_Data).yy, s_Output );
+        calc_line_array_scalar ( 0, Num, s_x0, s_x1, s_y0, s_y1, (*pf_Data).yy, s_Expected );
+        FailNum += test_check ( (*pf_Kernel).p_Name, "line", f_Kind, Num, s_Output, s_Expected, sizeof(signed long) );
+
+        memset ( s_Output, 0, sizeof(s_Output) );
+        memset ( s_Expected, 0, sizeof(s_Expected) );
+
+        (*(*pf_Kernel).p_Plane) ( Num, (*pf_Data).x0, (*pf_Data).x1, (*pf_Data).y0, (*pf_Data).y1,
+                                (*pf_Data).z[0], (*pf_Data).z[1], (*pf_Data).z[2], (*pf_Data).z[3], (*pf_Data).xx, (*pf_Data).yy, s_Output );
+        calc_plane_array_scalar ( 0, Num, (*pf_Data).x0, (*pf_Data).x1, (*pf_Data).y0, (*pf_Data).y1,
+                                  (*pf_Data).z[0], (*pf_Data).z[1], (*pf_Data).z[2], (*pf_Data).z[3], (*pf_Data).xx, (*pf_Data).yy, s_Expected );
+        FailNum += test_check ( (*pf_Kernel).p_Name, "plane", f_Kind, Num, s_Output, s_Expected, sizeof(signed long) );
+
+        if ( pf_Kernel == &s_Dispatch ) {
+            memset ( s_Output, 0, sizeof(s_Output) );
+            memset ( s_Expected, 0, sizeof(s_Expected) );
+
+            CalcAddressOnCellArray_slXslYslZ ( Num, (*pf_Data).x0, (*pf_Data).x1, (*pf_Data).y0, (*pf_Data).y1,
+                                               (*pf_Data).z[0], (*pf_Data).z[1], (*pf_Data).z[2], (*pf_Data).z[3], (*pf_Data).xx, (*pf_Data).yy, s_Output );
+            calc_cell_array_scalar ( 0, Num, (*pf_Data).x0, (*pf_Data).x1, (*pf_Data).y0, (*pf_Data).y1,
+                                     (*pf_Data).z[0], (*pf_Data).z[1], (*pf_Data).z[2], (*pf_Data).z[3], (*pf_Data).xx, (*pf_Data).yy, s_Expected );
+            FailNum += test_check ( (*pf_Kernel).p_Name, "cell", f_Kind, Num, s_Output, s_Expected, sizeof(signed long) );
+        }
+
+        memset ( s_Output, 0, sizeof(s_Output) );
+        memset ( s_Expected, 0, sizeof(s_Expected) );
+
+        (*(*pf_Kernel).p_Linear) ( Num, (*pf_Data).a, (*pf_Data).b, (*pf_Data).z[2], s_Output );
+        calc_linear_array_scalar ( 0, Num, (*pf_Data).a, (*pf_Data).b, (*pf_Data).z[2], s_Expected );
+        FailNum += test_check ( (*pf_Kernel).p_Name, "linear", f_Kind, Num, s_Output, s_Expected, sizeof(signed long) );
+
+        /* Dividends are not negative, and divisors are not 0 */
+        for ( i = 0; i < Num; i++ ) {
+            s_Dividend[i] = ( (*pf_Data).b[i] < 0.0 ) ? -(*pf_Data).b[i] * 1024.0 : (*pf_Data).b[i];
+            s_y0[i]       = ( (*pf_Data).z[3][i] == 0 ) ? 1 : (*pf_Data).z[3][i];
+        }
+
+        memset ( s_Quotient, 0, sizeof(s_Quotient) );
+        memset ( s_QuotientExpected, 0, sizeof(s_QuotientExpected) );
+
+        (*(*pf_Kernel).p_Quotient) ( Num, s_Dividend, 3.0, s_y0, s_Quotient );
+        calc_quotient_array_scalar ( 0, Num, s_Dividend, 3.0, s_y0, s_QuotientExpected );
+        FailNum += test_check ( (*pf_Kernel).p_Name, "quotient", f_Kind, Num, s_Quotient, s_QuotientExpected, sizeof(unsigned long) );
+    }
+
+    /* Vector functions of correlation are given values within signed 31 bit by the dispatching function */
+    if ( (*pf_Kernel).CorrelationGuard != 0 || f_Kind == D_TEST_DATA_RANDOM || f_Kind == D_TEST_DATA_EQUAL ) {
+        for ( Square = 0; Square <= 1; Square++ ) {
+            for ( ShiftNum = 0; ShiftNum <= D_TEST_SHIFT_NUM; ShiftNum++ ) {
+                memset ( s_Cost, 0, sizeof(s_Cost) );
+                memset ( s_CostExpected, 0, sizeof(s_CostExpected) );
+
+                (*(*pf_Kernel).p_Correlation) ( D_TEST_CORR_NUM, (*pf_Data).CorrX, (*pf_Data).CorrY, ShiftNum, Square, s_Cost );
+                calc_correlation_array_scalar ( 0, D_TEST_CORR_NUM, (*pf_Data).CorrX, (*pf_Data).CorrY, ShiftNum, Square, s_CostExpected );
+                FailNum += test_check ( (*pf_Kernel).p_Name, ( Square != 0 ) ? "SSD" : "SAD", f_Kind, D_TEST_SHIFT_NUM,
+                                        s_Cost, s_CostExpected, sizeof(unsigned long long) );
+            }
+        }
+    }
+
+    return FailNum;
+}
+
+/* Function for checking output data. Returns the number of different elements. */
+static unsigned long test_check ( const char *pf_Name, const char *pf_Function, unsigned char f_Kind, unsigned long f_Num, const void *pf_Output, const void *pf_Expected, unsigned long f_Size )
+{
+    unsigned long FailNum;
+    unsigned long i;
+
+    FailNum = 0;
+
+    for ( i = 0; i < f_Num; i++ ) {
+        if ( memcmp ( (const unsigned char *)pf_Output + i * f_Size, (const unsigned char *)pf_Expected + i * f_Size, f_Size ) != 0 ) {
+            if ( s_ReportNum < D_TEST_REPORT_NUM ) {
+                printf ( "%s %s of %s values, %lu elements : element %lu differs\n", pf_Name, pf_Function, s_DataName[f_Kind], f_Num, i );
+                s_ReportNum++;
+            }
+            FailNum++;
+        }
+    }
+
+    return FailNum;
+}
@@ -0,0 +1,348 @@
+﻿/*
+Copyright (c)  2016, Sony Corporation All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+this list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice, 
+this list of conditions and the following disclaimer in the documentation 
+and/or other materials provided with the distribution.
+3. Neither the name of the copyright holder nor the names of its contributors 
+may be used to endorse or promote products derived from this software without 
+specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/*
+    Helpers shared by tests and benchmark of PDAF Library : pseudo random numbers which are the same in
+    all environments, knots, random calibration data, random PDAF windows and input data of PdLibGetDefocus().
+
+    Included by one source file of each program. D_TEST_MAX_KNOT_NUM and D_TEST_MAX_POINT_NUM may be
+    defined before inclusion to change the size of TestCalib_t.
+*/
+
+#ifndef __PDAF_TEST_COMMON_H__
+#define __PDAF_TEST_COMMON_H__
+
+#include <string.h>
+
+#include "PdafLibrary.h"
+
+/****************************************************************/
+/*                          define                              */
+/****************************************************************/
+
+#ifndef D_TEST_MAX_KNOT_NUM
+#define D_TEST_MAX_KNOT_NUM         (16)            /* Maximum number of knots in each direction */
+#endif
+#ifndef D_TEST_MAX_POINT_NUM
+#define D_TEST_MAX_POINT_NUM        (8)             /* Maximum number of points of threshold line */
+#endif
+#define D_TEST_POINT_NUM            (4)             /* Number of points of threshold line which is not extreme */
+#define D_TEST_POINT_PITCH          (512)           /* Pitch of analog gain of threshold line which is not extreme */
+
+/* Knots of DefocusOKNG of TestCalibKind_t */
+#define D_TEST_OKNG_SAME            (0)             /* Same knots as slope and offset */
+#define D_TEST_OKNG_SAME_OR_NONE    (1)             /* Disabled, 1 x 1 or same knots as slope and offset */
+#define D_TEST_OKNG_OWN_OR_NONE     (2)             /* Disabled, 1 x 1 or random knots of its own */
+
+#if defined __GNUC__
+#define D_TEST_UNUSED               __attribute__ ((unused))    /* Helper not used by every program */
+#else
+#define D_TEST_UNUSED
+#endif
+
+/****************************************************************/
+/*                          structure                           */
+/****************************************************************/
+
+/* Random calibration data */
+typedef struct
+{
+    PdLibCalibData_t        CalibData;
+    signed long             SlopeData[D_TEST_MAX_KNOT_NUM * D_TEST_MAX_KNOT_NUM];
+    signed long             OffsetData[D_TEST_MAX_KNOT_NUM * D_TEST_MAX_KNOT_NUM];
+    unsigned short          XAddressKnot[D_TEST_MAX_KNOT_NUM];
+    unsigned short          YAddressKnot[D_TEST_MAX_KNOT_NUM];
+    unsigned short          XAddressKnotOkNg[D_TEST_MAX_KNOT_NUM];
+    unsigned short          YAddressKnotOkNg[D_TEST_MAX_KNOT_NUM];
+    DefocusOKNGThrLine_t    ThrLine[D_TEST_MAX_KNOT_NUM * D_TEST_MAX_KNOT_NUM];
+    unsigned long           AnalogGain[D_TEST_MAX_KNOT_NUM * D_TEST_MAX_KNOT_NUM][D_TEST_MAX_POINT_NUM];
+    unsigned long           Confidence[D_TEST_MAX_KNOT_NUM * D_TEST_MAX_KNOT_NUM][D_TEST_MAX_POINT_NUM];
+    unsigned long           MaxAnalogGain;          /* Maximum analog gain of threshold lines */
+} TestCalib_t;
+
+/* Kind of random calibration data */
+typedef struct
+{
+    unsigned short          XSizeOfImage;           /* Size of image. 0 : random from 640 x 480 to 8000 x 6000 */
+    unsigned short          YSizeOfImage;
+    unsigned short          KnotNum;                /* Knots of uniform pitch in each direction. 0 : random number and pitch */
+    unsigned char           OkNg;                   /* Knots of DefocusOKNG, D_TEST_OKNG_XXX */
+    unsigned char           Extreme;                /* 1 : some slopes, offsets and spans of threshold lines up to the */
+                                                    /*     limit of signed 32 bit, and random number of points */
+    const PdLibSensorProfile_t *p_Profile;          /* Profile of random sensor mode, or NULL for macros of mode 0 */
+} TestCalibKind_t;
+
+/****************************************************************/
+/*                       local function                         */
+/****************************************************************/
+
+static unsigned long s_TestSeed = 12345;            /* Seed of test_rand() */
+
+/* Function for generating 31-bit pseudo random number of a seed which is the same in all environments */
+static D_TEST_UNUSED unsigned long test_rand_seed ( unsigned long *pf_Seed )
+{
+    unsigned long High;
+
+    (*pf_Seed) = ( (*pf_Seed) * 1103515245UL + 12345UL ) & 0x7FFFFFFFUL;
+    High       = (*pf_Seed) >> 15;
+    (*pf_Seed) = ( (*pf_Seed) * 1103515245UL + 12345UL ) & 0x7FFFFFFFUL;
+
+    return ( ( High << 15 ) ^ ( (*pf_Seed) >> 16 ) ) & 0x7FFFFFFFUL;
+}
+
+/* Function for generating 31-bit pseudo random number of the seed of the program */
+static D_TEST_UNUSED unsigned long test_rand ( void )
+{
+    return test_rand_seed ( &s_TestSeed );
+}
+
+/* Function for generating pseudo random number from f_Min to f_Max */
+static D_TEST_UNUSED signed long test_rand_range ( signed long f_Min, signed long f_Max )
+{
+    unsigned long Range;
+
+    Range = (unsigned long)f_Max - (unsigned long)f_Min;
+
+    if ( 0x7FFFFFFFUL <= Range ) {
+        return (signed long)( (unsigned long)f_Min + ( ( test_rand () << 1 ) ^ ( test_rand () & 1 ) ) % ( Range + 1 ) );
+    }
+
+    return (signed long)( (unsigned long)f_Min + test_rand () % ( Range + 1 ) );
+}
+
+/* Function for setting knots between 1/8 and 7/8 of image so that windows can be out of knots. */
+/* Inner knots of irregular pitch are moved at random by up to 1/4 of the pitch. */
+static D_TEST_UNUSED void test_set_knot ( unsigned short f_KnotNum, unsigned short f_Size, unsigned char f_Irregular, unsigned short *pf_AddressKnot )
+{
+    unsigned long i;
+    unsigned long First;
+    unsigned long Pitch;
+
+    First = f_Size / 8;
+    Pitch = ( f_Size * 3 / 4 ) / ( f_KnotNum - 1 );
+
+    for ( i = 0; i < f_KnotNum; i++ ) {
+        pf_AddressKnot[i] = (unsigned short)( First + i * Pitch );
+
+        if ( f_Irregular != 0 && 0 < i && i < (unsigned long)f_KnotNum - 1 ) {
+            pf_AddressKnot[i] = (unsigned short)( pf_AddressKnot[i] + test_rand () % ( Pitch / 2 ) - Pitch / 4 );
+        }
+    }
+
+    return ;
+}
+
+/* Function for creating random calibration data of the kind */
+static D_TEST_UNUSED void test_create_calib ( const TestCalibKind_t *pf_Kind, TestCalib_t *pf_Calib )
+{
+    unsigned long i;
+    unsigned long j;
+    unsigned long KnotNum;
+    unsigned long LineNum;
+    unsigned long SensMode;
+    unsigned char Irregular;
+    unsigned char Wide;
+    PdLibCalibData_t *p_CalibData;
+
+    memset ( pf_Calib, 0, sizeof(TestCalib_t) );
+
+    p_CalibData = &((*pf_Calib).CalibData);
+    SensMode    = ( (*pf_Kind).p_Profile != NULL ) ? test_rand () % D_PD_LIB_SENS_MODE_NUM : 0;
+    Wide        = ( (*pf_Kind).Extreme != 0 && test_rand () % 4 == 0 ) ? 1 : 0;   /* Threshold lines of wide span */
+
+    (*p_CalibData).XSizeOfImage = (*pf_Kind).XSizeOfImage;
+    (*p_CalibData).YSizeOfImage = (*pf_Kind).YSizeOfImage;
+
+    if ( (*pf_Kind).XSizeOfImage == 0 ) {
+        (*p_CalibData).XSizeOfImage = (unsigned short)test_rand_range ( 640, 8000 );
+        (*p_CalibData).YSizeOfImage = (unsigned short)test_rand_range ( 480, 6000 );
+    }
+
+    if ( (*pf_Kind).KnotNum == 0 ) {
+        (*p_CalibData).XKnotNumSlopeOffset = (unsigned short)test_rand_range ( 2, D_TEST_MAX_KNOT_NUM );
+        (*p_CalibData).YKnotNumSlopeOffset = (unsigned short)test_rand_range ( 2, D_TEST_MAX_KNOT_NUM );
+        Irregular = 1;
+    } else {
+        (*p_CalibData).XKnotNumSlopeOffset = (*pf_Kind).KnotNum;
+        (*p_CalibData).YKnotNumSlopeOffset = (*pf_Kind).KnotNum;
+        Irregular = 0;
+    }
+
+    test_set_knot ( (*p_CalibData).XKnotNumSlopeOffset, (*p_CalibData).XSizeOfImage, Irregular, (*pf_Calib).XAddressKnot );
+    test_set_knot ( (*p_CalibData).YKnotNumSlopeOffset, (*p_CalibData).YSizeOfImage, Irregular, (*pf_Calib).YAddressKnot );
+
+    KnotNum = (unsigned long)(*p_CalibData).XKnotNumSlopeOffset * (*p_CalibData).YKnotNumSlopeOffset;
+
+    for ( i = 0; i < KnotNum; i++ ) {
+        (*pf_Calib).SlopeData[i]  = test_rand_range ( -200000, 200000 );
+        (*pf_Calib).OffsetData[i] = test_rand_range ( -100000, 100000 );
+
+        if ( (*pf_Kind).Extreme != 0 && test_rand () % 32 == 0 ) {
+            (*pf_Calib).SlopeData[i]  = test_rand_range ( -2147483647L, 2147483647L );
+        }
+        if ( (*pf_Kind).Extreme != 0 && test_rand () % 32 == 0 ) {
+            (*pf_Calib).OffsetData[i] = test_rand_range ( -2147483647L, 2147483647L );
+        }
+    }
+
+    /* Knots of DefocusOKNG : disabled, 1 x 1, the same as slope and offset, or grid of its own */
+    switch ( ( (*pf_Kind).OkNg == D_TEST_OKNG_SAME ) ? 2 : test_rand () % 3 ) {
+    case 0 :
+        (*p_CalibData).XKnotNumDefocusOKNG = 0;
+        (*p_CalibData).YKnotNumDefocusOKNG = 0;
+        break ;
+    case 1 :
+        (*p_CalibData).XKnotNumDefocusOKNG = 1;
+        (*p_CalibData).YKnotNumDefocusOKNG = 1;
+        break ;
+    default :
+        if ( (*pf_Kind).OkNg == D_TEST_OKNG_OWN_OR_NONE ) {
+            (*p_CalibData).XKnotNumDefocusOKNG = (unsigned short)test_rand_range ( 2, 8 );
+            (*p_CalibData).YKnotNumDefocusOKNG = (unsigned short)test_rand_range ( 2, 8 );
+            test_set_knot ( (*p_CalibData).XKnotNumDefocusOKNG, (*p_CalibData).XSizeOfImage, 1, (*pf_Calib).XAddressKnotOkNg );
+            test_set_knot ( (*p_CalibData).YKnotNumDefocusOKNG, (*p_CalibData).YSizeOfImage, 1, (*pf_Calib).YAddressKnotOkNg );
+        } else {
+            (*p_CalibData).XKnotNumDefocusOKNG = (*p_CalibData).XKnotNumSlopeOffset;
+            (*p_CalibData).YKnotNumDefocusOKNG = (*p_CalibData).YKnotNumSlopeOffset;
+            memcpy ( (*pf_Calib).XAddressKnotOkNg, (*pf_Calib).XAddressKnot, sizeof((*pf_Calib).XAddressKnot) );
+            memcpy ( (*pf_Calib).YAddressKnotOkNg, (*pf_Calib).YAddressKnot, sizeof((*pf_Calib).YAddressKnot) );
+        }
+        break ;
+    }
+
+    LineNum = (unsigned long)(*p_CalibData).XKnotNumDefocusOKNG * (*p_CalibData).YKnotNumDefocusOKNG;
+
+    if ( LineNum == 0 ) {
+        LineNum = 1;                                        /* Line 0 is checked even if confidence is not judged */
+    }
+
+    for ( i = 0; i < LineNum; i++ ) {
+        unsigned long PointNum;
+        unsigned long AnalogGain;
+
+        if ( (*pf_Kind).Extreme != 0 ) {
+            PointNum   = (unsigned long)test_rand_range ( 2, D_TEST_MAX_POINT_NUM );
+            AnalogGain = (unsigned long)test_rand_range ( 0, 300 );
+        } else {
+            PointNum   = D_TEST_POINT_NUM;
+            AnalogGain = 0;
+        }
+
+        (*pf_Calib).ThrLine[i].PointNum     = PointNum;
+        (*pf_Calib).ThrLine[i].p_AnalogGain = (*pf_Calib).AnalogGain[i];
+        (*pf_Calib).ThrLine[i].p_Confidence = (*pf_Calib).Confidence[i];
+
+        for ( j = 0; j < PointNum; j++ ) {
+            (*pf_Calib).AnalogGain[i][j] = AnalogGain;
+
+            if ( Wide != 0 ) {
+                AnalogGain += (unsigned long)test_rand_range ( 0, (signed long)( 0x7FFFFFFFUL / D_TEST_MAX_POINT_NUM ) );
+                (*pf_Calib).Confidence[i][j] = (unsigned long)test_rand_range ( 0, 0x7FFFFFFFL );
+            } else if ( (*pf_Kind).Extreme != 0 ) {
+                AnalogGain += (unsigned long)test_rand_range ( 0, 2000 );
+                (*pf_Calib).Confidence[i][j] = (unsigned long)test_rand_range ( 0, 5000 );
+            } else {
+                AnalogGain += D_TEST_POINT_PITCH;
+                (*pf_Calib).Confidence[i][j] = (unsigned long)test_rand_range ( 100, 1099 );
+            }
+        }
+
+        if ( (*pf_Calib).MaxAnalogGain < (*pf_Calib).AnalogGain[i][PointNum-1] ) {
+            (*pf_Calib).MaxAnalogGain = (*pf_Calib).AnalogGain[i][PointNum-1];
+        }
+    }
+
+    (*p_CalibData).p_SlopeData               = (*pf_Calib).SlopeData;
+    (*p_CalibData).p_OffsetData              = (*pf_Calib).OffsetData;
+    (*p_CalibData).p_XAddressKnotSlopeOffset = (*pf_Calib).XAddressKnot;
+    (*p_CalibData).p_YAddressKnotSlopeOffset = (*pf_Calib).YAddressKnot;
+    (*p_CalibData).p_DefocusOKNGThrLine      = (*pf_Calib).ThrLine;
+    (*p_CalibData).p_XAddressKnotDefocusOKNG = (*pf_Calib).XAddressKnotOkNg;
+    (*p_CalibData).p_YAddressKnotDefocusOKNG = (*pf_Calib).YAddressKnotOkNg;
+
+    if ( (*pf_Kind).p_Profile != NULL ) {
+        (*p_CalibData).AdjCoeffSlope     = (*(*pf_Kind).p_Profile).AdjCoeffSlope[SensMode];
+        (*p_CalibData).DensityOfPhasePix = (*(*pf_Kind).p_Profile).DensityOfPhasePix[SensMode];
+    } else {
+        (*p_CalibData).AdjCoeffSlope     = D_PD_LIB_SLOPE_ADJ_COEFF_SENS_MODE0;
+        (*p_CalibData).DensityOfPhasePix = D_PD_LIB_DENSITY_SENS_MODE0;
+    }
+
+    return ;
+}
+
+/* Function for setting a PDAF window of random size from 1 to f_MaxSize anywhere in image */
+static D_TEST_UNUSED void test_set_window ( unsigned short f_XSizeOfImage, unsigned short f_YSizeOfImage, unsigned long f_MaxSize, PdLibWindow_t *pf_Window )
+{
+    unsigned long Width;
+    unsigned long Height;
+
+    Width  = (unsigned long)test_rand_range ( 1, (signed long)f_MaxSize );
+    Height = (unsigned long)test_rand_range ( 1, (signed long)f_MaxSize );
+
+    (*pf_Window).XAddressOfWindowStart = (unsigned short)( test_rand () % ( f_XSizeOfImage - Width ) );
+    (*pf_Window).YAddressOfWindowStart = (unsigned short)( test_rand () % ( f_YSizeOfImage - Height ) );
+    (*pf_Window).XAddressOfWindowEnd   = (unsigned short)( (*pf_Window).XAddressOfWindowStart + Width );
+    (*pf_Window).YAddressOfWindowEnd   = (unsigned short)( (*pf_Window).YAddressOfWindowStart + Height );
+
+    return ;
+}
+
+/* Function for setting input data structure of PdLibGetDefocus() */
+static D_TEST_UNUSED void test_set_input ( TestCalib_t *pf_Calib, PdLibWindow_t *pf_Window, signed long f_PhaseDifference, unsigned long f_ConfidenceLevel, unsigned long f_ImagerAnalogGain, PdLibInputData_t *pf_InputData )
+{
+    PdLibCalibData_t *p_CalibData;
+
+    p_CalibData = &((*pf_Calib).CalibData);
+
+    (*pf_InputData).PhaseDifference           = f_PhaseDifference;
+    (*pf_InputData).ConfidenceLevel           = f_ConfidenceLevel;
+    (*pf_InputData).XSizeOfImage              = (*p_CalibData).XSizeOfImage;
+    (*pf_InputData).YSizeOfImage              = (*p_CalibData).YSizeOfImage;
+    (*pf_InputData).XAddressOfWindowStart     = (*pf_Window).XAddressOfWindowStart;
+    (*pf_InputData).YAddressOfWindowStart     = (*pf_Window).YAddressOfWindowStart;
+    (*pf_InputData).XAddressOfWindowEnd       = (*pf_Window).XAddressOfWindowEnd;
+    (*pf_InputData).YAddressOfWindowEnd       = (*pf_Window).YAddressOfWindowEnd;
+    (*pf_InputData).XKnotNumSlopeOffset       = (*p_CalibData).XKnotNumSlopeOffset;
+    (*pf_InputData).YKnotNumSlopeOffset       = (*p_CalibData).YKnotNumSlopeOffset;
+    (*pf_InputData).p_SlopeData               = (*p_CalibData).p_SlopeData;
+    (*pf_InputData).p_OffsetData              = (*p_CalibData).p_OffsetData;
+    (*pf_InputData).p_XAddressKnotSlopeOffset = (*p_CalibData).p_XAddressKnotSlopeOffset;
+    (*pf_InputData).p_YAddressKnotSlopeOffset = (*p_CalibData).p_YAddressKnotSlopeOffset;
+    (*pf_InputData).AdjCoeffSlope             = (*p_CalibData).AdjCoeffSlope;
+    (*pf_InputData).ImagerAnalogGain          = f_ImagerAnalogGain;
+    (*pf_InputData).XKnotNumDefocusOKNG       = (*p_CalibData).XKnotNumDefocusOKNG;
+    (*pf_InputData).YKnotNumDefocusOKNG       = (*p_CalibData).YKnotNumDefocusOKNG;
+    (*pf_InputData).p_DefocusOKNGThrLine      = (*p_CalibData).p_DefocusOKNGThrLine;
+    (*pf_InputData).p_XAddressKnotDefocusOKNG = (*p_CalibData).p_XAddressKnotDefocusOKNG;
+    (*pf_InputData).p_YAddressKnotDefocusOKNG = (*p_CalibData).p_YAddressKnotDefocusOKNG;
+    (*pf_InputData).DensityOfPhasePix         = (*p_CalibData).DensityOfPhasePix;
+
+    return ;
+}
+
+#endif